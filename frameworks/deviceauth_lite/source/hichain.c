@@ -539,16 +539,11 @@ DLL_API_PUBLIC int32_t is_trust_peer(hc_handle handle, struct hc_user_info *user
         LOGE("Generate key alias failed");
         return HC_GEN_ALIAS_FAILED;
     }
-    int32_t ret = check_lt_public_key_exist(&alias);
-    if (ret != ERROR_CODE_SUCCESS) {
-        LOGE("Check lt public key exist is %d", ret);
-        return HC_NOT_TRUST_PEER;
-    }
     struct huks_key_type key_type;
     struct hc_auth_id auth_id;
 
     (void)memset_s(&key_type, sizeof(key_type), 0, sizeof(key_type));
-    ret = get_lt_key_info(&alias, &key_type, &auth_id);
+    int32_t ret = get_lt_key_info(&alias, &key_type, &auth_id);
     if (ret != ERROR_CODE_SUCCESS) {
         LOGE("Check lt public key exist is %d", ret);
         return HC_NOT_TRUST_PEER;
@@ -591,17 +586,13 @@ DLL_API_PUBLIC uint32_t list_trust_peers(hc_handle handle, int32_t trust_user_ty
             LOGE("Generate key alias failed");
             return 0;
         }
-        if (check_lt_public_key_exist(&owner_alias) != ERROR_CODE_SUCCESS) {
-            LOGE("not found this owner");
-            return 0;
-        }
         if (check_key_alias_is_owner(&owner_alias) != ERROR_CODE_SUCCESS) {
             LOGE("hc_auth_id is not owner");
             return 0;
         }
     }
 
-    uint32_t count = LIST_TRUST_PEER_DEF_COUNT;
+    uint32_t count = HC_PUB_KEY_ALIAS_MAX_NUM;
     int32_t ret = get_lt_public_key_list(owner_auth_id, trust_user_type, *auth_id_list, &count);
     LOGI("End list trust peers");
     if ((ret != ERROR_CODE_SUCCESS) || (count == LIST_TRUST_PEER_DEF_COUNT)) {
@@ -1166,7 +1157,12 @@ static int32_t delete_base_key(struct service_id service_id, struct operation_pa
 static int32_t delete_public_key(hc_handle handle, struct service_id service_id, int32_t user_type)
 {
     LOGI("delete public key");
-    uint32_t length = HC_PUB_KEY_ALIAS_MAX_NUM * sizeof(struct hc_auth_id);
+    (void)handle;
+    uint32_t peers_num = get_lt_public_key_num();
+    if (peers_num == 0) {
+        return HC_OK;
+    }
+    uint32_t length = peers_num * sizeof(struct hc_auth_id);
     struct hc_auth_id *auth_id_list = (struct hc_auth_id *)MALLOC(length);
     if (auth_id_list == NULL) {
         LOGE("malloc auth id list failed");
@@ -1174,7 +1170,10 @@ static int32_t delete_public_key(hc_handle handle, struct service_id service_id,
     }
     (void)memset_s(auth_id_list, length, 0, length);
 
-    uint32_t peers_num = list_trust_peers(handle, user_type, NULL, &auth_id_list);
+    /* not through list_trust_peers, whose list is bounded by HC_PUB_KEY_ALIAS_MAX_NUM */
+    if (get_lt_public_key_list(NULL, user_type, auth_id_list, &peers_num) != ERROR_CODE_SUCCESS) {
+        peers_num = 0;
+    }
     LOGI("peers_num %d", peers_num);
     for (uint32_t loop = 0; loop < peers_num; loop++) {
         struct hc_key_alias key_alias = generate_key_alias(&service_id, &auth_id_list[loop], user_type);
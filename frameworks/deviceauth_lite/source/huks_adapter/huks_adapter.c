@@ -961,6 +961,237 @@ int32_t export_lt_public_key(struct hc_key_alias *key_alias, struct ltpk *out_pu
     return ERROR_CODE_SUCCESS;
 }
 
+/*
+ * The index of the trusted peers, that is the long time public keys imported for them, sorted by key alias.
+ * It is loaded from the keystore on the first use and then kept up to date when the keys are imported
+ * and deleted, so checking and listing the peers don't go through the keystore.
+ */
+struct lt_peer_entry {
+    struct hc_key_alias alias;
+    struct hc_auth_id auth_id;
+    struct huks_key_type key_type;
+};
+
+struct lt_peer_index {
+    bool is_loaded;
+    uint32_t count;
+    uint32_t capacity;
+    struct lt_peer_entry *entries;
+};
+
+#define LT_PEER_INDEX_MIN_CAPACITY 8
+/* the bound of the keys enumerated when the index is loaded, to stop on a broken keystore */
+#define LT_PEER_LOAD_MAX_NUM 4096
+
+static struct lt_peer_index g_lt_peer_index = { false, 0, 0, NULL };
+
+static int32_t init_key_info_list(struct HksKeyInfo *key_info_list, int32_t len);
+static int32_t inner_get_lt_info_by_key_info(struct HksKeyInfo *key_info,
+    struct huks_key_type *out_key_type, struct hc_auth_id *out_auth_id);
+
+static int32_t compare_key_alias(const struct hc_key_alias *alias, const struct HksBlob *other)
+{
+    if (alias->length != other->size) {
+        return (alias->length < other->size) ? -1 : 1;
+    }
+    return memcmp(alias->key_alias, other->data, other->size);
+}
+
+/* return the position of the alias, or the position to insert it if it is not found */
+static uint32_t search_lt_peer(const struct HksBlob *alias, bool *is_found)
+{
+    uint32_t low = 0;
+    uint32_t high = g_lt_peer_index.count;
+    *is_found = false;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        int32_t res = compare_key_alias(&g_lt_peer_index.entries[mid].alias, alias);
+        if (res == 0) {
+            *is_found = true;
+            return mid;
+        }
+        if (res < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static void clear_lt_peer_index(void)
+{
+    safe_free(g_lt_peer_index.entries);
+    (void)memset_s(&g_lt_peer_index, sizeof(g_lt_peer_index), 0, sizeof(g_lt_peer_index));
+}
+
+static int32_t grow_lt_peer_index(void)
+{
+    uint32_t capacity = (g_lt_peer_index.capacity == 0) ? LT_PEER_INDEX_MIN_CAPACITY :
+        (g_lt_peer_index.capacity * 2); /* 2: double the capacity */
+    uint32_t size = capacity * sizeof(struct lt_peer_entry);
+    struct lt_peer_entry *entries = (struct lt_peer_entry *)MALLOC(size);
+    if (entries == NULL) {
+        LOGE("Malloc for lt peer index failed");
+        return ERROR_CODE_NO_SPACE;
+    }
+    (void)memset_s(entries, size, 0, size);
+    if ((g_lt_peer_index.count > 0) && (memcpy_s(entries, size, g_lt_peer_index.entries,
+        g_lt_peer_index.count * sizeof(struct lt_peer_entry)) != EOK)) {
+        FREE(entries);
+        return ERROR_CODE_FAILED;
+    }
+    safe_free(g_lt_peer_index.entries);
+    g_lt_peer_index.entries = entries;
+    g_lt_peer_index.capacity = capacity;
+    return ERROR_CODE_SUCCESS;
+}
+
+static int32_t add_lt_peer(const struct HksBlob *alias, const struct huks_key_type *key_type,
+    const struct hc_auth_id *auth_id)
+{
+    if ((alias->size == 0) || (alias->size > HC_KEY_ALIAS_MAX_LEN) || (auth_id->length > HC_AUTH_ID_BUFF_LEN)) {
+        return ERROR_CODE_FAILED;
+    }
+    bool is_found = false;
+    uint32_t pos = search_lt_peer(alias, &is_found);
+    if (!is_found) {
+        if ((g_lt_peer_index.count == g_lt_peer_index.capacity) && (grow_lt_peer_index() != ERROR_CODE_SUCCESS)) {
+            return ERROR_CODE_NO_SPACE;
+        }
+        struct lt_peer_entry *entries = g_lt_peer_index.entries;
+        if (pos < g_lt_peer_index.count) {
+            (void)memmove_s(&entries[pos + 1], (g_lt_peer_index.capacity - pos - 1) * sizeof(struct lt_peer_entry),
+                &entries[pos], (g_lt_peer_index.count - pos) * sizeof(struct lt_peer_entry));
+        }
+        g_lt_peer_index.count++;
+    }
+    struct lt_peer_entry *entry = &g_lt_peer_index.entries[pos];
+    (void)memset_s(entry, sizeof(*entry), 0, sizeof(*entry));
+    (void)memcpy_s(entry->alias.key_alias, HC_KEY_ALIAS_MAX_LEN, alias->data, alias->size);
+    entry->alias.length = alias->size;
+    (void)memcpy_s(entry->auth_id.auth_id, HC_AUTH_ID_BUFF_LEN, auth_id->auth_id, auth_id->length);
+    entry->auth_id.length = auth_id->length;
+    entry->key_type = *key_type;
+    return ERROR_CODE_SUCCESS;
+}
+
+static void remove_lt_peer(const struct HksBlob *alias)
+{
+    bool is_found = false;
+    uint32_t pos = search_lt_peer(alias, &is_found);
+    if (!is_found) {
+        return;
+    }
+    struct lt_peer_entry *entries = g_lt_peer_index.entries;
+    if (pos + 1 < g_lt_peer_index.count) {
+        (void)memmove_s(&entries[pos], (g_lt_peer_index.capacity - pos) * sizeof(struct lt_peer_entry),
+            &entries[pos + 1], (g_lt_peer_index.count - pos - 1) * sizeof(struct lt_peer_entry));
+    }
+    g_lt_peer_index.count--;
+    (void)memset_s(&entries[g_lt_peer_index.count], sizeof(struct lt_peer_entry), 0, sizeof(struct lt_peer_entry));
+}
+
+static void free_key_info_list(struct HksKeyInfo *key_info_list, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i) {
+        safe_free(key_info_list[i].alias.data);
+        safe_free(key_info_list[i].paramSet);
+    }
+    FREE(key_info_list);
+}
+
+/* enumerate all the keys of the keystore, the list grows until it holds them all */
+static int32_t get_all_key_info(struct HksKeyInfo **out_list, uint32_t *out_len, uint32_t *out_count)
+{
+    uint32_t len = HC_PUB_KEY_ALIAS_MAX_NUM;
+    while (len <= LT_PEER_LOAD_MAX_NUM) {
+        struct HksKeyInfo *key_info_list = (struct HksKeyInfo *)MALLOC(len * sizeof(struct HksKeyInfo));
+        if (key_info_list == NULL) {
+            LOGE("Malloc for key info list failed");
+            return ERROR_CODE_NO_SPACE;
+        }
+        int32_t status = init_key_info_list(key_info_list, (int32_t)len);
+        uint32_t count = len;
+        if (status == ERROR_CODE_SUCCESS) {
+            status = HksGetKeyInfoList(NULL, key_info_list, &count);
+        }
+        if ((status == ERROR_CODE_SUCCESS) && (count < len)) {
+            *out_list = key_info_list;
+            *out_len = len;
+            *out_count = count;
+            return ERROR_CODE_SUCCESS;
+        }
+        free_key_info_list(key_info_list, len);
+        if ((status != ERROR_CODE_SUCCESS) && (status != HKS_ERROR_BUFFER_TOO_SMALL)) {
+            LOGE("Huks get key info list failed, status=%d", status);
+            return ERROR_CODE_FAILED;
+        }
+        len *= 2; /* 2: the list may be full, try again with a larger one */
+    }
+    LOGE("Too many keys in the keystore");
+    return ERROR_CODE_FAILED;
+}
+
+static int32_t load_lt_peer_index(void)
+{
+    struct HksKeyInfo *key_info_list = NULL;
+    uint32_t len = 0;
+    uint32_t count = 0;
+    int32_t status = get_all_key_info(&key_info_list, &len, &count);
+    if (status != ERROR_CODE_SUCCESS) {
+        return status;
+    }
+    clear_lt_peer_index();
+    for (uint32_t i = 0; i < count; i++) {
+        struct HksParam *key_flag_param = NULL;
+        if (HksGetParam(key_info_list[i].paramSet, HKS_TAG_KEY_FLAG, &key_flag_param) != ERROR_CODE_SUCCESS) {
+            LOGE("get key flag from param set failed");
+            continue;
+        }
+        if (key_flag_param->uint32Param == HKS_KEY_FLAG_GENERATE_KEY) {
+            continue;
+        }
+        struct huks_key_type key_type;
+        struct hc_auth_id auth_id;
+        if (inner_get_lt_info_by_key_info(&key_info_list[i], &key_type, &auth_id) != ERROR_CODE_SUCCESS) {
+            continue;
+        }
+        status = add_lt_peer(&key_info_list[i].alias, &key_type, &auth_id);
+        if (status == ERROR_CODE_NO_SPACE) {
+            break;
+        }
+        status = ERROR_CODE_SUCCESS;
+    }
+    free_key_info_list(key_info_list, len);
+    if (status != ERROR_CODE_SUCCESS) {
+        clear_lt_peer_index();
+        return status;
+    }
+    g_lt_peer_index.is_loaded = true;
+    LOGI("Load lt peer index, count: %u", g_lt_peer_index.count);
+    return ERROR_CODE_SUCCESS;
+}
+
+static int32_t ensure_lt_peer_index(void)
+{
+    if (g_lt_peer_index.is_loaded) {
+        return ERROR_CODE_SUCCESS;
+    }
+    return load_lt_peer_index();
+}
+
+static const struct lt_peer_entry *find_lt_peer(struct hc_key_alias *key_alias)
+{
+    if (ensure_lt_peer_index() != ERROR_CODE_SUCCESS) {
+        return NULL;
+    }
+    struct HksBlob alias_blob = convert_to_blob_from_hc_key_alias(key_alias);
+    bool is_found = false;
+    uint32_t pos = search_lt_peer(&alias_blob, &is_found);
+    return is_found ? &g_lt_peer_index.entries[pos] : NULL;
+}
+
 int32_t delete_key(struct hc_key_alias *key_alias)
 {
     check_ptr_return_val(key_alias, HC_INPUT_ERROR);
@@ -973,6 +1204,9 @@ int32_t delete_key(struct hc_key_alias *key_alias)
         LOGE("Delete key failed, status=%d", hks_status);
         return ERROR_CODE_FAILED;
     }
+    if (g_lt_peer_index.is_loaded) {
+        remove_lt_peer(&key_alias_blob);
+    }
 
     return ERROR_CODE_SUCCESS;
 }
@@ -993,18 +1227,24 @@ int32_t delete_lt_public_key(struct hc_key_alias *key_alias)
     return hks_status;
 }
 
-static int32_t init_import_lt_public_key_param_set(struct HksParamSet **param_set,
-    const int32_t user_type, const int32_t pair_type, struct hc_auth_id *auth_id)
+static uint32_t get_lt_public_key_role(const int32_t user_type, const int32_t pair_type)
 {
-#if !(defined(_SUPPORT_SEC_CLONE_) || defined(_SUPPORT_SEC_CLONE_SERVER_))
+#if (defined(_SUPPORT_SEC_CLONE_) || defined(_SUPPORT_SEC_CLONE_SERVER_))
+    (void)pair_type;
+    return (uint32_t)user_type;
+#else
     union huks_key_type_union huks_key_type;
     huks_key_type.type_struct.user_type = (uint8_t)user_type;
     huks_key_type.type_struct.pair_type = (uint8_t)pair_type;
     huks_key_type.type_struct.reserved1 = (uint8_t)0;
     huks_key_type.type_struct.reserved2 = (uint8_t)0;
+    return huks_key_type.key_type;
 #endif
+}
 
-    (void)pair_type;
+static int32_t init_import_lt_public_key_param_set(struct HksParamSet **param_set,
+    const int32_t user_type, const int32_t pair_type, struct hc_auth_id *auth_id)
+{
     struct HksParam key_param[] = {
         {
             .tag = HKS_TAG_ALGORITHM,
@@ -1025,23 +1265,13 @@ static int32_t init_import_lt_public_key_param_set(struct HksParamSet **param_se
             .tag = HKS_TAG_IS_ALLOWED_WRAP,
             .boolParam = true
         },
-#if (defined(_SUPPORT_SEC_CLONE_) || defined(_SUPPORT_SEC_CLONE_SERVER_))
-        {
-            .tag = HKS_TAG_PURPOSE,
-            .uint32Param = HKS_KEY_PURPOSE_VERIFY
-        }, {
-            .tag = HKS_TAG_KEY_ROLE,
-            .uint32Param = user_type
-        }
-#else
         {
             .tag = HKS_TAG_PURPOSE,
             .uint32Param = HKS_KEY_PURPOSE_VERIFY
         }, {
             .tag = HKS_TAG_KEY_ROLE,
-            .uint32Param = (uint32_t)huks_key_type.key_type
+            .uint32Param = get_lt_public_key_role(user_type, pair_type)
         }
-#endif
     };
 
     return construct_param_set(param_set, key_param, array_size(key_param));
@@ -1080,8 +1310,16 @@ int32_t import_lt_public_key(struct hc_key_alias *key_alias, struct ltpk *peer_p
     }
 
     status = HksImportKey(&key_alias_blob, param_set, &ltpk_key_blob);
-
     HksFreeParamSet(&param_set);
+    if ((status == ERROR_CODE_SUCCESS) && g_lt_peer_index.is_loaded) {
+        union huks_key_type_union key_type_union;
+        key_type_union.key_type = get_lt_public_key_role(user_type, pair_type);
+        if (add_lt_peer(&key_alias_blob, &key_type_union.type_struct, auth_id) != ERROR_CODE_SUCCESS) {
+            /* load it again from the keystore on the next use */
+            LOGW("Add lt peer to index failed");
+            clear_lt_peer_index();
+        }
+    }
     return status;
 }
 
@@ -1176,69 +1414,21 @@ static int32_t inner_get_lt_info_by_key_info(struct HksKeyInfo *key_info,
     return status;
 }
 
-static int32_t inner_get_lt_info_by_key_alias(struct HksBlob *key_alias,
-    struct huks_key_type *out_key_type, struct hc_auth_id *out_auth_id)
-{
-    struct HksParamSet *output_param_set = (struct HksParamSet *)MALLOC(DEFAULT_PARAM_SET_OUT_SIZE);
-    if (output_param_set == NULL) {
-        LOGE("allocate space for param set out failed");
-        return ERROR_CODE_FAILED;
-    }
-    (void)memset_s(output_param_set, DEFAULT_PARAM_SET_OUT_SIZE, 0, DEFAULT_PARAM_SET_OUT_SIZE);
-    output_param_set->paramSetSize = DEFAULT_PARAM_SET_OUT_SIZE;
-
-    int32_t status = HksGetKeyParamSet(key_alias, NULL, output_param_set);
-    if (status != ERROR_CODE_SUCCESS) {
-        LOGE("Get huks key param set failed");
-        goto get_key_info_free;
-    }
-
-    status = HksFreshParamSet(output_param_set, false);
-    if (status != ERROR_CODE_SUCCESS) {
-        LOGE("fresh param set failed, status:%d", status);
-        goto get_key_info_free;
-    }
-
-    struct HksParam *key_role = NULL;
-    status = HksGetParam(output_param_set, HKS_TAG_KEY_ROLE, &key_role);
-    if (status != ERROR_CODE_SUCCESS) {
-        LOGE("get key role from param set failed, status:%d", status);
-        goto get_key_info_free;
-    }
-
-    union huks_key_type_union key_type_union;
-    key_type_union.key_type = key_role->uint32Param;
-    out_key_type->user_type = key_type_union.type_struct.user_type;
-    out_key_type->pair_type = key_type_union.type_struct.pair_type;
-    out_key_type->reserved1 = key_type_union.type_struct.reserved1;
-    out_key_type->reserved2 = key_type_union.type_struct.reserved2;
-
-    struct HksParam *auth_id = NULL;
-    status = HksGetParam(output_param_set, HKS_TAG_KEY_AUTH_ID, &auth_id);
-    if (status != ERROR_CODE_SUCCESS) {
-        LOGE("get auth id from param set failed, status:%d", status);
-        goto get_key_info_free;
-    }
-
-    if (memcpy_s(out_auth_id->auth_id, HC_AUTH_ID_BUFF_LEN, auth_id->blob.data, auth_id->blob.size) != EOK) {
-        LOGE("Copy key param failed");
-        goto get_key_info_free;
-    }
-    out_auth_id->length = auth_id->blob.size;
-
-get_key_info_free:
-    safe_free(output_param_set);
-    return status;
-}
-
 int32_t get_lt_key_info(struct hc_key_alias *alias, struct huks_key_type *out_key_type, struct hc_auth_id *out_auth_id)
 {
     check_ptr_return_val(alias, HC_INPUT_ERROR);
     check_ptr_return_val(out_key_type, HC_INPUT_ERROR);
     check_ptr_return_val(out_auth_id, HC_INPUT_ERROR);
+    check_num_return_val(alias->length, HC_INPUT_ERROR);
 
-    struct HksBlob alias_blob = convert_to_blob_from_hc_key_alias(alias);
-    return inner_get_lt_info_by_key_alias(&alias_blob, out_key_type, out_auth_id);
+    const struct lt_peer_entry *entry = find_lt_peer(alias);
+    if (entry == NULL) {
+        LOGI("Lt public key is not found");
+        return ERROR_CODE_FAILED;
+    }
+    *out_key_type = entry->key_type;
+    *out_auth_id = entry->auth_id;
+    return ERROR_CODE_SUCCESS;
 }
 
 int32_t check_key_alias_is_owner(struct hc_key_alias *key_alias)
@@ -1246,76 +1436,28 @@ int32_t check_key_alias_is_owner(struct hc_key_alias *key_alias)
     check_ptr_return_val(key_alias, HC_INPUT_ERROR);
     check_num_return_val(key_alias->length, HC_INPUT_ERROR);
 
-    int32_t error_code = check_lt_public_key_exist(key_alias);
-    if (error_code != ERROR_CODE_SUCCESS) {
+    const struct lt_peer_entry *entry = find_lt_peer(key_alias);
+    if (entry == NULL) {
         LOGE("Key is not exist");
-        return error_code;
-    }
-
-    struct huks_key_type key_type;
-    struct hc_auth_id auth_id;
-
-    struct HksBlob key_alias_blob = convert_to_blob_from_hc_key_alias(key_alias);
-    error_code = inner_get_lt_info_by_key_alias(&key_alias_blob, &key_type, &auth_id);
-    if (error_code != ERROR_CODE_SUCCESS) {
-        LOGE("Get key info failed");
-        return error_code;
+        return ERROR_CODE_FAILED;
     }
 
-    if (key_type.user_type != (uint8_t)HC_USER_TYPE_CONTROLLER) {
+    if (entry->key_type.user_type != (uint8_t)HC_USER_TYPE_CONTROLLER) {
         return ERROR_CODE_FAILED;
     }
-    if (key_type.pair_type == (uint8_t)HC_PAIR_TYPE_BIND) {
+    if (entry->key_type.pair_type == (uint8_t)HC_PAIR_TYPE_BIND) {
         return ERROR_CODE_SUCCESS;
     } else {
         return ERROR_CODE_FAILED;
     }
 }
 
-static uint32_t load_lt_public_key_list(const struct hc_auth_id *owner_id, int32_t trust_user_type,
-    struct HksKeyInfo *key_info_list, uint32_t list_count, struct hc_auth_id *out_auth_list)
+uint32_t get_lt_public_key_num(void)
 {
-    uint8_t pair_type = owner_id == NULL ? (uint8_t)HC_PAIR_TYPE_BIND : (uint8_t)HC_PAIR_TYPE_AUTH;
-    uint8_t user_type = (uint8_t)trust_user_type;
-    int32_t err_code;
-    struct huks_key_type key_type;
-    struct hc_auth_id auth_id;
-    uint32_t effect_count = 0;
-
-    if ((trust_user_type < 0) || (trust_user_type >= HC_MAX_KEY_TYPE_NUM)) {
-        return effect_count;
-    }
-    for (uint32_t i = 0; i < list_count; i++) {
-        struct HksParam *key_flag_param = NULL;
-        int32_t status = HksGetParam(key_info_list[i].paramSet, HKS_TAG_KEY_FLAG, &key_flag_param);
-        if (status != ERROR_CODE_SUCCESS) {
-            LOGE("get key flag from param set failed, status:%d", status);
-            return ERROR_CODE_FAILED;
-        }
-        if (key_flag_param->uint32Param == HKS_KEY_FLAG_GENERATE_KEY) {
-            continue;
-        }
-        err_code = inner_get_lt_info_by_key_info(&key_info_list[i], &key_type, &auth_id);
-        if (err_code != ERROR_CODE_SUCCESS) {
-            continue;
-        }
-        if (key_type.user_type != user_type) {
-            continue;
-        }
-        if (user_type == (uint8_t)HC_USER_TYPE_CONTROLLER) {
-            if (key_type.pair_type != pair_type) {
-                continue;
-            }
-        }
-        if (memcpy_s(out_auth_list[effect_count].auth_id, HC_AUTH_ID_BUFF_LEN,
-                     auth_id.auth_id, auth_id.length) != EOK) {
-            LOGE("Copy from temp hc_auth_id to out_auth_list failed");
-            continue;
-        }
-        out_auth_list[effect_count].length = auth_id.length;
-        effect_count++;
+    if (ensure_lt_peer_index() != ERROR_CODE_SUCCESS) {
+        return 0;
     }
-    return effect_count;
+    return g_lt_peer_index.count;
 }
 
 int32_t get_lt_public_key_list(const struct hc_auth_id *owner_auth_id, int32_t trust_user_type,
@@ -1323,36 +1465,37 @@ int32_t get_lt_public_key_list(const struct hc_auth_id *owner_auth_id, int32_t t
 {
     check_ptr_return_val(out_auth_list, HC_INPUT_ERROR);
     check_ptr_return_val(out_count, HC_INPUT_ERROR);
-
-    int32_t error_code = ERROR_CODE_SUCCESS;
-    struct HksKeyInfo key_info_list[HC_PUB_KEY_ALIAS_MAX_NUM];
-    int32_t status = init_key_info_list(key_info_list, HC_PUB_KEY_ALIAS_MAX_NUM);
-    if (status != ERROR_CODE_SUCCESS) {
-        LOGE("Init key info list failed, status=%d", status);
-        error_code = ERROR_CODE_FAILED;
-        goto exit;
+    if ((trust_user_type < 0) || (trust_user_type >= HC_MAX_KEY_TYPE_NUM)) {
+        *out_count = 0;
+        return ERROR_CODE_SUCCESS;
     }
-
-    uint32_t list_count = HC_PUB_KEY_ALIAS_MAX_NUM;
-    status = HksGetKeyInfoList(NULL, key_info_list, &list_count);
-    if (status != ERROR_CODE_SUCCESS) {
-        LOGE("Huks get pub key info list failed, status=%d", status);
-        error_code = ERROR_CODE_FAILED;
-        goto exit;
+    if (ensure_lt_peer_index() != ERROR_CODE_SUCCESS) {
+        LOGE("Load lt peer index failed");
+        return ERROR_CODE_FAILED;
     }
 
-    /* filter with trust_user_type */
-    uint32_t effect_count = load_lt_public_key_list(owner_auth_id, trust_user_type, key_info_list,
-                                                    list_count, out_auth_list);
+    uint8_t pair_type = owner_auth_id == NULL ? (uint8_t)HC_PAIR_TYPE_BIND : (uint8_t)HC_PAIR_TYPE_AUTH;
+    uint8_t user_type = (uint8_t)trust_user_type;
+    uint32_t capacity = *out_count;
+    uint32_t effect_count = 0;
+    for (uint32_t i = 0; i < g_lt_peer_index.count; i++) {
+        const struct lt_peer_entry *entry = &g_lt_peer_index.entries[i];
+        if (entry->key_type.user_type != user_type) {
+            continue;
+        }
+        if ((user_type == (uint8_t)HC_USER_TYPE_CONTROLLER) && (entry->key_type.pair_type != pair_type)) {
+            continue;
+        }
+        if (effect_count == capacity) {
+            LOGW("The list is full, the other peers are not listed");
+            break;
+        }
+        out_auth_list[effect_count] = entry->auth_id;
+        effect_count++;
+    }
     /* output param */
     *out_count = effect_count;
-
-exit:
-    for (int32_t i = 0; i < HC_PUB_KEY_ALIAS_MAX_NUM; ++i) {
-        safe_free(key_info_list[i].alias.data);
-        safe_free(key_info_list[i].paramSet);
-    }
-    return error_code;
+    return ERROR_CODE_SUCCESS;
 }
 
 static int32_t gen_sign_key_param_set(struct HksParamSet **param_set)
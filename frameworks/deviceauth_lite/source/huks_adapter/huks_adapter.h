@@ -150,12 +150,20 @@ int32_t check_key_alias_is_owner(struct hc_key_alias *key_alias);
  */
 int32_t get_lt_key_info(struct hc_key_alias *alias, struct huks_key_type *out_key_type, struct hc_auth_id *out_auth_id);
 
+/*
+ * Get the number of imported and stored ed25519 public keys of all the types
+ *
+ * @return the number of the keys, it is enough for the list of any type
+ */
+uint32_t get_lt_public_key_num(void);
+
 /*
  * Query the list of imported and stored ed25519 public keys
  *
  * @param owner_auth_id: input null, output binding list;input owner, output auth list;other ,output null
  * @param trust_user_type: the public key alias
- * @return 0 -- exist, others -- not exist
+ * @param out_count: input the capacity of out_auth_list, output the number of listed auth ids
+ * @return 0 -- success, others -- failed
  */
 int32_t get_lt_public_key_list(const struct hc_auth_id *owner_auth_id, int32_t trust_user_type,
     struct hc_auth_id *out_auth_list, uint32_t *out_count);
@@ -14,6 +14,8 @@
  */
 
 #include "deviceauth_test.h"
+#include <deque>
+#include <string>
 #include <gtest/gtest.h>
 #include <securec.h>
 #include "hichain.h"
@@ -25,6 +27,10 @@ using namespace testing::ext;
 
 namespace {
 const int KEY_LEN = 32;
+const uint32_t TRUST_SERVER_SESSION_ID = 0;
+const uint32_t TRUST_CLIENT_SESSION_ID = 1;
+const int32_t TRUST_PUMP_MAX_ROUND = 32;
+const int32_t TRUST_INVALID_USER_TYPE = 2;
 
 class DeviceAuthTest : public testing::Test {
 public:
@@ -48,6 +54,22 @@ static struct session_identity g_serverIdentity = {
 static struct hc_pin g_testPin = {strlen("123456789012345"), "123456789012345"};
 static struct hc_auth_id g_testClientAuthId = {strlen("authClient"), "authClient"};
 static struct hc_auth_id g_testServerAuthId = {strlen("authServer"), "authServer"};
+static struct hc_auth_id g_testUnknownAuthId = {strlen("authUnknown"), "authUnknown"};
+
+static struct session_identity g_trustServerIdentity = {
+    TRUST_SERVER_SESSION_ID,
+    {strlen("testTrust"), "testTrust"},
+    {strlen("testTrust"), "testTrust"},
+    0
+};
+static struct session_identity g_trustClientIdentity = {
+    TRUST_CLIENT_SESSION_ID,
+    {strlen("testTrust"), "testTrust"},
+    {strlen("testTrust"), "testTrust"},
+    0
+};
+static deque<string> g_trustPending[TRUST_CLIENT_SESSION_ID + 1];
+static int32_t g_trustResult[TRUST_CLIENT_SESSION_ID + 1];
 
 static void Transmit(const struct session_identity *identity, const void *data, uint32_t length)
 {
@@ -96,6 +118,75 @@ static int32_t ConfirmReceiveRequest(const struct session_identity *identity, in
     return HC_OK;
 }
 
+/* messages of one side are queued for the other, so the sides run one after another */
+static void TrustTransmit(const struct session_identity *identity, const void *data, uint32_t length)
+{
+    LOG("--------TrustTransmit--------");
+    LOG("identity session_id[%d] length[%d]", identity->session_id, length);
+    uint32_t peer = (identity->session_id == TRUST_SERVER_SESSION_ID) ?
+        TRUST_CLIENT_SESSION_ID : TRUST_SERVER_SESSION_ID;
+    g_trustPending[peer].push_back(string((const char *)data, length));
+    LOG("--------TrustTransmit--------");
+}
+
+static void TrustGetProtocolParams(const struct session_identity *identity, int32_t operationCode,
+    struct hc_pin *pin, struct operation_parameter *para)
+{
+    LOG("--------TrustGetProtocolParams--------");
+    LOG("identity session_id[%d] operationCode[%d]", identity->session_id, operationCode);
+    *pin = g_testPin;
+    if (identity->session_id == TRUST_SERVER_SESSION_ID) {
+        para->self_auth_id = g_testServerAuthId;
+        para->peer_auth_id = g_testClientAuthId;
+    } else {
+        para->self_auth_id = g_testClientAuthId;
+        para->peer_auth_id = g_testServerAuthId;
+    }
+    para->key_length = KEY_LEN;
+    LOG("--------TrustGetProtocolParams--------");
+}
+
+static void TrustSetServiceResult(const struct session_identity *identity, int32_t result)
+{
+    LOG("--------TrustSetServiceResult--------");
+    LOG("identity session_id[%d] result[%d]", identity->session_id, result);
+    g_trustResult[identity->session_id] = result;
+    LOG("--------TrustSetServiceResult--------");
+}
+
+static void PumpTrustMessages(hc_handle server, hc_handle client)
+{
+    for (int32_t round = 0; round < TRUST_PUMP_MAX_ROUND; round++) {
+        uint32_t dest = g_trustPending[TRUST_SERVER_SESSION_ID].empty() ?
+            TRUST_CLIENT_SESSION_ID : TRUST_SERVER_SESSION_ID;
+        if (g_trustPending[dest].empty()) {
+            return;
+        }
+        string message = g_trustPending[dest].front();
+        g_trustPending[dest].pop_front();
+        struct uint8_buff data = {
+            (uint8_t *)message.data(),
+            (uint32_t)message.size(),
+            (uint32_t)message.size()
+        };
+        (void)receive_data((dest == TRUST_SERVER_SESSION_ID) ? server : client, &data);
+    }
+}
+
+static bool IsListedPeer(hc_handle handle, int32_t userType, const struct hc_auth_id *authId)
+{
+    struct hc_auth_id peers[HC_PUB_KEY_ALIAS_MAX_NUM];
+    struct hc_auth_id *list = peers;
+    uint32_t count = list_trust_peers(handle, userType, NULL, &list);
+    for (uint32_t i = 0; i < count; i++) {
+        if ((peers[i].length == authId->length) &&
+            (memcmp(peers[i].auth_id, authId->auth_id, authId->length) == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static HWTEST_F(DeviceAuthTest, Test001, TestSize.Level2)
 {
     LOG("--------DeviceAuthTest Test001--------");
@@ -150,4 +241,82 @@ static HWTEST_F(DeviceAuthTest, Test003, TestSize.Level2)
     destroy(&server);
     LOG("--------DeviceAuthTest Test003--------");
 }
+
+static HWTEST_F(DeviceAuthTest, Test004, TestSize.Level2)
+{
+    LOG("--------DeviceAuthTest Test004--------");
+    LOG("--------trusted peer index of an unknown peer--------");
+    struct hc_call_back callBack = {
+        Transmit,
+        GetProtocolParams,
+        SetSessionKey,
+        SetServiceResult,
+        ConfirmReceiveRequest
+    };
+    hc_handle server = get_instance(&g_serverIdentity, HC_ACCESSORY, &callBack);
+    ASSERT_TRUE(server != NULL);
+    struct hc_user_info userInfo = {g_testUnknownAuthId, HC_USER_TYPE_CONTROLLER};
+    /* the first query loads the index, the second one is answered from it */
+    EXPECT_EQ(is_trust_peer(server, &userInfo), HC_NOT_TRUST_PEER);
+    EXPECT_EQ(is_trust_peer(server, &userInfo), HC_NOT_TRUST_PEER);
+    EXPECT_FALSE(IsListedPeer(server, HC_USER_TYPE_CONTROLLER, &g_testUnknownAuthId));
+
+    struct hc_auth_id peers[HC_PUB_KEY_ALIAS_MAX_NUM];
+    struct hc_auth_id *list = peers;
+    EXPECT_EQ(list_trust_peers(server, TRUST_INVALID_USER_TYPE, NULL, &list), 0u);
+    EXPECT_EQ(list_trust_peers(server, HC_USER_TYPE_CONTROLLER, &g_testUnknownAuthId, &list), 0u);
+
+    /* deleting a peer that was never imported leaves the index usable */
+    EXPECT_EQ(delete_local_auth_info(server, &userInfo), HC_OK);
+    EXPECT_EQ(is_trust_peer(server, &userInfo), HC_NOT_TRUST_PEER);
+    destroy(&server);
+    LOG("--------DeviceAuthTest Test004--------");
+}
+
+static HWTEST_F(DeviceAuthTest, Test005, TestSize.Level2)
+{
+    LOG("--------DeviceAuthTest Test005--------");
+    LOG("--------trusted peer index after bind and delete--------");
+    struct hc_call_back callBack = {
+        TrustTransmit,
+        TrustGetProtocolParams,
+        SetSessionKey,
+        TrustSetServiceResult,
+        ConfirmReceiveRequest
+    };
+    g_trustResult[TRUST_SERVER_SESSION_ID] = END_FAILED;
+    g_trustResult[TRUST_CLIENT_SESSION_ID] = END_FAILED;
+    hc_handle server = get_instance(&g_trustServerIdentity, HC_ACCESSORY, &callBack);
+    hc_handle client = get_instance(&g_trustClientIdentity, HC_CENTRE, &callBack);
+    ASSERT_TRUE(server != NULL);
+    ASSERT_TRUE(client != NULL);
+    struct hc_user_info clientInfo = {g_testClientAuthId, HC_USER_TYPE_CONTROLLER};
+    struct hc_user_info serverInfo = {g_testServerAuthId, HC_USER_TYPE_ACCESSORY};
+    /* the keystore outlives the test, drop what an earlier run that stopped half way may have left */
+    (void)delete_local_auth_info(server, &clientInfo);
+    (void)delete_local_auth_info(client, &serverInfo);
+    /* load the indexes before the bind, so the bind has to update them */
+    EXPECT_EQ(is_trust_peer(server, &clientInfo), HC_NOT_TRUST_PEER);
+    EXPECT_EQ(is_trust_peer(client, &serverInfo), HC_NOT_TRUST_PEER);
+
+    const struct operation_parameter params = {g_testClientAuthId, g_testServerAuthId, KEY_LEN};
+    EXPECT_EQ(start_pake(client, &params), HC_OK);
+    PumpTrustMessages(server, client);
+    EXPECT_EQ(g_trustResult[TRUST_SERVER_SESSION_ID], END_SUCCESS);
+    EXPECT_EQ(g_trustResult[TRUST_CLIENT_SESSION_ID], END_SUCCESS);
+    EXPECT_NE(is_trust_peer(server, &clientInfo), HC_NOT_TRUST_PEER);
+    EXPECT_EQ(is_trust_peer(client, &serverInfo), HC_ACCESSORY_TRUST_PEER);
+    EXPECT_TRUE(IsListedPeer(server, HC_USER_TYPE_CONTROLLER, &g_testClientAuthId));
+    EXPECT_TRUE(IsListedPeer(client, HC_USER_TYPE_ACCESSORY, &g_testServerAuthId));
+
+    EXPECT_EQ(delete_local_auth_info(server, &clientInfo), HC_OK);
+    EXPECT_EQ(delete_local_auth_info(client, &serverInfo), HC_OK);
+    EXPECT_EQ(is_trust_peer(server, &clientInfo), HC_NOT_TRUST_PEER);
+    EXPECT_EQ(is_trust_peer(client, &serverInfo), HC_NOT_TRUST_PEER);
+    EXPECT_FALSE(IsListedPeer(server, HC_USER_TYPE_CONTROLLER, &g_testClientAuthId));
+    EXPECT_FALSE(IsListedPeer(client, HC_USER_TYPE_ACCESSORY, &g_testServerAuthId));
+    destroy(&server);
+    destroy(&client);
+    LOG("--------DeviceAuthTest Test005--------");
+}
 }
@@ -15,6 +15,7 @@
 
 #include "ipc_adapt.h"
 #include "common_defs.h"
+#include "hc_hash_map.h"
 #include "hc_log.h"
 #include "hc_types.h"
 #include "ipc_callback_proxy.h"
@@ -33,6 +34,7 @@ namespace {
     static const int32_t BUFF_MAX_SZ = 128;
     static const int32_t IPC_CALL_BACK_MAX_NODES = 64;
     static const int32_t IPC_CALL_BACK_STUB_NODES = 2;
+    static const int32_t IPC_CALL_BACK_ADD_TRY_TIMES = 2;
 }
 
 static sptr<StubDevAuthCb> g_sdkCbStub[IPC_CALL_BACK_STUB_NODES] = { nullptr, nullptr };
@@ -56,7 +58,51 @@ static struct {
     IpcCallBackNode *ctx;
     int32_t nodeCnt;
 } g_ipcCallBackList = {nullptr, 0};
+
+/*
+ * The registry lock guards the node array, the indexes and the free list, and is only held for the
+ * lookups and the updates. Each node also has its own lock, which is held while its remote object is
+ * called and while the node is changed, so the callbacks of different requests run in parallel.
+ * The node lock is always taken before the registry lock.
+ */
 static std::mutex g_cbListLock;
+static std::mutex g_cbNodeLock[IPC_CALL_BACK_MAX_NODES];
+/* changed each time a node is reset, to find out a node reused while its lock was waited for */
+static uint32_t g_cbNodeVersion[IPC_CALL_BACK_MAX_NODES] = { 0 };
+static int32_t g_freeNodeIdx[IPC_CALL_BACK_MAX_NODES];
+static int32_t g_freeNodeNum = 0;
+static HcHashMap g_appIdIndex;
+static HcHashMap g_reqIdIndex;
+
+typedef struct {
+    int64_t requestId;
+    int32_t cbType;
+    int32_t reserved;
+} IpcReqIdKey;
+
+typedef struct {
+    int32_t cbType;
+    char appId[BUFF_MAX_SZ];
+} IpcAppIdKey;
+
+static uint32_t BuildAppIdKey(const char *appId, int32_t type, IpcAppIdKey &key)
+{
+    size_t appIdLen = strlen(appId);
+    if ((appIdLen == 0) || (appIdLen >= sizeof(key.appId))) {
+        return 0;
+    }
+    key.cbType = type;
+    if (memcpy_s(key.appId, sizeof(key.appId), appId, appIdLen) != EOK) {
+        return 0;
+    }
+    return static_cast<uint32_t>(sizeof(key.cbType) + appIdLen);
+}
+
+static IpcReqIdKey BuildReqIdKey(int64_t reqId, int32_t type)
+{
+    IpcReqIdKey key = { reqId, type, 0 };
+    return key;
+}
 
 static void SetIpcCallBackNodeDefault(IpcCallBackNode &node)
 {
@@ -71,6 +117,7 @@ int32_t InitIpcCallBackList(void)
     int32_t i;
 
     LOGI("initializing ...");
+    std::lock_guard<std::mutex> autoLock(g_cbListLock);
     if (g_ipcCallBackList.ctx != nullptr) {
         LOGI("has initialized");
         return HC_SUCCESS;
@@ -81,14 +128,31 @@ int32_t InitIpcCallBackList(void)
         LOGE("initialized failed");
         return HC_ERROR;
     }
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
+    g_appIdIndex = CreateHashMap(IPC_CALL_BACK_MAX_NODES);
+    g_reqIdIndex = CreateHashMap(IPC_CALL_BACK_MAX_NODES);
+    /* pushed backwards, so that the nodes are taken in the index order */
+    g_freeNodeNum = 0;
+    for (i = IPC_CALL_BACK_MAX_NODES - 1; i >= 0; i--) {
         SetIpcCallBackNodeDefault(g_ipcCallBackList.ctx[i]);
+        g_freeNodeIdx[g_freeNodeNum++] = i;
     }
     g_ipcCallBackList.nodeCnt = 0;
     LOGI("initialized successful");
     return HC_SUCCESS;
 }
 
+static void RemoveIpcCallBackIndex(const IpcCallBackNode &node)
+{
+    IpcAppIdKey appIdKey;
+    uint32_t appIdKeyLen = BuildAppIdKey(node.appId, node.cbType, appIdKey);
+    if (appIdKeyLen > 0) {
+        (void)HashMapRemove(&g_appIdIndex, &appIdKey, appIdKeyLen, &node);
+    }
+    IpcReqIdKey reqIdKey = BuildReqIdKey(node.requestId, node.cbType);
+    (void)HashMapRemove(&g_reqIdIndex, &reqIdKey, sizeof(reqIdKey), &node);
+}
+
+/* Called with the node lock and the registry lock held. */
 static void ResetIpcCallBackNode(IpcCallBackNode &node)
 {
     char errStr[] = "invalid";
@@ -98,6 +162,13 @@ static void ResetIpcCallBackNode(IpcCallBackNode &node)
     }
     LOGI("appid is %s ", appId);
     ServiceDevAuth::ResetRemoteObject(node.proxyId);
+    int32_t nodeIdx = node.nodeIdx;
+    if (nodeIdx >= 0) {
+        RemoveIpcCallBackIndex(node);
+        g_cbNodeVersion[nodeIdx]++;
+        g_freeNodeIdx[g_freeNodeNum++] = nodeIdx;
+        g_ipcCallBackList.nodeCnt--;
+    }
     SetIpcCallBackNodeDefault(node);
     return;
 }
@@ -106,14 +177,19 @@ void DeInitIpcCallBackList(void)
 {
     int32_t i;
 
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        return;
-    }
     for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
+        std::lock_guard<std::mutex> nodeLock(g_cbNodeLock[i]);
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        if (g_ipcCallBackList.ctx == nullptr) {
+            return;
+        }
         ResetIpcCallBackNode(g_ipcCallBackList.ctx[i]);
     }
-    delete g_ipcCallBackList.ctx;
+    std::lock_guard<std::mutex> autoLock(g_cbListLock);
+    DestroyHashMap(&g_appIdIndex);
+    DestroyHashMap(&g_reqIdIndex);
+    g_freeNodeNum = 0;
+    delete[] g_ipcCallBackList.ctx;
     g_ipcCallBackList.ctx = nullptr;
     return;
 }
@@ -124,6 +200,7 @@ void ResetIpcCallBackNodeByNodeId(int32_t nodeIdx)
     if ((nodeIdx < 0) || (nodeIdx >= IPC_CALL_BACK_MAX_NODES)) {
         return;
     }
+    std::lock_guard<std::mutex> nodeLock(g_cbNodeLock[nodeIdx]);
     std::lock_guard<std::mutex> autoLock(g_cbListLock);
     if (g_ipcCallBackList.ctx == nullptr) {
         return;
@@ -133,35 +210,113 @@ void ResetIpcCallBackNodeByNodeId(int32_t nodeIdx)
     return;
 }
 
+/* Called with the registry lock held. */
 static IpcCallBackNode *GetIpcCallBackByAppId(const char *appId, int32_t type)
 {
-    int32_t i;
-    int32_t ret;
+    IpcAppIdKey key;
 
     LOGI("appid: %s", appId);
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].appId[0] == 0) {
-            continue;
-        }
-        ret = strcmp(g_ipcCallBackList.ctx[i].appId, appId);
-        if ((ret == 0) && (g_ipcCallBackList.ctx[i].cbType == type)) {
-            return &g_ipcCallBackList.ctx[i];
-        }
+    uint32_t keyLen = BuildAppIdKey(appId, type, key);
+    if (keyLen == 0) {
+        return nullptr;
     }
-    return nullptr;
+    return static_cast<IpcCallBackNode *>(HashMapGet(&g_appIdIndex, &key, keyLen));
 }
 
+/* Called with the registry lock held. */
+static IpcCallBackNode *GetIpcCallBackByReqId(int64_t reqId, int32_t type)
+{
+    IpcReqIdKey key = BuildReqIdKey(reqId, type);
+    return static_cast<IpcCallBackNode *>(HashMapGet(&g_reqIdIndex, &key, sizeof(key)));
+}
+
+/* Called with the registry lock held, the node is indexed by AddIpcCallBackIndex when it is set. */
 static IpcCallBackNode *GetFreeIpcCallBackNode(void)
 {
-    int32_t i;
+    if (g_freeNodeNum <= 0) {
+        return nullptr;
+    }
+    int32_t nodeIdx = g_freeNodeIdx[--g_freeNodeNum];
+    g_ipcCallBackList.ctx[nodeIdx].nodeIdx = nodeIdx;
+    g_ipcCallBackList.nodeCnt++;
+    return &g_ipcCallBackList.ctx[nodeIdx];
+}
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if ((g_ipcCallBackList.ctx[i].appId[0] == 0) && (g_ipcCallBackList.ctx[i].cbType == 0)) {
-            g_ipcCallBackList.ctx[i].nodeIdx = i;
-            return &g_ipcCallBackList.ctx[i];
+static bool AddIpcCallBackIndex(IpcCallBackNode &node)
+{
+    IpcAppIdKey appIdKey;
+    uint32_t appIdKeyLen = BuildAppIdKey(node.appId, node.cbType, appIdKey);
+    if ((appIdKeyLen > 0) && !HashMapPut(&g_appIdIndex, &appIdKey, appIdKeyLen, &node)) {
+        return false;
+    }
+    IpcReqIdKey reqIdKey = BuildReqIdKey(node.requestId, node.cbType);
+    if (!HashMapPut(&g_reqIdIndex, &reqIdKey, sizeof(reqIdKey), &node)) {
+        if (appIdKeyLen > 0) {
+            (void)HashMapRemove(&g_appIdIndex, &appIdKey, appIdKeyLen, &node);
         }
+        return false;
     }
-    return nullptr;
+    return true;
+}
+
+/*
+ * Take the lock of a node found with the registry lock held. The node may have been reset while the
+ * lock was waited for, in which case nullptr is returned. The registry lock is not held on return.
+ */
+static IpcCallBackNode *LockIpcCallBackNode(int32_t nodeIdx, uint32_t version)
+{
+    g_cbNodeLock[nodeIdx].lock();
+    std::lock_guard<std::mutex> autoLock(g_cbListLock);
+    if ((g_ipcCallBackList.ctx == nullptr) || (g_cbNodeVersion[nodeIdx] != version)) {
+        g_cbNodeLock[nodeIdx].unlock();
+        return nullptr;
+    }
+    return &g_ipcCallBackList.ctx[nodeIdx];
+}
+
+
+/* The node array is only freed by DeInitIpcCallBackList, which takes every node lock first. */
+static void UnlockIpcCallBackNode(const IpcCallBackNode *node)
+{
+    g_cbNodeLock[node - g_ipcCallBackList.ctx].unlock();
+}
+
+static IpcCallBackNode *LockIpcCallBackByAppId(const char *appId, int32_t type)
+{
+    int32_t nodeIdx;
+    uint32_t version;
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        if (g_ipcCallBackList.ctx == nullptr) {
+            return nullptr;
+        }
+        IpcCallBackNode *node = GetIpcCallBackByAppId(appId, type);
+        if (node == nullptr) {
+            return nullptr;
+        }
+        nodeIdx = node->nodeIdx;
+        version = g_cbNodeVersion[nodeIdx];
+    }
+    return LockIpcCallBackNode(nodeIdx, version);
+}
+
+static IpcCallBackNode *LockIpcCallBackByReqId(int64_t reqId, int32_t type)
+{
+    int32_t nodeIdx;
+    uint32_t version;
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        if (g_ipcCallBackList.ctx == nullptr) {
+            return nullptr;
+        }
+        IpcCallBackNode *node = GetIpcCallBackByReqId(reqId, type);
+        if (node == nullptr) {
+            return nullptr;
+        }
+        nodeIdx = node->nodeIdx;
+        version = g_cbNodeVersion[nodeIdx];
+    }
+    return LockIpcCallBackNode(nodeIdx, version);
 }
 
 static void SetCbDeathRecipient(int32_t type, int32_t objIdx, int32_t cbDataIdx)
@@ -174,235 +329,229 @@ static void SetCbDeathRecipient(int32_t type, int32_t objIdx, int32_t cbDataIdx)
 
 void AddIpcCbObjByAppId(const char *appId, int32_t objIdx, int32_t type)
 {
-    IpcCallBackNode *node = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("list not inited");
-        return;
-    }
-
-    if (g_ipcCallBackList.nodeCnt >= IPC_CALL_BACK_MAX_NODES) {
-        LOGE("list is full");
+    IpcCallBackNode *node = LockIpcCallBackByAppId(appId, type);
+    if (node == nullptr) {
+        LOGE("ipc callback node not found, appid: %s", appId);
         return;
     }
-
-    node = GetIpcCallBackByAppId(appId, type);
-    if (node != nullptr) {
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
         node->proxyId = objIdx;
-        SetCbDeathRecipient(type, objIdx, node->nodeIdx);
-        LOGI("ipc object add success, appid: %s, proxyId %d", appId, node->proxyId);
     }
+    SetCbDeathRecipient(type, objIdx, node->nodeIdx);
+    LOGI("ipc object add success, appid: %s, proxyId %d", appId, node->proxyId);
+    UnlockIpcCallBackNode(node);
     return;
 }
 
-int32_t AddIpcCallBackByAppId(const char *appId, const uint8_t *cbPtr, int32_t cbSz, int32_t type)
+/* Replace the callback of an existing node, the remote object of the old callback is released. */
+static int32_t UpdateIpcCallBack(IpcCallBackNode *node, const uint8_t *cbPtr, int32_t cbSz)
 {
-    IpcCallBackNode *node = nullptr;
-    errno_t eno;
-
     std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("list not inited");
-        return HC_ERROR;
-    }
-
-    if (g_ipcCallBackList.nodeCnt >= IPC_CALL_BACK_MAX_NODES) {
-        LOGE("list is full");
+    errno_t eno = memcpy_s(&(node->cbCtx), sizeof(node->cbCtx), cbPtr, cbSz);
+    if (eno != EOK) {
+        LOGE("callback context memory copy failed");
         return HC_ERROR;
     }
-
-    node = GetIpcCallBackByAppId(appId, type);
-    if (node != nullptr) {
-        eno = memcpy_s(&(node->cbCtx), sizeof(node->cbCtx), cbPtr, cbSz);
-        if (eno != EOK) {
-            LOGE("callback context memory copy failed");
-            return HC_ERROR;
-        }
-        if (node->proxyId >= 0) {
-            ServiceDevAuth::ResetRemoteObject(node->proxyId);
-            node->proxyId = -1;
-        }
-        LOGI("callback add success, appid: %s", appId);
-        return HC_SUCCESS;
+    if (node->proxyId >= 0) {
+        ServiceDevAuth::ResetRemoteObject(node->proxyId);
+        node->proxyId = -1;
     }
+    return HC_SUCCESS;
+}
 
-    LOGI("new callback to add, appid: %s", appId);
-    node = GetFreeIpcCallBackNode();
+/* Called with the registry lock held, the node is only visible to the lookups once it is indexed. */
+static int32_t AddNewIpcCallBackNode(const char *appId, int64_t reqId, const uint8_t *cbPtr, int32_t cbSz,
+    int32_t type)
+{
+    IpcCallBackNode *node = GetFreeIpcCallBackNode();
     if (node == nullptr) {
         LOGE("get free node failed");
         return HC_ERROR;
     }
     node->cbType = type;
-    eno = memcpy_s(&(node->appId), sizeof(node->appId), appId, strlen(appId) + 1);
-    if (eno != EOK) {
+    node->requestId = reqId;
+    node->delOnFni = (appId == nullptr) ? 1 : 0;
+    if ((appId != nullptr) &&
+        (memcpy_s(&(node->appId), sizeof(node->appId), appId, strlen(appId) + 1) != EOK)) {
         ResetIpcCallBackNode(*node);
         LOGE("appid memory copy failed");
         return HC_ERROR;
     }
-    eno = memcpy_s(&(node->cbCtx), sizeof(node->cbCtx), cbPtr, cbSz);
-    if (eno != EOK) {
+    if (memcpy_s(&(node->cbCtx), sizeof(node->cbCtx), cbPtr, cbSz) != EOK) {
         ResetIpcCallBackNode(*node);
         LOGE("callback context memory copy failed");
         return HC_ERROR;
     }
     node->proxyId = -1;
-    g_ipcCallBackList.nodeCnt++;
-    LOGI("callback add success, appid: %s, type %d", node->appId, node->cbType);
+    if (!AddIpcCallBackIndex(*node)) {
+        ResetIpcCallBackNode(*node);
+        LOGE("callback index add failed");
+        return HC_ERROR;
+    }
     return HC_SUCCESS;
 }
 
-void DelIpcCallBackByAppId(const char *appId, int32_t type)
+int32_t AddIpcCallBackByAppId(const char *appId, const uint8_t *cbPtr, int32_t cbSz, int32_t type)
 {
-    IpcCallBackNode *node = nullptr;
+    int32_t ret;
 
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if ((g_ipcCallBackList.nodeCnt <= 0) || (g_ipcCallBackList.ctx == nullptr)) {
-        return;
-    }
+    /* tried again if the same callback is added by another thread meanwhile */
+    for (int32_t i = 0; i < IPC_CALL_BACK_ADD_TRY_TIMES; i++) {
+        IpcCallBackNode *node = LockIpcCallBackByAppId(appId, type);
+        if (node != nullptr) {
+            ret = UpdateIpcCallBack(node, cbPtr, cbSz);
+            UnlockIpcCallBackNode(node);
+            if (ret == HC_SUCCESS) {
+                LOGI("callback add success, appid: %s", appId);
+            }
+            return ret;
+        }
 
-    node = GetIpcCallBackByAppId(appId, type);
-    if (node != nullptr) {
-        ResetIpcCallBackNode(*node);
-        g_ipcCallBackList.nodeCnt--;
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        if (g_ipcCallBackList.ctx == nullptr) {
+            LOGE("list not inited");
+            return HC_ERROR;
+        }
+        if (GetIpcCallBackByAppId(appId, type) != nullptr) {
+            continue;
+        }
+        LOGI("new callback to add, appid: %s", appId);
+        ret = AddNewIpcCallBackNode(appId, 0, cbPtr, cbSz, type);
+        if (ret == HC_SUCCESS) {
+            LOGI("callback add success, appid: %s, type %d", appId, type);
+        }
+        return ret;
     }
-    return;
+    return HC_ERROR;
 }
 
-static IpcCallBackNode *GetIpcCallBackByReqId(int64_t reqId, int32_t type)
+void DelIpcCallBackByAppId(const char *appId, int32_t type)
 {
-    int32_t i;
-
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if ((reqId == g_ipcCallBackList.ctx[i].requestId) &&
-            (g_ipcCallBackList.ctx[i].cbType == type)) {
-            return &g_ipcCallBackList.ctx[i];
-        }
+    IpcCallBackNode *node = LockIpcCallBackByAppId(appId, type);
+    if (node == nullptr) {
+        return;
     }
-    return nullptr;
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        ResetIpcCallBackNode(*node);
+    }
+    UnlockIpcCallBackNode(node);
+    return;
 }
 
 int32_t AddReqIdByAppId(const char *appId, int64_t reqId)
 {
-    IpcCallBackNode *node = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("ipc callback list not inited");
-        return HC_ERROR;
-    }
-
-    node = GetIpcCallBackByAppId(appId, CB_TYPE_DEV_AUTH);
+    IpcCallBackNode *node = LockIpcCallBackByAppId(appId, CB_TYPE_DEV_AUTH);
     if (node == nullptr) {
         LOGE("ipc callback node not found, appid: %s", appId);
         return HC_ERROR;
     }
-    node->requestId = reqId;
-    node->delOnFni = 0;
+    int32_t ret = HC_SUCCESS;
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        IpcReqIdKey newKey = BuildReqIdKey(reqId, node->cbType);
+        IpcReqIdKey oldKey = BuildReqIdKey(node->requestId, node->cbType);
+        if (HashMapPut(&g_reqIdIndex, &newKey, sizeof(newKey), node)) {
+            (void)HashMapRemove(&g_reqIdIndex, &oldKey, sizeof(oldKey), node);
+            node->requestId = reqId;
+            node->delOnFni = 0;
+        } else {
+            ret = HC_ERROR;
+        }
+    }
+    UnlockIpcCallBackNode(node);
+    if (ret != HC_SUCCESS) {
+        LOGE("request id index add failed, appid: %s", appId);
+        return ret;
+    }
     LOGI("success, appid: %s, requestId: %lld", appId, (long long)reqId);
     return HC_SUCCESS;
 }
 
 void AddIpcCbObjByReqId(int64_t reqId, int32_t objIdx, int32_t type)
 {
-    IpcCallBackNode *node = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("list not inited");
-        return;
-    }
-
-    if (g_ipcCallBackList.nodeCnt >= IPC_CALL_BACK_MAX_NODES) {
-        LOGE("list is full");
+    IpcCallBackNode *node = LockIpcCallBackByReqId(reqId, type);
+    if (node == nullptr) {
+        LOGE("ipc callback node not found, request id %lld, type %d", (long long)reqId, type);
         return;
     }
-
-    node = GetIpcCallBackByReqId(reqId, type);
-    if (node != nullptr) {
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
         node->proxyId = objIdx;
-        LOGI("ipc object add success, request id %lld, type %d, proxy id %d",
-            (long long)reqId, type, node->proxyId);
     }
+    LOGI("ipc object add success, request id %lld, type %d, proxy id %d", (long long)reqId, type, objIdx);
+    UnlockIpcCallBackNode(node);
     return;
 }
 
 int32_t AddIpcCallBackByReqId(int64_t reqId, const uint8_t *cbPtr, int32_t cbSz, int32_t type)
 {
-    IpcCallBackNode *node = nullptr;
-    errno_t eno;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("list is full");
-        return HC_ERROR;
-    }
+    int32_t ret;
 
-    if (g_ipcCallBackList.nodeCnt >= IPC_CALL_BACK_MAX_NODES) {
-        LOGE("list is full");
-        return HC_ERROR;
-    }
+    /* tried again if the same callback is added by another thread meanwhile */
+    for (int32_t i = 0; i < IPC_CALL_BACK_ADD_TRY_TIMES; i++) {
+        IpcCallBackNode *node = LockIpcCallBackByReqId(reqId, type);
+        if (node != nullptr) {
+            ret = UpdateIpcCallBack(node, cbPtr, cbSz);
+            UnlockIpcCallBackNode(node);
+            if (ret == HC_SUCCESS) {
+                LOGI("callback added success, request id %lld, type %d", (long long)reqId, type);
+            }
+            return ret;
+        }
 
-    node = GetIpcCallBackByReqId(reqId, type);
-    if (node != nullptr) {
-        eno = memcpy_s(&(node->cbCtx), sizeof(node->cbCtx), cbPtr, cbSz);
-        if (eno != EOK) {
-            LOGE("callback context memory copy failed");
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        if (g_ipcCallBackList.ctx == nullptr) {
+            LOGE("list not inited");
             return HC_ERROR;
         }
-        if (node->proxyId >= 0) {
-            ServiceDevAuth::ResetRemoteObject(node->proxyId);
-            node->proxyId = -1;
+        if (GetIpcCallBackByReqId(reqId, type) != nullptr) {
+            continue;
         }
-        LOGI("callback added success, request id %lld, type %d", (long long)reqId, type);
-        return HC_SUCCESS;
-    }
-
-    LOGI("new callback to add, request id %lld, type %d", (long long)reqId, type);
-    node = GetFreeIpcCallBackNode();
-    if (node == nullptr) {
-        LOGE("get free node failed");
-        return HC_ERROR;
-    }
-    node->cbType = type;
-    node->requestId = reqId;
-    eno = memcpy_s(&(node->cbCtx), sizeof(node->cbCtx), cbPtr, cbSz);
-    if (eno != EOK) {
-        ResetIpcCallBackNode(*node);
-        LOGE("callback context memory copy failed");
-        return HC_ERROR;
+        LOGI("new callback to add, request id %lld, type %d", (long long)reqId, type);
+        ret = AddNewIpcCallBackNode(nullptr, reqId, cbPtr, cbSz, type);
+        if (ret == HC_SUCCESS) {
+            LOGI("callback added success, request id %lld, type %d", (long long)reqId, type);
+        }
+        return ret;
     }
-    node->delOnFni = 1;
-    node->proxyId = -1;
-    g_ipcCallBackList.nodeCnt++;
-    LOGI("callback added success, request id %lld, type %d", (long long)reqId, type);
-    return HC_SUCCESS;
+    return HC_ERROR;
 }
 
-static void DelCallBackByReqId(int64_t reqId, int32_t type)
+/* Called with the node lock held, the node is freed if it was added for the request only. */
+static void DelCallBackNodeOnFinish(IpcCallBackNode *node)
 {
-    IpcCallBackNode *node = nullptr;
-
-    if ((g_ipcCallBackList.nodeCnt <= 0) || (g_ipcCallBackList.ctx == nullptr)) {
-        return;
-    }
-
-    node = GetIpcCallBackByReqId(reqId, type);
-    if ((node != nullptr) && (node->delOnFni == 1)) {
+    std::lock_guard<std::mutex> autoLock(g_cbListLock);
+    if (node->delOnFni == 1) {
         ResetIpcCallBackNode(*node);
-        g_ipcCallBackList.nodeCnt--;
     }
     return;
 }
 
 void DelIpcCallBackByReqId(int64_t reqId, int32_t type, bool withLock)
 {
+    IpcCallBackNode *node = nullptr;
+
     if (withLock) {
-        std::lock_guard<std::mutex> autoLock(g_cbListLock);
-        DelCallBackByReqId(reqId, type);
+        node = LockIpcCallBackByReqId(reqId, type);
+        if (node != nullptr) {
+            DelCallBackNodeOnFinish(node);
+            UnlockIpcCallBackNode(node);
+        }
         return;
     }
-    DelCallBackByReqId(reqId, type);
+    /* the caller holds the node lock */
+    {
+        std::lock_guard<std::mutex> autoLock(g_cbListLock);
+        if (g_ipcCallBackList.ctx == nullptr) {
+            return;
+        }
+        node = GetIpcCallBackByReqId(reqId, type);
+    }
+    if (node != nullptr) {
+        DelCallBackNodeOnFinish(node);
+    }
     return;
 }
 
@@ -675,12 +824,6 @@ static bool GaCbOnTransmitWithType(int64_t requestId, const uint8_t *data, uint3
     IpcCallBackNode *node = nullptr;
 
     LOGI("starting ... request id: %lld, type %d", (long long)requestId, type);
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    node = GetIpcCallBackByReqId(requestId, type);
-    if (node == nullptr) {
-        LOGE("onTransmit hook is null, request id %lld", (long long)requestId);
-        return false;
-    }
     uRet = EncodeCallData(dataParcel, PARAM_TYPE_REQID,
         reinterpret_cast<const uint8_t *>(&requestId), sizeof(requestId));
     uRet |= EncodeCallData(dataParcel, PARAM_TYPE_COMM_DATA, data, dataLen);
@@ -688,8 +831,14 @@ static bool GaCbOnTransmitWithType(int64_t requestId, const uint8_t *data, uint3
         LOGE("build trans data failed");
         return false;
     }
+    node = LockIpcCallBackByReqId(requestId, type);
+    if (node == nullptr) {
+        LOGE("onTransmit hook is null, request id %lld", (long long)requestId);
+        return false;
+    }
     ServiceDevAuth::ActCallback(node->proxyId, CB_ID_ON_TRANS, true,
         reinterpret_cast<uintptr_t>(node->cbCtx.devAuth.onTransmit), dataParcel, reply);
+    UnlockIpcCallBackNode(node);
     LOGI("process done, request id: %lld", (long long)requestId);
     if (reply.ReadInt32(ret) && (ret == HC_SUCCESS)) {
         return true;
@@ -715,21 +864,20 @@ static void GaCbOnSessionKeyRetWithType(int64_t requestId, const uint8_t *sessKe
     IpcCallBackNode *node = nullptr;
 
     LOGI("starting ... request id: %lld, type %d", (long long)requestId, type);
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    node = GetIpcCallBackByReqId(requestId, type);
-    if (node == nullptr) {
-        LOGE("onSessionKeyReturned hook is null, request id %lld", (long long)requestId);
-        return;
-    }
-
     ret = EncodeCallData(dataParcel, PARAM_TYPE_REQID, reinterpret_cast<uint8_t *>(&requestId), sizeof(requestId));
     ret |= EncodeCallData(dataParcel, PARAM_TYPE_SESS_KEY, sessKey, sessKeyLen);
     if (ret != HC_SUCCESS) {
         LOGE("build trans data failed");
         return;
     }
+    node = LockIpcCallBackByReqId(requestId, type);
+    if (node == nullptr) {
+        LOGE("onSessionKeyReturned hook is null, request id %lld", (long long)requestId);
+        return;
+    }
     ServiceDevAuth::ActCallback(node->proxyId, CB_ID_SESS_KEY_DONE, false,
         reinterpret_cast<uintptr_t>(node->cbCtx.devAuth.onSessionKeyReturned), dataParcel, reply);
+    UnlockIpcCallBackNode(node);
     LOGI("process done, request id: %lld", (long long)requestId);
     return;
 }
@@ -754,12 +902,6 @@ static void GaCbOnFinishWithType(int64_t requestId, int32_t operationCode, const
     IpcCallBackNode *node = nullptr;
 
     LOGI("starting ... request id: %lld, type %d", (long long)requestId, type);
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    node = GetIpcCallBackByReqId(requestId, type);
-    if (node == nullptr) {
-        LOGE("onFinish hook is null, request id %lld", (long long)requestId);
-        return;
-    }
     ret = EncodeCallData(dataParcel, PARAM_TYPE_REQID, reinterpret_cast<uint8_t *>(&requestId), sizeof(requestId));
     ret |= EncodeCallData(dataParcel, PARAM_TYPE_OPCODE,
         reinterpret_cast<uint8_t *>(&operationCode), sizeof(operationCode));
@@ -769,10 +911,16 @@ static void GaCbOnFinishWithType(int64_t requestId, int32_t operationCode, const
         LOGE("build trans data failed");
         return;
     }
+    node = LockIpcCallBackByReqId(requestId, type);
+    if (node == nullptr) {
+        LOGE("onFinish hook is null, request id %lld", (long long)requestId);
+        return;
+    }
     ServiceDevAuth::ActCallback(node->proxyId, CB_ID_ON_FINISH, false,
         reinterpret_cast<uintptr_t>(node->cbCtx.devAuth.onFinish), dataParcel, reply);
     /* delete request id */
-    DelIpcCallBackByReqId(requestId, type, false);
+    DelCallBackNodeOnFinish(node);
+    UnlockIpcCallBackNode(node);
     LOGI("process done, request id: %lld", (long long)requestId);
     return;
 }
@@ -798,12 +946,6 @@ static void GaCbOnErrorWithType(int64_t requestId, int32_t operationCode,
     IpcCallBackNode *node = nullptr;
 
     LOGI("starting ... request id: %lld, type %d", (long long)requestId, type);
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    node = GetIpcCallBackByReqId(requestId, type);
-    if (node == nullptr) {
-        LOGE("onError hook is null, request id %lld", (long long)requestId);
-        return;
-    }
     ret = EncodeCallData(dataParcel, PARAM_TYPE_REQID, reinterpret_cast<uint8_t *>(&requestId), sizeof(requestId));
     ret |= EncodeCallData(dataParcel, PARAM_TYPE_OPCODE,
         reinterpret_cast<uint8_t *>(&operationCode), sizeof(operationCode));
@@ -816,10 +958,16 @@ static void GaCbOnErrorWithType(int64_t requestId, int32_t operationCode,
         LOGE("build trans data failed");
         return;
     }
+    node = LockIpcCallBackByReqId(requestId, type);
+    if (node == nullptr) {
+        LOGE("onError hook is null, request id %lld", (long long)requestId);
+        return;
+    }
     ServiceDevAuth::ActCallback(node->proxyId, CB_ID_ON_ERROR, false,
         reinterpret_cast<uintptr_t>(node->cbCtx.devAuth.onError), dataParcel, reply);
     /* delete request id */
-    DelIpcCallBackByReqId(requestId, type, false);
+    DelCallBackNodeOnFinish(node);
+    UnlockIpcCallBackNode(node);
     LOGI("process done, request id: %lld", (long long)requestId);
     return;
 }
@@ -846,13 +994,6 @@ static char *GaCbOnRequestWithType(int64_t requestId, int32_t operationCode, con
     IpcCallBackNode *node = nullptr;
 
     LOGI("starting ... request id: %lld, type %d", (long long)requestId, type);
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    node = GetIpcCallBackByReqId(requestId, type);
-    if (node == nullptr) {
-        LOGE("onRequest hook is null, request id %lld", (long long)requestId);
-        return nullptr;
-    }
-
     uRet = EncodeCallData(dataParcel, PARAM_TYPE_REQID, reinterpret_cast<uint8_t *>(&requestId), sizeof(requestId));
     uRet |= EncodeCallData(dataParcel, PARAM_TYPE_OPCODE,
         reinterpret_cast<uint8_t *>(&operationCode), sizeof(operationCode));
@@ -864,9 +1005,14 @@ static char *GaCbOnRequestWithType(int64_t requestId, int32_t operationCode, con
         LOGE("build trans data failed");
         return nullptr;
     }
-
+    node = LockIpcCallBackByReqId(requestId, type);
+    if (node == nullptr) {
+        LOGE("onRequest hook is null, request id %lld", (long long)requestId);
+        return nullptr;
+    }
     ServiceDevAuth::ActCallback(node->proxyId, CB_ID_ON_REQUEST, true,
         reinterpret_cast<uintptr_t>(node->cbCtx.devAuth.onRequest), dataParcel, reply);
+    UnlockIpcCallBackNode(node);
     if (reply.ReadInt32(ret) && (ret == HC_SUCCESS)) {
         if (reply.GetReadableBytes() == 0) {
             LOGE("onRequest has no data, but success");
@@ -883,6 +1029,9 @@ static char *GaCbOnRequestWithType(int64_t requestId, int32_t operationCode, con
 static bool CanFindCbByReqId(int64_t requestId)
 {
     std::lock_guard<std::mutex> autoLock(g_cbListLock);
+    if (g_ipcCallBackList.ctx == nullptr) {
+        return false;
+    }
     IpcCallBackNode *node = GetIpcCallBackByReqId(requestId, CB_TYPE_DEV_AUTH);
     return (node != NULL) ? true : false;
 }
@@ -915,19 +1064,45 @@ static char *TmpIpcGaCbOnRequest(int64_t requestId, int32_t operationCode, const
     return GaCbOnRequestWithType(requestId, operationCode, reqParams, CB_TYPE_TMP_DEV_AUTH);
 }
 
+/*
+ * Call a hook of every listener. The registry lock is only held to find a listener node, and the node
+ * lock is held across the call, so a slow listener does not block the other callbacks.
+ */
+template <typename GetHook>
+static void ActListenerCallBack(int32_t callbackId, MessageParcel &dataParcel, GetHook getHook)
+{
+    MessageParcel reply;
+    for (int32_t i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
+        uint32_t version;
+        {
+            std::lock_guard<std::mutex> autoLock(g_cbListLock);
+            if (g_ipcCallBackList.ctx == nullptr) {
+                LOGE("IpcCallBackList un-initialized");
+                return;
+            }
+            if (g_ipcCallBackList.ctx[i].cbType != CB_TYPE_LISTENER) {
+                continue;
+            }
+            version = g_cbNodeVersion[i];
+        }
+        IpcCallBackNode *node = LockIpcCallBackNode(i, version);
+        if (node == nullptr) {
+            continue;
+        }
+        uintptr_t hook = getHook(node->cbCtx.listener);
+        if (hook == 0) {
+            LOGE("The listener hook is null, callbackId: %d", callbackId);
+        } else {
+            ServiceDevAuth::ActCallback(node->proxyId, callbackId, false, hook, dataParcel, reply);
+        }
+        UnlockIpcCallBackNode(node);
+    }
+}
+
 void IpcOnGroupCreated(const char *groupInfo)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     if (groupInfo == nullptr) {
         LOGE("IpcOnGroupCreated, params error");
@@ -941,33 +1116,16 @@ void IpcOnGroupCreated(const char *groupInfo)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onGroupCreated == nullptr) {
-                LOGE("onGroupCreated hook is invalid");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_GROUP_CREATED,
-                false, reinterpret_cast<uintptr_t>(listener->onGroupCreated), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_GROUP_CREATED, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onGroupCreated);
+    });
     return;
 }
 
 void IpcOnGroupDeleted(const char *groupInfo)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     if (groupInfo == nullptr) {
         LOGE("IpcOnGroupDeleted, params error");
@@ -981,33 +1139,16 @@ void IpcOnGroupDeleted(const char *groupInfo)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onGroupDeleted == nullptr) {
-                LOGE("onGroupDeleted hook is null");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_GROUP_DELETED,
-                false, reinterpret_cast<uintptr_t>(listener->onGroupDeleted), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_GROUP_DELETED, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onGroupDeleted);
+    });
     return;
 }
 
 void IpcOnDeviceBound(const char *peerUdid, const char *groupInfo)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     if ((peerUdid == nullptr) || (groupInfo == nullptr)) {
         LOGE("params error");
@@ -1023,33 +1164,16 @@ void IpcOnDeviceBound(const char *peerUdid, const char *groupInfo)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onDeviceBound == nullptr) {
-                LOGE("onDeviceBound hook is null");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_DEV_BOUND,
-                false, reinterpret_cast<uintptr_t>(listener->onDeviceBound), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_DEV_BOUND, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onDeviceBound);
+    });
     return;
 }
 
 void IpcOnDeviceUnBound(const char *peerUdid, const char *groupInfo)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     if ((peerUdid == nullptr) || (groupInfo == nullptr)) {
         LOGE("params error");
@@ -1065,33 +1189,16 @@ void IpcOnDeviceUnBound(const char *peerUdid, const char *groupInfo)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onDeviceUnBound == nullptr) {
-                LOGE("onDeviceUnBound hook is null");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_DEV_UNBOUND,
-                false, reinterpret_cast<uintptr_t>(listener->onDeviceUnBound), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_DEV_UNBOUND, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onDeviceUnBound);
+    });
     return;
 }
 
 void IpcOnDeviceNotTrusted(const char *peerUdid)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     if (peerUdid == nullptr) {
         LOGE("params error");
@@ -1105,33 +1212,16 @@ void IpcOnDeviceNotTrusted(const char *peerUdid)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onDeviceNotTrusted == nullptr) {
-                LOGE("onDeviceNotTrusted hook is null");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_DEV_UNTRUSTED,
-                false, reinterpret_cast<uintptr_t>(listener->onDeviceNotTrusted), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_DEV_UNTRUSTED, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onDeviceNotTrusted);
+    });
     return;
 }
 
 void IpcOnLastGroupDeleted(const char *peerUdid, int32_t groupType)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     if (peerUdid == nullptr) {
         LOGE("params error");
@@ -1147,33 +1237,16 @@ void IpcOnLastGroupDeleted(const char *peerUdid, int32_t groupType)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onLastGroupDeleted == nullptr) {
-                LOGE("onLastGroupDeleted hook is null");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_LAST_GROUP_DELETED,
-                false, reinterpret_cast<uintptr_t>(listener->onLastGroupDeleted), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_LAST_GROUP_DELETED, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onLastGroupDeleted);
+    });
     return;
 }
 
 void IpcOnTrustedDeviceNumChanged(int32_t curTrustedDeviceNum)
 {
-    int32_t i;
     uint32_t ret;
     MessageParcel dataParcel;
-    MessageParcel reply;
-    DataChangeListener *listener = nullptr;
-
-    std::lock_guard<std::mutex> autoLock(g_cbListLock);
-    if (g_ipcCallBackList.ctx == nullptr) {
-        LOGE("IpcCallBackList un-initialized");
-        return;
-    }
 
     ret = EncodeCallData(dataParcel, PARAM_TYPE_DATA_NUM,
         reinterpret_cast<const uint8_t *>(&curTrustedDeviceNum), sizeof(curTrustedDeviceNum));
@@ -1182,17 +1255,9 @@ void IpcOnTrustedDeviceNumChanged(int32_t curTrustedDeviceNum)
         return;
     }
 
-    for (i = 0; i < IPC_CALL_BACK_MAX_NODES; i++) {
-        if (g_ipcCallBackList.ctx[i].cbType == CB_TYPE_LISTENER) {
-            listener = &(g_ipcCallBackList.ctx[i].cbCtx.listener);
-            if (listener->onTrustedDeviceNumChanged == nullptr) {
-                LOGE("onTrustedDeviceNumChanged hook is null");
-                continue;
-            }
-            ServiceDevAuth::ActCallback(g_ipcCallBackList.ctx[i].proxyId, CB_ID_ON_TRUST_DEV_NUM_CHANGED,
-                false, reinterpret_cast<uintptr_t>(listener->onTrustedDeviceNumChanged), dataParcel, reply);
-        }
-    }
+    ActListenerCallBack(CB_ID_ON_TRUST_DEV_NUM_CHANGED, dataParcel, [](const DataChangeListener &listener) {
+        return reinterpret_cast<uintptr_t>(listener.onTrustedDeviceNumChanged);
+    });
     return;
 }
 
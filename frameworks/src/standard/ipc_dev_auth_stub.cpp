@@ -274,7 +274,14 @@ void ServiceDevAuth::ResetRemoteObject(int32_t idx)
 void ServiceDevAuth::ActCallback(int32_t objIdx, int32_t callbackId, bool sync,
     uintptr_t cbHook, MessageParcel &dataParcel, MessageParcel &reply)
 {
-    if ((objIdx < 0) || (objIdx >= MAX_CBSTUB_SIZE) || (!g_cbStub[objIdx].inUse)) {
+    sptr<IRemoteObject> cbStub = nullptr;
+    if ((objIdx >= 0) && (objIdx < MAX_CBSTUB_SIZE)) {
+        std::lock_guard<std::mutex> autoLock(g_cBMutex);
+        if (g_cbStub[objIdx].inUse) {
+            cbStub = g_cbStub[objIdx].cbStub;
+        }
+    }
+    if (cbStub == nullptr) {
         LOGW("nothing to do, callback id %d, remote object id %d", callbackId, objIdx);
         return;
     }
@@ -284,8 +291,8 @@ void ServiceDevAuth::ActCallback(int32_t objIdx, int32_t callbackId, bool sync,
         option.SetFlags(MessageOption::TF_ASYNC);
         option.SetWaitTime(0);
     }
-    std::lock_guard<std::mutex> autoLock(g_cBMutex);
-    sptr<ICommIpcCallback> proxy = iface_cast<ICommIpcCallback>(g_cbStub[objIdx].cbStub);
+    /* the reference keeps the remote object alive, the call is made without the lock */
+    sptr<ICommIpcCallback> proxy = iface_cast<ICommIpcCallback>(cbStub);
     proxy->DoCallBack(callbackId, cbHook, dataParcel, reply, option);
     return;
 }
@@ -99,6 +99,20 @@ typedef int32_t (*AgreeSharedSecretFunc)(const KeyBuff *priKey, const KeyBuff *p
 typedef int32_t (*BigNumExpModFunc)(const Uint8Buff *base, const Uint8Buff *exp, const char *bigNumHex,
     Uint8Buff *outNum);
 
+/*
+ * A DL group shared by all the handshakes of the process. The modulus is decoded from its hex string
+ * once, when the group is first requested, and the context is never changed or freed after that.
+ */
+typedef struct {
+    const char *primeHex;
+    Uint8Buff prime;
+} DlGroupContext;
+
+typedef const DlGroupContext *(*GetDlGroupContextFunc)(const char *primeHex);
+
+typedef int32_t (*BigNumExpModWithContextFunc)(const Uint8Buff *base, const Uint8Buff *exp,
+    const DlGroupContext *groupCtx, Uint8Buff *outNum);
+
 typedef int32_t (*GenerateKeyPairWithStorageFunc)(const Uint8Buff *keyAlias, uint32_t keyLen, Algorithm algo,
     const ExtraInfo *exInfo);
 
@@ -145,6 +159,8 @@ typedef struct {
     CheckDlPublicKeyFunc checkDlPublicKey;
     CheckEcPublicKeyFunc checkEcPublicKey;
     BigNumCompareFunc bigNumCompare;
+    GetDlGroupContextFunc getDlGroupContext;
+    BigNumExpModWithContextFunc bigNumExpModWithContext;
 } AlgLoader;
 
 #endif
\ No newline at end of file
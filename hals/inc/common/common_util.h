@@ -54,4 +54,13 @@ int32_t ByteToHexString(const uint8_t *byte, uint32_t byteLen, char *hexStr, uin
  */
 int64_t StringToInt64(const char *cp);
 
+/*
+ * Calculate the CRC-32 (ISO-HDLC) checksum of data.
+ * @param crc: the checksum of the preceding data, 0 for the first block
+ * @param data: the data to be calculated
+ * @param len: the length of data
+ * @return the checksum of the preceding data and this block.
+ */
+uint32_t HcCrc32(uint32_t crc, const uint8_t *data, uint32_t len);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC_CRYPTO_POOL_H
+#define HC_CRYPTO_POOL_H
+
+#include "alg_defs.h"
+
+/* the number of the crypto workers, it can be set by the build, the default is zero which disables the pool */
+#ifndef CRYPTO_WORKER_NUM
+#define CRYPTO_WORKER_NUM 0
+#endif
+
+/* the max number of the pending operations of a crypto worker, it can be set by the build */
+#ifndef CRYPTO_QUEUE_CAPACITY
+#define CRYPTO_QUEUE_CAPACITY 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Called once an operation of the async loader ends, with the result of the operation of the AlgLoader.
+ * It is called on a crypto worker, or on the caller thread when the pool can't take the operation.
+ */
+typedef void (*AlgCompletionFunc)(int32_t result, void *ctx);
+
+/*
+ * The slow operations of the AlgLoader, run by the crypto workers.
+ * The arguments are the same as the ones of the AlgLoader. The input structs which are passed by pointer
+ * (Uint8Buff, KeyBuff) are copied, but the memory they point to must stay valid until onDone is called,
+ * as well as the output Uint8Buff, which gets the length of the result.
+ * @return HAL_SUCCESS (onDone is called once, maybe before the return if the workers are all busy, or with
+ *         HAL_ERR_CANCELED if the pool is stopped), others (invalid params, onDone is not called)
+ */
+typedef struct {
+    int32_t (*computeHkdf)(const Uint8Buff *baseKey, const Uint8Buff *salt, const Uint8Buff *keyInfo,
+        Uint8Buff *outHkdf, bool isAlias, AlgCompletionFunc onDone, void *ctx);
+    int32_t (*hashToPoint)(const Uint8Buff *hash, Algorithm algo, Uint8Buff *outEcPoint,
+        AlgCompletionFunc onDone, void *ctx);
+    int32_t (*agreeSharedSecret)(const KeyBuff *priKey, const KeyBuff *pubKey, Algorithm algo,
+        Uint8Buff *sharedKey, AlgCompletionFunc onDone, void *ctx);
+    int32_t (*bigNumExpMod)(const Uint8Buff *base, const Uint8Buff *exp, const char *bigNumHex,
+        Uint8Buff *outNum, AlgCompletionFunc onDone, void *ctx);
+    int32_t (*bigNumExpModWithContext)(const Uint8Buff *base, const Uint8Buff *exp,
+        const DlGroupContext *groupCtx, Uint8Buff *outNum, AlgCompletionFunc onDone, void *ctx);
+    int32_t (*sign)(const Uint8Buff *keyAlias, const Uint8Buff *message, Algorithm algo,
+        Uint8Buff *outSignature, bool isAlias, AlgCompletionFunc onDone, void *ctx);
+    int32_t (*verify)(const Uint8Buff *key, const Uint8Buff *message, Algorithm algo,
+        const Uint8Buff *signature, bool isAlias, AlgCompletionFunc onDone, void *ctx);
+} AsyncAlgLoader;
+
+/*
+ * Start the crypto workers. The operations are spread over the workers in turn, so a long operation only
+ * delays the ones queued behind it on the same worker, and never the task workers.
+ * @return HAL_SUCCESS (ok, or the pool is disabled by a zero workerNum), others (error)
+ */
+int32_t InitCryptoPool(uint32_t workerNum);
+
+/*
+ * Stop the crypto workers. The operations which are still queued are dropped, and their onDone
+ * is called with HAL_ERR_CANCELED, as well as the ones submitted after it by a caller which got the loader before.
+ * The running operations end first.
+ */
+void DestroyCryptoPool(void);
+
+/* @return the async loader, NULL if the pool is not running, the callers should use the AlgLoader then. */
+const AsyncAlgLoader *GetAsyncLoaderInstance(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
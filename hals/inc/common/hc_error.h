@@ -40,6 +40,9 @@ enum {
     HAL_ERR_BUILD_PARAM_SET_FAILED = -17,
     HAL_ERR_FRESH_PARAM_SET_FAILED = -18,
     HAL_ERR_INIT_FAILED = -19,
+    HAL_ERR_QUEUE_FULL = -20,
+    HAL_ERR_NOT_SUPPORTED = -21,
+    HAL_ERR_CANCELED = -22,
 };
 
 #endif
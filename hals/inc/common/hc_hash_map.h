@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC_HASH_MAP_H
+#define HC_HASH_MAP_H
+
+#include "hc_types.h"
+
+#define HASH_MAP_DEFAULT_BUCKET_COUNT 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HcHashNodeT {
+    struct HcHashNodeT *next;
+    void *value;
+    uint32_t hash;
+    uint32_t keyLen;
+    uint8_t key[];
+} HcHashNode;
+
+/*
+ * Chained hash map with byte-string keys and pointer values.
+ * The same key may be inserted more than once, so it can also be used as a multimap. The elements with
+ * the same key are kept in the order of insertion. The map copies the key, but does not own the value.
+ */
+typedef struct {
+    HcHashNode **buckets;
+    uint32_t bucketCount;
+    uint32_t size;
+} HcHashMap;
+
+/*
+ * Create a hash map.
+ * Notice: You should destroy the map when you don't need it anymore.
+ * @param bucketCount: the initial bucket count, 0 means the default count.
+ * @return the created map.
+ */
+HcHashMap CreateHashMap(uint32_t bucketCount);
+
+/*
+ * Destroy a hash map. The values are not freed.
+ * @param map: the map you want to destroy.
+ */
+void DestroyHashMap(HcHashMap *map);
+
+/*
+ * Remove all elements, but keep the buckets.
+ * @param map: self pointer.
+ */
+void ClearHashMap(HcHashMap *map);
+
+/*
+ * Insert a key-value pair. An existing element with the same key is not replaced.
+ * @param map: self pointer.
+ * @param key: the key data.
+ * @param keyLen: the length of the key data.
+ * @param value: the value.
+ * @return HC_TRUE (ok), HC_FALSE (error)
+ */
+HcBool HashMapPut(HcHashMap *map, const void *key, uint32_t keyLen, void *value);
+
+/*
+ * Get the value of the first inserted element with the key.
+ * @param map: self pointer.
+ * @param key: the key data.
+ * @param keyLen: the length of the key data.
+ * @return the value, or NULL if the key does not exist.
+ */
+void *HashMapGet(const HcHashMap *map, const void *key, uint32_t keyLen);
+
+/*
+ * Find the first inserted node with the key, use HashMapFindNext to visit the later ones.
+ * Notice: The map must not be modified while visiting the nodes.
+ * @return the node, or NULL if the key does not exist.
+ */
+const HcHashNode *HashMapFind(const HcHashMap *map, const void *key, uint32_t keyLen);
+const HcHashNode *HashMapFindNext(const HcHashNode *node);
+
+/*
+ * Remove the first inserted element with the key and the value.
+ * @param map: self pointer.
+ * @param key: the key data.
+ * @param keyLen: the length of the key data.
+ * @param value: the value to match, NULL matches any value.
+ * @return HC_TRUE (removed), HC_FALSE (not found)
+ */
+HcBool HashMapRemove(HcHashMap *map, const void *key, uint32_t keyLen, const void *value);
+
+uint32_t HashMapSize(const HcHashMap *map);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC_LRU_CACHE_H
+#define HC_LRU_CACHE_H
+
+#include "common_util.h"
+#include "hc_mutex.h"
+#include "hc_types.h"
+
+typedef struct {
+    uint64_t lastUse; /* 0 means the slot is empty */
+    uint32_t hash;
+    uint32_t keyLen;
+    uint32_t valueLen;
+} HcLruSlot;
+
+/*
+ * Cache of a few byte-string pairs, the least recently used one is dropped when it is full.
+ * The memory of all the slots is taken at init, so the puts don't allocate. It is meant for a few tens
+ * of entries at most, a lookup scans all the slots. The cache is thread safe.
+ */
+typedef struct {
+    HcLruSlot *slots;
+    uint8_t *data; /* the key and the value of a slot, maxKeyLen + maxValueLen bytes per slot */
+    uint32_t capacity;
+    uint32_t maxKeyLen;
+    uint32_t maxValueLen;
+    uint32_t epoch; /* bumped by every removal, see LruCachePut */
+    uint64_t clock;
+    HcMutex lock;
+} HcLruCache;
+
+/*
+ * Init a cache.
+ * @param capacity: the number of the slots.
+ * @param maxKeyLen: the longest key, the longer ones are not cached.
+ * @param maxValueLen: the longest value, the longer ones are not cached.
+ * @return HAL_SUCCESS (ok), others (error)
+ */
+int32_t InitLruCache(HcLruCache *cache, uint32_t capacity, uint32_t maxKeyLen, uint32_t maxValueLen);
+
+void DestroyLruCache(HcLruCache *cache);
+
+/*
+ * Get the value of a key and mark it as the most recently used.
+ * @param outValue: the buffer the value is copied to, its length is set to the length of the value.
+ *                  NULL only checks whether the key is cached.
+ * @return HC_TRUE (hit), HC_FALSE (miss, or the buffer is too short)
+ */
+HcBool LruCacheGet(HcLruCache *cache, const Uint8Buff *key, Uint8Buff *outValue);
+
+/*
+ * The epoch to pass to LruCachePut, it should be read before the value is computed.
+ */
+uint32_t GetLruCacheEpoch(HcLruCache *cache);
+
+/*
+ * Put a pair, an existing value of the key is replaced. Nothing is put if a key was removed since the epoch
+ * was read, so a value computed from the state before the removal can't get back into the cache.
+ */
+void LruCachePut(HcLruCache *cache, const Uint8Buff *key, const Uint8Buff *value, uint32_t epoch);
+
+void LruCacheRemove(HcLruCache *cache, const Uint8Buff *key);
+
+void ClearLruCache(HcLruCache *cache);
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC_MEM_ARENA_H
+#define HC_MEM_ARENA_H
+
+#include "hc_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The arena of the process for the short-lived memory of the tasks. While a thread is bound to the arena,
+ * HcMalloc and the json objects of deviceauth take their memory from a chunk of the arena by bumping a pointer,
+ * and HcFree of the memory only counts it down. A chunk is wiped and reused as a whole when all the memory taken
+ * from it has been freed, by any thread. The memory which outlives the task keeps its chunk until it is freed.
+ * The allocations fall back to the heap when the arena has no free chunk or the size is too large.
+ */
+
+typedef struct {
+    uint32_t chunkNum;
+    uint32_t freeChunkNum;
+    uint32_t allocNum; /* the allocations served by the arena */
+    uint32_t fallbackNum; /* the allocations of the bound threads that went to the heap */
+} HcMemArenaStat;
+
+/*
+ * Init the arena, the memory of all the chunks is taken from the system at once.
+ * @param chunkSize: the size of a chunk, a power of two.
+ * @param chunkNum: the number of the chunks, it should be a few times the number of the bound threads.
+ * @return HAL_SUCCESS (ok), HAL_ERR_NOT_SUPPORTED (no arena on the platform), others (error)
+ */
+int32_t InitMemArena(uint32_t chunkSize, uint32_t chunkNum);
+
+/*
+ * Destroy the arena, no thread may be bound to it. The memory of the chunks is given back to the system
+ * when the last allocation taken from them is freed.
+ */
+void DestroyMemArena(void);
+
+/* Bind the calling thread to the arena, it does nothing if the arena is not inited. */
+void BindMemArena(void);
+void UnbindMemArena(void);
+
+/*
+ * Allocate zeroed memory from the arena for the calling thread.
+ * @return the memory, or NULL if the thread is not bound or the arena can't serve it.
+ */
+void *MemArenaAlloc(uint32_t size);
+
+/*
+ * Give the memory back to the arena if it was taken from it, it can be called by any thread.
+ * @return HC_TRUE (the memory belongs to the arena), HC_FALSE (the memory is not from the arena)
+ */
+HcBool MemArenaFree(void *addr);
+
+HcBool IsMemArenaAddr(const void *addr);
+
+/*
+ * The cJSON hooks are global to the process, so the arena only serves the json memory allocated between
+ * EnterJsonArenaScope and LeaveJsonArenaScope, which the json wrappers of deviceauth call around the cJSON
+ * functions. The other cJSON users of the process get the heap, even on the bound threads. The calls nest.
+ * InitMemArena installs the hooks once, and no other module of the process may install cJSON hooks after
+ * that: the json memory of the arena would be freed to its allocator. The hooks are checked on every bind,
+ * and the arena serves no json any more once they are found replaced.
+ */
+void EnterJsonArenaScope(void);
+void LeaveJsonArenaScope(void);
+
+void GetMemArenaStat(HcMemArenaStat *stat);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
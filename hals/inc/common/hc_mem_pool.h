@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HC_MEM_POOL_H
+#define HC_MEM_POOL_H
+
+#include "hc_mutex.h"
+#include "hc_types.h"
+
+typedef struct HcMemSlabT {
+    struct HcMemSlabT *next;
+} HcMemSlab;
+
+/*
+ * Pool of fixed-size objects. The memory is taken from the system a slab of objects at a time,
+ * and a freed object goes back to the free list of the pool. All the slabs but one are given back
+ * to the system when the last object is freed. The pool is thread safe.
+ */
+typedef struct {
+    HcMemSlab *slabs;
+    void *freeList; /* the free objects, linked by their first word */
+    uint32_t objSize;
+    uint32_t objNumPerSlab;
+    uint32_t slabNum;
+    uint32_t usedNum;
+    HcMutex lock;
+} HcMemPool;
+
+typedef struct {
+    uint32_t usedNum; /* the number of the allocated objects */
+    uint32_t usedBytes; /* the bytes of the allocated objects */
+    uint32_t reservedBytes; /* the bytes taken from the system, including the slab heads and the free objects */
+} HcMemPoolStat;
+
+/*
+ * Init a pool, no memory is taken until the first allocation.
+ * @param objSize: the size of an object, it is rounded up to keep the objects aligned.
+ * @param objNumPerSlab: the number of the objects taken from the system at a time.
+ * @return HAL_SUCCESS (ok), others (error)
+ */
+int32_t InitMemPool(HcMemPool *pool, uint32_t objSize, uint32_t objNumPerSlab);
+
+/*
+ * Destroy a pool and give all the memory back to the system, the objects must have been freed.
+ */
+void DestroyMemPool(HcMemPool *pool);
+
+/*
+ * Allocate a zeroed object.
+ * @return the object, or NULL if there is no memory.
+ */
+void *MemPoolAlloc(HcMemPool *pool);
+
+/*
+ * Give an object allocated from the pool back to it, NULL is ignored.
+ */
+void MemPoolFree(HcMemPool *pool, void *obj);
+
+void GetMemPoolStat(HcMemPool *pool, HcMemPoolStat *stat);
+
+#endif
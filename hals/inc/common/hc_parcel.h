@@ -85,4 +85,15 @@ HcBool ParcelPopBack(HcParcel *parcel, uint32_t size);
 HcBool ParcelPopFront(HcParcel *parcel, uint32_t size);
 HcBool ParcelEraseBlock(HcParcel *parcel, uint32_t start, uint32_t data_size, void *dst);
 
+/*
+ * Make sure that the parcel can hold size bytes of data without growing.
+ * @return HC_TRUE (ok), HC_FALSE (out of memory)
+ */
+HcBool ParcelReserve(HcParcel *parcel, uint32_t size);
+
+/*
+ * Release the space which is not used by the data.
+ */
+void ParcelShrinkToFit(HcParcel *parcel);
+
 #endif
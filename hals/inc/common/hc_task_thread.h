@@ -17,7 +17,6 @@
 #define HC_TASK_THREAD_H
 
 #include "hc_thread.h"
-#include "hc_vector.h"
 
 typedef struct HcTaskBaseT {
     void (*doAction) (struct HcTaskBaseT*);
@@ -25,22 +24,40 @@ typedef struct HcTaskBaseT {
 } HcTaskBase;
 
 typedef struct {
+    uint32_t sequence;
     HcTaskBase* task;
-} HcTaskWrap;
+} HcTaskSlot;
 
-DECLARE_HC_VECTOR(TaskVec, HcTaskWrap)
+/*
+ * Bounded ring queue of tasks. Any thread may push without taking a lock, the tasks are popped by the task thread.
+ * The sequence of a slot tells whether it is free for the producer of a position or filled for the consumer,
+ * so a push is a CAS on the tail, and a pop never waits for the producers.
+ */
+typedef struct {
+    HcTaskSlot* slots;
+    uint32_t mask;
+    uint32_t head;
+    uint32_t tail;
+} HcTaskQueue;
 
 typedef struct HcTaskThreadT {
     HcThread thread;
-    TaskVec tasks;
+    HcTaskQueue tasks;
     int32_t (*startThread)(struct HcTaskThreadT* thread);
-    void (*pushTask) (struct HcTaskThreadT* thread, HcTaskBase* task);
+    /* return HAL_ERR_QUEUE_FULL if the queue is full, the task is not consumed in this case */
+    int32_t (*pushTask) (struct HcTaskThreadT* thread, HcTaskBase* task);
     void (*clear) (struct HcTaskThreadT* thread);
     void (*stopAndClear) (struct HcTaskThreadT* thread);
-    HcMutex queueLock;
+    HcMutex queueLock; /* serializes the consumers of the queue: the task thread and clear */
+    HcBool isWaiting;
     HcBool quit;
+    HcBool useMemArena; /* the tasks take their memory from the memory arena while they run */
 } HcTaskThread;
 
-int32_t InitHcTaskThread(HcTaskThread* thread, size_t stackSize, const char* threadName);
+/*
+ * Init a task thread.
+ * @param queueCapacity: the max number of the pending tasks, it is rounded up to a power of two.
+ */
+int32_t InitHcTaskThread(HcTaskThread* thread, size_t stackSize, uint32_t queueCapacity, const char* threadName);
 void DestroyHcTaskThread(HcTaskThread* thread);
 #endif
\ No newline at end of file
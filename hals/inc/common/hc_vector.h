@@ -168,5 +168,8 @@ void Destroy##ClassName(ClassName* obj) \
 #define HC_VECTOR_SIZE(obj) (obj)->size(obj)
 #define HC_VECTOR_GET(obj, index) (obj)->get((obj), (index))
 #define HC_VECTOR_GETP(_obj, _index) (_obj)->getp((_obj), (_index))
+/* reserve the space of count elements in total, or release the unused space */
+#define HC_VECTOR_RESERVE(obj, count) ParcelReserve(&(obj)->parcel, (count) * sizeof(*(obj)->getp((obj), 0)))
+#define HC_VECTOR_SHRINK(obj) ParcelShrinkToFit(&(obj)->parcel)
 
 #endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_BINARY_H
+#define JSON_BINARY_H
+
+#include "json_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The binary form of a json object for the messages between the devices. Every item is a type byte
+ * followed by its value, the lengths and the integers are varints, and the upper case hex strings
+ * made by AddByteToJson are carried as the raw bytes. The conversion is lossless, so the receiver
+ * gets back the same json object as the one sent in the text form.
+ * The first byte of the binary data can never start a json text, so both forms can be told apart.
+ */
+
+/* Need to call FreeJsonBinary to free the returned pointer when it's no longer in use. */
+uint8_t *PackJsonToBinary(const CJson *jsonObj, uint32_t *dataLen);
+void FreeJsonBinary(uint8_t *data);
+
+/* Need to call FreeJson to free the returned pointer when it's no longer in use. */
+CJson *CreateJsonFromBinary(const uint8_t *data, uint32_t dataLen);
+
+bool IsJsonBinary(const uint8_t *data, uint32_t dataLen);
+
+/*
+ * Create a json object from the data received from the peer, either in the binary form or in the text form.
+ * The text is not required to be terminated with '\0' within dataLen.
+ * Need to call FreeJson to free the returned pointer when it's no longer in use.
+ */
+CJson *CreateJsonFromData(const uint8_t *data, uint32_t dataLen);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -25,6 +25,7 @@ extern "C" {
 #define INPUT_UDID_LEN 65
 #define MAX_INPUT_UDID_LEN 200
 #define MAX_SESSION_COUNT 30
+#define MAX_SESSION_COUNT_LIMIT 4096
 
 /*
  * Get the unique device ID of the device(UDID).
@@ -37,6 +38,12 @@ int32_t HcGetUdid(uint8_t *udid, int32_t udidLen);
 
 const char *GetStoragePath();
 
+/*
+ * Get the max number of the sessions which are open at the same time.
+ * It is MAX_SESSION_COUNT unless the device overrides it, and never exceeds MAX_SESSION_COUNT_LIMIT.
+ */
+uint32_t HcGetMaxSessionCount(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,7 @@
 #define INPUT_UDID_LEN 65
 #define MAX_INPUT_UDID_LEN 200
 #define MAX_SESSION_COUNT 20
+#define MAX_SESSION_COUNT_LIMIT 20
 
 /*
  * Get the unique device ID of the device(UDID).
@@ -33,4 +34,10 @@ int32_t HcGetUdid(uint8_t *udid, int32_t udidLen);
 
 const char *GetStoragePath();
 
+/*
+ * Get the max number of the sessions which are open at the same time.
+ * It is MAX_SESSION_COUNT unless the device overrides it, and never exceeds MAX_SESSION_COUNT_LIMIT.
+ */
+uint32_t HcGetMaxSessionCount(void);
+
 #endif
\ No newline at end of file
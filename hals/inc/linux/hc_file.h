@@ -16,6 +16,8 @@
 #ifndef HC_FILE_H
 #define HC_FILE_H
 
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -27,11 +29,17 @@ typedef union {
 
 typedef enum FileIdEnumT {
     FILE_ID_GROUP = 0,
+    FILE_ID_GROUP_JOURNAL,
     FILE_ID_LAST,
 } FileIdEnum;
 
 #define MODE_FILE_READ 0
 #define MODE_FILE_WRITE 1
+#define MODE_FILE_APPEND 2
+/* write a new generation to a temporary file, which is published by HcFileCommit */
+#define MODE_FILE_WRITE_TEMP 3
+/* read the previous generation kept by HcFileCommit */
+#define MODE_FILE_READ_BACKUP 4
 
 // 0 indicates success
 // -1 indicates fail
@@ -40,7 +48,17 @@ int HcFileSize(FileHandle file);
 int HcFileRead(FileHandle file, void *dst, int dstSize);
 int HcFileWrite(FileHandle file, const void *src, int srcSize);
 void HcFileClose(FileHandle file);
+/* Flush the buffered data of a file opened for writing and sync it to the disk. */
+int HcFileSync(FileHandle file);
 void HcFileRemove(int fileId);
+/* Cut the file back to the size and sync it, it must not be open for writing. */
+int HcFileTruncate(int fileId, int size);
+/*
+ * Sync and close a file opened with MODE_FILE_WRITE_TEMP, then atomically replace the file with it.
+ * The replaced file is kept as the previous generation, unless keepBackup is set because the file failed
+ * to load and the previous generation is the last good one. The handle is closed in any case.
+ */
+int HcFileCommit(int fileId, FileHandle file, bool keepBackup);
 void SetFilePath(FileIdEnum fileId, const char *path);
 
 #ifdef __cplusplus
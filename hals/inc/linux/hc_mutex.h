@@ -32,6 +32,21 @@ typedef struct HcMutexT {
 int32_t InitHcMutex(HcMutex* mutex);
 void DestroyHcMutex(HcMutex* mutex);
 
+/*
+ * Readers share the lock, a writer holds it exclusively. A waiting writer holds the turnstile,
+ * so the readers coming after it wait, and a stream of readers can not starve the writer.
+ */
+typedef struct HcRwLockT {
+    int (*readLock)(struct HcRwLockT* rwLock);
+    int (*writeLock)(struct HcRwLockT* rwLock);
+    void (*unlock)(struct HcRwLockT* rwLock);
+    pthread_rwlock_t rwLock;
+    pthread_mutex_t turnstile;
+} HcRwLock;
+
+int32_t InitHcRwLock(HcRwLock* rwLock);
+void DestroyHcRwLock(HcRwLock* rwLock);
+
 #ifdef __cplusplus
 }
 #endif
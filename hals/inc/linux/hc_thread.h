@@ -45,6 +45,11 @@ typedef struct HcThreadT {
 int32_t InitThread(HcThread* thread, ThreadFunc func, size_t stackSize, const char* threadName);
 void DestroyThread(HcThread* thread);
 
+/* The identity of the calling thread, for a resource that is owned by a thread across calls. */
+typedef pthread_t HcThreadId;
+HcThreadId GetCurrentThreadId(void);
+HcBool IsCurrentThreadId(HcThreadId threadId);
+
 #ifdef __cplusplus
 }
 #endif
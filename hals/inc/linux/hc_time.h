@@ -25,12 +25,15 @@ extern "C" {
 /* Calculate in seconds */
 #define TIME_OUT_VALUE 600
 
-/* Return in seconds */
+/* Return the seconds of CLOCK_MONOTONIC, setting the system time doesn't move it */
 int64_t HcGetCurTime();
 
 /* Return the interval seconds from startTime to current Time */
 int64_t HcGetIntervalTime(int64_t startTime);
 
+/* Return the seconds since the epoch, it can jump when the system time is set, so it is not for the timeouts */
+int64_t HcGetRealTime();
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,7 @@
 
 #define LOGD(fmt, arg...) HILOG_DEBUG(HILOG_MODULE_SCY, fmt, ##arg)
 #define LOGI(fmt, arg...) HILOG_INFO(HILOG_MODULE_SCY, fmt, ##arg)
+#define LOGW(fmt, arg...) HILOG_WARN(HILOG_MODULE_SCY, fmt, ##arg)
 #define LOGE(fmt, arg...) HILOG_ERROR(HILOG_MODULE_SCY, fmt, ##arg)
 
 #endif
@@ -28,4 +28,15 @@ typedef struct HcMutexT {
 int32_t InitHcMutex(HcMutex* mutex);
 void DestroyHcMutex(HcMutex* mutex);
 
+/* Readers share the lock, a writer holds it exclusively. The liteos version serializes the readers too. */
+typedef struct HcRwLockT {
+    int (*readLock)(struct HcRwLockT* rwLock);
+    int (*writeLock)(struct HcRwLockT* rwLock);
+    void (*unlock)(struct HcRwLockT* rwLock);
+    pthread_mutex_t mutex;
+} HcRwLock;
+
+int32_t InitHcRwLock(HcRwLock* rwLock);
+void DestroyHcRwLock(HcRwLock* rwLock);
+
 #endif
\ No newline at end of file
@@ -32,6 +32,11 @@ typedef uint32_t HcBool;
 
 void *HcMalloc(uint32_t size, char val);
 void HcFree(void* addr);
+/*
+ * Resize the memory block, the data is kept. On failure NULL is returned and the old block is not freed.
+ * @param oldSize: the size of the old block, it is used by the platforms without realloc.
+ */
+void *HcRealloc(void *addr, uint32_t oldSize, uint32_t newSize);
 uint32_t HcStrlen(const char *str);
 
 #endif
@@ -19,12 +19,275 @@
 #include "hc_error.h"
 #include "hc_log.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HEX_CODEC_SSE2
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+/* built for the baseline, the avx2 path is taken only if the cpu has it */
+#define HEX_CODEC_AVX2
+#define HEX_CODEC_AVX2_FUNC __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HEX_CODEC_NEON
+#endif
+
 #define OUT_OF_HEX 16
-#define NUMBER_9_IN_DECIMAL 9
+#define NIBBLE_BITS 4
+#define NIBBLE_MASK 0x0F
+#define HEX_LETTER_OFFSET ('A' - '0' - 10)
+#define HEX_LOWER_CASE_BIT 0x20
+#define HEX_BLOCK_BYTES 16
+#define HEX_WIDE_BLOCK_BYTES 32
+
+/* CRC-32 of every nibble value with the reflected polynomial 0xEDB88320 */
+static const uint32_t g_crc32NibbleTable[] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static const char g_hexChars[] = "0123456789ABCDEF";
+
+/* the nibble value of every char, OUT_OF_HEX for the chars that are not hex */
+static const uint8_t g_hexCharValues[] = {
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 16, 16, 16, 16, 16,
+    16, 10, 11, 12, 13, 14, 15, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 10, 11, 12, 13, 14, 15, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16
+};
+
+/*
+ * The vector codecs below convert the whole blocks of the input and return the number of the bytes
+ * converted, the rest is left to the scalar code. A decoder stops at the first block holding a char
+ * that is not hex, so that the scalar code reports it the same way as before.
+ */
+#ifdef HEX_CODEC_SSE2
+static __m128i NibbleToHexSse2(__m128i nibble)
+{
+    __m128i isLetter = _mm_cmpgt_epi8(nibble, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nibble, _mm_set1_epi8('0')),
+        _mm_and_si128(isLetter, _mm_set1_epi8(HEX_LETTER_OFFSET)));
+}
+
+static uint32_t EncodeHexSse2(const uint8_t *byte, uint32_t byteLen, char *hexStr)
+{
+    const __m128i mask = _mm_set1_epi8(NIBBLE_MASK);
+    uint32_t i = 0;
+    for (; byteLen - i >= HEX_BLOCK_BYTES; i += HEX_BLOCK_BYTES) {
+        __m128i value = _mm_loadu_si128((const __m128i *)(byte + i));
+        __m128i high = NibbleToHexSse2(_mm_and_si128(_mm_srli_epi16(value, NIBBLE_BITS), mask));
+        __m128i low = NibbleToHexSse2(_mm_and_si128(value, mask));
+        char *out = hexStr + i * BYTE_TO_HEX_OPER_LENGTH;
+        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i *)(out + HEX_BLOCK_BYTES), _mm_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+static __m128i HexToNibbleSse2(__m128i hex, __m128i *invalid)
+{
+    __m128i lower = _mm_or_si128(hex, _mm_set1_epi8(HEX_LOWER_CASE_BIT));
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(hex, _mm_set1_epi8('0' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), hex));
+    __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    *invalid = _mm_or_si128(*invalid, _mm_andnot_si128(_mm_or_si128(isDigit, isLetter), _mm_set1_epi8(-1)));
+    return _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(hex, _mm_set1_epi8('0'))),
+        _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+/* Every 16-bit lane holds the high nibble in its low byte, it becomes the byte of the two nibbles. */
+static __m128i PackNibblesSse2(__m128i nibbles)
+{
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), NIBBLE_BITS),
+        _mm_srli_epi16(nibbles, 8)); /* 8: the low nibble is in the high byte */
+}
+
+static uint32_t DecodeHexSse2(const char *hexStr, uint8_t *byte, uint32_t byteLen)
+{
+    uint32_t i = 0;
+    for (; byteLen - i >= HEX_BLOCK_BYTES; i += HEX_BLOCK_BYTES) {
+        const char *in = hexStr + i * BYTE_TO_HEX_OPER_LENGTH;
+        __m128i invalid = _mm_setzero_si128();
+        __m128i first = HexToNibbleSse2(_mm_loadu_si128((const __m128i *)in), &invalid);
+        __m128i second = HexToNibbleSse2(_mm_loadu_si128((const __m128i *)(in + HEX_BLOCK_BYTES)), &invalid);
+        if (_mm_movemask_epi8(invalid) != 0) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(byte + i), _mm_packus_epi16(PackNibblesSse2(first), PackNibblesSse2(second)));
+    }
+    return i;
+}
+#endif
+
+#ifdef HEX_CODEC_AVX2
+static HEX_CODEC_AVX2_FUNC __m256i NibbleToHexAvx2(__m256i nibble)
+{
+    __m256i isLetter = _mm256_cmpgt_epi8(nibble, _mm256_set1_epi8(9));
+    return _mm256_add_epi8(_mm256_add_epi8(nibble, _mm256_set1_epi8('0')),
+        _mm256_and_si256(isLetter, _mm256_set1_epi8(HEX_LETTER_OFFSET)));
+}
 
-static char HexToChar(uint8_t hex)
+static HEX_CODEC_AVX2_FUNC uint32_t EncodeHexAvx2(const uint8_t *byte, uint32_t byteLen, char *hexStr)
 {
-    return (hex > NUMBER_9_IN_DECIMAL) ? (hex + 0x37) : (hex + 0x30); /* Convert to the corresponding character */
+    const __m256i mask = _mm256_set1_epi8(NIBBLE_MASK);
+    uint32_t i = 0;
+    for (; byteLen - i >= HEX_WIDE_BLOCK_BYTES; i += HEX_WIDE_BLOCK_BYTES) {
+        __m256i value = _mm256_loadu_si256((const __m256i *)(byte + i));
+        __m256i high = NibbleToHexAvx2(_mm256_and_si256(_mm256_srli_epi16(value, NIBBLE_BITS), mask));
+        __m256i low = NibbleToHexAvx2(_mm256_and_si256(value, mask));
+        /* the unpacking works in each 128-bit lane, the lanes are put back in order when stored */
+        __m256i first = _mm256_unpacklo_epi8(high, low);
+        __m256i second = _mm256_unpackhi_epi8(high, low);
+        char *out = hexStr + i * BYTE_TO_HEX_OPER_LENGTH;
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *)(out + HEX_WIDE_BLOCK_BYTES),
+            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+
+static HEX_CODEC_AVX2_FUNC __m256i HexToNibbleAvx2(__m256i hex, __m256i *invalid)
+{
+    __m256i lower = _mm256_or_si256(hex, _mm256_set1_epi8(HEX_LOWER_CASE_BIT));
+    __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(hex, _mm256_set1_epi8('0' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), hex));
+    __m256i isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    *invalid = _mm256_or_si256(*invalid,
+        _mm256_andnot_si256(_mm256_or_si256(isDigit, isLetter), _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(_mm256_and_si256(isDigit, _mm256_sub_epi8(hex, _mm256_set1_epi8('0'))),
+        _mm256_and_si256(isLetter, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+}
+
+static HEX_CODEC_AVX2_FUNC __m256i PackNibblesAvx2(__m256i nibbles)
+{
+    return _mm256_or_si256(
+        _mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00FF)), NIBBLE_BITS),
+        _mm256_srli_epi16(nibbles, 8)); /* 8: the low nibble is in the high byte */
+}
+
+static HEX_CODEC_AVX2_FUNC uint32_t DecodeHexAvx2(const char *hexStr, uint8_t *byte, uint32_t byteLen)
+{
+    uint32_t i = 0;
+    for (; byteLen - i >= HEX_WIDE_BLOCK_BYTES; i += HEX_WIDE_BLOCK_BYTES) {
+        const char *in = hexStr + i * BYTE_TO_HEX_OPER_LENGTH;
+        __m256i invalid = _mm256_setzero_si256();
+        __m256i first = HexToNibbleAvx2(_mm256_loadu_si256((const __m256i *)in), &invalid);
+        __m256i second = HexToNibbleAvx2(_mm256_loadu_si256((const __m256i *)(in + HEX_WIDE_BLOCK_BYTES)),
+            &invalid);
+        if (_mm256_movemask_epi8(invalid) != 0) {
+            break;
+        }
+        /* the packing works in each 128-bit lane, 0xD8 puts the 64-bit parts back in order */
+        __m256i packed = _mm256_packus_epi16(PackNibblesAvx2(first), PackNibblesAvx2(second));
+        _mm256_storeu_si256((__m256i *)(byte + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return i;
+}
+#endif
+
+#ifdef HEX_CODEC_NEON
+static uint8x16_t NibbleToHexNeon(uint8x16_t nibble)
+{
+    uint8x16_t isLetter = vcgtq_u8(nibble, vdupq_n_u8(9));
+    return vaddq_u8(vaddq_u8(nibble, vdupq_n_u8('0')), vandq_u8(isLetter, vdupq_n_u8(HEX_LETTER_OFFSET)));
+}
+
+static uint32_t EncodeHexNeon(const uint8_t *byte, uint32_t byteLen, char *hexStr)
+{
+    uint32_t i = 0;
+    for (; byteLen - i >= HEX_BLOCK_BYTES; i += HEX_BLOCK_BYTES) {
+        uint8x16_t value = vld1q_u8(byte + i);
+        uint8x16x2_t hex;
+        hex.val[0] = NibbleToHexNeon(vshrq_n_u8(value, NIBBLE_BITS));
+        hex.val[1] = NibbleToHexNeon(vandq_u8(value, vdupq_n_u8(NIBBLE_MASK)));
+        /* the store interleaves the high and the low chars */
+        vst2q_u8((uint8_t *)hexStr + i * BYTE_TO_HEX_OPER_LENGTH, hex);
+    }
+    return i;
+}
+
+static uint8x16_t HexToNibbleNeon(uint8x16_t hex, uint8x16_t *invalid)
+{
+    /* the chars below '0' or 'a' wrap around, so one unsigned compare checks each range */
+    uint8x16_t digit = vsubq_u8(hex, vdupq_n_u8('0'));
+    uint8x16_t letter = vsubq_u8(vorrq_u8(hex, vdupq_n_u8(HEX_LOWER_CASE_BIT)), vdupq_n_u8('a'));
+    uint8x16_t isDigit = vcltq_u8(digit, vdupq_n_u8(10));
+    uint8x16_t isLetter = vcltq_u8(letter, vdupq_n_u8(6));
+    *invalid = vorrq_u8(*invalid, vmvnq_u8(vorrq_u8(isDigit, isLetter)));
+    return vorrq_u8(vandq_u8(isDigit, digit), vandq_u8(isLetter, vaddq_u8(letter, vdupq_n_u8(10))));
+}
+
+static uint32_t DecodeHexNeon(const char *hexStr, uint8_t *byte, uint32_t byteLen)
+{
+    uint32_t i = 0;
+    for (; byteLen - i >= HEX_BLOCK_BYTES; i += HEX_BLOCK_BYTES) {
+        /* the load splits the high and the low chars */
+        uint8x16x2_t hex = vld2q_u8((const uint8_t *)hexStr + i * BYTE_TO_HEX_OPER_LENGTH);
+        uint8x16_t invalid = vdupq_n_u8(0);
+        uint8x16_t high = HexToNibbleNeon(hex.val[0], &invalid);
+        uint8x16_t low = HexToNibbleNeon(hex.val[1], &invalid);
+        if (vmaxvq_u8(invalid) != 0) {
+            break;
+        }
+        vst1q_u8(byte + i, vorrq_u8(vshlq_n_u8(high, NIBBLE_BITS), low));
+    }
+    return i;
+}
+#endif
+
+static uint32_t EncodeHexVector(const uint8_t *byte, uint32_t byteLen, char *hexStr)
+{
+#if defined(HEX_CODEC_SSE2)
+    uint32_t done = 0;
+#ifdef HEX_CODEC_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        done = EncodeHexAvx2(byte, byteLen, hexStr);
+    }
+#endif
+    return done + EncodeHexSse2(byte + done, byteLen - done, hexStr + done * BYTE_TO_HEX_OPER_LENGTH);
+#elif defined(HEX_CODEC_NEON)
+    return EncodeHexNeon(byte, byteLen, hexStr);
+#else
+    (void)byte;
+    (void)byteLen;
+    (void)hexStr;
+    return 0;
+#endif
+}
+
+static uint32_t DecodeHexVector(const char *hexStr, uint8_t *byte, uint32_t byteLen)
+{
+#if defined(HEX_CODEC_SSE2)
+    uint32_t done = 0;
+#ifdef HEX_CODEC_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        done = DecodeHexAvx2(hexStr, byte, byteLen);
+    }
+#endif
+    return done + DecodeHexSse2(hexStr + done * BYTE_TO_HEX_OPER_LENGTH, byte + done, byteLen - done);
+#elif defined(HEX_CODEC_NEON)
+    return DecodeHexNeon(hexStr, byte, byteLen);
+#else
+    (void)hexStr;
+    (void)byte;
+    (void)byteLen;
+    return 0;
+#endif
 }
 
 int32_t ByteToHexString(const uint8_t *byte, uint32_t byteLen, char *hexStr, uint32_t hexLen)
@@ -39,28 +302,15 @@ int32_t ByteToHexString(const uint8_t *byte, uint32_t byteLen, char *hexStr, uin
         return HAL_ERR_INVALID_LEN;
     }
 
-    for (uint32_t i = 0; i < byteLen; i++) {
-        hexStr[i * BYTE_TO_HEX_OPER_LENGTH] = HexToChar((byte[i] & 0xF0) >> 4); /* 4: shift right for filling */
-        hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1] = HexToChar(byte[i] & 0x0F); /* get low four bits */
+    for (uint32_t i = EncodeHexVector(byte, byteLen, hexStr); i < byteLen; i++) {
+        hexStr[i * BYTE_TO_HEX_OPER_LENGTH] = g_hexChars[byte[i] >> NIBBLE_BITS];
+        hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1] = g_hexChars[byte[i] & NIBBLE_MASK];
     }
     hexStr[byteLen * BYTE_TO_HEX_OPER_LENGTH] = '\0';
 
     return HAL_SUCCESS;
 }
 
-static uint8_t CharToHex(char c)
-{
-    if ((c >= 'A') && (c <= 'F')) {
-        return (c - 'A' + DEC);
-    } else if ((c >= 'a') && (c <= 'f')) {
-        return (c - 'a' + DEC);
-    } else if ((c >= '0') && (c <= '9')) {
-        return (c - '0');
-    } else {
-        return OUT_OF_HEX;
-    }
-}
-
 int32_t HexStringToByte(const char *hexStr, uint8_t *byte, uint32_t byteLen)
 {
     if (byte == NULL || hexStr == NULL) {
@@ -73,13 +323,14 @@ int32_t HexStringToByte(const char *hexStr, uint8_t *byte, uint32_t byteLen)
         return HAL_ERR_INVALID_LEN;
     }
 
-    for (uint32_t i = 0; i < realHexLen / BYTE_TO_HEX_OPER_LENGTH; i++) {
-        uint8_t high = CharToHex(hexStr[i * BYTE_TO_HEX_OPER_LENGTH]);
-        uint8_t low = CharToHex(hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1]);
+    uint32_t realByteLen = realHexLen / BYTE_TO_HEX_OPER_LENGTH;
+    for (uint32_t i = DecodeHexVector(hexStr, byte, realByteLen); i < realByteLen; i++) {
+        uint8_t high = g_hexCharValues[(uint8_t)hexStr[i * BYTE_TO_HEX_OPER_LENGTH]];
+        uint8_t low = g_hexCharValues[(uint8_t)hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1]];
         if (high == OUT_OF_HEX || low == OUT_OF_HEX) {
             return HAL_ERR_INVALID_PARAM;
         }
-        byte[i] = high << 4; /* 4: Set the high nibble */
+        byte[i] = high << NIBBLE_BITS; /* Set the high nibble */
         byte[i] |= low; /* Set the low nibble */
     }
     return HAL_SUCCESS;
@@ -91,4 +342,18 @@ int64_t StringToInt64(const char *cp)
         return 0;
     }
     return strtoll(cp, NULL, DEC);
+}
+
+uint32_t HcCrc32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    if (data == NULL) {
+        return crc;
+    }
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> NIBBLE_BITS) ^ g_crc32NibbleTable[crc & NIBBLE_MASK];
+        crc = (crc >> NIBBLE_BITS) ^ g_crc32NibbleTable[crc & NIBBLE_MASK];
+    }
+    return ~crc;
 }
\ No newline at end of file
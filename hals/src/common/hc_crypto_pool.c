@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hc_crypto_pool.h"
+#include "alg_loader.h"
+#include "hc_condition.h"
+#include "hc_error.h"
+#include "hc_log.h"
+#include "hc_task_thread.h"
+#include "securec.h"
+
+#define CRYPTO_STACK_SIZE 4096
+#define CRYPTO_THREAD_NAME_LEN 16
+#define CRYPTO_OP_MAX_IN_NUM 3
+
+typedef enum {
+    CRYPTO_OP_HKDF,
+    CRYPTO_OP_HASH_TO_POINT,
+    CRYPTO_OP_AGREE,
+    CRYPTO_OP_EXP_MOD,
+    CRYPTO_OP_EXP_MOD_WITH_CONTEXT,
+    CRYPTO_OP_SIGN,
+    CRYPTO_OP_VERIFY,
+} CryptoOpType;
+
+typedef struct {
+    HcTaskBase base;
+    CryptoOpType type;
+    Uint8Buff inBuffs[CRYPTO_OP_MAX_IN_NUM];
+    const Uint8Buff *in[CRYPTO_OP_MAX_IN_NUM]; /* point to inBuffs, NULL for the absent ones */
+    KeyBuff priKey;
+    KeyBuff pubKey;
+    Algorithm algo;
+    bool isAlias;
+    const char *bigNumHex;
+    const DlGroupContext *groupCtx;
+    Uint8Buff *out;
+    AlgCompletionFunc onDone;
+    void *ctx;
+    bool isDone;
+} CryptoOp;
+
+static HcTaskThread *g_cryptoThreads = NULL;
+static uint32_t g_cryptoWorkerNum = 0;
+static uint32_t g_nextWorker = 0;
+static uint32_t g_submitterNum = 0; /* the callers which may still push to g_cryptoThreads */
+/*
+ * Notified by the last submitter to leave a pool which is being destroyed. It is never destroyed, as that
+ * submitter may still be notifying when the destruction sees no submitter left.
+ */
+static HcMutex g_submitterMutex;
+static HcCondition g_submitterCond;
+static bool g_isSubmitterCondInit = false;
+
+static int32_t RunCryptoOp(const CryptoOp *op)
+{
+    const AlgLoader *loader = GetLoaderInstance();
+    switch (op->type) {
+        case CRYPTO_OP_HKDF:
+            return (loader->computeHkdf == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->computeHkdf(op->in[0], op->in[1], op->in[2], op->out, op->isAlias);
+        case CRYPTO_OP_HASH_TO_POINT:
+            return (loader->hashToPoint == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->hashToPoint(op->in[0], op->algo, op->out);
+        case CRYPTO_OP_AGREE:
+            return (loader->agreeSharedSecret == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->agreeSharedSecret(&op->priKey, &op->pubKey, op->algo, op->out);
+        case CRYPTO_OP_EXP_MOD:
+            return (loader->bigNumExpMod == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->bigNumExpMod(op->in[0], op->in[1], op->bigNumHex, op->out);
+        case CRYPTO_OP_EXP_MOD_WITH_CONTEXT:
+            return (loader->bigNumExpModWithContext == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->bigNumExpModWithContext(op->in[0], op->in[1], op->groupCtx, op->out);
+        case CRYPTO_OP_SIGN:
+            return (loader->sign == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->sign(op->in[0], op->in[1], op->algo, op->out, op->isAlias);
+        case CRYPTO_OP_VERIFY:
+            return (loader->verify == NULL) ? HAL_ERR_NOT_SUPPORTED :
+                loader->verify(op->in[0], op->in[1], op->algo, op->in[2], op->isAlias);
+        default:
+            return HAL_ERR_NOT_SUPPORTED;
+    }
+}
+
+static void DoCryptoOp(HcTaskBase *task)
+{
+    CryptoOp *op = (CryptoOp *)task;
+    int32_t res = RunCryptoOp(op);
+    op->isDone = true;
+    op->onDone(res, op->ctx);
+}
+
+static void DestroyCryptoOp(HcTaskBase *task)
+{
+    CryptoOp *op = (CryptoOp *)task;
+    if (!op->isDone) {
+        /* dropped from the queue by the destruction of the pool */
+        op->isDone = true;
+        op->onDone(HAL_ERR_CANCELED, op->ctx);
+    }
+}
+
+static CryptoOp *CreateCryptoOp(CryptoOpType type, Uint8Buff *out, AlgCompletionFunc onDone, void *ctx)
+{
+    CryptoOp *op = (CryptoOp *)HcMalloc(sizeof(CryptoOp), 0);
+    if (op == NULL) {
+        LOGE("Failed to allocate the crypto operation!");
+        return NULL;
+    }
+    op->base.doAction = DoCryptoOp;
+    op->base.destroy = DestroyCryptoOp;
+    op->type = type;
+    op->out = out;
+    op->onDone = onDone;
+    op->ctx = ctx;
+    return op;
+}
+
+static void SetOpInput(CryptoOp *op, uint32_t index, const Uint8Buff *in)
+{
+    if (in != NULL) {
+        op->inBuffs[index] = *in;
+        op->in[index] = &op->inBuffs[index];
+    }
+}
+
+static void RunOnCallerThread(CryptoOp *op)
+{
+    DoCryptoOp(&op->base);
+    HcFree(op);
+}
+
+static void CancelCryptoOp(CryptoOp *op)
+{
+    DestroyCryptoOp(&op->base);
+    HcFree(op);
+}
+
+static bool PushCryptoOp(HcTaskThread *threads, CryptoOp *op)
+{
+    uint32_t start = __atomic_fetch_add(&g_nextWorker, 1, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < g_cryptoWorkerNum; i++) {
+        HcTaskThread *thread = &threads[(start + i) % g_cryptoWorkerNum];
+        if (thread->pushTask(thread, &op->base) == HAL_SUCCESS) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void LeaveCryptoPool(void)
+{
+    if ((__atomic_sub_fetch(&g_submitterNum, 1, __ATOMIC_SEQ_CST) == 0) &&
+        (__atomic_load_n(&g_cryptoThreads, __ATOMIC_SEQ_CST) == NULL)) {
+        g_submitterCond.notify(&g_submitterCond);
+    }
+}
+
+/*
+ * The operations are spread in turn, a worker with a full queue is skipped.
+ * The submitter count keeps the workers alive while they are pushed to, the destruction of the pool
+ * waits for it after taking the workers away, so a late operation either sees no workers or is queued
+ * before the queues are cleared.
+ */
+static int32_t SubmitCryptoOp(CryptoOp *op)
+{
+    __atomic_add_fetch(&g_submitterNum, 1, __ATOMIC_SEQ_CST);
+    HcTaskThread *threads = __atomic_load_n(&g_cryptoThreads, __ATOMIC_SEQ_CST);
+    if (threads == NULL) {
+        LeaveCryptoPool();
+        LOGW("The crypto pool is stopped, the operation is canceled.");
+        CancelCryptoOp(op);
+        return HAL_SUCCESS;
+    }
+    bool isPushed = PushCryptoOp(threads, op);
+    LeaveCryptoPool();
+    if (!isPushed) {
+        LOGW("All the crypto workers are busy, run the operation on the caller thread.");
+        RunOnCallerThread(op);
+    }
+    return HAL_SUCCESS;
+}
+
+static int32_t AsyncComputeHkdf(const Uint8Buff *baseKey, const Uint8Buff *salt, const Uint8Buff *keyInfo,
+    Uint8Buff *outHkdf, bool isAlias, AlgCompletionFunc onDone, void *ctx)
+{
+    if ((baseKey == NULL) || (outHkdf == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_HKDF, outHkdf, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    SetOpInput(op, 0, baseKey);
+    SetOpInput(op, 1, salt);
+    SetOpInput(op, 2, keyInfo); /* 2: the third input */
+    op->isAlias = isAlias;
+    return SubmitCryptoOp(op);
+}
+
+static int32_t AsyncHashToPoint(const Uint8Buff *hash, Algorithm algo, Uint8Buff *outEcPoint,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    if ((hash == NULL) || (outEcPoint == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_HASH_TO_POINT, outEcPoint, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    SetOpInput(op, 0, hash);
+    op->algo = algo;
+    return SubmitCryptoOp(op);
+}
+
+static int32_t AsyncAgreeSharedSecret(const KeyBuff *priKey, const KeyBuff *pubKey, Algorithm algo,
+    Uint8Buff *sharedKey, AlgCompletionFunc onDone, void *ctx)
+{
+    if ((priKey == NULL) || (pubKey == NULL) || (sharedKey == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_AGREE, sharedKey, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    op->priKey = *priKey;
+    op->pubKey = *pubKey;
+    op->algo = algo;
+    return SubmitCryptoOp(op);
+}
+
+static int32_t AsyncBigNumExpMod(const Uint8Buff *base, const Uint8Buff *exp, const char *bigNumHex,
+    Uint8Buff *outNum, AlgCompletionFunc onDone, void *ctx)
+{
+    if ((base == NULL) || (exp == NULL) || (bigNumHex == NULL) || (outNum == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_EXP_MOD, outNum, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    SetOpInput(op, 0, base);
+    SetOpInput(op, 1, exp);
+    op->bigNumHex = bigNumHex;
+    return SubmitCryptoOp(op);
+}
+
+static int32_t AsyncBigNumExpModWithContext(const Uint8Buff *base, const Uint8Buff *exp,
+    const DlGroupContext *groupCtx, Uint8Buff *outNum, AlgCompletionFunc onDone, void *ctx)
+{
+    if ((base == NULL) || (exp == NULL) || (groupCtx == NULL) || (outNum == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_EXP_MOD_WITH_CONTEXT, outNum, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    SetOpInput(op, 0, base);
+    SetOpInput(op, 1, exp);
+    op->groupCtx = groupCtx;
+    return SubmitCryptoOp(op);
+}
+
+static int32_t AsyncSign(const Uint8Buff *keyAlias, const Uint8Buff *message, Algorithm algo,
+    Uint8Buff *outSignature, bool isAlias, AlgCompletionFunc onDone, void *ctx)
+{
+    if ((keyAlias == NULL) || (message == NULL) || (outSignature == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_SIGN, outSignature, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    SetOpInput(op, 0, keyAlias);
+    SetOpInput(op, 1, message);
+    op->algo = algo;
+    op->isAlias = isAlias;
+    return SubmitCryptoOp(op);
+}
+
+static int32_t AsyncVerify(const Uint8Buff *key, const Uint8Buff *message, Algorithm algo,
+    const Uint8Buff *signature, bool isAlias, AlgCompletionFunc onDone, void *ctx)
+{
+    if ((key == NULL) || (message == NULL) || (signature == NULL) || (onDone == NULL)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    CryptoOp *op = CreateCryptoOp(CRYPTO_OP_VERIFY, NULL, onDone, ctx);
+    if (op == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    SetOpInput(op, 0, key);
+    SetOpInput(op, 1, message);
+    SetOpInput(op, 2, signature); /* 2: the third input */
+    op->algo = algo;
+    op->isAlias = isAlias;
+    return SubmitCryptoOp(op);
+}
+
+static const AsyncAlgLoader g_asyncLoader = {
+    .computeHkdf = AsyncComputeHkdf,
+    .hashToPoint = AsyncHashToPoint,
+    .agreeSharedSecret = AsyncAgreeSharedSecret,
+    .bigNumExpMod = AsyncBigNumExpMod,
+    .bigNumExpModWithContext = AsyncBigNumExpModWithContext,
+    .sign = AsyncSign,
+    .verify = AsyncVerify,
+};
+
+static void DestroyCryptoThreads(HcTaskThread *threads, uint32_t count)
+{
+    /* all the queued operations are canceled first, not only after the running ones before them end */
+    for (uint32_t i = 0; i < count; i++) {
+        threads[i].clear(&threads[i]);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        threads[i].stopAndClear(&threads[i]);
+        DestroyHcTaskThread(&threads[i]);
+    }
+    HcFree(threads);
+}
+
+static int32_t StartCryptoThread(HcTaskThread *thread, uint32_t index)
+{
+    char threadName[CRYPTO_THREAD_NAME_LEN] = { 0 };
+    if (sprintf_s(threadName, sizeof(threadName), "HichainCrypto%u", index) <= 0) {
+        return HAL_ERR_INIT_FAILED;
+    }
+    int32_t res = InitHcTaskThread(thread, CRYPTO_STACK_SIZE, CRYPTO_QUEUE_CAPACITY, threadName);
+    if (res != HAL_SUCCESS) {
+        LOGE("Failed to init crypto thread! res: %d", res);
+        return HAL_ERR_INIT_FAILED;
+    }
+    res = thread->startThread(thread);
+    if (res != HAL_SUCCESS) {
+        DestroyHcTaskThread(thread);
+        LOGE("Failed to start crypto thread! res: %d", res);
+        return HAL_ERR_INIT_FAILED;
+    }
+    return HAL_SUCCESS;
+}
+
+int32_t InitCryptoPool(uint32_t workerNum)
+{
+    if ((workerNum == 0) || (g_cryptoThreads != NULL)) {
+        return HAL_SUCCESS;
+    }
+    if (!g_isSubmitterCondInit) {
+        if (InitHcMutex(&g_submitterMutex) != 0) {
+            return HAL_ERR_INIT_FAILED;
+        }
+        if (InitHcCond(&g_submitterCond, &g_submitterMutex) != 0) {
+            DestroyHcMutex(&g_submitterMutex);
+            return HAL_ERR_INIT_FAILED;
+        }
+        g_isSubmitterCondInit = true;
+    }
+    HcTaskThread *threads = (HcTaskThread *)HcMalloc(sizeof(HcTaskThread) * workerNum, 0);
+    if (threads == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    for (uint32_t i = 0; i < workerNum; i++) {
+        int32_t res = StartCryptoThread(&threads[i], i);
+        if (res != HAL_SUCCESS) {
+            DestroyCryptoThreads(threads, i);
+            return res;
+        }
+    }
+    g_cryptoWorkerNum = workerNum;
+    __atomic_store_n(&g_cryptoThreads, threads, __ATOMIC_RELEASE);
+    LOGI("Start %u crypto threads successfully!", workerNum);
+    return HAL_SUCCESS;
+}
+
+void DestroyCryptoPool(void)
+{
+    HcTaskThread *threads = __atomic_exchange_n(&g_cryptoThreads, NULL, __ATOMIC_SEQ_CST);
+    if (threads == NULL) {
+        return;
+    }
+    /* a notification given before the wait is kept, so the last submitter can't be missed */
+    while (__atomic_load_n(&g_submitterNum, __ATOMIC_SEQ_CST) != 0) {
+        (void)g_submitterCond.wait(&g_submitterCond);
+    }
+    DestroyCryptoThreads(threads, g_cryptoWorkerNum);
+    g_cryptoWorkerNum = 0;
+}
+
+const AsyncAlgLoader *GetAsyncLoaderInstance(void)
+{
+    return (__atomic_load_n(&g_cryptoThreads, __ATOMIC_ACQUIRE) != NULL) ? &g_asyncLoader : NULL;
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hc_hash_map.h"
+#include "hc_log.h"
+#include "securec.h"
+
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+#define HASH_MAP_MAX_BUCKET_COUNT (1U << 30)
+/* grow the buckets when size > bucketCount * 3 / 4 */
+#define LOAD_FACTOR_NUMERATOR 3
+#define LOAD_FACTOR_DENOMINATOR 4
+
+static uint32_t HashKey(const void *key, uint32_t keyLen)
+{
+    const uint8_t *data = (const uint8_t *)key;
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t i = 0; i < keyLen; ++i) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t RoundUpPowerOfTwo(uint32_t count)
+{
+    uint32_t result = 1;
+    while ((result < count) && (result < HASH_MAP_MAX_BUCKET_COUNT)) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static bool IsKeyEquals(const HcHashNode *node, uint32_t hash, const void *key, uint32_t keyLen)
+{
+    return (node->hash == hash) && (node->keyLen == keyLen) && (memcmp(node->key, key, keyLen) == 0);
+}
+
+HcHashMap CreateHashMap(uint32_t bucketCount)
+{
+    HcHashMap map;
+    (void)memset_s(&map, sizeof(map), 0, sizeof(map));
+    if (bucketCount == 0) {
+        bucketCount = HASH_MAP_DEFAULT_BUCKET_COUNT;
+    }
+    map.bucketCount = RoundUpPowerOfTwo(bucketCount);
+    /* the buckets are allocated on the first insertion */
+    return map;
+}
+
+void ClearHashMap(HcHashMap *map)
+{
+    if ((map == NULL) || (map->buckets == NULL)) {
+        return;
+    }
+    for (uint32_t i = 0; i < map->bucketCount; ++i) {
+        HcHashNode *node = map->buckets[i];
+        while (node != NULL) {
+            HcHashNode *next = node->next;
+            HcFree(node);
+            node = next;
+        }
+        map->buckets[i] = NULL;
+    }
+    map->size = 0;
+}
+
+void DestroyHashMap(HcHashMap *map)
+{
+    if (map == NULL) {
+        return;
+    }
+    ClearHashMap(map);
+    HcFree(map->buckets);
+    map->buckets = NULL;
+    map->size = 0;
+}
+
+static HcBool AllocBuckets(HcHashMap *map)
+{
+    if (map->bucketCount == 0) {
+        map->bucketCount = HASH_MAP_DEFAULT_BUCKET_COUNT;
+    }
+    map->buckets = (HcHashNode **)HcMalloc(map->bucketCount * sizeof(HcHashNode *), 0);
+    if (map->buckets == NULL) {
+        LOGE("Failed to allocate hash map buckets!");
+        return HC_FALSE;
+    }
+    return HC_TRUE;
+}
+
+static void Rehash(HcHashMap *map)
+{
+    if (map->bucketCount >= HASH_MAP_MAX_BUCKET_COUNT) {
+        return;
+    }
+    uint32_t newCount = map->bucketCount << 1;
+    HcHashNode **newBuckets = (HcHashNode **)HcMalloc(newCount * sizeof(HcHashNode *), 0);
+    if (newBuckets == NULL) {
+        /* keep working with the longer chains */
+        LOGW("Failed to grow hash map buckets!");
+        return;
+    }
+    /* a chain splits into the same index and the index + bucketCount, both keep the order of the nodes */
+    for (uint32_t i = 0; i < map->bucketCount; ++i) {
+        HcHashNode **lowTail = &newBuckets[i];
+        HcHashNode **highTail = &newBuckets[i + map->bucketCount];
+        HcHashNode *node = map->buckets[i];
+        while (node != NULL) {
+            HcHashNode *next = node->next;
+            node->next = NULL;
+            if ((node->hash & map->bucketCount) == 0) {
+                *lowTail = node;
+                lowTail = &node->next;
+            } else {
+                *highTail = node;
+                highTail = &node->next;
+            }
+            node = next;
+        }
+    }
+    HcFree(map->buckets);
+    map->buckets = newBuckets;
+    map->bucketCount = newCount;
+}
+
+HcBool HashMapPut(HcHashMap *map, const void *key, uint32_t keyLen, void *value)
+{
+    if ((map == NULL) || (key == NULL) || (keyLen == 0)) {
+        return HC_FALSE;
+    }
+    if ((map->buckets == NULL) && !AllocBuckets(map)) {
+        return HC_FALSE;
+    }
+    HcHashNode *node = (HcHashNode *)HcMalloc(sizeof(HcHashNode) + keyLen, 0);
+    if (node == NULL) {
+        LOGE("Failed to allocate hash node!");
+        return HC_FALSE;
+    }
+    if (memcpy_s(node->key, keyLen, key, keyLen) != EOK) {
+        HcFree(node);
+        return HC_FALSE;
+    }
+    node->keyLen = keyLen;
+    node->hash = HashKey(key, keyLen);
+    node->value = value;
+    node->next = NULL;
+    /* append to the chain, so that the nodes with the same key are found in the order of insertion */
+    HcHashNode **link = &map->buckets[node->hash & (map->bucketCount - 1)];
+    while (*link != NULL) {
+        link = &(*link)->next;
+    }
+    *link = node;
+    map->size++;
+    if ((uint64_t)map->size * LOAD_FACTOR_DENOMINATOR > (uint64_t)map->bucketCount * LOAD_FACTOR_NUMERATOR) {
+        Rehash(map);
+    }
+    return HC_TRUE;
+}
+
+const HcHashNode *HashMapFind(const HcHashMap *map, const void *key, uint32_t keyLen)
+{
+    if ((map == NULL) || (map->buckets == NULL) || (key == NULL)) {
+        return NULL;
+    }
+    uint32_t hash = HashKey(key, keyLen);
+    const HcHashNode *node = map->buckets[hash & (map->bucketCount - 1)];
+    while (node != NULL) {
+        if (IsKeyEquals(node, hash, key, keyLen)) {
+            return node;
+        }
+        node = node->next;
+    }
+    return NULL;
+}
+
+const HcHashNode *HashMapFindNext(const HcHashNode *node)
+{
+    if (node == NULL) {
+        return NULL;
+    }
+    const HcHashNode *cur = node->next;
+    while (cur != NULL) {
+        if (IsKeyEquals(cur, node->hash, node->key, node->keyLen)) {
+            return cur;
+        }
+        cur = cur->next;
+    }
+    return NULL;
+}
+
+void *HashMapGet(const HcHashMap *map, const void *key, uint32_t keyLen)
+{
+    const HcHashNode *node = HashMapFind(map, key, keyLen);
+    return (node != NULL) ? node->value : NULL;
+}
+
+HcBool HashMapRemove(HcHashMap *map, const void *key, uint32_t keyLen, const void *value)
+{
+    if ((map == NULL) || (map->buckets == NULL) || (key == NULL)) {
+        return HC_FALSE;
+    }
+    uint32_t hash = HashKey(key, keyLen);
+    HcHashNode **link = &map->buckets[hash & (map->bucketCount - 1)];
+    while (*link != NULL) {
+        HcHashNode *node = *link;
+        if (IsKeyEquals(node, hash, key, keyLen) && ((value == NULL) || (node->value == value))) {
+            *link = node->next;
+            HcFree(node);
+            map->size--;
+            return HC_TRUE;
+        }
+        link = &node->next;
+    }
+    return HC_FALSE;
+}
+
+uint32_t HashMapSize(const HcHashMap *map)
+{
+    return (map != NULL) ? map->size : 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hc_lru_cache.h"
+#include "hc_error.h"
+#include "hc_log.h"
+#include "securec.h"
+
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+#define LRU_CACHE_MAX_DATA_SIZE (1U << 20)
+
+static uint32_t HashKey(const Uint8Buff *key)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t i = 0; i < key->length; ++i) {
+        hash ^= key->val[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint8_t *GetSlotKey(const HcLruCache *cache, uint32_t index)
+{
+    return cache->data + (cache->maxKeyLen + cache->maxValueLen) * index;
+}
+
+static uint8_t *GetSlotValue(const HcLruCache *cache, uint32_t index)
+{
+    return GetSlotKey(cache, index) + cache->maxKeyLen;
+}
+
+static bool IsValidKey(const HcLruCache *cache, const Uint8Buff *key)
+{
+    return (cache->slots != NULL) && (key != NULL) && (key->val != NULL) && (key->length > 0) &&
+        (key->length <= cache->maxKeyLen);
+}
+
+/* Called with the lock held. */
+static int32_t FindSlot(const HcLruCache *cache, const Uint8Buff *key, uint32_t hash)
+{
+    for (uint32_t i = 0; i < cache->capacity; ++i) {
+        const HcLruSlot *slot = &cache->slots[i];
+        if ((slot->lastUse != 0) && (slot->hash == hash) && (slot->keyLen == key->length) &&
+            (memcmp(GetSlotKey(cache, i), key->val, key->length) == 0)) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+/* Called with the lock held, an empty slot is the least recently used one. */
+static uint32_t FindVictimSlot(const HcLruCache *cache)
+{
+    uint32_t victim = 0;
+    for (uint32_t i = 1; i < cache->capacity; ++i) {
+        if (cache->slots[i].lastUse < cache->slots[victim].lastUse) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+int32_t InitLruCache(HcLruCache *cache, uint32_t capacity, uint32_t maxKeyLen, uint32_t maxValueLen)
+{
+    if ((cache == NULL) || (capacity == 0) || (maxKeyLen == 0) || (maxValueLen == 0)) {
+        return HAL_ERR_INVALID_PARAM;
+    }
+    if ((maxKeyLen > LRU_CACHE_MAX_DATA_SIZE) || (maxValueLen > LRU_CACHE_MAX_DATA_SIZE - maxKeyLen) ||
+        (capacity > LRU_CACHE_MAX_DATA_SIZE / (maxKeyLen + maxValueLen))) {
+        return HAL_ERR_INVALID_LEN;
+    }
+    (void)memset_s(cache, sizeof(HcLruCache), 0, sizeof(HcLruCache));
+    cache->slots = (HcLruSlot *)HcMalloc(capacity * sizeof(HcLruSlot), 0);
+    cache->data = (uint8_t *)HcMalloc(capacity * (maxKeyLen + maxValueLen), 0);
+    if ((cache->slots == NULL) || (cache->data == NULL)) {
+        LOGE("Failed to allocate the memory of the cache!");
+        HcFree(cache->slots);
+        HcFree(cache->data);
+        cache->slots = NULL;
+        cache->data = NULL;
+        return HAL_ERR_BAD_ALLOC;
+    }
+    if (InitHcMutex(&cache->lock) != 0) {
+        HcFree(cache->slots);
+        HcFree(cache->data);
+        cache->slots = NULL;
+        cache->data = NULL;
+        return HAL_ERR_INIT_FAILED;
+    }
+    cache->capacity = capacity;
+    cache->maxKeyLen = maxKeyLen;
+    cache->maxValueLen = maxValueLen;
+    return HAL_SUCCESS;
+}
+
+void DestroyLruCache(HcLruCache *cache)
+{
+    if ((cache == NULL) || (cache->slots == NULL)) {
+        return;
+    }
+    HcFree(cache->slots);
+    HcFree(cache->data);
+    cache->slots = NULL;
+    cache->data = NULL;
+    cache->capacity = 0;
+    DestroyHcMutex(&cache->lock);
+}
+
+HcBool LruCacheGet(HcLruCache *cache, const Uint8Buff *key, Uint8Buff *outValue)
+{
+    if ((cache == NULL) || !IsValidKey(cache, key)) {
+        return HC_FALSE;
+    }
+    uint32_t hash = HashKey(key);
+    cache->lock.lock(&cache->lock);
+    int32_t index = FindSlot(cache, key, hash);
+    if (index < 0) {
+        cache->lock.unlock(&cache->lock);
+        return HC_FALSE;
+    }
+    HcLruSlot *slot = &cache->slots[index];
+    if (outValue != NULL) {
+        if ((outValue->val == NULL) || (outValue->length < slot->valueLen)) {
+            cache->lock.unlock(&cache->lock);
+            return HC_FALSE;
+        }
+        (void)memcpy_s(outValue->val, outValue->length, GetSlotValue(cache, index), slot->valueLen);
+        outValue->length = slot->valueLen;
+    }
+    slot->lastUse = ++cache->clock;
+    cache->lock.unlock(&cache->lock);
+    return HC_TRUE;
+}
+
+uint32_t GetLruCacheEpoch(HcLruCache *cache)
+{
+    if ((cache == NULL) || (cache->slots == NULL)) {
+        return 0;
+    }
+    cache->lock.lock(&cache->lock);
+    uint32_t epoch = cache->epoch;
+    cache->lock.unlock(&cache->lock);
+    return epoch;
+}
+
+void LruCachePut(HcLruCache *cache, const Uint8Buff *key, const Uint8Buff *value, uint32_t epoch)
+{
+    if ((cache == NULL) || !IsValidKey(cache, key) || (value == NULL) || (value->val == NULL) ||
+        (value->length == 0) || (value->length > cache->maxValueLen)) {
+        return;
+    }
+    uint32_t hash = HashKey(key);
+    cache->lock.lock(&cache->lock);
+    if (epoch != cache->epoch) {
+        cache->lock.unlock(&cache->lock);
+        return;
+    }
+    int32_t index = FindSlot(cache, key, hash);
+    if (index < 0) {
+        index = (int32_t)FindVictimSlot(cache);
+        (void)memcpy_s(GetSlotKey(cache, index), cache->maxKeyLen, key->val, key->length);
+    }
+    HcLruSlot *slot = &cache->slots[index];
+    (void)memcpy_s(GetSlotValue(cache, index), cache->maxValueLen, value->val, value->length);
+    slot->hash = hash;
+    slot->keyLen = key->length;
+    slot->valueLen = value->length;
+    slot->lastUse = ++cache->clock;
+    cache->lock.unlock(&cache->lock);
+}
+
+void LruCacheRemove(HcLruCache *cache, const Uint8Buff *key)
+{
+    if ((cache == NULL) || !IsValidKey(cache, key)) {
+        return;
+    }
+    uint32_t hash = HashKey(key);
+    cache->lock.lock(&cache->lock);
+    cache->epoch++;
+    int32_t index = FindSlot(cache, key, hash);
+    if (index >= 0) {
+        (void)memset_s(&cache->slots[index], sizeof(HcLruSlot), 0, sizeof(HcLruSlot));
+    }
+    cache->lock.unlock(&cache->lock);
+}
+
+void ClearLruCache(HcLruCache *cache)
+{
+    if ((cache == NULL) || (cache->slots == NULL)) {
+        return;
+    }
+    cache->lock.lock(&cache->lock);
+    cache->epoch++;
+    (void)memset_s(cache->slots, cache->capacity * sizeof(HcLruSlot), 0, cache->capacity * sizeof(HcLruSlot));
+    cache->lock.unlock(&cache->lock);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hc_mem_pool.h"
+#include "hc_error.h"
+#include "hc_log.h"
+#include "securec.h"
+
+/* the objects hold 64-bit fields, keep them aligned on the 32-bit targets as well */
+#define MEM_POOL_ALIGN 8
+#define MEM_POOL_ROUND_UP(size) (((size) + MEM_POOL_ALIGN - 1) & ~(uint32_t)(MEM_POOL_ALIGN - 1))
+#define MEM_SLAB_HEAD_SIZE MEM_POOL_ROUND_UP((uint32_t)sizeof(HcMemSlab))
+#define MEM_SLAB_MAX_SIZE (1U << 20)
+
+static uint32_t GetSlabSize(const HcMemPool *pool)
+{
+    return MEM_SLAB_HEAD_SIZE + pool->objSize * pool->objNumPerSlab;
+}
+
+static void PushFreeObjects(HcMemPool *pool, HcMemSlab *slab)
+{
+    uint8_t *obj = (uint8_t *)slab + MEM_SLAB_HEAD_SIZE;
+    for (uint32_t i = 0; i < pool->objNumPerSlab; i++) {
+        *(void **)obj = pool->freeList;
+        pool->freeList = obj;
+        obj += pool->objSize;
+    }
+}
+
+static HcBool AddSlab(HcMemPool *pool)
+{
+    HcMemSlab *slab = (HcMemSlab *)HcMalloc(GetSlabSize(pool), 0);
+    if (slab == NULL) {
+        LOGE("Failed to allocate memory slab!");
+        return HC_FALSE;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slabNum++;
+    PushFreeObjects(pool, slab);
+    return HC_TRUE;
+}
+
+/* Called when no object is in use, keep one slab for the next allocations. */
+static void ReleaseSpareSlabs(HcMemPool *pool)
+{
+    HcMemSlab *slab = pool->slabs->next;
+    while (slab != NULL) {
+        HcMemSlab *next = slab->next;
+        HcFree(slab);
+        slab = next;
+    }
+    pool->slabs->next = NULL;
+    pool->slabNum = 1;
+    pool->freeList = NULL;
+    PushFreeObjects(pool, pool->slabs);
+}
+
+int32_t InitMemPool(HcMemPool *pool, uint32_t objSize, uint32_t objNumPerSlab)
+{
+    if ((pool == NULL) || (objSize == 0) || (objNumPerSlab == 0)) {
+        return HAL_ERR_INVALID_PARAM;
+    }
+    uint32_t alignedSize = MEM_POOL_ROUND_UP(objSize < sizeof(void *) ? (uint32_t)sizeof(void *) : objSize);
+    if ((alignedSize < objSize) || (alignedSize > (MEM_SLAB_MAX_SIZE - MEM_SLAB_HEAD_SIZE) / objNumPerSlab)) {
+        return HAL_ERR_INVALID_LEN;
+    }
+    (void)memset_s(pool, sizeof(HcMemPool), 0, sizeof(HcMemPool));
+    if (InitHcMutex(&pool->lock) != 0) {
+        return HAL_ERR_INIT_FAILED;
+    }
+    pool->objSize = alignedSize;
+    pool->objNumPerSlab = objNumPerSlab;
+    return HAL_SUCCESS;
+}
+
+void DestroyMemPool(HcMemPool *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    if (pool->usedNum > 0) {
+        LOGW("%u objects are still in use when the pool is destroyed!", pool->usedNum);
+    }
+    HcMemSlab *slab = pool->slabs;
+    while (slab != NULL) {
+        HcMemSlab *next = slab->next;
+        HcFree(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->freeList = NULL;
+    pool->slabNum = 0;
+    pool->usedNum = 0;
+    DestroyHcMutex(&pool->lock);
+}
+
+void *MemPoolAlloc(HcMemPool *pool)
+{
+    if ((pool == NULL) || (pool->objSize == 0)) {
+        return NULL;
+    }
+    pool->lock.lock(&pool->lock);
+    if ((pool->freeList == NULL) && !AddSlab(pool)) {
+        pool->lock.unlock(&pool->lock);
+        return NULL;
+    }
+    void *obj = pool->freeList;
+    pool->freeList = *(void **)obj;
+    pool->usedNum++;
+    pool->lock.unlock(&pool->lock);
+    (void)memset_s(obj, pool->objSize, 0, pool->objSize);
+    return obj;
+}
+
+void MemPoolFree(HcMemPool *pool, void *obj)
+{
+    if ((pool == NULL) || (obj == NULL)) {
+        return;
+    }
+    pool->lock.lock(&pool->lock);
+    *(void **)obj = pool->freeList;
+    pool->freeList = obj;
+    pool->usedNum--;
+    if ((pool->usedNum == 0) && (pool->slabNum > 1)) {
+        ReleaseSpareSlabs(pool);
+    }
+    pool->lock.unlock(&pool->lock);
+}
+
+void GetMemPoolStat(HcMemPool *pool, HcMemPoolStat *stat)
+{
+    if ((pool == NULL) || (stat == NULL)) {
+        return;
+    }
+    pool->lock.lock(&pool->lock);
+    stat->usedNum = pool->usedNum;
+    stat->usedBytes = pool->usedNum * pool->objSize;
+    stat->reservedBytes = pool->slabNum * GetSlabSize(pool);
+    pool->lock.unlock(&pool->lock);
+}
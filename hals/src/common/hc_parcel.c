@@ -19,6 +19,8 @@
 
 const int PARCEL_DEFAULT_INCREASE_STEP = 16;
 const uint32_t PARCEL_UINT_MAX = 0xffffffffU;
+/* the length grows by half each time, so n writes copy O(n) bytes in total */
+#define PARCEL_GROWTH_DIVISOR 2
 
 HcParcel CreateParcel(uint32_t size, uint32_t allocUnit)
 {
@@ -242,16 +244,11 @@ static HcBool ParcelRealloc(HcParcel *parcel, uint32_t size)
         LOGE("%s: ParcelRealloc failed, length is too big", __func__);
         return HC_FALSE;
     }
-    char *newData = (char*)HcMalloc(size, 0);
+    char *newData = (char*)HcRealloc(parcel->data, parcel->length, size);
     if (newData == NULL) {
         LOGE("%s: ParcelRealloc failed, out of memory", __func__);
         return HC_FALSE;
     }
-    if (memcpy_s(newData, size, parcel->data, parcel->length) != EOK) {
-        HcFree(newData);
-        return HC_FALSE;
-    }
-    HcFree(parcel->data);
     parcel->data = newData;
     parcel->length = size;
     return HC_TRUE;
@@ -280,15 +277,8 @@ static HcBool ParcelIncrease(HcParcel *parcel, uint32_t size)
     }
 }
 
-static void ParcelRecycle(HcParcel *parcel)
+static void ParcelMoveToFront(HcParcel *parcel)
 {
-    if (parcel == NULL) {
-        return;
-    }
-    if (parcel->data == NULL || parcel->beginPos < parcel->allocUnit) {
-        return;
-    }
-
     uint32_t contentSize = parcel->endPos - parcel->beginPos;
     if (contentSize > 0) {
         if (memmove_s(parcel->data, parcel->endPos - parcel->beginPos,
@@ -300,16 +290,80 @@ static void ParcelRecycle(HcParcel *parcel)
     parcel->endPos = contentSize;
 }
 
+static void ParcelRecycle(HcParcel *parcel)
+{
+    if (parcel == NULL) {
+        return;
+    }
+    if (parcel->data == NULL || parcel->beginPos < parcel->allocUnit) {
+        return;
+    }
+    /* only move the data when the freed space is not less than the data, so that the moves are amortized */
+    if (parcel->beginPos < GetParcelDataSize(parcel)) {
+        return;
+    }
+    ParcelMoveToFront(parcel);
+}
+
 static uint32_t GetParcelIncreaseSize(HcParcel *parcel, uint32_t newSize)
 {
     if (parcel == NULL || parcel->allocUnit == 0) {
         return 0;
     }
-    if (newSize % parcel->allocUnit) {
-        return (newSize / parcel->allocUnit + 1) * parcel->allocUnit;
-    } else {
-        return (newSize / parcel->allocUnit) * parcel->allocUnit;
+    uint32_t size = newSize;
+    if ((parcel->length <= PARCEL_UINT_MAX - parcel->length / PARCEL_GROWTH_DIVISOR) &&
+        (parcel->length + parcel->length / PARCEL_GROWTH_DIVISOR > size)) {
+        size = parcel->length + parcel->length / PARCEL_GROWTH_DIVISOR;
+    }
+    if (size % parcel->allocUnit == 0) {
+        return size;
+    }
+    if (size / parcel->allocUnit >= PARCEL_UINT_MAX / parcel->allocUnit) {
+        return newSize;
+    }
+    return (size / parcel->allocUnit + 1) * parcel->allocUnit;
+}
+
+HcBool ParcelReserve(HcParcel *parcel, uint32_t size)
+{
+    if (parcel == NULL) {
+        return HC_FALSE;
+    }
+    if (parcel->length - parcel->beginPos >= size) {
+        return HC_TRUE;
+    }
+    if (parcel->data != NULL && parcel->beginPos > 0) {
+        ParcelMoveToFront(parcel);
+    }
+    if (parcel->length >= size) {
+        return HC_TRUE;
+    }
+    return ParcelIncrease(parcel, size);
+}
+
+void ParcelShrinkToFit(HcParcel *parcel)
+{
+    if (parcel == NULL || parcel->data == NULL) {
+        return;
+    }
+    uint32_t dataSize = GetParcelDataSize(parcel);
+    if (dataSize == 0) {
+        DeleteParcel(parcel);
+        return;
+    }
+    if (parcel->beginPos > 0) {
+        ParcelMoveToFront(parcel);
     }
+    if (parcel->length == dataSize) {
+        return;
+    }
+    char *newData = (char*)HcRealloc(parcel->data, parcel->length, dataSize);
+    if (newData == NULL) {
+        /* keep the larger buffer */
+        return;
+    }
+    parcel->data = newData;
+    parcel->length = dataSize;
 }
 
 HcBool ParcelWrite(HcParcel *parcel, const void *src, uint32_t dataSize)
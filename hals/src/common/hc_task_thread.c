@@ -16,10 +16,74 @@
 #include "hc_task_thread.h"
 #include "hc_error.h"
 #include "hc_log.h"
+#include "hc_mem_arena.h"
 
-#define TASK_ALLOC_UINT 5
+#define MIN_QUEUE_CAPACITY 2
+#define MAX_QUEUE_CAPACITY (1U << 16)
 
-IMPLEMENT_HC_VECTOR(TaskVec, HcTaskWrap, TASK_ALLOC_UINT)
+static int32_t InitTaskQueue(HcTaskQueue* queue, uint32_t capacity)
+{
+    uint32_t size = MIN_QUEUE_CAPACITY;
+    while ((size < capacity) && (size < MAX_QUEUE_CAPACITY)) {
+        size <<= 1;
+    }
+    queue->slots = (HcTaskSlot*)HcMalloc(size * sizeof(HcTaskSlot), 0);
+    if (queue->slots == NULL) {
+        return HAL_ERR_BAD_ALLOC;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        queue->slots[i].sequence = i;
+        queue->slots[i].task = NULL;
+    }
+    queue->mask = size - 1;
+    queue->head = 0;
+    queue->tail = 0;
+    return HAL_SUCCESS;
+}
+
+static HcBool TaskQueuePush(HcTaskQueue* queue, HcTaskBase* task)
+{
+    uint32_t pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    HcTaskSlot* slot = NULL;
+    while (1) {
+        slot = &queue->slots[pos & queue->mask];
+        uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            /* the slot is free, try to claim the position */
+            if (__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, HC_TRUE,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* the slot still holds the task of the previous round */
+            return HC_FALSE;
+        } else {
+            pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+    slot->task = task;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    return HC_TRUE;
+}
+
+/* Must be called with the queueLock. */
+static HcBool TaskQueuePop(HcTaskQueue* queue, HcTaskBase** task)
+{
+    uint32_t pos = queue->head;
+    HcTaskSlot* slot = &queue->slots[pos & queue->mask];
+    uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (sequence != pos + 1) {
+        /* empty, or the producer of the position has not finished writing */
+        return HC_FALSE;
+    }
+    *task = slot->task;
+    slot->task = NULL;
+    /* free the slot for the producer of the next round */
+    __atomic_store_n(&slot->sequence, pos + queue->mask + 1, __ATOMIC_RELEASE);
+    queue->head = pos + 1;
+    return HC_TRUE;
+}
 
 static HcTaskBase* PopTask(HcTaskThread* thread)
 {
@@ -27,42 +91,43 @@ static HcTaskBase* PopTask(HcTaskThread* thread)
         return NULL;
     }
 
+    HcTaskBase* task = NULL;
     thread->queueLock.lock(&thread->queueLock);
-    HcTaskWrap task;
-    HcBool ret = thread->tasks.popFront(&thread->tasks, &task);
+    HcBool ret = TaskQueuePop(&thread->tasks, &task);
     thread->queueLock.unlock(&thread->queueLock);
     if (ret) {
-        return task.task;
+        return task;
     }
     return NULL;
 }
 
-static void PushTask(struct HcTaskThreadT* thread, HcTaskBase* task)
+static int32_t PushTask(struct HcTaskThreadT* thread, HcTaskBase* task)
 {
     if (thread == NULL || task == NULL) {
-        return;
+        return HAL_ERR_NULL_PTR;
     }
 
-    thread->queueLock.lock(&thread->queueLock);
-    HcTaskWrap taskWarp;
-    taskWarp.task = task;
-    thread->tasks.pushBack(&thread->tasks, &taskWarp);
-    thread->thread.notify(&thread->thread);
-    thread->queueLock.unlock(&thread->queueLock);
+    if (!TaskQueuePush(&thread->tasks, task)) {
+        return HAL_ERR_QUEUE_FULL;
+    }
+    /* pairs with the fence in WaitTask, the thread either sees the task or is woken up */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&thread->isWaiting, __ATOMIC_RELAXED)) {
+        thread->thread.notify(&thread->thread);
+    }
+    return HAL_SUCCESS;
 }
 
 static void Clear(struct HcTaskThreadT* thread)
 {
     thread->queueLock.lock(&thread->queueLock);
-    HcTaskWrap *taskWarp = NULL;
-    uint32_t index;
-    FOR_EACH_HC_VECTOR(thread->tasks, index, taskWarp) {
-        if (taskWarp->task->destroy) {
-            taskWarp->task->destroy(taskWarp->task);
+    HcTaskBase* task = NULL;
+    while (TaskQueuePop(&thread->tasks, &task)) {
+        if (task->destroy) {
+            task->destroy(task);
         }
-        HcFree(taskWarp->task);
+        HcFree(task);
     }
-    thread->tasks.clear(&thread->tasks);
     thread->queueLock.unlock(&thread->queueLock);
 }
 
@@ -72,7 +137,7 @@ static void StopAndClear(struct HcTaskThreadT* thread)
         return;
     }
     thread->clear(thread);
-    thread->quit = HC_TRUE;
+    __atomic_store_n(&thread->quit, HC_TRUE, __ATOMIC_RELEASE);
     thread->thread.notify(&thread->thread);
     thread->thread.join(&thread->thread);
 }
@@ -91,6 +156,19 @@ static int32_t StartTaskThread(struct HcTaskThreadT* thread)
     return res;
 }
 
+static HcTaskBase* WaitTask(HcTaskThread* thread)
+{
+    __atomic_store_n(&thread->isWaiting, HC_TRUE, __ATOMIC_RELAXED);
+    /* pairs with the fence in PushTask, check again after announcing the wait */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    HcTaskBase* task = PopTask(thread);
+    if (task == NULL) {
+        thread->thread.wait(&thread->thread);
+    }
+    __atomic_store_n(&thread->isWaiting, HC_FALSE, __ATOMIC_RELAXED);
+    return task;
+}
+
 static int TaskThreadLoop(void* args)
 {
     HcTaskThread* thread = (HcTaskThread*)args;
@@ -99,26 +177,32 @@ static int TaskThreadLoop(void* args)
     }
 
     while (1) {
-        if (thread->quit) {
+        if (__atomic_load_n(&thread->quit, __ATOMIC_ACQUIRE)) {
             break;
         }
         HcTaskBase* task = PopTask(thread);
+        if (task == NULL) {
+            task = WaitTask(thread);
+        }
         if (task != NULL) {
+            if (thread->useMemArena) {
+                BindMemArena();
+            }
             if (task->doAction) {
                 task->doAction(task);
             }
             if (task->destroy) {
                 task->destroy(task);
             }
+            /* all the memory of the task which is already freed is wiped at once */
+            UnbindMemArena();
             HcFree(task);
-        } else {
-            thread->thread.wait(&thread->thread);
         }
     }
     return 0;
 }
 
-int32_t InitHcTaskThread(HcTaskThread* thread, size_t stackSize, const char* threadName)
+int32_t InitHcTaskThread(HcTaskThread* thread, size_t stackSize, uint32_t queueCapacity, const char* threadName)
 {
     if (thread == NULL) {
         return -1;
@@ -137,13 +221,21 @@ int32_t InitHcTaskThread(HcTaskThread* thread, size_t stackSize, const char* thr
         DestroyThread(&thread->thread);
         return res;
     }
-    thread->tasks = CREATE_HC_VECTOR(TaskVec);
+    res = InitTaskQueue(&thread->tasks, queueCapacity);
+    if (res != 0) {
+        DestroyHcMutex(&thread->queueLock);
+        DestroyThread(&thread->thread);
+        return res;
+    }
+    thread->isWaiting = HC_FALSE;
+    thread->useMemArena = HC_FALSE;
     return 0;
 }
 
 void DestroyHcTaskThread(HcTaskThread* thread)
 {
-    DESTROY_HC_VECTOR(TaskVec, &thread->tasks);
+    HcFree(thread->tasks.slots);
+    thread->tasks.slots = NULL;
     DestroyHcMutex(&thread->queueLock);
     DestroyThread(&thread->thread);
 }
\ No newline at end of file
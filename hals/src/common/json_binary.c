@@ -0,0 +1,541 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "json_binary.h"
+#include <string.h>
+#include "cJSON.h"
+#include "common_util.h"
+#include "hc_error.h"
+#include "hc_log.h"
+#include "hc_mem_arena.h"
+#include "hc_types.h"
+#include "securec.h"
+
+/* a json text starts with '{', '[' or a white space, never with this byte */
+#define JSON_BINARY_MAGIC 0xB5
+#define JSON_BINARY_FORMAT_VERSION 1
+#define JSON_BINARY_HEAD_LEN 2
+#define JSON_BINARY_MAX_DEPTH 32
+#define JSON_TYPE_MASK 0xFF
+#define VARINT_MAX_LEN 10
+#define VARINT_VALUE_BITS 7
+#define VARINT_VALUE_MASK 0x7F
+#define VARINT_MORE_FLAG 0x80
+#define DOUBLE_BYTE_LEN 8
+#define BITS_PER_BYTE 8
+#define INT64_SIGN_SHIFT 63
+/* 2^53, the integers beyond it are not kept exactly in the double of cJSON */
+#define MAX_EXACT_INT_IN_DOUBLE 9007199254740992.0
+
+typedef enum {
+    BIN_TYPE_NULL = 0,
+    BIN_TYPE_FALSE = 1,
+    BIN_TYPE_TRUE = 2,
+    BIN_TYPE_INT = 3,
+    BIN_TYPE_DOUBLE = 4,
+    BIN_TYPE_STRING = 5,
+    BIN_TYPE_HEX = 6,
+    BIN_TYPE_ARRAY = 7,
+    BIN_TYPE_OBJECT = 8,
+} JsonBinaryType;
+
+/* When data is NULL, nothing is written and pos only counts the length of the binary data. */
+typedef struct {
+    uint8_t *data;
+    uint32_t pos;
+} BinaryWriter;
+
+typedef struct {
+    uint8_t *data; /* a copy of the input, the strings are terminated in place while being parsed */
+    uint32_t len;
+    uint32_t pos;
+    char *hexStr;
+    uint32_t hexStrLen;
+} BinaryReader;
+
+static int32_t WriteBytes(BinaryWriter *writer, const uint8_t *bytes, uint32_t len)
+{
+    if (writer->pos > UINT32_MAX - len) {
+        LOGE("The binary data is too long!");
+        return HAL_ERR_INVALID_LEN;
+    }
+    if ((writer->data != NULL) && (len > 0) &&
+        (memcpy_s(writer->data + writer->pos, len, bytes, len) != EOK)) {
+        return HAL_ERR_MEMORY_COPY;
+    }
+    writer->pos += len;
+    return HAL_SUCCESS;
+}
+
+static int32_t WriteVarint(BinaryWriter *writer, uint64_t value)
+{
+    uint8_t buf[VARINT_MAX_LEN] = { 0 };
+    uint32_t len = 0;
+    do {
+        buf[len] = (uint8_t)(value & VARINT_VALUE_MASK);
+        value >>= VARINT_VALUE_BITS;
+        if (value != 0) {
+            buf[len] |= VARINT_MORE_FLAG;
+        }
+        len++;
+    } while (value != 0);
+    return WriteBytes(writer, buf, len);
+}
+
+static int32_t WriteType(BinaryWriter *writer, JsonBinaryType type)
+{
+    uint8_t typeByte = (uint8_t)type;
+    return WriteBytes(writer, &typeByte, sizeof(typeByte));
+}
+
+static int32_t WriteString(BinaryWriter *writer, const char *str)
+{
+    uint32_t len = (uint32_t)strlen(str);
+    int32_t res = WriteVarint(writer, len);
+    if (res != HAL_SUCCESS) {
+        return res;
+    }
+    return WriteBytes(writer, (const uint8_t *)str, len);
+}
+
+/* Only the form made by AddByteToJson is taken, so that the hex string is rebuilt exactly by the receiver. */
+static bool IsUpperHexString(const char *str, uint32_t *strLen)
+{
+    uint32_t len = 0;
+    for (; str[len] != '\0'; len++) {
+        char c = str[len];
+        if (!(((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'F')))) {
+            return false;
+        }
+    }
+    *strLen = len;
+    return (len > 0) && (len % BYTE_TO_HEX_OPER_LENGTH == 0);
+}
+
+static int32_t WriteStringItem(BinaryWriter *writer, const char *str)
+{
+    uint32_t strLen = 0;
+    if (!IsUpperHexString(str, &strLen)) {
+        int32_t res = WriteType(writer, BIN_TYPE_STRING);
+        return (res != HAL_SUCCESS) ? res : WriteString(writer, str);
+    }
+    uint32_t byteLen = strLen / BYTE_TO_HEX_OPER_LENGTH;
+    int32_t res = WriteType(writer, BIN_TYPE_HEX);
+    if (res == HAL_SUCCESS) {
+        res = WriteVarint(writer, byteLen);
+    }
+    if (res != HAL_SUCCESS) {
+        return res;
+    }
+    if (writer->pos > UINT32_MAX - byteLen) {
+        LOGE("The binary data is too long!");
+        return HAL_ERR_INVALID_LEN;
+    }
+    if ((writer->data != NULL) && (HexStringToByte(str, writer->data + writer->pos, byteLen) != HAL_SUCCESS)) {
+        return HAL_FAILED;
+    }
+    writer->pos += byteLen;
+    return HAL_SUCCESS;
+}
+
+static int32_t WriteNumberItem(BinaryWriter *writer, double value)
+{
+    if ((value >= -MAX_EXACT_INT_IN_DOUBLE) && (value <= MAX_EXACT_INT_IN_DOUBLE) &&
+        ((double)(int64_t)value == value)) {
+        int64_t intValue = (int64_t)value;
+        int32_t res = WriteType(writer, BIN_TYPE_INT);
+        /* zigzag, the small negative numbers are kept short as well */
+        return (res != HAL_SUCCESS) ? res :
+            WriteVarint(writer, ((uint64_t)intValue << 1) ^ (uint64_t)(intValue >> INT64_SIGN_SHIFT));
+    }
+    uint64_t bits = 0;
+    (void)memcpy_s(&bits, sizeof(bits), &value, sizeof(value));
+    uint8_t buf[DOUBLE_BYTE_LEN] = { 0 };
+    for (uint32_t i = 0; i < DOUBLE_BYTE_LEN; i++) {
+        buf[i] = (uint8_t)(bits >> (i * BITS_PER_BYTE));
+    }
+    int32_t res = WriteType(writer, BIN_TYPE_DOUBLE);
+    return (res != HAL_SUCCESS) ? res : WriteBytes(writer, buf, DOUBLE_BYTE_LEN);
+}
+
+static int32_t WriteItem(BinaryWriter *writer, const CJson *item, uint32_t depth);
+
+static int32_t WriteChildren(BinaryWriter *writer, const CJson *item, bool isObject, uint32_t depth)
+{
+    int32_t res = WriteType(writer, isObject ? BIN_TYPE_OBJECT : BIN_TYPE_ARRAY);
+    if (res != HAL_SUCCESS) {
+        return res;
+    }
+    uint32_t childNum = 0;
+    for (const CJson *child = item->child; child != NULL; child = child->next) {
+        childNum++;
+    }
+    if ((res = WriteVarint(writer, childNum)) != HAL_SUCCESS) {
+        return res;
+    }
+    for (const CJson *child = item->child; child != NULL; child = child->next) {
+        if (isObject && (child->string == NULL)) {
+            return HAL_ERR_NULL_PTR;
+        }
+        if (isObject && ((res = WriteString(writer, child->string)) != HAL_SUCCESS)) {
+            return res;
+        }
+        if ((res = WriteItem(writer, child, depth + 1)) != HAL_SUCCESS) {
+            return res;
+        }
+    }
+    return HAL_SUCCESS;
+}
+
+static int32_t WriteItem(BinaryWriter *writer, const CJson *item, uint32_t depth)
+{
+    if (depth > JSON_BINARY_MAX_DEPTH) {
+        LOGE("The json is nested too deeply!");
+        return HAL_ERR_INVALID_PARAM;
+    }
+    switch (item->type & JSON_TYPE_MASK) {
+        case cJSON_NULL:
+            return WriteType(writer, BIN_TYPE_NULL);
+        case cJSON_False:
+            return WriteType(writer, BIN_TYPE_FALSE);
+        case cJSON_True:
+            return WriteType(writer, BIN_TYPE_TRUE);
+        case cJSON_Number:
+            return WriteNumberItem(writer, item->valuedouble);
+        case cJSON_String:
+            return (item->valuestring == NULL) ? HAL_ERR_NULL_PTR : WriteStringItem(writer, item->valuestring);
+        case cJSON_Array:
+            return WriteChildren(writer, item, false, depth);
+        case cJSON_Object:
+            return WriteChildren(writer, item, true, depth);
+        default:
+            LOGE("Unsupported json type: %d!", item->type);
+            return HAL_ERR_INVALID_PARAM;
+    }
+}
+
+static int32_t WriteJson(BinaryWriter *writer, const CJson *jsonObj)
+{
+    uint8_t head[JSON_BINARY_HEAD_LEN] = { JSON_BINARY_MAGIC, JSON_BINARY_FORMAT_VERSION };
+    int32_t res = WriteBytes(writer, head, JSON_BINARY_HEAD_LEN);
+    if (res != HAL_SUCCESS) {
+        return res;
+    }
+    return WriteItem(writer, jsonObj, 0);
+}
+
+uint8_t *PackJsonToBinary(const CJson *jsonObj, uint32_t *dataLen)
+{
+    if ((jsonObj == NULL) || (dataLen == NULL)) {
+        LOGE("Param is null.");
+        return NULL;
+    }
+    /* the first pass only counts the length, so the data is written to a buffer of the exact size */
+    BinaryWriter writer = { NULL, 0 };
+    if (WriteJson(&writer, jsonObj) != HAL_SUCCESS) {
+        LOGE("Failed to count the length of the binary data!");
+        return NULL;
+    }
+    uint32_t len = writer.pos;
+    writer.data = (uint8_t *)HcMalloc(len, 0);
+    if (writer.data == NULL) {
+        LOGE("Failed to allocate binary data memory!");
+        return NULL;
+    }
+    writer.pos = 0;
+    if (WriteJson(&writer, jsonObj) != HAL_SUCCESS) {
+        LOGE("Failed to pack json to binary!");
+        HcFree(writer.data);
+        return NULL;
+    }
+    *dataLen = len;
+    return writer.data;
+}
+
+void FreeJsonBinary(uint8_t *data)
+{
+    HcFree(data);
+}
+
+static bool ReadByte(BinaryReader *reader, uint8_t *value)
+{
+    if (reader->pos >= reader->len) {
+        return false;
+    }
+    *value = reader->data[reader->pos++];
+    return true;
+}
+
+static bool ReadVarint(BinaryReader *reader, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (uint32_t i = 0; i < VARINT_MAX_LEN; i++) {
+        uint8_t byte = 0;
+        if (!ReadByte(reader, &byte)) {
+            return false;
+        }
+        result |= (uint64_t)(byte & VARINT_VALUE_MASK) << (i * VARINT_VALUE_BITS);
+        if ((byte & VARINT_MORE_FLAG) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Every item takes one byte at least, so a length or a count beyond the rest of the data is a broken one. */
+static bool ReadLength(BinaryReader *reader, uint32_t *len)
+{
+    uint64_t value = 0;
+    if (!ReadVarint(reader, &value) || (value > reader->len - reader->pos)) {
+        return false;
+    }
+    *len = (uint32_t)value;
+    return true;
+}
+
+/* The string is terminated in place, the caller needs to call RestoreString when it's no longer in use. */
+static char *ReadString(BinaryReader *reader, uint8_t *saved)
+{
+    uint32_t len = 0;
+    if (!ReadLength(reader, &len)) {
+        return NULL;
+    }
+    char *str = (char *)(reader->data + reader->pos);
+    if (memchr(str, '\0', len) != NULL) {
+        return NULL;
+    }
+    reader->pos += len;
+    *saved = reader->data[reader->pos];
+    reader->data[reader->pos] = '\0';
+    return str;
+}
+
+static void RestoreString(BinaryReader *reader, const char *str, uint8_t saved)
+{
+    reader->data[(const uint8_t *)str - reader->data + strlen(str)] = saved;
+}
+
+static CJson *ReadStringItem(BinaryReader *reader)
+{
+    uint8_t saved = 0;
+    char *str = ReadString(reader, &saved);
+    if (str == NULL) {
+        return NULL;
+    }
+    CJson *item = cJSON_CreateString(str);
+    RestoreString(reader, str, saved);
+    return item;
+}
+
+static CJson *ReadHexItem(BinaryReader *reader)
+{
+    uint32_t byteLen = 0;
+    if (!ReadLength(reader, &byteLen) || (byteLen == 0) ||
+        (byteLen > (UINT32_MAX - 1) / BYTE_TO_HEX_OPER_LENGTH)) {
+        return NULL;
+    }
+    uint32_t hexLen = byteLen * BYTE_TO_HEX_OPER_LENGTH + 1;
+    if (hexLen > reader->hexStrLen) {
+        HcFree(reader->hexStr);
+        reader->hexStrLen = 0;
+        reader->hexStr = (char *)HcMalloc(hexLen, 0);
+        if (reader->hexStr == NULL) {
+            return NULL;
+        }
+        reader->hexStrLen = hexLen;
+    }
+    if (ByteToHexString(reader->data + reader->pos, byteLen, reader->hexStr, hexLen) != HAL_SUCCESS) {
+        return NULL;
+    }
+    reader->pos += byteLen;
+    return cJSON_CreateString(reader->hexStr);
+}
+
+static CJson *ReadIntItem(BinaryReader *reader)
+{
+    uint64_t value = 0;
+    if (!ReadVarint(reader, &value)) {
+        return NULL;
+    }
+    int64_t intValue = (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    return cJSON_CreateNumber((double)intValue);
+}
+
+static CJson *ReadDoubleItem(BinaryReader *reader)
+{
+    if (reader->len - reader->pos < DOUBLE_BYTE_LEN) {
+        return NULL;
+    }
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < DOUBLE_BYTE_LEN; i++) {
+        bits |= (uint64_t)reader->data[reader->pos + i] << (i * BITS_PER_BYTE);
+    }
+    reader->pos += DOUBLE_BYTE_LEN;
+    double value = 0;
+    (void)memcpy_s(&value, sizeof(value), &bits, sizeof(bits));
+    return cJSON_CreateNumber(value);
+}
+
+static CJson *ReadItem(BinaryReader *reader, uint32_t depth);
+
+static bool ReadObjectMember(BinaryReader *reader, CJson *obj, uint32_t depth)
+{
+    uint8_t saved = 0;
+    char *key = ReadString(reader, &saved);
+    if (key == NULL) {
+        return false;
+    }
+    /* the value begins at the byte replaced by the terminator of the key, the key is terminated again later */
+    uint32_t keyEnd = reader->pos;
+    reader->data[keyEnd] = saved;
+    CJson *value = ReadItem(reader, depth + 1);
+    if (value == NULL) {
+        return false;
+    }
+    reader->data[keyEnd] = '\0';
+    bool isAdded = cJSON_AddItemToObject(obj, key, value);
+    reader->data[keyEnd] = saved;
+    if (!isAdded) {
+        cJSON_Delete(value);
+    }
+    return isAdded;
+}
+
+static CJson *ReadChildren(BinaryReader *reader, bool isObject, uint32_t depth)
+{
+    uint32_t childNum = 0;
+    if (!ReadLength(reader, &childNum)) {
+        return NULL;
+    }
+    CJson *item = isObject ? cJSON_CreateObject() : cJSON_CreateArray();
+    if (item == NULL) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < childNum; i++) {
+        if (isObject) {
+            if (!ReadObjectMember(reader, item, depth)) {
+                cJSON_Delete(item);
+                return NULL;
+            }
+            continue;
+        }
+        CJson *child = ReadItem(reader, depth + 1);
+        if ((child == NULL) || !cJSON_AddItemToArray(item, child)) {
+            cJSON_Delete(child);
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+    return item;
+}
+
+static CJson *ReadItem(BinaryReader *reader, uint32_t depth)
+{
+    uint8_t type = 0;
+    if ((depth > JSON_BINARY_MAX_DEPTH) || !ReadByte(reader, &type)) {
+        return NULL;
+    }
+    switch (type) {
+        case BIN_TYPE_NULL:
+            return cJSON_CreateNull();
+        case BIN_TYPE_FALSE:
+            return cJSON_CreateFalse();
+        case BIN_TYPE_TRUE:
+            return cJSON_CreateTrue();
+        case BIN_TYPE_INT:
+            return ReadIntItem(reader);
+        case BIN_TYPE_DOUBLE:
+            return ReadDoubleItem(reader);
+        case BIN_TYPE_STRING:
+            return ReadStringItem(reader);
+        case BIN_TYPE_HEX:
+            return ReadHexItem(reader);
+        case BIN_TYPE_ARRAY:
+            return ReadChildren(reader, false, depth);
+        case BIN_TYPE_OBJECT:
+            return ReadChildren(reader, true, depth);
+        default:
+            return NULL;
+    }
+}
+
+bool IsJsonBinary(const uint8_t *data, uint32_t dataLen)
+{
+    return (data != NULL) && (dataLen > 0) && (data[0] == JSON_BINARY_MAGIC);
+}
+
+CJson *CreateJsonFromBinary(const uint8_t *data, uint32_t dataLen)
+{
+    if (!IsJsonBinary(data, dataLen) || (dataLen < JSON_BINARY_HEAD_LEN) || (dataLen == UINT32_MAX)) {
+        LOGE("Invalid binary data!");
+        return NULL;
+    }
+    if (data[1] != JSON_BINARY_FORMAT_VERSION) {
+        LOGE("Unsupported binary format version: %u!", data[1]);
+        return NULL;
+    }
+    /* one more byte for the terminator of the last string */
+    BinaryReader reader = { NULL, dataLen, JSON_BINARY_HEAD_LEN, NULL, 0 };
+    reader.data = (uint8_t *)HcMalloc(dataLen + 1, 0);
+    if (reader.data == NULL) {
+        LOGE("Failed to allocate binary data memory!");
+        return NULL;
+    }
+    if (memcpy_s(reader.data, dataLen + 1, data, dataLen) != EOK) {
+        HcFree(reader.data);
+        return NULL;
+    }
+    /* the json memory may come from the memory arena, like that of the json wrappers */
+    EnterJsonArenaScope();
+    CJson *jsonObj = ReadItem(&reader, 0);
+    LeaveJsonArenaScope();
+    if ((jsonObj != NULL) && (reader.pos != reader.len)) {
+        cJSON_Delete(jsonObj);
+        jsonObj = NULL;
+    }
+    if (jsonObj == NULL) {
+        LOGE("Failed to create json from binary!");
+    }
+    HcFree(reader.hexStr);
+    HcFree(reader.data);
+    return jsonObj;
+}
+
+CJson *CreateJsonFromData(const uint8_t *data, uint32_t dataLen)
+{
+    if ((data == NULL) || (dataLen == 0)) {
+        LOGE("Param is null.");
+        return NULL;
+    }
+    if (IsJsonBinary(data, dataLen)) {
+        return CreateJsonFromBinary(data, dataLen);
+    }
+    if (data[dataLen - 1] == '\0') {
+        return CreateJsonFromString((const char *)data);
+    }
+    char *str = (char *)HcMalloc(dataLen + 1, 0);
+    if (str == NULL) {
+        LOGE("Failed to allocate data memory!");
+        return NULL;
+    }
+    if (memcpy_s(str, dataLen + 1, data, dataLen) != EOK) {
+        HcFree(str);
+        return NULL;
+    }
+    CJson *jsonObj = CreateJsonFromString(str);
+    HcFree(str);
+    return jsonObj;
+}
@@ -18,27 +18,42 @@
 #include "common_util.h"
 #include "hc_error.h"
 #include "hc_log.h"
+#include "hc_mem_arena.h"
 #include "hc_types.h"
 
 #define RECURSE_FLAG_TRUE 1
 
+/* Only the json memory allocated by the wrappers below may come from the memory arena, see hc_mem_arena.h. */
+#define CALL_IN_JSON_ARENA(res, call) \
+    do { \
+        EnterJsonArenaScope(); \
+        (res) = (call); \
+        LeaveJsonArenaScope(); \
+    } while (0)
+
 CJson *CreateJsonFromString(const char *jsonStr)
 {
     if (jsonStr == NULL) {
         LOGE("Param is null.");
         return NULL;
     }
-    return cJSON_Parse(jsonStr);
+    CJson *jsonObj = NULL;
+    CALL_IN_JSON_ARENA(jsonObj, cJSON_Parse(jsonStr));
+    return jsonObj;
 }
 
 CJson *CreateJson(void)
 {
-    return cJSON_CreateObject();
+    CJson *jsonObj = NULL;
+    CALL_IN_JSON_ARENA(jsonObj, cJSON_CreateObject());
+    return jsonObj;
 }
 
 CJson *CreateJsonArray(void)
 {
-    return cJSON_CreateArray();
+    CJson *jsonArr = NULL;
+    CALL_IN_JSON_ARENA(jsonArr, cJSON_CreateArray());
+    return jsonArr;
 }
 
 CJson *DuplicateJson(const CJson *jsonObj)
@@ -47,7 +62,9 @@ CJson *DuplicateJson(const CJson *jsonObj)
         LOGE("Param is null.");
         return NULL;
     }
-    return cJSON_Duplicate(jsonObj, RECURSE_FLAG_TRUE);
+    CJson *dupObj = NULL;
+    CALL_IN_JSON_ARENA(dupObj, cJSON_Duplicate(jsonObj, RECURSE_FLAG_TRUE));
+    return dupObj;
 }
 
 void FreeJson(CJson *jsonObj)
@@ -114,7 +131,9 @@ char *PackJsonToString(const CJson *jsonObj)
         LOGE("Param is null.");
         return NULL;
     }
-    return cJSON_PrintUnformatted(jsonObj);
+    char *jsonStr = NULL;
+    CALL_IN_JSON_ARENA(jsonStr, cJSON_PrintUnformatted(jsonObj));
+    return jsonStr;
 }
 
 void FreeJsonString(char *jsonStr)
@@ -335,21 +354,25 @@ int32_t AddObjToJson(CJson *jsonObj, const char *key, const CJson *childObj)
         return HAL_ERR_NULL_PTR;
     }
 
-    cJSON *tmpObj = cJSON_Duplicate(childObj, RECURSE_FLAG_TRUE);
+    cJSON *tmpObj = NULL;
+    CALL_IN_JSON_ARENA(tmpObj, cJSON_Duplicate(childObj, RECURSE_FLAG_TRUE));
     if (tmpObj == NULL) {
         LOGE("Duplicate json object failed.");
         return HAL_ERR_JSON_DUPLICATE;
     }
 
     cJSON *objInJson = cJSON_GetObjectItemCaseSensitive(jsonObj, key);
+    bool isAdded = false;
     if (objInJson == NULL) {
-        if (cJSON_AddItemToObject(jsonObj, key, tmpObj) == false) {
+        CALL_IN_JSON_ARENA(isAdded, cJSON_AddItemToObject(jsonObj, key, tmpObj));
+        if (isAdded == false) {
             LOGE("Add object to json failed.");
             cJSON_Delete(tmpObj);
             return HAL_ERR_JSON_ADD;
         }
     } else {
-        if (cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmpObj) == false) {
+        CALL_IN_JSON_ARENA(isAdded, cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmpObj));
+        if (isAdded == false) {
             LOGE("Replace object in json failed.");
             cJSON_Delete(tmpObj);
             return HAL_ERR_JSON_REPLACE;
@@ -392,7 +415,8 @@ int32_t AddStringToArray(CJson *jsonArr, const char *string)
         return HAL_ERR_INVALID_PARAM;
     }
 
-    cJSON *strObj = cJSON_CreateString(string);
+    cJSON *strObj = NULL;
+    CALL_IN_JSON_ARENA(strObj, cJSON_CreateString(string));
     if (strObj == NULL) {
         LOGE("Create string json object failed.");
         return HAL_ERR_BAD_ALLOC;
@@ -415,18 +439,22 @@ int32_t AddStringToJson(CJson *jsonObj, const char *key, const char *value)
     }
 
     cJSON *objInJson = cJSON_GetObjectItemCaseSensitive(jsonObj, key);
+    cJSON *tmp = NULL;
     if (objInJson == NULL) {
-        if (cJSON_AddStringToObject(jsonObj, key, value) == NULL) {
+        CALL_IN_JSON_ARENA(tmp, cJSON_AddStringToObject(jsonObj, key, value));
+        if (tmp == NULL) {
             LOGE("Add string to json failed.");
             return HAL_ERR_JSON_GET;
         }
     } else {
-        cJSON *tmp = cJSON_CreateString(value);
+        CALL_IN_JSON_ARENA(tmp, cJSON_CreateString(value));
         if (tmp == NULL) {
             LOGE("Create string json object failed.");
             return HAL_ERR_BAD_ALLOC;
         }
-        if (cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmp) == false) {
+        bool isReplaced = false;
+        CALL_IN_JSON_ARENA(isReplaced, cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmp));
+        if (isReplaced == false) {
             LOGE("Replace string in json failed.");
             cJSON_Delete(tmp);
             return HAL_ERR_JSON_REPLACE;
@@ -475,18 +503,22 @@ int32_t AddBoolToJson(CJson *jsonObj, const char *key, bool value)
     }
 
     cJSON *objInJson = cJSON_GetObjectItemCaseSensitive(jsonObj, key);
+    cJSON *tmp = NULL;
     if (objInJson == NULL) {
-        if (cJSON_AddBoolToObject(jsonObj, key, value) == NULL) {
+        CALL_IN_JSON_ARENA(tmp, cJSON_AddBoolToObject(jsonObj, key, value));
+        if (tmp == NULL) {
             LOGE("Add bool to json failed.");
             return HAL_ERR_JSON_GET;
         }
     } else {
-        cJSON *tmp = cJSON_CreateBool(value);
+        CALL_IN_JSON_ARENA(tmp, cJSON_CreateBool(value));
         if (tmp == NULL) {
             LOGE("Create bool json object failed.");
             return HAL_ERR_BAD_ALLOC;
         }
-        if (cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmp) == false) {
+        bool isReplaced = false;
+        CALL_IN_JSON_ARENA(isReplaced, cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmp));
+        if (isReplaced == false) {
             LOGE("Repalce bool in json failed.");
             cJSON_Delete(tmp);
             return HAL_ERR_JSON_REPLACE;
@@ -504,18 +536,22 @@ int32_t AddIntToJson(CJson *jsonObj, const char *key, int value)
     }
 
     cJSON *objInJson = cJSON_GetObjectItemCaseSensitive(jsonObj, key);
+    cJSON *tmp = NULL;
     if (objInJson == NULL) {
-        if (cJSON_AddNumberToObject(jsonObj, key, value) == NULL) {
+        CALL_IN_JSON_ARENA(tmp, cJSON_AddNumberToObject(jsonObj, key, value));
+        if (tmp == NULL) {
             LOGE("Add int to json failed.");
             return HAL_ERR_JSON_GET;
         }
     } else {
-        cJSON *tmp = cJSON_CreateNumber(value);
+        CALL_IN_JSON_ARENA(tmp, cJSON_CreateNumber(value));
         if (tmp == NULL) {
             LOGE("Create int json object failed.");
             return HAL_ERR_BAD_ALLOC;
         }
-        if (cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmp) == false) {
+        bool isReplaced = false;
+        CALL_IN_JSON_ARENA(isReplaced, cJSON_ReplaceItemInObjectCaseSensitive(jsonObj, key, tmp));
+        if (isReplaced == false) {
             LOGE("Replace int in json failed.");
             cJSON_Delete(tmp);
             return HAL_ERR_JSON_REPLACE;
@@ -546,12 +582,15 @@ int32_t AddStringArrayToJson(CJson *jsonObj, const char *key, const char * const
         return HAL_ERR_NULL_PTR;
     }
 
-    cJSON *strArrayObj = cJSON_CreateStringArray(stringArray, arrayLen);
+    cJSON *strArrayObj = NULL;
+    CALL_IN_JSON_ARENA(strArrayObj, cJSON_CreateStringArray(stringArray, arrayLen));
     if (strArrayObj == NULL) {
         LOGE("Create string array object failed.");
         return HAL_ERR_BAD_ALLOC;
     }
-    if (cJSON_AddItemToObject(jsonObj, key, strArrayObj) == false) {
+    bool isAdded = false;
+    CALL_IN_JSON_ARENA(isAdded, cJSON_AddItemToObject(jsonObj, key, strArrayObj));
+    if (isAdded == false) {
         LOGE("Add string array to json failed.");
         cJSON_Delete(strArrayObj);
         return HAL_ERR_JSON_ADD;
@@ -14,6 +14,8 @@
  */
 
 #include "hc_dev_info.h"
+#include <stdlib.h>
+#include "common_util.h"
 #include "hc_error.h"
 #include "hc_log.h"
 #include "securec.h"
@@ -22,6 +24,9 @@
 #include "parameter.h"
 #endif
 
+#define MAX_SESSION_PARAM_KEY "persist.deviceauth.max_session"
+#define MAX_SESSION_PARAM_LEN 16
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -57,6 +62,23 @@ const char *GetStoragePath()
     return storageFile;
 }
 
+uint32_t HcGetMaxSessionCount(void)
+{
+#ifndef LITE_DEVICE
+    /* hub devices raise the limit with this parameter, e.g. "param set persist.deviceauth.max_session 1024" */
+    char value[MAX_SESSION_PARAM_LEN] = { 0 };
+    if (GetParameter(MAX_SESSION_PARAM_KEY, "", value, sizeof(value)) > 0) {
+        char *end = NULL;
+        unsigned long count = strtoul(value, &end, DEC);
+        if ((end != value) && (*end == '\0') && (count > 0) && (count <= MAX_SESSION_COUNT_LIMIT)) {
+            return (uint32_t)count;
+        }
+        LOGW("Invalid max session count: %s, use the default value.", value);
+    }
+#endif
+    return MAX_SESSION_COUNT;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,4 +49,9 @@ int32_t HcGetUdid(uint8_t *udid, int32_t udidLen)
 const char *GetStoragePath()
 {
     return "user/Hichain/hcgroup.dat";
-}
\ No newline at end of file
+}
+
+uint32_t HcGetMaxSessionCount(void)
+{
+    return MAX_SESSION_COUNT;
+}
@@ -17,7 +17,9 @@
 #include "securec.h"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
 #include <unistd.h>
 #include "hc_log.h"
 #include "hc_types.h"
@@ -28,26 +30,30 @@ extern "C" {
 
 #define MAX_FILE_PATH_SIZE 256
 #define MAX_FOLDER_NAME_SIZE 128
+#define TEMP_FILE_SUFFIX ".tmp"
+#define BACKUP_FILE_SUFFIX ".bak"
+#define BACKUP_TEMP_FILE_SUFFIX ".bak.tmp"
 
 typedef struct {
     FileIdEnum fileId;
     const char *filePath;
 } FileDefInfo;
 
-static char g_groupPath[MAX_FILE_PATH_SIZE] = { 0 };
+static char g_filePath[FILE_ID_LAST][MAX_FILE_PATH_SIZE] = { { 0 } };
 
 static FileDefInfo g_fileDefInfo[FILE_ID_LAST] = {
     { FILE_ID_GROUP, "/data/data/deviceauth/hcgroup.dat" },
+    { FILE_ID_GROUP_JOURNAL, "/data/data/deviceauth/hcgroup.journal" },
 };
 
 void SetFilePath(FileIdEnum fileId, const char *path)
 {
-    if (path == NULL) {
+    if (path == NULL || fileId >= FILE_ID_LAST) {
         LOGE("Invalid path param");
         return;
     }
-    if (sprintf_s(g_groupPath, MAX_FILE_PATH_SIZE, "%s", path) != -1) {
-        g_fileDefInfo[fileId].filePath = g_groupPath;
+    if (sprintf_s(g_filePath[fileId], MAX_FILE_PATH_SIZE, "%s", path) != -1) {
+        g_fileDefInfo[fileId].filePath = g_filePath[fileId];
     }
 }
 
@@ -83,13 +89,45 @@ static int32_t CreateDirectory(const char *filePath)
     return 0;
 }
 
+static int32_t GetSiblingFilePath(int fileId, const char *suffix, char *path, uint32_t pathSize)
+{
+    if (sprintf_s(path, pathSize, "%s%s", g_fileDefInfo[fileId].filePath, suffix) == -1) {
+        LOGE("Failed to generate file path, fileId:%d", fileId);
+        return -1;
+    }
+    return 0;
+}
+
+static void SyncParentDirectory(const char *path)
+{
+    char dirPath[MAX_FILE_PATH_SIZE];
+    const char *sep = strrchr(path, '/');
+    if (sep == NULL) {
+        return;
+    }
+    size_t len = (sep == path) ? 1 : (size_t)(sep - path);
+    if (memcpy_s(dirPath, sizeof(dirPath) - 1, path, len) != EOK) {
+        return;
+    }
+    dirPath[len] = '\0';
+    int fd = open(dirPath, O_RDONLY);
+    if (fd < 0) {
+        LOGW("Failed to open the directory to sync, errno:%d", errno);
+        return;
+    }
+    if (fsync(fd) != 0) {
+        LOGW("Failed to sync the directory, errno:%d", errno);
+    }
+    close(fd);
+}
+
 static FILE *HcFileOpenRead(int fileId, const char *path)
 {
     (void)fileId;
     return fopen(path, "rb");
 }
 
-static FILE *HcFileOpenWrite(int32_t fileId, const char *path)
+static FILE *HcFileOpenWrite(int32_t fileId, const char *path, const char *fileMode)
 {
     (void)fileId;
     if (access(path, F_OK) != 0) {
@@ -98,7 +136,7 @@ static FILE *HcFileOpenWrite(int32_t fileId, const char *path)
             return NULL;
         }
     }
-    return fopen(path, "w+");
+    return fopen(path, fileMode);
 }
 
 int HcFileOpen(int fileId, int mode, FileHandle *file)
@@ -106,10 +144,29 @@ int HcFileOpen(int fileId, int mode, FileHandle *file)
     if (fileId < 0 || fileId >= FILE_ID_LAST || file == NULL) {
         return -1;
     }
+    char path[MAX_FILE_PATH_SIZE];
     if (mode == MODE_FILE_READ) {
         file->pfd = HcFileOpenRead(fileId, g_fileDefInfo[fileId].filePath);
+    } else if (mode == MODE_FILE_READ_BACKUP) {
+        if (GetSiblingFilePath(fileId, BACKUP_FILE_SUFFIX, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        file->pfd = HcFileOpenRead(fileId, path);
+    } else if (mode == MODE_FILE_WRITE_TEMP) {
+        if (GetSiblingFilePath(fileId, TEMP_FILE_SUFFIX, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        file->pfd = HcFileOpenWrite(fileId, path, "wb");
+    } else if (mode == MODE_FILE_APPEND) {
+        const char *filePath = g_fileDefInfo[fileId].filePath;
+        bool isCreated = (access(filePath, F_OK) != 0);
+        file->pfd = HcFileOpenWrite(fileId, filePath, "ab");
+        /* the new file must be found after a crash, once its data is synced */
+        if (isCreated && (file->pfd != NULL)) {
+            SyncParentDirectory(filePath);
+        }
     } else {
-        file->pfd = HcFileOpenWrite(fileId, g_fileDefInfo[fileId].filePath);
+        file->pfd = HcFileOpenWrite(fileId, g_fileDefInfo[fileId].filePath, "w+");
     }
     if (file->pfd == NULL) {
         return -1;
@@ -187,13 +244,116 @@ void HcFileClose(FileHandle file)
     fclose(fp);
 }
 
+int HcFileSync(FileHandle file)
+{
+    FILE *fp = (FILE *)file.pfd;
+    if (fp == NULL) {
+        return -1;
+    }
+    if ((fflush(fp) != 0) || (fsync(fileno(fp)) != 0)) {
+        LOGE("Failed to sync the file, errno:%d", errno);
+        return -1;
+    }
+    return 0;
+}
+
 void HcFileRemove(int fileId)
 {
     if (fileId >= FILE_ID_LAST) {
         LOGE("Invalid fileId:%d", fileId);
         return;
     }
-    unlink(g_fileDefInfo[fileId].filePath);
+    /* the removal must be on disk before the caller relies on it */
+    if (unlink(g_fileDefInfo[fileId].filePath) == 0) {
+        SyncParentDirectory(g_fileDefInfo[fileId].filePath);
+    }
+}
+
+int HcFileTruncate(int fileId, int size)
+{
+    if (fileId < 0 || fileId >= FILE_ID_LAST || size < 0) {
+        return -1;
+    }
+    int fd = open(g_fileDefInfo[fileId].filePath, O_WRONLY);
+    if (fd < 0) {
+        LOGE("Failed to open the file to truncate, errno:%d", errno);
+        return -1;
+    }
+    int ret = ((ftruncate(fd, (off_t)size) == 0) && (fsync(fd) == 0)) ? 0 : -1;
+    if (ret != 0) {
+        LOGE("Failed to truncate the file, errno:%d", errno);
+    }
+    close(fd);
+    return ret;
+}
+
+/*
+ * Keep the current generation of the file as the previous one. It is linked to a temporary name and renamed
+ * over the previous one, so a valid previous generation exists at every moment of the update.
+ */
+static void KeepPreviousGeneration(int fileId, const char *backupPath)
+{
+    char backupTempPath[MAX_FILE_PATH_SIZE];
+    if (GetSiblingFilePath(fileId, BACKUP_TEMP_FILE_SUFFIX, backupTempPath, sizeof(backupTempPath)) != 0) {
+        return;
+    }
+    if ((unlink(backupTempPath) != 0) && (errno != ENOENT)) {
+        LOGW("Failed to remove the temporary previous generation, errno:%d", errno);
+        return;
+    }
+    if (link(g_fileDefInfo[fileId].filePath, backupTempPath) != 0) {
+        if (errno != ENOENT) {
+            LOGW("Failed to keep the previous generation, errno:%d", errno);
+        }
+        return;
+    }
+    if (rename(backupTempPath, backupPath) != 0) {
+        LOGW("Failed to replace the previous generation, errno:%d", errno);
+        unlink(backupTempPath);
+    }
+}
+
+int HcFileCommit(int fileId, FileHandle file, bool keepBackup)
+{
+    FILE *fp = (FILE *)file.pfd;
+    if (fileId < 0 || fileId >= FILE_ID_LAST || fp == NULL) {
+        return -1;
+    }
+    /* the data must be on disk before the rename makes it visible */
+    int ret = ((fflush(fp) == 0) && (fsync(fileno(fp)) == 0)) ? 0 : -1;
+    if (fclose(fp) != 0) {
+        ret = -1;
+    }
+    char tempPath[MAX_FILE_PATH_SIZE];
+    if (GetSiblingFilePath(fileId, TEMP_FILE_SUFFIX, tempPath, sizeof(tempPath)) != 0) {
+        return -1;
+    }
+    if (ret != 0) {
+        LOGE("Failed to sync the temporary file, errno:%d", errno);
+        unlink(tempPath);
+        return -1;
+    }
+    char backupPath[MAX_FILE_PATH_SIZE];
+    if (GetSiblingFilePath(fileId, BACKUP_FILE_SUFFIX, backupPath, sizeof(backupPath)) != 0) {
+        unlink(tempPath);
+        return -1;
+    }
+    const char *filePath = g_fileDefInfo[fileId].filePath;
+    /*
+     * keep the current generation as a hard link, the reader falls back to it if the file is broken.
+     * A file which failed to load is never kept, the previous generation is the last good one then.
+     * The file itself is only replaced by the rename, so it exists at every moment of the update.
+     */
+    if (!keepBackup) {
+        KeepPreviousGeneration(fileId, backupPath);
+    }
+    if (rename(tempPath, filePath) != 0) {
+        LOGE("Failed to replace the file, errno:%d", errno);
+        unlink(tempPath);
+        return -1;
+    }
+    SyncParentDirectory(filePath);
+    return 0;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hc_mem_arena.h"
+
+#include <stdlib.h>
+#include "cJSON.h"
+#include "hc_error.h"
+#include "hc_log.h"
+#include "hc_mutex.h"
+#include "securec.h"
+
+#define ARENA_ALIGN 8
+#define ARENA_ROUND_UP(size) (((size) + (ARENA_ALIGN - 1)) & ~(uint32_t)(ARENA_ALIGN - 1))
+/* a larger allocation would waste the most part of a chunk, so it goes to the heap */
+#define ARENA_MAX_ALLOC_DIVISOR 4
+#define ARENA_MIN_CHUNK_SIZE 1024
+#define ARENA_NO_CHUNK UINT32_MAX
+
+enum {
+    ARENA_STATE_NONE = 0,
+    ARENA_STATE_ACTIVE,
+    ARENA_STATE_DESTROYING,
+};
+
+typedef struct {
+    uint32_t used; /* the bumped bytes, only written by the thread which holds the chunk */
+    uint32_t refNum; /* the live allocations, plus one while a thread holds the chunk */
+} HcMemChunk;
+
+typedef struct {
+    uint8_t *base;
+    uintptr_t regionSize;
+    uint32_t chunkSize;
+    uint32_t chunkShift;
+    uint32_t chunkNum;
+    uint32_t maxAllocSize;
+    HcMemChunk *chunks;
+    uint32_t *freeChunks; /* the stack of the indexes of the free chunks */
+    uint32_t freeChunkNum;
+    uint32_t allocNum;
+    uint32_t fallbackNum;
+    int32_t state;
+    HcMutex lock;
+} HcMemArena;
+
+static HcMemArena g_arena;
+static HcBool g_isHookInstalled = HC_FALSE;
+static HcBool g_isHookReplaced = HC_FALSE;
+/* returned by the hook to the probe, which finds out whether the hooks are still installed */
+static uint8_t g_hookProbe;
+
+static __thread HcBool g_isBound = HC_FALSE;
+static __thread HcBool g_isExhausted = HC_FALSE;
+static __thread uint32_t g_curChunk = ARENA_NO_CHUNK;
+static __thread uint32_t g_jsonScopeDepth = 0;
+static __thread HcBool g_isProbing = HC_FALSE;
+static __thread HcBool g_isProbeHit = HC_FALSE;
+
+static void *JsonMalloc(size_t size)
+{
+    if (g_isProbing) {
+        g_isProbeHit = HC_TRUE;
+        return &g_hookProbe;
+    }
+    void *addr = NULL;
+    /* the replaced hooks may be installed again, the memory would be freed to them in between */
+    if (g_jsonScopeDepth > 0 && size <= UINT32_MAX && !__atomic_load_n(&g_isHookReplaced, __ATOMIC_RELAXED)) {
+        addr = MemArenaAlloc((uint32_t)size);
+    }
+    return (addr != NULL) ? addr : malloc(size);
+}
+
+static void JsonFree(void *addr)
+{
+    if (addr == &g_hookProbe) {
+        return;
+    }
+    if (!MemArenaFree(addr)) {
+        free(addr);
+    }
+}
+
+static HcBool IsJsonHookInstalled(void)
+{
+    g_isProbing = HC_TRUE;
+    g_isProbeHit = HC_FALSE;
+    void *addr = cJSON_malloc(1);
+    g_isProbing = HC_FALSE;
+    cJSON_free(addr);
+    return g_isProbeHit;
+}
+
+/* Another module installed its cJSON hooks, the json memory must not come from the arena from now on. */
+static void CheckJsonHook(void)
+{
+    if (!g_isHookInstalled || __atomic_load_n(&g_isHookReplaced, __ATOMIC_RELAXED)) {
+        return;
+    }
+    if (!IsJsonHookInstalled()) {
+        __atomic_store_n(&g_isHookReplaced, HC_TRUE, __ATOMIC_RELAXED);
+        LOGE("The cJSON hooks of the memory arena are replaced by another module!");
+    }
+}
+
+static void FreeArena(void)
+{
+    uint8_t *region = g_arena.base;
+    HcMemChunk *chunks = g_arena.chunks;
+    uint32_t *freeChunks = g_arena.freeChunks;
+    /* no address is taken for the arena from now on, even if the heap gives the region out again */
+    __atomic_store_n(&g_arena.base, NULL, __ATOMIC_RELEASE);
+    DestroyHcMutex(&g_arena.lock);
+    HcFree(region);
+    HcFree(chunks);
+    HcFree(freeChunks);
+    g_arena.chunks = NULL;
+    g_arena.freeChunks = NULL;
+    __atomic_store_n(&g_arena.state, ARENA_STATE_NONE, __ATOMIC_RELEASE);
+    LOGI("The memory arena is freed.");
+}
+
+static uint32_t TakeChunk(void)
+{
+    uint32_t index = ARENA_NO_CHUNK;
+    g_arena.lock.lock(&g_arena.lock);
+    if (g_arena.freeChunkNum > 0) {
+        index = g_arena.freeChunks[--g_arena.freeChunkNum];
+    }
+    g_arena.lock.unlock(&g_arena.lock);
+    if (index != ARENA_NO_CHUNK) {
+        /* the bias of the holder, the chunk is not recycled while the thread bumps in it */
+        __atomic_store_n(&g_arena.chunks[index].refNum, 1, __ATOMIC_RELAXED);
+    }
+    return index;
+}
+
+static void RecycleChunk(uint32_t index)
+{
+    HcMemChunk *chunk = &g_arena.chunks[index];
+    /* all the memory of the chunk is dead, wipe it in one go so that it is zeroed for the next holder */
+    (void)memset_s(g_arena.base + ((uintptr_t)index << g_arena.chunkShift), g_arena.chunkSize, 0, chunk->used);
+    chunk->used = 0;
+    g_arena.lock.lock(&g_arena.lock);
+    g_arena.freeChunks[g_arena.freeChunkNum++] = index;
+    HcBool isLast = (g_arena.state == ARENA_STATE_DESTROYING) && (g_arena.freeChunkNum == g_arena.chunkNum);
+    g_arena.lock.unlock(&g_arena.lock);
+    if (isLast) {
+        FreeArena();
+    }
+}
+
+static void ReleaseChunk(uint32_t index)
+{
+    /* the last release sees all the writes of the chunk made by the other threads */
+    if (__atomic_sub_fetch(&g_arena.chunks[index].refNum, 1, __ATOMIC_ACQ_REL) == 0) {
+        RecycleChunk(index);
+    }
+}
+
+static uint32_t GetChunkShift(uint32_t chunkSize)
+{
+    uint32_t shift = 0;
+    while ((1U << shift) < chunkSize) {
+        shift++;
+    }
+    return shift;
+}
+
+static int32_t AllocArena(uint32_t chunkSize, uint32_t chunkNum)
+{
+    g_arena.chunkShift = GetChunkShift(chunkSize);
+    g_arena.chunkSize = chunkSize;
+    g_arena.chunkNum = chunkNum;
+    g_arena.regionSize = (uintptr_t)chunkNum << g_arena.chunkShift;
+    g_arena.maxAllocSize = chunkSize / ARENA_MAX_ALLOC_DIVISOR;
+    g_arena.chunks = (HcMemChunk *)HcMalloc(sizeof(HcMemChunk) * chunkNum, 0);
+    g_arena.freeChunks = (uint32_t *)HcMalloc(sizeof(uint32_t) * chunkNum, 0);
+    uint8_t *region = (uint8_t *)HcMalloc((uint32_t)g_arena.regionSize, 0);
+    if (g_arena.chunks == NULL || g_arena.freeChunks == NULL || region == NULL) {
+        HcFree(g_arena.chunks);
+        HcFree(g_arena.freeChunks);
+        HcFree(region);
+        g_arena.chunks = NULL;
+        g_arena.freeChunks = NULL;
+        return HAL_ERR_BAD_ALLOC;
+    }
+    if (InitHcMutex(&g_arena.lock) != 0) {
+        HcFree(g_arena.chunks);
+        HcFree(g_arena.freeChunks);
+        HcFree(region);
+        g_arena.chunks = NULL;
+        g_arena.freeChunks = NULL;
+        return HAL_ERR_INIT_FAILED;
+    }
+    /* the chunks are taken from the low addresses first */
+    for (uint32_t i = 0; i < chunkNum; i++) {
+        g_arena.freeChunks[i] = chunkNum - 1 - i;
+    }
+    g_arena.freeChunkNum = chunkNum;
+    g_arena.allocNum = 0;
+    g_arena.fallbackNum = 0;
+    __atomic_store_n(&g_arena.base, region, __ATOMIC_RELEASE);
+    return HAL_SUCCESS;
+}
+
+int32_t InitMemArena(uint32_t chunkSize, uint32_t chunkNum)
+{
+    if (chunkSize < ARENA_MIN_CHUNK_SIZE || (chunkSize & (chunkSize - 1)) != 0 || chunkNum == 0 ||
+        ((uint64_t)chunkSize * chunkNum) > UINT32_MAX) {
+        LOGE("Invalid arena size, chunk size: %u, chunk num: %u", chunkSize, chunkNum);
+        return HAL_ERR_INVALID_PARAM;
+    }
+    if (__atomic_load_n(&g_arena.state, __ATOMIC_ACQUIRE) != ARENA_STATE_NONE) {
+        /* the memory of the last arena is still in use */
+        LOGW("The memory arena is in use!");
+        return HAL_ERR_INIT_FAILED;
+    }
+    int32_t res = AllocArena(chunkSize, chunkNum);
+    if (res != HAL_SUCCESS) {
+        LOGE("Failed to alloc the memory arena, res: %d", res);
+        return res;
+    }
+    if (!g_isHookInstalled) {
+        /* the hooks stay after the arena is destroyed, the json memory may still be freed to the arena */
+        cJSON_Hooks hooks = { JsonMalloc, JsonFree };
+        cJSON_InitHooks(&hooks);
+        g_isHookInstalled = HC_TRUE;
+    }
+    __atomic_store_n(&g_arena.state, ARENA_STATE_ACTIVE, __ATOMIC_RELEASE);
+    return HAL_SUCCESS;
+}
+
+void DestroyMemArena(void)
+{
+    if (__atomic_load_n(&g_arena.state, __ATOMIC_ACQUIRE) != ARENA_STATE_ACTIVE) {
+        return;
+    }
+    g_arena.lock.lock(&g_arena.lock);
+    g_arena.state = ARENA_STATE_DESTROYING;
+    HcBool isLast = (g_arena.freeChunkNum == g_arena.chunkNum);
+    uint32_t pinnedNum = g_arena.chunkNum - g_arena.freeChunkNum;
+    g_arena.lock.unlock(&g_arena.lock);
+    if (isLast) {
+        FreeArena();
+    } else {
+        LOGI("The memory arena is freed later, %u chunks are still in use.", pinnedNum);
+    }
+}
+
+void BindMemArena(void)
+{
+    if (__atomic_load_n(&g_arena.state, __ATOMIC_ACQUIRE) == ARENA_STATE_ACTIVE) {
+        g_isBound = HC_TRUE;
+        g_isExhausted = HC_FALSE;
+        CheckJsonHook();
+    }
+}
+
+void UnbindMemArena(void)
+{
+    if (g_curChunk != ARENA_NO_CHUNK) {
+        ReleaseChunk(g_curChunk);
+        g_curChunk = ARENA_NO_CHUNK;
+    }
+    g_isBound = HC_FALSE;
+}
+
+void *MemArenaAlloc(uint32_t size)
+{
+    if (!g_isBound) {
+        return NULL;
+    }
+    if (size == 0 || size > g_arena.maxAllocSize || g_isExhausted) {
+        __atomic_add_fetch(&g_arena.fallbackNum, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    uint32_t alignedSize = ARENA_ROUND_UP(size);
+    if (g_curChunk != ARENA_NO_CHUNK && g_arena.chunks[g_curChunk].used + alignedSize > g_arena.chunkSize) {
+        ReleaseChunk(g_curChunk);
+        g_curChunk = ARENA_NO_CHUNK;
+    }
+    if (g_curChunk == ARENA_NO_CHUNK) {
+        g_curChunk = TakeChunk();
+        if (g_curChunk == ARENA_NO_CHUNK) {
+            /* don't try the lock again until the next task */
+            LOGD("The memory arena is exhausted.");
+            g_isExhausted = HC_TRUE;
+            __atomic_add_fetch(&g_arena.fallbackNum, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    }
+    HcMemChunk *chunk = &g_arena.chunks[g_curChunk];
+    uint8_t *addr = g_arena.base + ((uintptr_t)g_curChunk << g_arena.chunkShift) + chunk->used;
+    chunk->used += alignedSize;
+    __atomic_add_fetch(&chunk->refNum, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&g_arena.allocNum, 1, __ATOMIC_RELAXED);
+    return addr;
+}
+
+HcBool MemArenaFree(void *addr)
+{
+    if (!IsMemArenaAddr(addr)) {
+        return HC_FALSE;
+    }
+    uintptr_t offset = (uintptr_t)addr - (uintptr_t)g_arena.base;
+    ReleaseChunk((uint32_t)(offset >> g_arena.chunkShift));
+    return HC_TRUE;
+}
+
+void EnterJsonArenaScope(void)
+{
+    g_jsonScopeDepth++;
+}
+
+void LeaveJsonArenaScope(void)
+{
+    if (g_jsonScopeDepth > 0) {
+        g_jsonScopeDepth--;
+    }
+}
+
+HcBool IsMemArenaAddr(const void *addr)
+{
+    uint8_t *base = __atomic_load_n(&g_arena.base, __ATOMIC_ACQUIRE);
+    if (base == NULL) {
+        return HC_FALSE;
+    }
+    return ((uintptr_t)addr >= (uintptr_t)base) && ((uintptr_t)addr - (uintptr_t)base < g_arena.regionSize);
+}
+
+void GetMemArenaStat(HcMemArenaStat *stat)
+{
+    if (stat == NULL) {
+        return;
+    }
+    (void)memset_s(stat, sizeof(HcMemArenaStat), 0, sizeof(HcMemArenaStat));
+    if (__atomic_load_n(&g_arena.state, __ATOMIC_ACQUIRE) == ARENA_STATE_NONE) {
+        return;
+    }
+    stat->chunkNum = g_arena.chunkNum;
+    stat->freeChunkNum = __atomic_load_n(&g_arena.freeChunkNum, __ATOMIC_RELAXED);
+    stat->allocNum = __atomic_load_n(&g_arena.allocNum, __ATOMIC_RELAXED);
+    stat->fallbackNum = __atomic_load_n(&g_arena.fallbackNum, __ATOMIC_RELAXED);
+}
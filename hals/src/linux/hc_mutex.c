@@ -57,6 +57,71 @@ void DestroyHcMutex(struct HcMutexT* mutex)
     pthread_mutex_destroy(&mutex->mutex);
 }
 
+int RwLockReadLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return -1;
+    }
+    int res = pthread_mutex_lock(&rwLock->turnstile);
+    if (res != 0) {
+        return -res;
+    }
+    res = pthread_rwlock_rdlock(&rwLock->rwLock);
+    pthread_mutex_unlock(&rwLock->turnstile);
+    return -res;
+}
+
+int RwLockWriteLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return -1;
+    }
+    int res = pthread_mutex_lock(&rwLock->turnstile);
+    if (res != 0) {
+        return -res;
+    }
+    res = pthread_rwlock_wrlock(&rwLock->rwLock);
+    pthread_mutex_unlock(&rwLock->turnstile);
+    return -res;
+}
+
+void RwLockUnlock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return;
+    }
+    pthread_rwlock_unlock(&rwLock->rwLock);
+}
+
+int32_t InitHcRwLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return -1;
+    }
+    int res = pthread_rwlock_init(&rwLock->rwLock, NULL);
+    if (res != 0) {
+        return res;
+    }
+    res = pthread_mutex_init(&rwLock->turnstile, NULL);
+    if (res != 0) {
+        pthread_rwlock_destroy(&rwLock->rwLock);
+        return res;
+    }
+    rwLock->readLock = RwLockReadLock;
+    rwLock->writeLock = RwLockWriteLock;
+    rwLock->unlock = RwLockUnlock;
+    return res;
+}
+
+void DestroyHcRwLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return;
+    }
+    pthread_rwlock_destroy(&rwLock->rwLock);
+    pthread_mutex_destroy(&rwLock->turnstile);
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -149,6 +149,16 @@ void DestroyThread(HcThread* thread)
     DeleteString(&thread->name);
 }
 
+HcThreadId GetCurrentThreadId(void)
+{
+    return pthread_self();
+}
+
+HcBool IsCurrentThreadId(HcThreadId threadId)
+{
+    return pthread_equal(threadId, pthread_self()) ? HC_TRUE : HC_FALSE;
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -52,6 +52,17 @@ int64_t HcGetIntervalTime(int64_t startTime)
     return (end.tv_sec - startTime);
 }
 
+int64_t HcGetRealTime()
+{
+    struct timespec now;
+    int res = clock_gettime(CLOCK_REALTIME, &now);
+    if (res != 0) {
+        LOGE("clock_gettime failed, res:%d", res);
+        return -1;
+    }
+    return now.tv_sec;
+}
+
 #ifdef __cplusplus
 }
 #endif
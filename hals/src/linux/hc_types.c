@@ -15,6 +15,7 @@
 
 #include "hc_types.h"
 #include "hc_log.h"
+#include "hc_mem_arena.h"
 #include "securec.h"
 
 #ifdef __cplusplus
@@ -27,7 +28,15 @@ void* HcMalloc(uint32_t size, char val)
         LOGE("Malloc size is invalid.");
         return NULL;
     }
-    void* addr = malloc(size);
+    void* addr = MemArenaAlloc(size);
+    if (addr != NULL) {
+        /* the memory of the arena is zeroed */
+        if (val != 0) {
+            (void)memset_s(addr, size, val, size);
+        }
+        return addr;
+    }
+    addr = malloc(size);
     if (addr != NULL) {
         (void)memset_s(addr, size, val, size);
     }
@@ -36,11 +45,34 @@ void* HcMalloc(uint32_t size, char val)
 
 void HcFree(void* addr)
 {
-    if (addr != NULL) {
+    if (addr != NULL && !MemArenaFree(addr)) {
         free(addr);
     }
 }
 
+void* HcRealloc(void* addr, uint32_t oldSize, uint32_t newSize)
+{
+    if (newSize == 0) {
+        LOGE("Realloc size is invalid.");
+        return NULL;
+    }
+    if (!IsMemArenaAddr(addr)) {
+        return realloc(addr, newSize);
+    }
+    /* the memory of the arena can't grow in place, move it */
+    void* newAddr = HcMalloc(newSize, 0);
+    if (newAddr == NULL) {
+        return NULL;
+    }
+    uint32_t copySize = (oldSize < newSize) ? oldSize : newSize;
+    if (memcpy_s(newAddr, newSize, addr, copySize) != EOK) {
+        HcFree(newAddr);
+        return NULL;
+    }
+    HcFree(addr);
+    return newAddr;
+}
+
 uint32_t HcStrlen(const char *str)
 {
     if (str == NULL) {
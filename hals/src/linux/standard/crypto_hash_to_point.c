@@ -14,9 +14,6 @@
  */
 
 #include "crypto_hash_to_point.h"
-#include <openssl/bn.h>
-#include <openssl/evp.h>
-#include <openssl/rand.h>
 #include "hc_error.h"
 #include "hc_log.h"
 #include "hc_types.h"
@@ -24,359 +21,398 @@
 
 #define KEY_BYTES_CURVE25519                 32
 
-struct CurveConstPara {
-    BIGNUM *p;
-    BIGNUM *one;
-    BIGNUM *d;
-    BIGNUM *k;
-    BIGNUM *capitalA;
-    BIGNUM *minusA;
-    BIGNUM *u;
-    BIGNUM *q;
-};
+/*
+ * The map works on GF(p), p = 2^255 - 19, with five unsigned 51-bit limbs, least significant first.
+ * All the operations are branch-free and do the same memory accesses whatever the values are.
+ */
+#define FE_LIMB_NUM 5
+#define FE_LIMB_BITS 51
+#define FE_LIMB_MASK ((1ULL << FE_LIMB_BITS) - 1)
+#define FE_REDUCE_FACTOR 19 /* 2^255 = 19 mod p */
+#define FE_BITS_PER_BYTE 8
 
-/* RFC 8032, the prime of Curve25519, p = 2^255-19 */
-static const uint8_t g_curveParamP[KEY_BYTES_CURVE25519] = {
-    0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xed
-};
+typedef struct {
+    uint64_t v[FE_LIMB_NUM];
+} FieldElement;
 
-/* RFC 8032, one = 1 */
-static const uint8_t g_curveParamOne[KEY_BYTES_CURVE25519] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
-};
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128 FeWide;
 
-/* RFC 8032, A non-zero element in the finite field GF(p), not equal to 1 */
-static const uint8_t g_curveParamD[KEY_BYTES_CURVE25519] = {
-    0xa3, 0x78, 0x59, 0x13, 0xca, 0x4d, 0xeb, 0x75, 0xab, 0xd8, 0x41, 0x41, 0x4d, 0x0a, 0x70, 0x00,
-    0x98, 0xe8, 0x79, 0x77, 0x79, 0x40, 0xc7, 0x8c, 0x73, 0xfe, 0x6f, 0x2b, 0xee, 0x6c, 0x03, 0x52
-};
+static inline FeWide WideMul(uint64_t a, uint64_t b)
+{
+    return (FeWide)a * b;
+}
 
-/* RFC 8032, k = (p - 1) / 2 */
-static const uint8_t g_curveParamK[KEY_BYTES_CURVE25519] = {
-    0xf6, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3f
-};
+static inline FeWide WideAdd(FeWide a, FeWide b)
+{
+    return a + b;
+}
 
-/* RFC 8032, A = 486662 */
-static const uint8_t g_curveParamCapitalA[KEY_BYTES_CURVE25519] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x6d, 0x06
-};
+static inline FeWide WideFromU64(uint64_t a)
+{
+    return a;
+}
 
-/* RFC 8032, -A = -486662 */
-static const uint8_t g_curveParamMinusA[KEY_BYTES_CURVE25519] = {
-    0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0x92, 0xe7
-};
+static inline uint64_t WideLowLimb(FeWide a)
+{
+    return (uint64_t)a & FE_LIMB_MASK;
+}
 
-/* RFC 8032, u = 2 */
-static const uint8_t g_curveParamU[KEY_BYTES_CURVE25519] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02
-};
+static inline uint64_t WideCarry(FeWide a)
+{
+    return (uint64_t)(a >> FE_LIMB_BITS);
+}
+#else
+/* 128-bit arithmetic for the targets without a native 64x64->128 multiplication */
+typedef struct {
+    uint64_t lo;
+    uint64_t hi;
+} FeWide;
 
-/* RFC 8032, q = endian_swap(k) */
-static const uint8_t g_curveParamQ[KEY_BYTES_CURVE25519] = {
-    0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf6
-};
+#define HALF_BITS 32
+#define HALF_MASK 0xffffffffULL
 
-static void CurveInitConstPara(struct CurveConstPara *para)
+static inline FeWide WideMul(uint64_t a, uint64_t b)
 {
-    para->p = BN_new();
-    para->one = BN_new();
-    para->d = BN_new();
-    para->k = BN_new();
-    para->capitalA = BN_new();
-    para->minusA = BN_new();
-    para->u = BN_new();
-    para->q = BN_new();
+    uint64_t a0 = a & HALF_MASK;
+    uint64_t a1 = a >> HALF_BITS;
+    uint64_t b0 = b & HALF_MASK;
+    uint64_t b1 = b >> HALF_BITS;
+    uint64_t p00 = a0 * b0;
+    uint64_t p01 = a0 * b1;
+    uint64_t p10 = a1 * b0;
+    uint64_t mid = (p00 >> HALF_BITS) + (p01 & HALF_MASK) + (p10 & HALF_MASK);
+    FeWide r = { (p00 & HALF_MASK) | (mid << HALF_BITS),
+        a1 * b1 + (p01 >> HALF_BITS) + (p10 >> HALF_BITS) + (mid >> HALF_BITS) };
+    return r;
 }
 
-static void CurveFreeConstPara(struct CurveConstPara *para)
+static inline FeWide WideAdd(FeWide a, FeWide b)
 {
-    BN_free(para->p);
-    BN_free(para->one);
-    BN_free(para->d);
-    BN_free(para->k);
-    BN_free(para->capitalA);
-    BN_free(para->minusA);
-    BN_free(para->u);
-    BN_free(para->q);
+    FeWide r = { a.lo + b.lo, a.hi + b.hi };
+    r.hi += (r.lo < a.lo);
+    return r;
 }
 
-/* b := -A / (1 + u * a ^ 2) */
-static int32_t CurveHashToPointCalcB(const struct HksBlob *hash,
-    const struct CurveConstPara *curvePara, BIGNUM *b, BN_CTX *ctx)
+static inline FeWide WideFromU64(uint64_t a)
 {
-    BIGNUM *swap = BN_new();
-    int32_t ret = HAL_FAILED;
-    do {
-        if (BN_bin2bn(hash->data, hash->size, swap) == NULL) {
-            break;
-        }
-        if (BN_mul(b, swap, swap, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod(b, b, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_mul(swap, b, curvePara->u, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod(swap, swap, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_add(b, swap, curvePara->one) <= 0) {
-            break;
-        }
-        if (BN_mod(b, b, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod_inverse(swap, b, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_mul(b, swap, curvePara->minusA, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod(b, b, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        ret = HAL_SUCCESS;
-    } while (0);
-    BN_free(swap);
-    return ret;
+    FeWide r = { a, 0 };
+    return r;
 }
 
-static int32_t CurveHashToPointCalcA(const BIGNUM *b,
-    const struct CurveConstPara *curvePara, BIGNUM *a, BN_CTX *ctx)
+static inline uint64_t WideLowLimb(FeWide a)
 {
-    BIGNUM *swap = BN_new();
-    BIGNUM *result = BN_new();
-    int32_t ret = HAL_FAILED;
-
-    do {
-        if (BN_mul(result, b, b, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod(result, result, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_mul(swap, result, b, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod(swap, swap, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_mul(a, result, curvePara->capitalA, ctx) <= 0) {
-            break;
-        }
-        if (BN_mod(a, a, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_add(result, swap, a) <= 0) {
-            break;
-        }
-        if (BN_mod(result, result, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_add(a, result, b) <= 0) {
-            break;
-        }
-        if (BN_mod(a, a, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        ret = HAL_SUCCESS;
-    } while (0);
+    return a.lo & FE_LIMB_MASK;
+}
 
-    BN_free(swap);
-    BN_free(result);
-    return ret;
+static inline uint64_t WideCarry(FeWide a)
+{
+    return (a.lo >> FE_LIMB_BITS) | (a.hi << (64 - FE_LIMB_BITS));
 }
+#endif
+
+/* RFC 7748, A = 486662 */
+#define CURVE_PARAM_A 486662
+/* RFC 8032, u = 2 */
+#define CURVE_PARAM_U 2
+
+static const FieldElement g_feOne = { { 1, 0, 0, 0, 0 } };
+
+/* -A mod p */
+static const FieldElement g_feMinusA = { {
+    FE_LIMB_MASK - FE_REDUCE_FACTOR + 1 - CURVE_PARAM_A, FE_LIMB_MASK, FE_LIMB_MASK, FE_LIMB_MASK, FE_LIMB_MASK
+} };
 
-static int32_t CurveHashToPointCalcC(const BIGNUM *a, BIGNUM *b,
-    const struct CurveConstPara *curvePara, BIGNUM *c, BN_CTX *ctx)
+/* p - 1, the value of the Legendre symbol of a non-residue, little endian */
+static const uint8_t g_pMinusOne[KEY_BYTES_CURVE25519] = {
+    0xec, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f
+};
+
+static uint64_t LoadLe64(const uint8_t *in)
 {
-    BIGNUM *result = BN_new();
-    int32_t ret = HAL_FAILED;
+    uint64_t r = 0;
+    for (int32_t i = sizeof(uint64_t) - 1; i >= 0; i--) {
+        r = (r << FE_BITS_PER_BYTE) | in[i];
+    }
+    return r;
+}
 
-    do {
-        /* If a is a quadratic residue modulo p, c := b and high_y := 1 Otherwise c := -b - A and high_y := 0 */
-        if (BN_sub(c, curvePara->p, b) <= 0) {
-            break;
-        }
-        if (BN_mod(c, c, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_add(c, c, curvePara->minusA) <= 0) {
-            break;
-        }
-        if (BN_mod(c, c, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        /* Sliding-window exponentiation: result = a^q mod p */
-        if (BN_mod_exp(result, a, curvePara->q, curvePara->p, ctx) <= 0) {
-            break;
-        }
-        if (BN_cmp(curvePara->q, result) > 0) {
-            BN_swap(b, c);
-        }
-        ret = HAL_SUCCESS;
-    } while (0);
+/* in is little endian and less than 2^255 */
+static void FeFromBytes(FieldElement *h, const uint8_t *in)
+{
+    h->v[0] = LoadLe64(in) & FE_LIMB_MASK;
+    h->v[1] = (LoadLe64(in + 6) >> 3) & FE_LIMB_MASK; /* bit 51 is bit 3 of byte 6 */
+    h->v[2] = (LoadLe64(in + 12) >> 6) & FE_LIMB_MASK; /* bit 102 is bit 6 of byte 12 */
+    h->v[3] = (LoadLe64(in + 19) >> 1) & FE_LIMB_MASK; /* bit 153 is bit 1 of byte 19 */
+    h->v[4] = (LoadLe64(in + 24) >> 12) & FE_LIMB_MASK; /* bit 204 is bit 12 of byte 24 */
+}
 
-    BN_free(result);
-    return ret;
+/* Propagate the carries, the limbs are left below 2^51 + 2^13 */
+static void FeCarry(FieldElement *h)
+{
+    for (int32_t i = 0; i < FE_LIMB_NUM - 1; i++) {
+        h->v[i + 1] += h->v[i] >> FE_LIMB_BITS;
+        h->v[i] &= FE_LIMB_MASK;
+    }
+    h->v[0] += FE_REDUCE_FACTOR * (h->v[FE_LIMB_NUM - 1] >> FE_LIMB_BITS);
+    h->v[FE_LIMB_NUM - 1] &= FE_LIMB_MASK;
 }
 
-static int32_t CurveSetConstPara(struct CurveConstPara *para)
+/* Write the canonical value of h, little endian */
+static void FeToBytes(uint8_t *out, const FieldElement *f)
 {
-    int32_t ret = HAL_FAILED;
-    do {
-        if (BN_bin2bn(g_curveParamP, KEY_BYTES_CURVE25519, para->p) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamOne, KEY_BYTES_CURVE25519, para->one) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamD, KEY_BYTES_CURVE25519, para->d) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamK, KEY_BYTES_CURVE25519, para->k) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamCapitalA, KEY_BYTES_CURVE25519, para->capitalA) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamMinusA, KEY_BYTES_CURVE25519, para->minusA) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamU, KEY_BYTES_CURVE25519, para->u) == NULL) {
-            break;
-        }
-        if (BN_bin2bn(g_curveParamQ, KEY_BYTES_CURVE25519, para->q) == NULL) {
-            break;
-        }
-        ret = HAL_SUCCESS;
-    } while (0);
+    FieldElement t = *f;
+    FeCarry(&t);
+    FeCarry(&t);
+    /* now t < 2^255 + small, add 19 so that t >= p becomes t >= 2^255 */
+    t.v[0] += FE_REDUCE_FACTOR;
+    FeCarry(&t);
+    /* add 2^255 - 19 and drop the 2^255 bit, which subtracts p if t was not below it */
+    t.v[0] += FE_LIMB_MASK + 1 - FE_REDUCE_FACTOR;
+    for (int32_t i = 1; i < FE_LIMB_NUM; i++) {
+        t.v[i] += FE_LIMB_MASK;
+    }
+    for (int32_t i = 0; i < FE_LIMB_NUM - 1; i++) {
+        t.v[i + 1] += t.v[i] >> FE_LIMB_BITS;
+        t.v[i] &= FE_LIMB_MASK;
+    }
+    t.v[FE_LIMB_NUM - 1] &= FE_LIMB_MASK;
+
+    uint32_t bitPos = 0;
+    for (int32_t i = 0; i < KEY_BYTES_CURVE25519; i++) {
+        uint32_t limb = bitPos / FE_LIMB_BITS;
+        uint32_t shift = bitPos % FE_LIMB_BITS;
+        uint64_t byte = t.v[limb] >> shift;
+        if ((shift > FE_LIMB_BITS - FE_BITS_PER_BYTE) && (limb + 1 < FE_LIMB_NUM)) {
+            byte |= t.v[limb + 1] << (FE_LIMB_BITS - shift);
+        }
+        out[i] = (uint8_t)byte;
+        bitPos += FE_BITS_PER_BYTE;
+    }
+}
 
-    return ret;
+static void FeAdd(FieldElement *h, const FieldElement *f, const FieldElement *g)
+{
+    for (int32_t i = 0; i < FE_LIMB_NUM; i++) {
+        h->v[i] = f->v[i] + g->v[i];
+    }
+    FeCarry(h);
 }
 
-static int32_t CurveHashToPoint(const struct HksBlob *hash, struct HksBlob *point)
+/* h = f - g, 4 * p is added first so that no limb goes negative */
+static void FeSub(FieldElement *h, const FieldElement *f, const FieldElement *g)
 {
-    if ((hash == NULL) || (hash->data == NULL) ||
-        (hash->size != KEY_BYTES_CURVE25519)) {
-            return HAL_ERR_NULL_PTR;
-        }
-    if ((point == NULL) || (point->data == NULL) ||
-        (point->size != KEY_BYTES_CURVE25519)) {
-            return HAL_ERR_NULL_PTR;
-        }
+    h->v[0] = f->v[0] + ((FE_LIMB_MASK + 1 - FE_REDUCE_FACTOR) << 2) - g->v[0];
+    for (int32_t i = 1; i < FE_LIMB_NUM; i++) {
+        h->v[i] = f->v[i] + (FE_LIMB_MASK << 2) - g->v[i];
+    }
+    FeCarry(h);
+}
 
-    BIGNUM *a = BN_new();
-    BIGNUM *b = BN_new();
-    BIGNUM *c = BN_new();
-    struct CurveConstPara curvePara;
-    (void)memset_s(&curvePara, sizeof(curvePara), 0, sizeof(curvePara));
-    CurveInitConstPara(&curvePara);
-    int32_t ret;
-    BN_CTX *ctx = BN_CTX_new();
-    if (ctx == NULL) {
-        ret = HAL_ERR_BAD_ALLOC;
-        goto err;
+static void FeCarryWide(FieldElement *h, FeWide *r)
+{
+    for (int32_t i = 0; i < FE_LIMB_NUM - 1; i++) {
+        r[i + 1] = WideAdd(r[i + 1], WideFromU64(WideCarry(r[i])));
+        h->v[i] = WideLowLimb(r[i]);
     }
-    do {
-        ret = CurveSetConstPara(&curvePara);
-        if (ret != HAL_SUCCESS) {
-            break;
-        }
-        ret = CurveHashToPointCalcB(hash, &curvePara, b, ctx);
-        if (ret != HAL_SUCCESS) {
-            break;
-        }
+    h->v[FE_LIMB_NUM - 1] = WideLowLimb(r[FE_LIMB_NUM - 1]);
+    h->v[0] += FE_REDUCE_FACTOR * WideCarry(r[FE_LIMB_NUM - 1]);
+    h->v[1] += h->v[0] >> FE_LIMB_BITS;
+    h->v[0] &= FE_LIMB_MASK;
+}
 
-        ret = CurveHashToPointCalcA(b, &curvePara, a, ctx);
-        if (ret != HAL_SUCCESS) {
-            break;
-        }
+static inline FeWide WideMulAdd(FeWide acc, uint64_t a, uint64_t b)
+{
+    return WideAdd(acc, WideMul(a, b));
+}
 
-        ret = CurveHashToPointCalcC(a, b, &curvePara, c, ctx);
-        if (ret != HAL_SUCCESS) {
-            break;
-        }
+/* The limbs above 2^255 come back multiplied by 19 */
+static void FeMul(FieldElement *h, const FieldElement *f, const FieldElement *g)
+{
+    const uint64_t *a = f->v;
+    const uint64_t *b = g->v;
+    uint64_t b1x19 = FE_REDUCE_FACTOR * b[1];
+    uint64_t b2x19 = FE_REDUCE_FACTOR * b[2];
+    uint64_t b3x19 = FE_REDUCE_FACTOR * b[3];
+    uint64_t b4x19 = FE_REDUCE_FACTOR * b[4];
+    FeWide r[FE_LIMB_NUM];
+    r[0] = WideMulAdd(WideMulAdd(WideMulAdd(WideMulAdd(WideMul(a[0], b[0]),
+        a[1], b4x19), a[2], b3x19), a[3], b2x19), a[4], b1x19);
+    r[1] = WideMulAdd(WideMulAdd(WideMulAdd(WideMulAdd(WideMul(a[0], b[1]),
+        a[1], b[0]), a[2], b4x19), a[3], b3x19), a[4], b2x19);
+    r[2] = WideMulAdd(WideMulAdd(WideMulAdd(WideMulAdd(WideMul(a[0], b[2]),
+        a[1], b[1]), a[2], b[0]), a[3], b4x19), a[4], b3x19);
+    r[3] = WideMulAdd(WideMulAdd(WideMulAdd(WideMulAdd(WideMul(a[0], b[3]),
+        a[1], b[2]), a[2], b[1]), a[3], b[0]), a[4], b4x19);
+    r[4] = WideMulAdd(WideMulAdd(WideMulAdd(WideMulAdd(WideMul(a[0], b[4]),
+        a[1], b[3]), a[2], b[2]), a[3], b[1]), a[4], b[0]);
+    FeCarryWide(h, r);
+}
 
-        if (BN_bn2bin(c, point->data) <= 0) {
-            ret = HAL_FAILED;
-        }
-    } while (0);
-err:
-    CurveFreeConstPara(&curvePara);
-    BN_free(a);
-    BN_free(b);
-    BN_free(c);
-    BN_CTX_free(ctx);
-    return ret;
+static void FeSquare(FieldElement *h, const FieldElement *f)
+{
+    const uint64_t *a = f->v;
+    uint64_t a0x2 = a[0] << 1;
+    uint64_t a1x2 = a[1] << 1;
+    uint64_t a2x2 = a[2] << 1;
+    uint64_t a3x19 = FE_REDUCE_FACTOR * a[3];
+    uint64_t a4x19 = FE_REDUCE_FACTOR * a[4];
+    FeWide r[FE_LIMB_NUM];
+    r[0] = WideMulAdd(WideMulAdd(WideMul(a[0], a[0]), a1x2, a4x19), a2x2, a3x19);
+    r[1] = WideMulAdd(WideMulAdd(WideMul(a0x2, a[1]), a2x2, a4x19), a[3], a3x19);
+    r[2] = WideMulAdd(WideMulAdd(WideMul(a0x2, a[2]), a[1], a[1]), a[3] << 1, a4x19);
+    r[3] = WideMulAdd(WideMulAdd(WideMul(a0x2, a[3]), a1x2, a[2]), a[4], a4x19);
+    r[4] = WideMulAdd(WideMulAdd(WideMul(a0x2, a[4]), a1x2, a[3]), a[2], a[2]);
+    FeCarryWide(h, r);
 }
 
-static int32_t EndianSwap(struct HksBlob *data)
+static void FeSquareTimes(FieldElement *h, const FieldElement *f, uint32_t times)
 {
-    if (data->data == NULL)
-        return HAL_ERR_NULL_PTR;
+    FeSquare(h, f);
+    for (uint32_t i = 1; i < times; i++) {
+        FeSquare(h, h);
+    }
+}
 
-    if (data->size == 0)
-        return HAL_ERR_NULL_PTR;
+static void FeMulSmall(FieldElement *h, const FieldElement *f, uint32_t n)
+{
+    FeWide r[FE_LIMB_NUM];
+    for (int32_t i = 0; i < FE_LIMB_NUM; i++) {
+        r[i] = WideMul(f->v[i], n);
+    }
+    FeCarryWide(h, r);
+}
 
-    int32_t end = data->size - 1;
-    const int32_t start = 0;
+/* z250 = f ^ (2^250 - 1), z11 = f ^ 11, the common part of the inversion and the Legendre symbol */
+static void FePow2To250Minus1(FieldElement *z250, FieldElement *z11, const FieldElement *f)
+{
+    FieldElement z2;
+    FieldElement z9;
+    FieldElement t;
+    FieldElement z5;
+    FieldElement z10;
+    FieldElement z20;
+    FieldElement z50;
+    FieldElement z100;
+
+    FeSquare(&z2, f);                   /* 2 */
+    FeSquareTimes(&t, &z2, 2);          /* 8 */
+    FeMul(&z9, &t, f);                  /* 9 */
+    FeMul(z11, &z9, &z2);               /* 11 */
+    FeSquare(&t, z11);                  /* 22 */
+    FeMul(&z5, &t, &z9);                /* 2^5 - 1 */
+    FeSquareTimes(&t, &z5, 5);
+    FeMul(&z10, &t, &z5);               /* 2^10 - 1 */
+    FeSquareTimes(&t, &z10, 10);
+    FeMul(&z20, &t, &z10);              /* 2^20 - 1 */
+    FeSquareTimes(&t, &z20, 20);
+    FeMul(&t, &t, &z20);                /* 2^40 - 1 */
+    FeSquareTimes(&t, &t, 10);
+    FeMul(&z50, &t, &z10);              /* 2^50 - 1 */
+    FeSquareTimes(&t, &z50, 50);
+    FeMul(&z100, &t, &z50);             /* 2^100 - 1 */
+    FeSquareTimes(&t, &z100, 100);
+    FeMul(&t, &t, &z100);               /* 2^200 - 1 */
+    FeSquareTimes(&t, &t, 50);
+    FeMul(z250, &t, &z50);              /* 2^250 - 1 */
+}
 
-    /* count the middle index of array */
-    int32_t cnt = data->size / 2; // 2 used to calculate half of the data size
+/* h = f ^ (p - 2) = 1 / f */
+static void FeInvert(FieldElement *h, const FieldElement *f)
+{
+    FieldElement z250;
+    FieldElement z11;
+    FePow2To250Minus1(&z250, &z11, f);
+    FeSquareTimes(&z250, &z250, 5);     /* 2^255 - 2^5 */
+    FeMul(h, &z250, &z11);              /* 2^255 - 21 */
+}
 
-    for (int32_t i = 0; i < cnt; i++) {
-        uint8_t tmp;
-        tmp = data->data[start + i];
-        data->data[start + i] = data->data[end - i];
-        data->data[end - i] = tmp;
-    }
-    return HAL_SUCCESS;
+/* h = f ^ ((p - 1) / 2), which is 0, 1 or p - 1 */
+static void FeLegendre(FieldElement *h, const FieldElement *f)
+{
+    FieldElement z250;
+    FieldElement z11;
+    FieldElement z2;
+    FieldElement z6;
+    FePow2To250Minus1(&z250, &z11, f);
+    FeSquare(&z2, f);
+    FeSquare(&z6, &z2);
+    FeMul(&z6, &z6, &z2);               /* 6 */
+    FeSquareTimes(&z250, &z250, 4);     /* 2^254 - 2^4 */
+    FeMul(h, &z250, &z6);               /* 2^254 - 10 */
 }
 
-int32_t OpensslHashToPoint(const struct HksBlob *hash, struct HksBlob *point)
+/* Swap f and g if swap is 1, swap must be 0 or 1 */
+static void FeCondSwap(FieldElement *f, FieldElement *g, uint64_t swap)
 {
-    int32_t ret = HAL_FAILED;
-    uint8_t *copyData = HcMalloc(hash->size, 0);
-    if (copyData == NULL) {
-        LOGE("malloc size %u failed", hash->size);
-        return HKS_ERROR_MALLOC_FAIL;
+    uint64_t mask = 0 - swap;
+    for (int32_t i = 0; i < FE_LIMB_NUM; i++) {
+        uint64_t x = (f->v[i] ^ g->v[i]) & mask;
+        f->v[i] ^= x;
+        g->v[i] ^= x;
     }
-    struct HksBlob hashCopy = { hash->size, copyData};
-
-    do {
-        if (memcpy_s(hashCopy.data, hashCopy.size, hash->data, hash->size) != EOK) {
-            break;
-        }
+}
 
-        hashCopy.data[hashCopy.size - 1] &= 0x3f; /* RFC 8032 */
-        ret = EndianSwap(&hashCopy);
-        if (ret != HAL_SUCCESS) {
-            LOGE("swap endian before convert failed");
-            break;
-        }
+static uint64_t IsBytesEqual(const uint8_t *a, const uint8_t *b, uint32_t len)
+{
+    uint8_t diff = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return (uint64_t)((diff - 1U) >> FE_BITS_PER_BYTE) & 1;
+}
 
-        ret = CurveHashToPoint(&hashCopy, point);
-        if (ret != HAL_SUCCESS) {
-            LOGE("curve hash to point failed");
-            break;
-        }
+/*
+ * Elligator 2 map of r to the u-coordinate of Curve25519, little endian in and out:
+ * b := -A / (1 + u * r ^ 2), a := b ^ 3 + A * b ^ 2 + b,
+ * point := b if a is a quadratic residue modulo p, otherwise point := -b - A.
+ */
+static void CurveHashToPoint(const uint8_t *hash, uint8_t *point)
+{
+    FieldElement r;
+    FieldElement t;
+    FieldElement b;
+    FieldElement b2;
+    FieldElement a;
+    FieldElement c;
+    uint8_t legendre[KEY_BYTES_CURVE25519];
+
+    FeFromBytes(&r, hash);
+    FeSquare(&t, &r);
+    FeMulSmall(&t, &t, CURVE_PARAM_U);
+    FeAdd(&t, &t, &g_feOne);
+    FeInvert(&t, &t);
+    FeMul(&b, &t, &g_feMinusA);
+
+    FeSquare(&b2, &b);
+    FeMul(&a, &b2, &b);
+    FeMulSmall(&t, &b2, CURVE_PARAM_A);
+    FeAdd(&a, &a, &t);
+    FeAdd(&a, &a, &b);
+
+    FeSub(&c, &g_feMinusA, &b);
+    FeLegendre(&t, &a);
+    FeToBytes(legendre, &t);
+    /* keep b for a residue, or for a == 0, whose symbol is 0 */
+    FeCondSwap(&b, &c, IsBytesEqual(legendre, g_pMinusOne, KEY_BYTES_CURVE25519));
+    FeToBytes(point, &b);
+}
 
-        ret = EndianSwap(point);
-        if (ret != HAL_SUCCESS) {
-            LOGE("swap endian after convert failed");
-            break;
-        }
-    } while (0);
-    HcFree(hashCopy.data);
-    return ret;
-}
\ No newline at end of file
+int32_t OpensslHashToPoint(const struct HksBlob *hash, struct HksBlob *point)
+{
+    if ((hash == NULL) || (hash->data == NULL) || (hash->size != KEY_BYTES_CURVE25519)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    if ((point == NULL) || (point->data == NULL) || (point->size != KEY_BYTES_CURVE25519)) {
+        return HAL_ERR_NULL_PTR;
+    }
+    uint8_t hashCopy[KEY_BYTES_CURVE25519];
+    if (memcpy_s(hashCopy, sizeof(hashCopy), hash->data, hash->size) != EOK) {
+        return HAL_FAILED;
+    }
+    hashCopy[KEY_BYTES_CURVE25519 - 1] &= 0x3f; /* RFC 8032 */
+    CurveHashToPoint(hashCopy, point->data);
+    (void)memset_s(hashCopy, sizeof(hashCopy), 0, sizeof(hashCopy));
+    return HAL_SUCCESS;
+}
@@ -17,6 +17,8 @@
 #include "common_util.h"
 #include "crypto_hash_to_point.h"
 #include "hc_log.h"
+#include "hc_lru_cache.h"
+#include "hc_mutex.h"
 #include "hks_api.h"
 #include "hks_param.h"
 #include "hks_type.h"
@@ -65,8 +67,42 @@ static int32_t ConstructParamSet(struct HksParamSet **out, const struct HksParam
     return HAL_SUCCESS;
 }
 
+#define DL_GROUP_MAX_NUM 2
+#define DL_SQUARE_EXP 2
+
+static HcMutex g_dlGroupMutex;
+static bool g_isDlGroupMutexInit = false;
+static uint8_t g_dlGroupPrimes[DL_GROUP_MAX_NUM][BIG_PRIME_LEN_384];
+static DlGroupContext g_dlGroups[DL_GROUP_MAX_NUM];
+static uint32_t g_dlGroupNum = 0;
+
+/* the public keys exported from the stored key pairs, by the alias */
+#define PUB_KEY_CACHE_CAPACITY 16
+#define PUB_KEY_CACHE_MAX_ALIAS_LEN 64
+#define PUB_KEY_CACHE_MAX_KEY_LEN 256
+
+static HcLruCache g_pubKeyCache;
+static bool g_isPubKeyCacheInit = false;
+
 static int32_t InitHks()
 {
+    /* the DL groups live as long as the process, so the mutex is created only once */
+    if (!g_isDlGroupMutexInit) {
+        if (InitHcMutex(&g_dlGroupMutex) != 0) {
+            LOGE("Init DL group mutex failed.");
+            return HAL_FAILED;
+        }
+        g_isDlGroupMutexInit = true;
+    }
+    if (!g_isPubKeyCacheInit) {
+        /* the keys are still exported from huks without the cache */
+        if (InitLruCache(&g_pubKeyCache, PUB_KEY_CACHE_CAPACITY, PUB_KEY_CACHE_MAX_ALIAS_LEN,
+            PUB_KEY_CACHE_MAX_KEY_LEN) == HAL_SUCCESS) {
+            g_isPubKeyCacheInit = true;
+        } else {
+            LOGW("Init public key cache failed.");
+        }
+    }
     return HksInitialize();
 }
 
@@ -127,6 +163,11 @@ static int32_t CheckKeyExist(const Uint8Buff *keyAlias)
     CHECK_PTR_RETURN_HAL_ERROR_CODE(keyAlias->val, "keyAlias->val");
     CHECK_LEN_ZERO_RETURN_ERROR_CODE(keyAlias->length, "keyAlias->length");
 
+    /* the public key is cached only while the key pair is stored */
+    if (LruCacheGet(&g_pubKeyCache, keyAlias, NULL)) {
+        return HAL_SUCCESS;
+    }
+
     struct HksBlob keyAliasBlob = { keyAlias->length, keyAlias->val };
     int32_t ret = HksKeyExist(&keyAliasBlob, NULL);
     if (ret != HKS_SUCCESS) {
@@ -143,6 +184,7 @@ static int32_t DeleteKey(const Uint8Buff *keyAlias)
     CHECK_PTR_RETURN_HAL_ERROR_CODE(keyAlias->val, "keyAlias->val");
     CHECK_LEN_ZERO_RETURN_ERROR_CODE(keyAlias->length, "keyAlias->length");
 
+    LruCacheRemove(&g_pubKeyCache, keyAlias);
     struct HksBlob keyAliasBlob = { keyAlias->length, keyAlias->val };
     int32_t ret = HksDeleteKey(&keyAliasBlob, NULL);
     if (ret == HKS_ERROR_NOT_EXIST) {
@@ -603,6 +645,108 @@ static int32_t BigNumExpMod(const Uint8Buff *base, const Uint8Buff *exp, const c
     return HAL_SUCCESS;
 }
 
+static const DlGroupContext *GetDlGroupContext(const char *primeHex)
+{
+    if (primeHex == NULL) {
+        LOGE("primeHex is null.");
+        return NULL;
+    }
+    if (!g_isDlGroupMutexInit) {
+        LOGE("The algorithm is not initialized.");
+        return NULL;
+    }
+    uint32_t primeLen = HcStrlen(primeHex) / BYTE_TO_HEX_OPER_LENGTH;
+    if ((primeLen != BIG_PRIME_LEN_384) && (primeLen != BIG_PRIME_LEN_256)) {
+        LOGE("Not support big number len %u", primeLen);
+        return NULL;
+    }
+    const DlGroupContext *groupCtx = NULL;
+    g_dlGroupMutex.lock(&g_dlGroupMutex);
+    for (uint32_t i = 0; i < g_dlGroupNum; i++) {
+        if ((g_dlGroups[i].primeHex == primeHex) || (strcmp(g_dlGroups[i].primeHex, primeHex) == 0)) {
+            groupCtx = &g_dlGroups[i];
+            break;
+        }
+    }
+    if ((groupCtx == NULL) && (g_dlGroupNum < DL_GROUP_MAX_NUM) &&
+        (HexStringToByte(primeHex, g_dlGroupPrimes[g_dlGroupNum], primeLen) == HAL_SUCCESS)) {
+        DlGroupContext *newCtx = &g_dlGroups[g_dlGroupNum];
+        newCtx->primeHex = primeHex;
+        newCtx->prime.val = g_dlGroupPrimes[g_dlGroupNum];
+        newCtx->prime.length = primeLen;
+        g_dlGroupNum++;
+        groupCtx = newCtx;
+    }
+    g_dlGroupMutex.unlock(&g_dlGroupMutex);
+    if (groupCtx == NULL) {
+        LOGE("Create DL group context failed, group num: %u.", g_dlGroupNum);
+    }
+    return groupCtx;
+}
+
+static bool IsShortSquare(const Uint8Buff *base, const Uint8Buff *exp, const DlGroupContext *groupCtx)
+{
+    for (uint32_t i = 0; i + 1 < exp->length; i++) {
+        if (exp->val[i] != 0) {
+            return false;
+        }
+    }
+    /* the top byte of the prime is not 0, so base ^ 2 < 2 ^ (8 * 2 * base->length) <= prime */
+    return (exp->val[exp->length - 1] == DL_SQUARE_EXP) && (base->length * 2 < groupCtx->prime.length);
+}
+
+/*
+ * outNum = base ^ 2, the square is less than the prime, so it needs no reduction.
+ * The loops only depend on the lengths, not on the value of the base.
+ */
+static void SquareShortBigNum(const Uint8Buff *base, Uint8Buff *outNum)
+{
+    const uint8_t *in = base->val + base->length - 1;
+    uint8_t *out = outNum->val + outNum->length - 1;
+    (void)memset_s(outNum->val, outNum->length, 0, outNum->length);
+    uint64_t carry = 0;
+    for (uint32_t k = 0; k < base->length * 2; k++) {
+        uint64_t sum = carry;
+        uint32_t start = (k < base->length) ? 0 : (k - base->length + 1);
+        for (uint32_t i = start; (i <= k) && (i < base->length); i++) {
+            sum += (uint64_t)(*(in - i)) * (*(in - (k - i)));
+        }
+        *(out - k) = (uint8_t)sum;
+        carry = sum >> BITS_PER_BYTE;
+    }
+}
+
+static int32_t BigNumExpModWithContext(const Uint8Buff *base, const Uint8Buff *exp, const DlGroupContext *groupCtx,
+    Uint8Buff *outNum)
+{
+    const Uint8Buff *inParams[] = { base, exp, outNum };
+    const char *paramTags[] = { "base", "exp", "outNum" };
+    int32_t ret = BaseCheckParams(inParams, paramTags, CAL_ARRAY_SIZE(inParams));
+    if (ret != HAL_SUCCESS) {
+        return ret;
+    }
+    CHECK_PTR_RETURN_HAL_ERROR_CODE(groupCtx, "groupCtx");
+    CHECK_LEN_EQUAL_RETURN(outNum->length, groupCtx->prime.length, "outNum->length");
+
+    /* the base of DL-SPEKE is secret ^ 2, and the secret is much shorter than the prime */
+    if (IsShortSquare(base, exp, groupCtx)) {
+        SquareShortBigNum(base, outNum);
+        return HAL_SUCCESS;
+    }
+
+    struct HksBlob baseBlob = { base->length, base->val };
+    struct HksBlob expBlob = { exp->length, exp->val };
+    struct HksBlob outNumBlob = { outNum->length, outNum->val };
+    struct HksBlob bigNumBlob = { groupCtx->prime.length, groupCtx->prime.val };
+    ret = HksBnExpMod(&outNumBlob, &baseBlob, &expBlob, &bigNumBlob);
+    if (ret != HKS_SUCCESS) {
+        LOGE("Huks calculate big number exp mod failed, ret = %d", ret);
+        return HAL_FAILED;
+    }
+    outNum->length = outNumBlob.size;
+    return HAL_SUCCESS;
+}
+
 static int32_t ConstructGenerateKeyPairWithStorageParams(struct HksParamSet **paramSet, Algorithm algo,
     uint32_t keyLen, const struct HksBlob *authIdBlob)
 {
@@ -652,6 +796,7 @@ static int32_t GenerateKeyPairWithStorage(const Uint8Buff *keyAlias, uint32_t ke
         return ret;
     }
 
+    LruCacheRemove(&g_pubKeyCache, keyAlias);
     ret = HksGenerateKey(&keyAliasBlob, paramSet, NULL);
     if (ret != HKS_SUCCESS) {
         LOGE("Hks generate failed, ret=%d", ret);
@@ -786,6 +931,11 @@ static int32_t ExportPublicKey(const Uint8Buff *keyAlias, Uint8Buff *outPubKey)
     CHECK_PTR_RETURN_HAL_ERROR_CODE(outPubKey->val, "outPubKey->val");
     CHECK_LEN_ZERO_RETURN_ERROR_CODE(outPubKey->length, "outPubKey->length");
 
+    if (LruCacheGet(&g_pubKeyCache, keyAlias, outPubKey)) {
+        return HAL_SUCCESS;
+    }
+    uint32_t epoch = GetLruCacheEpoch(&g_pubKeyCache);
+
     struct HksBlob keyAliasBlob = { keyAlias->length, keyAlias->val };
     struct HksBlob keyBlob = { outPubKey->length, outPubKey->val };
 
@@ -795,6 +945,7 @@ static int32_t ExportPublicKey(const Uint8Buff *keyAlias, Uint8Buff *outPubKey)
         return HAL_FAILED;
     }
     outPubKey->length = keyBlob.size;
+    LruCachePut(&g_pubKeyCache, keyAlias, outPubKey, epoch);
 
     return HAL_SUCCESS;
 }
@@ -1006,6 +1157,7 @@ static int32_t ImportPublicKey(const Uint8Buff *keyAlias, const Uint8Buff *pubKe
         return ret;
     }
 
+    LruCacheRemove(&g_pubKeyCache, keyAlias);
     ret = HksImportKey(&keyAliasBlob, paramSet, &pubKeyBlob);
     if (ret != HKS_SUCCESS) {
         LOGE("Hks importKey failed, ret: %d", ret);
@@ -1121,7 +1273,9 @@ static const AlgLoader g_huksLoader = {
     .importPublicKey = ImportPublicKey,
     .checkDlPublicKey = CheckDlPublicKey,
     .checkEcPublicKey = NULL,
-    .bigNumCompare = NULL
+    .bigNumCompare = NULL,
+    .getDlGroupContext = GetDlGroupContext,
+    .bigNumExpModWithContext = BigNumExpModWithContext
 };
 
 const AlgLoader *GetRealLoaderInstance()
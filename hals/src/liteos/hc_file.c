@@ -30,6 +30,10 @@
 #define GET_FOLDER_FAILED (-1)
 #define GET_FILE_OK 1
 #define DEFAULT_FILE_PERMISSION 0666
+#define TEMP_FILE_SUFFIX ".tmp"
+#define BACKUP_FILE_SUFFIX ".bak"
+#define BACKUP_TEMP_FILE_SUFFIX ".bak.tmp"
+#define COPY_FILE_BUFF_SIZE 512
 
 typedef struct {
     FileIdEnum fileId;
@@ -37,22 +41,32 @@ typedef struct {
 } FileDefInfo;
 
 static FileDefInfo g_fileDefInfo[FILE_ID_LAST] = {
-    { FILE_ID_GROUP, "user/Hichain/hcgroup.dat" }
+    { FILE_ID_GROUP, "user/Hichain/hcgroup.dat" },
+    { FILE_ID_GROUP_JOURNAL, "user/Hichain/hcgroup.journal" }
 };
 
-static char g_groupPath[MAX_FILE_PATH_SIZE] = { 0 };
+static char g_filePath[FILE_ID_LAST][MAX_FILE_PATH_SIZE] = { { 0 } };
 
 void SetFilePath(FileIdEnum fileId, const char *path)
 {
-    if (path == NULL) {
+    if (path == NULL || fileId >= FILE_ID_LAST) {
         LOGE("Invalid path param");
         return;
     }
-    if (sprintf_s(g_groupPath, MAX_FILE_PATH_SIZE, "%s", path) != -1) {
-        g_fileDefInfo[fileId].filePath = g_groupPath;
+    if (sprintf_s(g_filePath[fileId], MAX_FILE_PATH_SIZE, "%s", path) != -1) {
+        g_fileDefInfo[fileId].filePath = g_filePath[fileId];
     }
 }
 
+static int GetSiblingFilePath(int fileId, const char *suffix, char *path, int pathSize)
+{
+    if (sprintf_s(path, pathSize, "%s%s", g_fileDefInfo[fileId].filePath, suffix) == -1) {
+        LOGE("Failed to generate file path, fileId:%d", fileId);
+        return -1;
+    }
+    return 0;
+}
+
 int GetNextFolder(const char* filePath, int* beginPos, char* dst, int size)
 {
     int pos = (*beginPos);
@@ -102,7 +116,7 @@ static int IsFileValid(const char *path)
     return 0;
 }
 
-int HcFileOpenWrite(const char* path)
+int HcFileOpenWrite(const char* path, int flags)
 {
     char filePath[MAX_FOLDER_NAME_SIZE + 1];
     int beginPos = 0;
@@ -118,7 +132,7 @@ int HcFileOpenWrite(const char* path)
         } else if (ret == GET_FOLDER_FAILED) {
             return -1;
         } else {
-            int fd = open(filePath, O_RDWR | O_CREAT);
+            int fd = open(filePath, flags, DEFAULT_FILE_PERMISSION);
             if (fd == -1) {
                 LOGE("file stat failed, errno = 0x%x", errno);
             }
@@ -132,10 +146,23 @@ int HcFileOpen(int fileId, int mode, FileHandle* file)
     if (fileId < 0 || fileId >= FILE_ID_LAST || file == NULL) {
         return -1;
     }
+    char path[MAX_FILE_PATH_SIZE];
     if (mode == MODE_FILE_READ) {
         file->fd = HcFileOpenRead(g_fileDefInfo[fileId].filePath);
+    } else if (mode == MODE_FILE_READ_BACKUP) {
+        if (GetSiblingFilePath(fileId, BACKUP_FILE_SUFFIX, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        file->fd = HcFileOpenRead(path);
+    } else if (mode == MODE_FILE_WRITE_TEMP) {
+        if (GetSiblingFilePath(fileId, TEMP_FILE_SUFFIX, path, sizeof(path)) != 0) {
+            return -1;
+        }
+        file->fd = HcFileOpenWrite(path, O_RDWR | O_CREAT | O_TRUNC);
+    } else if (mode == MODE_FILE_APPEND) {
+        file->fd = HcFileOpenWrite(g_fileDefInfo[fileId].filePath, O_WRONLY | O_CREAT | O_APPEND);
     } else {
-        file->fd = HcFileOpenWrite(g_fileDefInfo[fileId].filePath);
+        file->fd = HcFileOpenWrite(g_fileDefInfo[fileId].filePath, O_RDWR | O_CREAT | O_TRUNC);
     }
     if (file->fd == -1) {
         return -1;
@@ -205,6 +232,18 @@ void HcFileClose(FileHandle file)
     close(fp);
 }
 
+int HcFileSync(FileHandle file)
+{
+    if (file.fd == -1) {
+        return -1;
+    }
+    if (fsync(file.fd) != 0) {
+        LOGE("Failed to sync the file, errno = 0x%x", errno);
+        return -1;
+    }
+    return 0;
+}
+
 void HcFileRemove(int fileId)
 {
     if (fileId >= FILE_ID_LAST) {
@@ -212,4 +251,121 @@ void HcFileRemove(int fileId)
         return;
     }
     unlink(g_fileDefInfo[fileId].filePath);
+}
+
+int HcFileTruncate(int fileId, int size)
+{
+    if (fileId < 0 || fileId >= FILE_ID_LAST || size < 0) {
+        return -1;
+    }
+    int fd = open(g_fileDefInfo[fileId].filePath, O_WRONLY);
+    if (fd == -1) {
+        LOGE("Failed to open the file to truncate, errno = 0x%x", errno);
+        return -1;
+    }
+    int ret = ((ftruncate(fd, size) == 0) && (fsync(fd) == 0)) ? 0 : -1;
+    if (ret != 0) {
+        LOGE("Failed to truncate the file, errno = 0x%x", errno);
+    }
+    close(fd);
+    return ret;
+}
+
+static int CopyFile(const char *srcPath, const char *dstPath)
+{
+    int src = open(srcPath, O_RDONLY);
+    if (src == -1) {
+        return -1;
+    }
+    int dst = open(dstPath, O_WRONLY | O_CREAT | O_TRUNC, DEFAULT_FILE_PERMISSION);
+    if (dst == -1) {
+        close(src);
+        return -1;
+    }
+    char buff[COPY_FILE_BUFF_SIZE];
+    int ret = 0;
+    while (1) {
+        int readLen = read(src, buff, sizeof(buff));
+        if (readLen <= 0) {
+            ret = readLen;
+            break;
+        }
+        if (write(dst, buff, readLen) != readLen) {
+            ret = -1;
+            break;
+        }
+    }
+    if ((ret == 0) && (fsync(dst) != 0)) {
+        ret = -1;
+    }
+    close(src);
+    close(dst);
+    return ret;
+}
+
+/*
+ * Keep the current generation of the file as the previous one. It is copied to a temporary file and renamed
+ * over the previous one, so a valid previous generation exists at every moment of the update.
+ */
+static void KeepPreviousGeneration(int fileId, const char *backupPath)
+{
+    const char *filePath = g_fileDefInfo[fileId].filePath;
+    if (IsFileValid(filePath) != 0) {
+        return;
+    }
+    char backupTempPath[MAX_FILE_PATH_SIZE];
+    if (GetSiblingFilePath(fileId, BACKUP_TEMP_FILE_SUFFIX, backupTempPath, sizeof(backupTempPath)) != 0) {
+        return;
+    }
+    if (CopyFile(filePath, backupTempPath) != 0) {
+        LOGW("Failed to keep the previous generation, errno = 0x%x", errno);
+        unlink(backupTempPath);
+        return;
+    }
+    if (rename(backupTempPath, backupPath) != 0) {
+        LOGW("Failed to replace the previous generation, errno = 0x%x", errno);
+        unlink(backupTempPath);
+    }
+}
+
+int HcFileCommit(int fileId, FileHandle file, bool keepBackup)
+{
+    int fp = file.fd;
+    if (fileId < 0 || fileId >= FILE_ID_LAST || fp == -1) {
+        return -1;
+    }
+    /* the data must be on the flash before the rename makes it visible */
+    int ret = fsync(fp);
+    if (close(fp) != 0) {
+        ret = -1;
+    }
+    char tempPath[MAX_FILE_PATH_SIZE];
+    if (GetSiblingFilePath(fileId, TEMP_FILE_SUFFIX, tempPath, sizeof(tempPath)) != 0) {
+        return -1;
+    }
+    if (ret != 0) {
+        LOGE("Failed to sync the temporary file, errno = 0x%x", errno);
+        unlink(tempPath);
+        return -1;
+    }
+    char backupPath[MAX_FILE_PATH_SIZE];
+    if (GetSiblingFilePath(fileId, BACKUP_FILE_SUFFIX, backupPath, sizeof(backupPath)) != 0) {
+        unlink(tempPath);
+        return -1;
+    }
+    const char *filePath = g_fileDefInfo[fileId].filePath;
+    /*
+     * keep the current generation as a copy, the reader falls back to it if the file is broken.
+     * A file which failed to load is never kept, the previous generation is the last good one then.
+     * The file itself is only replaced by the rename, so it exists at every moment of the update.
+     */
+    if (!keepBackup) {
+        KeepPreviousGeneration(fileId, backupPath);
+    }
+    if (rename(tempPath, filePath) != 0) {
+        LOGE("Failed to replace the file, errno = 0x%x", errno);
+        unlink(tempPath);
+        return -1;
+    }
+    return 0;
 }
\ No newline at end of file
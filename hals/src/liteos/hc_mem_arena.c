@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hc_mem_arena.h"
+
+#include "hc_error.h"
+#include "securec.h"
+
+/* the memory of the device is too small to keep an arena, all the allocations go to the heap */
+
+int32_t InitMemArena(uint32_t chunkSize, uint32_t chunkNum)
+{
+    (void)chunkSize;
+    (void)chunkNum;
+    return HAL_ERR_NOT_SUPPORTED;
+}
+
+void DestroyMemArena(void)
+{
+}
+
+void BindMemArena(void)
+{
+}
+
+void UnbindMemArena(void)
+{
+}
+
+void *MemArenaAlloc(uint32_t size)
+{
+    (void)size;
+    return NULL;
+}
+
+HcBool MemArenaFree(void *addr)
+{
+    (void)addr;
+    return HC_FALSE;
+}
+
+HcBool IsMemArenaAddr(const void *addr)
+{
+    (void)addr;
+    return HC_FALSE;
+}
+
+void EnterJsonArenaScope(void)
+{
+}
+
+void LeaveJsonArenaScope(void)
+{
+}
+
+void GetMemArenaStat(HcMemArenaStat *stat)
+{
+    if (stat != NULL) {
+        (void)memset_s(stat, sizeof(HcMemArenaStat), 0, sizeof(HcMemArenaStat));
+    }
+}
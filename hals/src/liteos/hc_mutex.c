@@ -51,4 +51,43 @@ void DestroyHcMutex(struct HcMutexT* mutex)
         return;
     }
     pthread_mutex_destroy(&mutex->mutex);
+}
+
+int RwLockLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return -1;
+    }
+    return -pthread_mutex_lock(&rwLock->mutex);
+}
+
+void RwLockUnlock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return;
+    }
+    pthread_mutex_unlock(&rwLock->mutex);
+}
+
+int32_t InitHcRwLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return -1;
+    }
+    int res = pthread_mutex_init(&rwLock->mutex, NULL);
+    if (res != 0) {
+        return res;
+    }
+    rwLock->readLock = RwLockLock;
+    rwLock->writeLock = RwLockLock;
+    rwLock->unlock = RwLockUnlock;
+    return 0;
+}
+
+void DestroyHcRwLock(HcRwLock* rwLock)
+{
+    if (rwLock == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&rwLock->mutex);
 }
\ No newline at end of file
@@ -140,4 +140,14 @@ void DestroyThread(HcThread *thread)
     DestroyHcCond(&thread->threadWaitObj);
     DestroyHcMutex(&thread->threadLock);
     DeleteString(&thread->name);
+}
+
+HcThreadId GetCurrentThreadId(void)
+{
+    return pthread_self();
+}
+
+HcBool IsCurrentThreadId(HcThreadId threadId)
+{
+    return pthread_equal(threadId, pthread_self()) ? HC_TRUE : HC_FALSE;
 }
\ No newline at end of file
@@ -39,6 +39,27 @@ void HcFree(void* addr)
     }
 }
 
+void *HcRealloc(void *addr, uint32_t oldSize, uint32_t newSize)
+{
+    if (newSize == 0) {
+        LOGE("Realloc size is invalid.");
+        return NULL;
+    }
+    /* the memory pool has no realloc, copy the data to a new block */
+    void *newAddr = OhosMalloc(MEM_TYPE_HICHAIN, newSize);
+    if (newAddr == NULL) {
+        return NULL;
+    }
+    if ((addr != NULL) && (oldSize > 0)) {
+        if (memcpy_s(newAddr, newSize, addr, (oldSize < newSize) ? oldSize : newSize) != EOK) {
+            OhosFree(newAddr);
+            return NULL;
+        }
+        OhosFree(addr);
+    }
+    return newAddr;
+}
+
 uint32_t HcStrlen(const char *str)
 {
     if (str == NULL) {
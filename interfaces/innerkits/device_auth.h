@@ -62,6 +62,7 @@
 #define FIELD_GROUP_VISIBILITY "groupVisibility"
 #define FIELD_EXPIRE_TIME "expireTime"
 #define FIELD_IS_DELETE_ALL "isDeleteAll"
+#define FIELD_IS_RESUMABLE "isResumable"
 
 typedef enum {
     GROUP_CREATE = 0,
@@ -83,6 +83,7 @@ enum {
     HC_ERR_INVALID_ALG = 0x0000400A,
     HC_ERR_IGNORE_MSG = 0x0000400B,
     HC_ERR_LOCAL_IDENTITY_NOT_EXIST = 0x0000400C,
+    HC_ERR_TASK_QUEUE_FULL = 0x0000400D,
 
     /* error code for group , 0x00005000 ~ 0x00005FFF */
     HC_ERR_ACCESS_DENIED = 0x00005001,
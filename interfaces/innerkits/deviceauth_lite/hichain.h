@@ -413,7 +413,7 @@ DLL_API_PUBLIC int32_t is_trust_peer(hc_handle handle, struct hc_user_info *user
  * para handle:  hichain instance
  * para trust_user_type:  the type of peer. 0 : ACCESSORY ; 1 : CONTROLLER
  * para owner_auth_id:  input null, output binding list; input owner, output auth list;others, output null
- * para auth_id_list:  list to receive auth id
+ * para auth_id_list:  list to receive auth id, it holds HC_PUB_KEY_ALIAS_MAX_NUM auth ids at most
  * return  number of trusted peers
  */
 DLL_API_PUBLIC uint32_t list_trust_peers(hc_handle handle, int32_t trust_user_type,
@@ -19,6 +19,16 @@
 #include "database.h"
 #include "device_auth.h"
 
+/* the max number of the pending events of a listener, it can be set by the build */
+#ifndef BROADCAST_QUEUE_CAPACITY
+#define BROADCAST_QUEUE_CAPACITY 64
+#endif
+
+/* the number of the threads shared by all the listeners, it can be set by the build */
+#ifndef BROADCAST_WORKER_NUM
+#define BROADCAST_WORKER_NUM 2
+#endif
+
 typedef struct {
     void (*postOnGroupCreated)(const GroupInfo *groupInfo);
     void (*postOnGroupDeleted)(const GroupInfo *groupInfo);
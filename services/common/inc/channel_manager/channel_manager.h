@@ -24,8 +24,16 @@
 extern "C" {
 #endif
 
+/*
+ * Handler of the messages received from a channel. The message has already been parsed and carries
+ * the channel id, the handler takes the ownership of it in all cases.
+ */
+typedef int32_t (*ChannelMsgHandler)(int64_t requestId, CJson *msg);
+
 int32_t InitChannelManager(void);
 void DestroyChannelManager(void);
+void SetChannelMsgHandler(ChannelMsgHandler handler);
+ChannelMsgHandler GetChannelMsgHandler(void);
 
 /* Channel operation interfaces */
 ChannelType GetChannelType(const DeviceAuthCallback *callback, const CJson *jsonParams);
@@ -33,6 +41,12 @@ int32_t OpenChannel(ChannelType channelType, const CJson *jsonParams, int64_t re
 void CloseChannel(ChannelType channelType, int64_t channelId);
 int32_t HcSendMsg(ChannelType channelType, int64_t requestId, int64_t channelId,
     const DeviceAuthCallback *callback, const char *data);
+/*
+ * Send a json message, in the binary form if the peer has agreed on it and the channel is the soft bus,
+ * otherwise in the text form. The data of the service channel goes through the app, which may handle it as text.
+ */
+int32_t HcSendJsonMsg(ChannelType channelType, int64_t requestId, int64_t channelId,
+    const DeviceAuthCallback *callback, const CJson *msg, bool isBinary);
 void SetAuthResult(ChannelType channelType, int64_t channelId);
 int32_t GetLocalConnectInfo(char *jsonAddrInfo, int32_t bufLen);
 
@@ -30,6 +30,7 @@
 #define FIELD_ADD_AUTH_INFO "addAuthInfo"
 #define FIELD_ADD_RETURN "addReturn"
 #define FIELD_APP_ID "appId"
+#define FIELD_ASYNC_RESUME_ID "asyncResumeId"
 #define FIELD_BIND_SESSION_TYPE "bindSessionType"
 #define FIELD_CHALLENGE "challenge"
 #define FIELD_CHANNEL_ID "channelId"
@@ -52,9 +53,12 @@
 #define FIELD_GROUP_TYPE "groupType"
 #define FIELD_GROUP_VISIBILITY "groupVisibility"
 #define FIELD_IS_ADMIN "isAdmin"
+#define FIELD_IS_ASYNC_CRYPTO "isAsyncCrypto"
 #define FIELD_IS_ACCOUNT_BIND "isAccountBind"
+#define FIELD_IS_BINARY_WIRE "isBinaryWire"
 #define FIELD_IS_FORCE_DELETE "isForceDelete"
 #define FIELD_IS_CREDENTIAL_EXISTS "isCredentialExists"
+#define FIELD_IS_PEER_RESUMABLE "isPeerResumable"
 #define FIELD_KCF_DATA "kcfData"
 #define FIELD_KEY_TYPE "keyType"
 #define FIELD_MESSAGE "message"
@@ -77,6 +81,10 @@
 #define FIELD_SELF_DEVICE_ID "selfDeviceId"
 #define FIELD_REQUEST_ID "requestId"
 #define FIELD_RECEIVED_DATA "receivedData"
+#define FIELD_RESUME_MAC "resumeMac"
+#define FIELD_RESUME_NONCE "resumeNonce"
+#define FIELD_RESUME_SECRET "resumeSecret"
+#define FIELD_RESUME_STEP "resumeStep"
 #define FIELD_RETURN_CODE "returnCode"
 #define FIELD_RETURN_DATA "returnData"
 #define FIELD_RETURN_CODE_MAC "returnCodeMac"
@@ -127,6 +135,7 @@
 #define DEFAULT_EXPIRE_TIME 90
 #define GROUP_MANAGER_PACKAGE_NAME "com.huawei.devicegroupmanage"
 #define DEFAULT_RETURN_KEY_LENGTH 32
+#define AUTH_RESUME_SECRET_LEN 32
 #define ERR_AUTH_FORM 0
 #define MAX_BUFFER_LEN 1024
 #define MAX_DATA_BUFFER_SIZE 4096
@@ -215,6 +224,7 @@ typedef enum {
     CONTINUE = 0,
     IGNORE_MSG = 1,
     FINISH,
+    ASYNC_PENDING, /* only between the sub tasks and the task, the sessions see IGNORE_MSG */
 } TaskStatus;
 
 typedef enum {
@@ -48,8 +48,9 @@ typedef struct {
     uint8_t devType; /* 0 - accessory, 1 - controller, 2 - proxy */
     int64_t userId; /* user account id */
     uint64_t lastTm; /* accessed time of the device of the auth information, absolute time */
+    uint64_t savedLastTm; /* lastTm in the database file, a newer lastTm is saved at most once a minute */
 } TrustedDeviceEntry;
-DECLARE_HC_VECTOR(TrustedDeviceTable, TrustedDeviceEntry)
+DECLARE_HC_VECTOR(TrustedDeviceTable, TrustedDeviceEntry*)
 
 typedef struct {
     DECLARE_TLV_STRUCT(9)
@@ -95,6 +96,19 @@ typedef struct {
 } HCDataBaseV1;
 DECLEAR_INIT_FUNC(HCDataBaseV1)
 
+/*
+ * the head of version 2 database, it is followed by groupCount group records and deviceCount device records,
+ * journalSeq is the sequence number of the last journal record included in the records
+ */
+typedef struct {
+    DECLARE_TLV_STRUCT(4)
+    TlvInt32 version;
+    TlvUint32 groupCount;
+    TlvUint32 deviceCount;
+    TlvUint32 journalSeq;
+} HCDataBaseV2Head;
+DECLEAR_INIT_FUNC(HCDataBaseV2Head)
+
 typedef struct {
     HcString name; /* group name */
     HcString id; /* group id */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DATABASE_JOURNAL_H
+#define DATABASE_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hc_parcel.h"
+
+/*
+ * The journal is an append-only file next to the database snapshot. Every record is
+ * a fixed head (type, sequence number, payload length, crc32 of the payload) followed by the payload.
+ * A record torn by a crash fails the length or crc check, and the replay stops there.
+ * The sequence numbers grow by one for each record. The snapshot keeps the sequence number of the
+ * last change it contains, so the records left over by a crash during a compaction are skipped.
+ */
+typedef enum {
+    JOURNAL_PUT_GROUP = 1, /* payload: TlvGroupElement, add or replace the group */
+    JOURNAL_PUT_DEVICE = 2, /* payload: TlvDevAuthElement, add or replace the device */
+    JOURNAL_DEL_DEVICE = 3, /* payload: TlvDevAuthElement, delete the device */
+    JOURNAL_DEL_GROUP = 4, /* payload: TlvGroupElement, delete the group and the devices in it */
+} JournalRecordType;
+
+typedef bool (*JournalReplayFunc)(uint32_t type, HcParcel *payload);
+
+/*
+ * Append a record to the journal.
+ * @param type: the type of the record.
+ * @param payload: the payload of the record, it is not consumed.
+ * @return true (ok), false (error)
+ * The record is synced to the disk before true is returned. What was written of a failed record is
+ * cut off. If that fails too, every append fails until ResetJournal, so the caller saves a snapshot instead.
+ */
+bool AppendJournalRecord(uint32_t type, const HcParcel *payload);
+
+/*
+ * Replay the valid records of the journal in order.
+ * @param snapshotSeq: the sequence number saved in the snapshot, the records up to it are skipped.
+ * @param replayFunc: the function to apply a record, a failed record is skipped.
+ * @return the number of records replayed.
+ * The replay stops at a broken record, or at a gap in the sequence numbers, as the records after
+ * it were made on a newer snapshot than the loaded one. The file is cut back to the valid records,
+ * so the records appended later follow them.
+ */
+uint32_t ReplayJournal(uint32_t snapshotSeq, JournalReplayFunc replayFunc);
+
+/*
+ * Get the sequence number of the last record appended or replayed, it is saved in the snapshot.
+ */
+uint32_t GetJournalSeq(void);
+
+/*
+ * Get the size of the journal in bytes.
+ */
+uint32_t GetJournalSize(void);
+
+/*
+ * Remove all the records, called after the records have been compacted into the snapshot.
+ */
+void ResetJournal(void);
+
+#endif
@@ -52,6 +52,16 @@ int32_t DeleteUserIdExpiredGroups(int64_t curUserId);
 int32_t DeleteAllAccountGroup(void);
 int32_t ChangeSharedUserIdVec(Int64Vector *sharedUserIdList);
 
+/*
+ * The changes made between begin and commit are saved once on commit, and their broadcasts are posted
+ * after the save, with a single trusted device number change.
+ * The transaction belongs to the thread that begins it, and that thread must commit or roll it back. The writes
+ * of the other threads wait until then, the reads go on and see the changes that are not committed yet.
+ */
+int32_t BeginDatabaseTransaction(void);
+int32_t CommitDatabaseTransaction(void);
+void RollbackDatabaseTransaction(void);
+
 int32_t GetLocalDevUdid(char **udid);
 void DestroyUdid(char **udid);
 
@@ -79,10 +89,15 @@ bool IsGroupExistByGroupId(const char *groupId);
 bool IsTrustedDeviceExist(const char *udid);
 bool IsTrustedDeviceInGroup(const char *groupId, const char *udid);
 bool IsTrustedDeviceInGroupByAuthId(const char *groupId, const char *authId);
-int32_t GetJoinedGroups(int groupType, GroupInfoVec *groupInfoVec);
-int32_t GetGroupInfo(int groupType, const char *groupId, const char *groupName, const char *groupOwner,
-    GroupInfoVec *groupInfoVec);
-int32_t GetRelatedGroups(const char *peerAuthId, GroupInfoVec *groupInfoVec);
+/* The last time (HcGetRealTime) the device was authenticated in the group, 0 if never. udid is used if not NULL. */
+uint64_t GetTrustedDeviceLastTm(const char *groupId, const char *udid, const char *authId);
+/* Updated in memory at once, but saved at most once per minute of the device, so it can be called on every auth. */
+int32_t UpdateTrustedDeviceLastTm(const char *groupId, const char *udid, uint64_t lastTm);
+/* The group queries below only return the groups accessible to the appId, see IsGroupAccessible. */
+int32_t GetJoinedGroups(const char *appId, int groupType, GroupInfoVec *groupInfoVec);
+int32_t GetGroupInfo(const char *appId, int groupType, const char *groupId, const char *groupName,
+    const char *groupOwner, GroupInfoVec *groupInfoVec);
+int32_t GetRelatedGroups(const char *appId, const char *peerAuthId, GroupInfoVec *groupInfoVec);
 int32_t GetTrustedDevices(const char *peerAuthId, DeviceInfoVec *deviceInfoVec);
 
 int32_t AddGroupManager(const char *groupId, const char *managerAppId);
@@ -18,13 +18,38 @@
 
 #include "hc_task_thread.h"
 
+/* the number of worker threads, it can be set by the build, the default is one */
+#ifndef TASK_WORKER_NUM
+#define TASK_WORKER_NUM 1
+#endif
+
+/* the max number of the pending tasks of a worker, it can be set by the build */
+#ifndef TASK_QUEUE_CAPACITY
+#define TASK_QUEUE_CAPACITY 128
+#endif
+
+/*
+ * The number of the chunks of the memory arena which the workers take the memory of the tasks from,
+ * it can be set by the build, the default is zero which disables the arena.
+ */
+#ifndef TASK_ARENA_CHUNK_NUM
+#define TASK_ARENA_CHUNK_NUM 0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 int32_t InitTaskManager(void);
 void DestroyTaskManager(void);
-int32_t PushTask(HcTaskBase *baseTask);
+/*
+ * Push a task to the worker of the request.
+ * The tasks of the same request are executed in order, the tasks of different requests may run in parallel.
+ * @param requestId: the request which the task belongs to.
+ * @param baseTask: the task, it is freed by the worker after execution.
+ * @return HC_SUCCESS (ok), HC_ERR_TASK_QUEUE_FULL (the worker is busy, the task is not consumed), others (error)
+ */
+int32_t PushTask(int64_t requestId, HcTaskBase *baseTask);
 
 #ifdef __cplusplus
 }
@@ -16,19 +16,87 @@
 #include "broadcast_manager.h"
 #include "common_defs.h"
 #include "device_auth_defines.h"
+#include "hc_error.h"
 #include "hc_log.h"
 #include "hc_mutex.h"
+#include "hc_task_thread.h"
+#include "hc_thread.h"
 #include "securec.h"
 
+#define BROADCAST_STACK_SIZE 4096
+#define BROADCAST_THREAD_NAME_LEN 16
+/* the number of the events of a listener delivered in a row before the other listeners get their turn */
+#define BROADCAST_DISPATCH_BATCH 8
+/* a worker has at most one kick task in its queue */
+#define BROADCAST_KICK_QUEUE_CAPACITY 2
+
+typedef enum {
+    BROADCAST_GROUP_CREATED,
+    BROADCAST_GROUP_DELETED,
+    BROADCAST_DEVICE_BOUND,
+    BROADCAST_DEVICE_UNBOUND,
+    BROADCAST_DEVICE_NOT_TRUSTED,
+    BROADCAST_LAST_GROUP_DELETED,
+} BroadcastEventType;
+
+/* An event is shared by the queues of all the listeners, it is freed by the last of them. */
+typedef struct {
+    uint32_t refCount;
+    int32_t type;
+    int32_t groupType;
+    char *peerUdid;
+    char *message;
+} BroadcastEvent;
+
+DECLARE_HC_VECTOR(BroadcastEventVec, BroadcastEvent *)
+IMPLEMENT_HC_VECTOR(BroadcastEventVec, BroadcastEvent *, 1)
+
+/*
+ * The pending events of a listener, they are delivered in order by the shared workers, one worker at a time.
+ * At most BROADCAST_QUEUE_CAPACITY events are kept, but a trust revocation is never dropped: it replaces
+ * a pending copy of itself or an older event which is not a revocation, and is queued beyond the bound
+ * only when all the pending events are distinct revocations. The trusted device number is a state rather
+ * than an event, only the latest one is kept.
+ * All the fields are guarded by the broadcast mutex.
+ */
+typedef struct ListenerQueueT {
+    DataChangeListener listener;
+    BroadcastEventVec events;
+    int32_t trustedDeviceNum;
+    bool isDevNumPending;
+    bool isReady; /* in the ready list */
+    bool isServing; /* a worker is calling the listener */
+    bool isRemoved;
+    bool isRemovedBySelf; /* removed by its own listener, the worker frees it */
+    HcThreadId servingThread;
+    HcCondition servedCond; /* notified when the worker stops calling a removed listener */
+    uint32_t droppedNum;
+    struct ListenerQueueT *nextReady;
+} ListenerQueue;
+
+typedef struct {
+    HcTaskThread thread;
+    bool isKicked; /* a kick task is queued or running, it serves the ready list until it is empty */
+} BroadcastWorker;
+
+typedef struct {
+    HcTaskBase base;
+    BroadcastWorker *worker;
+} KickTask;
+
 typedef struct {
     char *appId;
-    DataChangeListener *listener;
+    ListenerQueue *queue;
 } ListenerEntry;
 
 DECLARE_HC_VECTOR(ListenerEntryVec, ListenerEntry)
 IMPLEMENT_HC_VECTOR(ListenerEntryVec, ListenerEntry, 1)
 static ListenerEntryVec g_listenerEntryVec;
 static HcMutex *g_broadcastMutex = NULL;
+static BroadcastWorker g_broadcastWorkers[BROADCAST_WORKER_NUM];
+static uint32_t g_broadcastWorkerNum = 0;
+static ListenerQueue *g_readyHead = NULL;
+static ListenerQueue *g_readyTail = NULL;
 
 static int32_t AddGroupId(const GroupInfo *groupInfo, CJson *message)
 {
@@ -101,96 +169,404 @@ static int32_t GenerateMessage(const GroupInfo *groupInfo, char **returnGroupInf
     return HC_SUCCESS;
 }
 
-static void PostOnGroupCreated(const GroupInfo *groupInfo)
+static void ReleaseBroadcastEvent(BroadcastEvent *event)
 {
-    if (groupInfo == NULL) {
-        LOGE("The groupEntry is NULL!");
+    if (__atomic_sub_fetch(&event->refCount, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+    HcFree(event->peerUdid);
+    FreeJsonString(event->message);
+    HcFree(event);
+}
+
+static BroadcastEvent *CreateBroadcastEvent(int32_t type, const char *peerUdid, const GroupInfo *groupInfo,
+    int32_t groupType)
+{
+    BroadcastEvent *event = (BroadcastEvent *)HcMalloc(sizeof(BroadcastEvent), 0);
+    if (event == NULL) {
+        LOGE("Failed to allocate event memory!");
+        return NULL;
+    }
+    event->refCount = 1;
+    event->type = type;
+    event->groupType = groupType;
+    if (peerUdid != NULL) {
+        uint32_t peerUdidLen = HcStrlen(peerUdid) + 1;
+        event->peerUdid = (char *)HcMalloc(peerUdidLen, 0);
+        if ((event->peerUdid == NULL) || (strcpy_s(event->peerUdid, peerUdidLen, peerUdid) != EOK)) {
+            LOGE("Failed to copy peerUdid!");
+            ReleaseBroadcastEvent(event);
+            return NULL;
+        }
+    }
+    if ((groupInfo != NULL) && (GenerateMessage(groupInfo, &event->message) != HC_SUCCESS)) {
+        ReleaseBroadcastEvent(event);
+        return NULL;
+    }
+    return event;
+}
+
+static bool IsRevocationEvent(const BroadcastEvent *event)
+{
+    return (event->type == BROADCAST_GROUP_DELETED) || (event->type == BROADCAST_DEVICE_UNBOUND) ||
+        (event->type == BROADCAST_DEVICE_NOT_TRUSTED) || (event->type == BROADCAST_LAST_GROUP_DELETED);
+}
+
+static bool IsSameString(const char *str1, const char *str2)
+{
+    if ((str1 == NULL) || (str2 == NULL)) {
+        return str1 == str2;
+    }
+    return strcmp(str1, str2) == 0;
+}
+
+static bool IsSameEvent(const BroadcastEvent *event1, const BroadcastEvent *event2)
+{
+    return (event1->type == event2->type) && (event1->groupType == event2->groupType) &&
+        IsSameString(event1->peerUdid, event2->peerUdid) && IsSameString(event1->message, event2->message);
+}
+
+static void DeliverEvent(const DataChangeListener *listener, const BroadcastEvent *event)
+{
+    switch (event->type) {
+        case BROADCAST_GROUP_CREATED:
+            if (listener->onGroupCreated != NULL) {
+                listener->onGroupCreated(event->message);
+            }
+            break;
+        case BROADCAST_GROUP_DELETED:
+            if (listener->onGroupDeleted != NULL) {
+                listener->onGroupDeleted(event->message);
+            }
+            break;
+        case BROADCAST_DEVICE_BOUND:
+            if (listener->onDeviceBound != NULL) {
+                listener->onDeviceBound(event->peerUdid, event->message);
+            }
+            break;
+        case BROADCAST_DEVICE_UNBOUND:
+            if (listener->onDeviceUnBound != NULL) {
+                listener->onDeviceUnBound(event->peerUdid, event->message);
+            }
+            break;
+        case BROADCAST_DEVICE_NOT_TRUSTED:
+            if (listener->onDeviceNotTrusted != NULL) {
+                listener->onDeviceNotTrusted(event->peerUdid);
+            }
+            break;
+        case BROADCAST_LAST_GROUP_DELETED:
+            if (listener->onLastGroupDeleted != NULL) {
+                listener->onLastGroupDeleted(event->peerUdid, event->groupType);
+            }
+            break;
+        default:
+            LOGE("Unsupported broadcast event type: %d", event->type);
+            break;
+    }
+}
+
+static void ClearPendingEvents(ListenerQueue *queue)
+{
+    BroadcastEvent *event = NULL;
+    while (HC_VECTOR_POPFRONT(&queue->events, &event)) {
+        ReleaseBroadcastEvent(event);
+    }
+    queue->isDevNumPending = false;
+}
+
+static void FreeListenerQueue(ListenerQueue *queue)
+{
+    ClearPendingEvents(queue);
+    DESTROY_HC_VECTOR(BroadcastEventVec, &queue->events)
+    DestroyHcCond(&queue->servedCond);
+    HcFree(queue);
+}
+
+/* The functions below are called with the broadcast mutex held. */
+
+static ListenerQueue *PopReadyQueue(void)
+{
+    ListenerQueue *queue = g_readyHead;
+    if (queue == NULL) {
+        return NULL;
+    }
+    g_readyHead = queue->nextReady;
+    if (g_readyHead == NULL) {
+        g_readyTail = NULL;
+    }
+    queue->nextReady = NULL;
+    queue->isReady = false;
+    return queue;
+}
+
+static void UnlinkReadyQueue(ListenerQueue *queue)
+{
+    ListenerQueue *prev = NULL;
+    for (ListenerQueue *cur = g_readyHead; cur != NULL; prev = cur, cur = cur->nextReady) {
+        if (cur != queue) {
+            continue;
+        }
+        if (prev == NULL) {
+            g_readyHead = cur->nextReady;
+        } else {
+            prev->nextReady = cur->nextReady;
+        }
+        if (g_readyTail == cur) {
+            g_readyTail = prev;
+        }
+        break;
+    }
+    queue->nextReady = NULL;
+    queue->isReady = false;
+}
+
+static void AppendReadyQueue(ListenerQueue *queue)
+{
+    queue->isReady = true;
+    queue->nextReady = NULL;
+    if (g_readyTail == NULL) {
+        g_readyHead = queue;
+    } else {
+        g_readyTail->nextReady = queue;
+    }
+    g_readyTail = queue;
+}
+
+static void DoKickTask(HcTaskBase *task);
+
+static void KickWorker(void)
+{
+    for (uint32_t i = 0; i < g_broadcastWorkerNum; i++) {
+        BroadcastWorker *worker = &g_broadcastWorkers[i];
+        if (worker->isKicked) {
+            continue;
+        }
+        KickTask *kickTask = (KickTask *)HcMalloc(sizeof(KickTask), 0);
+        if (kickTask == NULL) {
+            LOGE("Failed to allocate kick task memory!");
+            return;
+        }
+        kickTask->base.doAction = DoKickTask;
+        kickTask->base.destroy = NULL;
+        kickTask->worker = worker;
+        if (worker->thread.pushTask(&worker->thread, &kickTask->base) != HAL_SUCCESS) {
+            LOGE("Failed to kick the broadcast worker!");
+            HcFree(kickTask);
+            continue;
+        }
+        worker->isKicked = true;
         return;
     }
-    char *messageStr = NULL;
-    if (GenerateMessage(groupInfo, &messageStr) != HC_SUCCESS) {
+    /* all the workers are kicked already, they serve the ready list until it is empty */
+}
+
+/* The queue is served later unless a worker is calling its listener, the worker checks it again then. */
+static void ScheduleListenerQueue(ListenerQueue *queue)
+{
+    if (queue->isReady || queue->isServing) {
         return;
     }
+    AppendReadyQueue(queue);
+    KickWorker();
+}
+
+/* Make room for a revocation in a full queue, return false if all the pending events are distinct revocations. */
+static bool MakeRoomForRevocation(ListenerQueue *queue, const BroadcastEvent *event)
+{
     uint32_t index;
-    ListenerEntry *entry = NULL;
-    g_broadcastMutex->lock(g_broadcastMutex);
-    FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onGroupCreated != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s", entry->appId);
-            entry->listener->onGroupCreated(messageStr);
+    BroadcastEvent **pendingEvent = NULL;
+    BroadcastEvent *removedEvent = NULL;
+    /* the copy moves to the tail, the listener still gets the revocation after all the events before it */
+    FOR_EACH_HC_VECTOR(queue->events, index, pendingEvent) {
+        if (IsSameEvent(*pendingEvent, event)) {
+            HC_VECTOR_POPELEMENT(&queue->events, &removedEvent, index);
+            ReleaseBroadcastEvent(removedEvent);
+            return true;
         }
     }
-    g_broadcastMutex->unlock(g_broadcastMutex);
-    FreeJsonString(messageStr);
+    FOR_EACH_HC_VECTOR(queue->events, index, pendingEvent) {
+        if (!IsRevocationEvent(*pendingEvent)) {
+            HC_VECTOR_POPELEMENT(&queue->events, &removedEvent, index);
+            ReleaseBroadcastEvent(removedEvent);
+            queue->droppedNum++;
+            LOGW("[Broadcaster]: An event is replaced by a revocation, %u events are dropped!", queue->droppedNum);
+            return true;
+        }
+    }
+    return false;
 }
 
-static void PostOnGroupDeleted(const GroupInfo *groupInfo)
+static void PushEvent(ListenerQueue *queue, BroadcastEvent *event)
 {
-    if (groupInfo == NULL) {
-        LOGE("The groupEntry is NULL!");
+    if (queue->events.size(&queue->events) >= BROADCAST_QUEUE_CAPACITY) {
+        if (!IsRevocationEvent(event)) {
+            queue->droppedNum++;
+            LOGW("[Broadcaster]: The queue of the listener is full, %u events are dropped!", queue->droppedNum);
+            return;
+        }
+        if (!MakeRoomForRevocation(queue, event)) {
+            LOGW("[Broadcaster]: The revocation is queued beyond the bound of the listener!");
+        }
+    }
+    __atomic_add_fetch(&event->refCount, 1, __ATOMIC_RELAXED);
+    if (queue->events.pushBackT(&queue->events, event) == NULL) {
+        LOGE("[Broadcaster]: Failed to queue the event!");
+        ReleaseBroadcastEvent(event);
+        return;
+    }
+    ScheduleListenerQueue(queue);
+}
+
+static void PushDeviceNum(ListenerQueue *queue, int32_t trustedDeviceNum)
+{
+    queue->trustedDeviceNum = trustedDeviceNum;
+    queue->isDevNumPending = true;
+    ScheduleListenerQueue(queue);
+}
+
+/* Deliver a batch of the events of the queue, the listener is called without the mutex. */
+static void ServeListenerQueue(ListenerQueue *queue)
+{
+    BroadcastEvent *events[BROADCAST_DISPATCH_BATCH] = { NULL };
+    uint32_t eventNum = 0;
+    while ((eventNum < BROADCAST_DISPATCH_BATCH) && HC_VECTOR_POPFRONT(&queue->events, &events[eventNum])) {
+        eventNum++;
+    }
+    bool isDevNumDue = queue->isDevNumPending;
+    queue->isDevNumPending = false;
+    int32_t trustedDeviceNum = queue->trustedDeviceNum;
+    DataChangeListener listener = queue->listener;
+    queue->isServing = true;
+    queue->servingThread = GetCurrentThreadId();
+    g_broadcastMutex->unlock(g_broadcastMutex);
+    /*
+     * The listener may add or remove listeners itself, including its own. Only this thread marks the queue
+     * removed by itself, so the flag is read without the mutex and nothing is delivered after the removal.
+     */
+    for (uint32_t i = 0; i < eventNum; i++) {
+        if (!queue->isRemovedBySelf) {
+            DeliverEvent(&listener, events[i]);
+        }
+        ReleaseBroadcastEvent(events[i]);
+    }
+    if (isDevNumDue && !queue->isRemovedBySelf && (listener.onTrustedDeviceNumChanged != NULL)) {
+        listener.onTrustedDeviceNumChanged(trustedDeviceNum);
+    }
+    g_broadcastMutex->lock(g_broadcastMutex);
+    queue->isServing = false;
+    if (queue->isRemovedBySelf) {
+        FreeListenerQueue(queue);
         return;
     }
-    char *messageStr = NULL;
-    if (GenerateMessage(groupInfo, &messageStr) != HC_SUCCESS) {
+    if (queue->isRemoved) {
+        /* the remover frees the queue once it gets the mutex */
+        queue->servedCond.notifyWithoutLock(&queue->servedCond);
         return;
     }
-    uint32_t index;
-    ListenerEntry *entry = NULL;
+    if ((queue->events.size(&queue->events) > 0) || queue->isDevNumPending) {
+        AppendReadyQueue(queue);
+    }
+}
+
+static void DoKickTask(HcTaskBase *task)
+{
+    BroadcastWorker *worker = ((KickTask *)task)->worker;
     g_broadcastMutex->lock(g_broadcastMutex);
-    FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onGroupDeleted != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s", entry->appId);
-            entry->listener->onGroupDeleted(messageStr);
-        }
+    ListenerQueue *queue = NULL;
+    while ((queue = PopReadyQueue()) != NULL) {
+        ServeListenerQueue(queue);
     }
+    worker->isKicked = false;
     g_broadcastMutex->unlock(g_broadcastMutex);
-    FreeJsonString(messageStr);
 }
 
-static void PostOnDeviceBound(const char *peerUdid, const GroupInfo *groupInfo)
+/*
+ * Called with the broadcast mutex held, the entry of the queue is already removed. The queue is freed
+ * when this returns true, which waits for a listener being called by another thread.
+ */
+static bool RetireListenerQueue(ListenerQueue *queue)
 {
-    if ((peerUdid == NULL) || (groupInfo == NULL)) {
-        LOGE("The peerUdid or groupEntry is NULL!");
+    ClearPendingEvents(queue);
+    if (queue->isReady) {
+        UnlinkReadyQueue(queue);
+    }
+    queue->isRemoved = true;
+    if (queue->isServing && IsCurrentThreadId(queue->servingThread)) {
+        queue->isRemovedBySelf = true;
+        return false;
+    }
+    while (queue->isServing) {
+        (void)queue->servedCond.waitWithoutLock(&queue->servedCond);
+    }
+    return true;
+}
+
+static bool HasListener(void)
+{
+    g_broadcastMutex->lock(g_broadcastMutex);
+    bool hasListener = (g_listenerEntryVec.size(&g_listenerEntryVec) > 0);
+    g_broadcastMutex->unlock(g_broadcastMutex);
+    return hasListener;
+}
+
+static void PostBroadcastEvent(int32_t type, const char *peerUdid, const GroupInfo *groupInfo, int32_t groupType)
+{
+    if (!HasListener()) {
         return;
     }
-    char *messageStr = NULL;
-    if (GenerateMessage(groupInfo, &messageStr) != HC_SUCCESS) {
+    /* the message is generated once and shared by all the listeners */
+    BroadcastEvent *event = CreateBroadcastEvent(type, peerUdid, groupInfo, groupType);
+    if (event == NULL) {
         return;
     }
     uint32_t index;
     ListenerEntry *entry = NULL;
     g_broadcastMutex->lock(g_broadcastMutex);
     FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onDeviceBound != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s", entry->appId);
-            entry->listener->onDeviceBound(peerUdid, messageStr);
+        if ((entry != NULL) && (entry->queue != NULL)) {
+            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s, [Type]: %d",
+                entry->appId, type);
+            PushEvent(entry->queue, event);
         }
     }
     g_broadcastMutex->unlock(g_broadcastMutex);
-    FreeJsonString(messageStr);
+    ReleaseBroadcastEvent(event);
 }
 
-static void PostOnDeviceUnBound(const char *peerUdid, const GroupInfo *groupInfo)
+static void PostOnGroupCreated(const GroupInfo *groupInfo)
+{
+    if (groupInfo == NULL) {
+        LOGE("The groupEntry is NULL!");
+        return;
+    }
+    PostBroadcastEvent(BROADCAST_GROUP_CREATED, NULL, groupInfo, 0);
+}
+
+static void PostOnGroupDeleted(const GroupInfo *groupInfo)
+{
+    if (groupInfo == NULL) {
+        LOGE("The groupEntry is NULL!");
+        return;
+    }
+    PostBroadcastEvent(BROADCAST_GROUP_DELETED, NULL, groupInfo, 0);
+}
+
+static void PostOnDeviceBound(const char *peerUdid, const GroupInfo *groupInfo)
 {
     if ((peerUdid == NULL) || (groupInfo == NULL)) {
         LOGE("The peerUdid or groupEntry is NULL!");
         return;
     }
-    char *messageStr = NULL;
-    if (GenerateMessage(groupInfo, &messageStr) != HC_SUCCESS) {
+    PostBroadcastEvent(BROADCAST_DEVICE_BOUND, peerUdid, groupInfo, 0);
+}
+
+static void PostOnDeviceUnBound(const char *peerUdid, const GroupInfo *groupInfo)
+{
+    if ((peerUdid == NULL) || (groupInfo == NULL)) {
+        LOGE("The peerUdid or groupEntry is NULL!");
         return;
     }
-    uint32_t index;
-    ListenerEntry *entry = NULL;
-    g_broadcastMutex->lock(g_broadcastMutex);
-    FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onDeviceUnBound != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s", entry->appId);
-            entry->listener->onDeviceUnBound(peerUdid, messageStr);
-        }
-    }
-    g_broadcastMutex->unlock(g_broadcastMutex);
-    FreeJsonString(messageStr);
+    PostBroadcastEvent(BROADCAST_DEVICE_UNBOUND, peerUdid, groupInfo, 0);
 }
 
 static void PostOnDeviceNotTrusted(const char *peerUdid)
@@ -199,16 +575,7 @@ static void PostOnDeviceNotTrusted(const char *peerUdid)
         LOGE("The peerUdid is NULL!");
         return;
     }
-    uint32_t index;
-    ListenerEntry *entry = NULL;
-    g_broadcastMutex->lock(g_broadcastMutex);
-    FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onDeviceNotTrusted != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s", entry->appId);
-            entry->listener->onDeviceNotTrusted(peerUdid);
-        }
-    }
-    g_broadcastMutex->unlock(g_broadcastMutex);
+    PostBroadcastEvent(BROADCAST_DEVICE_NOT_TRUSTED, peerUdid, NULL, 0);
 }
 
 static void PostOnLastGroupDeleted(const char *peerUdid, int groupType)
@@ -217,17 +584,7 @@ static void PostOnLastGroupDeleted(const char *peerUdid, int groupType)
         LOGE("The peerUdid is NULL!");
         return;
     }
-    uint32_t index;
-    ListenerEntry *entry = NULL;
-    g_broadcastMutex->lock(g_broadcastMutex);
-    FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onLastGroupDeleted != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s, [GroupType]: %d",
-                entry->appId, groupType);
-            entry->listener->onLastGroupDeleted(peerUdid, groupType);
-        }
-    }
-    g_broadcastMutex->unlock(g_broadcastMutex);
+    PostBroadcastEvent(BROADCAST_LAST_GROUP_DELETED, peerUdid, NULL, groupType);
 }
 
 static void PostOnTrustedDeviceNumChanged(int curTrustedDeviceNum)
@@ -236,14 +593,30 @@ static void PostOnTrustedDeviceNumChanged(int curTrustedDeviceNum)
     ListenerEntry *entry = NULL;
     g_broadcastMutex->lock(g_broadcastMutex);
     FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if ((entry != NULL) && (entry->listener != NULL) && (entry->listener->onTrustedDeviceNumChanged != NULL)) {
-            LOGI("[Broadcaster]: Ready to broadcast the message to the listener! [AppId]: %s", entry->appId);
-            entry->listener->onTrustedDeviceNumChanged(curTrustedDeviceNum);
+        if ((entry != NULL) && (entry->queue != NULL)) {
+            PushDeviceNum(entry->queue, curTrustedDeviceNum);
         }
     }
     g_broadcastMutex->unlock(g_broadcastMutex);
 }
 
+static ListenerQueue *CreateListenerQueue(const DataChangeListener *listener)
+{
+    ListenerQueue *queue = (ListenerQueue *)HcMalloc(sizeof(ListenerQueue), 0);
+    if (queue == NULL) {
+        LOGE("Failed to allocate listener queue memory!");
+        return NULL;
+    }
+    if (InitHcCond(&queue->servedCond, g_broadcastMutex) != HC_SUCCESS) {
+        LOGE("Init condition failed");
+        HcFree(queue);
+        return NULL;
+    }
+    queue->listener = *listener;
+    queue->events = CREATE_HC_VECTOR(BroadcastEventVec)
+    return queue;
+}
+
 static int32_t UpdateListenerIfExist(const char *appId, const DataChangeListener *listener)
 {
     uint32_t index;
@@ -251,12 +624,7 @@ static int32_t UpdateListenerIfExist(const char *appId, const DataChangeListener
     g_broadcastMutex->lock(g_broadcastMutex);
     FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
         if ((entry != NULL) && (strcmp(entry->appId, appId) == 0)) {
-            if (memcpy_s(entry->listener, sizeof(DataChangeListener),
-                listener, sizeof(DataChangeListener)) != HC_SUCCESS) {
-                g_broadcastMutex->unlock(g_broadcastMutex);
-                LOGE("Failed to copy listener!");
-                return HC_ERR_MEMORY_COPY;
-            }
+            entry->queue->listener = *listener;
             g_broadcastMutex->unlock(g_broadcastMutex);
             return HC_SUCCESS;
         }
@@ -278,24 +646,22 @@ static int32_t AddListenerIfNotExist(const char *appId, const DataChangeListener
         HcFree(copyAppId);
         return HC_ERR_MEMORY_COPY;
     }
-    DataChangeListener *copyListener = (DataChangeListener *)HcMalloc(sizeof(DataChangeListener), 0);
-    if (copyListener == NULL) {
-        LOGE("Failed to allocate saveCallback memory!");
+    ListenerQueue *queue = CreateListenerQueue(listener);
+    if (queue == NULL) {
         HcFree(copyAppId);
         return HC_ERR_ALLOC_MEMORY;
     }
-    if (memcpy_s(copyListener, sizeof(DataChangeListener),
-        listener, sizeof(DataChangeListener)) != HC_SUCCESS) {
-        LOGE("Failed to copy listener!");
-        HcFree(copyAppId);
-        HcFree(copyListener);
-        return HC_ERR_MEMORY_COPY;
-    }
     ListenerEntry entry;
     entry.appId = copyAppId;
-    entry.listener = copyListener;
+    entry.queue = queue;
     g_broadcastMutex->lock(g_broadcastMutex);
-    g_listenerEntryVec.pushBack(&g_listenerEntryVec, &entry);
+    if (g_listenerEntryVec.pushBackT(&g_listenerEntryVec, entry) == NULL) {
+        g_broadcastMutex->unlock(g_broadcastMutex);
+        LOGE("Failed to push listener entry!");
+        FreeListenerQueue(queue);
+        HcFree(copyAppId);
+        return HC_ERR_ALLOC_MEMORY;
+    }
     g_broadcastMutex->unlock(g_broadcastMutex);
     LOGI("[End]: Service register listener successfully!");
     return HC_SUCCESS;
@@ -311,6 +677,43 @@ static Broadcaster g_broadcaster = {
     .postOnTrustedDeviceNumChanged = PostOnTrustedDeviceNumChanged
 };
 
+static void DestroyBroadcastWorkers(void)
+{
+    for (uint32_t i = 0; i < g_broadcastWorkerNum; i++) {
+        g_broadcastWorkers[i].thread.stopAndClear(&g_broadcastWorkers[i].thread);
+        DestroyHcTaskThread(&g_broadcastWorkers[i].thread);
+        g_broadcastWorkers[i].isKicked = false;
+    }
+    g_broadcastWorkerNum = 0;
+}
+
+/* The workers are shared by all the listeners, so the number of threads does not grow with the listeners. */
+static int32_t InitBroadcastWorkers(void)
+{
+    for (uint32_t i = 0; i < BROADCAST_WORKER_NUM; i++) {
+        BroadcastWorker *worker = &g_broadcastWorkers[i];
+        char threadName[BROADCAST_THREAD_NAME_LEN] = { 0 };
+        if (sprintf_s(threadName, sizeof(threadName), "HcBroadcast%u", i) <= 0) {
+            LOGW("Failed to generate the broadcast thread name!");
+        }
+        if (InitHcTaskThread(&worker->thread, BROADCAST_STACK_SIZE, BROADCAST_KICK_QUEUE_CAPACITY,
+            threadName) != HAL_SUCCESS) {
+            LOGE("Failed to init the broadcast thread!");
+            DestroyBroadcastWorkers();
+            return HC_ERR_INIT_FAILED;
+        }
+        if (worker->thread.startThread(&worker->thread) != HAL_SUCCESS) {
+            LOGE("Failed to start the broadcast thread!");
+            DestroyHcTaskThread(&worker->thread);
+            DestroyBroadcastWorkers();
+            return HC_ERR_INIT_FAILED;
+        }
+        worker->isKicked = false;
+        g_broadcastWorkerNum++;
+    }
+    return HC_SUCCESS;
+}
+
 bool IsBroadcastSupported()
 {
     return true;
@@ -332,19 +735,32 @@ int32_t InitBroadcastManager()
         }
     }
     g_listenerEntryVec = CREATE_HC_VECTOR(ListenerEntryVec)
+    g_readyHead = NULL;
+    g_readyTail = NULL;
+    if (InitBroadcastWorkers() != HC_SUCCESS) {
+        DESTROY_HC_VECTOR(ListenerEntryVec, &g_listenerEntryVec)
+        DestroyHcMutex(g_broadcastMutex);
+        HcFree(g_broadcastMutex);
+        g_broadcastMutex = NULL;
+        return HC_ERR_INIT_FAILED;
+    }
     LOGI("[Broadcaster]: Init broadcast manager module successfully!");
     return HC_SUCCESS;
 }
 
 void DestroyBroadcastManager()
 {
-    uint32_t index;
-    ListenerEntry *entry = NULL;
-    FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
-        if (entry != NULL) {
-            HcFree(entry->appId);
-            HcFree(entry->listener);
+    if (g_broadcastMutex != NULL) {
+        ListenerEntry entry = { NULL, NULL };
+        g_broadcastMutex->lock(g_broadcastMutex);
+        while (HC_VECTOR_POPFRONT(&g_listenerEntryVec, &entry)) {
+            HcFree(entry.appId);
+            if (RetireListenerQueue(entry.queue)) {
+                FreeListenerQueue(entry.queue);
+            }
         }
+        g_broadcastMutex->unlock(g_broadcastMutex);
+        DestroyBroadcastWorkers();
     }
     DESTROY_HC_VECTOR(ListenerEntryVec, &g_listenerEntryVec)
     if (g_broadcastMutex != NULL) {
@@ -380,16 +796,27 @@ int32_t RemoveListener(const char *appId)
     }
     uint32_t index;
     ListenerEntry *entry = NULL;
+    ListenerEntry tempEntry = { NULL, NULL };
+    g_broadcastMutex->lock(g_broadcastMutex);
     FOR_EACH_HC_VECTOR(g_listenerEntryVec, index, entry) {
         if (strcmp(entry->appId, appId) == 0) {
-            HcFree(entry->appId);
-            HcFree(entry->listener);
-            ListenerEntry tempEntry;
             HC_VECTOR_POPELEMENT(&g_listenerEntryVec, &tempEntry, index);
-            LOGI("[End]: Service deregister listener successfully!");
-            return HC_SUCCESS;
+            break;
         }
     }
-    LOGI("[End]: Although the listener does not exist, we still believe it is correct to deregister the listener!");
+    if (tempEntry.appId == NULL) {
+        g_broadcastMutex->unlock(g_broadcastMutex);
+        LOGI("[End]: Although the listener does not exist, "
+            "we still believe it is correct to deregister the listener!");
+        return HC_SUCCESS;
+    }
+    /* the listener is never called once this returns, unless it is removed by itself */
+    bool isFreeable = RetireListenerQueue(tempEntry.queue);
+    g_broadcastMutex->unlock(g_broadcastMutex);
+    if (isFreeable) {
+        FreeListenerQueue(tempEntry.queue);
+    }
+    HcFree(tempEntry.appId);
+    LOGI("[End]: Service deregister listener successfully!");
     return HC_SUCCESS;
 }
@@ -19,9 +19,11 @@
 #include "device_auth_defines.h"
 #include "hc_log.h"
 #include "hc_types.h"
+#include "json_binary.h"
 #include "soft_bus_channel.h"
 
 static bool g_initialized = false;
+static ChannelMsgHandler g_msgHandler = NULL;
 
 int32_t InitChannelManager(void)
 {
@@ -43,6 +45,16 @@ void DestroyChannelManager(void)
     }
 }
 
+void SetChannelMsgHandler(ChannelMsgHandler handler)
+{
+    g_msgHandler = handler;
+}
+
+ChannelMsgHandler GetChannelMsgHandler(void)
+{
+    return g_msgHandler;
+}
+
 ChannelType GetChannelType(const DeviceAuthCallback *callback, const CJson *jsonParams)
 {
     if (IsSoftBusChannelSupported()) {
@@ -87,21 +99,51 @@ void CloseChannel(ChannelType channelType, int64_t channelId)
     }
 }
 
-int32_t HcSendMsg(ChannelType channelType, int64_t requestId, int64_t channelId,
-    const DeviceAuthCallback *callback, const char *data)
+static int32_t HcSendData(ChannelType channelType, int64_t requestId, int64_t channelId,
+    const DeviceAuthCallback *callback, const uint8_t *data, uint32_t dataLen)
 {
     if (channelType == SERVICE_CHANNEL) {
-        if (ProcessTransmitCallback(requestId, (uint8_t *)data, HcStrlen(data) + 1, callback)) {
+        if (ProcessTransmitCallback(requestId, data, dataLen, callback)) {
             return HC_SUCCESS;
         }
         return HC_ERR_TRANSMIT_FAIL;
     } else if (channelType == SOFT_BUS) {
-        return GetSoftBusInstance()->sendMsg(channelId, (uint8_t *)data, HcStrlen(data) + 1);
+        return GetSoftBusInstance()->sendMsg(channelId, data, dataLen);
     } else {
         return HC_ERR_CHANNEL_NOT_EXIST;
     }
 }
 
+int32_t HcSendMsg(ChannelType channelType, int64_t requestId, int64_t channelId,
+    const DeviceAuthCallback *callback, const char *data)
+{
+    return HcSendData(channelType, requestId, channelId, callback, (const uint8_t *)data, HcStrlen(data) + 1);
+}
+
+int32_t HcSendJsonMsg(ChannelType channelType, int64_t requestId, int64_t channelId,
+    const DeviceAuthCallback *callback, const CJson *msg, bool isBinary)
+{
+    if (!isBinary || (channelType != SOFT_BUS)) {
+        char *msgStr = PackJsonToString(msg);
+        if (msgStr == NULL) {
+            LOGE("An error occurred when converting json to string!");
+            return HC_ERR_JSON_FAIL;
+        }
+        int32_t result = HcSendMsg(channelType, requestId, channelId, callback, msgStr);
+        FreeJsonString(msgStr);
+        return result;
+    }
+    uint32_t dataLen = 0;
+    uint8_t *data = PackJsonToBinary(msg, &dataLen);
+    if (data == NULL) {
+        LOGE("An error occurred when converting json to binary!");
+        return HC_ERR_JSON_FAIL;
+    }
+    int32_t result = HcSendData(channelType, requestId, channelId, callback, data, dataLen);
+    FreeJsonBinary(data);
+    return result;
+}
+
 void SetAuthResult(ChannelType channelType, int64_t channelId)
 {
     if (channelType == SOFT_BUS) {
@@ -15,12 +15,15 @@
 
 #include "soft_bus_channel.h"
 
+#include "channel_manager.h"
 #include "common_defs.h"
 #include "device_auth.h"
 #include "device_auth_defines.h"
 #include "group_manager.h"
 #include "hc_log.h"
+#include "hc_vector.h"
 #include "inner_session.h"
+#include "json_binary.h"
 #include "session.h"
 #include "session_manager.h"
 #include "task_manager.h"
@@ -109,22 +112,12 @@ static void InitSoftBusTask(SoftBusTask *task, int64_t requestId, int64_t channe
     task->requestId = requestId;
 }
 
-static char *GenRecvData(int64_t channelId, const void *data, uint32_t dataLen, int64_t *requestId)
+static CJson *GenRecvData(int64_t channelId, const void *data, uint32_t dataLen, int64_t *requestId)
 {
-    char *dataStr = (char *)HcMalloc(dataLen + 1, 0);
-    if (dataStr == NULL) {
-        LOGE("Failed to allocate dataStr memory!");
-        return NULL;
-    }
-    if (memcpy_s(dataStr, dataLen + 1, data, dataLen) != HC_SUCCESS) {
-        LOGE("Failed to copy data!");
-        HcFree(dataStr);
-        return NULL;
-    }
-    CJson *recvData = CreateJsonFromString(dataStr);
-    HcFree(dataStr);
+    /* the soft bus data is not NUL-terminated, it is copied for parsing if it is in the text form */
+    CJson *recvData = CreateJsonFromData((const uint8_t *)data, dataLen);
     if (recvData == NULL) {
-        LOGE("Failed to create recvData from string!");
+        LOGE("Failed to create recvData from data!");
         return NULL;
     }
     if (GetInt64FromJson(recvData, FIELD_REQUEST_ID, requestId) != HC_SUCCESS) {
@@ -137,13 +130,7 @@ static char *GenRecvData(int64_t channelId, const void *data, uint32_t dataLen,
         FreeJson(recvData);
         return NULL;
     }
-    char *recvDataStr = PackJsonToString(recvData);
-    FreeJson(recvData);
-    if (recvDataStr == NULL) {
-        LOGE("Failed to convert json to string!");
-        return NULL;
-    }
-    return recvDataStr;
+    return recvData;
 }
 
 static bool IsServer(int sessionId)
@@ -175,7 +162,7 @@ static int OnChannelOpenedCb(int sessionId, int result)
         return HC_ERR_ALLOC_MEMORY;
     }
     InitSoftBusTask(task, requestId, sessionId);
-    if (PushTask((HcTaskBase *)task) != HC_SUCCESS) {
+    if (PushTask(requestId, (HcTaskBase *)task) != HC_SUCCESS) {
         DestroySession(requestId);
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
@@ -201,12 +188,17 @@ static void OnBytesReceivedCb(int sessionId, const void *data, unsigned int data
     }
     LOGD("[Start]: OnMsgReceived! [ChannelId]: %d", sessionId);
     int64_t requestId = DEFAULT_REQUEST_ID;
-    char *recvDataStr = GenRecvData(sessionId, data, dataLen, &requestId);
-    if (recvDataStr == NULL) {
+    ChannelMsgHandler handler = GetChannelMsgHandler();
+    if (handler == NULL) {
+        LOGE("The message handler is not registered!");
+        return;
+    }
+    CJson *recvData = GenRecvData(sessionId, data, dataLen, &requestId);
+    if (recvData == NULL) {
         return;
     }
-    (void)GetGmInstance()->processData(requestId, (uint8_t *)recvDataStr, HcStrlen(recvDataStr) + 1);
-    FreeJsonString(recvDataStr);
+    /* the parsed message goes to the task layer directly, the handler takes the ownership of it */
+    (void)handler(requestId, recvData);
 }
 
 static int32_t OpenSoftBusChannel(const char *connectParams, int64_t requestId, int64_t *returnChannelId)
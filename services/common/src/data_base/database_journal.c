@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "database_journal.h"
+#include "common_util.h"
+#include "hc_file.h"
+#include "hc_log.h"
+#include "hc_types.h"
+
+#define JOURNAL_RECORD_HEAD_LEN (4 * sizeof(uint32_t))
+#define JOURNAL_MAX_PAYLOAD_LEN (1024 * 1024)
+
+static uint32_t g_journalSize = 0;
+static uint32_t g_journalSeq = 0;
+/* the journal may end with a torn record that can't be cut off, nothing is appended until it is reset */
+static bool g_isJournalBroken = false;
+
+static bool WriteJournalUint32(HcParcel *parcel, uint32_t value)
+{
+#ifdef IS_BIG_ENDIAN
+    return ParcelWriteUint32Revert(parcel, value);
+#else
+    return ParcelWriteUint32(parcel, value);
+#endif
+}
+
+static bool ReadJournalUint32(HcParcel *parcel, uint32_t *value)
+{
+#ifdef IS_BIG_ENDIAN
+    return ParcelReadUint32Revert(parcel, value);
+#else
+    return ParcelReadUint32(parcel, value);
+#endif
+}
+
+bool AppendJournalRecord(uint32_t type, const HcParcel *payload)
+{
+    if (g_isJournalBroken) {
+        LOGE("[DB]: The journal ends with a torn record, it is not appended until it is compacted!");
+        return false;
+    }
+    uint32_t payloadLen = GetParcelDataSize(payload);
+    if ((payloadLen == 0) || (payloadLen > JOURNAL_MAX_PAYLOAD_LEN)) {
+        LOGE("[DB]: Invalid journal payload length: %u!", payloadLen);
+        return false;
+    }
+    const uint8_t *payloadData = (const uint8_t *)GetParcelData(payload);
+    uint32_t seq = g_journalSeq + 1;
+    HcParcel record = CreateParcel(JOURNAL_RECORD_HEAD_LEN + payloadLen, 0);
+    /* write the whole record at once, so that a crash can only tear the tail of the journal */
+    if (!WriteJournalUint32(&record, type) || !WriteJournalUint32(&record, seq) ||
+        !WriteJournalUint32(&record, payloadLen) ||
+        !WriteJournalUint32(&record, HcCrc32(0, payloadData, payloadLen)) ||
+        !ParcelWrite(&record, payloadData, payloadLen)) {
+        LOGE("[DB]: Failed to generate journal record!");
+        DeleteParcel(&record);
+        return false;
+    }
+    FileHandle file;
+    if (HcFileOpen(FILE_ID_GROUP_JOURNAL, MODE_FILE_APPEND, &file) != 0) {
+        LOGE("[DB]: Failed to open journal!");
+        DeleteParcel(&record);
+        return false;
+    }
+    int recordLen = (int)GetParcelDataSize(&record);
+    /* the change is only reported as saved once the record is on the disk */
+    bool ret = (HcFileWrite(file, GetParcelData(&record), recordLen) == recordLen) && (HcFileSync(file) == 0);
+    HcFileClose(file);
+    DeleteParcel(&record);
+    if (!ret) {
+        LOGE("[DB]: Failed to append journal record!");
+        /* cut off what was written of the record, so the next record follows the last complete one */
+        if (HcFileTruncate(FILE_ID_GROUP_JOURNAL, (int)g_journalSize) != 0) {
+            g_isJournalBroken = true;
+        }
+        return false;
+    }
+    g_journalSize += (uint32_t)recordLen;
+    g_journalSeq = seq;
+    return true;
+}
+
+static bool ReadJournal(HcParcel *journal)
+{
+    FileHandle file;
+    if (HcFileOpen(FILE_ID_GROUP_JOURNAL, MODE_FILE_READ, &file) != 0) {
+        return false;
+    }
+    int fileSize = HcFileSize(file);
+    if (fileSize <= 0) {
+        HcFileClose(file);
+        return false;
+    }
+    char *fileData = (char *)HcMalloc(fileSize, 0);
+    if (fileData == NULL) {
+        HcFileClose(file);
+        return false;
+    }
+    if (HcFileRead(file, fileData, fileSize) != fileSize) {
+        HcFileClose(file);
+        HcFree(fileData);
+        return false;
+    }
+    HcFileClose(file);
+    *journal = CreateParcel(0, 0);
+    bool ret = ParcelWrite(journal, fileData, fileSize);
+    HcFree(fileData);
+    if (!ret) {
+        DeleteParcel(journal);
+    }
+    return ret;
+}
+
+static bool ReadJournalRecord(HcParcel *journal, uint32_t *type, uint32_t *seq, HcParcel *payload)
+{
+    uint32_t payloadLen = 0;
+    uint32_t checksum = 0;
+    if (!ReadJournalUint32(journal, type) || !ReadJournalUint32(journal, seq) ||
+        !ReadJournalUint32(journal, &payloadLen) || !ReadJournalUint32(journal, &checksum)) {
+        return false;
+    }
+    if ((payloadLen == 0) || (payloadLen > GetParcelDataSize(journal))) {
+        return false;
+    }
+    if (HcCrc32(0, (const uint8_t *)GetParcelData(journal), payloadLen) != checksum) {
+        return false;
+    }
+    return ParcelReadParcel(journal, payload, payloadLen, HC_FALSE);
+}
+
+/* Cut off the records from the position on, the records appended later must follow the valid ones. */
+static void DropJournalTail(uint32_t validSize)
+{
+    g_journalSize = validSize;
+    if (HcFileTruncate(FILE_ID_GROUP_JOURNAL, (int)validSize) != 0) {
+        g_isJournalBroken = true;
+    }
+}
+
+uint32_t ReplayJournal(uint32_t snapshotSeq, JournalReplayFunc replayFunc)
+{
+    g_journalSize = 0;
+    g_journalSeq = snapshotSeq;
+    g_isJournalBroken = false;
+    HcParcel journal;
+    if (!ReadJournal(&journal)) {
+        return 0;
+    }
+    uint32_t journalSize = GetParcelDataSize(&journal);
+    uint32_t count = 0;
+    while (GetParcelDataSize(&journal) > 0) {
+        uint32_t type = 0;
+        uint32_t seq = 0;
+        uint32_t recordPos = journalSize - GetParcelDataSize(&journal);
+        HcParcel payload = CreateParcel(0, 0);
+        if (!ReadJournalRecord(&journal, &type, &seq, &payload)) {
+            LOGW("[DB]: The journal ends with a broken record, the remaining %u bytes are dropped!",
+                journalSize - recordPos);
+            DeleteParcel(&payload);
+            DropJournalTail(recordPos);
+            break;
+        }
+        g_journalSize = journalSize - GetParcelDataSize(&journal);
+        /* the record was compacted into the snapshot before a crash prevented the journal from being removed */
+        if (seq <= g_journalSeq) {
+            DeleteParcel(&payload);
+            continue;
+        }
+        if (seq != g_journalSeq + 1) {
+            LOGE("[DB]: The journal does not follow the snapshot, expected record %u, got %u!", g_journalSeq + 1, seq);
+            DeleteParcel(&payload);
+            DropJournalTail(recordPos);
+            break;
+        }
+        if (!replayFunc(type, &payload)) {
+            LOGW("[DB]: Failed to replay journal record, type: %u!", type);
+        }
+        DeleteParcel(&payload);
+        g_journalSeq = seq;
+        count++;
+    }
+    DeleteParcel(&journal);
+    return count;
+}
+
+uint32_t GetJournalSeq(void)
+{
+    return g_journalSeq;
+}
+
+uint32_t GetJournalSize(void)
+{
+    return g_journalSize;
+}
+
+void ResetJournal(void)
+{
+    HcFileRemove(FILE_ID_GROUP_JOURNAL);
+    g_journalSize = 0;
+    g_isJournalBroken = false;
+}
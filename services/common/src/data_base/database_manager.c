@@ -14,16 +14,32 @@
  */
 
 #include "alg_defs.h"
+#include "common_util.h"
 #include "database.h"
+#include "database_journal.h"
 #include "database_manager.h"
 #include "device_auth.h"
 #include "hc_dev_info.h"
 #include "hc_file.h"
+#include "hc_hash_map.h"
 #include "hc_log.h"
 #include "hc_mutex.h"
+#include "hc_thread.h"
 #include "securec.h"
 
 #define MAX_STRING_LEN 256
+#define INDEX_KEY_BUFF_LEN (MAX_STRING_LEN * 2)
+#define HC_DATABASE_V1_TAG 0x0001
+#define HC_DATABASE_VERSION 2
+#define DB_SAVE_CHUNK_SIZE (16 * 1024)
+/* the trailer is the magic, the length and the crc32 of the records */
+#define DB_TRAILER_MAGIC 0x42444348
+#define DB_TRAILER_LEN (3 * sizeof(uint32_t))
+#define JOURNAL_COMPACT_MIN_SIZE (64 * 1024)
+#define JOURNAL_FILE_SUFFIX ".journal"
+#define DB_FILE_PATH_LEN 256
+/* a newer access time of a device is only saved if the saved one is older than this, in seconds */
+#define LAST_TM_SAVE_INTERVAL 60
 
 DEFINE_TLV_FIX_LENGTH_TYPE(TlvDevAuthFixedLenInfo, NO_REVERT)
 
@@ -56,23 +72,155 @@ BEGIN_TLV_STRUCT_DEFINE(HCDataBaseV1, 0x0001)
     TLV_MEMBER(TlvDevAuthVec, deviceAuthInfos, 0x6003)
 END_TLV_STRUCT_DEFINE()
 
+BEGIN_TLV_STRUCT_DEFINE(HCDataBaseV2Head, 0x0003)
+    TLV_MEMBER(TlvInt32, version, 0x6001)
+    TLV_MEMBER(TlvUint32, groupCount, 0x6004)
+    TLV_MEMBER(TlvUint32, deviceCount, 0x6005)
+    TLV_MEMBER(TlvUint32, journalSeq, 0x6006)
+END_TLV_STRUCT_DEFINE()
+
 IMPLEMENT_HC_VECTOR(TrustedGroupTable, TrustedGroupEntry *, 1)
-IMPLEMENT_HC_VECTOR(TrustedDeviceTable, TrustedDeviceEntry, 2)
+IMPLEMENT_HC_VECTOR(TrustedDeviceTable, TrustedDeviceEntry *, 2)
 IMPLEMENT_HC_VECTOR(StringVector, HcString, 1)
 IMPLEMENT_HC_VECTOR(Int64Vector, int64_t, 1)
 IMPLEMENT_HC_VECTOR(GroupInfoVec, void *, 1)
 IMPLEMENT_HC_VECTOR(DeviceInfoVec, void *, 2)
 
+typedef enum {
+    DB_EVENT_GROUP_CREATED = 0,
+    DB_EVENT_GROUP_DELETED,
+    DB_EVENT_DEVICE_BOUND,
+    DB_EVENT_DEVICE_UNBOUND,
+    DB_EVENT_DEVICE_NOT_TRUSTED,
+    DB_EVENT_LAST_GROUP_DELETED,
+} DbEventType;
+
+typedef struct {
+    int32_t type;
+    int32_t groupType;
+    HcString udid;
+    GroupInfo *groupInfo;
+} DbEvent;
+DECLARE_HC_VECTOR(DbEventVec, DbEvent)
+IMPLEMENT_HC_VECTOR(DbEventVec, DbEvent, 64)
+
+/*
+ * While a transaction is active, the changes are only saved on commit, and the broadcasts are kept
+ * in events until the changes are saved. The transaction belongs to the owner thread, the writers of
+ * the other threads wait on g_transactionCond until it ends.
+ */
+typedef struct {
+    bool isActive;
+    HcThreadId owner;
+    bool isDirty;
+    bool isDevNumChanged;
+    DbEventVec events;
+} DbTransaction;
+
 static TrustedGroupTable g_trustedGroupTable;
 static TrustedDeviceTable g_trustedDeviceTable;
 
+/* secondary indexes of g_trustedDeviceTable, the values are the TrustedDeviceEntry pointers in the table */
+static HcHashMap g_udidGroupIndex; /* udid + groupId */
+static HcHashMap g_authIdGroupIndex; /* authId + groupId */
+static HcHashMap g_udidIndex; /* udid, a device may be in several groups */
+
+/* access index of g_trustedGroupTable, appId + group entry, one element for each manager and friend of a group */
+static HcHashMap g_groupAclIndex;
+
 /* cache across account groupId func */
 static int32_t (*g_generateIdFunc)(int64_t userId, int64_t sharedUserId, char **returnGroupId) = NULL;
 
 /* cache broadcaster instance */
 static const Broadcaster *g_broadcaster = NULL;
 
+/*
+ * The writers are serialized by g_databaseMutex, and hold g_databaseRwLock for write only while they
+ * modify the tables. The readers only take g_databaseRwLock for read, so they never wait for the file I/O.
+ */
 static HcMutex *g_databaseMutex = NULL;
+static HcRwLock *g_databaseRwLock = NULL;
+static bool g_isWriteLocked = false;
+
+static DbTransaction g_transaction = { 0 };
+static HcCondition g_transactionCond;
+
+/* the size of the latest snapshot, the journal is compacted when it grows larger than this */
+static uint32_t g_snapshotSize = 0;
+/* the database failed to load, the previous generation must not be replaced by it until a new one is saved */
+static bool g_isBackupKept = false;
+
+typedef struct {
+    FileHandle file;
+    HcParcel chunk;
+    uint32_t writtenSize;
+    uint32_t checksum;
+} DBSnapshotWriter;
+
+static bool IsTransactionOwner()
+{
+    return g_transaction.isActive && IsCurrentThreadId(g_transaction.owner);
+}
+
+/* Called with g_databaseMutex held, the writers of the other threads wait until the transaction ends. */
+static void WaitForOtherTransaction()
+{
+    bool isWaited = false;
+    while (g_transaction.isActive && !IsCurrentThreadId(g_transaction.owner)) {
+        (void)g_transactionCond.waitWithoutLock(&g_transactionCond);
+        isWaited = true;
+    }
+    /* the condition wakes one waiter at a time, pass the wakeup on to the next writer */
+    if (isWaited) {
+        g_transactionCond.notifyWithoutLock(&g_transactionCond);
+    }
+}
+
+static void EndTransaction()
+{
+    g_transaction.isActive = false;
+    g_transactionCond.notifyWithoutLock(&g_transactionCond);
+}
+
+static void LockDatabaseWrite()
+{
+    g_databaseMutex->lock(g_databaseMutex);
+    WaitForOtherTransaction();
+    g_databaseRwLock->writeLock(g_databaseRwLock);
+    g_isWriteLocked = true;
+}
+
+static void UnlockDatabaseWrite()
+{
+    g_isWriteLocked = false;
+    g_databaseRwLock->unlock(g_databaseRwLock);
+    g_databaseMutex->unlock(g_databaseMutex);
+}
+
+static void LockDatabaseRead()
+{
+    g_databaseRwLock->readLock(g_databaseRwLock);
+}
+
+static void UnlockDatabaseRead()
+{
+    g_databaseRwLock->unlock(g_databaseRwLock);
+}
+
+/* The readers may go on during the file I/O, the other writers still wait on g_databaseMutex. */
+static void BeginDatabaseIo()
+{
+    if (g_isWriteLocked) {
+        g_databaseRwLock->unlock(g_databaseRwLock);
+    }
+}
+
+static void EndDatabaseIo()
+{
+    if (g_isWriteLocked) {
+        g_databaseRwLock->writeLock(g_databaseRwLock);
+    }
+}
 
 static void DestroyStrVector(StringVector *vec)
 {
@@ -116,6 +264,7 @@ static void DestroyGroupTable()
         HcFree(*entry);
     }
     DESTROY_HC_VECTOR(TrustedGroupTable, &g_trustedGroupTable)
+    DestroyHashMap(&g_groupAclIndex);
 }
 
 static void DestroyDeviceEntryStruct(TrustedDeviceEntry *deviceEntry)
@@ -126,14 +275,300 @@ static void DestroyDeviceEntryStruct(TrustedDeviceEntry *deviceEntry)
     DeleteParcel(&deviceEntry->ext);
 }
 
+static void DestroyDeviceEntry(TrustedDeviceEntry *deviceEntry)
+{
+    DestroyDeviceEntryStruct(deviceEntry);
+    HcFree(deviceEntry);
+}
+
+static const char *GetDeviceEntryGroupId(const TrustedDeviceEntry *deviceEntry)
+{
+    return (deviceEntry->groupEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) ?
+        (StringGet(&deviceEntry->groupEntry->id)) : (StringGet(&deviceEntry->serviceType));
+}
+
+/*
+ * The index key is the first string and the second string, both including '\0'.
+ * If the key does not fit in the buffer, the returned key is allocated and must be freed by FreeIndexKey.
+ */
+static char *GenerateIndexKey(const char *first, const char *second, char *buff, uint32_t buffLen,
+    uint32_t *keyLen)
+{
+    uint32_t firstLen = HcStrlen(first) + 1;
+    uint32_t secondLen = (second != NULL) ? (HcStrlen(second) + 1) : 0;
+    uint32_t totalLen = firstLen + secondLen;
+    char *key = buff;
+    if (totalLen > buffLen) {
+        key = (char *)HcMalloc(totalLen, 0);
+        if (key == NULL) {
+            LOGE("[DB]: Failed to allocate index key memory!");
+            return NULL;
+        }
+    }
+    if (memcpy_s(key, totalLen, first, firstLen) != EOK) {
+        if (key != buff) {
+            HcFree(key);
+        }
+        return NULL;
+    }
+    if ((secondLen > 0) && (memcpy_s(key + firstLen, totalLen - firstLen, second, secondLen) != EOK)) {
+        if (key != buff) {
+            HcFree(key);
+        }
+        return NULL;
+    }
+    *keyLen = totalLen;
+    return key;
+}
+
+static void FreeIndexKey(char *key, const char *buff)
+{
+    if (key != buff) {
+        HcFree(key);
+    }
+}
+
+static bool PutDeviceIndex(HcHashMap *index, const char *first, const char *second, TrustedDeviceEntry *entry)
+{
+    char buff[INDEX_KEY_BUFF_LEN];
+    uint32_t keyLen = 0;
+    char *key = GenerateIndexKey(first, second, buff, sizeof(buff), &keyLen);
+    if (key == NULL) {
+        return false;
+    }
+    bool res = HashMapPut(index, key, keyLen, entry);
+    FreeIndexKey(key, buff);
+    return res;
+}
+
+static TrustedDeviceEntry *GetDeviceIndex(const HcHashMap *index, const char *first, const char *second)
+{
+    char buff[INDEX_KEY_BUFF_LEN];
+    uint32_t keyLen = 0;
+    char *key = GenerateIndexKey(first, second, buff, sizeof(buff), &keyLen);
+    if (key == NULL) {
+        return NULL;
+    }
+    TrustedDeviceEntry *entry = (TrustedDeviceEntry *)HashMapGet(index, key, keyLen);
+    FreeIndexKey(key, buff);
+    return entry;
+}
+
+static void RemoveDeviceIndex(HcHashMap *index, const char *first, const char *second,
+    const TrustedDeviceEntry *entry)
+{
+    char buff[INDEX_KEY_BUFF_LEN];
+    uint32_t keyLen = 0;
+    char *key = GenerateIndexKey(first, second, buff, sizeof(buff), &keyLen);
+    if (key == NULL) {
+        return;
+    }
+    (void)HashMapRemove(index, key, keyLen, entry);
+    FreeIndexKey(key, buff);
+}
+
+static void RemoveDeviceEntryFromIndex(const TrustedDeviceEntry *entry)
+{
+    const char *groupId = GetDeviceEntryGroupId(entry);
+    RemoveDeviceIndex(&g_udidGroupIndex, StringGet(&entry->udid), groupId, entry);
+    RemoveDeviceIndex(&g_authIdGroupIndex, StringGet(&entry->authId), groupId, entry);
+    RemoveDeviceIndex(&g_udidIndex, StringGet(&entry->udid), NULL, entry);
+}
+
+static bool AddDeviceEntryToIndex(TrustedDeviceEntry *entry)
+{
+    const char *groupId = GetDeviceEntryGroupId(entry);
+    if (!PutDeviceIndex(&g_udidGroupIndex, StringGet(&entry->udid), groupId, entry) ||
+        !PutDeviceIndex(&g_authIdGroupIndex, StringGet(&entry->authId), groupId, entry) ||
+        !PutDeviceIndex(&g_udidIndex, StringGet(&entry->udid), NULL, entry)) {
+        LOGE("[DB]: Failed to add the device entry to index!");
+        RemoveDeviceEntryFromIndex(entry);
+        return false;
+    }
+    return true;
+}
+
+/* Add the device entry to the table and the indexes, the table takes the ownership of the entry if success. */
+static bool PushDeviceEntry(TrustedDeviceEntry *entry)
+{
+    if (g_trustedDeviceTable.pushBackT(&g_trustedDeviceTable, entry) == NULL) {
+        LOGE("[DB]: Failed to push deviceEntry to deviceTable!");
+        return false;
+    }
+    if (!AddDeviceEntryToIndex(entry)) {
+        TrustedDeviceEntry *tmpEntry = NULL;
+        HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, &tmpEntry, HC_VECTOR_SIZE(&g_trustedDeviceTable) - 1);
+        return false;
+    }
+    return true;
+}
+
+/* Remove the device entry from the table and the indexes, the caller takes the ownership of the entry. */
+static void PopDeviceEntry(uint32_t devIndex, TrustedDeviceEntry **entry)
+{
+    HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, entry, devIndex);
+    RemoveDeviceEntryFromIndex(*entry);
+}
+
+static bool GetDeviceEntryPosition(const TrustedDeviceEntry *entry, uint32_t *devIndex)
+{
+    uint32_t index;
+    TrustedDeviceEntry **deviceEntry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, deviceEntry) {
+        if (*deviceEntry == entry) {
+            *devIndex = index;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* The acl key is the appId including '\0', followed by the address of the group entry. */
+static char *GenerateAclKey(const char *appId, const TrustedGroupEntry *entry, char *buff, uint32_t buffLen,
+    uint32_t *keyLen)
+{
+    uint32_t appIdLen = HcStrlen(appId) + 1;
+    uint32_t totalLen = appIdLen + sizeof(entry);
+    char *key = buff;
+    if (totalLen > buffLen) {
+        key = (char *)HcMalloc(totalLen, 0);
+        if (key == NULL) {
+            LOGE("[DB]: Failed to allocate acl key memory!");
+            return NULL;
+        }
+    }
+    if ((memcpy_s(key, totalLen, appId, appIdLen) != EOK) ||
+        (memcpy_s(key + appIdLen, totalLen - appIdLen, &entry, sizeof(entry)) != EOK)) {
+        FreeIndexKey(key, buff);
+        return NULL;
+    }
+    *keyLen = totalLen;
+    return key;
+}
+
+/* An app which is both a manager and a friend has two elements, so removing one of them keeps the access. */
+static bool PutGroupAcl(const char *appId, TrustedGroupEntry *entry)
+{
+    char buff[INDEX_KEY_BUFF_LEN];
+    uint32_t keyLen = 0;
+    char *key = GenerateAclKey(appId, entry, buff, sizeof(buff), &keyLen);
+    if (key == NULL) {
+        return false;
+    }
+    bool res = HashMapPut(&g_groupAclIndex, key, keyLen, entry);
+    FreeIndexKey(key, buff);
+    return res;
+}
+
+static void RemoveGroupAcl(const char *appId, const TrustedGroupEntry *entry)
+{
+    char buff[INDEX_KEY_BUFF_LEN];
+    uint32_t keyLen = 0;
+    char *key = GenerateAclKey(appId, entry, buff, sizeof(buff), &keyLen);
+    if (key == NULL) {
+        return;
+    }
+    (void)HashMapRemove(&g_groupAclIndex, key, keyLen, entry);
+    FreeIndexKey(key, buff);
+}
+
+static bool HasGroupAcl(const char *appId, const TrustedGroupEntry *entry)
+{
+    char buff[INDEX_KEY_BUFF_LEN];
+    uint32_t keyLen = 0;
+    char *key = GenerateAclKey(appId, entry, buff, sizeof(buff), &keyLen);
+    if (key == NULL) {
+        return false;
+    }
+    bool res = (HashMapGet(&g_groupAclIndex, key, keyLen) != NULL);
+    FreeIndexKey(key, buff);
+    return res;
+}
+
+static void RemoveGroupEntryFromAclIndex(const TrustedGroupEntry *entry)
+{
+    uint32_t index;
+    HcString *appId = NULL;
+    FOR_EACH_HC_VECTOR(entry->managers, index, appId) {
+        RemoveGroupAcl(StringGet(appId), entry);
+    }
+    FOR_EACH_HC_VECTOR(entry->friends, index, appId) {
+        RemoveGroupAcl(StringGet(appId), entry);
+    }
+}
+
+static bool AddGroupEntryToAclIndex(TrustedGroupEntry *entry)
+{
+    uint32_t index;
+    HcString *appId = NULL;
+    bool res = true;
+    FOR_EACH_HC_VECTOR(entry->managers, index, appId) {
+        res = res && PutGroupAcl(StringGet(appId), entry);
+    }
+    FOR_EACH_HC_VECTOR(entry->friends, index, appId) {
+        res = res && PutGroupAcl(StringGet(appId), entry);
+    }
+    if (!res) {
+        LOGE("[DB]: Failed to add the group entry to acl index!");
+        RemoveGroupEntryFromAclIndex(entry);
+    }
+    return res;
+}
+
+/* Add the group entry to the table and the acl index, the table takes the ownership of the entry if success. */
+static bool PushGroupEntry(TrustedGroupEntry *entry)
+{
+    if (g_trustedGroupTable.pushBackT(&g_trustedGroupTable, entry) == NULL) {
+        LOGE("[DB]: Failed to push groupEntry to groupTable!");
+        return false;
+    }
+    if (!AddGroupEntryToAclIndex(entry)) {
+        TrustedGroupEntry *tmpEntry = NULL;
+        HC_VECTOR_POPELEMENT(&g_trustedGroupTable, &tmpEntry, HC_VECTOR_SIZE(&g_trustedGroupTable) - 1);
+        return false;
+    }
+    return true;
+}
+
+/* Remove the group entry from the table and the acl index, the caller takes the ownership of the entry. */
+static void PopGroupEntry(uint32_t groupIndex, TrustedGroupEntry **entry)
+{
+    HC_VECTOR_POPELEMENT(&g_trustedGroupTable, entry, groupIndex);
+    RemoveGroupEntryFromAclIndex(*entry);
+}
+
+/* Drop the entries loaded from a broken database, the tables and the indexes stay usable. */
+static void ClearDBTables()
+{
+    uint32_t index;
+    TrustedDeviceEntry **deviceEntry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, deviceEntry) {
+        DestroyDeviceEntry(*deviceEntry);
+    }
+    g_trustedDeviceTable.clear(&g_trustedDeviceTable);
+    ClearHashMap(&g_udidGroupIndex);
+    ClearHashMap(&g_authIdGroupIndex);
+    ClearHashMap(&g_udidIndex);
+    ClearHashMap(&g_groupAclIndex);
+    TrustedGroupEntry **groupEntry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, groupEntry) {
+        DestroyGroupEntryStruct(*groupEntry);
+        HcFree(*groupEntry);
+    }
+    g_trustedGroupTable.clear(&g_trustedGroupTable);
+}
+
 static void DestroyTrustDevTable()
 {
     uint32_t devIndex;
-    TrustedDeviceEntry *deviceEntry = NULL;
+    TrustedDeviceEntry **deviceEntry = NULL;
     FOR_EACH_HC_VECTOR(g_trustedDeviceTable, devIndex, deviceEntry) {
-        DestroyDeviceEntryStruct(deviceEntry);
+        DestroyDeviceEntry(*deviceEntry);
     }
     DESTROY_HC_VECTOR(TrustedDeviceTable, &g_trustedDeviceTable)
+    DestroyHashMap(&g_udidGroupIndex);
+    DestroyHashMap(&g_authIdGroupIndex);
+    DestroyHashMap(&g_udidIndex);
 }
 
 static int32_t GetSharedUserIdFromVecByGroupId(const TrustedGroupEntry *groupEntry, const char *groupId,
@@ -191,9 +626,7 @@ static bool CompareGroupIdInDeviceEntryOrNull(const TrustedDeviceEntry *deviceEn
     if (groupId == NULL) {
         return true;
     } else {
-        const char *tmpGroupId = (deviceEntry->groupEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) ?
-            (StringGet(&deviceEntry->groupEntry->id)) : (StringGet(&deviceEntry->serviceType));
-        return (strcmp(tmpGroupId, groupId) == 0);
+        return (strcmp(GetDeviceEntryGroupId(deviceEntry), groupId) == 0);
     }
 }
 
@@ -217,12 +650,18 @@ static bool CompareAuthIdInDeviceEntryOrNull(const TrustedDeviceEntry *deviceEnt
 
 static TrustedDeviceEntry *GetTrustedDeviceEntry(const char *udid, const char *groupId)
 {
+    if (udid != NULL) {
+        if (groupId != NULL) {
+            return GetDeviceIndex(&g_udidGroupIndex, udid, groupId);
+        }
+        return GetDeviceIndex(&g_udidIndex, udid, NULL);
+    }
     uint32_t index;
-    TrustedDeviceEntry *deviceEntry = NULL;
+    TrustedDeviceEntry **deviceEntry = NULL;
     FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, deviceEntry) {
-        if (CompareUdidInDeviceEntryOrNull(deviceEntry, udid)) {
-            if (CompareGroupIdInDeviceEntryOrNull(deviceEntry, groupId)) {
-                return deviceEntry;
+        if (CompareUdidInDeviceEntryOrNull(*deviceEntry, udid)) {
+            if (CompareGroupIdInDeviceEntryOrNull(*deviceEntry, groupId)) {
+                return *deviceEntry;
             }
         }
     }
@@ -231,12 +670,15 @@ static TrustedDeviceEntry *GetTrustedDeviceEntry(const char *udid, const char *g
 
 static TrustedDeviceEntry *GetTrustedDeviceEntryByAuthId(const char *authId, const char *groupId)
 {
+    if ((authId != NULL) && (groupId != NULL)) {
+        return GetDeviceIndex(&g_authIdGroupIndex, authId, groupId);
+    }
     uint32_t index;
-    TrustedDeviceEntry *deviceEntry = NULL;
+    TrustedDeviceEntry **deviceEntry = NULL;
     FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, deviceEntry) {
-        if (CompareAuthIdInDeviceEntryOrNull(deviceEntry, authId)) {
-            if (CompareGroupIdInDeviceEntryOrNull(deviceEntry, groupId)) {
-                return deviceEntry;
+        if (CompareAuthIdInDeviceEntryOrNull(*deviceEntry, authId)) {
+            if (CompareGroupIdInDeviceEntryOrNull(*deviceEntry, groupId)) {
+                return *deviceEntry;
             }
         }
     }
@@ -354,6 +796,76 @@ static int32_t GenerateDeviceInfoByEntry(const TrustedDeviceEntry *deviceEntry,
     return GenerateDeviceInfoId(StringGet(&deviceEntry->serviceType), returnDeviceInfo);
 }
 
+static void PostDbEvent(const DbEvent *event)
+{
+    if (g_broadcaster == NULL) {
+        return;
+    }
+    const char *udid = StringGet(&event->udid);
+    switch (event->type) {
+        case DB_EVENT_GROUP_CREATED:
+            g_broadcaster->postOnGroupCreated(event->groupInfo);
+            break;
+        case DB_EVENT_GROUP_DELETED:
+            g_broadcaster->postOnGroupDeleted(event->groupInfo);
+            break;
+        case DB_EVENT_DEVICE_BOUND:
+            g_broadcaster->postOnDeviceBound(udid, event->groupInfo);
+            break;
+        case DB_EVENT_DEVICE_UNBOUND:
+            g_broadcaster->postOnDeviceUnBound(udid, event->groupInfo);
+            break;
+        case DB_EVENT_DEVICE_NOT_TRUSTED:
+            g_broadcaster->postOnDeviceNotTrusted(udid);
+            break;
+        case DB_EVENT_LAST_GROUP_DELETED:
+            g_broadcaster->postOnLastGroupDeleted(udid, event->groupType);
+            break;
+        default:
+            break;
+    }
+}
+
+static void DestroyDbEvents(DbEventVec *events)
+{
+    uint32_t index;
+    DbEvent *event = NULL;
+    FOR_EACH_HC_VECTOR(*events, index, event) {
+        DeleteString(&event->udid);
+        if (event->groupInfo != NULL) {
+            DestroyGroupInfoStruct(event->groupInfo);
+        }
+    }
+    DESTROY_HC_VECTOR(DbEventVec, events)
+}
+
+/* Post the event now, or keep it until the transaction is committed. The groupInfo is consumed. */
+static void DispatchDbEvent(int32_t type, const char *udid, GroupInfo *groupInfo, int32_t groupType)
+{
+    DbEvent event;
+    event.type = type;
+    event.groupType = groupType;
+    event.udid = CreateString();
+    event.groupInfo = groupInfo;
+    if ((udid != NULL) && !StringSetPointer(&event.udid, udid)) {
+        LOGE("[DB]: Failed to copy udid of the event!");
+        DeleteString(&event.udid);
+        if (groupInfo != NULL) {
+            DestroyGroupInfoStruct(groupInfo);
+        }
+        return;
+    }
+    if (g_transaction.isActive &&
+        (g_transaction.events.pushBackT(&g_transaction.events, event) != NULL)) {
+        return;
+    }
+    PostDbEvent(&event);
+    DeleteString(&event.udid);
+    if (groupInfo != NULL) {
+        DestroyGroupInfoStruct(groupInfo);
+    }
+}
+
 static void NotifyGroupCreated(const TrustedGroupEntry *groupEntry, int64_t userId)
 {
     if ((g_broadcaster == NULL) || (g_broadcaster->postOnGroupCreated == NULL)) {
@@ -368,8 +880,7 @@ static void NotifyGroupCreated(const TrustedGroupEntry *groupEntry, int64_t user
         DestroyGroupInfoStruct(groupInfo);
         return;
     }
-    g_broadcaster->postOnGroupCreated(groupInfo);
-    DestroyGroupInfoStruct(groupInfo);
+    DispatchDbEvent(DB_EVENT_GROUP_CREATED, NULL, groupInfo, 0);
 }
 
 static void NotifyGroupDeleted(const TrustedGroupEntry *groupEntry, int64_t userId)
@@ -386,8 +897,7 @@ static void NotifyGroupDeleted(const TrustedGroupEntry *groupEntry, int64_t user
         DestroyGroupInfoStruct(groupInfo);
         return;
     }
-    g_broadcaster->postOnGroupDeleted(groupInfo);
-    DestroyGroupInfoStruct(groupInfo);
+    DispatchDbEvent(DB_EVENT_GROUP_DELETED, NULL, groupInfo, 0);
 }
 
 static void NotifyDeviceBound(const TrustedGroupEntry *groupEntry, const char *udid, int64_t sharedUserId)
@@ -404,8 +914,7 @@ static void NotifyDeviceBound(const TrustedGroupEntry *groupEntry, const char *u
         DestroyGroupInfoStruct(groupInfo);
         return;
     }
-    g_broadcaster->postOnDeviceBound(udid, groupInfo);
-    DestroyGroupInfoStruct(groupInfo);
+    DispatchDbEvent(DB_EVENT_DEVICE_BOUND, udid, groupInfo, 0);
 }
 
 static void NotifyDeviceUnBound(const TrustedGroupEntry *groupEntry, const char *udid, int64_t sharedUserId)
@@ -422,26 +931,30 @@ static void NotifyDeviceUnBound(const TrustedGroupEntry *groupEntry, const char
         DestroyGroupInfoStruct(groupInfo);
         return;
     }
-    g_broadcaster->postOnDeviceUnBound(udid, groupInfo);
-    DestroyGroupInfoStruct(groupInfo);
+    DispatchDbEvent(DB_EVENT_DEVICE_UNBOUND, udid, groupInfo, 0);
 }
 
 static void NotifyDeviceNotTrusted(const char *peerUdid)
 {
     if (g_broadcaster != NULL && g_broadcaster->postOnDeviceNotTrusted != NULL) {
-        g_broadcaster->postOnDeviceNotTrusted(peerUdid);
+        DispatchDbEvent(DB_EVENT_DEVICE_NOT_TRUSTED, peerUdid, NULL, 0);
     }
 }
 
 static void NotifyLastGroupDeleted(const char *peerUdid, int groupType)
 {
     if (g_broadcaster != NULL && g_broadcaster->postOnLastGroupDeleted != NULL) {
-        g_broadcaster->postOnLastGroupDeleted(peerUdid, groupType);
+        DispatchDbEvent(DB_EVENT_LAST_GROUP_DELETED, peerUdid, NULL, groupType);
     }
 }
 
 static void NotifyTrustedDeviceNumChanged()
 {
+    if (g_transaction.isActive) {
+        /* posted once on commit */
+        g_transaction.isDevNumChanged = true;
+        return;
+    }
     int trustedDeviceNum = GetTrustedDeviceNum();
     if (g_broadcaster != NULL && g_broadcaster->postOnTrustedDeviceNumChanged != NULL) {
         g_broadcaster->postOnTrustedDeviceNumChanged(trustedDeviceNum);
@@ -562,6 +1075,7 @@ static bool InitAuthInfo(const DeviceInfo *deviceInfo, const Uint8Buff *ext, Tru
     deviceEntry->devType = deviceInfo->devType;
     deviceEntry->userId = deviceInfo->userId;
     deviceEntry->lastTm = 0;
+    deviceEntry->savedLastTm = 0;
     if (ext != NULL && ext->val != NULL) {
         if (!ParcelWrite(&deviceEntry->ext, ext->val, ext->length)) {
             LOGE("[DB]: Failed to copy extern data!");
@@ -573,15 +1087,13 @@ static bool InitAuthInfo(const DeviceInfo *deviceInfo, const Uint8Buff *ext, Tru
 
 static bool IsDeleteLastSuchTypeGroup(const char *udid, int groupType)
 {
-    uint32_t devIndex;
-    TrustedDeviceEntry *deviceEntry = NULL;
-    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, devIndex, deviceEntry) {
-        if ((deviceEntry != NULL) && (deviceEntry->groupEntry != NULL)) {
-            const char *devUdid = StringGet(&deviceEntry->udid);
-            if ((strcmp(devUdid, udid) == 0) && (deviceEntry->groupEntry->type == groupType)) {
-                return false;
-            }
+    const HcHashNode *node = HashMapFind(&g_udidIndex, udid, HcStrlen(udid) + 1);
+    while (node != NULL) {
+        const TrustedDeviceEntry *deviceEntry = (const TrustedDeviceEntry *)node->value;
+        if ((deviceEntry->groupEntry != NULL) && (deviceEntry->groupEntry->type == groupType)) {
+            return false;
         }
+        node = HashMapFindNext(node);
     }
     return true;
 }
@@ -641,16 +1153,10 @@ static bool IsGroupManager(const char *appId, const TrustedGroupEntry *entry)
     return false;
 }
 
-static bool IsGroupFriend(const char *appId, const TrustedGroupEntry *entry)
+/* The public groups, and the groups the app manages or is a friend of, are accessible. */
+static bool IsGroupAccessibleInner(const char *appId, const TrustedGroupEntry *entry)
 {
-    uint32_t index;
-    HcString *trustedFriend = NULL;
-    FOR_EACH_HC_VECTOR(entry->friends, index, trustedFriend) {
-        if (strcmp(StringGet(trustedFriend), appId) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return (entry->visibility == GROUP_VISIBILITY_PUBLIC) || HasGroupAcl(appId, entry);
 }
 
 static bool CompareSearchParams(int groupType, const char *groupId, const char *groupName, const char *groupOwner,
@@ -889,29 +1395,6 @@ static bool SetGroupFromTlv(TrustedGroupEntry *entry, TlvGroupElement *group)
     return true;
 }
 
-static bool LoadGroupDb(HCDataBaseV1 *db)
-{
-    uint32_t index;
-    TlvGroupElement *group = NULL;
-    FOR_EACH_HC_VECTOR(db->groups.data, index, group) {
-        TrustedGroupEntry *entry = HcMalloc(sizeof(TrustedGroupEntry), 0);
-        if (entry == NULL) {
-            return false;
-        }
-        if (!SetGroupFromTlv(entry, group)) {
-            DestroyGroupEntryStruct(entry);
-            HcFree(entry);
-            return false;
-        }
-        if (g_trustedGroupTable.pushBack(&g_trustedGroupTable, (const TrustedGroupEntry **)&entry) == NULL) {
-            DestroyGroupEntryStruct(entry);
-            HcFree(entry);
-            return false;
-        }
-    }
-    return true;
-}
-
 static bool SetDevAuthFromTlv(TrustedDeviceEntry *authInfo, TlvDevAuthElement *devAuth)
 {
     authInfo->udid = CreateString();
@@ -936,35 +1419,79 @@ static bool SetDevAuthFromTlv(TrustedDeviceEntry *authInfo, TlvDevAuthElement *d
         authInfo->devType = devAuth->info.data.devType;
         authInfo->userId = devAuth->info.data.userId;
         authInfo->lastTm = devAuth->info.data.lastTm;
+        authInfo->savedLastTm = authInfo->lastTm;
         return true;
     } else {
         return false;
     }
 }
 
-static bool LoadDevAuthDb(HCDataBaseV1 *db)
+static bool LoadGroupElement(TlvGroupElement *group)
 {
-    uint32_t index;
-    TlvDevAuthElement *devAuth = NULL;
-    FOR_EACH_HC_VECTOR(db->deviceAuthInfos.data, index, devAuth) {
-        TrustedDeviceEntry authInfo;
-        if (!SetDevAuthFromTlv(&authInfo, devAuth)) {
-            DestroyDeviceEntryStruct(&authInfo);
-            return false;
-        }
-        if (g_trustedDeviceTable.pushBack(&g_trustedDeviceTable, &authInfo) == NULL) {
-            DestroyDeviceEntryStruct(&authInfo);
-            return false;
-        }
+    TrustedGroupEntry *entry = HcMalloc(sizeof(TrustedGroupEntry), 0);
+    if (entry == NULL) {
+        return false;
+    }
+    if (!SetGroupFromTlv(entry, group)) {
+        DestroyGroupEntryStruct(entry);
+        HcFree(entry);
+        return false;
+    }
+    if (!PushGroupEntry(entry)) {
+        DestroyGroupEntryStruct(entry);
+        HcFree(entry);
+        return false;
     }
     return true;
 }
 
-static bool LoadDBFromParcel(HcParcel *parcelIn)
+static bool LoadDevAuthElement(TlvDevAuthElement *devAuth)
 {
-    bool ret = false;
-    HCDataBaseV1 dbv1;
-    TLV_INIT(HCDataBaseV1, &dbv1);
+    TrustedDeviceEntry *authInfo = (TrustedDeviceEntry *)HcMalloc(sizeof(TrustedDeviceEntry), 0);
+    if (authInfo == NULL) {
+        LOGE("[DB]: Failed to allocate deviceEntry memory!");
+        return false;
+    }
+    if (!SetDevAuthFromTlv(authInfo, devAuth)) {
+        DestroyDeviceEntry(authInfo);
+        return false;
+    }
+    if (!PushDeviceEntry(authInfo)) {
+        DestroyDeviceEntry(authInfo);
+        return false;
+    }
+    return true;
+}
+
+static bool LoadGroupDb(HCDataBaseV1 *db)
+{
+    uint32_t index;
+    TlvGroupElement *group = NULL;
+    FOR_EACH_HC_VECTOR(db->groups.data, index, group) {
+        if (!LoadGroupElement(group)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool LoadDevAuthDb(HCDataBaseV1 *db)
+{
+    uint32_t index;
+    TlvDevAuthElement *devAuth = NULL;
+    FOR_EACH_HC_VECTOR(db->deviceAuthInfos.data, index, devAuth) {
+        if (!LoadDevAuthElement(devAuth)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool LoadDBV1FromParcel(HcParcel *parcelIn)
+{
+    bool ret = false;
+    HCDataBaseV1 dbv1;
+    TLV_INIT(HCDataBaseV1, &dbv1);
     if (DecodeTlvMessage((TlvBase *)&dbv1, parcelIn, false)) {
         if (!LoadGroupDb(&dbv1)) {
             TLV_DEINIT(dbv1);
@@ -982,11 +1509,531 @@ static bool LoadDBFromParcel(HcParcel *parcelIn)
     return ret;
 }
 
-static bool LoadDB()
+static bool LoadGroupRecords(HcParcel *parcelIn, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        TlvGroupElement group;
+        TLV_INIT(TlvGroupElement, &group);
+        if (ParseTlvNode((TlvBase *)&group, parcelIn, false) < 0) {
+            LOGE("[DB]: Failed to decode group record!");
+            TLV_DEINIT(group);
+            return false;
+        }
+        bool ret = LoadGroupElement(&group);
+        TLV_DEINIT(group);
+        if (!ret) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool LoadDevAuthRecords(HcParcel *parcelIn, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        TlvDevAuthElement devAuth;
+        TLV_INIT(TlvDevAuthElement, &devAuth);
+        if (ParseTlvNode((TlvBase *)&devAuth, parcelIn, false) < 0) {
+            LOGE("[DB]: Failed to decode device record!");
+            TLV_DEINIT(devAuth);
+            return false;
+        }
+        bool ret = LoadDevAuthElement(&devAuth);
+        TLV_DEINIT(devAuth);
+        if (!ret) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool LoadDBV2FromParcel(HcParcel *parcelIn, uint32_t *journalSeq)
+{
+    HCDataBaseV2Head head;
+    TLV_INIT(HCDataBaseV2Head, &head);
+    if (ParseTlvNode((TlvBase *)&head, parcelIn, false) < 0) {
+        LOGE("[DB]: Failed to decode database head!");
+        TLV_DEINIT(head);
+        return false;
+    }
+    uint32_t groupCount = head.groupCount.data;
+    uint32_t deviceCount = head.deviceCount.data;
+    *journalSeq = head.journalSeq.data;
+    TLV_DEINIT(head);
+    /* every record takes at least a TLV head, which bounds the counts read from the file */
+    uint32_t maxCount = GetParcelDataSize(parcelIn) / (sizeof(uint16_t) + sizeof(uint16_t));
+    if ((groupCount > maxCount) || (deviceCount > maxCount - groupCount)) {
+        LOGE("[DB]: Invalid record counts in database head!");
+        return false;
+    }
+    /* the tables grow once instead of once per record */
+    (void)HC_VECTOR_RESERVE(&g_trustedGroupTable, HC_VECTOR_SIZE(&g_trustedGroupTable) + groupCount);
+    (void)HC_VECTOR_RESERVE(&g_trustedDeviceTable, HC_VECTOR_SIZE(&g_trustedDeviceTable) + deviceCount);
+    if (!LoadGroupRecords(parcelIn, groupCount) || !LoadDevAuthRecords(parcelIn, deviceCount)) {
+        return false;
+    }
+    if (GetParcelDataSize(parcelIn) != 0) {
+        LOGE("[DB]: Unexpected data after the last record!");
+        return false;
+    }
+    return true;
+}
+
+static bool IsDataBaseV1(HcParcel *parcelIn)
+{
+    uint16_t tag = 0;
+    if (!ParcelReadWithoutPopData(parcelIn, &tag, sizeof(tag))) {
+        return false;
+    }
+#ifdef IS_BIG_ENDIAN
+    DataRevert(&tag, sizeof(tag));
+#endif
+    return (tag == HC_DATABASE_V1_TAG);
+}
+
+static bool LoadDBFromParcel(HcParcel *parcelIn, bool *isV1, uint32_t *journalSeq)
+{
+    *isV1 = IsDataBaseV1(parcelIn);
+    if (*isV1) {
+        LOGI("[DB]: The database is in version 1 format, it will be migrated.");
+        /* the version 1 database was saved before the journal existed */
+        *journalSeq = 0;
+        return LoadDBV1FromParcel(parcelIn);
+    }
+    return LoadDBV2FromParcel(parcelIn, journalSeq);
+}
+
+
+static bool GenerateGroupElement(const TrustedGroupEntry *entry, TlvGroupElement *element)
+{
+    if (!StringSet(&element->name.data, entry->name)) {
+        return false;
+    }
+    if (!StringSet(&element->id.data, entry->id)) {
+        return false;
+    }
+    element->type.data = entry->type;
+    element->visibility.data = entry->visibility;
+    element->expireTime.data = entry->expireTime;
+    element->userId.data = entry->userId;
+    if (!SaveStringVectorToParcel(&entry->managers, &element->managers.data)) {
+        return false;
+    }
+    if (!SaveStringVectorToParcel(&entry->friends, &element->friends.data)) {
+        return false;
+    }
+    if (!SaveInt64VectorToParcel(&entry->sharedUserIdVec, &element->sharedUserIdVec.data)) {
+        return false;
+    }
+    return true;
+}
+
+static bool GenerateDevAuthElement(TrustedDeviceEntry *authInfo, TlvDevAuthElement *element)
+{
+    if (!StringSet(&element->groupId.data, authInfo->groupEntry->id)) {
+        return false;
+    }
+    if (!StringSet(&element->udid.data, authInfo->udid)) {
+        return false;
+    }
+    if (!StringSet(&element->authId.data, authInfo->authId)) {
+        return false;
+    }
+    if (!StringSet(&element->serviceType.data, authInfo->serviceType)) {
+        return false;
+    }
+    if (!ParcelCopy(&element->ext.data, &authInfo->ext)) {
+        return false;
+    }
+    element->info.data.credential = authInfo->credential;
+    element->info.data.devType = authInfo->devType;
+    element->info.data.userId = authInfo->userId;
+    element->info.data.lastTm = authInfo->lastTm;
+    return true;
+}
+
+/* The records are encoded into a chunk buffer, which is written to the file whenever it is full. */
+static bool FlushDBChunk(DBSnapshotWriter *writer, bool force)
+{
+    int dataSize = (int)GetParcelDataSize(&writer->chunk);
+    if ((dataSize == 0) || (!force && (dataSize < DB_SAVE_CHUNK_SIZE))) {
+        return true;
+    }
+    if (HcFileWrite(writer->file, GetParcelData(&writer->chunk), dataSize) != dataSize) {
+        LOGE("[DB]: Failed to write database chunk!");
+        return false;
+    }
+    writer->checksum = HcCrc32(writer->checksum, (const uint8_t *)GetParcelData(&writer->chunk), (uint32_t)dataSize);
+    writer->writtenSize += (uint32_t)dataSize;
+    ClearParcel(&writer->chunk);
+    return true;
+}
+
+static bool SaveDBHead(DBSnapshotWriter *writer)
+{
+    HCDataBaseV2Head head;
+    TLV_INIT(HCDataBaseV2Head, &head);
+    head.version.data = HC_DATABASE_VERSION;
+    head.groupCount.data = g_trustedGroupTable.size(&g_trustedGroupTable);
+    head.deviceCount.data = g_trustedDeviceTable.size(&g_trustedDeviceTable);
+    head.journalSeq.data = GetJournalSeq();
+    int32_t ret = EncodeTlvNode((TlvBase *)&head, &writer->chunk, HC_FALSE);
+    TLV_DEINIT(head);
+    if (ret < 0) {
+        LOGE("[DB]: Failed to encode database head!");
+        return false;
+    }
+    return FlushDBChunk(writer, false);
+}
+
+static bool SaveGroupRecords(DBSnapshotWriter *writer)
+{
+    uint32_t index;
+    TrustedGroupEntry **entry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
+        TlvGroupElement element;
+        TLV_INIT(TlvGroupElement, &element);
+        if (!GenerateGroupElement(*entry, &element) ||
+            (EncodeTlvNode((TlvBase *)&element, &writer->chunk, HC_FALSE) < 0)) {
+            LOGE("[DB]: Failed to encode group record!");
+            TLV_DEINIT(element);
+            return false;
+        }
+        TLV_DEINIT(element);
+        if (!FlushDBChunk(writer, false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool SaveDevAuthRecords(DBSnapshotWriter *writer)
+{
+    uint32_t index;
+    TrustedDeviceEntry **entry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, entry) {
+        TlvDevAuthElement element;
+        TLV_INIT(TlvDevAuthElement, &element);
+        if (!GenerateDevAuthElement(*entry, &element) ||
+            (EncodeTlvNode((TlvBase *)&element, &writer->chunk, HC_FALSE) < 0)) {
+            LOGE("[DB]: Failed to encode device record!");
+            TLV_DEINIT(element);
+            return false;
+        }
+        TLV_DEINIT(element);
+        if (!FlushDBChunk(writer, false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool WriteDBUint32(HcParcel *parcel, uint32_t value)
+{
+#ifdef IS_BIG_ENDIAN
+    return ParcelWriteUint32Revert(parcel, value);
+#else
+    return ParcelWriteUint32(parcel, value);
+#endif
+}
+
+static bool ReadDBUint32(HcParcel *parcel, uint32_t *value)
+{
+#ifdef IS_BIG_ENDIAN
+    return ParcelReadUint32Revert(parcel, value);
+#else
+    return ParcelReadUint32(parcel, value);
+#endif
+}
+
+static bool SaveDBTrailer(DBSnapshotWriter *writer)
+{
+    if (!FlushDBChunk(writer, true)) {
+        return false;
+    }
+    if (!WriteDBUint32(&writer->chunk, DB_TRAILER_MAGIC) || !WriteDBUint32(&writer->chunk, writer->writtenSize) ||
+        !WriteDBUint32(&writer->chunk, writer->checksum)) {
+        LOGE("[DB]: Failed to encode database trailer!");
+        return false;
+    }
+    return FlushDBChunk(writer, true);
+}
+
+/*
+ * The database is saved in version 2 format: a head with the record counts, followed by the group
+ * records and the device records. Every record is a separate TLV node, so the size of the database
+ * is not limited by the length of a single TLV node. A trailer with the length and the crc32 of the
+ * records lets the loader detect a broken file.
+ * The snapshot is written to a temporary file and then renamed over the old one, so a crash during
+ * the save never leaves a half-written database behind.
+ */
+static bool SaveDB()
+{
+    DBSnapshotWriter writer;
+    writer.writtenSize = 0;
+    writer.checksum = 0;
+    if (HcFileOpen(FILE_ID_GROUP, MODE_FILE_WRITE_TEMP, &writer.file) != 0) {
+        return false;
+    }
+    /* reserve enough space for a full chunk and the record that overflows it */
+    writer.chunk = CreateParcel(DB_SAVE_CHUNK_SIZE * 2, DB_SAVE_CHUNK_SIZE);
+    bool res = SaveDBHead(&writer) && SaveGroupRecords(&writer) && SaveDevAuthRecords(&writer) &&
+        SaveDBTrailer(&writer);
+    DeleteParcel(&writer.chunk);
+    if (!res) {
+        HcFileClose(writer.file);
+        return false;
+    }
+    if (HcFileCommit(FILE_ID_GROUP, writer.file, g_isBackupKept) != 0) {
+        LOGE("[DB]: Failed to commit database snapshot!");
+        return false;
+    }
+    g_isBackupKept = false;
+    g_snapshotSize = writer.writtenSize;
+    return true;
+}
+
+static bool CompactDB()
+{
+    BeginDatabaseIo();
+    bool ret = SaveDB();
+    if (ret) {
+        ResetJournal();
+    }
+    EndDatabaseIo();
+    return ret;
+}
+
+/* Compact the journal into a new snapshot once it is larger than the snapshot, so the cost is amortized. */
+static void CompactDBIfNeeded()
+{
+    uint32_t journalSize = GetJournalSize();
+    if ((journalSize < JOURNAL_COMPACT_MIN_SIZE) || (journalSize < g_snapshotSize)) {
+        return;
+    }
+    if (!CompactDB()) {
+        LOGW("[DB]: Failed to compact database, it will be retried on the next change!");
+    }
+}
+
+static bool AppendChangeToJournal(uint32_t type, TlvBase *element)
+{
+    HcParcel payload = CreateParcel(0, 0);
+    bool ret = (EncodeTlvNode(element, &payload, HC_FALSE) >= 0);
+    if (ret) {
+        BeginDatabaseIo();
+        ret = AppendJournalRecord(type, &payload);
+        EndDatabaseIo();
+    }
+    DeleteParcel(&payload);
+    if (!ret) {
+        LOGE("[DB]: Failed to append the change to journal!");
+    }
+    return ret;
+}
+
+/* Persist the added or modified group, a full snapshot is saved if the journal is not available. */
+static bool SaveGroupChange(const TrustedGroupEntry *entry)
+{
+    if (g_transaction.isActive) {
+        g_transaction.isDirty = true;
+        return true;
+    }
+    TlvGroupElement element;
+    TLV_INIT(TlvGroupElement, &element);
+    bool ret = GenerateGroupElement(entry, &element) && AppendChangeToJournal(JOURNAL_PUT_GROUP, (TlvBase *)&element);
+    TLV_DEINIT(element);
+    if (!ret) {
+        return CompactDB();
+    }
+    CompactDBIfNeeded();
+    return true;
+}
+
+/* Persist the added (JOURNAL_PUT_DEVICE) or deleted (JOURNAL_DEL_DEVICE) device. */
+static bool SaveDeviceChange(TrustedDeviceEntry *entry, uint32_t type)
+{
+    if (g_transaction.isActive) {
+        g_transaction.isDirty = true;
+        return true;
+    }
+    TlvDevAuthElement element;
+    TLV_INIT(TlvDevAuthElement, &element);
+    bool ret = GenerateDevAuthElement(entry, &element) && AppendChangeToJournal(type, (TlvBase *)&element);
+    TLV_DEINIT(element);
+    if (!ret) {
+        return CompactDB();
+    }
+    CompactDBIfNeeded();
+    return true;
+}
+
+/* Persist the deleted group, the devices in it are deleted along with it on replay. */
+static bool SaveGroupDelete(const char *groupId)
+{
+    if (g_transaction.isActive) {
+        g_transaction.isDirty = true;
+        return true;
+    }
+    TlvGroupElement element;
+    TLV_INIT(TlvGroupElement, &element);
+    bool ret = StringSetPointer(&element.id.data, groupId) &&
+        AppendChangeToJournal(JOURNAL_DEL_GROUP, (TlvBase *)&element);
+    TLV_DEINIT(element);
+    if (!ret) {
+        return CompactDB();
+    }
+    CompactDBIfNeeded();
+    return true;
+}
+
+/* Persist a change of many entries, the whole database is saved. */
+static bool SaveBulkChange()
+{
+    if (g_transaction.isActive) {
+        g_transaction.isDirty = true;
+        return true;
+    }
+    return CompactDB();
+}
+
+static TrustedGroupEntry *GetGroupEntryById(const char *groupId)
+{
+    uint32_t groupIndex;
+    TrustedGroupEntry **entry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
+        if (strcmp(StringGet(&(*entry)->id), groupId) == 0) {
+            return *entry;
+        }
+    }
+    return NULL;
+}
+
+static bool ReplayGroupChange(HcParcel *payload)
+{
+    TlvGroupElement group;
+    TLV_INIT(TlvGroupElement, &group);
+    if (ParseTlvNode((TlvBase *)&group, payload, false) < 0) {
+        TLV_DEINIT(group);
+        return false;
+    }
+    bool ret = true;
+    TrustedGroupEntry *oldEntry = GetGroupEntryById(StringGet(&group.id.data));
+    if (oldEntry == NULL) {
+        ret = LoadGroupElement(&group);
+    } else {
+        /* update in place, the device entries refer to the group entry */
+        TrustedGroupEntry newEntry;
+        if (SetGroupFromTlv(&newEntry, &group)) {
+            RemoveGroupEntryFromAclIndex(oldEntry);
+            DestroyGroupEntryStruct(oldEntry);
+            *oldEntry = newEntry;
+            ret = AddGroupEntryToAclIndex(oldEntry);
+        } else {
+            DestroyGroupEntryStruct(&newEntry);
+            ret = false;
+        }
+    }
+    TLV_DEINIT(group);
+    return ret;
+}
+
+static bool ReplayDeviceChange(uint32_t type, HcParcel *payload)
+{
+    TlvDevAuthElement devAuth;
+    TLV_INIT(TlvDevAuthElement, &devAuth);
+    if (ParseTlvNode((TlvBase *)&devAuth, payload, false) < 0) {
+        TLV_DEINIT(devAuth);
+        return false;
+    }
+    TrustedDeviceEntry *entry = (TrustedDeviceEntry *)HcMalloc(sizeof(TrustedDeviceEntry), 0);
+    if (entry == NULL) {
+        TLV_DEINIT(devAuth);
+        return false;
+    }
+    bool ret = SetDevAuthFromTlv(entry, &devAuth);
+    TLV_DEINIT(devAuth);
+    if (!ret) {
+        DestroyDeviceEntry(entry);
+        return false;
+    }
+    /* the records are idempotent, an existing device is replaced */
+    uint32_t devIndex;
+    TrustedDeviceEntry *oldEntry = GetTrustedDeviceEntry(StringGet(&entry->udid), GetDeviceEntryGroupId(entry));
+    if ((oldEntry != NULL) && GetDeviceEntryPosition(oldEntry, &devIndex)) {
+        TrustedDeviceEntry *tmpEntry = NULL;
+        PopDeviceEntry(devIndex, &tmpEntry);
+        DestroyDeviceEntry(tmpEntry);
+    }
+    if (type == JOURNAL_DEL_DEVICE) {
+        DestroyDeviceEntry(entry);
+        return true;
+    }
+    if (!PushDeviceEntry(entry)) {
+        DestroyDeviceEntry(entry);
+        return false;
+    }
+    return true;
+}
+
+static bool ReplayGroupDelete(HcParcel *payload)
+{
+    TlvGroupElement group;
+    TLV_INIT(TlvGroupElement, &group);
+    if (ParseTlvNode((TlvBase *)&group, payload, false) < 0) {
+        TLV_DEINIT(group);
+        return false;
+    }
+    const char *groupId = StringGet(&group.id.data);
+    uint32_t devIndex = 0;
+    TrustedDeviceEntry **deviceEntry = NULL;
+    while (devIndex < g_trustedDeviceTable.size(&g_trustedDeviceTable)) {
+        deviceEntry = g_trustedDeviceTable.getp(&g_trustedDeviceTable, devIndex);
+        /* the devices which point to the group, like DelDeviceEntryByGroupId, whatever their service type */
+        if (strcmp(StringGet(&(*deviceEntry)->groupEntry->id), groupId) != 0) {
+            devIndex++;
+            continue;
+        }
+        TrustedDeviceEntry *tmpDeviceEntry = NULL;
+        PopDeviceEntry(devIndex, &tmpDeviceEntry);
+        DestroyDeviceEntry(tmpDeviceEntry);
+    }
+    uint32_t groupIndex;
+    TrustedGroupEntry **groupEntry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, groupEntry) {
+        if (IsGroupIdEquals(*groupEntry, groupId)) {
+            TrustedGroupEntry *tmpEntry = NULL;
+            PopGroupEntry(groupIndex, &tmpEntry);
+            DestroyGroupEntryStruct(tmpEntry);
+            HcFree(tmpEntry);
+            break;
+        }
+    }
+    TLV_DEINIT(group);
+    return true;
+}
+
+static bool ReplayJournalRecord(uint32_t type, HcParcel *payload)
+{
+    switch (type) {
+        case JOURNAL_PUT_GROUP:
+            return ReplayGroupChange(payload);
+        case JOURNAL_DEL_GROUP:
+            return ReplayGroupDelete(payload);
+        case JOURNAL_PUT_DEVICE:
+        case JOURNAL_DEL_DEVICE:
+            return ReplayDeviceChange(type, payload);
+        default:
+            LOGE("[DB]: Unknown journal record type: %u!", type);
+            return false;
+    }
+}
+
+
+static bool ReadDBFile(int mode, HcParcel *parcel)
 {
     FileHandle file;
-    int ret = HcFileOpen(FILE_ID_GROUP, MODE_FILE_READ, &file);
-    if (ret != 0) {
+    if (HcFileOpen(FILE_ID_GROUP, mode, &file) != 0) {
         return false;
     }
     int fileSize = HcFileSize(file);
@@ -1005,137 +2052,151 @@ static bool LoadDB()
         return false;
     }
     HcFileClose(file);
-    HcParcel parcel = CreateParcel(0, 0);
-    if (!ParcelWrite(&parcel, fileData, fileSize)) {
-        HcFree(fileData);
-        DeleteParcel(&parcel);
+    *parcel = CreateParcel(0, 0);
+    bool ret = ParcelWrite(parcel, fileData, fileSize);
+    HcFree(fileData);
+    if (!ret) {
+        DeleteParcel(parcel);
+    }
+    return ret;
+}
+
+/* Check the trailer and strip it. A version 1 database was saved without a trailer. */
+static bool VerifyDBTrailer(HcParcel *parcel)
+{
+    if (IsDataBaseV1(parcel)) {
+        return true;
+    }
+    uint32_t dataSize = GetParcelDataSize(parcel);
+    if (dataSize < DB_TRAILER_LEN) {
+        LOGE("[DB]: The database is too short to have a trailer!");
         return false;
     }
-    ret = LoadDBFromParcel(&parcel);
-    HcFree(fileData);
+    dataSize -= DB_TRAILER_LEN;
+    HcParcel trailer = CreateParcel(0, 0);
+    uint32_t magic = 0;
+    uint32_t recordsSize = 0;
+    uint32_t checksum = 0;
+    bool ret = ParcelWrite(&trailer, GetParcelData(parcel) + dataSize, DB_TRAILER_LEN) &&
+        ReadDBUint32(&trailer, &magic) && ReadDBUint32(&trailer, &recordsSize) && ReadDBUint32(&trailer, &checksum);
+    DeleteParcel(&trailer);
+    if (!ret || (magic != DB_TRAILER_MAGIC) || (recordsSize != dataSize)) {
+        LOGE("[DB]: The database trailer is broken!");
+        return false;
+    }
+    if (HcCrc32(0, (const uint8_t *)GetParcelData(parcel), dataSize) != checksum) {
+        LOGE("[DB]: The database checksum mismatches!");
+        return false;
+    }
+    return ParcelPopBack(parcel, DB_TRAILER_LEN);
+}
+
+static bool LoadDBFile(int mode, bool *isV1, uint32_t *fileSize, uint32_t *journalSeq)
+{
+    HcParcel parcel;
+    if (!ReadDBFile(mode, &parcel)) {
+        return false;
+    }
+    *fileSize = GetParcelDataSize(&parcel);
+    bool ret = VerifyDBTrailer(&parcel) && LoadDBFromParcel(&parcel, isV1, journalSeq);
     DeleteParcel(&parcel);
+    if (!ret) {
+        ClearDBTables();
+    }
     return ret;
 }
 
-static bool SaveGroupDb(HCDataBaseV1 *db)
+/*
+ * If the database is missing or broken, the previous generation is loaded instead. The changes
+ * made after it are replayed from the journal if they have not been compacted yet.
+ * The previous generation is then kept by the next save, instead of being replaced by the broken file.
+ */
+static bool LoadDB(bool *isV1, uint32_t *journalSeq)
 {
-    uint32_t index;
-    TrustedGroupEntry **entry;
-    FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
-        TlvGroupElement tmp;
-        TlvGroupElement *element = db->groups.data.pushBack(&db->groups.data, &tmp);
-        if (element != NULL) {
-            TLV_INIT(TlvGroupElement, element);
-            if (!StringSet(&element->name.data, (*entry)->name)) {
-                return false;
-            }
-            if (!StringSet(&element->id.data, (*entry)->id)) {
-                return false;
-            }
-            element->type.data = (*entry)->type;
-            element->visibility.data = (*entry)->visibility;
-            element->expireTime.data = (*entry)->expireTime;
-            element->userId.data = (*entry)->userId;
-            if (!SaveStringVectorToParcel(&(*entry)->managers, &element->managers.data)) {
-                return false;
-            }
-            if (!SaveStringVectorToParcel(&(*entry)->friends, &element->friends.data)) {
-                return false;
-            }
-            if (!SaveInt64VectorToParcel(&(*entry)->sharedUserIdVec, &element->sharedUserIdVec.data)) {
-                return false;
-            }
-        } else {
+    uint32_t fileSize = 0;
+    g_isBackupKept = false;
+    if (!LoadDBFile(MODE_FILE_READ, isV1, &fileSize, journalSeq)) {
+        g_isBackupKept = true;
+        if (!LoadDBFile(MODE_FILE_READ_BACKUP, isV1, &fileSize, journalSeq)) {
             return false;
         }
+        LOGW("[DB]: The database is missing or broken, the previous generation is loaded!");
     }
+    g_snapshotSize = fileSize;
     return true;
 }
 
-static bool SaveDevAuthDb(HCDataBaseV1 *db)
+/* Load the snapshot and the journal, and compact them into a new snapshot if the journal is not empty. */
+static void LoadDatabaseFiles(void)
+{
+    bool isV1 = false;
+    uint32_t journalSeq = 0;
+    if (!LoadDB(&isV1, &journalSeq)) {
+        LOGI("[DB]: Failed to load database, it may be the first time the database is read!");
+    } else {
+        LOGI("[DB]: Load database successfully!");
+    }
+    uint32_t count = ReplayJournal(journalSeq, ReplayJournalRecord);
+    if ((GetJournalSize() == 0) && !isV1) {
+        return;
+    }
+    LOGI("[DB]: Replay %u journal records!", count);
+    /*
+     * start a new journal, so that no record is appended after a broken one, and migrate a version 1 database.
+     * The snapshot takes the sequence number of the last replayed record.
+     */
+    if (!CompactDB()) {
+        LOGE("[DB]: Failed to compact database after loading it!");
+    }
+}
+
+static int32_t CountGroupsByOwner(const char *ownerName)
 {
+    int32_t count = 0;
     uint32_t index;
-    TrustedDeviceEntry *authInfo = NULL;
-    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, authInfo) {
-        TlvDevAuthElement tmp;
-        TlvDevAuthElement *element = db->deviceAuthInfos.data.pushBack(&db->deviceAuthInfos.data, &tmp);
-        if (element != NULL) {
-            TLV_INIT(TlvDevAuthElement, element);
-            if (!StringSet(&element->groupId.data, authInfo->groupEntry->id)) {
-                return false;
-            }
-            if (!StringSet(&element->udid.data, authInfo->udid)) {
-                return false;
-            }
-            if (!StringSet(&element->authId.data, authInfo->authId)) {
-                return false;
-            }
-            if (!StringSet(&element->serviceType.data, authInfo->serviceType)) {
-                return false;
-            }
-            if (!ParcelCopy(&element->ext.data, &authInfo->ext)) {
-                return false;
+    TrustedGroupEntry **entry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
+        if (HC_VECTOR_SIZE(&(*entry)->managers) > 0) {
+            HcString entryOwner = HC_VECTOR_GET(&(*entry)->managers, 0);
+            if (strcmp(StringGet(&entryOwner), ownerName) == 0) {
+                count++;
             }
-            element->info.data.credential = authInfo->credential;
-            element->info.data.devType = authInfo->devType;
-            element->info.data.userId = authInfo->userId;
-            element->info.data.lastTm = authInfo->lastTm;
-        } else {
-            return false;
         }
     }
-    return true;
+    return count;
 }
 
-static bool SaveDBToParcel(HcParcel *parcelOut)
+static int32_t CountDevicesByGroupId(const char *groupId)
 {
-    int ret;
-    HCDataBaseV1 dbv1;
-    TLV_INIT(HCDataBaseV1, &dbv1);
-    dbv1.version.data = 1;
-    do {
-        if (!SaveGroupDb(&dbv1)) {
-            ret = false;
-            break;
-        }
-        if (!SaveDevAuthDb(&dbv1)) {
-            ret = false;
-            break;
-        }
-        if (!EncodeTlvMessage((TlvBase *)&dbv1, parcelOut)) {
-            LOGE("[DB]: Encode Tlv Message failed!");
-            ret = false;
-            break;
+    int32_t count = 0;
+    uint32_t index;
+    TrustedDeviceEntry **deviceEntry = NULL;
+    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, deviceEntry) {
+        if (strcmp(StringGet(&(*deviceEntry)->groupEntry->id), groupId) == 0) {
+            ++count;
         }
-        ret = true;
-    } while (0);
-    TLV_DEINIT(dbv1);
-    return ret;
+    }
+    return count;
 }
 
-static bool SaveDB()
+/*
+ * Called with the write lock held. The group manager checks the limits before it creates a group, but
+ * the workers create groups in parallel, so the check is repeated here before the group is added.
+ */
+static int32_t CheckGroupAddable(const GroupInfo *groupInfo)
 {
-    HcParcel parcel = CreateParcel(0, 0);
-    if (!SaveDBToParcel(&parcel)) {
-        DeleteParcel(&parcel);
-        return false;
+    if (GetGroupEntryById(StringGet(&groupInfo->id)) != NULL) {
+        LOGE("[DB]: The group corresponding to the groupId already exists and cannot be created again!");
+        return HC_ERR_GROUP_DUPLICATE;
     }
-    FileHandle file;
-    int ret = HcFileOpen(FILE_ID_GROUP, MODE_FILE_WRITE, &file);
-    if (ret != 0) {
-        DeleteParcel(&parcel);
-        return false;
+    if (groupInfo->type != PEER_TO_PEER_GROUP) {
+        return HC_SUCCESS;
     }
-    int fileSize = (int)GetParcelDataSize(&parcel);
-    const char *fileData = GetParcelData(&parcel);
-    if (HcFileWrite(file, fileData, fileSize) == fileSize) {
-        ret = true;
-    } else {
-        ret = false;
+    if (CountGroupsByOwner(StringGet(&groupInfo->ownerName)) >= HC_TRUST_GROUP_ENTRY_MAX_NUM) {
+        LOGE("[DB]: The number of groups created by the service exceeds the maximum!");
+        return HC_ERR_BEYOND_LIMIT;
     }
-    DeleteParcel(&parcel);
-    HcFileClose(file);
-    return ret;
+    return HC_SUCCESS;
 }
 
 int32_t AddGroup(const GroupInfo *groupInfo)
@@ -1145,10 +2206,6 @@ int32_t AddGroup(const GroupInfo *groupInfo)
         LOGE("[DB]: The input groupInfo is NULL!");
         return HC_ERR_INVALID_PARAMS;
     }
-    if (IsGroupExistByGroupId(StringGet(&groupInfo->id))) {
-        LOGE("[DB]: The group corresponding to the groupId already exists and cannot be created again!");
-        return HC_ERR_GROUP_DUPLICATE;
-    }
     TrustedGroupEntry *entry = CreateGroupEntryStruct();
     if (entry == NULL) {
         LOGE("[DB]: Failed to allocate groupEntry memory!");
@@ -1160,23 +2217,29 @@ int32_t AddGroup(const GroupInfo *groupInfo)
         HcFree(entry);
         return result;
     }
-    g_databaseMutex->lock(g_databaseMutex);
-    if (g_trustedGroupTable.pushBack(&g_trustedGroupTable, (const TrustedGroupEntry **)&entry) == NULL) {
-        g_databaseMutex->unlock(g_databaseMutex);
-        LOGE("[DB]: Failed to push groupEntry to groupTable!");
+    LockDatabaseWrite();
+    result = CheckGroupAddable(groupInfo);
+    if (result != HC_SUCCESS) {
+        UnlockDatabaseWrite();
+        DestroyGroupEntryStruct(entry);
+        HcFree(entry);
+        return result;
+    }
+    if (!PushGroupEntry(entry)) {
+        UnlockDatabaseWrite();
         DestroyGroupEntryStruct(entry);
         HcFree(entry);
         return HC_ERR_MEMORY_COPY;
     }
-    if (!SaveDB()) {
-        g_databaseMutex->unlock(g_databaseMutex);
+    if (!SaveGroupChange(entry)) {
+        UnlockDatabaseWrite();
         LOGE("[DB]: Failed to save database!");
         return HC_ERR_SAVE_DB_FAILED;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
     if (entry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) {
         NotifyGroupCreated(entry, DEFAULT_USER_ID);
     }
+    UnlockDatabaseWrite();
     LOGI("[DB]: Add a group to database successfully! [GroupType]: %d", groupInfo->type);
     return HC_SUCCESS;
 }
@@ -1190,33 +2253,39 @@ int32_t AddGroupManager(const char *groupId, const char *managerAppId)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             HcString managerStr = CreateString();
             if (!StringSetPointer(&managerStr, managerAppId)) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to copy manager!");
                 DeleteString(&managerStr);
                 return HC_ERR_MEMORY_COPY;
             }
+            if (!PutGroupAcl(managerAppId, *entry)) {
+                UnlockDatabaseWrite();
+                DeleteString(&managerStr);
+                return HC_ERR_ALLOC_MEMORY;
+            }
             if ((*entry)->managers.pushBackT(&(*entry)->managers, managerStr) == NULL) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                RemoveGroupAcl(managerAppId, *entry);
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to push manager to managerVec!");
                 DeleteString(&managerStr);
                 return HC_ERR_MEMORY_COPY;
             }
-            if (!SaveDB()) {
-                g_databaseMutex->unlock(g_databaseMutex);
+            if (!SaveGroupChange(*entry)) {
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to save database!");
                 return HC_ERR_SAVE_DB_FAILED;
             }
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseWrite();
             LOGI("[DB]: Add a manager to the group successfully! [Manager]: %s", managerAppId);
             return HC_SUCCESS;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The group does not exist!");
     return HC_ERR_GROUP_NOT_EXIST;
 }
@@ -1230,32 +2299,39 @@ int32_t AddGroupFriend(const char *groupId, const char *friendAppId)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             HcString friendStr = CreateString();
             if (!StringSetPointer(&friendStr, friendAppId)) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to copy friend!");
                 DeleteString(&friendStr);
                 return HC_ERR_MEMORY_COPY;
             }
+            if (!PutGroupAcl(friendAppId, *entry)) {
+                UnlockDatabaseWrite();
+                DeleteString(&friendStr);
+                return HC_ERR_ALLOC_MEMORY;
+            }
             if ((*entry)->friends.pushBackT(&(*entry)->friends, friendStr) == NULL) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                RemoveGroupAcl(friendAppId, *entry);
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to push friend to friendVec!");
+                DeleteString(&friendStr);
                 return HC_ERR_MEMORY_COPY;
             }
-            if (!SaveDB()) {
-                g_databaseMutex->unlock(g_databaseMutex);
+            if (!SaveGroupChange(*entry)) {
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to save database!");
                 return HC_ERR_SAVE_DB_FAILED;
             }
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseWrite();
             LOGI("[DB]: Add a friend to the group successfully! [Friend]: %s", friendAppId);
             return HC_SUCCESS;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The group does not exist!");
     return HC_SUCCESS;
 }
@@ -1269,7 +2345,7 @@ int32_t RemoveGroupManager(const char *groupId, const char *managerAppId)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             HcString *managerEntry = NULL;
@@ -1279,23 +2355,24 @@ int32_t RemoveGroupManager(const char *groupId, const char *managerAppId)
                     (strcmp(StringGet(managerEntry), managerAppId) == 0)) {
                     HcString tmpManager;
                     HC_VECTOR_POPELEMENT(&((*entry)->managers), &tmpManager, managerIndex);
+                    RemoveGroupAcl(managerAppId, *entry);
                     DeleteString(&tmpManager);
-                    if (!SaveDB()) {
+                    if (!SaveGroupChange(*entry)) {
                         LOGE("[DB]: Failed to save database!");
-                        g_databaseMutex->unlock(g_databaseMutex);
+                        UnlockDatabaseWrite();
                         return HC_ERR_SAVE_DB_FAILED;
                     }
-                    g_databaseMutex->unlock(g_databaseMutex);
+                    UnlockDatabaseWrite();
                     LOGI("[DB]: Delete a manager from the group successfully! [Manager]: %s", managerAppId);
                     return HC_SUCCESS;
                 }
             }
             LOGE("[DB]: The manager does not exist in the group!");
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseWrite();
             return HC_ERR_MANAGER_NOT_EXIST;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The group does not exist!");
     return HC_ERR_GROUP_NOT_EXIST;
 }
@@ -1309,7 +2386,7 @@ int32_t RemoveGroupFriend(const char *groupId, const char *friendAppId)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             HcString *friendEntry = NULL;
@@ -1318,24 +2395,25 @@ int32_t RemoveGroupFriend(const char *groupId, const char *friendAppId)
                 if ((friendEntry != NULL) && (strcmp(StringGet(friendEntry), friendAppId) == 0)) {
                     HcString tmpFriend;
                     HC_VECTOR_POPELEMENT(&((*entry)->friends), &tmpFriend, friendIndex);
+                    RemoveGroupAcl(friendAppId, *entry);
                     DeleteString(&tmpFriend);
-                    if (!SaveDB()) {
+                    if (!SaveGroupChange(*entry)) {
                         LOGE("[DB]: Failed to save database!");
-                        g_databaseMutex->unlock(g_databaseMutex);
+                        UnlockDatabaseWrite();
                         return HC_ERR_SAVE_DB_FAILED;
                     }
-                    g_databaseMutex->unlock(g_databaseMutex);
+                    UnlockDatabaseWrite();
                     LOGI("[DB]: Delete a friend from the group successfully! [Friend]: %s", friendAppId);
                     return HC_SUCCESS;
                 }
             }
             LOGE("[DB]: The friend does not exist in the group!");
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseWrite();
             return HC_ERR_FRIEND_NOT_EXIST;
         }
     }
     LOGE("[DB]: The group does not exist!");
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     return HC_ERR_GROUP_NOT_EXIST;
 }
 
@@ -1347,7 +2425,7 @@ int32_t GetGroupManagers(const char *groupId, CJson *returnManagers)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             HcString *managerEntry = NULL;
@@ -1355,16 +2433,16 @@ int32_t GetGroupManagers(const char *groupId, CJson *returnManagers)
             FOR_EACH_HC_VECTOR((*entry)->managers, managerIndex, managerEntry) {
                 if ((managerEntry != NULL) &&
                     (AddStringToArray(returnManagers, StringGet(managerEntry)) != HC_SUCCESS)) {
-                    g_databaseMutex->unlock(g_databaseMutex);
+                    UnlockDatabaseRead();
                     LOGE("[DB]: Failed to add manager to returnManagers!");
                     return HC_ERR_JSON_FAIL;
                 }
             }
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseRead();
             return HC_SUCCESS;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     LOGE("[DB]: The group does not exist!");
     return HC_ERR_GROUP_NOT_EXIST;
 }
@@ -1377,7 +2455,7 @@ int32_t GetGroupFriends(const char *groupId, CJson *returnFriends)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             HcString *friendEntry = NULL;
@@ -1385,16 +2463,16 @@ int32_t GetGroupFriends(const char *groupId, CJson *returnFriends)
             FOR_EACH_HC_VECTOR((*entry)->friends, friendIndex, friendEntry) {
                 if ((friendEntry != NULL) &&
                     (AddStringToArray(returnFriends, StringGet(friendEntry)) != HC_SUCCESS)) {
-                    g_databaseMutex->unlock(g_databaseMutex);
+                    UnlockDatabaseRead();
                     LOGE("[DB]: Failed to add friend to returnFriends!");
                     return HC_ERR_JSON_FAIL;
                 }
             }
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseRead();
             return HC_SUCCESS;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     LOGE("[DB]: The group does not exist!");
     return HC_ERR_GROUP_NOT_EXIST;
 }
@@ -1407,40 +2485,40 @@ int32_t CompareVisibility(const char *groupId, int groupVisibility)
     }
     TrustedGroupEntry **entry = NULL;
     uint32_t groupIndex;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, groupIndex, entry) {
         if ((entry != NULL) && (*entry != NULL) && (IsGroupIdEquals(*entry, groupId))) {
             if (((uint32_t)((*entry)->visibility) & (uint32_t)groupVisibility) == 0) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return HC_ERROR;
             } else {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return HC_SUCCESS;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     LOGE("[DB]: The group does not exist!");
     return HC_ERR_GROUP_NOT_EXIST;
 }
 
 bool IsTrustedDeviceExist(const char *udid)
 {
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     if (GetTrustedDeviceEntry(udid, NULL) != NULL) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return true;
     } else {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return false;
     }
 }
 
 int32_t GetTrustedDevNumber()
 {
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     int num = GetTrustedDeviceNum();
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return num;
 }
 
@@ -1453,37 +2531,49 @@ int32_t AddTrustedDevice(const DeviceInfo *deviceInfo, const Uint8Buff *ext)
     }
     const char *udid = StringGet(&(deviceInfo->udid));
     bool isTrustedDeviceNumChanged = false;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     if (GetTrustedDeviceEntry(udid, NULL) == NULL) {
         isTrustedDeviceNumChanged = true;
     }
     if (GetTrustedDeviceEntry(udid, StringGet(&deviceInfo->groupId)) == NULL) {
-        TrustedDeviceEntry deviceEntry;
-        if (!InitAuthInfo(deviceInfo, ext, &deviceEntry)) {
-            g_databaseMutex->unlock(g_databaseMutex);
-            DestroyDeviceEntryStruct(&deviceEntry);
+        /* checked again under the lock, as the workers bind devices in parallel */
+        TrustedGroupEntry *groupEntry = GetGroupEntryById(StringGet(&deviceInfo->groupId));
+        if ((groupEntry != NULL) && (groupEntry->type == PEER_TO_PEER_GROUP) &&
+            (CountDevicesByGroupId(StringGet(&deviceInfo->groupId)) >= HC_TRUST_DEV_ENTRY_MAX_NUM)) {
+            UnlockDatabaseWrite();
+            LOGE("[DB]: The number of devices in the group has reached the upper limit!");
+            return HC_ERR_BEYOND_LIMIT;
+        }
+        TrustedDeviceEntry *deviceEntry = (TrustedDeviceEntry *)HcMalloc(sizeof(TrustedDeviceEntry), 0);
+        if (deviceEntry == NULL) {
+            UnlockDatabaseWrite();
+            LOGE("[DB]: Failed to allocate deviceEntry memory!");
+            return HC_ERR_ALLOC_MEMORY;
+        }
+        if (!InitAuthInfo(deviceInfo, ext, deviceEntry)) {
+            UnlockDatabaseWrite();
+            DestroyDeviceEntry(deviceEntry);
             return HC_ERR_MEMORY_COPY;
         }
-        if (g_trustedDeviceTable.pushBack(&g_trustedDeviceTable, &deviceEntry) == NULL) {
-            g_databaseMutex->unlock(g_databaseMutex);
-            LOGE("[DB]: Failed to push deviceEntry to deviceTable!");
-            DestroyDeviceEntryStruct(&deviceEntry);
+        if (!PushDeviceEntry(deviceEntry)) {
+            UnlockDatabaseWrite();
+            DestroyDeviceEntry(deviceEntry);
             return HC_ERR_MEMORY_COPY;
         }
-        if (!SaveDB()) {
-            g_databaseMutex->unlock(g_databaseMutex);
+        if (!SaveDeviceChange(deviceEntry, JOURNAL_PUT_DEVICE)) {
+            UnlockDatabaseWrite();
             LOGE("[DB]: Failed to save database!");
             return HC_ERR_SAVE_DB_FAILED;
         }
         if (isTrustedDeviceNumChanged) {
             NotifyTrustedDeviceNumChanged();
         }
-        NotifyDeviceBound(deviceEntry.groupEntry, udid, DEFAULT_USER_ID);
-        g_databaseMutex->unlock(g_databaseMutex);
+        NotifyDeviceBound(deviceEntry->groupEntry, udid, DEFAULT_USER_ID);
+        UnlockDatabaseWrite();
         LOGI("[DB]: Add a trusted device to database successfully!");
         return HC_SUCCESS;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The device already exists in the group!");
     return HC_ERR_DEVICE_DUPLICATE;
 }
@@ -1496,28 +2586,24 @@ int32_t DelTrustedDevice(const char *udid, const char *groupId)
         return HC_ERR_INVALID_PARAMS;
     }
     uint32_t devIndex;
-    TrustedDeviceEntry *deviceEntry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
-    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, devIndex, deviceEntry) {
-        if ((deviceEntry != NULL) && (deviceEntry->groupEntry != NULL)) {
-            if (((strcmp(StringGet(&deviceEntry->udid), udid) == 0)) &&
-                (CompareGroupIdInDeviceEntryOrNull(deviceEntry, groupId))) {
-                TrustedDeviceEntry tmpDeviceEntry;
-                HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, &tmpDeviceEntry, devIndex);
-                if (!SaveDB()) {
-                    g_databaseMutex->unlock(g_databaseMutex);
-                    LOGE("[DB]: Failed to save database!");
-                    return HC_ERR_SAVE_DB_FAILED;
-                }
-                CheckAndNotifyAfterDelDevice(&tmpDeviceEntry);
-                DestroyDeviceEntryStruct(&tmpDeviceEntry);
-                g_databaseMutex->unlock(g_databaseMutex);
-                LOGI("[DB]: Delete a trusted device from database successfully!");
-                return HC_SUCCESS;
-            }
+    LockDatabaseWrite();
+    TrustedDeviceEntry *deviceEntry = GetTrustedDeviceEntry(udid, groupId);
+    if ((deviceEntry != NULL) && (GetDeviceEntryPosition(deviceEntry, &devIndex))) {
+        TrustedDeviceEntry *tmpDeviceEntry = NULL;
+        PopDeviceEntry(devIndex, &tmpDeviceEntry);
+        if (!SaveDeviceChange(tmpDeviceEntry, JOURNAL_DEL_DEVICE)) {
+            UnlockDatabaseWrite();
+            LOGE("[DB]: Failed to save database!");
+            DestroyDeviceEntry(tmpDeviceEntry);
+            return HC_ERR_SAVE_DB_FAILED;
         }
+        CheckAndNotifyAfterDelDevice(tmpDeviceEntry);
+        DestroyDeviceEntry(tmpDeviceEntry);
+        UnlockDatabaseWrite();
+        LOGI("[DB]: Delete a trusted device from database successfully!");
+        return HC_SUCCESS;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The trusted device is not found!");
     return HC_ERR_DEVICE_NOT_EXIST;
 }
@@ -1530,28 +2616,29 @@ int32_t DelTrustedDeviceByAuthId(const char *authId, const char *groupId)
         return HC_ERR_INVALID_PARAMS;
     }
     uint32_t devIndex;
-    TrustedDeviceEntry *deviceEntry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    TrustedDeviceEntry **deviceEntry = NULL;
+    LockDatabaseWrite();
     FOR_EACH_HC_VECTOR(g_trustedDeviceTable, devIndex, deviceEntry) {
-        if ((deviceEntry != NULL) && (deviceEntry->groupEntry != NULL)) {
-            if (((strcmp(StringGet(&deviceEntry->authId), authId) == 0)) &&
-                (IsGroupIdEquals(deviceEntry->groupEntry, groupId))) {
-                TrustedDeviceEntry tmpDeviceEntry;
-                HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, &tmpDeviceEntry, devIndex);
-                if (!SaveDB()) {
-                    g_databaseMutex->unlock(g_databaseMutex);
+        if ((*deviceEntry)->groupEntry != NULL) {
+            if (((strcmp(StringGet(&(*deviceEntry)->authId), authId) == 0)) &&
+                (IsGroupIdEquals((*deviceEntry)->groupEntry, groupId))) {
+                TrustedDeviceEntry *tmpDeviceEntry = NULL;
+                PopDeviceEntry(devIndex, &tmpDeviceEntry);
+                if (!SaveDeviceChange(tmpDeviceEntry, JOURNAL_DEL_DEVICE)) {
+                    UnlockDatabaseWrite();
                     LOGE("[DB]: Failed to save database!");
+                    DestroyDeviceEntry(tmpDeviceEntry);
                     return HC_ERR_SAVE_DB_FAILED;
                 }
-                CheckAndNotifyAfterDelDevice(&tmpDeviceEntry);
-                DestroyDeviceEntryStruct(&tmpDeviceEntry);
-                g_databaseMutex->unlock(g_databaseMutex);
+                CheckAndNotifyAfterDelDevice(tmpDeviceEntry);
+                DestroyDeviceEntry(tmpDeviceEntry);
+                UnlockDatabaseWrite();
                 LOGI("[DB]: Delete a trusted device from database successfully!");
                 return HC_SUCCESS;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The trusted device is not found!");
     return HC_ERR_DEVICE_NOT_EXIST;
 }
@@ -1559,25 +2646,25 @@ int32_t DelTrustedDeviceByAuthId(const char *authId, const char *groupId)
 static void DeleteUserIdExpiredDeviceEntry(int64_t curUserId)
 {
     uint32_t devIndex = 0;
-    TrustedDeviceEntry *deviceEntry = NULL;
+    TrustedDeviceEntry **deviceEntry = NULL;
     while (devIndex < g_trustedDeviceTable.size(&g_trustedDeviceTable)) {
         deviceEntry = g_trustedDeviceTable.getp(&g_trustedDeviceTable, devIndex);
-        if (deviceEntry == NULL) {
+        if ((deviceEntry == NULL) || (*deviceEntry == NULL)) {
             devIndex++;
             continue;
         }
-        if (deviceEntry->groupEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) {
+        if ((*deviceEntry)->groupEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) {
             devIndex++;
             continue;
         }
-        if (deviceEntry->groupEntry->userId == curUserId) {
+        if ((*deviceEntry)->groupEntry->userId == curUserId) {
             devIndex++;
             continue;
         }
-        TrustedDeviceEntry tmpDeviceEntry;
-        HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, &tmpDeviceEntry, devIndex);
-        CheckAndNotifyAfterDelDevice(&tmpDeviceEntry);
-        DestroyDeviceEntryStruct(&tmpDeviceEntry);
+        TrustedDeviceEntry *tmpDeviceEntry = NULL;
+        PopDeviceEntry(devIndex, &tmpDeviceEntry);
+        CheckAndNotifyAfterDelDevice(tmpDeviceEntry);
+        DestroyDeviceEntry(tmpDeviceEntry);
     }
 }
 
@@ -1600,7 +2687,7 @@ static void DeleteUserIdExpiredGroupEntry(int64_t curUserId)
             continue;
         }
         TrustedGroupEntry *tmpEntry = NULL;
-        HC_VECTOR_POPELEMENT(&g_trustedGroupTable, &tmpEntry, groupIndex);
+        PopGroupEntry(groupIndex, &tmpEntry);
         uint32_t tmpIndex;
         int64_t *sharedUserId = NULL;
         FOR_EACH_HC_VECTOR(tmpEntry->sharedUserIdVec, tmpIndex, sharedUserId) {
@@ -1614,22 +2701,22 @@ static void DeleteUserIdExpiredGroupEntry(int64_t curUserId)
 static void DeleteAccountDeviceEntry()
 {
     uint32_t devIndex = 0;
-    TrustedDeviceEntry *deviceEntry = NULL;
+    TrustedDeviceEntry **deviceEntry = NULL;
     while (devIndex < g_trustedDeviceTable.size(&g_trustedDeviceTable)) {
         deviceEntry = g_trustedDeviceTable.getp(&g_trustedDeviceTable, devIndex);
-        if (deviceEntry == NULL) {
+        if ((deviceEntry == NULL) || (*deviceEntry == NULL)) {
             devIndex++;
             continue;
         }
-        if ((deviceEntry->groupEntry->type != IDENTICAL_ACCOUNT_GROUP) &&
-            (deviceEntry->groupEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP)) {
+        if (((*deviceEntry)->groupEntry->type != IDENTICAL_ACCOUNT_GROUP) &&
+            ((*deviceEntry)->groupEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP)) {
             devIndex++;
             continue;
         }
-        TrustedDeviceEntry tmpDeviceEntry;
-        HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, &tmpDeviceEntry, devIndex);
-        CheckAndNotifyAfterDelDevice(&tmpDeviceEntry);
-        DestroyDeviceEntryStruct(&tmpDeviceEntry);
+        TrustedDeviceEntry *tmpDeviceEntry = NULL;
+        PopDeviceEntry(devIndex, &tmpDeviceEntry);
+        CheckAndNotifyAfterDelDevice(tmpDeviceEntry);
+        DestroyDeviceEntry(tmpDeviceEntry);
     }
 }
 
@@ -1649,7 +2736,7 @@ static void DeleteAccountGroupEntry()
             continue;
         }
         TrustedGroupEntry *tmpEntry = NULL;
-        HC_VECTOR_POPELEMENT(&g_trustedGroupTable, &tmpEntry, groupIndex);
+        PopGroupEntry(groupIndex, &tmpEntry);
         if (tmpEntry->type == IDENTICAL_ACCOUNT_GROUP) {
             NotifyGroupDeleted(tmpEntry, DEFAULT_USER_ID);
         } else {
@@ -1667,21 +2754,21 @@ static void DeleteAccountGroupEntry()
 static void DelDeviceEntryByGroupId(const char *groupId)
 {
     uint32_t devIndex = 0;
-    TrustedDeviceEntry *deviceEntry = NULL;
+    TrustedDeviceEntry **deviceEntry = NULL;
     while (devIndex < g_trustedDeviceTable.size(&g_trustedDeviceTable)) {
         deviceEntry = g_trustedDeviceTable.getp(&g_trustedDeviceTable, devIndex);
-        if (deviceEntry == NULL) {
+        if ((deviceEntry == NULL) || (*deviceEntry == NULL)) {
             devIndex++;
             continue;
         }
-        if (strcmp(StringGet(&deviceEntry->groupEntry->id), groupId) != 0) {
+        if (strcmp(StringGet(&(*deviceEntry)->groupEntry->id), groupId) != 0) {
             devIndex++;
             continue;
         }
-        TrustedDeviceEntry tmpDeviceEntry;
-        HC_VECTOR_POPELEMENT(&g_trustedDeviceTable, &tmpDeviceEntry, devIndex);
-        CheckAndNotifyAfterDelDevice(&tmpDeviceEntry);
-        DestroyDeviceEntryStruct(&tmpDeviceEntry);
+        TrustedDeviceEntry *tmpDeviceEntry = NULL;
+        PopDeviceEntry(devIndex, &tmpDeviceEntry);
+        CheckAndNotifyAfterDelDevice(tmpDeviceEntry);
+        DestroyDeviceEntry(tmpDeviceEntry);
     }
 }
 
@@ -1696,7 +2783,7 @@ static void DelGroupEntryByGroupId(const char *groupId)
             continue;
         }
         TrustedGroupEntry *tmpEntry = NULL;
-        HC_VECTOR_POPELEMENT(&g_trustedGroupTable, &tmpEntry, groupIndex);
+        PopGroupEntry(groupIndex, &tmpEntry);
         if (tmpEntry->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) {
             NotifyGroupDeleted(tmpEntry, DEFAULT_USER_ID);
         } else {
@@ -1717,15 +2804,15 @@ static void DelGroupEntryByGroupId(const char *groupId)
 int32_t DeleteUserIdExpiredGroups(int64_t curUserId)
 {
     LOGI("[DB]: Start to delete all across account groups with expired userId!");
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     DeleteUserIdExpiredDeviceEntry(curUserId);
     DeleteUserIdExpiredGroupEntry(curUserId);
-    if (!SaveDB()) {
-        g_databaseMutex->unlock(g_databaseMutex);
+    if (!SaveBulkChange()) {
+        UnlockDatabaseWrite();
         LOGE("[DB]: Failed to save database!");
         return HC_ERR_SAVE_DB_FAILED;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGI("[DB]: Delete all across account groups with expired userId successfully!");
     return HC_SUCCESS;
 }
@@ -1733,15 +2820,15 @@ int32_t DeleteUserIdExpiredGroups(int64_t curUserId)
 int32_t DeleteAllAccountGroup(void)
 {
     LOGI("[DB]: Start to delete all account-related groups!");
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     DeleteAccountDeviceEntry();
     DeleteAccountGroupEntry();
-    if (!SaveDB()) {
-        g_databaseMutex->unlock(g_databaseMutex);
+    if (!SaveBulkChange()) {
+        UnlockDatabaseWrite();
         LOGE("[DB]: Failed to save database!");
         return HC_ERR_SAVE_DB_FAILED;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGI("[DB]: Delete all account-related groups successfully!");
     return HC_SUCCESS;
 }
@@ -1751,24 +2838,24 @@ int32_t ChangeSharedUserIdVec(Int64Vector *sharedUserIdList)
     LOGI("[DB]: Start to change shared userId list!");
     TrustedGroupEntry **entry = NULL;
     uint32_t index;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if ((entry != NULL) && (*entry != NULL) && ((*entry)->type == ACROSS_ACCOUNT_AUTHORIZE_GROUP)) {
             DeleteExpiredSharedUserId(sharedUserIdList, *entry);
             LOGI("[DB]: Delete expired local userIds successfully!");
             AddNewSharedUserId(sharedUserIdList, *entry);
             LOGI("[DB]: Add new userIds successfully!");
-            if (!SaveDB()) {
-                g_databaseMutex->unlock(g_databaseMutex);
+            if (!SaveGroupChange(*entry)) {
+                UnlockDatabaseWrite();
                 LOGE("[DB]: Failed to save database!");
                 return HC_ERR_SAVE_DB_FAILED;
             }
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseWrite();
             LOGI("[DB]: Change shared userId list successfully!");
             return HC_SUCCESS;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     LOGE("[DB]: The across account group does not exist!");
     return HC_ERR_GROUP_NOT_EXIST;
 }
@@ -1780,15 +2867,15 @@ int32_t DelGroupByGroupId(const char *groupId)
         LOGE("[DB]: The input groupId is NULL!");
         return HC_ERR_INVALID_PARAMS;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseWrite();
     DelDeviceEntryByGroupId(groupId);
     DelGroupEntryByGroupId(groupId);
-    if (!SaveDB()) {
-        g_databaseMutex->unlock(g_databaseMutex);
+    if (!SaveGroupDelete(groupId)) {
+        UnlockDatabaseWrite();
         LOGE("[DB]: Failed to save database!");
         return HC_ERR_SAVE_DB_FAILED;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseWrite();
     return HC_SUCCESS;
 }
 
@@ -1798,12 +2885,12 @@ bool IsTrustedDeviceInGroup(const char *groupId, const char *udid)
         LOGE("[DB]: The input groupId or udid is NULL!");
         return false;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     if (GetTrustedDeviceEntry(udid, groupId) != NULL) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return true;
     } else {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return false;
     }
 }
@@ -1814,16 +2901,74 @@ bool IsTrustedDeviceInGroupByAuthId(const char *groupId, const char *authId)
         LOGE("[DB]: The input groupId or authId is NULL!");
         return false;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     if (GetTrustedDeviceEntryByAuthId(authId, groupId) != NULL) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return true;
     } else {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return false;
     }
 }
 
+uint64_t GetTrustedDeviceLastTm(const char *groupId, const char *udid, const char *authId)
+{
+    if ((groupId == NULL) || ((udid == NULL) && (authId == NULL))) {
+        LOGE("[DB]: The input groupId or device id is NULL!");
+        return 0;
+    }
+    uint64_t lastTm = 0;
+    LockDatabaseRead();
+    TrustedDeviceEntry *entry = (udid != NULL) ? GetTrustedDeviceEntry(udid, groupId) :
+        GetTrustedDeviceEntryByAuthId(authId, groupId);
+    if (entry != NULL) {
+        lastTm = entry->lastTm;
+    }
+    UnlockDatabaseRead();
+    return lastTm;
+}
+
+/* An access soon after the saved one would only cost a journal record, a clock set back is always saved. */
+static bool IsLastTmSaveNeeded(const TrustedDeviceEntry *entry, uint64_t lastTm)
+{
+    return (entry->savedLastTm > lastTm) || (lastTm - entry->savedLastTm >= LAST_TM_SAVE_INTERVAL);
+}
+
+int32_t UpdateTrustedDeviceLastTm(const char *groupId, const char *udid, uint64_t lastTm)
+{
+    if ((groupId == NULL) || (udid == NULL)) {
+        LOGE("[DB]: The input groupId or udid is NULL!");
+        return HC_ERR_INVALID_PARAMS;
+    }
+    LockDatabaseRead();
+    TrustedDeviceEntry *entry = GetTrustedDeviceEntry(udid, groupId);
+    bool isChanged = (entry != NULL) && (entry->lastTm != lastTm);
+    UnlockDatabaseRead();
+    if (!isChanged) {
+        return (entry != NULL) ? HC_SUCCESS : HC_ERR_DEVICE_NOT_EXIST;
+    }
+    LockDatabaseWrite();
+    entry = GetTrustedDeviceEntry(udid, groupId);
+    if (entry == NULL) {
+        UnlockDatabaseWrite();
+        return HC_ERR_DEVICE_NOT_EXIST;
+    }
+    /* the candidate order always follows the latest auth, only the write of the file is throttled */
+    entry->lastTm = lastTm;
+    if (!IsLastTmSaveNeeded(entry, lastTm)) {
+        UnlockDatabaseWrite();
+        return HC_SUCCESS;
+    }
+    if (!SaveDeviceChange(entry, JOURNAL_PUT_DEVICE)) {
+        UnlockDatabaseWrite();
+        LOGE("[DB]: Failed to save database!");
+        return HC_ERR_SAVE_DB_FAILED;
+    }
+    entry->savedLastTm = lastTm;
+    UnlockDatabaseWrite();
+    return HC_SUCCESS;
+}
+
 bool IsGroupExist(const char *ownerName, const char *groupName)
 {
     if ((ownerName == NULL) || (groupName == NULL)) {
@@ -1832,19 +2977,19 @@ bool IsGroupExist(const char *ownerName, const char *groupName)
     }
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if (strcmp(StringGet(&(*entry)->name), groupName) == 0) {
             if (HC_VECTOR_SIZE(&(*entry)->managers) != 0) {
                 HcString entryOwner = HC_VECTOR_GET(&(*entry)->managers, 0);
                 if (strcmp(StringGet(&entryOwner), ownerName) == 0) {
-                    g_databaseMutex->unlock(g_databaseMutex);
+                    UnlockDatabaseRead();
                     return true;
                 }
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return false;
 }
 
@@ -1852,14 +2997,14 @@ bool IsIdenticalGroupExist()
 {
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if ((*entry)->type == IDENTICAL_ACCOUNT_GROUP) {
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseRead();
             return true;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return false;
 }
 
@@ -1867,14 +3012,14 @@ bool IsAcrossAccountGroupExist()
 {
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if ((*entry)->type == ACROSS_ACCOUNT_AUTHORIZE_GROUP) {
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseRead();
             return true;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return false;
 }
 
@@ -1886,14 +3031,14 @@ bool IsGroupExistByGroupId(const char *groupId)
     }
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if (IsGroupIdEquals(*entry, groupId)) {
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseRead();
             return true;
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return false;
 }
 
@@ -1903,37 +3048,37 @@ int32_t GetDeviceInfoForDevAuth(const char *udid, const char *groupId, DeviceInf
         LOGE("[DB]: The input parameters contains NULL value!");
         return HC_ERR_INVALID_PARAMS;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     TrustedDeviceEntry *deviceEntry = GetTrustedDeviceEntry(udid, groupId);
     if (deviceEntry == NULL) {
         LOGE("[DB]: The trusted device is not found!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_DEVICE_NOT_EXIST;
     }
     if (!StringSet(&deviceInfo->authId, deviceEntry->authId)) {
         LOGE("[DB]: Failed to copy authId!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     if (!StringSet(&deviceInfo->udid, deviceEntry->udid)) {
         LOGE("[DB]: Failed to copy authId!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     if (!StringSet(&(deviceInfo->groupId), deviceEntry->groupEntry->id)) {
         LOGE("[DB]: Failed to copy groupId!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     if (!StringSet(&(deviceInfo->serviceType), deviceEntry->serviceType)) {
         LOGE("[DB]: Failed to copy serviceType!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     deviceInfo->credential = deviceEntry->credential;
     deviceInfo->devType = deviceEntry->devType;
     deviceInfo->userId = deviceEntry->userId;
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
@@ -1943,37 +3088,37 @@ int32_t GetDeviceInfoByAuthId(const char *authId, const char *groupId, DeviceInf
         LOGE("[DB]: The input parameters contains NULL value!");
         return HC_ERR_INVALID_PARAMS;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     TrustedDeviceEntry *deviceEntry = GetTrustedDeviceEntryByAuthId(authId, groupId);
     if (deviceEntry == NULL) {
         LOGE("[DB]: The trusted device is not found!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_DEVICE_NOT_EXIST;
     }
     if (!StringSet(&deviceInfo->authId, deviceEntry->authId)) {
         LOGE("[DB]: Failed to copy authId!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     if (!StringSet(&deviceInfo->udid, deviceEntry->udid)) {
         LOGE("[DB]: Failed to copy authId!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     if (!StringSet(&(deviceInfo->groupId), deviceEntry->groupEntry->id)) {
         LOGE("[DB]: Failed to copy groupId!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     if (!StringSet(&(deviceInfo->serviceType), deviceEntry->serviceType)) {
         LOGE("[DB]: Failed to copy serviceType!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return HC_ERR_MEMORY_COPY;
     }
     deviceInfo->credential = deviceEntry->credential;
     deviceInfo->devType = deviceEntry->devType;
     deviceInfo->userId = deviceEntry->userId;
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
@@ -1983,19 +3128,9 @@ int32_t GetGroupNumberByOwner(const char *ownerName)
         LOGE("[DB]: The input ownerName is NULL!");
         return 0;
     }
-    int count = 0;
-    uint32_t index;
-    TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
-    FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
-        if (HC_VECTOR_SIZE(&(*entry)->managers) > 0) {
-            HcString entryOwner = HC_VECTOR_GET(&(*entry)->managers, 0);
-            if (strcmp(StringGet(&entryOwner), ownerName) == 0) {
-                count++;
-            }
-        }
-    }
-    g_databaseMutex->unlock(g_databaseMutex);
+    LockDatabaseRead();
+    int32_t count = CountGroupsByOwner(ownerName);
+    UnlockDatabaseRead();
     return count;
 }
 
@@ -2005,16 +3140,9 @@ int32_t GetCurDeviceNumByGroupId(const char *groupId)
         LOGE("[DB]: The input groupId is NULL!");
         return 0;
     }
-    int count = 0;
-    uint32_t index;
-    TrustedDeviceEntry *deviceEntry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
-    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, deviceEntry) {
-        if (strcmp(StringGet(&deviceEntry->groupEntry->id), groupId) == 0) {
-            ++count;
-        }
-    }
-    g_databaseMutex->unlock(g_databaseMutex);
+    LockDatabaseRead();
+    int32_t count = CountDevicesByGroupId(groupId);
+    UnlockDatabaseRead();
     return count;
 }
 
@@ -2024,9 +3152,9 @@ int32_t GetGroupEntry(const char *groupId, const char *udid, GroupInfo *returnGr
         LOGE("[DB]: The input parameters contains NULL value!");
         return HC_ERR_INVALID_PARAMS;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     int32_t res = GetGroupEntryInner(groupId, udid, returnGroupInfo);
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return res;
 }
 
@@ -2036,9 +3164,9 @@ int32_t GetGroupEntryByGroupId(const char *groupId, GroupInfo *returnGroupInfo)
         LOGE("[DB]: The input groupId or returnGroupInfo is NULL!");
         return HC_ERR_INVALID_PARAMS;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     int32_t res = GetGroupEntryInner(groupId, NULL, returnGroupInfo);
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return res;
 }
 
@@ -2142,7 +3270,7 @@ int32_t GetJoinedGroupInfoVecByDevId(const GroupQueryParams *params, GroupInfoVe
     }
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if ((entry == NULL) || (*entry == NULL)) {
             continue;
@@ -2154,7 +3282,7 @@ int32_t GetJoinedGroupInfoVecByDevId(const GroupQueryParams *params, GroupInfoVe
             deviceEntry = GetTrustedDeviceEntryByAuthId(params->authId, StringGet(&(*entry)->id));
         } else {
             LOGE("[DB]: The values of udid and authId are null!");
-            g_databaseMutex->unlock(g_databaseMutex);
+            UnlockDatabaseRead();
             return HC_ERR_INVALID_PARAMS;
         }
         if ((deviceEntry != NULL) &&
@@ -2162,12 +3290,12 @@ int32_t GetJoinedGroupInfoVecByDevId(const GroupQueryParams *params, GroupInfoVe
             (IsSatisfyUdidAndAuthId(deviceEntry, params))) {
             int32_t result = PushGroupInfoToVec(*entry, vec);
             if (result != HC_SUCCESS) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return result;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
@@ -2177,24 +3305,24 @@ bool IsGroupOwner(const char *groupId, const char *appId)
         LOGE("[DB]: The input parameter contains NULL value!");
         return false;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     TrustedGroupEntry *entry = GetGroupEntryByGroupIdInner(groupId);
     if (entry == NULL) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         LOGE("[DB]: The group cannot be found!");
         return false;
     }
     if (HC_VECTOR_SIZE(&(entry->managers)) == 0) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         LOGE("[DB]: The group does not have manager and owner!");
         return false;
     }
     HcString entryOwner = HC_VECTOR_GET(&(entry->managers), 0);
     if (strcmp(StringGet(&entryOwner), appId) == 0) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return true;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     LOGE("[DB]: The visitor is not the group owner!");
     return false;
 }
@@ -2205,21 +3333,16 @@ bool IsGroupAccessible(const char *groupId, const char *appId)
         LOGE("[DB]: The input groupId or appId is NULL!");
         return false;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     TrustedGroupEntry *entry = GetGroupEntryByGroupIdInner(groupId);
     if (entry == NULL) {
         LOGE("[DB]: The group cannot be found!");
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return false;
     }
-    if ((entry->visibility == GROUP_VISIBILITY_PUBLIC) ||
-        (IsGroupManager(appId, entry)) ||
-        (IsGroupFriend(appId, entry))) {
-        g_databaseMutex->unlock(g_databaseMutex);
-        return true;
-    }
-    g_databaseMutex->unlock(g_databaseMutex);
-    return false;
+    bool isAccessible = IsGroupAccessibleInner(appId, entry);
+    UnlockDatabaseRead();
+    return isAccessible;
 }
 
 bool IsGroupEditAllowed(const char *groupId, const char *appId)
@@ -2228,18 +3351,18 @@ bool IsGroupEditAllowed(const char *groupId, const char *appId)
         LOGE("[DB]: The input groupId or appId is NULL!");
         return false;
     }
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     TrustedGroupEntry *entry = GetGroupEntryByGroupIdInner(groupId);
     if (entry == NULL) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         LOGE("[DB]: The group cannot be found!");
         return false;
     }
     if (IsGroupManager(appId, entry)) {
-        g_databaseMutex->unlock(g_databaseMutex);
+        UnlockDatabaseRead();
         return true;
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return false;
 }
 
@@ -2250,32 +3373,28 @@ int32_t GetLocalDevUdid(char **udid)
     if (res != 0) {
         return res;
     }
-    uint32_t index;
-    TrustedDeviceEntry *entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
-    FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, entry) {
-        if ((entry != NULL) && (entry->groupEntry != NULL) && (CompareUdidInDeviceEntryOrNull(entry,
-            (char *)udidLocal))) {
-            const char *localUdid = StringGet(&entry->udid);
-            *udid = (char *)HcMalloc((uint32_t)(strlen(localUdid) + 1), 0);
-            if ((*udid) == NULL) {
-                g_databaseMutex->unlock(g_databaseMutex);
-                LOGE("[DB]: Failed to allocate udid memory!");
-                return HC_ERR_ALLOC_MEMORY;
-            }
-            if (strcpy_s(*udid, strlen(localUdid) + 1, localUdid) != HC_SUCCESS) {
-                g_databaseMutex->unlock(g_databaseMutex);
-                LOGE("[DB]: Failed to copy localUdid!");
-                HcFree(*udid);
-                *udid = NULL;
-                return HC_ERR_MEMORY_COPY;
-            }
-            g_databaseMutex->unlock(g_databaseMutex);
-            return HC_SUCCESS;
+    LockDatabaseRead();
+    TrustedDeviceEntry *entry = GetTrustedDeviceEntry((const char *)udidLocal, NULL);
+    if ((entry != NULL) && (entry->groupEntry != NULL)) {
+        const char *localUdid = StringGet(&entry->udid);
+        *udid = (char *)HcMalloc((uint32_t)(strlen(localUdid) + 1), 0);
+        if ((*udid) == NULL) {
+            UnlockDatabaseRead();
+            LOGE("[DB]: Failed to allocate udid memory!");
+            return HC_ERR_ALLOC_MEMORY;
         }
+        if (strcpy_s(*udid, strlen(localUdid) + 1, localUdid) != HC_SUCCESS) {
+            UnlockDatabaseRead();
+            LOGE("[DB]: Failed to copy localUdid!");
+            HcFree(*udid);
+            *udid = NULL;
+            return HC_ERR_MEMORY_COPY;
+        }
+        UnlockDatabaseRead();
+        return HC_SUCCESS;
     }
     *udid = NULL;
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
@@ -2320,70 +3439,80 @@ static int32_t PushSearchGroupInfoToVec(const char *groupId, const char *groupNa
     return HC_SUCCESS;
 }
 
-int32_t GetGroupInfo(int groupType, const char *groupId, const char *groupName, const char *groupOwner,
-    GroupInfoVec *groupInfoVec)
+int32_t GetGroupInfo(const char *appId, int groupType, const char *groupId, const char *groupName,
+    const char *groupOwner, GroupInfoVec *groupInfoVec)
 {
-    if (groupInfoVec == NULL) {
-        LOGE("[DB]: The input groupInfoVec is NULL!");
+    if ((appId == NULL) || (groupInfoVec == NULL)) {
+        LOGE("[DB]: The input appId or groupInfoVec is NULL!");
         return HC_ERR_INVALID_PARAMS;
     }
     int32_t result;
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
         if ((entry != NULL) && (*entry != NULL) && (CompareSearchParams(groupType, groupId, groupName,
-            groupOwner, *entry))) {
+            groupOwner, *entry)) && (IsGroupAccessibleInner(appId, *entry))) {
             if (((*entry)->type != ACROSS_ACCOUNT_AUTHORIZE_GROUP) || ((groupId == NULL) && (groupName == NULL))) {
                 result = PushGroupInfoToVec(*entry, groupInfoVec);
             } else {
                 result = PushSearchGroupInfoToVec(groupId, groupName, *entry, groupInfoVec);
             }
             if (result != HC_SUCCESS) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return result;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
-int32_t GetJoinedGroups(int groupType, GroupInfoVec *groupInfoVec)
+int32_t GetJoinedGroups(const char *appId, int groupType, GroupInfoVec *groupInfoVec)
 {
+    if ((appId == NULL) || (groupInfoVec == NULL)) {
+        LOGE("[DB]: The input appId or groupInfoVec is NULL!");
+        return HC_ERR_INVALID_PARAMS;
+    }
     int32_t result;
     uint32_t index;
     TrustedGroupEntry **entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedGroupTable, index, entry) {
-        if ((entry != NULL) && (*entry != NULL) && ((*entry)->type == groupType)) {
+        if ((entry != NULL) && (*entry != NULL) && ((*entry)->type == groupType) &&
+            (IsGroupAccessibleInner(appId, *entry))) {
             result = PushGroupInfoToVec(*entry, groupInfoVec);
             if (result != HC_SUCCESS) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return result;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
-int32_t GetRelatedGroups(const char *peerAuthId, GroupInfoVec *groupInfoVec)
+int32_t GetRelatedGroups(const char *appId, const char *peerAuthId, GroupInfoVec *groupInfoVec)
 {
+    if ((appId == NULL) || (peerAuthId == NULL) || (groupInfoVec == NULL)) {
+        LOGE("[DB]: The input parameters contains NULL value!");
+        return HC_ERR_INVALID_PARAMS;
+    }
     int32_t result;
     uint32_t index;
-    TrustedDeviceEntry *entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    TrustedDeviceEntry **entry = NULL;
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, entry) {
-        if ((entry != NULL) && (strcmp(StringGet(&entry->authId), peerAuthId) == 0)) {
-            result = PushGroupInfoToVec(entry->groupEntry, groupInfoVec);
+        if ((strcmp(StringGet(&(*entry)->authId), peerAuthId) == 0) &&
+            (IsGroupAccessibleInner(appId, (*entry)->groupEntry))) {
+            result = PushGroupInfoToVec((*entry)->groupEntry, groupInfoVec);
             if (result != HC_SUCCESS) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return result;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
@@ -2391,25 +3520,39 @@ int32_t GetTrustedDevices(const char *groupId, DeviceInfoVec *deviceInfoVec)
 {
     int32_t result;
     uint32_t index;
-    TrustedDeviceEntry *entry = NULL;
-    g_databaseMutex->lock(g_databaseMutex);
+    TrustedDeviceEntry **entry = NULL;
+    LockDatabaseRead();
     FOR_EACH_HC_VECTOR(g_trustedDeviceTable, index, entry) {
-        if ((entry != NULL) && (entry->groupEntry != NULL) && (CompareGroupIdInDeviceEntryOrNull(entry, groupId))) {
-            result = PushDevInfoToVec(entry, deviceInfoVec);
+        if (((*entry)->groupEntry != NULL) && (CompareGroupIdInDeviceEntryOrNull(*entry, groupId))) {
+            result = PushDevInfoToVec(*entry, deviceInfoVec);
             if (result != HC_SUCCESS) {
-                g_databaseMutex->unlock(g_databaseMutex);
+                UnlockDatabaseRead();
                 return result;
             }
         }
     }
-    g_databaseMutex->unlock(g_databaseMutex);
+    UnlockDatabaseRead();
     return HC_SUCCESS;
 }
 
+static void SetJournalFilePath(const char *storagePath)
+{
+    char journalPath[DB_FILE_PATH_LEN] = { 0 };
+    if (sprintf_s(journalPath, sizeof(journalPath), "%s%s", storagePath, JOURNAL_FILE_SUFFIX) == -1) {
+        LOGE("[DB]: Failed to generate journal path!");
+        return;
+    }
+    SetFilePath(FILE_ID_GROUP_JOURNAL, journalPath);
+}
+
 int32_t InitDatabase()
 {
     g_trustedGroupTable = CREATE_HC_VECTOR(TrustedGroupTable)
     g_trustedDeviceTable = CREATE_HC_VECTOR(TrustedDeviceTable)
+    g_udidGroupIndex = CreateHashMap(0);
+    g_authIdGroupIndex = CreateHashMap(0);
+    g_udidIndex = CreateHashMap(0);
+    g_groupAclIndex = CreateHashMap(0);
     if (g_databaseMutex == NULL) {
         g_databaseMutex = (HcMutex *)HcMalloc(sizeof(HcMutex), 0);
         if (g_databaseMutex == NULL) {
@@ -2426,25 +3569,127 @@ int32_t InitDatabase()
             g_databaseMutex = NULL;
             return HC_ERROR;
         }
+        if (InitHcCond(&g_transactionCond, g_databaseMutex) != HC_SUCCESS) {
+            LOGE("[DB]: Init transaction condition failed");
+            DESTROY_HC_VECTOR(TrustedDeviceTable, &g_trustedDeviceTable)
+            DESTROY_HC_VECTOR(TrustedGroupTable, &g_trustedGroupTable)
+            DestroyHcMutex(g_databaseMutex);
+            HcFree(g_databaseMutex);
+            g_databaseMutex = NULL;
+            return HC_ERROR;
+        }
+    }
+    if (g_databaseRwLock == NULL) {
+        g_databaseRwLock = (HcRwLock *)HcMalloc(sizeof(HcRwLock), 0);
+        if (g_databaseRwLock == NULL) {
+            LOGE("[DB]: Alloc databaseRwLock failed");
+            DESTROY_HC_VECTOR(TrustedDeviceTable, &g_trustedDeviceTable)
+            DESTROY_HC_VECTOR(TrustedGroupTable, &g_trustedGroupTable)
+            return HC_ERR_ALLOC_MEMORY;
+        }
+        if (InitHcRwLock(g_databaseRwLock) != HC_SUCCESS) {
+            LOGE("[DB]: Init rwlock failed");
+            DESTROY_HC_VECTOR(TrustedDeviceTable, &g_trustedDeviceTable)
+            DESTROY_HC_VECTOR(TrustedGroupTable, &g_trustedGroupTable)
+            HcFree(g_databaseRwLock);
+            g_databaseRwLock = NULL;
+            return HC_ERROR;
+        }
     }
     SetFilePath(FILE_ID_GROUP, GetStoragePath());
-    if (!LoadDB()) {
-        LOGI("[DB]: Failed to load database, it may be the first time the database is read!");
-    } else {
-        LOGI("[DB]: Load database successfully!");
+    SetJournalFilePath(GetStoragePath());
+    LoadDatabaseFiles();
+    return HC_SUCCESS;
+}
+
+int32_t BeginDatabaseTransaction(void)
+{
+    g_databaseMutex->lock(g_databaseMutex);
+    if (IsTransactionOwner()) {
+        g_databaseMutex->unlock(g_databaseMutex);
+        LOGE("[DB]: A transaction is already active!");
+        return HC_ERR_BAD_TIMING;
+    }
+    WaitForOtherTransaction();
+    g_transaction.isActive = true;
+    g_transaction.owner = GetCurrentThreadId();
+    g_transaction.isDirty = false;
+    g_transaction.isDevNumChanged = false;
+    g_transaction.events = CREATE_HC_VECTOR(DbEventVec)
+    g_databaseMutex->unlock(g_databaseMutex);
+    LOGI("[DB]: Begin a database transaction!");
+    return HC_SUCCESS;
+}
+
+int32_t CommitDatabaseTransaction(void)
+{
+    g_databaseMutex->lock(g_databaseMutex);
+    if (!IsTransactionOwner()) {
+        g_databaseMutex->unlock(g_databaseMutex);
+        LOGE("[DB]: The caller has no active transaction!");
+        return HC_ERR_BAD_TIMING;
+    }
+    if (g_transaction.isDirty && !CompactDB()) {
+        /* the transaction stays active, so that the caller can commit again or roll back */
+        g_databaseMutex->unlock(g_databaseMutex);
+        LOGE("[DB]: Failed to save database!");
+        return HC_ERR_SAVE_DB_FAILED;
+    }
+    EndTransaction();
+    DbEventVec events = g_transaction.events;
+    bool isDevNumChanged = g_transaction.isDevNumChanged;
+    int trustedDeviceNum = GetTrustedDeviceNum();
+    g_databaseMutex->unlock(g_databaseMutex);
+    uint32_t index;
+    DbEvent *event = NULL;
+    FOR_EACH_HC_VECTOR(events, index, event) {
+        PostDbEvent(event);
+    }
+    DestroyDbEvents(&events);
+    if (isDevNumChanged && (g_broadcaster != NULL) && (g_broadcaster->postOnTrustedDeviceNumChanged != NULL)) {
+        g_broadcaster->postOnTrustedDeviceNumChanged(trustedDeviceNum);
     }
+    LOGI("[DB]: Commit a database transaction successfully!");
     return HC_SUCCESS;
 }
 
+void RollbackDatabaseTransaction(void)
+{
+    LockDatabaseWrite();
+    if (!IsTransactionOwner()) {
+        UnlockDatabaseWrite();
+        return;
+    }
+    EndTransaction();
+    DestroyDbEvents(&g_transaction.events);
+    if (g_transaction.isDirty) {
+        /* the changes only exist in memory, reload the saved database */
+        ClearDBTables();
+        LoadDatabaseFiles();
+    }
+    UnlockDatabaseWrite();
+    LOGI("[DB]: Roll back a database transaction!");
+}
+
 void DestroyDatabase()
 {
+    if (g_transaction.isActive) {
+        g_transaction.isActive = false;
+        DestroyDbEvents(&g_transaction.events);
+    }
     DestroyTrustDevTable();
     DestroyGroupTable();
     if (g_databaseMutex != NULL) {
+        DestroyHcCond(&g_transactionCond);
         DestroyHcMutex(g_databaseMutex);
         HcFree(g_databaseMutex);
         g_databaseMutex = NULL;
     }
+    if (g_databaseRwLock != NULL) {
+        DestroyHcRwLock(g_databaseRwLock);
+        HcFree(g_databaseRwLock);
+        g_databaseRwLock = NULL;
+    }
 }
 
 void RegGenerateGroupIdFunc(int32_t (*generateGroupId)(int64_t userId, int64_t sharedUserId, char **returnGroupId))
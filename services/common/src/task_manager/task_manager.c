@@ -16,56 +16,107 @@
 #include "task_manager.h"
 
 #include "device_auth_defines.h"
+#include "hc_error.h"
 #include "hc_log.h"
+#include "hc_mem_arena.h"
+#include "securec.h"
 
 #define STACK_SIZE 4096
+/* a chunk holds all the memory of a few messages of a bind */
+#define TASK_ARENA_CHUNK_SIZE (32 * 1024)
+#define THREAD_NAME_LEN 16
 
-static HcTaskThread *g_taskThread = NULL;
+static HcTaskThread *g_taskThreads = NULL;
 
-int32_t PushTask(HcTaskBase *baseTask)
+/*
+ * All the tasks of a request are pushed to the same worker, so they still run in order,
+ * while the tasks of different requests run in parallel on different workers.
+ */
+static uint32_t GetWorkerIndex(int64_t requestId)
 {
-    if (g_taskThread == NULL) {
+    uint64_t hash = (uint64_t)requestId;
+    hash ^= hash >> 33; /* 33: mix the high bits into the low bits */
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33; /* 33: mix the high bits into the low bits */
+    return (uint32_t)(hash % TASK_WORKER_NUM);
+}
+
+int32_t PushTask(int64_t requestId, HcTaskBase *baseTask)
+{
+    if (g_taskThreads == NULL) {
         LOGE("Task thread is NULL!");
         return HC_ERR_NULL_PTR;
     }
-    g_taskThread->pushTask(g_taskThread, baseTask);
-    return HC_SUCCESS;
+    HcTaskThread *thread = &g_taskThreads[GetWorkerIndex(requestId)];
+    int32_t res = thread->pushTask(thread, baseTask);
+    if (res == HAL_ERR_QUEUE_FULL) {
+        LOGW("The task queue is full, the caller should retry later!");
+        return HC_ERR_TASK_QUEUE_FULL;
+    }
+    return (res == HAL_SUCCESS) ? HC_SUCCESS : HC_ERR_INIT_TASK_FAIL;
 }
 
-int32_t InitTaskManager(void)
+static void DestroyTaskThreads(uint32_t count)
 {
-    if (g_taskThread != NULL) {
-        LOGD("Task thread is running!");
-        return HC_SUCCESS;
+    for (uint32_t i = 0; i < count; i++) {
+        g_taskThreads[i].stopAndClear(&g_taskThreads[i]);
+        DestroyHcTaskThread(&g_taskThreads[i]);
     }
-    g_taskThread = (HcTaskThread *)HcMalloc(sizeof(HcTaskThread), 0);
-    if (g_taskThread == NULL) {
-        return HC_ERR_ALLOC_MEMORY;
+    HcFree(g_taskThreads);
+    g_taskThreads = NULL;
+}
+
+static int32_t StartTaskThread(HcTaskThread *thread, uint32_t index)
+{
+    char threadName[THREAD_NAME_LEN] = "HichainThread";
+    if ((index > 0) && (sprintf_s(threadName, sizeof(threadName), "HichainThread%u", index) <= 0)) {
+        return HC_ERR_INIT_FAILED;
     }
-    int32_t res = InitHcTaskThread(g_taskThread, STACK_SIZE, "HichainThread");
+    int32_t res = InitHcTaskThread(thread, STACK_SIZE, TASK_QUEUE_CAPACITY, threadName);
     if (res != HC_SUCCESS) {
         LOGE("Failed to init task thread! res: %d", res);
-        HcFree(g_taskThread);
-        g_taskThread = NULL;
         return HC_ERR_INIT_FAILED;
     }
-    res = g_taskThread->startThread(g_taskThread);
+    thread->useMemArena = HC_TRUE;
+    res = thread->startThread(thread);
     if (res != HC_SUCCESS) {
-        DestroyHcTaskThread(g_taskThread);
-        HcFree(g_taskThread);
-        g_taskThread = NULL;
+        DestroyHcTaskThread(thread);
         LOGE("Failed to start thread! res: %d", res);
         return HC_ERR_INIT_FAILED;
     }
     return HC_SUCCESS;
 }
 
+int32_t InitTaskManager(void)
+{
+    if (g_taskThreads != NULL) {
+        LOGD("Task thread is running!");
+        return HC_SUCCESS;
+    }
+    g_taskThreads = (HcTaskThread *)HcMalloc(sizeof(HcTaskThread) * TASK_WORKER_NUM, 0);
+    if (g_taskThreads == NULL) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    if ((TASK_ARENA_CHUNK_NUM > 0) && (InitMemArena(TASK_ARENA_CHUNK_SIZE, TASK_ARENA_CHUNK_NUM) != HAL_SUCCESS)) {
+        /* the tasks still work with the memory of the heap */
+        LOGW("Failed to init the memory arena, the tasks run without it.");
+    }
+    for (uint32_t i = 0; i < TASK_WORKER_NUM; i++) {
+        int32_t res = StartTaskThread(&g_taskThreads[i], i);
+        if (res != HC_SUCCESS) {
+            DestroyTaskThreads(i);
+            DestroyMemArena();
+            return res;
+        }
+    }
+    LOGI("Start %d task threads successfully!", TASK_WORKER_NUM);
+    return HC_SUCCESS;
+}
+
 void DestroyTaskManager(void)
 {
-    if (g_taskThread != NULL) {
-        g_taskThread->stopAndClear(g_taskThread);
-        DestroyHcTaskThread(g_taskThread);
-        HcFree(g_taskThread);
-        g_taskThread = NULL;
+    if (g_taskThreads != NULL) {
+        DestroyTaskThreads(TASK_WORKER_NUM);
+        DestroyMemArena();
     }
-}
\ No newline at end of file
+}
@@ -23,8 +23,10 @@
 #include "device_auth_defines.h"
 #include "group_auth_manager.h"
 #include "group_manager.h"
+#include "hc_crypto_pool.h"
 #include "hc_init_protection.h"
 #include "hc_log.h"
+#include "json_binary.h"
 #include "json_utils.h"
 #include "securec.h"
 #include "session_manager.h"
@@ -242,6 +244,16 @@ static bool InitProcessDataTask(AuthDeviceTask *task, int64_t authReqId, CJson *
     return true;
 }
 
+/* The callback is not needed, the session of the request already has it. */
+static void InitResumeAuthTask(AuthDeviceTask *task, int64_t authReqId, CJson *resumeMsg)
+{
+    task->base.doAction = DoResumeAuthData;
+    task->base.destroy = DestroyGroupAuthTask;
+    task->authReqId = authReqId;
+    task->authParams = resumeMsg;
+    task->callback = NULL;
+}
+
 static void InitProcessBindDataTask(GroupManagerTask *task, int64_t requestId, CJson *jsonParams)
 {
     task->base.doAction = DoProcessBindData;
@@ -319,10 +331,11 @@ static int32_t AuthDevice(int64_t authReqId, const char *authParams, const Devic
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(authReqId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("Push AuthDevice task successfully.");
     return HC_SUCCESS;
@@ -336,7 +349,7 @@ static int32_t ProcessData(int64_t authReqId, const uint8_t *data, uint32_t data
         LOGE("Invalid input for ProcessData!");
         return HC_ERR_INVALID_PARAMS;
     }
-    CJson *receivedData = CreateJsonFromString((const char *)data);
+    CJson *receivedData = CreateJsonFromData(data, dataLen);
     if (receivedData == NULL) {
         LOGE("Create Json for input data failed!");
         return HC_ERR_JSON_FAIL;
@@ -353,15 +366,41 @@ static int32_t ProcessData(int64_t authReqId, const uint8_t *data, uint32_t data
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(authReqId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(receivedData);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("Push ProcessData task successfully.");
     return HC_SUCCESS;
 }
 
+/*
+ * Called on a crypto worker once the operations of a pending step of an auth task end.
+ * Nothing else would wake the session up, so it fails at once if the resume task can't be queued.
+ */
+static int32_t ResumeAuthTask(int64_t requestId, CJson *msg)
+{
+    AuthDeviceTask *task = (AuthDeviceTask *)HcMalloc(sizeof(AuthDeviceTask), 0);
+    if (task == NULL) {
+        FreeJson(msg);
+        LOGE("Failed to allocate memory for task!");
+        AbortSession(requestId, HC_ERR_ALLOC_MEMORY);
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    InitResumeAuthTask(task, requestId, msg);
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
+        LOGE("Failed to push the resume task, res: %d.", pushRes);
+        FreeJson(msg);
+        HcFree(task);
+        AbortSession(requestId, pushRes);
+        return pushRes;
+    }
+    return HC_SUCCESS;
+}
+
 static int GetOperationCodeWhenAdd(CJson *jsonParams)
 {
     bool isAdmin = true;
@@ -480,10 +519,11 @@ static int32_t RequestCreateGroup(int64_t requestId, const char *appId, const ch
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonCreateParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the creating group task successfully! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
     return HC_SUCCESS;
@@ -518,10 +558,11 @@ static int32_t RequestDeleteGroup(int64_t requestId, const char *appId, const ch
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonDisBandParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the deleting group task successfully! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
     return HC_SUCCESS;
@@ -556,10 +597,11 @@ static int32_t RequestAddMemberToGroup(int64_t requestId, const char *appId, con
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonAddParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the adding member task successfully! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
     return HC_SUCCESS;
@@ -594,27 +636,19 @@ static int32_t RequestDeleteMemberFromGroup(int64_t requestId, const char *appId
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonDeleteParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the deleting member task successfully! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
     return HC_SUCCESS;
 }
 
-static int32_t RequestProcessBindData(int64_t requestId, const uint8_t *data, uint32_t dataLen)
+/* Takes the ownership of dataJson, it is freed if the task cannot be created. */
+static int32_t ProcessBindDataJson(int64_t requestId, CJson *dataJson)
 {
-    if ((data == NULL) || (dataLen == 0) || (dataLen > MAX_DATA_BUFFER_SIZE)) {
-        LOGE("The input data is invalid!");
-        return HC_ERR_INVALID_PARAMS;
-    }
-    LOGI("[Start]: RequestProcessBindData! [RequestId]: %" PRId64, requestId);
-    CJson *dataJson = CreateJsonFromString((const char *)data);
-    if (dataJson == NULL) {
-        LOGE("Failed to create json from string!");
-        return HC_ERR_JSON_FAIL;
-    }
     int64_t tempRequestId = DEFAULT_REQUEST_ID;
     if (GetInt64FromJson(dataJson, FIELD_REQUEST_ID, &tempRequestId) != HC_SUCCESS) {
         LOGE("Failed to get requestId from json!");
@@ -634,15 +668,37 @@ static int32_t RequestProcessBindData(int64_t requestId, const uint8_t *data, ui
         return HC_ERR_ALLOC_MEMORY;
     }
     InitProcessBindDataTask(task, requestId, dataJson);
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(dataJson);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the processing data task successfully! [RequestId]: %" PRId64, requestId);
     return HC_SUCCESS;
 }
 
+static int32_t RequestProcessBindData(int64_t requestId, const uint8_t *data, uint32_t dataLen)
+{
+    if ((data == NULL) || (dataLen == 0) || (dataLen > MAX_DATA_BUFFER_SIZE)) {
+        LOGE("The input data is invalid!");
+        return HC_ERR_INVALID_PARAMS;
+    }
+    LOGI("[Start]: RequestProcessBindData! [RequestId]: %" PRId64, requestId);
+    CJson *dataJson = CreateJsonFromData(data, dataLen);
+    if (dataJson == NULL) {
+        LOGE("Failed to create json from data!");
+        return HC_ERR_JSON_FAIL;
+    }
+    return ProcessBindDataJson(requestId, dataJson);
+}
+
+static int32_t ProcessChannelMsg(int64_t requestId, CJson *msg)
+{
+    LOGI("[Start]: ProcessChannelMsg! [RequestId]: %" PRId64, requestId);
+    return ProcessBindDataJson(requestId, msg);
+}
+
 static int32_t ConfirmRequest(int64_t requestId, const char *appId, const char *confirmParams)
 {
     if ((appId == NULL) || (confirmParams == NULL)) {
@@ -672,10 +728,11 @@ static int32_t ConfirmRequest(int64_t requestId, const char *appId, const char *
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonConfirmParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the confirming request task successfully! [AppId]: %s, [RequestId]: %" PRId64,
         appId, requestId);
@@ -913,9 +970,9 @@ static int32_t RequestProcessLiteData(int64_t requestId, const char *appId, cons
         return HC_ERR_INVALID_PARAMS;
     }
     LOGI("[Start]: RequestProcessLiteData! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
-    CJson *receivedData = CreateJsonFromString((const char *)data);
+    CJson *receivedData = CreateJsonFromData(data, dataLen);
     if (receivedData == NULL) {
-        LOGE("Failed to create received json object from string!");
+        LOGE("Failed to create received json object from data!");
         return HC_ERR_JSON_FAIL;
     }
     if (AddLiteDataToReceivedData(receivedData, requestId, appId) != HC_SUCCESS) {
@@ -934,10 +991,11 @@ static int32_t RequestProcessLiteData(int64_t requestId, const char *appId, cons
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(receivedData);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the processing lite data task successfully! [AppId]: %s, [RequestId]: %" PRId64,
         appId, requestId);
@@ -973,10 +1031,11 @@ static int32_t RequestBindPeer(int64_t requestId, const char *appId, const char
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonBindParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the binding peer device task successfully! [AppId]: %s, [RequestId]: %" PRId64,
         appId, requestId);
@@ -1012,10 +1071,11 @@ static int32_t RequestUnbindPeer(int64_t requestId, const char *appId, const cha
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonUnbindParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the unbinding peer device task successfully! [AppId]: %s, [RequestId]: %" PRId64,
         appId, requestId);
@@ -1051,10 +1111,11 @@ static int32_t RequestAuthKeyAgree(int64_t requestId, const char *appId, const c
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(jsonAgreeParams);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the key agreement task successfully! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
     return HC_SUCCESS;
@@ -1067,9 +1128,9 @@ static int32_t RequestProcessKeyAgreeData(int64_t requestId, const char *appId,
         return HC_ERR_INVALID_PARAMS;
     }
     LOGI("[Start]: RequestProcessKeyAgreeData! [AppId]: %s, [RequestId]: %" PRId64, appId, requestId);
-    CJson *receivedData = CreateJsonFromString((const char *)data);
+    CJson *receivedData = CreateJsonFromData(data, dataLen);
     if (receivedData == NULL) {
-        LOGE("Failed to create received json object from string!");
+        LOGE("Failed to create received json object from data!");
         return HC_ERR_JSON_FAIL;
     }
     if (AddServerParamsToJson(false, requestId, appId, receivedData) != HC_SUCCESS) {
@@ -1088,10 +1149,11 @@ static int32_t RequestProcessKeyAgreeData(int64_t requestId, const char *appId,
         HcFree(task);
         return HC_ERR_INIT_TASK_FAIL;
     }
-    if (PushTask((HcTaskBase*)task) != HC_SUCCESS) {
+    int32_t pushRes = PushTask(requestId, (HcTaskBase*)task);
+    if (pushRes != HC_SUCCESS) {
         FreeJson(receivedData);
         HcFree(task);
-        return HC_ERR_INIT_TASK_FAIL;
+        return pushRes;
     }
     LOGI("[End]: Create the processing key agreement data task successfully! [AppId]: %s, [RequestId]: %" PRId64, appId,
         requestId);
@@ -1494,21 +1556,33 @@ DEVICE_AUTH_API_PUBLIC int InitDeviceAuthService()
         LOGE("[End]: [Service]: Failed to init all authenticator modules!");
         goto free_gm_ga;
     }
+    /* registered before the channels are opened by the group manager */
+    SetChannelMsgHandler(ProcessChannelMsg);
+    SetTaskResumeHandler(ResumeAuthTask);
     res = InitGroupManager();
     if (res != HC_SUCCESS) {
         goto free_module;
     }
-    InitSessionManager();
+    res = InitSessionManager();
+    if (res != HC_SUCCESS) {
+        LOGE("[End]: [Service]: Failed to init session manager!");
+        goto free_group_manager;
+    }
     res = InitTaskManager();
     if (res != HC_SUCCESS) {
         LOGE("[End]: [Service]: Failed to init worker thread!");
         goto free_all;
     }
+    /* without the pool, the tasks run their crypto operations themselves */
+    if (InitCryptoPool(CRYPTO_WORKER_NUM) != HAL_SUCCESS) {
+        LOGW("[Service]: Failed to init the crypto workers!");
+    }
     SetInitStatus();
     LOGI("[End]: [Service]: Init device auth service successfully!");
     return res;
 free_all:
     DestroySessionManager();
+free_group_manager:
     DestroyGroupManager();
 free_module:
     DestroyModules();
@@ -1526,6 +1600,8 @@ DEVICE_AUTH_API_PUBLIC void DestroyDeviceAuthService()
         LOGI("[End]: [Service]: The service has not been initialized, so it does not need to be destroyed!");
         return;
     }
+    /* before the task workers, which the crypto workers push the resume tasks to */
+    DestroyCryptoPool();
     DestroyTaskManager();
     DestroyChannelManager();
     DestroySessionManager();
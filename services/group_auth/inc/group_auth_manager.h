@@ -24,5 +24,6 @@ bool IsTrustedDevice(const char *udid);
 int32_t QueryTrustedDeviceNum(void);
 void DoAuthDevice(HcTaskBase *task);
 void DoProcessData(HcTaskBase *task);
+void DoResumeAuthData(HcTaskBase *task);
 
 #endif
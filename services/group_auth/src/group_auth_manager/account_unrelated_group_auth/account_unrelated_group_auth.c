@@ -16,6 +16,8 @@
 #include "account_unrelated_group_auth.h"
 #include "auth_session_common.h"
 #include "auth_session_common_util.h"
+#include "auth_session_resume.h"
+#include "channel_manager.h"
 #include "common_defs.h"
 #include "device_auth_defines.h"
 #include "hc_log.h"
@@ -157,18 +159,12 @@ static int32_t DasOnFinishToPeer(int64_t requestId, const CJson *out, const Devi
         LOGI("No need to transmit data to peer.");
         return res;
     }
-    char *sendToPeerStr = PackJsonToString(sendToPeer);
-    if (sendToPeerStr == NULL) {
-        LOGE("Failed to pack sendToPeerStr for onTransmit!");
-        return HC_ERR_ALLOC_MEMORY;
-    }
-    if ((callback != NULL) && (callback->onTransmit != NULL)) {
-        if (!callback->onTransmit(requestId, (uint8_t *)sendToPeerStr, (uint32_t)strlen(sendToPeerStr) + 1)) {
-            LOGE("Failed to transmit data to peer!");
-            res = HC_ERR_TRANSMIT_FAIL;
-        }
+    bool isBinaryWire = false;
+    (void)GetBoolFromJson(out, FIELD_IS_BINARY_WIRE, &isBinaryWire);
+    res = HcSendJsonMsg(SERVICE_CHANNEL, requestId, DEFAULT_CHANNEL_ID, callback, sendToPeer, isBinaryWire);
+    if (res != HC_SUCCESS) {
+        LOGE("Failed to transmit data to peer!");
     }
-    FreeJsonString(sendToPeerStr);
     return res;
 }
 
@@ -409,6 +405,14 @@ static int32_t CombineDasServerConfirmParams(const CJson *confirmationJson, CJso
             return HC_ERR_JSON_FAIL;
         }
     }
+    bool isClientResumable = false;
+    bool isServerResumable = false;
+    (void)GetBoolFromJson(dataFromClient, FIELD_IS_RESUMABLE, &isClientResumable);
+    (void)GetBoolFromJson(confirmationJson, FIELD_IS_RESUMABLE, &isServerResumable);
+    if (AddBoolToJson(dataFromClient, FIELD_IS_RESUMABLE, isClientResumable && isServerResumable) != HC_SUCCESS) {
+        LOGE("Failed to combine server param for isResumable!");
+        return HC_ERR_JSON_FAIL;
+    }
     return HC_SUCCESS;
 }
 
@@ -434,6 +438,7 @@ static void OnDasFinish(int64_t requestId, const CJson *authParam, const CJson *
         LOGE("Failed to return session key when auth finished!");
         return;
     }
+    SaveAuthResumeSecret(authParam, out);
     if (DasOnFinishToSelf(requestId, authParam, out, callback) != HC_SUCCESS) {
         LOGE("Failed to send data to self when auth finished!");
         return;
@@ -14,6 +14,8 @@
  */
 
 #include "group_auth_manager.h"
+#include "auth_session_resume.h"
+#include "auth_session_server.h"
 #include "database_manager.h"
 #include "device_auth_defines.h"
 #include "hc_log.h"
@@ -86,9 +88,36 @@ void DoProcessData(HcTaskBase *task)
         }
         return;
     }
+    if (IsAuthResumeMsg(realTask->authParams)) {
+        /* a response whose client session has ended is dropped, answering it would bounce errors forever */
+        if (IsAuthResumeRequest(realTask->authParams)) {
+            ProcessServerAuthResumeMsg(realTask->authParams, realTask->callback);
+        } else {
+            LOGI("The client session of the resume message has ended.");
+        }
+        return;
+    }
     int32_t result = CreateSession(realTask->authReqId, TYPE_SERVER_AUTH_SESSION, realTask->authParams,
         realTask->callback);
     if (result != HC_SUCCESS) {
         LOGE("Failed to create session for process auth data!");
     }
 }
+
+void DoResumeAuthData(HcTaskBase *task)
+{
+    if (task == NULL) {
+        LOGE("The input task is NULL, can't resume auth!");
+        return;
+    }
+    AuthDeviceTask *realTask = (AuthDeviceTask *)task;
+    /* the session may have ended while the crypto workers ran, it is never created again */
+    if (!IsRequestExist(realTask->authReqId)) {
+        LOGI("The session to resume has ended.");
+        return;
+    }
+    int ret = ProcessSession(realTask->authReqId, AUTH_TYPE, realTask->authParams);
+    if (ret != HC_SUCCESS) {
+        DestroySession(realTask->authReqId);
+    }
+}
@@ -89,4 +89,21 @@ void DoProcessData(HcTaskBase *task)
             realTask->callback->onError(realTask->authReqId, AUTH_FORM_INVALID_TYPE, result, NULL);
         }
     }
+}
+
+void DoResumeAuthData(HcTaskBase *task)
+{
+    if (task == NULL) {
+        LOGE("The input task is NULL, can't resume lite-auth!");
+        return;
+    }
+    AuthDeviceTask *realTask = (AuthDeviceTask *)task;
+    if (!IsRequestExist(realTask->authReqId)) {
+        LOGI("The lite auth session to resume has ended.");
+        return;
+    }
+    int ret = ProcessSession(realTask->authReqId, AUTH_TYPE, realTask->authParams);
+    if (ret != HC_SUCCESS) {
+        DestroySession(realTask->authReqId);
+    }
 }
\ No newline at end of file
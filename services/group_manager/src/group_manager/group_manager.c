@@ -212,27 +212,6 @@ static int32_t GenerateReturnDevInfo(const DeviceInfo *devEntry, CJson *returnJs
     return HC_SUCCESS;
 }
 
-static void RemoveNoPermissionGroup(GroupInfoVec *groupEntryVec, const char *appId)
-{
-    uint32_t index = 0;
-    void **groupEntryPtr = NULL;
-    while (index < groupEntryVec->size(groupEntryVec)) {
-        groupEntryPtr = groupEntryVec->getp(groupEntryVec, index);
-        if ((groupEntryPtr == NULL) || (*groupEntryPtr == NULL)) {
-            index++;
-            continue;
-        }
-        GroupInfo *groupEntry = (GroupInfo *)(*groupEntryPtr);
-        if (IsGroupAccessible(StringGet(&groupEntry->id), appId)) {
-            index++;
-            continue;
-        }
-        void *tempEntry = NULL;
-        HC_VECTOR_POPELEMENT(groupEntryVec, &tempEntry, index);
-        LOGI("Pop a no permission group from vector!");
-    }
-}
-
 static int32_t GenerateReturnEmptyArrayStr(char **returnVec)
 {
     CJson *json = CreateJsonArray();
@@ -679,13 +658,12 @@ static int32_t GetAccessibleGroupInfo(const char *appId, const char *queryParams
     }
     GroupInfoVec groupInfoVec;
     CreateGroupInfoVecStruct(&groupInfoVec);
-    int32_t result = GetGroupInfo(groupType, groupId, groupName, groupOwner, &groupInfoVec);
+    int32_t result = GetGroupInfo(appId, groupType, groupId, groupName, groupOwner, &groupInfoVec);
     FreeJson(queryParamsJson);
     if (result != HC_SUCCESS) {
         DestroyGroupInfoVecStruct(&groupInfoVec);
         return result;
     }
-    RemoveNoPermissionGroup(&groupInfoVec, appId);
     result = GenerateReturnGroupVec(&groupInfoVec, returnGroupVec, groupNum);
     DestroyGroupInfoVecStruct(&groupInfoVec);
     return result;
@@ -703,12 +681,11 @@ static int32_t GetAccessibleJoinedGroups(const char *appId, int groupType, char
     }
     GroupInfoVec groupInfoVec;
     CreateGroupInfoVecStruct(&groupInfoVec);
-    int32_t result = GetJoinedGroups(groupType, &groupInfoVec);
+    int32_t result = GetJoinedGroups(appId, groupType, &groupInfoVec);
     if (result != HC_SUCCESS) {
         DestroyGroupInfoVecStruct(&groupInfoVec);
         return result;
     }
-    RemoveNoPermissionGroup(&groupInfoVec, appId);
     result = GenerateReturnGroupVec(&groupInfoVec, returnGroupVec, groupNum);
     DestroyGroupInfoVecStruct(&groupInfoVec);
     return result;
@@ -724,12 +701,11 @@ static int32_t GetAccessibleRelatedGroups(const char *appId, const char *peerDev
     LOGI("Start to get related groups! [AppId]: %s", appId);
     GroupInfoVec groupInfoVec;
     CreateGroupInfoVecStruct(&groupInfoVec);
-    int32_t result = GetRelatedGroups(peerDeviceId, &groupInfoVec);
+    int32_t result = GetRelatedGroups(appId, peerDeviceId, &groupInfoVec);
     if (result != HC_SUCCESS) {
         DestroyGroupInfoVecStruct(&groupInfoVec);
         return result;
     }
-    RemoveNoPermissionGroup(&groupInfoVec, appId);
     result = GenerateReturnGroupVec(&groupInfoVec, returnGroupVec, groupNum);
     DestroyGroupInfoVecStruct(&groupInfoVec);
     return result;
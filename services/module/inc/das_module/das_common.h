@@ -21,6 +21,9 @@
 #include "hc_types.h"
 #include "json_utils.h"
 
+/* The aliases are cached after the module is created, GenerateKeyAlias works without the cache as well. */
+int32_t InitKeyAliasCache(void);
+void DestroyKeyAliasCache(void);
 int32_t GenerateKeyAlias(const Uint8Buff *pkgName, const Uint8Buff *serviceType, const KeyAliasType keyType,
     const Uint8Buff *authId, Uint8Buff *outKeyAlias);
 int32_t GetIdPeerForParams(const CJson *in, const char *peerIdKey, const Uint8Buff *authIdSelf, Uint8Buff *authIdPeer);
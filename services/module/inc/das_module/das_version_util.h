@@ -24,6 +24,9 @@ typedef enum {
     VERSION_DECIDED,
 } VersionAgreementStatus;
 
+/* Not an algorithm, the messages are sent in the binary form if both peers keep it in the negotiated version. */
+#define BINARY_WIRE_CAPABILITY 0x0100
+
 typedef struct VersionInfoT {
     int opCode;
     VersionAgreementStatus versionStatus;
@@ -41,5 +44,6 @@ int32_t NegotiateVersion(VersionStruct *minVersionPeer, VersionStruct *curVersio
 ProtocolType GetPrototolType(VersionStruct *curVersion, OperationCode opCode);
 
 AlgType GetSupportedPakeAlg(VersionStruct *curVersion);
+bool IsSupportedBinaryWire(const VersionStruct *curVersion);
 
 #endif
\ No newline at end of file
@@ -34,6 +34,11 @@ typedef struct PakeParamsT {
     int32_t userTypePeer;
     char *packageName;
     char *serviceType;
+    int64_t requestId;
+    bool isResumable; /* the auth also derives the resumption secret, which is never returned to the caller */
+    bool isAsyncCrypto; /* the session resumes the task, so the steps may wait for the crypto pool */
+    int32_t resumeId; /* of the pending step, 0 if no step is pending */
+    CJson *resumeMsg; /* passed to the resume handler when the operations of the pending step end */
 } PakeParams;
 
 typedef struct AsyBaseCurTaskT {
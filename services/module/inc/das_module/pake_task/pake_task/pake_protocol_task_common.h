@@ -17,9 +17,27 @@
 #define PAKE_PROTOCOL_TASK_COMMOM_H
 
 #include "pake_base_cur_task.h"
+#include "pake_protocol_common.h"
 #include "json_utils.h"
 
 int32_t InitDasPakeParams(PakeParams *params, const CJson *in);
 void DestroyDasPakeParams(PakeParams *params);
 
+/*
+ * Run a step, its asymmetric operations go to the crypto pool if the session resumes the task.
+ * If they still run at the return, *isPending is set and the task returns ASYNC_PENDING. Once they end,
+ * a copy of the message with FIELD_ASYNC_RESUME_ID is passed to the resume handler, and ResumePakeStep
+ * completes the step when the task gets it. Otherwise the step is already completed.
+ */
+int32_t ExecutePakeStep(PakeParams *params, PakeProtocolStep step, const CJson *in, bool *isPending);
+
+bool IsPakeStepPending(const PakeParams *params);
+
+/*
+ * Called with the messages of a task whose step is pending.
+ * @return HC_SUCCESS with *isResumed set (the step is completed), HC_SUCCESS with *isResumed clear (the
+ *         message doesn't resume the step, the step is still pending), others (the step failed)
+ */
+int32_t ResumePakeStep(PakeParams *params, PakeProtocolStep step, const CJson *in, bool *isResumed);
+
 #endif
\ No newline at end of file
@@ -26,6 +26,7 @@ DECLARE_HC_VECTOR(SubTaskVec, void *)
 typedef struct TaskT {
     int taskId;
     VersionInfo versionInfo;
+    bool isPending; /* a step waits for the crypto workers, only its resume message is processed */
     void(*destroyTask)(struct TaskT *);
     int(*processTask)(struct TaskT *, const CJson *in, CJson *out, int *status);
     SubTaskVec vec;
@@ -23,6 +23,13 @@
 extern "C" {
 #endif
 
+/*
+ * Handler of the messages which resume a task, after the operations it has left on the crypto pool end.
+ * It is called on a crypto worker, the message is passed to ProcessTask of the request again on the task
+ * thread, and the handler takes the ownership of it in all cases.
+ */
+typedef int32_t (*TaskResumeHandler)(int64_t requestId, CJson *msg);
+
 int32_t InitModules();
 void DestroyModules();
 
@@ -30,6 +37,8 @@ int32_t CreateTask(int *taskId, const CJson *in, CJson *out, int moduleType);
 int32_t ProcessTask(int taskId, const CJson *in, CJson *out, int *status, int moduleType);
 void DestroyTask(int taskId, int moduleType);
 int32_t CheckMsgRepeatability(const CJson *in, int moduleType);
+void SetTaskResumeHandler(TaskResumeHandler handler);
+TaskResumeHandler GetTaskResumeHandler(void);
 
 // for DAS
 int32_t RegisterLocalIdentity(const char *pkgName, const char *serviceType, Uint8Buff *authId, int userType,
@@ -23,6 +23,7 @@
 #define HICHAIN_SPEKE_BASE_INFO "hichain_speke_base_info"
 #define HICHAIN_SPEKE_SESSIONKEY_INFO "hichain_speke_sessionkey_info"
 #define HICHAIN_RETURN_KEY "hichain_return_key"
+#define HICHAIN_RESUME_SECRET "hichain_resume_secret"
 #define TMP_AUTH_KEY_FACTOR "hichain_tmp_auth_enc_key"
 #define SHARED_SECRET_DERIVED_FACTOR "hichain_speke_shared_secret_info"
 
@@ -42,6 +43,8 @@
 #define PAKE_DL_PRIME_SMALL_LEN 256
 #define PAKE_DL_PRIME_LEN 384
 
+typedef struct PakeCryptoBatchT PakeCryptoBatch;
+
 typedef struct PakeBaseParamsT {
     Uint8Buff salt;
     Uint8Buff psk;
@@ -60,12 +63,14 @@ typedef struct PakeBaseParamsT {
     Uint8Buff kcfDataPeer;
     uint32_t innerKeyLen;
     const char *largePrimeNumHex;
+    const DlGroupContext *dlGroupCtx;
     bool is256ModSupported;
 
     AlgType supportedPakeAlg;
     CurveType curveType;
     bool isClient;
     const AlgLoader *loader;
+    PakeCryptoBatch *cryptoBatch; /* the operations of the step which runs on the crypto pool */
 } PakeBaseParams;
 
 #endif
\ No newline at end of file
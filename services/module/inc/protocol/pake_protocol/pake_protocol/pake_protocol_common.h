@@ -29,4 +29,26 @@ int32_t ClientVerifyConfirmPakeProtocol(const PakeBaseParams *params);
 int32_t ServerResponsePakeProtocol(PakeBaseParams *params);
 int32_t ServerConfirmPakeProtocol(PakeBaseParams *params);
 
+typedef enum {
+    PAKE_STEP_SERVER_RESPONSE,
+    PAKE_STEP_CLIENT_CONFIRM,
+    PAKE_STEP_SERVER_CONFIRM,
+} PakeProtocolStep;
+
+/* Called on a crypto worker once the operations of a started step end. */
+typedef void (*PakeStepDoneFunc)(void *ctx);
+
+/*
+ * The form of ServerResponsePakeProtocol, ClientConfirmPakeProtocol and ServerConfirmPakeProtocol whose
+ * asymmetric operations run on the crypto pool. If they still run at the return, *isPending is set, onDone is
+ * called once they end, and FinishPakeProtocolStep completes the step after that. Otherwise the step is already
+ * completed, as by the synchronous function, which is always the case with a NULL onDone or when the pool is
+ * not running. The params must not be used while the step is pending, DestroyPakeBaseParams waits for the
+ * operations and onDone is not called after it.
+ */
+int32_t StartPakeProtocolStep(PakeBaseParams *params, PakeProtocolStep step, PakeStepDoneFunc onDone, void *ctx,
+    bool *isPending);
+int32_t FinishPakeProtocolStep(PakeBaseParams *params, PakeProtocolStep step);
+bool IsPakeProtocolStepPending(const PakeBaseParams *params);
+
 #endif
@@ -17,6 +17,7 @@
 #define PAKE_PROTOCOL_DL_H
 
 #include "common_defs.h"
+#include "hc_crypto_pool.h"
 #include "hc_types.h"
 #include "pake_defs.h"
 
@@ -24,4 +25,13 @@ uint32_t GetPakeDlAlg();
 int32_t GenerateDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret);
 int32_t GenerateDlSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret);
 
+/*
+ * The same as the functions above, but the exponentiation is left to the async loader.
+ * @return HC_SUCCESS (onDone is called once it ends), others (error, onDone is not called)
+ */
+int32_t StartDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx);
+int32_t StartDlSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx);
+
 #endif
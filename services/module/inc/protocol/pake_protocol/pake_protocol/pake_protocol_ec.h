@@ -17,6 +17,7 @@
 #define PAKE_PROTOCOL_EC_H
 
 #include "common_defs.h"
+#include "hc_crypto_pool.h"
 #include "hc_types.h"
 #include "pake_defs.h"
 
@@ -24,4 +25,14 @@ uint32_t GetPakeEcAlg();
 int32_t GenerateEcPakeParams(PakeBaseParams *params, Uint8Buff *secret);
 int32_t GenerateEcSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret);
 
+/*
+ * The same as the functions above, but the point operations are left to the async loader, the secret must
+ * stay valid until onDone is called.
+ * @return HC_SUCCESS (onDone is called once they end), others (error, onDone is not called)
+ */
+int32_t StartEcPakeParams(PakeBaseParams *params, const Uint8Buff *secret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx);
+int32_t StartEcSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx);
+
 #endif
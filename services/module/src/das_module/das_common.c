@@ -18,6 +18,7 @@
 #include "alg_loader.h"
 #include "common_util.h"
 #include "hc_log.h"
+#include "hc_lru_cache.h"
 #include "hc_types.h"
 #include "module_common.h"
 
@@ -26,6 +27,13 @@
 #define SERVICE_TYPE_MAX_LEN 256
 #define AUTH_ID_MAX_LEN 64
 
+/* the aliases are derived from (keyType, alias length, pkgName, serviceType, authId) only */
+#define KEY_ALIAS_CACHE_CAPACITY 16
+#define KEY_ALIAS_CACHE_HEAD_LEN (sizeof(uint8_t) + sizeof(uint32_t) * 3)
+#define KEY_ALIAS_CACHE_MAX_KEY_LEN (KEY_ALIAS_CACHE_HEAD_LEN + PACKAGE_NAME_MAX_LEN + SERVICE_TYPE_MAX_LEN + \
+    AUTH_ID_MAX_LEN)
+#define KEY_ALIAS_CACHE_MAX_ALIAS_LEN (SHA256_LEN * BYTE_TO_HEX_OPER_LENGTH)
+
 #define MESSAGE_RETURN 0x8000
 #define MESSAGE_PREFIX 0x0010
 
@@ -41,6 +49,19 @@ static const uint8_t KEY_TYPE_PAIRS[KEY_ALIAS_TYPE_END][KEY_TYPE_PAIR_LEN] = {
     { 0x00, 0x07 }  /* AUTHTOKEN */
 };
 
+static HcLruCache g_keyAliasCache;
+
+int32_t InitKeyAliasCache(void)
+{
+    return InitLruCache(&g_keyAliasCache, KEY_ALIAS_CACHE_CAPACITY, KEY_ALIAS_CACHE_MAX_KEY_LEN,
+        KEY_ALIAS_CACHE_MAX_ALIAS_LEN);
+}
+
+void DestroyKeyAliasCache(void)
+{
+    DestroyLruCache(&g_keyAliasCache);
+}
+
 void SendErrorToOut(CJson *out, int opCode, int errCode)
 {
     CJson *sendToSelf = CreateJson();
@@ -286,6 +307,28 @@ err:
     return res;
 }
 
+static void AppendCacheKeyField(Uint8Buff *cacheKey, const void *field, uint32_t fieldLen)
+{
+    (void)memcpy_s(cacheKey->val + cacheKey->length, KEY_ALIAS_CACHE_MAX_KEY_LEN - cacheKey->length,
+        field, fieldLen);
+    cacheKey->length += fieldLen;
+}
+
+/* The lengths of the params have been checked, so the key fits in the buffer. */
+static void BuildKeyAliasCacheKey(const Uint8Buff *pkgName, const Uint8Buff *serviceType,
+    const KeyAliasType keyType, const Uint8Buff *authId, const Uint8Buff *outKeyAlias, Uint8Buff *cacheKey)
+{
+    uint8_t type = (uint8_t)keyType;
+    cacheKey->length = 0;
+    AppendCacheKeyField(cacheKey, &type, sizeof(type));
+    AppendCacheKeyField(cacheKey, &outKeyAlias->length, sizeof(outKeyAlias->length));
+    AppendCacheKeyField(cacheKey, &pkgName->length, sizeof(pkgName->length));
+    AppendCacheKeyField(cacheKey, &serviceType->length, sizeof(serviceType->length));
+    AppendCacheKeyField(cacheKey, pkgName->val, pkgName->length);
+    AppendCacheKeyField(cacheKey, serviceType->val, serviceType->length);
+    AppendCacheKeyField(cacheKey, authId->val, authId->length);
+}
+
 int32_t GenerateKeyAlias(const Uint8Buff *pkgName, const Uint8Buff *serviceType,
     const KeyAliasType keyType, const Uint8Buff *authId, Uint8Buff *outKeyAlias)
 {
@@ -305,6 +348,14 @@ int32_t GenerateKeyAlias(const Uint8Buff *pkgName, const Uint8Buff *serviceType,
         return HC_ERR_INVALID_LEN;
     }
 
+    uint8_t cacheKeyVal[KEY_ALIAS_CACHE_MAX_KEY_LEN];
+    Uint8Buff cacheKey = { cacheKeyVal, 0 };
+    BuildKeyAliasCacheKey(pkgName, serviceType, keyType, authId, outKeyAlias, &cacheKey);
+    if (LruCacheGet(&g_keyAliasCache, &cacheKey, outKeyAlias)) {
+        return HC_SUCCESS;
+    }
+    uint32_t epoch = GetLruCacheEpoch(&g_keyAliasCache);
+
     int32_t res;
     Uint8Buff serviceId = { NULL, SHA256_LEN };
     serviceId.val = (uint8_t *)HcMalloc(serviceId.length, 0);
@@ -326,6 +377,8 @@ int32_t GenerateKeyAlias(const Uint8Buff *pkgName, const Uint8Buff *serviceType,
     }
     if (res != HC_SUCCESS) {
         LOGE("CombineKeyAlias failed, keyType: %d, res: %d", keyType, res);
+    } else {
+        LruCachePut(&g_keyAliasCache, &cacheKey, outKeyAlias, epoch);
     }
 err:
     HcFree(serviceId.val);
@@ -15,7 +15,9 @@
 
 #include "das_module.h"
 #include "common_defs.h"
+#include "das_common.h"
 #include "hc_log.h"
+#include "hc_mutex.h"
 #include "hc_types.h"
 #include "hc_vector.h"
 #include "task_main.h"
@@ -25,6 +27,8 @@ IMPLEMENT_HC_VECTOR(TaskInModuleVec, void *, 1)
 
 TaskInModuleVec g_taskInModuleVec;
 DasAuthModule g_dasModule = {0};
+/* the tasks of different sessions are created and processed by different task workers */
+static HcMutex *g_taskInModuleMutex = NULL;
 
 static int32_t RegisterLocalIdentity(const char *pkgName, const char *serviceType, Uint8Buff *authId, int userType)
 {
@@ -52,7 +56,9 @@ static int CreateDasTask(int *taskId, const CJson *in, CJson *out)
         return HC_ERR_ALLOC_MEMORY;
     }
 
+    g_taskInModuleMutex->lock(g_taskInModuleMutex);
     g_taskInModuleVec.pushBackT(&g_taskInModuleVec, (void *)task);
+    g_taskInModuleMutex->unlock(g_taskInModuleMutex);
     return HC_SUCCESS;
 }
 
@@ -67,40 +73,56 @@ static void DestroyDasModule(AuthModuleBase *module)
     }
     DESTROY_HC_VECTOR(TaskInModuleVec, &g_taskInModuleVec)
     DestroyDasProtocolType();
+    DestroyKeyAliasCache();
+    if (g_taskInModuleMutex != NULL) {
+        DestroyHcMutex(g_taskInModuleMutex);
+        HcFree(g_taskInModuleMutex);
+        g_taskInModuleMutex = NULL;
+    }
     if (module != NULL) {
         (void)memset_s(module, sizeof(AuthModuleBase), 0, sizeof(AuthModuleBase));
     }
 }
 
-static int ProcessDasTask(int taskId, const CJson* in, CJson* out, int *status)
+static Task *GetDasTask(int taskId, bool isRemove)
 {
     uint32_t index;
     void **ptr = NULL;
     FOR_EACH_HC_VECTOR(g_taskInModuleVec, index, ptr) {
         if ((ptr != NULL) && (*ptr != NULL)) {
-            Task *temp = (Task *)*ptr;
-            if (taskId == temp->taskId) {
-                return temp->processTask(temp, in, out, status);
+            Task *temp = (Task *)(*ptr);
+            if (taskId != temp->taskId) {
+                continue;
             }
+            if (isRemove) {
+                void *tempPtr = NULL;
+                HC_VECTOR_POPELEMENT(&g_taskInModuleVec, &tempPtr, index);
+            }
+            return temp;
         }
     }
-    return HC_ERR_TASK_IS_NULL;
+    return NULL;
+}
+
+static int ProcessDasTask(int taskId, const CJson* in, CJson* out, int *status)
+{
+    /* a task is only processed and destroyed by the worker of its session, so it can be used without the lock */
+    g_taskInModuleMutex->lock(g_taskInModuleMutex);
+    Task *task = GetDasTask(taskId, false);
+    g_taskInModuleMutex->unlock(g_taskInModuleMutex);
+    if (task == NULL) {
+        return HC_ERR_TASK_IS_NULL;
+    }
+    return task->processTask(task, in, out, status);
 }
 
 static void DestroyDasTask(int taskId)
 {
-    uint32_t index;
-    void **ptr = NULL;
-    FOR_EACH_HC_VECTOR(g_taskInModuleVec, index, ptr) {
-        if ((ptr != NULL) && (*ptr != NULL)) {
-            Task *temp = (Task *)(*ptr);
-            if (taskId == temp->taskId) {
-                temp->destroyTask(temp);
-                void *tempPtr = NULL;
-                HC_VECTOR_POPELEMENT(&g_taskInModuleVec, &tempPtr, index);
-                return;
-            }
-        }
+    g_taskInModuleMutex->lock(g_taskInModuleMutex);
+    Task *task = GetDasTask(taskId, true);
+    g_taskInModuleMutex->unlock(g_taskInModuleMutex);
+    if (task != NULL) {
+        task->destroyTask(task);
     }
 }
 
@@ -120,10 +142,26 @@ AuthModuleBase *CreateDasModule()
     g_dasModule.unregisterLocalIdentity = UnregisterLocalIdentity;
     g_dasModule.deletePeerAuthInfo = DeletePeerAuthInfo;
     g_taskInModuleVec = CREATE_HC_VECTOR(TaskInModuleVec)
+    g_taskInModuleMutex = (HcMutex *)HcMalloc(sizeof(HcMutex), 0);
+    if (g_taskInModuleMutex == NULL) {
+        LOGE("Failed to allocate task mutex memory!");
+        DestroyDasModule((AuthModuleBase *)&g_dasModule);
+        return NULL;
+    }
+    if (InitHcMutex(g_taskInModuleMutex) != HC_SUCCESS) {
+        LOGE("Init mutex failed!");
+        HcFree(g_taskInModuleMutex);
+        g_taskInModuleMutex = NULL;
+        DestroyDasModule((AuthModuleBase *)&g_dasModule);
+        return NULL;
+    }
     if (InitDasProtocolType() != HC_SUCCESS) {
         LOGE("InitDasProtocolType failed.");
         DestroyDasModule((AuthModuleBase *)&g_dasModule);
         return NULL;
     }
+    if (InitKeyAliasCache() != HC_SUCCESS) {
+        LOGW("Init key alias cache failed, the aliases are not cached.");
+    }
     return (AuthModuleBase *)&g_dasModule;
 }
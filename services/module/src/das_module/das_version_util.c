@@ -117,7 +117,8 @@ int32_t NegotiateVersion(VersionStruct *minVersionPeer, VersionStruct *curVersio
         return HC_SUCCESS;
     }
     curVersionSelf->third = curVersionSelf->third & curVersionPeer->third;
-    if (curVersionSelf->third == 0) {
+    /* a capability bit is not an algorithm, the peers must still have an algorithm in common */
+    if ((curVersionSelf->third & ~BINARY_WIRE_CAPABILITY) == 0) {
         LOGE("Unsupported version!");
         return HC_ERR_UNSUPPORTED_VERSION;
     }
@@ -167,6 +168,11 @@ AlgType GetSupportedPakeAlg(VersionStruct *curVersion)
     return curVersion->third & (DL_SPEKE | EC_SPEKE | PSK_SPEKE | NEW_DL_SPEKE | NEW_EC_SPEKE);
 }
 
+bool IsSupportedBinaryWire(const VersionStruct *curVersion)
+{
+    return (curVersion->third & BINARY_WIRE_CAPABILITY) != 0;
+}
+
 bool IsSupportedPsk(VersionStruct *curVersion)
 {
     if (curVersion->third & PSK_SPEKE) {
@@ -19,6 +19,7 @@
 #include "hc_types.h"
 #include "pake_message_util.h"
 #include "pake_protocol_common.h"
+#include "pake_protocol_task_common.h"
 #include "pake_task_common.h"
 
 enum {
@@ -140,9 +141,41 @@ static int PackageMsgForClientConfirm(PakeParams *params, CJson *out)
     return res;
 }
 
+static int FinishPakeClientConfirm(AsyBaseCurTask *task, PakeParams *params, CJson *out, int *status)
+{
+    int res = PackageMsgForClientConfirm(params, out);
+    if (res != HC_SUCCESS) {
+        LOGE("PackageMsgForClientConfirm failed, res: %d.", res);
+        return res;
+    }
+
+    task->taskStatus = TASK_STATUS_CLIENT_PAKE_CONFIRM;
+    *status = CONTINUE;
+    return res;
+}
+
+static int ResumePakeClientConfirm(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out,
+    int *status)
+{
+    bool isResumed = false;
+    int res = ResumePakeStep(params, PAKE_STEP_CLIENT_CONFIRM, in, &isResumed);
+    if (res != HC_SUCCESS) {
+        LOGE("ClientConfirmPakeProtocol failed, res:%d", res);
+        return res;
+    }
+    if (!isResumed) {
+        *status = ASYNC_PENDING;
+        return HC_SUCCESS;
+    }
+    return FinishPakeClientConfirm(task, params, out, status);
+}
+
 static int PakeClientConfirm(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out, int *status)
 {
     int res;
+    if (IsPakeStepPending(params)) {
+        return ResumePakeClientConfirm(task, params, in, out, status);
+    }
     if (task->taskStatus < TASK_STATUS_CLIENT_PAKE_REQUEST) {
         return HC_ERR_BAD_MESSAGE;
     }
@@ -167,21 +200,17 @@ static int PakeClientConfirm(AsyBaseCurTask *task, PakeParams *params, const CJs
     }
 
     // execute
-    res = ClientConfirmPakeProtocol(&(params->baseParams));
+    bool isPending = false;
+    res = ExecutePakeStep(params, PAKE_STEP_CLIENT_CONFIRM, in, &isPending);
     if (res != HC_SUCCESS) {
         LOGE("ClientConfirmPakeProtocol failed, res:%d", res);
         return res;
     }
-
-    res = PackageMsgForClientConfirm(params, out);
-    if (res != HC_SUCCESS) {
-        LOGE("PackageMsgForClientConfirm failed, res: %d.", res);
-        return res;
+    if (isPending) {
+        *status = ASYNC_PENDING;
+        return HC_SUCCESS;
     }
-
-    task->taskStatus = TASK_STATUS_CLIENT_PAKE_CONFIRM;
-    *status = CONTINUE;
-    return res;
+    return FinishPakeClientConfirm(task, params, out, status);
 }
 
 static int PakeClientVerifyConfirm(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out, int *status)
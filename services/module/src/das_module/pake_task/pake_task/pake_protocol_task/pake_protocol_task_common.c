@@ -14,6 +14,8 @@
  */
 
 #include "pake_protocol_task_common.h"
+#include "dev_auth_module_manager.h"
+#include "hc_crypto_pool.h"
 #include "hc_log.h"
 #include "hc_types.h"
 #include "module_common.h"
@@ -27,6 +29,9 @@ void DestroyDasPakeParams(PakeParams *params)
     }
 
     DestroyPakeBaseParams(&(params->baseParams));
+    FreeJson(params->resumeMsg);
+    params->resumeMsg = NULL;
+    params->resumeId = 0;
 
     if (params->returnKey.val != NULL) {
         (void)memset_s(params->returnKey.val, params->returnKey.length, 0, params->returnKey.length);
@@ -67,6 +72,23 @@ static int32_t FillReturnKey(PakeParams *params, const CJson *in)
     return res;
 }
 
+/* Only the sessions which resume the task ask for it, with the request id to resume. */
+static void FillAsyncCrypto(PakeParams *params, const CJson *in)
+{
+    params->isAsyncCrypto = false;
+    params->resumeId = 0;
+    params->resumeMsg = NULL;
+    bool isAsyncCrypto = false;
+    if ((GetBoolFromJson(in, FIELD_IS_ASYNC_CRYPTO, &isAsyncCrypto) != HC_SUCCESS) || !isAsyncCrypto) {
+        return;
+    }
+    if (GetByteFromJson(in, FIELD_REQUEST_ID, (uint8_t *)&params->requestId, sizeof(int64_t)) != HC_SUCCESS) {
+        LOGW("No request id, the crypto operations run on the task thread.");
+        return;
+    }
+    params->isAsyncCrypto = true;
+}
+
 int32_t InitDasPakeParams(PakeParams *params, const CJson *in)
 {
     if (params == NULL || in == NULL) {
@@ -93,8 +115,89 @@ int32_t InitDasPakeParams(PakeParams *params, const CJson *in)
         goto err;
     }
 
+    FillAsyncCrypto(params, in);
     return HC_SUCCESS;
 err:
     DestroyDasPakeParams(params);
     return res;
-}
\ No newline at end of file
+}
+
+static void OnPakeStepDone(void *ctx)
+{
+    PakeParams *params = (PakeParams *)ctx;
+    CJson *msg = params->resumeMsg;
+    params->resumeMsg = NULL;
+    TaskResumeHandler handler = GetTaskResumeHandler();
+    if (handler == NULL) {
+        LOGE("No resume handler, the task can't go on.");
+        FreeJson(msg);
+        return;
+    }
+    (void)handler(params->requestId, msg);
+}
+
+/* Random, so a message of the peer can't pass for the resume message. */
+static int32_t GenerateResumeId(const PakeParams *params, int32_t *resumeId)
+{
+    uint32_t randomId = 0;
+    Uint8Buff randomBuff = { (uint8_t *)&randomId, sizeof(uint32_t) };
+    int32_t res = params->baseParams.loader->generateRandom(&randomBuff);
+    if (res != HC_SUCCESS) {
+        LOGE("Generate resume id failed, res: %d.", res);
+        return res;
+    }
+    /* 0 means no step is pending */
+    *resumeId = (int32_t)((randomId & INT32_MAX) | 1);
+    return HC_SUCCESS;
+}
+
+int32_t ExecutePakeStep(PakeParams *params, PakeProtocolStep step, const CJson *in, bool *isPending)
+{
+    *isPending = false;
+    if (!params->isAsyncCrypto || (GetAsyncLoaderInstance() == NULL)) {
+        return StartPakeProtocolStep(&params->baseParams, step, NULL, NULL, isPending);
+    }
+    int32_t resumeId = 0;
+    int32_t res = GenerateResumeId(params, &resumeId);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    CJson *resumeMsg = DuplicateJson(in);
+    if (resumeMsg == NULL) {
+        LOGE("Failed to duplicate the message to resume!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    if (AddIntToJson(resumeMsg, FIELD_ASYNC_RESUME_ID, resumeId) != HC_SUCCESS) {
+        LOGE("Failed to add resume id to json!");
+        FreeJson(resumeMsg);
+        return HC_ERR_JSON_ADD;
+    }
+    params->resumeMsg = resumeMsg;
+    params->resumeId = resumeId;
+    res = StartPakeProtocolStep(&params->baseParams, step, OnPakeStepDone, params, isPending);
+    if (!*isPending) {
+        /* failed, or done on this thread, the resume message is not handed over in both cases */
+        FreeJson(params->resumeMsg);
+        params->resumeMsg = NULL;
+        params->resumeId = 0;
+    }
+    return res;
+}
+
+bool IsPakeStepPending(const PakeParams *params)
+{
+    return params->resumeId != 0;
+}
+
+int32_t ResumePakeStep(PakeParams *params, PakeProtocolStep step, const CJson *in, bool *isResumed)
+{
+    *isResumed = false;
+    int32_t resumeId = 0;
+    if ((GetIntFromJson(in, FIELD_ASYNC_RESUME_ID, &resumeId) != HC_SUCCESS) || (resumeId != params->resumeId) ||
+        IsPakeProtocolStepPending(&params->baseParams)) {
+        return HC_SUCCESS;
+    }
+    params->resumeId = 0;
+    *isResumed = true;
+    return FinishPakeProtocolStep(&params->baseParams, step);
+}
@@ -19,6 +19,7 @@
 #include "hc_types.h"
 #include "pake_message_util.h"
 #include "pake_protocol_common.h"
+#include "pake_protocol_task_common.h"
 #include "pake_task_common.h"
 
 enum {
@@ -67,9 +68,41 @@ static int PackageMsgForResponse(const PakeParams *params, CJson *out)
     return res;
 }
 
+static int FinishPakeResponse(AsyBaseCurTask *task, PakeParams *params, CJson *out, int *status)
+{
+    // package message
+    int res = PackageMsgForResponse(params, out);
+    if (res != HC_SUCCESS) {
+        LOGE("PackageMsgForResponse failed, res: %d.", res);
+        return res;
+    }
+
+    task->taskStatus = TASK_STATUS_SERVER_PAKE_RESPONSE;
+    *status = CONTINUE;
+    return res;
+}
+
+static int ResumePakeResponse(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out, int *status)
+{
+    bool isResumed = false;
+    int res = ResumePakeStep(params, PAKE_STEP_SERVER_RESPONSE, in, &isResumed);
+    if (res != HC_SUCCESS) {
+        LOGE("ServerResponsePakeProtocol failed, res:%d", res);
+        return res;
+    }
+    if (!isResumed) {
+        *status = ASYNC_PENDING;
+        return HC_SUCCESS;
+    }
+    return FinishPakeResponse(task, params, out, status);
+}
+
 static int PakeResponse(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out, int *status)
 {
     int res;
+    if (IsPakeStepPending(params)) {
+        return ResumePakeResponse(task, params, in, out, status);
+    }
     if (task->taskStatus > TASK_STATUS_SERVER_PAKE_BEGIN) {
         LOGI("The message is repeated, ignore it, status :%d", task->taskStatus);
         *status = IGNORE_MSG;
@@ -100,27 +133,65 @@ static int PakeResponse(AsyBaseCurTask *task, PakeParams *params, const CJson *i
     }
 
     // execute
-    res = ServerResponsePakeProtocol(&params->baseParams);
+    bool isPending = false;
+    res = ExecutePakeStep(params, PAKE_STEP_SERVER_RESPONSE, in, &isPending);
     if (res != HC_SUCCESS) {
         LOGE("ServerResponsePakeProtocol failed, res:%d", res);
         return res;
     }
+    if (isPending) {
+        *status = ASYNC_PENDING;
+        return HC_SUCCESS;
+    }
+    return FinishPakeResponse(task, params, out, status);
+}
 
+static int FinishPakeServerConfirm(AsyBaseCurTask *task, PakeParams *params, CJson *out, int *status)
+{
     // package message
-    res = PackageMsgForResponse(params, out);
+    int res = ConstructOutJson(params, out);
     if (res != HC_SUCCESS) {
-        LOGE("PackageMsgForResponse failed, res: %d.", res);
+        LOGE("ConstructOutJson failed, res: %d.", res);
+        return res;
+    }
+    CJson *payload = GetObjFromJson(out, FIELD_PAYLOAD);
+    if (payload == NULL) {
+        LOGE("Get payload from json failed.");
+        return HC_ERR_JSON_GET;
+    }
+    res = PackagePakeServerConfirmData(params, payload);
+    if (res != HC_SUCCESS) {
+        LOGE("PackagePakeServerConfirmData failed, res: %d.", res);
         return res;
     }
 
-    task->taskStatus = TASK_STATUS_SERVER_PAKE_RESPONSE;
-    *status = CONTINUE;
+    task->taskStatus = TASK_STATUS_SERVER_PAKE_CONFIRM;
+    *status = FINISH;
     return res;
 }
 
+static int ResumePakeServerConfirm(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out,
+    int *status)
+{
+    bool isResumed = false;
+    int res = ResumePakeStep(params, PAKE_STEP_SERVER_CONFIRM, in, &isResumed);
+    if (res != HC_SUCCESS) {
+        LOGE("ServerConfirmPakeProtocol failed, res:%d", res);
+        return res;
+    }
+    if (!isResumed) {
+        *status = ASYNC_PENDING;
+        return HC_SUCCESS;
+    }
+    return FinishPakeServerConfirm(task, params, out, status);
+}
+
 static int PakeServerConfirm(AsyBaseCurTask *task, PakeParams *params, const CJson *in, CJson *out, int *status)
 {
     int res;
+    if (IsPakeStepPending(params)) {
+        return ResumePakeServerConfirm(task, params, in, out, status);
+    }
     if (task->taskStatus < TASK_STATUS_SERVER_PAKE_RESPONSE) {
         return HC_ERR_BAD_MESSAGE;
     }
@@ -144,32 +215,17 @@ static int PakeServerConfirm(AsyBaseCurTask *task, PakeParams *params, const CJs
     }
 
     // execute
-    res = ServerConfirmPakeProtocol(&params->baseParams);
+    bool isPending = false;
+    res = ExecutePakeStep(params, PAKE_STEP_SERVER_CONFIRM, in, &isPending);
     if (res != HC_SUCCESS) {
         LOGE("ServerConfirmPakeProtocol failed, res:%d", res);
         return res;
     }
-
-    // package message
-    res = ConstructOutJson(params, out);
-    if (res != HC_SUCCESS) {
-        LOGE("ConstructOutJson failed, res: %d.", res);
-        return res;
-    }
-    CJson *payload = GetObjFromJson(out, FIELD_PAYLOAD);
-    if (payload == NULL) {
-        LOGE("Get payload from json failed.");
-        return HC_ERR_JSON_GET;
-    }
-    res = PackagePakeServerConfirmData(params, payload);
-    if (res != HC_SUCCESS) {
-        LOGE("PackagePakeServerConfirmData failed, res: %d.", res);
-        return res;
+    if (isPending) {
+        *status = ASYNC_PENDING;
+        return HC_SUCCESS;
     }
-
-    task->taskStatus = TASK_STATUS_SERVER_PAKE_CONFIRM;
-    *status = FINISH;
-    return res;
+    return FinishPakeServerConfirm(task, params, out, status);
 }
 
 static int Process(struct AsyBaseCurTaskT *task, PakeParams *params, const CJson *in, CJson *out, int *status)
@@ -83,6 +83,23 @@ static int32_t GenerateOutputKey(PakeParams *params)
     return res;
 }
 
+/* The secret comes from the PAKE key like the return key, but with its own info, so the caller can't derive it. */
+static void AddResumeSecret(const PakeParams *params, CJson *sendToSelf)
+{
+    uint8_t secret[AUTH_RESUME_SECRET_LEN] = { 0 };
+    Uint8Buff secretBuff = { secret, AUTH_RESUME_SECRET_LEN };
+    Uint8Buff keyInfo = { (uint8_t *)HICHAIN_RESUME_SECRET, strlen(HICHAIN_RESUME_SECRET) };
+    int32_t res = params->baseParams.loader->computeHkdf(&(params->baseParams.sessionKey),
+        &(params->baseParams.salt), &keyInfo, &secretBuff, false);
+    if (res == HC_SUCCESS) {
+        res = AddByteToJson(sendToSelf, FIELD_RESUME_SECRET, secret, AUTH_RESUME_SECRET_LEN);
+    }
+    (void)memset_s(secret, sizeof(secret), 0, sizeof(secret));
+    if (res != HC_SUCCESS) {
+        LOGW("Failed to add the resumption secret, the auth won't be resumed, res: %d.", res);
+    }
+}
+
 int32_t SendResultToSelf(PakeParams *params, CJson *out)
 {
     int res = HC_SUCCESS;
@@ -101,6 +118,9 @@ int32_t SendResultToSelf(PakeParams *params, CJson *out)
         }
         GOTO_ERR_AND_SET_RET(AddByteToJson(sendToSelf, FIELD_SESSION_KEY, params->returnKey.val,
             params->returnKey.length), res);
+        if (params->isResumable) {
+            AddResumeSecret(params, sendToSelf);
+        }
     }
 
     GOTO_ERR_AND_SET_RET(AddObjToJson(out, FIELD_SEND_TO_SELF, sendToSelf), res);
@@ -344,6 +364,10 @@ int32_t FillDasPakeParams(PakeParams *params, const CJson *in)
         LOGD("Get opCode failed, use default, res: %d", res);
         params->opCode = AUTHENTICATE;
     }
+    params->isResumable = false;
+    if (params->opCode == AUTHENTICATE) {
+        (void)GetBoolFromJson(in, FIELD_IS_RESUMABLE, &(params->isResumable));
+    }
 
     res = GetBoolFromJson(in, FIELD_IS_CLIENT, &(params->baseParams.isClient));
     if (res != HC_SUCCESS) {
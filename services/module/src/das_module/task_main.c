@@ -56,7 +56,7 @@ static void GetMaxVersion(VersionStruct *version)
 {
     version->first = VERSION_FIRST_BIT;
     version->second = 0;
-    version->third = 0;
+    version->third = BINARY_WIRE_CAPABILITY;
 
     uint32_t index;
     void **ptr = NULL;
@@ -272,6 +272,13 @@ static int ProcessTask(Task *task, const CJson *in, CJson *out, int *status)
         LOGE("Peer message is error message.");
         return res;
     }
+    int32_t resumeId = 0;
+    bool isResumeMsg = (GetIntFromJson(in, FIELD_ASYNC_RESUME_ID, &resumeId) == HC_SUCCESS);
+    if (isResumeMsg != task->isPending) {
+        LOGI("The message doesn't match the pending state of the task, ignore it.");
+        *status = IGNORE_MSG;
+        return HC_SUCCESS;
+    }
 
     if (task->versionInfo.versionStatus == INITIAL) {
         res = ProcessMultiTask(task, in, out, status);
@@ -295,10 +302,25 @@ static int ProcessTask(Task *task, const CJson *in, CJson *out, int *status)
             return res;
         }
     }
+    task->isPending = (*status == ASYNC_PENDING);
+    if (task->isPending) {
+        /* the resume message of the step is processed later, nothing to send for now */
+        *status = IGNORE_MSG;
+        return HC_SUCCESS;
+    }
 
     res = AddVersionToOut(&(task->versionInfo), out);
     if (res != HC_SUCCESS) {
         LOGE("AddVersionToOut failed");
+        return res;
+    }
+    if ((task->versionInfo.versionStatus == VERSION_DECIDED) &&
+        IsSupportedBinaryWire(&(task->versionInfo.curVersion))) {
+        /* not sent to the peer, it tells the session to send the messages in the binary form */
+        res = AddBoolToJson(out, FIELD_IS_BINARY_WIRE, true);
+        if (res != HC_SUCCESS) {
+            LOGE("Add binary wire flag to out failed.");
+        }
     }
     return res;
 }
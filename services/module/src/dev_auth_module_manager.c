@@ -27,6 +27,7 @@ IMPLEMENT_HC_VECTOR(AuthModuleVec, void *, 1)
 
 static AuthModuleVec g_authModuleVec;
 static VersionStruct g_version;
+static TaskResumeHandler g_resumeHandler = NULL;
 
 static AuthModuleBase *GetModule(int moduleType)
 {
@@ -311,6 +312,16 @@ static uint32_t InitTcisModule()
     return HC_SUCCESS;
 }
 
+void SetTaskResumeHandler(TaskResumeHandler handler)
+{
+    g_resumeHandler = handler;
+}
+
+TaskResumeHandler GetTaskResumeHandler(void)
+{
+    return g_resumeHandler;
+}
+
 int32_t InitModules()
 {
     g_authModuleVec = CREATE_HC_VECTOR(AuthModuleVec)
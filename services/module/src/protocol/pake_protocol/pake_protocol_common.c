@@ -15,6 +15,8 @@
 
 #include "pake_protocol_common.h"
 #include "alg_loader.h"
+#include "hc_condition.h"
+#include "hc_crypto_pool.h"
 #include "hc_log.h"
 #include "hc_types.h"
 #include "module_common.h"
@@ -25,12 +27,52 @@
 
 #define PAKE_SESSION_KEY_LEN 16
 
+struct PakeCryptoBatchT {
+    HcMutex lock;
+    HcCondition cond;
+    uint32_t pending; /* the chains of operations which have not ended, plus one while the step is started */
+    bool isNotifying; /* onDone runs out of the lock, the batch is kept until it returns */
+    int32_t result; /* the first error of the operations */
+    PakeStepDoneFunc onDone;
+    void *ctx;
+    uint8_t secretVal[PAKE_SECRET_LEN];
+    Uint8Buff secret; /* the input of hashToPoint, it is kept until the step ends */
+};
+
+static void WaitCryptoBatch(PakeCryptoBatch *batch)
+{
+    batch->lock.lock(&batch->lock);
+    while ((batch->pending > 0) || batch->isNotifying) {
+        batch->cond.waitWithoutLock(&batch->cond);
+    }
+    batch->lock.unlock(&batch->lock);
+}
+
+static void DestroyCryptoBatch(PakeBaseParams *params)
+{
+    PakeCryptoBatch *batch = params->cryptoBatch;
+    if (batch == NULL) {
+        return;
+    }
+    /* the operations which still run write to the params, nobody is left to resume when they end */
+    batch->lock.lock(&batch->lock);
+    batch->onDone = NULL;
+    batch->lock.unlock(&batch->lock);
+    WaitCryptoBatch(batch);
+    (void)memset_s(batch->secretVal, PAKE_SECRET_LEN, 0, PAKE_SECRET_LEN);
+    DestroyHcCond(&batch->cond);
+    DestroyHcMutex(&batch->lock);
+    HcFree(batch);
+    params->cryptoBatch = NULL;
+}
+
 void DestroyPakeBaseParams(PakeBaseParams *params)
 {
     if (params == NULL) {
         return;
     }
 
+    DestroyCryptoBatch(params);
     FreeAndCleanKey(&params->psk);
     FreeAndCleanKey(&params->base);
     FreeAndCleanKey(&params->eskSelf);
@@ -132,10 +174,12 @@ static void FillDefaultValue(PakeBaseParams *params)
     params->idPeer.length = 0;
     params->is256ModSupported = false; /* default 384 */
     params->largePrimeNumHex = NULL;
+    params->dlGroupCtx = NULL;
     params->innerKeyLen = 0;
     params->supportedPakeAlg = UNSUPPORTED_ALG;
     params->curveType = CURVE_NONE;
     params->isClient = true;
+    params->cryptoBatch = NULL;
 }
 
 int32_t InitPakeBaseParams(PakeBaseParams *params)
@@ -164,29 +208,37 @@ err:
     return res;
 }
 
-static int32_t GeneratePakeParams(PakeBaseParams *params)
+static int32_t DeriveSecret(PakeBaseParams *params, Uint8Buff *secret)
 {
     int32_t res;
-    uint8_t secretVal[PAKE_SECRET_LEN] = { 0 };
-    Uint8Buff secret = { secretVal, PAKE_SECRET_LEN };
     if (!params->isClient) {
         res = params->loader->generateRandom(&(params->salt));
         if (res != HC_SUCCESS) {
             LOGE("Generate salt failed, res: %d.", res);
-            goto err;
+            return res;
         }
     }
 
     res = params->loader->generateRandom(&(params->challengeSelf));
     if (res != HC_SUCCESS) {
         LOGE("Generate challengeSelf failed, res: %d.", res);
-        goto err;
+        return res;
     }
 
     Uint8Buff keyInfo = { (uint8_t *)HICHAIN_SPEKE_BASE_INFO, strlen(HICHAIN_SPEKE_BASE_INFO) };
-    res = params->loader->computeHkdf(&(params->psk), &(params->salt), &keyInfo, &secret, false);
+    res = params->loader->computeHkdf(&(params->psk), &(params->salt), &keyInfo, secret, false);
     if (res != HC_SUCCESS) {
         LOGE("Derive secret from psk failed, res: %d.", res);
+    }
+    return res;
+}
+
+static int32_t GeneratePakeParams(PakeBaseParams *params)
+{
+    uint8_t secretVal[PAKE_SECRET_LEN] = { 0 };
+    Uint8Buff secret = { secretVal, PAKE_SECRET_LEN };
+    int32_t res = DeriveSecret(params, &secret);
+    if (res != HC_SUCCESS) {
         goto err;
     }
 
@@ -398,3 +450,246 @@ int32_t ServerConfirmPakeProtocol(PakeBaseParams *params)
 
     return res;
 }
+
+static int32_t RunPakeProtocolStep(PakeBaseParams *params, PakeProtocolStep step)
+{
+    switch (step) {
+        case PAKE_STEP_SERVER_RESPONSE:
+            return ServerResponsePakeProtocol(params);
+        case PAKE_STEP_CLIENT_CONFIRM:
+            return ClientConfirmPakeProtocol(params);
+        case PAKE_STEP_SERVER_CONFIRM:
+            return ServerConfirmPakeProtocol(params);
+        default:
+            return HC_ERR_INVALID_PARAMS;
+    }
+}
+
+static PakeCryptoBatch *GetCryptoBatch(PakeBaseParams *params)
+{
+    if (params->cryptoBatch != NULL) {
+        return params->cryptoBatch;
+    }
+    PakeCryptoBatch *batch = (PakeCryptoBatch *)HcMalloc(sizeof(PakeCryptoBatch), 0);
+    if (batch == NULL) {
+        return NULL;
+    }
+    if (InitHcMutex(&batch->lock) != HC_SUCCESS) {
+        HcFree(batch);
+        return NULL;
+    }
+    if (InitHcCond(&batch->cond, &batch->lock) != HC_SUCCESS) {
+        DestroyHcMutex(&batch->lock);
+        HcFree(batch);
+        return NULL;
+    }
+    batch->secret.val = batch->secretVal;
+    batch->secret.length = PAKE_SECRET_LEN;
+    params->cryptoBatch = batch;
+    return batch;
+}
+
+/*
+ * Called with the lock held, which it releases. The last operation calls onDone after unlocking, as onDone
+ * hands the resume message to a thread which may take the lock at once.
+ */
+static void ReleaseCryptoOp(PakeCryptoBatch *batch)
+{
+    batch->pending--;
+    PakeStepDoneFunc onDone = (batch->pending == 0) ? batch->onDone : NULL;
+    void *stepCtx = batch->ctx;
+    if (onDone == NULL) {
+        if (batch->pending == 0) {
+            batch->cond.notifyWithoutLock(&batch->cond);
+        }
+        batch->lock.unlock(&batch->lock);
+        return;
+    }
+    batch->isNotifying = true;
+    batch->lock.unlock(&batch->lock);
+    onDone(stepCtx);
+    batch->lock.lock(&batch->lock);
+    batch->isNotifying = false;
+    batch->cond.notifyWithoutLock(&batch->cond);
+    batch->lock.unlock(&batch->lock);
+}
+
+static void OnPakeCryptoOpDone(int32_t result, void *ctx)
+{
+    PakeCryptoBatch *batch = (PakeCryptoBatch *)ctx;
+    batch->lock.lock(&batch->lock);
+    if ((result != HC_SUCCESS) && (batch->result == HC_SUCCESS)) {
+        batch->result = result;
+    }
+    ReleaseCryptoOp(batch);
+}
+
+static void AddCryptoOp(PakeCryptoBatch *batch)
+{
+    batch->lock.lock(&batch->lock);
+    batch->pending++;
+    batch->lock.unlock(&batch->lock);
+}
+
+/* For an operation which failed to start, the guard of the start keeps pending above zero. */
+static void DropCryptoOp(PakeCryptoBatch *batch)
+{
+    batch->lock.lock(&batch->lock);
+    batch->pending--;
+    batch->lock.unlock(&batch->lock);
+}
+
+static int32_t StartPakeParams(PakeBaseParams *params, PakeCryptoBatch *batch, const AsyncAlgLoader *asyncLoader)
+{
+    int32_t res = DeriveSecret(params, &batch->secret);
+    FreeAndCleanKey(&params->psk);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+
+    AddCryptoOp(batch);
+    if ((uint32_t)params->supportedPakeAlg & EC_SPEKE) {
+        res = StartEcPakeParams(params, &batch->secret, asyncLoader, OnPakeCryptoOpDone, batch);
+    } else if ((uint32_t)params->supportedPakeAlg & DL_SPEKE) {
+        res = StartDlPakeParams(params, &batch->secret, asyncLoader, OnPakeCryptoOpDone, batch);
+    } else {
+        res = HC_ERR_INVALID_ALG;
+    }
+    if (res != HC_SUCCESS) {
+        DropCryptoOp(batch);
+        LOGE("StartPakeParams failed, PakeAlg: 0x%x, res: %d.", params->supportedPakeAlg, res);
+    }
+    return res;
+}
+
+static int32_t StartSharedSecret(PakeBaseParams *params, PakeCryptoBatch *batch, const AsyncAlgLoader *asyncLoader)
+{
+    int32_t res = InitSingleParam(&params->sharedSecret, params->innerKeyLen);
+    if (res != HC_SUCCESS) {
+        LOGE("InitSingleParam for sharedSecret failed, res: %d.", res);
+        return res;
+    }
+
+    AddCryptoOp(batch);
+    if ((uint32_t)params->supportedPakeAlg & EC_SPEKE) {
+        res = StartEcSharedSecret(params, &params->sharedSecret, asyncLoader, OnPakeCryptoOpDone, batch);
+    } else if ((uint32_t)params->supportedPakeAlg & DL_SPEKE) {
+        res = StartDlSharedSecret(params, &params->sharedSecret, asyncLoader, OnPakeCryptoOpDone, batch);
+    } else {
+        res = HC_ERR_INVALID_ALG;
+    }
+    if (res != HC_SUCCESS) {
+        DropCryptoOp(batch);
+        LOGE("StartSharedSecret failed, pakeAlg: %x, res: %d.", params->supportedPakeAlg, res);
+    }
+    return res;
+}
+
+int32_t StartPakeProtocolStep(PakeBaseParams *params, PakeProtocolStep step, PakeStepDoneFunc onDone, void *ctx,
+    bool *isPending)
+{
+    if ((params == NULL) || (isPending == NULL)) {
+        return HC_ERR_NULL_PTR;
+    }
+    *isPending = false;
+    const AsyncAlgLoader *asyncLoader = (onDone != NULL) ? GetAsyncLoaderInstance() : NULL;
+    PakeCryptoBatch *batch = (asyncLoader != NULL) ? GetCryptoBatch(params) : NULL;
+    if (batch == NULL) {
+        return RunPakeProtocolStep(params, step);
+    }
+    /* the operations of a step which failed to start may still run */
+    WaitCryptoBatch(batch);
+    batch->lock.lock(&batch->lock);
+    batch->pending = 1;
+    batch->result = HC_SUCCESS;
+    batch->onDone = onDone;
+    batch->ctx = ctx;
+    batch->lock.unlock(&batch->lock);
+
+    /* the operations of the client confirm don't depend on each other, they run in parallel */
+    int32_t res = HC_SUCCESS;
+    if (step != PAKE_STEP_SERVER_CONFIRM) {
+        res = StartPakeParams(params, batch, asyncLoader);
+    }
+    if ((res == HC_SUCCESS) && (step != PAKE_STEP_SERVER_RESPONSE)) {
+        res = StartSharedSecret(params, batch, asyncLoader);
+    }
+
+    batch->lock.lock(&batch->lock);
+    if (res != HC_SUCCESS) {
+        /* the step fails now, the operations which have started are only waited for by the destruction */
+        batch->onDone = NULL;
+    }
+    batch->pending--;
+    bool isDone = (batch->pending == 0);
+    batch->lock.unlock(&batch->lock);
+    if (res != HC_SUCCESS) {
+        LOGE("Start pake step %d failed, res: %d.", step, res);
+        return res;
+    }
+    if (!isDone) {
+        *isPending = true;
+        return HC_SUCCESS;
+    }
+    /* the pool was too busy and ran the operations on this thread */
+    return FinishPakeProtocolStep(params, step);
+}
+
+static int32_t FinishSessionKey(PakeBaseParams *params)
+{
+    int32_t res = DeriveKeyFromSharedSecret(params, &params->sharedSecret);
+    if (res != HC_SUCCESS) {
+        LOGE("DeriveKeyFromSharedSecret failed.");
+        FreeAndCleanKey(&params->sharedSecret);
+        FreeAndCleanKey(&params->sessionKey);
+        FreeAndCleanKey(&params->hmacKey);
+    }
+    return res;
+}
+
+int32_t FinishPakeProtocolStep(PakeBaseParams *params, PakeProtocolStep step)
+{
+    if ((params == NULL) || (params->cryptoBatch == NULL)) {
+        return HC_ERR_NULL_PTR;
+    }
+    PakeCryptoBatch *batch = params->cryptoBatch;
+    batch->lock.lock(&batch->lock);
+    int32_t res = batch->result;
+    batch->lock.unlock(&batch->lock);
+    (void)memset_s(batch->secretVal, PAKE_SECRET_LEN, 0, PAKE_SECRET_LEN);
+    if (res != HC_SUCCESS) {
+        LOGE("The crypto operations of pake step %d failed, res: %d.", step, res);
+        return res;
+    }
+    if (step == PAKE_STEP_SERVER_RESPONSE) {
+        return HC_SUCCESS;
+    }
+    res = FinishSessionKey(params);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    if (step == PAKE_STEP_SERVER_CONFIRM) {
+        res = VerifyProof(params);
+        if (res != HC_SUCCESS) {
+            LOGE("VerifyProof failed, res:%d", res);
+            return res;
+        }
+    }
+    res = GenerateProof(params);
+    if (res != HC_SUCCESS) {
+        LOGE("GenerateProof failed, res:%d", res);
+    }
+    return res;
+}
+
+bool IsPakeProtocolStepPending(const PakeBaseParams *params)
+{
+    if ((params == NULL) || (params->cryptoBatch == NULL)) {
+        return false;
+    }
+    PakeCryptoBatch *batch = params->cryptoBatch;
+    batch->lock.lock(&batch->lock);
+    bool isPending = (batch->pending > 0);
+    batch->lock.unlock(&batch->lock);
+    return isPending;
+}
@@ -56,6 +56,24 @@ static int32_t GenerateEsk(PakeBaseParams *params)
     return res;
 }
 
+static void InitDlGroup(PakeBaseParams *params)
+{
+    params->largePrimeNumHex = params->is256ModSupported ? g_largePrimeNumberHex256 : g_largePrimeNumberHex348;
+    params->dlGroupCtx = NULL;
+    if ((params->loader->getDlGroupContext != NULL) && (params->loader->bigNumExpModWithContext != NULL)) {
+        params->dlGroupCtx = params->loader->getDlGroupContext(params->largePrimeNumHex);
+    }
+}
+
+/* The cached group context saves decoding the prime for every exponentiation. */
+static int32_t DlExpMod(const PakeBaseParams *params, const Uint8Buff *base, const Uint8Buff *exp, Uint8Buff *outNum)
+{
+    if (params->dlGroupCtx != NULL) {
+        return params->loader->bigNumExpModWithContext(base, exp, params->dlGroupCtx, outNum);
+    }
+    return params->loader->bigNumExpMod(base, exp, params->largePrimeNumHex, outNum);
+}
+
 static int32_t InitDlPakeParams(PakeBaseParams *params)
 {
     if (params->isClient) {
@@ -85,28 +103,37 @@ static int32_t InitDlPakeParams(PakeBaseParams *params)
     return res;
 }
 
-int32_t GenerateDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret)
+/* Everything but the exponentiation of epkSelf, the base is a square so it is cheap. */
+static int32_t PrepareDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret)
 {
     int32_t res = InitDlPakeParams(params);
     if (res != HC_SUCCESS) {
         LOGE("InitDlPakeParams failed, res: %d.", res);
-        goto err;
+        return res;
     }
     res = GenerateEsk(params);
     if (res != HC_SUCCESS) {
         LOGE("GenerateEsk failed, res: %d.", res);
-        goto err;
+        return res;
     }
     uint8_t expVal[PAKE_DL_EXP_LEN] = { 2 };
     Uint8Buff exp = { expVal, PAKE_DL_EXP_LEN };
-    params->largePrimeNumHex = params->is256ModSupported ? g_largePrimeNumberHex256 : g_largePrimeNumberHex348;
-    res = params->loader->bigNumExpMod(secret, &exp, params->largePrimeNumHex, &params->base);
+    InitDlGroup(params);
+    res = DlExpMod(params, secret, &exp, &params->base);
     if (res != HC_SUCCESS) {
         LOGE("BigNumExpMod for base failed, res: %d.", res);
+    }
+    return res;
+}
+
+int32_t GenerateDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret)
+{
+    int32_t res = PrepareDlPakeParams(params, secret);
+    if (res != HC_SUCCESS) {
         goto err;
     }
 
-    res = params->loader->bigNumExpMod(&params->base, &(params->eskSelf), params->largePrimeNumHex, &(params->epkSelf));
+    res = DlExpMod(params, &params->base, &(params->eskSelf), &(params->epkSelf));
     if (res != HC_SUCCESS) {
         LOGE("BigNumExpMod for epkSelf failed, res: %d.", res);
         goto err;
@@ -124,10 +151,53 @@ int32_t GenerateDlSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret)
         LOGE("CheckDlPublicKey failed.");
         return HC_ERR_INVALID_PUBLIC_KEY;
     }
-    int32_t res = params->loader->bigNumExpMod(&(params->epkPeer), &(params->eskSelf), params->largePrimeNumHex,
-        sharedSecret);
+    int32_t res = DlExpMod(params, &(params->epkPeer), &(params->eskSelf), sharedSecret);
     if (res != HC_SUCCESS) {
         LOGE("BigNumExpMod for sharedSecret failed.");
     }
     return res;
-}
\ No newline at end of file
+}
+
+static int32_t StartDlExpMod(const PakeBaseParams *params, const Uint8Buff *base, const Uint8Buff *exp,
+    Uint8Buff *outNum, const AsyncAlgLoader *asyncLoader, AlgCompletionFunc onDone, void *ctx)
+{
+    if (params->dlGroupCtx != NULL) {
+        return asyncLoader->bigNumExpModWithContext(base, exp, params->dlGroupCtx, outNum, onDone, ctx);
+    }
+    return asyncLoader->bigNumExpMod(base, exp, params->largePrimeNumHex, outNum, onDone, ctx);
+}
+
+int32_t StartDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    int32_t res = PrepareDlPakeParams(params, secret);
+    if (res != HC_SUCCESS) {
+        goto err;
+    }
+
+    res = StartDlExpMod(params, &params->base, &(params->eskSelf), &(params->epkSelf), asyncLoader, onDone, ctx);
+    if (res != HC_SUCCESS) {
+        LOGE("Start BigNumExpMod for epkSelf failed, res: %d.", res);
+        goto err;
+    }
+    return res;
+err:
+    FreeAndCleanKey(&params->eskSelf);
+    FreeAndCleanKey(&params->base);
+    return res;
+}
+
+int32_t StartDlSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    if (!params->loader->checkDlPublicKey(&(params->epkPeer), params->largePrimeNumHex)) {
+        LOGE("CheckDlPublicKey failed.");
+        return HC_ERR_INVALID_PUBLIC_KEY;
+    }
+    int32_t res = StartDlExpMod(params, &(params->epkPeer), &(params->eskSelf), sharedSecret,
+        asyncLoader, onDone, ctx);
+    if (res != HC_SUCCESS) {
+        LOGE("Start BigNumExpMod for sharedSecret failed.");
+    }
+    return res;
+}
@@ -37,4 +37,28 @@ int32_t GenerateDlSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret)
     (void)sharedSecret;
     LOGE("PAKE-DL unsupported.");
     return HC_ERROR;
-}
\ No newline at end of file
+}
+
+int32_t StartDlPakeParams(PakeBaseParams *params, const Uint8Buff *secret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    (void)params;
+    (void)secret;
+    (void)asyncLoader;
+    (void)onDone;
+    (void)ctx;
+    LOGE("PAKE-DL unsupported.");
+    return HC_ERROR;
+}
+
+int32_t StartDlSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    (void)params;
+    (void)sharedSecret;
+    (void)asyncLoader;
+    (void)onDone;
+    (void)ctx;
+    LOGE("PAKE-DL unsupported.");
+    return HC_ERROR;
+}
@@ -62,7 +62,7 @@ static int32_t InitEcPakeParams(PakeBaseParams *params)
     return res;
 }
 
-int32_t GenerateEcPakeParams(PakeBaseParams *params, Uint8Buff *secret)
+static int32_t PrepareEcPakeParams(PakeBaseParams *params)
 {
     if (params->curveType == CURVE_256) {
         LOGE("Unsupport curve type.");
@@ -72,12 +72,20 @@ int32_t GenerateEcPakeParams(PakeBaseParams *params, Uint8Buff *secret)
     int32_t res = InitEcPakeParams(params);
     if (res != HC_SUCCESS) {
         LOGE("InitEcPakeParams failed, res: %d.", res);
-        goto err;
+        return res;
     }
 
     res = GenerateEsk(params);
     if (res != HC_SUCCESS) {
         LOGE("GenerateEsk failed, res: %d.", res);
+    }
+    return res;
+}
+
+int32_t GenerateEcPakeParams(PakeBaseParams *params, Uint8Buff *secret)
+{
+    int32_t res = PrepareEcPakeParams(params);
+    if (res != HC_SUCCESS) {
         goto err;
     }
 
@@ -116,4 +124,82 @@ int32_t GenerateEcSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret)
     }
 
     return res;
-}
\ No newline at end of file
+}
+
+/* The base comes from the hash of the secret, so the agreement of epkSelf is chained to it. */
+typedef struct {
+    PakeBaseParams *params;
+    const AsyncAlgLoader *asyncLoader;
+    AlgCompletionFunc onDone;
+    void *ctx;
+} EcPakeParamsChain;
+
+static void OnEcBaseDone(int32_t result, void *ctx)
+{
+    EcPakeParamsChain *chain = (EcPakeParamsChain *)ctx;
+    PakeBaseParams *params = chain->params;
+    AlgCompletionFunc onDone = chain->onDone;
+    void *doneCtx = chain->ctx;
+    const AsyncAlgLoader *asyncLoader = chain->asyncLoader;
+    HcFree(chain);
+    if (result != HC_SUCCESS) {
+        LOGE("HashToPoint from secret to base failed, res: %d.", result);
+        onDone(result, doneCtx);
+        return;
+    }
+    KeyBuff eskSelfBuff = { params->eskSelf.val, params->eskSelf.length, false };
+    KeyBuff baseBuff = { params->base.val, params->base.length, false };
+    int32_t res = asyncLoader->agreeSharedSecret(&eskSelfBuff, &baseBuff, X25519, &params->epkSelf,
+        onDone, doneCtx);
+    if (res != HC_SUCCESS) {
+        LOGE("Start AgreeSharedSecret failed, res: %d.", res);
+        onDone(res, doneCtx);
+    }
+}
+
+int32_t StartEcPakeParams(PakeBaseParams *params, const Uint8Buff *secret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    EcPakeParamsChain *chain = NULL;
+    int32_t res = PrepareEcPakeParams(params);
+    if (res != HC_SUCCESS) {
+        goto err;
+    }
+    chain = (EcPakeParamsChain *)HcMalloc(sizeof(EcPakeParamsChain), 0);
+    if (chain == NULL) {
+        res = HC_ERR_ALLOC_MEMORY;
+        goto err;
+    }
+    chain->params = params;
+    chain->asyncLoader = asyncLoader;
+    chain->onDone = onDone;
+    chain->ctx = ctx;
+    res = asyncLoader->hashToPoint(secret, X25519, &params->base, OnEcBaseDone, chain);
+    if (res != HC_SUCCESS) {
+        LOGE("Start HashToPoint from secret to base failed, res: %d.", res);
+        HcFree(chain);
+        goto err;
+    }
+    return res;
+err:
+    FreeAndCleanKey(&params->eskSelf);
+    FreeAndCleanKey(&params->base);
+    return res;
+}
+
+int32_t StartEcSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    if (params->curveType == CURVE_256) {
+        LOGE("Unsupport curve type.");
+        return HC_ERROR;
+    }
+
+    KeyBuff eskSelfBuff = { params->eskSelf.val, params->eskSelf.length, false };
+    KeyBuff epkPeerBuff = { params->epkPeer.val, params->epkPeer.length, false };
+    int32_t res = asyncLoader->agreeSharedSecret(&eskSelfBuff, &epkPeerBuff, X25519, sharedSecret, onDone, ctx);
+    if (res != HC_SUCCESS) {
+        LOGE("Start AgreeSharedSecret failed, res: %d.", res);
+    }
+    return res;
+}
@@ -37,4 +37,28 @@ int32_t GenerateEcSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret)
     (void)sharedSecret;
     LOGE("PAKE-EC unsupported.");
     return HC_ERROR;
-}
\ No newline at end of file
+}
+
+int32_t StartEcPakeParams(PakeBaseParams *params, const Uint8Buff *secret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    (void)params;
+    (void)secret;
+    (void)asyncLoader;
+    (void)onDone;
+    (void)ctx;
+    LOGE("PAKE-EC unsupported.");
+    return HC_ERROR;
+}
+
+int32_t StartEcSharedSecret(PakeBaseParams *params, Uint8Buff *sharedSecret, const AsyncAlgLoader *asyncLoader,
+    AlgCompletionFunc onDone, void *ctx)
+{
+    (void)params;
+    (void)sharedSecret;
+    (void)asyncLoader;
+    (void)onDone;
+    (void)ctx;
+    LOGE("PAKE-EC unsupported.");
+    return HC_ERROR;
+}
@@ -20,6 +20,14 @@
 #include "common_defs.h"
 #include "database_manager.h"
 
+/* Counters of the candidate groups of the auth sessions, since the start of the service. */
+typedef struct {
+    uint32_t finishCount; /* auths finished with a group */
+    uint32_t reorderCount; /* candidate lists which start with the group of the last successful auth */
+    uint32_t fallbackCount; /* retries with the next candidate group after a group failed */
+    uint32_t firstFailCount; /* sessions which fell back because their first candidate group failed */
+} AuthGroupStat;
+
 void InformLocalAuthError(const CJson *param, const DeviceAuthCallback *callback);
 void InformPeerAuthError(const CJson *param, const DeviceAuthCallback *callback);
 int32_t InformAuthError(AuthSession *session, const CJson *out, int errorCode);
@@ -34,5 +42,6 @@ void CreateAuthParamsVec(ParamsVec *vec);
 void DestroyAuthParamsVec(ParamsVec *vec);
 int32_t ReturnSessionKey(int64_t requestId, const CJson *authParam,
     const CJson *out, const DeviceAuthCallback *callback);
+void GetAuthGroupStat(AuthGroupStat *stat);
 
 #endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUTH_SESSION_RESUME_H
+#define AUTH_SESSION_RESUME_H
+
+#include "auth_session_common_defines.h"
+#include "json_utils.h"
+
+/*
+ * Resumption of the non-account auth.
+ *
+ * When both sides set FIELD_IS_RESUMABLE, a successful auth leaves a resumption secret on both sides, keyed by
+ * the peer udid and the group id. The PAKE task derives it from its own key with another info than the session
+ * key, so the application which gets the session key can't derive the secret. Within AUTH_RESUME_EXPIRE_TIME
+ * on the monotonic clock, the client can then get a new session key in one round trip:
+ *   client -> server: resumeStep 1, nonceC, HMAC(secret, client label || nonceC)
+ *   server -> client: resumeStep 2, nonceS, HMAC(secret, server label || nonceC || nonceS)
+ * The session key is HKDF(secret, nonceC || nonceS), and both sides replace the secret by another key derived
+ * the same way with another info, so a secret proves one resumption at most. A client whose resumption fails
+ * falls back to the full auth in the same session.
+ */
+
+#define AUTH_RESUME_EXPIRE_TIME 300
+#define AUTH_RESUME_CACHE_CAPACITY 32
+#define AUTH_RESUME_REQUEST 1
+#define AUTH_RESUME_RESPONSE 2
+
+int32_t InitAuthResumeCache(void);
+void DestroyAuthResumeCache(void);
+
+/* Called when a non-account auth finishes, it keeps a secret only if both sides asked for it. */
+void SaveAuthResumeSecret(const CJson *authParam, const CJson *out);
+
+/* Used by the client, it only keeps the flag if the peer also sent it. */
+void ProcessResumableFlag(const CJson *receiveData, CJson *authParam);
+
+/* Whether the param of authDevice asks to resume and a secret of the peer is kept. */
+bool IsAuthResumeRequested(const CJson *param);
+bool IsAuthResumeMsg(const CJson *in);
+/* Only a request starts the server side, the other resume messages belong to a client session. */
+bool IsAuthResumeRequest(const CJson *in);
+
+/*
+ * Send the resume request of a client session, its first param is the param of authDevice.
+ * @return HC_SUCCESS (sent), others (the session can't resume, nothing is sent)
+ */
+int32_t StartClientAuthResume(AuthSession *session);
+
+/*
+ * @return FINISH (the session key is returned), others (the session should fall back to the full auth)
+ */
+int32_t ProcessClientAuthResume(AuthSession *session, const CJson *in);
+
+void DestroyAuthResumeContext(AuthSession *session);
+
+/*
+ * Answer a resume request which the server application has accepted, the callbacks are called on success.
+ * The caller sends the error to the client on failure.
+ */
+int32_t ProcessServerAuthResume(const CJson *in, const CJson *confirmation, const DeviceAuthCallback *callback);
+
+void SendAuthResumeError(const CJson *in, const DeviceAuthCallback *callback, int32_t errorCode);
+
+#endif
@@ -25,4 +25,7 @@
 
 Session *CreateServerAuthSession(CJson *param, const DeviceAuthCallback *callback);
 
+/* Answer a resume request, which is sent instead of the first message of the full auth. */
+void ProcessServerAuthResumeMsg(CJson *in, const DeviceAuthCallback *callback);
+
 #endif
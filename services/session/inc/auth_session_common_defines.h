@@ -22,11 +22,14 @@
 
 DECLARE_HC_VECTOR(ParamsVec, void*)
 
+typedef struct AuthResumeContextT AuthResumeContext;
+
 typedef struct {
     Session base;
     int curTaskId;
     ParamsVec paramsList;
     uint32_t currentIndex;
+    AuthResumeContext *resumeCtx; /* not NULL while a client session resumes, see auth_session_resume.h */
 } AuthSession;
 
 typedef enum {
@@ -28,6 +28,7 @@ typedef struct {
     int operationCode;
     ChannelType channelType;
     bool isWaiting;
+    bool isBinaryWire;
     int64_t requestId;
     int64_t channelId;
     CJson *params;
@@ -42,7 +43,7 @@ void InformPeerModuleErrorIfNeed(CJson *out, const BindSession *session);
 void InitBindSession(int bindType, int operationCode, int64_t requestId, const DeviceAuthCallback *callback,
     BindSession *session);
 int32_t CreateAndProcessModule(BindSession *session, const CJson *in, CJson *out);
-int32_t ProcessModule(const BindSession *session, const CJson *in, CJson *out, int *status);
+int32_t ProcessModule(BindSession *session, const CJson *in, CJson *out, int *status);
 int32_t AddInfoToSendData(bool isNeedCompatibleInfo, const BindSession *session, CJson *data);
 int32_t GenerateBasicModuleParams(bool isClient, BindSession *session, CJson *moduleParams);
 int32_t GenerateBindParams(int isClient, const CJson *jsonParams, BindSession *session);
@@ -17,7 +17,25 @@
 #define SESSION_COMMON_H
 
 #include <stdint.h>
+#include "hc_mem_pool.h"
 #include "json_utils.h"
 
+/* the session structs which are allocated from the session pools */
+typedef enum {
+    SESSION_OBJ_AUTH = 0,
+    SESSION_OBJ_AUTH_LITE,
+    SESSION_OBJ_BIND,
+    SESSION_OBJ_BIND_LITE,
+    SESSION_OBJ_TYPE_NUM
+} SessionObjType;
+
 int GenerateSessionOrTaskId(int64_t *id);
+
+int32_t InitSessionObjPools(void);
+void DestroySessionObjPools(void);
+/* Allocate a zeroed session struct of the type, it is freed by FreeSessionObj with the same type. */
+void *AllocSessionObj(SessionObjType type);
+void FreeSessionObj(SessionObjType type, void *obj);
+/* Add up the usage of all the session pools. */
+void GetSessionObjStat(HcMemPoolStat *stat);
 #endif
\ No newline at end of file
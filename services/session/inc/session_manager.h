@@ -23,8 +23,8 @@
 #define BIND_TYPE 0
 #define AUTH_TYPE 1
 
-void InitSessionManager();
-void DestroySessionManager();
+int32_t InitSessionManager(void);
+void DestroySessionManager(void);
 
 bool IsRequestExist(int64_t requestId);
 
@@ -32,7 +32,25 @@ int32_t CreateSession(int64_t requestId, SessionTypeValue sessionType, CJson *pa
     const DeviceAuthCallback *callback);
 int32_t ProcessSession(int64_t requestId, int32_t type, CJson *in);
 void DestroySession(int64_t requestId);
+/*
+ * Fail the session at once: onError is called with the errorCode, and no message reaches the session any more.
+ * It is destroyed later by a task worker, so the caller may be in a callback of the session.
+ */
+void AbortSession(int64_t requestId, int32_t errorCode);
 void OnChannelOpened(int64_t requestId, int64_t channelId);
 void OnConfirmationReceived(int64_t requestId, CJson *returnData);
 
+/*
+ * The memory of the session structs and their registry entries, it does not count the json params
+ * and the tasks of the sessions.
+ */
+typedef struct {
+    uint32_t sessionCount;
+    uint32_t capacity;
+    uint32_t usedBytes;
+    uint32_t reservedBytes;
+} SessionMemoryStat;
+
+void GetSessionMemoryStat(SessionMemoryStat *stat);
+
 #endif
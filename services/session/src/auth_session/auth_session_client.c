@@ -15,6 +15,7 @@
 
 #include "auth_session_client.h"
 #include "auth_session_common.h"
+#include "auth_session_resume.h"
 #include "auth_session_util.h"
 #include "dev_auth_module_manager.h"
 #include "hc_log.h"
@@ -41,7 +42,7 @@ int32_t CheckInputAuthParams(const CJson *authParam)
 
 static AuthSession *InitClientAuthSession(const DeviceAuthCallback *callback, ParamsVec *authParamsVec)
 {
-    AuthSession *session = (AuthSession *)HcMalloc(sizeof(AuthSession), 0);
+    AuthSession *session = (AuthSession *)AllocSessionObj(SESSION_OBJ_AUTH);
     if (session == NULL) {
         LOGE("Failed to allocate memory for session!");
         DestroyAuthParamsVec(authParamsVec);
@@ -106,6 +107,7 @@ static int32_t StartClientAuthTask(AuthSession *session)
     return res;
 }
 
+/* @return HC_SUCCESS (not a group error), IGNORE_MSG (the next candidate group is started), others (error) */
 int32_t CheckClientGroupAuthMsg(AuthSession *session, const CJson *in)
 {
     int32_t GroupErrMsg = 0;
@@ -122,13 +124,50 @@ int32_t CheckClientGroupAuthMsg(AuthSession *session, const CJson *in)
         FreeJson(outData);
         return HC_ERR_JSON_FAIL;
     }
-    if (InformAuthError(session, outData, HC_ERR_PEER_ERROR) != HC_SUCCESS) {
+    uint32_t groupIndex = session->currentIndex;
+    int32_t res = InformAuthError(session, outData, HC_ERR_PEER_ERROR);
+    FreeJson(outData);
+    if ((res == HC_SUCCESS) && (session->currentIndex != groupIndex)) {
+        return IGNORE_MSG;
+    }
+    if (res != HC_SUCCESS) {
         LOGE("Failed to inform auth error!");
     }
-    FreeJson(outData);
     return HC_ERR_PEER_ERROR;
 }
 
+/* The only param of a resuming session is the param of authDevice, it is replaced by the candidate groups. */
+static int32_t StartClientFullAuth(AuthSession *session)
+{
+    CJson *param = (session->paramsList).get(&(session->paramsList), 0);
+    ParamsVec authParamsVec;
+    CreateAuthParamsVec(&authParamsVec);
+    int32_t res = GetAuthParamsList(param, &authParamsVec);
+    if ((res != HC_SUCCESS) || (authParamsVec.size(&authParamsVec) == 0)) {
+        LOGE("No candidate auth group!");
+        DestroyAuthParamsVec(&authParamsVec);
+        InformLocalAuthError(param, session->base.callback);
+        return (res != HC_SUCCESS) ? res : HC_ERR_NO_CANDIDATE_GROUP;
+    }
+    FreeJson(param);
+    DestroyAuthParamsVec(&session->paramsList);
+    session->paramsList = authParamsVec;
+    session->currentIndex = 0;
+    return StartClientAuthTask(session);
+}
+
+static int32_t ProcessClientResumeSession(AuthSession *session, const CJson *in)
+{
+    int32_t res = ProcessClientAuthResume(session, in);
+    if (res == FINISH) {
+        LOGI("End process client authSession, auth resumed successfully.");
+        return res;
+    }
+    DestroyAuthResumeContext(session);
+    LOGI("Failed to resume the auth, res = %d, start the full auth.", res);
+    return StartClientFullAuth(session);
+}
+
 static int32_t ProcessClientAuthSession(Session *session, CJson *in)
 {
     LOGI("Begin process client authSession.");
@@ -137,13 +176,21 @@ static int32_t ProcessClientAuthSession(Session *session, CJson *in)
         return HC_ERR_INVALID_PARAMS;
     }
     AuthSession *realSession = (AuthSession *)session;
+    if (realSession->resumeCtx != NULL) {
+        return ProcessClientResumeSession(realSession, in);
+    }
     CJson *paramInSession = (realSession->paramsList).get(&(realSession->paramsList), realSession->currentIndex);
     if (paramInSession == NULL) {
         LOGE("Failed to get param in session!");
         return HC_ERR_NULL_PTR;
     }
     ProcessDeviceLevel(in, paramInSession);
+    ProcessResumableFlag(in, paramInSession);
     int32_t res = CheckClientGroupAuthMsg(realSession, in);
+    if (res == IGNORE_MSG) {
+        LOGI("Peer device refused the group, the next candidate group is tried.");
+        return HC_SUCCESS;
+    }
     if (res != HC_SUCCESS) {
         LOGE("Peer device's group has error, so we stop client auth session!");
         return res;
@@ -196,6 +243,32 @@ static Session *CreateClientAuthSessionInner(CJson *param, const DeviceAuthCallb
     return (Session *)session;
 }
 
+static Session *CreateClientResumeSession(CJson *param, const DeviceAuthCallback *callback)
+{
+    CJson *paramInSession = DuplicateJson(param);
+    if (paramInSession == NULL) {
+        LOGE("Failed to duplicate auth param!");
+        return NULL;
+    }
+    ParamsVec authParamsVec;
+    CreateAuthParamsVec(&authParamsVec);
+    if (authParamsVec.pushBack(&authParamsVec, (const void **)&paramInSession) == NULL) {
+        LOGE("Failed to push auth param!");
+        FreeJson(paramInSession);
+        DestroyAuthParamsVec(&authParamsVec);
+        return NULL;
+    }
+    AuthSession *session = InitClientAuthSession(callback, &authParamsVec);
+    if (session == NULL) {
+        return NULL;
+    }
+    if (StartClientAuthResume(session) != HC_SUCCESS) {
+        DestroyAuthSession((Session *)session);
+        return NULL;
+    }
+    return (Session *)session;
+}
+
 Session *CreateClientAuthSession(CJson *param, const DeviceAuthCallback *callback)
 {
     Session *session = NULL;
@@ -209,6 +282,12 @@ Session *CreateClientAuthSession(CJson *param, const DeviceAuthCallback *callbac
         InformLocalAuthError(param, callback);
         return NULL;
     }
+    if (IsAuthResumeRequested(param)) {
+        session = CreateClientResumeSession(param, callback);
+        if (session != NULL) {
+            return session;
+        }
+    }
     session = CreateClientAuthSessionInner(param, callback);
     if (session == NULL) {
         LOGE("Failed to create client auth session!");
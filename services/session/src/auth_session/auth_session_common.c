@@ -17,15 +17,21 @@
 #include "account_related_group_auth.h"
 #include "account_unrelated_group_auth.h"
 #include "alg_defs.h"
+#include "auth_session_resume.h"
 #include "auth_session_util.h"
+#include "channel_manager.h"
 #include "common_defs.h"
 #include "common_util.h"
 #include "dev_auth_module_manager.h"
 #include "hc_log.h"
+#include "hc_time.h"
 #include "json_utils.h"
+#include "session_common.h"
 
 IMPLEMENT_HC_VECTOR(ParamsVec, void *, 1)
 
+static AuthGroupStat g_authGroupStat = { 0 };
+
 static bool IsOldFormatParams(const CJson *param)
 {
     int32_t authForm = AUTH_FORM_INVALID_TYPE;
@@ -329,6 +335,36 @@ static void GetGroupInfoByGroupId(const char *groupId, const char *peerUdid, con
     }
 }
 
+/* The group which authenticated the peer last is tried first, the order of the other groups is kept. */
+static void MoveLastSuccessGroupToFront(const char *peerUdid, const char *peerAuthId, GroupInfoVec *vec)
+{
+    uint32_t lastIndex = 0;
+    uint64_t lastTm = 0;
+    uint32_t size = vec->size(vec);
+    for (uint32_t i = 0; i < size; ++i) {
+        const GroupInfo *groupInfo = (const GroupInfo *)vec->get(vec, i);
+        const char *groupId = (groupInfo != NULL) ? StringGet(&groupInfo->id) : NULL;
+        if (groupId == NULL) {
+            continue;
+        }
+        uint64_t groupLastTm = GetTrustedDeviceLastTm(groupId, peerUdid, peerAuthId);
+        if (groupLastTm > lastTm) {
+            lastTm = groupLastTm;
+            lastIndex = i;
+        }
+    }
+    if (lastIndex == 0) {
+        return;
+    }
+    void *lastGroup = vec->get(vec, lastIndex);
+    for (uint32_t i = lastIndex; i > 0; --i) {
+        *(vec->getp(vec, i)) = vec->get(vec, i - 1);
+    }
+    *(vec->getp(vec, 0)) = lastGroup;
+    __atomic_add_fetch(&g_authGroupStat.reorderCount, 1, __ATOMIC_RELAXED);
+    LOGI("The group of the last successful auth is moved to the front, it was candidate %u.", lastIndex);
+}
+
 static int32_t GetCandidateAuthInfo(const char *groupId, const CJson *param, ParamsVec *authParamsVec)
 {
     const char *peerUdid = GetStringFromJson(param, FIELD_PEER_CONN_DEVICE_ID);
@@ -341,6 +377,9 @@ static int32_t GetCandidateAuthInfo(const char *groupId, const CJson *param, Par
     CreateGroupInfoVecStruct(&vec);
     if (groupId == NULL) {
         GetCandidateGroupInfo(param, peerUdid, peerAuthId, &vec);
+        if (vec.size(&vec) > 1) {
+            MoveLastSuccessGroupToFront(peerUdid, peerAuthId, &vec);
+        }
     } else {
         GetGroupInfoByGroupId(groupId, peerUdid, peerAuthId, &vec);
     }
@@ -373,6 +412,12 @@ static int32_t AddGroupAuthTransmitData(const AuthSession *session, CJson *sendT
         LOGE("Failed to get isClient!");
         return HC_ERR_JSON_GET;
     }
+    bool isResumable = false;
+    (void)GetBoolFromJson(authParam, FIELD_IS_RESUMABLE, &isResumable);
+    if (isResumable && (AddBoolToJson(sendToPeer, FIELD_IS_RESUMABLE, isResumable) != HC_SUCCESS)) {
+        LOGE("Failed to add resumable flag!");
+        return HC_ERR_JSON_FAIL;
+    }
     if (isClient && (session->currentIndex < (list.size(&list) - 1))) {
         const char *altGroup = GetStringFromJson(list.get(&list, session->currentIndex + 1), FIELD_SERVICE_TYPE);
         if ((altGroup != NULL) && (AddStringToJson(sendToPeer, FIELD_ALTERNATIVE, altGroup) != HC_SUCCESS)) {
@@ -406,25 +451,13 @@ static int32_t ReturnTransmitData(const AuthSession *session, CJson *out)
         LOGE("Failed to add extra data!");
         return ret;
     }
-    char *outStr = PackJsonToString(sendToPeer);
-    if (outStr == NULL) {
-        LOGE("Failed to pack outStr for onTransmit!");
-        return HC_ERR_ALLOC_MEMORY;
+    bool isBinaryWire = false;
+    (void)GetBoolFromJson(out, FIELD_IS_BINARY_WIRE, &isBinaryWire);
+    ret = HcSendJsonMsg(SERVICE_CHANNEL, requestId, DEFAULT_CHANNEL_ID, session->base.callback, sendToPeer,
+        isBinaryWire);
+    if (ret != HC_SUCCESS) {
+        LOGE("Failed to transmit data to peer!");
     }
-
-    const DeviceAuthCallback *callback = session->base.callback;
-    do {
-        if ((callback == NULL) || (callback->onTransmit == NULL)) {
-            LOGE("The callback for transmit is null!");
-            ret = HC_ERR_TRANSMIT_FAIL;
-            break;
-        }
-        if (!callback->onTransmit(requestId, (uint8_t *)outStr, (uint32_t)strlen(outStr) + 1)) {
-            LOGE("Failed to transmit data to peer!");
-            ret = HC_ERR_TRANSMIT_FAIL;
-        }
-    } while (0);
-    FreeJsonString(outStr);
     return ret;
 }
 
@@ -444,6 +477,21 @@ int32_t GetAuthParamsList(const CJson *param, ParamsVec *authParamsVec)
     return ret;
 }
 
+/* Keep the time of the successful auth, so that the next auth of the peer tries the same group first. */
+static void RecordLastSuccessGroup(const CJson *authParam)
+{
+    __atomic_add_fetch(&g_authGroupStat.finishCount, 1, __ATOMIC_RELAXED);
+    const char *groupId = GetStringFromJson(authParam, FIELD_GROUP_ID);
+    const char *peerUdid = GetStringFromJson(authParam, FIELD_PEER_CONN_DEVICE_ID);
+    int64_t curTime = HcGetRealTime();
+    if ((groupId == NULL) || (peerUdid == NULL) || (curTime <= 0)) {
+        return;
+    }
+    if (UpdateTrustedDeviceLastTm(groupId, peerUdid, (uint64_t)curTime) != HC_SUCCESS) {
+        LOGW("Failed to update the last auth time of the peer.");
+    }
+}
+
 static void ReturnFinishData(const AuthSession *session, const CJson *out)
 {
     if (out == NULL) {
@@ -466,6 +514,7 @@ static void ReturnFinishData(const AuthSession *session, const CJson *out)
         LOGE("Failed to get auth type!");
         return;
     }
+    RecordLastSuccessGroup(authParam);
     BaseGroupAuth *groupAuth = NULL;
     if (GetGroupAuth(GetGroupAuthType(authForm), &groupAuth) == HC_SUCCESS) {
         groupAuth->onFinish(requestId, authParam, out, session->base.callback);
@@ -590,6 +639,10 @@ static int32_t ProcessNextGroupIfPossible(AuthSession *session)
         return HC_ERR_NO_CANDIDATE_GROUP;
     }
     int32_t res;
+    __atomic_add_fetch(&g_authGroupStat.fallbackCount, 1, __ATOMIC_RELAXED);
+    if (session->currentIndex == 0) {
+        __atomic_add_fetch(&g_authGroupStat.firstFailCount, 1, __ATOMIC_RELAXED);
+    }
     session->currentIndex++;
     CJson *paramInNextSession = (session->paramsList).get(&(session->paramsList), session->currentIndex);
     if (paramInNextSession == NULL) {
@@ -659,6 +712,17 @@ void DeleteCachedData(CJson *paramInSession)
     DeleteItemFromJson(paramInSession, FIELD_OPERATION_CODE);
 }
 
+void GetAuthGroupStat(AuthGroupStat *stat)
+{
+    if (stat == NULL) {
+        return;
+    }
+    stat->finishCount = __atomic_load_n(&g_authGroupStat.finishCount, __ATOMIC_RELAXED);
+    stat->reorderCount = __atomic_load_n(&g_authGroupStat.reorderCount, __ATOMIC_RELAXED);
+    stat->fallbackCount = __atomic_load_n(&g_authGroupStat.fallbackCount, __ATOMIC_RELAXED);
+    stat->firstFailCount = __atomic_load_n(&g_authGroupStat.firstFailCount, __ATOMIC_RELAXED);
+}
+
 int32_t GetGroupAuthType(int32_t authForm)
 {
     switch (authForm) {
@@ -736,6 +800,7 @@ int32_t ProcessTaskStatusForAuth(const AuthSession *session, const CJson *param,
         case FINISH:
             ReturnFinishData(session, out);
             ClearSensitiveStringInJson(out, FIELD_SESSION_KEY);
+            ClearSensitiveStringInJson(GetObjFromJson(out, FIELD_SEND_TO_SELF), FIELD_RESUME_SECRET);
             res = FINISH;
             break;
         default:
@@ -754,6 +819,11 @@ int32_t CreateAndProcessTask(AuthSession *session, CJson *paramInSession, CJson
         LOGE("Failed to add pkg name to json!");
         return HC_ERR_JSON_FAIL;
     }
+    /* the auth session can wait for the crypto workers, its task is resumed by the request id */
+    if (AddBoolToJson(paramInSession, FIELD_IS_ASYNC_CRYPTO, true) != HC_SUCCESS) {
+        LOGE("Failed to add async crypto flag to json!");
+        return HC_ERR_JSON_FAIL;
+    }
     session->curTaskId = 0;
     int32_t res = CreateTask(&(session->curTaskId), paramInSession, out, moduleType);
     if (res != HC_SUCCESS) {
@@ -806,7 +876,12 @@ void DestroyAuthSession(Session *session)
         LOGE("The json data in session is null!");
         return;
     }
-    DestroyTask(realSession->curTaskId, GetAuthModuleType(paramInSession));
+    if (realSession->resumeCtx != NULL) {
+        /* no task is created while the session resumes */
+        DestroyAuthResumeContext(realSession);
+    } else {
+        DestroyTask(realSession->curTaskId, GetAuthModuleType(paramInSession));
+    }
 
     uint32_t index;
     void **paramsData = NULL;
@@ -816,7 +891,7 @@ void DestroyAuthSession(Session *session)
         }
     }
     DESTROY_HC_VECTOR(ParamsVec, &(realSession->paramsList))
-    HcFree(realSession);
+    FreeSessionObj(SESSION_OBJ_AUTH, realSession);
     realSession = NULL;
 }
 
@@ -0,0 +1,834 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "auth_session_resume.h"
+#include "alg_defs.h"
+#include "alg_loader.h"
+#include "channel_manager.h"
+#include "common_defs.h"
+#include "common_util.h"
+#include "database_manager.h"
+#include "device_auth_defines.h"
+#include "hc_dev_info.h"
+#include "hc_log.h"
+#include "hc_mutex.h"
+#include "hc_time.h"
+#include "hc_types.h"
+#include "securec.h"
+
+#define RESUME_NONCE_LEN 32
+#define RESUME_MAX_GROUP_ID_LEN 64
+#define RESUME_MAX_LABEL_LEN 32
+#define RESUME_CLIENT_LABEL "hichain_resume_client"
+#define RESUME_SERVER_LABEL "hichain_resume_server"
+#define RESUME_NEXT_SECRET_INFO "hichain_resume_next_secret"
+#define RESUME_SESSION_KEY_INFO "hichain_resume_session_key"
+
+typedef struct {
+    int64_t expireTime; /* 0 means the slot is empty */
+    uint64_t lastUse;
+    char peerUdid[MAX_INPUT_UDID_LEN + 1];
+    char groupId[RESUME_MAX_GROUP_ID_LEN + 1];
+    int32_t selfType;
+    int32_t peerType;
+    uint8_t secret[AUTH_RESUME_SECRET_LEN];
+} AuthResumeRecord;
+
+struct AuthResumeContextT {
+    AuthResumeRecord record;
+    int32_t keyLen;
+    uint8_t nonce[RESUME_NONCE_LEN];
+};
+
+static AuthResumeRecord g_resumeRecords[AUTH_RESUME_CACHE_CAPACITY];
+static uint64_t g_resumeClock = 0;
+static HcMutex g_resumeMutex;
+static bool g_isResumeCacheInit = false;
+
+static void ClearRecord(AuthResumeRecord *record)
+{
+    (void)memset_s(record, sizeof(AuthResumeRecord), 0, sizeof(AuthResumeRecord));
+}
+
+/*
+ * Called with the lock held, the expired records met on the way are cleared.
+ * HcGetCurTime reads CLOCK_MONOTONIC on both the linux and the liteos hals, so setting the system time can
+ * neither extend nor cut the life of a secret.
+ */
+static AuthResumeRecord *FindRecord(const char *peerUdid, const char *groupId)
+{
+    int64_t curTime = HcGetCurTime();
+    AuthResumeRecord *found = NULL;
+    for (uint32_t i = 0; i < AUTH_RESUME_CACHE_CAPACITY; ++i) {
+        AuthResumeRecord *record = &g_resumeRecords[i];
+        if (record->expireTime == 0) {
+            continue;
+        }
+        if ((curTime < 0) || (curTime >= record->expireTime)) {
+            ClearRecord(record);
+            continue;
+        }
+        if ((strcmp(record->peerUdid, peerUdid) != 0) ||
+            ((groupId != NULL) && (strcmp(record->groupId, groupId) != 0))) {
+            continue;
+        }
+        if ((found == NULL) || (record->lastUse > found->lastUse)) {
+            found = record;
+        }
+    }
+    return found;
+}
+
+/* Called with the lock held. */
+static void PutRecord(const AuthResumeRecord *record)
+{
+    AuthResumeRecord *slot = FindRecord(record->peerUdid, record->groupId);
+    if (slot == NULL) {
+        slot = &g_resumeRecords[0];
+        for (uint32_t i = 1; i < AUTH_RESUME_CACHE_CAPACITY; ++i) {
+            if (g_resumeRecords[i].lastUse < slot->lastUse) {
+                slot = &g_resumeRecords[i];
+            }
+        }
+    }
+    (void)memcpy_s(slot, sizeof(AuthResumeRecord), record, sizeof(AuthResumeRecord));
+    slot->lastUse = ++g_resumeClock;
+}
+
+/*
+ * Copy the record of a peer, the most recently used one if groupId is NULL.
+ */
+static bool CopyRecord(const char *peerUdid, const char *groupId, AuthResumeRecord *outRecord)
+{
+    if (!g_isResumeCacheInit) {
+        return false;
+    }
+    g_resumeMutex.lock(&g_resumeMutex);
+    AuthResumeRecord *record = FindRecord(peerUdid, groupId);
+    if (record != NULL) {
+        (void)memcpy_s(outRecord, sizeof(AuthResumeRecord), record, sizeof(AuthResumeRecord));
+    }
+    g_resumeMutex.unlock(&g_resumeMutex);
+    return (record != NULL);
+}
+
+/*
+ * Replace the secret of a record by the next one, unless another resumption has already replaced it.
+ * The expire time of the record is kept, so a chain of resumptions can't outlive the full auth.
+ */
+static bool ReplaceSecret(const AuthResumeRecord *oldRecord, const uint8_t *nextSecret)
+{
+    if (!g_isResumeCacheInit) {
+        return false;
+    }
+    g_resumeMutex.lock(&g_resumeMutex);
+    AuthResumeRecord *record = FindRecord(oldRecord->peerUdid, oldRecord->groupId);
+    bool isReplaced = (record != NULL) && (memcmp(record->secret, oldRecord->secret, AUTH_RESUME_SECRET_LEN) == 0);
+    if (isReplaced) {
+        (void)memcpy_s(record->secret, AUTH_RESUME_SECRET_LEN, nextSecret, AUTH_RESUME_SECRET_LEN);
+        record->lastUse = ++g_resumeClock;
+    }
+    g_resumeMutex.unlock(&g_resumeMutex);
+    return isReplaced;
+}
+
+/* Remove a record whose secret can't resume the auth, unless a newer auth has already replaced it. */
+static void RemoveRecord(const AuthResumeRecord *oldRecord)
+{
+    if (!g_isResumeCacheInit) {
+        return;
+    }
+    g_resumeMutex.lock(&g_resumeMutex);
+    AuthResumeRecord *record = FindRecord(oldRecord->peerUdid, oldRecord->groupId);
+    if ((record != NULL) && (memcmp(record->secret, oldRecord->secret, AUTH_RESUME_SECRET_LEN) == 0)) {
+        ClearRecord(record);
+    }
+    g_resumeMutex.unlock(&g_resumeMutex);
+}
+
+int32_t InitAuthResumeCache(void)
+{
+    if (g_isResumeCacheInit) {
+        return HC_SUCCESS;
+    }
+    if (InitHcMutex(&g_resumeMutex) != HC_SUCCESS) {
+        LOGE("Failed to init the mutex of the resume cache!");
+        return HC_ERR_INIT_FAILED;
+    }
+    (void)memset_s(g_resumeRecords, sizeof(g_resumeRecords), 0, sizeof(g_resumeRecords));
+    g_resumeClock = 0;
+    g_isResumeCacheInit = true;
+    return HC_SUCCESS;
+}
+
+void DestroyAuthResumeCache(void)
+{
+    if (!g_isResumeCacheInit) {
+        return;
+    }
+    g_isResumeCacheInit = false;
+    (void)memset_s(g_resumeRecords, sizeof(g_resumeRecords), 0, sizeof(g_resumeRecords));
+    DestroyHcMutex(&g_resumeMutex);
+}
+
+static int32_t GetFixedByteFromJson(const CJson *in, const char *key, uint8_t *byte, uint32_t len)
+{
+    const char *hexStr = GetStringFromJson(in, key);
+    if ((hexStr == NULL) || (strlen(hexStr) != len * BYTE_TO_HEX_OPER_LENGTH)) {
+        LOGE("Failed to get %s!", key);
+        return HC_ERR_JSON_GET;
+    }
+    if (HexStringToByte(hexStr, byte, len) != HC_SUCCESS) {
+        LOGE("Failed to convert %s!", key);
+        return HC_ERR_CONVERT_FAILED;
+    }
+    return HC_SUCCESS;
+}
+
+static int32_t DeriveKey(const Uint8Buff *baseKey, const Uint8Buff *salt, const char *info, Uint8Buff *outKey)
+{
+    Uint8Buff keyInfo = { (uint8_t *)info, HcStrlen(info) };
+    int32_t res = GetLoaderInstance()->computeHkdf(baseKey, salt, &keyInfo, outKey, false);
+    if (res != HC_SUCCESS) {
+        LOGE("Failed to derive the key of %s, res = %d!", info, res);
+    }
+    return res;
+}
+
+/* HMAC(secret, label || nonceC || nonceS), nonceS is NULL for the client. */
+static int32_t ComputeResumeMac(const uint8_t *secret, const char *label, const uint8_t *nonceC,
+    const uint8_t *nonceS, uint8_t *outMac)
+{
+    uint8_t message[RESUME_MAX_LABEL_LEN + RESUME_NONCE_LEN + RESUME_NONCE_LEN] = { 0 };
+    uint32_t labelLen = HcStrlen(label);
+    if (labelLen > RESUME_MAX_LABEL_LEN) {
+        return HC_ERR_INVALID_LEN;
+    }
+    uint32_t messageLen = labelLen + RESUME_NONCE_LEN;
+    (void)memcpy_s(message, sizeof(message), label, labelLen);
+    (void)memcpy_s(message + labelLen, sizeof(message) - labelLen, nonceC, RESUME_NONCE_LEN);
+    if (nonceS != NULL) {
+        (void)memcpy_s(message + messageLen, sizeof(message) - messageLen, nonceS, RESUME_NONCE_LEN);
+        messageLen += RESUME_NONCE_LEN;
+    }
+    Uint8Buff keyBuff = { (uint8_t *)secret, AUTH_RESUME_SECRET_LEN };
+    Uint8Buff messageBuff = { message, messageLen };
+    Uint8Buff macBuff = { outMac, HMAC_LEN };
+    int32_t res = GetLoaderInstance()->computeHmac(&keyBuff, &messageBuff, &macBuff, false);
+    if (res != HC_SUCCESS) {
+        LOGE("Failed to compute the resume mac, res = %d!", res);
+    }
+    return res;
+}
+
+static int32_t VerifyResumeMac(const uint8_t *secret, const char *label, const uint8_t *nonceC,
+    const uint8_t *nonceS, const uint8_t *peerMac)
+{
+    uint8_t mac[HMAC_LEN] = { 0 };
+    int32_t res = ComputeResumeMac(secret, label, nonceC, nonceS, mac);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    uint8_t diff = 0;
+    for (uint32_t i = 0; i < HMAC_LEN; ++i) {
+        diff |= mac[i] ^ peerMac[i];
+    }
+    if (diff != 0) {
+        LOGE("The resume mac of the peer doesn't match!");
+        return HC_ERR_PROOF_NOT_MATCH;
+    }
+    return HC_SUCCESS;
+}
+
+/* The session key and the next secret, both from HKDF(secret, nonceC || nonceS). */
+static int32_t DeriveResumedKeys(const AuthResumeRecord *record, const uint8_t *nonceC, const uint8_t *nonceS,
+    Uint8Buff *sessionKey, uint8_t *nextSecret)
+{
+    uint8_t salt[RESUME_NONCE_LEN + RESUME_NONCE_LEN] = { 0 };
+    (void)memcpy_s(salt, sizeof(salt), nonceC, RESUME_NONCE_LEN);
+    (void)memcpy_s(salt + RESUME_NONCE_LEN, sizeof(salt) - RESUME_NONCE_LEN, nonceS, RESUME_NONCE_LEN);
+    Uint8Buff saltBuff = { salt, sizeof(salt) };
+    Uint8Buff secretBuff = { (uint8_t *)record->secret, AUTH_RESUME_SECRET_LEN };
+    int32_t res = DeriveKey(&secretBuff, &saltBuff, RESUME_SESSION_KEY_INFO, sessionKey);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    Uint8Buff nextSecretBuff = { nextSecret, AUTH_RESUME_SECRET_LEN };
+    return DeriveKey(&secretBuff, &saltBuff, RESUME_NEXT_SECRET_INFO, &nextSecretBuff);
+}
+
+static int32_t InitRecordByAuthParam(const CJson *authParam, AuthResumeRecord *record)
+{
+    const char *groupId = GetStringFromJson(authParam, FIELD_GROUP_ID);
+    const char *serviceType = GetStringFromJson(authParam, FIELD_SERVICE_TYPE);
+    const char *peerUdid = GetStringFromJson(authParam, FIELD_PEER_CONN_DEVICE_ID);
+    if ((groupId == NULL) || (serviceType == NULL) || (peerUdid == NULL)) {
+        LOGE("Failed to get the ids of the auth!");
+        return HC_ERR_JSON_GET;
+    }
+    /* the compatible groups authenticate with a service type of their own, they are not resumed */
+    if (strcmp(groupId, serviceType) != 0) {
+        LOGI("The auth of a compatible group is not resumable.");
+        return HC_ERR_NOT_SUPPORT;
+    }
+    if ((strcpy_s(record->groupId, sizeof(record->groupId), groupId) != EOK) ||
+        (strcpy_s(record->peerUdid, sizeof(record->peerUdid), peerUdid) != EOK)) {
+        LOGE("The group id or the udid is too long to resume!");
+        return HC_ERR_INVALID_LEN;
+    }
+    if ((GetIntFromJson(authParam, FIELD_SELF_TYPE, &record->selfType) != HC_SUCCESS) ||
+        (GetIntFromJson(authParam, FIELD_PEER_USER_TYPE, &record->peerType) != HC_SUCCESS)) {
+        LOGE("Failed to get the device types of the auth!");
+        return HC_ERR_JSON_GET;
+    }
+    return HC_SUCCESS;
+}
+
+/* The PAKE task derives the secret from its own key, the session key returned to the application is not used. */
+static int32_t GetSecretOfPake(const CJson *out, AuthResumeRecord *record)
+{
+    const CJson *sendToSelf = GetObjFromJson(out, FIELD_SEND_TO_SELF);
+    if (sendToSelf == NULL) {
+        LOGE("No data to send to self!");
+        return HC_ERR_LOST_DATA;
+    }
+    return GetFixedByteFromJson(sendToSelf, FIELD_RESUME_SECRET, record->secret, AUTH_RESUME_SECRET_LEN);
+}
+
+void SaveAuthResumeSecret(const CJson *authParam, const CJson *out)
+{
+    bool isResumable = false;
+    (void)GetBoolFromJson(authParam, FIELD_IS_RESUMABLE, &isResumable);
+    if (!isResumable || !g_isResumeCacheInit) {
+        return;
+    }
+    bool isClient = false;
+    (void)GetBoolFromJson(authParam, FIELD_IS_CLIENT, &isClient);
+    bool isPeerResumable = !isClient; /* the flag of the server is already combined with the one of the client */
+    (void)GetBoolFromJson(authParam, FIELD_IS_PEER_RESUMABLE, &isPeerResumable);
+    if (!isPeerResumable) {
+        LOGI("The peer doesn't resume the auth.");
+        return;
+    }
+    AuthResumeRecord record;
+    (void)memset_s(&record, sizeof(record), 0, sizeof(record));
+    if ((InitRecordByAuthParam(authParam, &record) != HC_SUCCESS) ||
+        (GetSecretOfPake(out, &record) != HC_SUCCESS)) {
+        ClearRecord(&record);
+        return;
+    }
+    int64_t curTime = HcGetCurTime();
+    if (curTime >= 0) {
+        record.expireTime = curTime + AUTH_RESUME_EXPIRE_TIME;
+        g_resumeMutex.lock(&g_resumeMutex);
+        PutRecord(&record);
+        g_resumeMutex.unlock(&g_resumeMutex);
+        LOGI("The auth can be resumed in %d seconds.", AUTH_RESUME_EXPIRE_TIME);
+    }
+    ClearRecord(&record);
+}
+
+void ProcessResumableFlag(const CJson *receiveData, CJson *authParam)
+{
+    bool isPeerResumable = false;
+    (void)GetBoolFromJson(receiveData, FIELD_IS_RESUMABLE, &isPeerResumable);
+    if (isPeerResumable && (AddBoolToJson(authParam, FIELD_IS_PEER_RESUMABLE, true) != HC_SUCCESS)) {
+        LOGE("Failed to add the resumable flag of the peer!");
+    }
+}
+
+static const char *GetGroupIdOfParam(const CJson *param)
+{
+    const char *groupId = GetStringFromJson(param, FIELD_GROUP_ID);
+    if (groupId == NULL) {
+        groupId = GetStringFromJson(param, FIELD_SERVICE_TYPE);
+    }
+    return groupId;
+}
+
+bool IsAuthResumeRequested(const CJson *param)
+{
+    bool isResumable = false;
+    (void)GetBoolFromJson(param, FIELD_IS_RESUMABLE, &isResumable);
+    const char *peerUdid = GetStringFromJson(param, FIELD_PEER_CONN_DEVICE_ID);
+    if (!isResumable || (peerUdid == NULL) || !g_isResumeCacheInit) {
+        return false;
+    }
+    g_resumeMutex.lock(&g_resumeMutex);
+    bool hasSecret = (FindRecord(peerUdid, GetGroupIdOfParam(param)) != NULL);
+    g_resumeMutex.unlock(&g_resumeMutex);
+    if (!hasSecret) {
+        LOGI("No resumption secret of the peer.");
+    }
+    return hasSecret;
+}
+
+bool IsAuthResumeMsg(const CJson *in)
+{
+    int32_t step = 0;
+    return (GetIntFromJson(in, FIELD_RESUME_STEP, &step) == HC_SUCCESS);
+}
+
+bool IsAuthResumeRequest(const CJson *in)
+{
+    int32_t step = 0;
+    return (GetIntFromJson(in, FIELD_RESUME_STEP, &step) == HC_SUCCESS) && (step == AUTH_RESUME_REQUEST);
+}
+
+static int32_t SendResumeMsg(const CJson *param, const DeviceAuthCallback *callback, const CJson *msg)
+{
+    int64_t requestId = 0;
+    if (GetByteFromJson(param, FIELD_REQUEST_ID, (uint8_t *)&requestId, sizeof(int64_t)) != HC_SUCCESS) {
+        LOGE("Failed to get request id!");
+        return HC_ERR_JSON_GET;
+    }
+    int32_t res = HcSendJsonMsg(SERVICE_CHANNEL, requestId, DEFAULT_CHANNEL_ID, callback, msg, false);
+    if (res != HC_SUCCESS) {
+        LOGE("Failed to send the resume message!");
+    }
+    return res;
+}
+
+static int32_t ReturnResumedResult(const CJson *param, const AuthResumeRecord *record, const Uint8Buff *sessionKey,
+    const DeviceAuthCallback *callback)
+{
+    int64_t requestId = 0;
+    if (GetByteFromJson(param, FIELD_REQUEST_ID, (uint8_t *)&requestId, sizeof(int64_t)) != HC_SUCCESS) {
+        LOGE("Failed to get request id!");
+        return HC_ERR_JSON_GET;
+    }
+    if ((callback == NULL) || (callback->onSessionKeyReturned == NULL)) {
+        LOGE("The callback of onSessionKeyReturned is null!");
+        return HC_ERR_INVALID_PARAMS;
+    }
+    callback->onSessionKeyReturned(requestId, sessionKey->val, sessionKey->length);
+    CJson *returnToSelf = CreateJson();
+    if (returnToSelf == NULL) {
+        LOGE("Create json failed!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    char *returnStr = NULL;
+    if ((AddStringToJson(returnToSelf, FIELD_GROUP_ID, record->groupId) == HC_SUCCESS) &&
+        (AddStringToJson(returnToSelf, FIELD_PEER_CONN_DEVICE_ID, record->peerUdid) == HC_SUCCESS) &&
+        (AddIntToJson(returnToSelf, FIELD_USER_TYPE, record->selfType) == HC_SUCCESS) &&
+        (AddIntToJson(returnToSelf, FIELD_PEER_USER_TYPE, record->peerType) == HC_SUCCESS) &&
+        (AddByteToJson(returnToSelf, FIELD_SESSION_KEY, sessionKey->val, sessionKey->length) == HC_SUCCESS)) {
+        returnStr = PackJsonToString(returnToSelf);
+    }
+    ClearSensitiveStringInJson(returnToSelf, FIELD_SESSION_KEY);
+    FreeJson(returnToSelf);
+    if (returnStr == NULL) {
+        LOGE("Failed to pack returnToSelf for onFinish!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    if (callback->onFinish != NULL) {
+        callback->onFinish(requestId, AUTH_FORM_ACCOUNT_UNRELATED, returnStr);
+    }
+    ClearAndFreeJsonString(returnStr);
+    return HC_SUCCESS;
+}
+
+/* The server shows the auth id of the client to its application like the full auth does. */
+static int32_t AddSelfAuthIdToRequest(const char *groupId, CJson *request)
+{
+    char *localUdid = NULL;
+    if (GetLocalDevUdid(&localUdid) != HC_SUCCESS) {
+        LOGE("Failed to get local udid!");
+        return HC_ERROR;
+    }
+    DeviceInfo *localInfo = CreateDeviceInfoStruct();
+    if (localInfo == NULL) {
+        LOGE("Failed to allocate memory for localInfo!");
+        DestroyUdid(&localUdid);
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    char *authIdHex = NULL;
+    int32_t res = GetDeviceInfoForDevAuth(localUdid, groupId, localInfo);
+    do {
+        if (res != HC_SUCCESS) {
+            LOGE("Failed to get local device info from database!");
+            break;
+        }
+        const char *authId = StringGet(&localInfo->authId);
+        uint32_t authIdLen = (authId == NULL) ? 0 : HcStrlen(authId);
+        if ((authIdLen == 0) || (authIdLen > MAX_AUTH_ID_LEN / BYTE_TO_HEX_OPER_LENGTH)) {
+            LOGE("Invalid len of the local auth id!");
+            res = HC_ERR_INVALID_LEN;
+            break;
+        }
+        uint32_t authIdHexLen = authIdLen * BYTE_TO_HEX_OPER_LENGTH + 1;
+        authIdHex = (char *)HcMalloc(authIdHexLen, 0);
+        if (authIdHex == NULL) {
+            res = HC_ERR_ALLOC_MEMORY;
+            break;
+        }
+        res = ByteToHexString((const uint8_t *)authId, authIdLen, authIdHex, authIdHexLen);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        res = AddStringToJson(request, FIELD_PEER_AUTH_ID, authIdHex);
+    } while (0);
+    HcFree(authIdHex);
+    DestroyDeviceInfoStruct(localInfo);
+    DestroyUdid(&localUdid);
+    return res;
+}
+
+static int32_t BuildResumeRequest(const AuthResumeContext *ctx, CJson *request)
+{
+    const AuthResumeRecord *record = &ctx->record;
+    uint8_t mac[HMAC_LEN] = { 0 };
+    int32_t res = ComputeResumeMac(record->secret, RESUME_CLIENT_LABEL, ctx->nonce, NULL, mac);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    res = AddSelfAuthIdToRequest(record->groupId, request);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    if ((AddIntToJson(request, FIELD_RESUME_STEP, AUTH_RESUME_REQUEST) != HC_SUCCESS) ||
+        (AddIntToJson(request, FIELD_AUTH_FORM, AUTH_FORM_ACCOUNT_UNRELATED) != HC_SUCCESS) ||
+        (AddStringToJson(request, FIELD_PKG_NAME, GROUP_MANAGER_PACKAGE_NAME) != HC_SUCCESS) ||
+        (AddStringToJson(request, FIELD_SERVICE_TYPE, record->groupId) != HC_SUCCESS) ||
+        (AddIntToJson(request, FIELD_PEER_USER_TYPE, record->selfType) != HC_SUCCESS) ||
+        (AddIntToJson(request, FIELD_KEY_LENGTH, ctx->keyLen) != HC_SUCCESS) ||
+        (AddByteToJson(request, FIELD_RESUME_NONCE, ctx->nonce, RESUME_NONCE_LEN) != HC_SUCCESS) ||
+        (AddByteToJson(request, FIELD_RESUME_MAC, mac, HMAC_LEN) != HC_SUCCESS)) {
+        LOGE("Failed to build the resume request!");
+        return HC_ERR_JSON_FAIL;
+    }
+    return HC_SUCCESS;
+}
+
+static int32_t CheckClientRecord(const CJson *param, const AuthResumeRecord *record)
+{
+    const char *pkgName = GetStringFromJson(param, FIELD_SERVICE_PKG_NAME);
+    if ((pkgName == NULL) || !IsGroupAccessible(record->groupId, pkgName)) {
+        LOGI("The caller can't access the group of the resumption secret.");
+        return HC_ERR_ACCESS_DENIED;
+    }
+    if (!IsTrustedDeviceInGroup(record->groupId, record->peerUdid)) {
+        LOGI("The peer is no longer trusted in the group of the resumption secret.");
+        return HC_ERR_DEVICE_NOT_EXIST;
+    }
+    return HC_SUCCESS;
+}
+
+static void DestroyContext(AuthResumeContext *ctx)
+{
+    (void)memset_s(ctx, sizeof(AuthResumeContext), 0, sizeof(AuthResumeContext));
+    HcFree(ctx);
+}
+
+int32_t StartClientAuthResume(AuthSession *session)
+{
+    CJson *param = (session->paramsList).get(&(session->paramsList), 0);
+    const char *peerUdid = GetStringFromJson(param, FIELD_PEER_CONN_DEVICE_ID);
+    if (peerUdid == NULL) {
+        LOGI("The udid of the peer is unknown, the auth can't be resumed.");
+        return HC_ERR_NOT_SUPPORT;
+    }
+    const char *groupId = GetGroupIdOfParam(param);
+    AuthResumeContext *ctx = (AuthResumeContext *)HcMalloc(sizeof(AuthResumeContext), 0);
+    if (ctx == NULL) {
+        LOGE("Failed to allocate memory for the resume context!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    if (!CopyRecord(peerUdid, groupId, &ctx->record)) {
+        LOGI("The resumption secret of the peer has expired.");
+        DestroyContext(ctx);
+        return HC_ERR_KEY_NOT_EXIST;
+    }
+    ctx->keyLen = DEFAULT_RETURN_KEY_LENGTH;
+    (void)GetIntFromJson(param, FIELD_KEY_LENGTH, &ctx->keyLen);
+    Uint8Buff nonceBuff = { ctx->nonce, RESUME_NONCE_LEN };
+    int32_t res = CheckClientRecord(param, &ctx->record);
+    if (res == HC_SUCCESS) {
+        res = GetLoaderInstance()->generateRandom(&nonceBuff);
+    }
+    CJson *request = (res == HC_SUCCESS) ? CreateJson() : NULL;
+    if ((res == HC_SUCCESS) && (request == NULL)) {
+        res = HC_ERR_ALLOC_MEMORY;
+    }
+    if (res == HC_SUCCESS) {
+        res = BuildResumeRequest(ctx, request);
+    }
+    if (res == HC_SUCCESS) {
+        res = SendResumeMsg(param, session->base.callback, request);
+    }
+    FreeJson(request);
+    if (res != HC_SUCCESS) {
+        DestroyContext(ctx);
+        return res;
+    }
+    LOGI("Send the resume request.");
+    session->resumeCtx = ctx;
+    return HC_SUCCESS;
+}
+
+static int32_t ProcessResumeResponse(AuthSession *session, const CJson *in)
+{
+    AuthResumeContext *ctx = session->resumeCtx;
+    int32_t step = 0;
+    if ((GetIntFromJson(in, FIELD_RESUME_STEP, &step) != HC_SUCCESS) || (step != AUTH_RESUME_RESPONSE)) {
+        LOGE("The peer doesn't answer the resume request!");
+        return HC_ERR_BAD_MESSAGE;
+    }
+    int32_t peerError = HC_SUCCESS;
+    if (GetIntFromJson(in, FIELD_ERROR_CODE, &peerError) == HC_SUCCESS) {
+        LOGI("The peer refuses to resume the auth, res = %d.", peerError);
+        return HC_ERR_PEER_ERROR;
+    }
+    uint8_t peerNonce[RESUME_NONCE_LEN] = { 0 };
+    uint8_t peerMac[HMAC_LEN] = { 0 };
+    int32_t res = GetFixedByteFromJson(in, FIELD_RESUME_NONCE, peerNonce, RESUME_NONCE_LEN);
+    if (res == HC_SUCCESS) {
+        res = GetFixedByteFromJson(in, FIELD_RESUME_MAC, peerMac, HMAC_LEN);
+    }
+    if (res == HC_SUCCESS) {
+        res = VerifyResumeMac(ctx->record.secret, RESUME_SERVER_LABEL, ctx->nonce, peerNonce, peerMac);
+    }
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    uint8_t *sessionKey = (uint8_t *)HcMalloc(ctx->keyLen, 0);
+    if (sessionKey == NULL) {
+        LOGE("Failed to allocate memory for sessionKey!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    Uint8Buff keyBuff = { sessionKey, ctx->keyLen };
+    uint8_t nextSecret[AUTH_RESUME_SECRET_LEN] = { 0 };
+    res = DeriveResumedKeys(&ctx->record, ctx->nonce, peerNonce, &keyBuff, nextSecret);
+    if (res == HC_SUCCESS) {
+        (void)ReplaceSecret(&ctx->record, nextSecret);
+        CJson *param = (session->paramsList).get(&(session->paramsList), 0);
+        res = ReturnResumedResult(param, &ctx->record, &keyBuff, session->base.callback);
+    }
+    (void)memset_s(nextSecret, sizeof(nextSecret), 0, sizeof(nextSecret));
+    (void)memset_s(sessionKey, ctx->keyLen, 0, ctx->keyLen);
+    HcFree(sessionKey);
+    return (res == HC_SUCCESS) ? FINISH : res;
+}
+
+int32_t ProcessClientAuthResume(AuthSession *session, const CJson *in)
+{
+    int32_t res = ProcessResumeResponse(session, in);
+    if (res != FINISH) {
+        /* the server has no secret or refuses it, the full auth makes a new one if the server still resumes */
+        RemoveRecord(&session->resumeCtx->record);
+    }
+    return res;
+}
+
+void DestroyAuthResumeContext(AuthSession *session)
+{
+    if (session->resumeCtx == NULL) {
+        return;
+    }
+    DestroyContext(session->resumeCtx);
+    session->resumeCtx = NULL;
+}
+
+/* The udid set by the server application, or the one of the auth id sent by the client. */
+static int32_t GetPeerUdidOfRequest(const CJson *in, const CJson *confirmation, const char *groupId,
+    char *peerUdid, uint32_t peerUdidSize)
+{
+    const char *confirmedUdid = GetStringFromJson(confirmation, FIELD_PEER_CONN_DEVICE_ID);
+    if (confirmedUdid != NULL) {
+        return (strcpy_s(peerUdid, peerUdidSize, confirmedUdid) == EOK) ? HC_SUCCESS : HC_ERR_INVALID_LEN;
+    }
+    const char *authIdHex = GetStringFromJson(in, FIELD_PEER_AUTH_ID);
+    uint32_t authIdHexLen = (authIdHex == NULL) ? 0 : HcStrlen(authIdHex);
+    if ((authIdHexLen == 0) || (authIdHexLen > MAX_AUTH_ID_LEN)) {
+        LOGE("Invalid auth id of the client!");
+        return HC_ERR_JSON_GET;
+    }
+    char authId[MAX_AUTH_ID_LEN / BYTE_TO_HEX_OPER_LENGTH + 1] = { 0 };
+    if (HexStringToByte(authIdHex, (uint8_t *)authId, sizeof(authId) - 1) != HC_SUCCESS) {
+        LOGE("Failed to convert the auth id of the client!");
+        return HC_ERR_CONVERT_FAILED;
+    }
+    DeviceInfo *peerInfo = CreateDeviceInfoStruct();
+    if (peerInfo == NULL) {
+        LOGE("Failed to allocate memory for peerInfo!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    int32_t res = GetDeviceInfoByAuthId(authId, groupId, peerInfo);
+    if (res == HC_SUCCESS) {
+        const char *udid = StringGet(&peerInfo->udid);
+        if ((udid == NULL) || (strcpy_s(peerUdid, peerUdidSize, udid) != EOK)) {
+            res = HC_ERR_DB;
+        }
+    } else {
+        LOGE("The client is not in the group!");
+    }
+    DestroyDeviceInfoStruct(peerInfo);
+    return res;
+}
+
+static int32_t CheckServerRequest(const CJson *in, const CJson *confirmation, AuthResumeRecord *record)
+{
+    if (!IsAuthResumeRequest(in)) {
+        LOGE("The message is not a resume request!");
+        return HC_ERR_BAD_MESSAGE;
+    }
+    bool isResumable = false;
+    (void)GetBoolFromJson(confirmation, FIELD_IS_RESUMABLE, &isResumable);
+    if (!isResumable) {
+        LOGI("The server application doesn't resume the auth.");
+        return HC_ERR_NOT_SUPPORT;
+    }
+    const char *groupId = GetStringFromJson(in, FIELD_SERVICE_TYPE);
+    const char *pkgName = GetStringFromJson(confirmation, FIELD_SERVICE_PKG_NAME);
+    if ((groupId == NULL) || (pkgName == NULL) || !IsGroupAccessible(groupId, pkgName)) {
+        LOGE("The server application can't access the group to resume!");
+        return HC_ERR_ACCESS_DENIED;
+    }
+    char peerUdid[MAX_INPUT_UDID_LEN + 1] = { 0 };
+    int32_t res = GetPeerUdidOfRequest(in, confirmation, groupId, peerUdid, sizeof(peerUdid));
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    if (!IsTrustedDeviceInGroup(groupId, peerUdid)) {
+        LOGE("The client is no longer trusted in the group!");
+        return HC_ERR_DEVICE_NOT_EXIST;
+    }
+    if (!CopyRecord(peerUdid, groupId, record)) {
+        LOGI("No resumption secret of the client.");
+        return HC_ERR_KEY_NOT_EXIST;
+    }
+    return HC_SUCCESS;
+}
+
+static int32_t SendResumeResponse(const CJson *in, const DeviceAuthCallback *callback, const uint8_t *nonce,
+    const uint8_t *mac)
+{
+    CJson *response = CreateJson();
+    if (response == NULL) {
+        LOGE("Failed to create the resume response!");
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    int32_t res = HC_ERR_JSON_FAIL;
+    if ((AddIntToJson(response, FIELD_RESUME_STEP, AUTH_RESUME_RESPONSE) == HC_SUCCESS) &&
+        (AddByteToJson(response, FIELD_RESUME_NONCE, nonce, RESUME_NONCE_LEN) == HC_SUCCESS) &&
+        (AddByteToJson(response, FIELD_RESUME_MAC, mac, HMAC_LEN) == HC_SUCCESS)) {
+        res = SendResumeMsg(in, callback, response);
+    }
+    FreeJson(response);
+    return res;
+}
+
+static int32_t AnswerResumeRequest(const CJson *in, const DeviceAuthCallback *callback,
+    const AuthResumeRecord *record, const uint8_t *peerNonce, Uint8Buff *sessionKey)
+{
+    uint8_t nonce[RESUME_NONCE_LEN] = { 0 };
+    Uint8Buff nonceBuff = { nonce, RESUME_NONCE_LEN };
+    int32_t res = GetLoaderInstance()->generateRandom(&nonceBuff);
+    if (res != HC_SUCCESS) {
+        LOGE("Failed to generate the resume nonce!");
+        return res;
+    }
+    uint8_t nextSecret[AUTH_RESUME_SECRET_LEN] = { 0 };
+    uint8_t mac[HMAC_LEN] = { 0 };
+    do {
+        res = DeriveResumedKeys(record, peerNonce, nonce, sessionKey, nextSecret);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        res = ComputeResumeMac(record->secret, RESUME_SERVER_LABEL, peerNonce, nonce, mac);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        /* the secret is used up before the answer is sent, so a replayed request can't be answered again */
+        if (!ReplaceSecret(record, nextSecret)) {
+            LOGE("The resumption secret is used by another resumption!");
+            res = HC_ERR_KEY_NOT_EXIST;
+            break;
+        }
+        res = SendResumeResponse(in, callback, nonce, mac);
+    } while (0);
+    (void)memset_s(nextSecret, sizeof(nextSecret), 0, sizeof(nextSecret));
+    return res;
+}
+
+int32_t ProcessServerAuthResume(const CJson *in, const CJson *confirmation, const DeviceAuthCallback *callback)
+{
+    AuthResumeRecord record;
+    (void)memset_s(&record, sizeof(record), 0, sizeof(record));
+    int32_t res = CheckServerRequest(in, confirmation, &record);
+    if (res != HC_SUCCESS) {
+        return res;
+    }
+    uint8_t peerNonce[RESUME_NONCE_LEN] = { 0 };
+    uint8_t peerMac[HMAC_LEN] = { 0 };
+    int32_t keyLen = DEFAULT_RETURN_KEY_LENGTH;
+    (void)GetIntFromJson(in, FIELD_KEY_LENGTH, &keyLen);
+    uint8_t *sessionKey = NULL;
+    do {
+        if ((keyLen < MIN_KEY_LENGTH) || (keyLen > MAX_KEY_LENGTH)) {
+            LOGE("The key length is invalid!");
+            res = HC_ERR_INVALID_LEN;
+            break;
+        }
+        res = GetFixedByteFromJson(in, FIELD_RESUME_NONCE, peerNonce, RESUME_NONCE_LEN);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        res = GetFixedByteFromJson(in, FIELD_RESUME_MAC, peerMac, HMAC_LEN);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        res = VerifyResumeMac(record.secret, RESUME_CLIENT_LABEL, peerNonce, NULL, peerMac);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        sessionKey = (uint8_t *)HcMalloc(keyLen, 0);
+        if (sessionKey == NULL) {
+            LOGE("Failed to allocate memory for sessionKey!");
+            res = HC_ERR_ALLOC_MEMORY;
+            break;
+        }
+        Uint8Buff keyBuff = { sessionKey, keyLen };
+        res = AnswerResumeRequest(in, callback, &record, peerNonce, &keyBuff);
+        if (res != HC_SUCCESS) {
+            break;
+        }
+        LOGI("The auth is resumed.");
+        /* the client has its key, there is nothing to tell it if the local callbacks fail */
+        if (ReturnResumedResult(in, &record, &keyBuff, callback) != HC_SUCCESS) {
+            LOGE("Failed to return the resumed result!");
+        }
+    } while (0);
+    if (sessionKey != NULL) {
+        (void)memset_s(sessionKey, keyLen, 0, keyLen);
+        HcFree(sessionKey);
+    }
+    ClearRecord(&record);
+    return res;
+}
+
+void SendAuthResumeError(const CJson *in, const DeviceAuthCallback *callback, int32_t errorCode)
+{
+    CJson *response = CreateJson();
+    if (response == NULL) {
+        LOGE("Failed to create the resume response!");
+        return;
+    }
+    if ((AddIntToJson(response, FIELD_RESUME_STEP, AUTH_RESUME_RESPONSE) == HC_SUCCESS) &&
+        (AddIntToJson(response, FIELD_ERROR_CODE, errorCode) == HC_SUCCESS)) {
+        (void)SendResumeMsg(in, callback, response);
+    }
+    FreeJson(response);
+}
@@ -16,6 +16,7 @@
 #include "auth_session_server.h"
 #include "auth_session_common.h"
 #include "auth_session_common_util.h"
+#include "auth_session_resume.h"
 #include "auth_session_util.h"
 #include "base_group_auth.h"
 #include "common_defs.h"
@@ -135,7 +136,7 @@ static int32_t AddAuthParamByRequest(CJson *dataFromClient, const DeviceAuthCall
 
 static AuthSession *InitServerAuthSession(const DeviceAuthCallback *callback, ParamsVec *authParamsVec)
 {
-    AuthSession *session = (AuthSession *)HcMalloc(sizeof(AuthSession), 0);
+    AuthSession *session = (AuthSession *)AllocSessionObj(SESSION_OBJ_AUTH);
     if (session == NULL) {
         LOGE("Failed to malloc memory for session!");
         DestroyAuthParamsVec(authParamsVec);
@@ -293,6 +294,36 @@ err:
     return NULL;
 }
 
+void ProcessServerAuthResumeMsg(CJson *in, const DeviceAuthCallback *callback)
+{
+    LOGI("Begin process the resume request.");
+    char *confirmation = StartServerRequest(in, callback);
+    if (confirmation == NULL) {
+        LOGE("Failed to get confirmation from server!");
+        SendAuthResumeError(in, callback, HC_ERR_SERVER_CONFIRM_FAIL);
+        return;
+    }
+    CJson *confirmationJson = CreateJsonFromString(confirmation);
+    FreeJsonString(confirmation);
+    if (confirmationJson == NULL) {
+        LOGE("Failed to create json from string!");
+        SendAuthResumeError(in, callback, HC_ERR_JSON_FAIL);
+        return;
+    }
+    int32_t res = HC_ERR_REQ_REJECTED;
+    int serverConfirm = REQUEST_ACCEPTED;
+    (void)GetIntFromJson(confirmationJson, FIELD_CONFIRMATION, &serverConfirm);
+    if ((uint32_t)serverConfirm == REQUEST_REJECTED) {
+        LOGE("Server reject to response.");
+    } else {
+        res = ProcessServerAuthResume(in, confirmationJson, callback);
+    }
+    FreeJson(confirmationJson);
+    if (res != HC_SUCCESS) {
+        SendAuthResumeError(in, callback, res);
+    }
+}
+
 Session *CreateServerAuthSession(CJson *param, const DeviceAuthCallback *callback)
 {
     AuthSession *session = NULL;
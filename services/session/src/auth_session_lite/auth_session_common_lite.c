@@ -343,13 +343,13 @@ void DestroyAuthSessionLite(Session *session)
     }
     AuthSessionLite *realSession = (AuthSessionLite *)session;
     FreeJson(realSession->authParams);
-    HcFree(realSession);
+    FreeSessionObj(SESSION_OBJ_AUTH_LITE, realSession);
     realSession = NULL;
 }
 
 AuthSessionLite *InitAuthSessionLite(CJson *param, const DeviceAuthCallback *callback)
 {
-    AuthSessionLite *session = (AuthSessionLite *)HcMalloc(sizeof(AuthSessionLite), 0);
+    AuthSessionLite *session = (AuthSessionLite *)AllocSessionObj(SESSION_OBJ_AUTH_LITE);
     if (session == NULL) {
         LOGE("Failed to allocate memory for session!");
         return NULL;
@@ -18,6 +18,7 @@
 #include "channel_manager.h"
 #include "group_common.h"
 #include "hc_log.h"
+#include "session_common.h"
 #include "session_manager.h"
 
 static int32_t GenerateClientModuleParams(BindSession *session, CJson *moduleParams)
@@ -179,7 +180,7 @@ Session *CreateClientBindSession(CJson *jsonParams, const DeviceAuthCallback *ca
         }
     }
 
-    BindSession *session = (BindSession *)HcMalloc(sizeof(BindSession), 0);
+    BindSession *session = (BindSession *)AllocSessionObj(SESSION_OBJ_BIND);
     if (session == NULL) {
         LOGE("Failed to allocate session memory!");
         return NULL;
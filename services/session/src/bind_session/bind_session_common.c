@@ -1250,15 +1250,8 @@ int32_t GenerateBindParams(int isClient, const CJson *jsonParams, BindSession *s
 
 int32_t SendBindSessionData(const BindSession *session, const CJson *sendData)
 {
-    char *sendDataStr = PackJsonToString(sendData);
-    if (sendDataStr == NULL) {
-        LOGE("An error occurred when converting json to string!");
-        return HC_ERR_JSON_FAIL;
-    }
-    int32_t result = HcSendMsg(session->channelType, session->requestId,
-        session->channelId, session->base.callback, sendDataStr);
-    FreeJsonString(sendDataStr);
-    return result;
+    return HcSendJsonMsg(session->channelType, session->requestId, session->channelId,
+        session->base.callback, sendData, session->isBinaryWire);
 }
 
 void InformPeerProcessErrorIfNeed(bool isNeedInform, int32_t errorCode, const BindSession *session)
@@ -1306,11 +1299,20 @@ void DestroyBindSession(Session *session)
     DestroyTask(realSession->curTaskId, DAS_MODULE);
     FreeJson(realSession->params);
     realSession->params = NULL;
-    HcFree(realSession);
+    FreeSessionObj(SESSION_OBJ_BIND, realSession);
     realSession = NULL;
 }
 
-int32_t ProcessModule(const BindSession *session, const CJson *in, CJson *out, int *status)
+static void UpdateWireFormat(BindSession *session, const CJson *out)
+{
+    /* once the binary form is agreed on, the rest of the messages of the session are all sent in it */
+    bool isBinaryWire = false;
+    if ((GetBoolFromJson(out, FIELD_IS_BINARY_WIRE, &isBinaryWire) == HC_SUCCESS) && isBinaryWire) {
+        session->isBinaryWire = true;
+    }
+}
+
+int32_t ProcessModule(BindSession *session, const CJson *in, CJson *out, int *status)
 {
     LOGI("Start to process DAS module task!");
     int32_t result = ProcessTask(session->curTaskId, in, out, status, DAS_MODULE);
@@ -1318,6 +1320,7 @@ int32_t ProcessModule(const BindSession *session, const CJson *in, CJson *out, i
         LOGE("An error occurs when the module processes task! [ErrorCode]: %d", result);
         return result;
     }
+    UpdateWireFormat(session, out);
     LOGI("Process DAS module task successfully!");
     return HC_SUCCESS;
 }
@@ -1336,6 +1339,7 @@ int32_t CreateAndProcessModule(BindSession *session, const CJson *in, CJson *out
         LOGE("An error occurs when the module processes task! [ErrorCode]: %d", result);
         return result;
     }
+    UpdateWireFormat(session, out);
     LOGI("Create and process DAS module task successfully!");
     return HC_SUCCESS;
 }
@@ -1381,6 +1385,7 @@ void InitBindSession(int bindType, int operationCode, int64_t requestId, const D
     session->requestId = requestId;
     session->channelId = DEFAULT_CHANNEL_ID;
     session->isWaiting = HC_FALSE;
+    session->isBinaryWire = false;
     session->params = NULL;
     session->onChannelOpened = NULL;
     session->onConfirmationReceived = NULL;
@@ -19,6 +19,7 @@
 #include "das_module_defines.h"
 #include "group_common.h"
 #include "hc_log.h"
+#include "session_common.h"
 #include "session_manager.h"
 
 static int32_t AddRecvModuleDataToParams(CJson *jsonParams, CJson *moduleParams)
@@ -479,7 +480,7 @@ Session *CreateServerBindSession(CJson *jsonParams, const DeviceAuthCallback *ca
     LOGI("Start to create server bind session! [RequestId]: %" PRId64 ", [OperationCode]: %d",
         requestId, operationCode);
 
-    BindSession *session = (BindSession *)HcMalloc(sizeof(BindSession), 0);
+    BindSession *session = (BindSession *)AllocSessionObj(SESSION_OBJ_BIND);
     if (session == NULL) {
         LOGE("Failed to allocate session memory!");
         return NULL;
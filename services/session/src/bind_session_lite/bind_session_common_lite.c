@@ -286,7 +286,7 @@ void DestroyLiteBindSession(Session *session)
     DestroyTask(realSession->curTaskId, DAS_MODULE);
     FreeJson(realSession->params);
     realSession->params = NULL;
-    HcFree(realSession);
+    FreeSessionObj(SESSION_OBJ_BIND_LITE, realSession);
     realSession = NULL;
 }
 
@@ -18,6 +18,7 @@
 #include "channel_manager.h"
 #include "device_auth_defines.h"
 #include "hc_log.h"
+#include "session_common.h"
 #include "session_manager.h"
 
 static int32_t RequestConfirmation(const LiteBindSession *session, char **returnStr)
@@ -167,7 +168,7 @@ Session *CreateLiteServerBindSession(CJson *jsonParams, const DeviceAuthCallback
     LOGI("Start to create lite server bind session! [RequestId]: %" PRId64 ", [OperationCode]: %d",
         requestId, operationCode);
 
-    LiteBindSession *session = (LiteBindSession *)HcMalloc(sizeof(LiteBindSession), 0);
+    LiteBindSession *session = (LiteBindSession *)AllocSessionObj(SESSION_OBJ_BIND_LITE);
     if (session == NULL) {
         LOGE("Failed to allocate session memory!");
         return NULL;
@@ -15,7 +15,25 @@
 
 #include "session_common.h"
 #include "alg_loader.h"
+#include "auth_session_common_defines.h"
+#include "auth_session_common_lite.h"
+#include "bind_session_common.h"
+#include "bind_session_common_lite.h"
 #include "das_module_defines.h"
+#include "hc_error.h"
+#include "hc_log.h"
+
+#define SESSION_NUM_PER_SLAB 8
+
+static HcMemPool g_sessionObjPools[SESSION_OBJ_TYPE_NUM];
+static bool g_isSessionObjPoolsInited = false;
+
+static const uint32_t SESSION_OBJ_SIZE[SESSION_OBJ_TYPE_NUM] = {
+    sizeof(AuthSession),
+    sizeof(AuthSessionLite),
+    sizeof(BindSession),
+    sizeof(LiteBindSession)
+};
 
 int GenerateSessionOrTaskId(int64_t *id)
 {
@@ -26,3 +44,64 @@ int GenerateSessionOrTaskId(int64_t *id)
     Uint8Buff idBuf = { (void *)id, sizeof(int64_t) };
     return loader->generateRandom(&idBuf);
 }
+
+int32_t InitSessionObjPools(void)
+{
+    if (g_isSessionObjPoolsInited) {
+        return HC_SUCCESS;
+    }
+    for (int32_t i = 0; i < SESSION_OBJ_TYPE_NUM; i++) {
+        if (InitMemPool(&g_sessionObjPools[i], SESSION_OBJ_SIZE[i], SESSION_NUM_PER_SLAB) != HAL_SUCCESS) {
+            LOGE("Failed to init session pool, type: %d", i);
+            for (int32_t j = 0; j < i; j++) {
+                DestroyMemPool(&g_sessionObjPools[j]);
+            }
+            return HC_ERR_INIT_FAILED;
+        }
+    }
+    g_isSessionObjPoolsInited = true;
+    return HC_SUCCESS;
+}
+
+void DestroySessionObjPools(void)
+{
+    if (!g_isSessionObjPoolsInited) {
+        return;
+    }
+    for (int32_t i = 0; i < SESSION_OBJ_TYPE_NUM; i++) {
+        DestroyMemPool(&g_sessionObjPools[i]);
+    }
+    g_isSessionObjPoolsInited = false;
+}
+
+void *AllocSessionObj(SessionObjType type)
+{
+    if (!g_isSessionObjPoolsInited || (type < 0) || (type >= SESSION_OBJ_TYPE_NUM)) {
+        LOGE("The session pool is not available, type: %d", type);
+        return NULL;
+    }
+    return MemPoolAlloc(&g_sessionObjPools[type]);
+}
+
+void FreeSessionObj(SessionObjType type, void *obj)
+{
+    if (!g_isSessionObjPoolsInited || (type < 0) || (type >= SESSION_OBJ_TYPE_NUM)) {
+        return;
+    }
+    MemPoolFree(&g_sessionObjPools[type], obj);
+}
+
+void GetSessionObjStat(HcMemPoolStat *stat)
+{
+    (void)memset_s(stat, sizeof(HcMemPoolStat), 0, sizeof(HcMemPoolStat));
+    if (!g_isSessionObjPoolsInited) {
+        return;
+    }
+    for (int32_t i = 0; i < SESSION_OBJ_TYPE_NUM; i++) {
+        HcMemPoolStat poolStat;
+        GetMemPoolStat(&g_sessionObjPools[i], &poolStat);
+        stat->usedNum += poolStat.usedNum;
+        stat->usedBytes += poolStat.usedBytes;
+        stat->reservedBytes += poolStat.reservedBytes;
+    }
+}
@@ -16,6 +16,7 @@
 #include "session_manager.h"
 #include "auth_session_client.h"
 #include "auth_session_client_lite.h"
+#include "auth_session_resume.h"
 #include "auth_session_server.h"
 #include "auth_session_server_lite.h"
 #include "bind_session_client.h"
@@ -26,20 +27,59 @@
 #include "device_auth.h"
 #include "device_auth_defines.h"
 #include "hc_dev_info.h"
+#include "hc_error.h"
+#include "hc_hash_map.h"
 #include "hc_log.h"
+#include "hc_mutex.h"
 #include "hc_time.h"
-#include "hc_vector.h"
 #include "key_agree_session_client.h"
 #include "key_agree_session_server.h"
+#include "session_common.h"
 
-DECLARE_HC_VECTOR(SessionManagerVec, void *)
-IMPLEMENT_HC_VECTOR(SessionManagerVec, void *, 1)
 
-DECLARE_HC_VECTOR(RequestInfoVec, RequestInfo)
-IMPLEMENT_HC_VECTOR(RequestInfoVec, RequestInfo, 1)
+/*
+ * The sessions of different requests are processed by different task workers at the same time.
+ * The lock only protects the registry and is never held while calling into a session, so a session
+ * which is destroyed while it is in use is only marked, and the last user destroys it.
+ */
+typedef struct SessionEntryT {
+    Session *session;
+    int64_t requestId;
+    int32_t requestType;
+    uint32_t useCount;
+    bool isDestroyed;
+    bool isAborted; /* onError is already called, it is only left for the wheel to destroy */
+    int64_t expireTime;
+    struct SessionEntryT *next; /* the links of the timer wheel slot, or of the expired list */
+    struct SessionEntryT **pprev;
+} SessionEntry;
+
+#define SESSION_ENTRY_NUM_PER_SLAB 16
+
+#define TIMER_WHEEL_LEVEL_NUM 2
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOT_NUM (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOT_NUM - 1)
+#define TIMER_WHEEL_SPAN (TIMER_WHEEL_SLOT_NUM * TIMER_WHEEL_SLOT_NUM)
+
+/*
+ * Two-level timer wheel of the session timeouts, in seconds. A slot of the first level holds the sessions
+ * which expire in that second, a slot of the second level holds the sessions of TIMER_WHEEL_SLOT_NUM seconds,
+ * and they move down to the first level when the wheel reaches their slot.
+ * The task workers advance the wheel to the current time before dispatching a message.
+ */
+typedef struct {
+    SessionEntry *slots[TIMER_WHEEL_LEVEL_NUM][TIMER_WHEEL_SLOT_NUM];
+    int64_t curTime;
+    uint32_t timerCount;
+} SessionTimerWheel;
 
-static SessionManagerVec g_sessionManagerVec;
-static RequestInfoVec g_requestVec;
+static HcHashMap g_sessionMap; /* requestId -> SessionEntry, the destroyed sessions are not in it */
+static SessionTimerWheel g_timerWheel;
+static uint32_t g_sessionCount = 0; /* including the destroyed sessions which are still in use */
+static uint32_t g_sessionCapacity = MAX_SESSION_COUNT;
+static HcMemPool g_entryPool;
+static HcMutex *g_sessionMutex = NULL;
 
 typedef Session *(*CreateSessionFunc)(CJson *, const DeviceAuthCallback *);
 
@@ -62,138 +102,239 @@ static const SessionManagerInfo SESSION_MANAGER_INFO[] = {
     { TYPE_SERVER_KEY_AGREE_SESSION, BIND_TYPE, CreateServerKeyAgreeSession }
 };
 
-static int32_t GetSessionId(int64_t requestId, int64_t *sessionId)
+static void LinkTimer(SessionEntry **slot, SessionEntry *entry)
 {
-    uint32_t index;
-    RequestInfo *requestInfo = NULL;
-    FOR_EACH_HC_VECTOR(g_requestVec, index, requestInfo) {
-        if ((requestInfo != NULL) && (requestInfo->requestId == requestId)) {
-            *sessionId = requestInfo->sessionId;
-            return HC_SUCCESS;
-        }
+    entry->next = *slot;
+    if (*slot != NULL) {
+        (*slot)->pprev = &entry->next;
+    }
+    entry->pprev = slot;
+    *slot = entry;
+    g_timerWheel.timerCount++;
+}
+
+static void UnlinkTimer(SessionEntry *entry)
+{
+    if (entry->pprev == NULL) {
+        return;
+    }
+    *entry->pprev = entry->next;
+    if (entry->next != NULL) {
+        entry->next->pprev = entry->pprev;
     }
-    return HC_ERR_REQUEST_NOT_FOUND;
+    entry->next = NULL;
+    entry->pprev = NULL;
+    g_timerWheel.timerCount--;
 }
 
-static int32_t GetSessionIdByType(int64_t requestId, int32_t type, int64_t *sessionId)
+static void AddTimer(SessionEntry *entry)
 {
-    uint32_t index;
-    RequestInfo *requestInfo = NULL;
-    FOR_EACH_HC_VECTOR(g_requestVec, index, requestInfo) {
-        if ((requestInfo != NULL) && (requestInfo->requestId == requestId)) {
-            if (requestInfo->type != type) {
-                LOGE("RequestId is match but type not match");
-                return HC_ERR_REQUEST_NOT_FOUND;
+    int64_t curTime = g_timerWheel.curTime;
+    /* a session which is in use when it expires is checked again in the next second */
+    int64_t expireTime = (entry->expireTime > curTime) ? entry->expireTime : (curTime + 1);
+    if (expireTime - curTime < TIMER_WHEEL_SLOT_NUM) {
+        LinkTimer(&g_timerWheel.slots[0][expireTime & TIMER_WHEEL_SLOT_MASK], entry);
+        return;
+    }
+    if (expireTime - curTime >= TIMER_WHEEL_SPAN) {
+        /* park it in the farthest slot, it is added again when the wheel reaches the slot */
+        expireTime = curTime + TIMER_WHEEL_SPAN - 1;
+    }
+    LinkTimer(&g_timerWheel.slots[1][(expireTime >> TIMER_WHEEL_BITS) & TIMER_WHEEL_SLOT_MASK], entry);
+}
+
+static void RemoveSessionEntry(SessionEntry *entry)
+{
+    (void)HashMapRemove(&g_sessionMap, &entry->requestId, sizeof(entry->requestId), entry);
+    UnlinkTimer(entry);
+}
+
+/*
+ * Move the wheel to now. The expired sessions which are not in use are removed from the registry,
+ * and returned as a list linked by next, the caller destroys them.
+ */
+static SessionEntry *AdvanceTimerWheel(int64_t now)
+{
+    SessionEntry *expiredList = NULL;
+    while (g_timerWheel.curTime < now) {
+        if (g_timerWheel.timerCount == 0) {
+            g_timerWheel.curTime = now;
+            break;
+        }
+        int64_t tick = ++g_timerWheel.curTime;
+        SessionEntry *entry = NULL;
+        if ((tick & TIMER_WHEEL_SLOT_MASK) == 0) {
+            SessionEntry **upperSlot = &g_timerWheel.slots[1][(tick >> TIMER_WHEEL_BITS) & TIMER_WHEEL_SLOT_MASK];
+            while ((entry = *upperSlot) != NULL) {
+                UnlinkTimer(entry);
+                AddTimer(entry);
+            }
+        }
+        SessionEntry **slot = &g_timerWheel.slots[0][tick & TIMER_WHEEL_SLOT_MASK];
+        while ((entry = *slot) != NULL) {
+            UnlinkTimer(entry);
+            if (entry->useCount > 0) {
+                AddTimer(entry);
+                continue;
             }
-            *sessionId = requestInfo->sessionId;
-            return HC_SUCCESS;
+            RemoveSessionEntry(entry);
+            g_sessionCount--;
+            entry->next = expiredList;
+            expiredList = entry;
         }
     }
-    return HC_ERR_REQUEST_NOT_FOUND;
+    return expiredList;
 }
 
-static void DestroyRequest(int64_t requestId)
+static void FreeSessionEntry(SessionEntry *entry)
 {
-    uint32_t index;
-    RequestInfo *request = NULL;
-    FOR_EACH_HC_VECTOR(g_requestVec, index, request) {
-        if ((request != NULL) && (request->requestId == requestId)) {
-            RequestInfo tempRequest;
-            HC_VECTOR_POPELEMENT(&g_requestVec, &tempRequest, index);
-            return;
-        }
+    entry->session->destroy(entry->session);
+    MemPoolFree(&g_entryPool, entry);
+}
+
+/*
+ * Get the session of the request and keep it alive until ReleaseSession is called.
+ * @param type: the request type to match, or a negative value to match any type.
+ */
+static SessionEntry *AcquireSession(int64_t requestId, int32_t type)
+{
+    g_sessionMutex->lock(g_sessionMutex);
+    SessionEntry *entry = (SessionEntry *)HashMapGet(&g_sessionMap, &requestId, sizeof(requestId));
+    if (entry == NULL) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        return NULL;
+    }
+    if ((type >= 0) && (entry->requestType != type)) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        LOGE("RequestId is match but type not match");
+        return NULL;
+    }
+    entry->useCount++;
+    g_sessionMutex->unlock(g_sessionMutex);
+    return entry;
+}
+
+static void ReleaseSession(SessionEntry *entry)
+{
+    g_sessionMutex->lock(g_sessionMutex);
+    entry->useCount--;
+    if ((entry->useCount > 0) || !entry->isDestroyed) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        return;
     }
+    g_sessionCount--;
+    g_sessionMutex->unlock(g_sessionMutex);
+    FreeSessionEntry(entry);
 }
 
-void InitSessionManager()
+int32_t InitSessionManager(void)
 {
-    g_sessionManagerVec = CREATE_HC_VECTOR(SessionManagerVec)
-    g_requestVec = CREATE_HC_VECTOR(RequestInfoVec)
+    if (g_sessionMutex == NULL) {
+        g_sessionMutex = (HcMutex *)HcMalloc(sizeof(HcMutex), 0);
+        if (g_sessionMutex == NULL) {
+            LOGE("Failed to allocate session mutex memory!");
+            return HC_ERR_ALLOC_MEMORY;
+        }
+        if (InitHcMutex(g_sessionMutex) != HC_SUCCESS) {
+            LOGE("Init mutex failed!");
+            HcFree(g_sessionMutex);
+            g_sessionMutex = NULL;
+            return HC_ERR_INIT_FAILED;
+        }
+    }
+    if (InitSessionObjPools() != HC_SUCCESS) {
+        return HC_ERR_INIT_FAILED;
+    }
+    if (InitMemPool(&g_entryPool, sizeof(SessionEntry), SESSION_ENTRY_NUM_PER_SLAB) != HAL_SUCCESS) {
+        LOGE("Failed to init session entry pool!");
+        DestroySessionObjPools();
+        return HC_ERR_INIT_FAILED;
+    }
+    if (InitAuthResumeCache() != HC_SUCCESS) {
+        LOGW("Failed to init the resume cache, the auth is never resumed!");
+    }
+    g_sessionCapacity = HcGetMaxSessionCount();
+    LOGI("The max session count is %u.", g_sessionCapacity);
+    g_sessionMap = CreateHashMap(MAX_SESSION_COUNT);
+    (void)memset_s(&g_timerWheel, sizeof(g_timerWheel), 0, sizeof(g_timerWheel));
+    int64_t curTime = HcGetCurTime();
+    g_timerWheel.curTime = (curTime > 0) ? curTime : 0;
+    g_sessionCount = 0;
+    return HC_SUCCESS;
 }
 
-void DestroySessionManager()
+void DestroySessionManager(void)
 {
-    uint32_t index;
-    void **session = NULL;
-    FOR_EACH_HC_VECTOR(g_sessionManagerVec, index, session) {
-        if (session != NULL && (*session != NULL)) {
-            Session *temp = (Session *)(*session);
-            temp->destroy(temp);
+    /* the sessions which are not destroyed are all in the wheel */
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVEL_NUM; level++) {
+        for (uint32_t i = 0; i < TIMER_WHEEL_SLOT_NUM; i++) {
+            SessionEntry *entry = NULL;
+            while ((entry = g_timerWheel.slots[level][i]) != NULL) {
+                UnlinkTimer(entry);
+                FreeSessionEntry(entry);
+            }
         }
     }
-    DESTROY_HC_VECTOR(SessionManagerVec, &g_sessionManagerVec)
-    DESTROY_HC_VECTOR(RequestInfoVec, &g_requestVec)
+    DestroyHashMap(&g_sessionMap);
+    g_sessionCount = 0;
+    DestroyMemPool(&g_entryPool);
+    DestroySessionObjPools();
+    DestroyAuthResumeCache();
+    if (g_sessionMutex != NULL) {
+        DestroyHcMutex(g_sessionMutex);
+        HcFree(g_sessionMutex);
+        g_sessionMutex = NULL;
+    }
 }
 
 bool IsRequestExist(int64_t requestId)
 {
-    int64_t sessionId = 0;
-    return (GetSessionId(requestId, &sessionId) == HC_SUCCESS) ? true : false;
+    g_sessionMutex->lock(g_sessionMutex);
+    bool isExist = (HashMapGet(&g_sessionMap, &requestId, sizeof(requestId)) != NULL);
+    g_sessionMutex->unlock(g_sessionMutex);
+    return isExist;
 }
 
-static void InformTimeOutAndDestroyRequest(const DeviceAuthCallback *callback, int64_t sessionId)
+static void InformTimeOut(const DeviceAuthCallback *callback, int64_t requestId)
 {
     if (callback == NULL || callback->onError == NULL) {
         LOGD("Callback is null, can't inform timeout");
         return;
     }
-    int64_t requestId = 0;
-    uint32_t index;
-    RequestInfo *requestInfo = NULL;
-    FOR_EACH_HC_VECTOR(g_requestVec, index, requestInfo) {
-        if ((requestInfo != NULL) && (requestInfo->sessionId == sessionId)) {
-            requestId = requestInfo->requestId;
-            RequestInfo tempRequest;
-            HC_VECTOR_POPELEMENT(&g_requestVec, &tempRequest, index);
-            break;
-        }
-    }
     LOGI("Begin to inform time out, requestId :%" PRId64, requestId);
     callback->onError(requestId, AUTH_FORM_INVALID_TYPE, HC_ERR_TIME_OUT, NULL);
 }
 
-static void RemoveOverTimeSession()
+static void RemoveOverTimeSession(void)
 {
-    uint32_t index = 0;
-    void **session = NULL;
-    while (index < g_sessionManagerVec.size(&(g_sessionManagerVec))) {
-        session = g_sessionManagerVec.getp(&(g_sessionManagerVec), index);
-        if (session == NULL || (*session == NULL)) {
-            index++;
-            continue;
-        }
-        Session *ptr = (Session *)(*session);
-        if (HcGetIntervalTime(ptr->createTime) < TIME_OUT_VALUE) {
-            index++;
-        } else {
-            InformTimeOutAndDestroyRequest(ptr->callback, ptr->sessionId);
-            ptr->destroy(ptr);
-            g_sessionManagerVec.eraseElement(&(g_sessionManagerVec), session, index);
+    int64_t curTime = HcGetCurTime();
+    if (curTime < 0) {
+        return;
+    }
+    g_sessionMutex->lock(g_sessionMutex);
+    SessionEntry *entry = AdvanceTimerWheel(curTime);
+    g_sessionMutex->unlock(g_sessionMutex);
+    while (entry != NULL) {
+        SessionEntry *next = entry->next;
+        if (!entry->isAborted) {
+            InformTimeOut(entry->session->callback, entry->requestId);
         }
-        session = g_sessionManagerVec.getp(&(g_sessionManagerVec), index);
+        FreeSessionEntry(entry);
+        entry = next;
     }
 }
 
 int32_t ProcessSession(int64_t requestId, int32_t type, CJson *in)
 {
-    int64_t sessionId = 0;
     RemoveOverTimeSession();
-    int32_t result = GetSessionIdByType(requestId, type, &sessionId);
-    if (result != HC_SUCCESS) {
+    SessionEntry *entry = AcquireSession(requestId, type);
+    if (entry == NULL) {
         LOGE("The corresponding session is not found!");
-        return result;
-    }
-    uint32_t index;
-    void **session = NULL;
-    FOR_EACH_HC_VECTOR(g_sessionManagerVec, index, session) {
-        if (session != NULL && (*session != NULL)) {
-            Session *ptr = (Session *)(*session);
-            if (ptr->sessionId == sessionId) {
-                return ptr->process(ptr, in);
-            }
-        }
+        return HC_ERR_SESSION_NOT_EXIST;
     }
-    return HC_ERR_SESSION_NOT_EXIST;
+    int32_t result = entry->session->process(entry->session, in);
+    ReleaseSession(entry);
+    return result;
 }
 
 static int32_t CheckForCreateSession(int64_t requestId, CJson *params, const DeviceAuthCallback *callback)
@@ -206,6 +347,14 @@ static int32_t CheckForCreateSession(int64_t requestId, CJson *params, const Dev
         LOGE("A request with the request ID already exists!");
         return HC_ERR_REQUEST_EXIST;
     }
+    RemoveOverTimeSession();
+    g_sessionMutex->lock(g_sessionMutex);
+    uint32_t sessionCount = g_sessionCount;
+    g_sessionMutex->unlock(g_sessionMutex);
+    if (sessionCount >= g_sessionCapacity) {
+        LOGE("The session count reaches the limit: %u.", g_sessionCapacity);
+        return HC_ERR_SESSION_IS_FULL;
+    }
     return HC_SUCCESS;
 }
 
@@ -216,134 +365,186 @@ int32_t CreateSession(int64_t requestId, SessionTypeValue sessionType, CJson *pa
     if (res != HC_SUCCESS) {
         return res;
     }
-    uint32_t vecSize = g_sessionManagerVec.size(&g_sessionManagerVec);
-    if (vecSize >= MAX_SESSION_COUNT) {
-        LOGE("Session vector is full.");
-        return HC_ERR_SESSION_IS_FULL;
+    SessionEntry *entry = (SessionEntry *)MemPoolAlloc(&g_entryPool);
+    if (entry == NULL) {
+        LOGE("Failed to allocate session entry memory!");
+        return HC_ERR_ALLOC_MEMORY;
     }
-    RequestInfo requestInfo;
-    requestInfo.requestId = requestId;
-    Session *session = NULL;
     for (uint32_t i = 0; i < sizeof(SESSION_MANAGER_INFO) / sizeof(SessionManagerInfo); i++) {
         if (SESSION_MANAGER_INFO[i].sessionType == sessionType) {
-            session = SESSION_MANAGER_INFO[i].createSessionFunc(params, callback);
-            requestInfo.type = SESSION_MANAGER_INFO[i].requestType;
+            entry->session = SESSION_MANAGER_INFO[i].createSessionFunc(params, callback);
+            entry->requestType = SESSION_MANAGER_INFO[i].requestType;
             break;
         }
     }
-    if (session == NULL) {
+    if (entry->session == NULL) {
         LOGE("Failed to create session! Session Type: %d", sessionType);
+        MemPoolFree(&g_entryPool, entry);
         return HC_ERR_CREATE_SESSION_FAIL;
     }
 
-    requestInfo.sessionId = session->sessionId;
-    g_sessionManagerVec.pushBackT(&g_sessionManagerVec, (void *)session);
-    g_requestVec.pushBack(&g_requestVec, &requestInfo);
+    Session *session = entry->session;
     session->createTime = HcGetCurTime();
     if (session->createTime <= 0) {
         session->createTime = 0;
         LOGE("Failed to get cur time.");
     }
+    entry->requestId = requestId;
+    entry->expireTime = session->createTime + TIME_OUT_VALUE;
+    g_sessionMutex->lock(g_sessionMutex);
+    if (HashMapGet(&g_sessionMap, &requestId, sizeof(requestId)) != NULL) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        LOGE("A request with the request ID already exists!");
+        FreeSessionEntry(entry);
+        return HC_ERR_REQUEST_EXIST;
+    }
+    if (g_sessionCount >= g_sessionCapacity) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        LOGE("The session count reaches the limit: %u.", g_sessionCapacity);
+        FreeSessionEntry(entry);
+        return HC_ERR_SESSION_IS_FULL;
+    }
+    if (!HashMapPut(&g_sessionMap, &entry->requestId, sizeof(entry->requestId), entry)) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        LOGE("Failed to add session to the registry!");
+        FreeSessionEntry(entry);
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    AddTimer(entry);
+    g_sessionCount++;
+    g_sessionMutex->unlock(g_sessionMutex);
     return HC_SUCCESS;
 }
 
 void DestroySession(int64_t requestId)
 {
-    int64_t sessionId = 0;
-    if (GetSessionId(requestId, &sessionId) != HC_SUCCESS) {
+    g_sessionMutex->lock(g_sessionMutex);
+    SessionEntry *entry = (SessionEntry *)HashMapGet(&g_sessionMap, &requestId, sizeof(requestId));
+    if (entry == NULL) {
+        g_sessionMutex->unlock(g_sessionMutex);
         LOGI("The corresponding session is not found. Therefore, the destruction operation is not required!");
         return;
     }
-    uint32_t index;
-    void **session = NULL;
-    FOR_EACH_HC_VECTOR(g_sessionManagerVec, index, session) {
-        if (session != NULL && (*session != NULL)) {
-            if (((Session *)(*session))->sessionId == sessionId) {
-                ((Session *)(*session))->destroy(((Session *)(*session)));
-                *session = NULL;
-                HC_VECTOR_POPELEMENT(&g_sessionManagerVec, session, index);
-                break;
-            }
-        }
+    RemoveSessionEntry(entry);
+    if (entry->useCount > 0) {
+        entry->isDestroyed = true;
+        g_sessionMutex->unlock(g_sessionMutex);
+        return;
     }
-    DestroyRequest(requestId);
+    g_sessionCount--;
+    g_sessionMutex->unlock(g_sessionMutex);
+    FreeSessionEntry(entry);
 }
 
-void OnChannelOpened(int64_t requestId, int64_t channelId)
+void AbortSession(int64_t requestId, int32_t errorCode)
 {
-    int64_t sessionId = 0;
-    if (GetSessionIdByType(requestId, BIND_TYPE, &sessionId) != HC_SUCCESS) {
-        LOGE("The corresponding session is not found!");
+    g_sessionMutex->lock(g_sessionMutex);
+    SessionEntry *entry = (SessionEntry *)HashMapGet(&g_sessionMap, &requestId, sizeof(requestId));
+    if (entry == NULL) {
+        g_sessionMutex->unlock(g_sessionMutex);
+        LOGI("The session to abort has ended.");
         return;
     }
-    uint32_t index;
-    void **session = NULL;
-    FOR_EACH_HC_VECTOR(g_sessionManagerVec, index, session) {
-        if (session != NULL && (*session != NULL)) {
-            if (((Session *)(*session))->sessionId == sessionId) {
-                if (((Session *)(*session))->type == TYPE_CLIENT_BIND_SESSION) {
-                    BindSession *realSession = (BindSession *)(*session);
-                    realSession->onChannelOpened(*session, channelId, requestId);
-                    return;
-                }
-                if (((Session *)(*session))->type == TYPE_CLIENT_BIND_SESSION_LITE) {
-                    LiteBindSession *realSession = (LiteBindSession *)(*session);
-                    realSession->onChannelOpened(*session, channelId, requestId);
-                    return;
-                }
-                if (((Session *)(*session))->type == TYPE_CLIENT_KEY_AGREE_SESSION) {
-                    KeyAgreeSession *realSession = (KeyAgreeSession *)(*session);
-                    realSession->onChannelOpened(*session, channelId, requestId);
-                    return;
-                }
-                LOGE("The type of the found session is not as expected!");
-                return;
-            }
-        }
+    /* no message reaches it any more, and the wheel destroys it in the next second */
+    RemoveSessionEntry(entry);
+    entry->isAborted = true;
+    entry->expireTime = 0;
+    AddTimer(entry);
+    const DeviceAuthCallback *callback = entry->session->callback;
+    g_sessionMutex->unlock(g_sessionMutex);
+    LOGE("Abort the session, requestId: %" PRId64 ", error: %d.", requestId, errorCode);
+    if ((callback != NULL) && (callback->onError != NULL)) {
+        callback->onError(requestId, AUTH_FORM_INVALID_TYPE, errorCode, NULL);
     }
 }
 
-void OnConfirmationReceived(int64_t requestId, CJson *returnData)
+void GetSessionMemoryStat(SessionMemoryStat *stat)
 {
-    int64_t sessionId = 0;
-    if (GetSessionIdByType(requestId, BIND_TYPE, &sessionId) != HC_SUCCESS) {
+    if (stat == NULL) {
+        return;
+    }
+    HcMemPoolStat objStat;
+    HcMemPoolStat entryStat;
+    GetSessionObjStat(&objStat);
+    GetMemPoolStat(&g_entryPool, &entryStat);
+    g_sessionMutex->lock(g_sessionMutex);
+    stat->sessionCount = g_sessionCount;
+    stat->capacity = g_sessionCapacity;
+    g_sessionMutex->unlock(g_sessionMutex);
+    stat->usedBytes = objStat.usedBytes + entryStat.usedBytes;
+    stat->reservedBytes = objStat.reservedBytes + entryStat.reservedBytes;
+}
+
+static void DoChannelOpened(Session *session, int64_t channelId, int64_t requestId)
+{
+    if (session->type == TYPE_CLIENT_BIND_SESSION) {
+        BindSession *realSession = (BindSession *)session;
+        realSession->onChannelOpened(session, channelId, requestId);
+        return;
+    }
+    if (session->type == TYPE_CLIENT_BIND_SESSION_LITE) {
+        LiteBindSession *realSession = (LiteBindSession *)session;
+        realSession->onChannelOpened(session, channelId, requestId);
+        return;
+    }
+    if (session->type == TYPE_CLIENT_KEY_AGREE_SESSION) {
+        KeyAgreeSession *realSession = (KeyAgreeSession *)session;
+        realSession->onChannelOpened(session, channelId, requestId);
+        return;
+    }
+    LOGE("The type of the found session is not as expected!");
+}
+
+void OnChannelOpened(int64_t requestId, int64_t channelId)
+{
+    SessionEntry *entry = AcquireSession(requestId, BIND_TYPE);
+    if (entry == NULL) {
         LOGE("The corresponding session is not found!");
         return;
     }
-    uint32_t index;
-    void **session = NULL;
-    FOR_EACH_HC_VECTOR(g_sessionManagerVec, index, session) {
-        if ((session == NULL) || (*session == NULL) || (((Session *)(*session))->sessionId != sessionId)) {
-            continue;
-        }
-        if (((Session *)(*session))->type == TYPE_SERVER_BIND_SESSION) {
-            BindSession *realSession = (BindSession *)(*session);
-            if (!realSession->isWaiting) {
-                LOGE("The found session is not in the waiting state!");
-                return;
-            }
-            realSession->onConfirmationReceived(*session, returnData);
+    DoChannelOpened(entry->session, channelId, requestId);
+    ReleaseSession(entry);
+}
+
+static void DoConfirmationReceived(Session *session, CJson *returnData)
+{
+    if (session->type == TYPE_SERVER_BIND_SESSION) {
+        BindSession *realSession = (BindSession *)session;
+        if (!realSession->isWaiting) {
+            LOGE("The found session is not in the waiting state!");
             return;
         }
-        if (((Session *)(*session))->type == TYPE_SERVER_BIND_SESSION_LITE) {
-            LiteBindSession *realSession = (LiteBindSession *)(*session);
-            if (!realSession->isWaiting) {
-                LOGE("The found session is not in the waiting state!");
-                return;
-            }
-            realSession->onConfirmationReceived(*session, returnData);
+        realSession->onConfirmationReceived(session, returnData);
+        return;
+    }
+    if (session->type == TYPE_SERVER_BIND_SESSION_LITE) {
+        LiteBindSession *realSession = (LiteBindSession *)session;
+        if (!realSession->isWaiting) {
+            LOGE("The found session is not in the waiting state!");
             return;
         }
-        if (((Session *)(*session))->type == TYPE_SERVER_KEY_AGREE_SESSION) {
-            KeyAgreeSession *realSession = (KeyAgreeSession *)(*session);
-            if (!realSession->isWaiting) {
-                LOGE("The found session is not in the waiting state!");
-                return;
-            }
-            realSession->onConfirmationReceived(*session, returnData);
+        realSession->onConfirmationReceived(session, returnData);
+        return;
+    }
+    if (session->type == TYPE_SERVER_KEY_AGREE_SESSION) {
+        KeyAgreeSession *realSession = (KeyAgreeSession *)session;
+        if (!realSession->isWaiting) {
+            LOGE("The found session is not in the waiting state!");
             return;
         }
-        LOGE("The type of the found session is not as expected!");
+        realSession->onConfirmationReceived(session, returnData);
         return;
     }
-}
\ No newline at end of file
+    LOGE("The type of the found session is not as expected!");
+}
+
+void OnConfirmationReceived(int64_t requestId, CJson *returnData)
+{
+    SessionEntry *entry = AcquireSession(requestId, BIND_TYPE);
+    if (entry == NULL) {
+        LOGE("The corresponding session is not found!");
+        return;
+    }
+    DoConfirmationReceived(entry->session, returnData);
+    ReleaseSession(entry);
+}
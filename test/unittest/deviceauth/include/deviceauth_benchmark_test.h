@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVICEAUTH_BENCHMARK_TEST_H
+#define DEVICEAUTH_BENCHMARK_TEST_H
+
+#include <cstdint>
+#include "gtest/gtest.h"
+
+namespace {
+    const char *BENCH_APP_NAME = "BenchApp";
+    const char *BENCH_DB_DIR = "/data/data/deviceauth";
+    const int32_t BENCH_BUFFER_SIZE = 256;
+}
+
+/* the cases on the group database, every case starts the service on an empty database */
+class DATABASE_BENCHMARK : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+/* the cases on the task workers, every case starts the service, which starts the workers */
+class TASK_MANAGER_BENCHMARK : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+/* the cases on the session registry, the service is started with the session limit raised to its maximum */
+class SESSION_MANAGER_BENCHMARK : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+/*
+ * The cases of a bind or an auth between two devices. The server device runs in a child process, and the
+ * messages of the two devices go through a socket pair.
+ */
+class DEVICE_AUTH_BENCHMARK : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+#endif
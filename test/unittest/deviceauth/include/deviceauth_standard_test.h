@@ -104,5 +104,39 @@ public:
     void SetUp() override;
     void TearDown() override;
 };
-#endif
 
+/* the cases on the group database, every case starts the service on an empty database */
+class DATABASE_MANAGER : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+class AUTH_GROUP_AFFINITY : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+/* the resumption between a client session and the server, both sides share the database of the case */
+class AUTH_RESUME_SESSION : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+
+/* the session registry, the service is started with a session limit above MAX_SESSION_COUNT */
+class SESSION_MANAGER : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    void SetUp() override;
+    void TearDown() override;
+};
+#endif
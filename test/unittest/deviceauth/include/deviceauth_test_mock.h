@@ -19,8 +19,17 @@
 #include <cstdbool>
 #include <cstdint>
 #include "hc_dev_info.h"
+#include "hc_time.h"
 
 void SetClient(bool tag);
 bool GetClient();
+/* move the clock of HcGetCurTime and HcGetRealTime forward by the seconds */
+void SetTimeOffset(int64_t offset);
+/* the session limit returned by HcGetMaxSessionCount, it takes effect when the service is started again */
+void SetMaxSessionCount(uint32_t count);
+/* the database file returned by GetStoragePath, nullptr gives back the default one */
+void SetStoragePath(const char *path);
+/* the sha256 calls made through GetLoaderInstance, the loader of the tests counts them and passes them on */
+uint32_t GetSha256CallNum();
 
 #endif
@@ -0,0 +1,1894 @@
+/*
+ * Copyright (C) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "deviceauth_benchmark_test.h"
+#include "deviceauth_test_mock.h"
+#include <openssl/bn.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+extern "C" {
+#include "alg_loader.h"
+#include "auth_session_common.h"
+#include "broadcast_manager.h"
+#include "common_defs.h"
+#include "common_util.h"
+#include "crypto_hash_to_point.h"
+#include "database_manager.h"
+#include "device_auth.h"
+#include "device_auth_defines.h"
+#include "hc_crypto_pool.h"
+#include "hc_dev_info.h"
+#include "hc_mem_arena.h"
+#include "hc_types.h"
+#include "json_binary.h"
+#include "json_utils.h"
+#include "securec.h"
+#include "session_manager.h"
+#include "task_manager.h"
+}
+
+using namespace std;
+
+static int64_t GetBenchTimeNs(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/* print the spread of the costs of the runs of a benchmark, and record it in the xml report */
+static void PrintBenchmarkResult(const string &name, vector<double> &costs, const char *unit)
+{
+    if (costs.empty()) {
+        return;
+    }
+    sort(costs.begin(), costs.end());
+    double total = 0;
+    for (double cost : costs) {
+        total += cost;
+    }
+    double avg = total / costs.size();
+    double p50 = costs[costs.size() / 2];
+    double p99 = costs[(costs.size() * 99) / 100];
+    printf("[  BENCH   ] %s: %zu runs, avg %.1f, p50 %.1f, p99 %.1f, max %.1f %s\n", name.c_str(), costs.size(),
+        avg, p50, p99, costs.back(), unit);
+    testing::Test::RecordProperty(name + ".avg", to_string(avg));
+    testing::Test::RecordProperty(name + ".p99", to_string(p99));
+}
+
+static void DeleteBenchDatabase(void)
+{
+    char cmd[BENCH_BUFFER_SIZE] = { 0 };
+    (void)sprintf_s(cmd, sizeof(cmd), "rm -rf %s/hcgroup.dat*", BENCH_DB_DIR);
+    (void)system(cmd);
+}
+
+void DATABASE_BENCHMARK::SetUp()
+{
+    DeleteBenchDatabase();
+    InitDeviceAuthService();
+}
+
+void DATABASE_BENCHMARK::TearDown()
+{
+    DestroyDeviceAuthService();
+    DeleteBenchDatabase();
+}
+
+static const uint32_t BENCH_ID_LEN = 65;
+
+static int32_t AddBenchGroup(const char *groupId, int32_t groupType)
+{
+    GroupInfo *groupInfo = CreateGroupInfoStruct();
+    if (groupInfo == nullptr) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    StringSetPointer(&groupInfo->name, groupId);
+    StringSetPointer(&groupInfo->id, groupId);
+    StringSetPointer(&groupInfo->ownerName, BENCH_APP_NAME);
+    groupInfo->type = groupType;
+    groupInfo->visibility = GROUP_VISIBILITY_PUBLIC;
+    groupInfo->expireTime = -1;
+    int32_t ret = AddGroup(groupInfo);
+    DestroyGroupInfoStruct(groupInfo);
+    return ret;
+}
+
+static int32_t AddBenchDevice(const char *groupId, const char *udid)
+{
+    DeviceInfo *deviceInfo = CreateDeviceInfoStruct();
+    if (deviceInfo == nullptr) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    deviceInfo->devType = DEVICE_TYPE_ACCESSORY;
+    StringSetPointer(&deviceInfo->authId, udid);
+    StringSetPointer(&deviceInfo->udid, udid);
+    StringSetPointer(&deviceInfo->groupId, groupId);
+    StringSetPointer(&deviceInfo->serviceType, groupId);
+    int32_t ret = AddTrustedDevice(deviceInfo, nullptr);
+    DestroyDeviceInfoStruct(deviceInfo);
+    return ret;
+}
+
+static void GenerateBenchUdid(uint32_t index, char *udid, uint32_t udidLen)
+{
+    (void)sprintf_s(udid, udidLen, "%064X", index);
+}
+
+static const uint32_t DEVICE_INDEX_RUN_NUM = 20;
+static const uint32_t DEVICE_INDEX_LOOKUP_NUM = 5000;
+
+/*
+ * The lookups of a trusted device by udid and by authId, in an account group of 120 to 10000 devices.
+ * The cost of a lookup through the device indexes does not grow with the number of devices.
+ */
+TEST_F(DATABASE_BENCHMARK, TC_DEVICE_INDEX_01)
+{
+    const char *groupId = "BENCH_GROUP_A";
+    const uint32_t deviceNums[] = { 120, 1000, 10000 };
+    char udid[BENCH_ID_LEN] = { 0 };
+    ASSERT_EQ(AddBenchGroup(groupId, IDENTICAL_ACCOUNT_GROUP), HC_SUCCESS);
+    uint32_t addedNum = 0;
+    for (uint32_t deviceNum : deviceNums) {
+        for (; addedNum < deviceNum; addedNum++) {
+            GenerateBenchUdid(addedNum, udid, sizeof(udid));
+            ASSERT_EQ(AddBenchDevice(groupId, udid), HC_SUCCESS);
+        }
+        vector<double> hitCosts;
+        vector<double> missCosts;
+        srand(deviceNum);
+        for (uint32_t run = 0; run < DEVICE_INDEX_RUN_NUM; run++) {
+            int64_t start = GetBenchTimeNs();
+            for (uint32_t i = 0; i < DEVICE_INDEX_LOOKUP_NUM; i++) {
+                GenerateBenchUdid(rand() % deviceNum, udid, sizeof(udid));
+                ASSERT_TRUE(IsTrustedDeviceInGroup(groupId, udid));
+                ASSERT_TRUE(IsTrustedDeviceInGroupByAuthId(groupId, udid));
+            }
+            hitCosts.push_back((double)(GetBenchTimeNs() - start) / (DEVICE_INDEX_LOOKUP_NUM * 2));
+            start = GetBenchTimeNs();
+            for (uint32_t i = 0; i < DEVICE_INDEX_LOOKUP_NUM; i++) {
+                GenerateBenchUdid(deviceNum + i, udid, sizeof(udid));
+                ASSERT_FALSE(IsTrustedDeviceExist(udid));
+            }
+            missCosts.push_back((double)(GetBenchTimeNs() - start) / DEVICE_INDEX_LOOKUP_NUM);
+        }
+        PrintBenchmarkResult("device_index.hit." + to_string(deviceNum), hitCosts, "ns/lookup");
+        PrintBenchmarkResult("device_index.miss." + to_string(deviceNum), missCosts, "ns/lookup");
+    }
+}
+
+static const uint32_t DATABASE_SAVE_RUN_NUM = 40;
+
+/* add the devices in one transaction, which saves them in a single snapshot */
+static void FillBenchDevices(const char *groupId, uint32_t firstIndex, uint32_t lastIndex)
+{
+    char udid[BENCH_ID_LEN] = { 0 };
+    ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+    for (uint32_t i = firstIndex; i < lastIndex; i++) {
+        GenerateBenchUdid(i, udid, sizeof(udid));
+        ASSERT_EQ(AddBenchDevice(groupId, udid), HC_SUCCESS);
+    }
+    ASSERT_EQ(CommitDatabaseTransaction(), HC_SUCCESS);
+}
+
+/*
+ * The save of a single added device in a database of 100 to 10000 devices, appended to the journal and synced,
+ * against the save of the whole database in a snapshot, which a transaction of the one device makes.
+ */
+TEST_F(DATABASE_BENCHMARK, TC_DATABASE_JOURNAL_01)
+{
+    const char *groupId = "BENCH_GROUP_A";
+    const uint32_t deviceNums[] = { 100, 1000, 10000 };
+    char udid[BENCH_ID_LEN] = { 0 };
+    ASSERT_EQ(AddBenchGroup(groupId, IDENTICAL_ACCOUNT_GROUP), HC_SUCCESS);
+    uint32_t addedNum = 0;
+    for (uint32_t deviceNum : deviceNums) {
+        FillBenchDevices(groupId, addedNum, deviceNum);
+        addedNum = deviceNum;
+        vector<double> journalCosts;
+        vector<double> snapshotCosts;
+        for (uint32_t run = 0; run < DATABASE_SAVE_RUN_NUM; run++) {
+            GenerateBenchUdid(addedNum++, udid, sizeof(udid));
+            int64_t start = GetBenchTimeNs();
+            ASSERT_EQ(AddBenchDevice(groupId, udid), HC_SUCCESS);
+            journalCosts.push_back((GetBenchTimeNs() - start) / 1000.0);
+            GenerateBenchUdid(addedNum++, udid, sizeof(udid));
+            start = GetBenchTimeNs();
+            ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+            ASSERT_EQ(AddBenchDevice(groupId, udid), HC_SUCCESS);
+            ASSERT_EQ(CommitDatabaseTransaction(), HC_SUCCESS);
+            snapshotCosts.push_back((GetBenchTimeNs() - start) / 1000.0);
+        }
+        PrintBenchmarkResult("database_save.journal." + to_string(deviceNum), journalCosts, "us/add");
+        PrintBenchmarkResult("database_save.snapshot." + to_string(deviceNum), snapshotCosts, "us/add");
+    }
+}
+
+/*
+ * The save of a snapshot of 10 to 10000 devices: it is written to a temporary file and synced, the current
+ * generation is kept as the previous one and the temporary file is renamed over it.
+ */
+TEST_F(DATABASE_BENCHMARK, TC_DATABASE_SAVE_01)
+{
+    const char *groupId = "BENCH_GROUP_A";
+    const uint32_t deviceNums[] = { 10, 1000, 10000 };
+    char udid[BENCH_ID_LEN] = { 0 };
+    ASSERT_EQ(AddBenchGroup(groupId, IDENTICAL_ACCOUNT_GROUP), HC_SUCCESS);
+    uint32_t addedNum = 0;
+    for (uint32_t deviceNum : deviceNums) {
+        FillBenchDevices(groupId, addedNum, deviceNum);
+        addedNum = deviceNum;
+        vector<double> saveCosts;
+        for (uint32_t run = 0; run < DATABASE_SAVE_RUN_NUM; run++) {
+            GenerateBenchUdid(addedNum++, udid, sizeof(udid));
+            ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+            ASSERT_EQ(AddBenchDevice(groupId, udid), HC_SUCCESS);
+            int64_t start = GetBenchTimeNs();
+            ASSERT_EQ(CommitDatabaseTransaction(), HC_SUCCESS);
+            saveCosts.push_back((GetBenchTimeNs() - start) / 1000000.0);
+        }
+        PrintBenchmarkResult("database_save.snapshot_commit." + to_string(deviceNum), saveCosts, "ms/save");
+    }
+}
+
+void TASK_MANAGER_BENCHMARK::SetUp()
+{
+    DeleteBenchDatabase();
+    InitDeviceAuthService();
+}
+
+void TASK_MANAGER_BENCHMARK::TearDown()
+{
+    DestroyDeviceAuthService();
+    DeleteBenchDatabase();
+}
+
+static const uint32_t AUTH_BENCH_REQUEST_NUM = 32;
+static const uint32_t AUTH_BENCH_STEP_NUM = 4;
+static const uint32_t AUTH_BENCH_RUN_NUM = 5;
+static const uint32_t AUTH_BENCH_MOD_LEN = 384;
+static const uint32_t AUTH_BENCH_EXP_LEN = 32;
+static const int64_t AUTH_BENCH_REQUEST_ID_BASE = 0x1000;
+static const int64_t AUTH_BENCH_REQUEST_ID_STEP = 7919;
+
+typedef struct {
+    HcTaskBase base;
+    uint32_t requestIndex;
+    uint32_t step;
+} AuthBenchStepTask;
+
+static std::mutex g_authBenchMutex;
+static std::condition_variable g_authBenchCond;
+static uint32_t g_authBenchDoneNum = 0;
+static uint32_t g_authBenchOrderErrorNum = 0;
+static uint32_t g_authBenchNextSteps[AUTH_BENCH_REQUEST_NUM] = { 0 };
+static uint32_t g_authBenchBlockUs = 0;
+static string g_authBenchModHex;
+static uint8_t g_authBenchBase[AUTH_BENCH_MOD_LEN] = { 0 };
+static uint8_t g_authBenchExp[AUTH_BENCH_EXP_LEN] = { 0 };
+
+/* a step of an authentication: one 3072-bit modexp, and optionally a wait for the peer or HUKS */
+static void DoAuthBenchStep(HcTaskBase *task)
+{
+    AuthBenchStepTask *stepTask = (AuthBenchStepTask *)task;
+    Uint8Buff base = { g_authBenchBase, sizeof(g_authBenchBase) };
+    Uint8Buff exp = { g_authBenchExp, sizeof(g_authBenchExp) };
+    uint8_t out[AUTH_BENCH_MOD_LEN] = { 0 };
+    Uint8Buff outNum = { out, sizeof(out) };
+    const char *modHex = g_authBenchModHex.c_str();
+    bool isStepOk = (GetLoaderInstance()->bigNumExpMod(&base, &exp, modHex, &outNum) == HAL_SUCCESS);
+    if (g_authBenchBlockUs != 0) {
+        (void)usleep(g_authBenchBlockUs);
+    }
+    std::lock_guard<std::mutex> lock(g_authBenchMutex);
+    /* the steps of a request run in order, the next step is only checked once the previous one has finished */
+    if (!isStepOk || (g_authBenchNextSteps[stepTask->requestIndex] != stepTask->step)) {
+        g_authBenchOrderErrorNum++;
+    }
+    g_authBenchNextSteps[stepTask->requestIndex] = stepTask->step + 1;
+    if (stepTask->step == AUTH_BENCH_STEP_NUM - 1) {
+        g_authBenchDoneNum++;
+        g_authBenchCond.notify_one();
+    }
+}
+
+/* an odd 3072-bit modulus costs a modexp as much as the prime of the DL PAKE */
+static void InitAuthBenchNumbers(void)
+{
+    const char *hexDigits = "0123456789ABCDEF";
+    srand(AUTH_BENCH_MOD_LEN);
+    g_authBenchModHex = "F";
+    for (uint32_t i = 1; i < AUTH_BENCH_MOD_LEN * BYTE_TO_HEX_OPER_LENGTH - 1; i++) {
+        g_authBenchModHex += hexDigits[rand() % strlen(hexDigits)];
+    }
+    g_authBenchModHex += "B";
+    for (uint32_t i = 0; i < AUTH_BENCH_MOD_LEN; i++) {
+        g_authBenchBase[i] = (uint8_t)rand();
+    }
+    g_authBenchBase[0] &= 0x7F;
+    for (uint32_t i = 0; i < AUTH_BENCH_EXP_LEN; i++) {
+        g_authBenchExp[i] = (uint8_t)rand();
+    }
+}
+
+/* push all the steps of all the requests at once, and return the time until the last request finishes */
+static double RunAuthBenchRound(void)
+{
+    g_authBenchDoneNum = 0;
+    (void)memset_s(g_authBenchNextSteps, sizeof(g_authBenchNextSteps), 0, sizeof(g_authBenchNextSteps));
+    int64_t start = GetBenchTimeNs();
+    for (uint32_t step = 0; step < AUTH_BENCH_STEP_NUM; step++) {
+        for (uint32_t i = 0; i < AUTH_BENCH_REQUEST_NUM; i++) {
+            AuthBenchStepTask *task = (AuthBenchStepTask *)HcMalloc(sizeof(AuthBenchStepTask), 0);
+            if (task == nullptr) {
+                return -1;
+            }
+            task->base.doAction = DoAuthBenchStep;
+            task->base.destroy = nullptr;
+            task->requestIndex = i;
+            task->step = step;
+            int64_t requestId = AUTH_BENCH_REQUEST_ID_BASE + i * AUTH_BENCH_REQUEST_ID_STEP;
+            if (PushTask(requestId, (HcTaskBase *)task) != HC_SUCCESS) {
+                HcFree(task);
+                return -1;
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(g_authBenchMutex);
+    g_authBenchCond.wait(lock, [] { return g_authBenchDoneNum == AUTH_BENCH_REQUEST_NUM; });
+    return (double)(GetBenchTimeNs() - start) / 1000000000;
+}
+
+/*
+ * The throughput of 32 concurrent authentications of 4 steps each, run through the task workers. It is measured
+ * with the CPU bound steps only, and with a 2 ms wait in every step, which stands in for the round trip to the
+ * peer or to HUKS. The number of workers is TASK_WORKER_NUM of the build.
+ */
+TEST_F(TASK_MANAGER_BENCHMARK, TC_AUTH_THROUGHPUT_01)
+{
+    const uint32_t blockUs[] = { 0, 2000 };
+    InitAuthBenchNumbers();
+    g_authBenchOrderErrorNum = 0;
+    for (uint32_t block : blockUs) {
+        g_authBenchBlockUs = block;
+        vector<double> throughputs;
+        for (uint32_t run = 0; run < AUTH_BENCH_RUN_NUM; run++) {
+            double cost = RunAuthBenchRound();
+            ASSERT_GT(cost, 0);
+            throughputs.push_back(AUTH_BENCH_REQUEST_NUM / cost);
+        }
+        PrintBenchmarkResult("auth_throughput.workers_" + to_string(TASK_WORKER_NUM) + ".block_us_" +
+            to_string(block), throughputs, "auths/s");
+    }
+    EXPECT_EQ(g_authBenchOrderErrorNum, 0u);
+}
+
+static const uint32_t HASH_TO_POINT_LEN = 32;
+static const uint32_t HASH_TO_POINT_RUN_NUM = 20;
+static const uint32_t HASH_TO_POINT_CALL_NUM = 1000;
+static const char *CURVE25519_P_HEX = "7FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFED";
+static const char *CURVE25519_Q_HEX = "3FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF6";
+static const BN_ULONG CURVE25519_A = 486662;
+static const BN_ULONG CURVE25519_U = 2;
+
+/*
+ * The former path of OpensslHashToPoint, which parses the curve constants and allocates a BN_CTX and its big
+ * numbers on every call. The point is padded to 32 bytes, which the former path failed to do.
+ */
+static bool ReferenceHashToPoint(const uint8_t *hash, uint8_t *point)
+{
+    uint8_t buf[HASH_TO_POINT_LEN] = { 0 };
+    for (uint32_t i = 0; i < HASH_TO_POINT_LEN; i++) {
+        buf[i] = hash[HASH_TO_POINT_LEN - 1 - i];
+    }
+    buf[0] &= 0x3f; /* RFC 8032 */
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *p = nullptr;
+    BIGNUM *q = nullptr;
+    BIGNUM *a = BN_new();
+    BIGNUM *b = BN_new();
+    BIGNUM *c = BN_new();
+    BIGNUM *t = BN_new();
+    bool ret = (ctx != nullptr) && (BN_hex2bn(&p, CURVE25519_P_HEX) != 0) && (BN_hex2bn(&q, CURVE25519_Q_HEX) != 0) &&
+        (a != nullptr) && (b != nullptr) && (c != nullptr) && (t != nullptr) &&
+        (BN_bin2bn(buf, sizeof(buf), a) != nullptr) &&
+        /* b := -A / (1 + u * a ^ 2) */
+        BN_mod_sqr(t, a, p, ctx) && BN_mul_word(t, CURVE25519_U) && BN_add_word(t, 1) &&
+        (BN_mod_inverse(t, t, p, ctx) != nullptr) && BN_mul_word(t, CURVE25519_A) && BN_mod_sub(b, p, t, p, ctx) &&
+        /* a := b ^ 3 + A * b ^ 2 + b */
+        BN_mod_sqr(t, b, p, ctx) && BN_mod_mul(a, t, b, p, ctx) && BN_mul_word(t, CURVE25519_A) &&
+        BN_mod_add(a, a, t, p, ctx) && BN_mod_add(a, a, b, p, ctx) &&
+        /* c := -b - A */
+        BN_mod_sub(c, p, b, p, ctx) && BN_sub_word(c, CURVE25519_A) && BN_nnmod(c, c, p, ctx) &&
+        /* the point is b if a is a quadratic residue modulo p, and c otherwise */
+        BN_mod_exp(t, a, q, p, ctx) && (BN_bn2binpad((BN_cmp(q, t) > 0) ? b : c, buf, sizeof(buf)) > 0);
+    for (uint32_t i = 0; i < HASH_TO_POINT_LEN; i++) {
+        point[i] = buf[HASH_TO_POINT_LEN - 1 - i];
+    }
+    BN_free(p);
+    BN_free(q);
+    BN_free(a);
+    BN_free(b);
+    BN_free(c);
+    BN_free(t);
+    BN_CTX_free(ctx);
+    return ret;
+}
+
+/*
+ * The cost of a hash to point of the Curve25519 field kernel, against the former OpenSSL path.
+ * Every random hash is also mapped by both, and the points must be equal.
+ */
+TEST(HASH_TO_POINT_BENCHMARK, TC_HASH_TO_POINT_01)
+{
+    vector<uint8_t> hashes(HASH_TO_POINT_LEN * HASH_TO_POINT_CALL_NUM);
+    vector<uint8_t> points(HASH_TO_POINT_LEN * HASH_TO_POINT_CALL_NUM);
+    vector<uint8_t> refPoints(HASH_TO_POINT_LEN * HASH_TO_POINT_CALL_NUM);
+    vector<double> kernelCosts;
+    vector<double> referenceCosts;
+    srand(HASH_TO_POINT_LEN);
+    for (uint32_t run = 0; run < HASH_TO_POINT_RUN_NUM; run++) {
+        for (uint8_t &val : hashes) {
+            val = (uint8_t)rand();
+        }
+        int64_t start = GetBenchTimeNs();
+        for (uint32_t i = 0; i < HASH_TO_POINT_CALL_NUM; i++) {
+            struct HksBlob hash = { HASH_TO_POINT_LEN, &hashes[i * HASH_TO_POINT_LEN] };
+            struct HksBlob point = { HASH_TO_POINT_LEN, &points[i * HASH_TO_POINT_LEN] };
+            ASSERT_EQ(OpensslHashToPoint(&hash, &point), 0);
+        }
+        kernelCosts.push_back((double)(GetBenchTimeNs() - start) / 1000 / HASH_TO_POINT_CALL_NUM);
+        start = GetBenchTimeNs();
+        for (uint32_t i = 0; i < HASH_TO_POINT_CALL_NUM; i++) {
+            ASSERT_TRUE(ReferenceHashToPoint(&hashes[i * HASH_TO_POINT_LEN], &refPoints[i * HASH_TO_POINT_LEN]));
+        }
+        referenceCosts.push_back((double)(GetBenchTimeNs() - start) / 1000 / HASH_TO_POINT_CALL_NUM);
+        ASSERT_TRUE(points == refPoints);
+    }
+    PrintBenchmarkResult("hash_to_point.kernel", kernelCosts, "us/call");
+    PrintBenchmarkResult("hash_to_point.openssl_reference", referenceCosts, "us/call");
+}
+
+void SESSION_MANAGER_BENCHMARK::SetUp()
+{
+    DeleteBenchDatabase();
+    SetMaxSessionCount(MAX_SESSION_COUNT_LIMIT);
+    InitDeviceAuthService();
+}
+
+void SESSION_MANAGER_BENCHMARK::TearDown()
+{
+    DestroyDeviceAuthService();
+    SetMaxSessionCount(MAX_SESSION_COUNT);
+    SetTimeOffset(0);
+    DeleteBenchDatabase();
+}
+
+static const uint32_t SESSION_BENCH_RUN_NUM = 20;
+static const uint32_t SESSION_BENCH_MESSAGE_NUM = 5000;
+static const uint32_t SESSION_BENCH_MESSAGES_PER_SECOND = 1000;
+static const int64_t SESSION_BENCH_REQUEST_ID_STEP = 7919;
+static DeviceAuthCallback g_sessionBenchCallback = { nullptr };
+
+static char *OnSessionBenchRequest(int64_t requestId, int operationCode, const char *reqParams)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)reqParams;
+    CJson *returnData = CreateJson();
+    (void)AddIntToJson(returnData, FIELD_CONFIRMATION, REQUEST_WAITING);
+    char *returnDataStr = PackJsonToString(returnData);
+    FreeJson(returnData);
+    return returnDataStr;
+}
+
+/* open a server bind session, which waits for the confirmation of the service until it times out */
+static int32_t OpenBenchSession(uint32_t index)
+{
+    char udid[BENCH_ID_LEN] = { 0 };
+    GenerateBenchUdid(index, udid, sizeof(udid));
+    CJson *params = CreateJson();
+    if (params == nullptr) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    int64_t requestId = index * SESSION_BENCH_REQUEST_ID_STEP;
+    (void)AddInt64StringToJson(params, FIELD_REQUEST_ID, requestId);
+    (void)AddIntToJson(params, FIELD_GROUP_OP, MEMBER_INVITE);
+    (void)AddStringToJson(params, FIELD_GROUP_ID, "BENCH_GROUP_A");
+    (void)AddIntToJson(params, FIELD_GROUP_TYPE, PEER_TO_PEER_GROUP);
+    (void)AddStringToJson(params, FIELD_PEER_DEVICE_ID, udid);
+    (void)AddStringToJson(params, FIELD_APP_ID, BENCH_APP_NAME);
+    g_sessionBenchCallback.onRequest = OnSessionBenchRequest;
+    int32_t ret = CreateSession(requestId, TYPE_SERVER_BIND_SESSION, params, &g_sessionBenchCallback);
+    FreeJson(params);
+    return ret;
+}
+
+/* send the logs to /dev/null while a loop is timed, and return the fd to restore stdout with */
+static int MuteStdout(void)
+{
+    (void)fflush(stdout);
+    int stdoutFd = dup(STDOUT_FILENO);
+    int nullFd = open("/dev/null", O_WRONLY);
+    if ((stdoutFd < 0) || (nullFd < 0) || (dup2(nullFd, STDOUT_FILENO) < 0)) {
+        close(stdoutFd);
+        close(nullFd);
+        return -1;
+    }
+    close(nullFd);
+    return stdoutFd;
+}
+
+static void RestoreStdout(int stdoutFd)
+{
+    (void)fflush(stdout);
+    (void)dup2(stdoutFd, STDOUT_FILENO);
+    close(stdoutFd);
+}
+
+/*
+ * The dispatch of a message to a session, with 30 to 4000 open sessions. Every message moves the timer wheel
+ * and looks the session up by its request, the clock moves one second every 1000 messages. The messages are
+ * of the auth type, so the bind sessions are found but not run. The logs of the dispatch go to /dev/null while
+ * it is timed, it would be the cost of the log otherwise.
+ */
+TEST_F(SESSION_MANAGER_BENCHMARK, TC_SESSION_DISPATCH_01)
+{
+    const uint32_t sessionNums[] = { 30, 1000, 4000 };
+    uint32_t openedNum = 0;
+    int64_t timeOffset = 0;
+    for (uint32_t sessionNum : sessionNums) {
+        for (; openedNum < sessionNum; openedNum++) {
+            ASSERT_EQ(OpenBenchSession(openedNum), HC_SUCCESS);
+        }
+        vector<double> costs;
+        uint32_t foundNum = 0;
+        for (uint32_t run = 0; run < SESSION_BENCH_RUN_NUM; run++) {
+            int stdoutFd = MuteStdout();
+            ASSERT_GE(stdoutFd, 0);
+            int64_t start = GetBenchTimeNs();
+            for (uint32_t i = 0; i < SESSION_BENCH_MESSAGE_NUM; i++) {
+                if ((i % SESSION_BENCH_MESSAGES_PER_SECOND) == 0) {
+                    SetTimeOffset(++timeOffset);
+                }
+                int64_t requestId = (i % sessionNum) * SESSION_BENCH_REQUEST_ID_STEP;
+                foundNum += IsRequestExist(requestId) ? 1 : 0;
+                (void)ProcessSession(requestId, AUTH_TYPE, nullptr);
+            }
+            costs.push_back((double)(GetBenchTimeNs() - start) / SESSION_BENCH_MESSAGE_NUM);
+            RestoreStdout(stdoutFd);
+        }
+        /* no session has expired during the runs */
+        EXPECT_EQ(foundNum, SESSION_BENCH_RUN_NUM * SESSION_BENCH_MESSAGE_NUM);
+        SessionMemoryStat stat;
+        GetSessionMemoryStat(&stat);
+        EXPECT_EQ(stat.sessionCount, sessionNum);
+        PrintBenchmarkResult("session_dispatch." + to_string(sessionNum), costs, "ns/message");
+    }
+}
+
+static const uint32_t SESSION_SOAK_ROUND_NUM = 50;
+static const uint32_t SESSION_SOAK_SESSION_NUM = 1000;
+static const uint32_t SESSION_SOAK_MESSAGE_NUM = 4;
+
+/*
+ * The soak of the session pools: every round opens 1000 sessions, dispatches 4 messages to each and destroys them.
+ * It reports the cost of the whole life of a session, and the memory reserved per open session. All the memory
+ * but the kept slabs must be given back after every round.
+ */
+TEST_F(SESSION_MANAGER_BENCHMARK, TC_SESSION_SOAK_01)
+{
+    SessionMemoryStat stat;
+    GetSessionMemoryStat(&stat);
+    uint32_t idleReservedBytes = stat.reservedBytes;
+    vector<double> lifeCosts;
+    vector<double> reservedBytes;
+    for (uint32_t round = 0; round < SESSION_SOAK_ROUND_NUM; round++) {
+        int stdoutFd = MuteStdout();
+        ASSERT_GE(stdoutFd, 0);
+        int64_t start = GetBenchTimeNs();
+        uint32_t openedNum = 0;
+        for (uint32_t i = 0; i < SESSION_SOAK_SESSION_NUM; i++) {
+            openedNum += (OpenBenchSession(i) == HC_SUCCESS) ? 1 : 0;
+        }
+        GetSessionMemoryStat(&stat);
+        for (uint32_t msg = 0; msg < SESSION_SOAK_MESSAGE_NUM; msg++) {
+            for (uint32_t i = 0; i < SESSION_SOAK_SESSION_NUM; i++) {
+                (void)ProcessSession(i * SESSION_BENCH_REQUEST_ID_STEP, AUTH_TYPE, nullptr);
+            }
+        }
+        for (uint32_t i = 0; i < SESSION_SOAK_SESSION_NUM; i++) {
+            DestroySession(i * SESSION_BENCH_REQUEST_ID_STEP);
+        }
+        lifeCosts.push_back((double)(GetBenchTimeNs() - start) / SESSION_SOAK_SESSION_NUM);
+        RestoreStdout(stdoutFd);
+        ASSERT_EQ(openedNum, SESSION_SOAK_SESSION_NUM);
+        ASSERT_EQ(stat.sessionCount, SESSION_SOAK_SESSION_NUM);
+        reservedBytes.push_back((double)stat.reservedBytes / SESSION_SOAK_SESSION_NUM);
+        GetSessionMemoryStat(&stat);
+        ASSERT_EQ(stat.sessionCount, 0u);
+        ASSERT_EQ(stat.usedBytes, 0u);
+        /* one slab is kept by every pool, which the first round may have taken */
+        if (round == 0) {
+            idleReservedBytes = stat.reservedBytes;
+        }
+        ASSERT_EQ(stat.reservedBytes, idleReservedBytes);
+    }
+    PrintBenchmarkResult("session_soak.life", lifeCosts, "ns/session");
+    PrintBenchmarkResult("session_soak.reserved", reservedBytes, "bytes/open session");
+}
+
+static const uint32_t BROADCAST_BENCH_RUN_NUM = 5;
+static const uint32_t BROADCAST_BENCH_MUTATION_NUM = 40;
+static const uint32_t BROADCAST_BENCH_SLOW_US = 5000;
+static const uint32_t BROADCAST_BENCH_WAIT_MSEC = 5000;
+static const char *BROADCAST_BENCH_SLOW_APP_NAME = "BenchSlowApp";
+static const char *BROADCAST_BENCH_FAST_APP_NAME = "BenchFastApp";
+
+static std::mutex g_broadcastBenchMutex;
+static std::condition_variable g_broadcastBenchCond;
+static uint32_t g_broadcastBenchSlowNum = 0;
+static uint32_t g_broadcastBenchFastNum = 0;
+static int64_t g_broadcastBenchDeliveredNs = 0;
+
+static void OnBroadcastBenchSlowCreated(const char *groupInfo)
+{
+    (void)groupInfo;
+    (void)usleep(BROADCAST_BENCH_SLOW_US);
+    std::lock_guard<std::mutex> autoLock(g_broadcastBenchMutex);
+    g_broadcastBenchSlowNum++;
+    g_broadcastBenchCond.notify_all();
+}
+
+static void OnBroadcastBenchSlowDevNumChanged(int curTrustedDeviceNum)
+{
+    (void)curTrustedDeviceNum;
+    (void)usleep(BROADCAST_BENCH_SLOW_US);
+}
+
+static void OnBroadcastBenchFastCreated(const char *groupInfo)
+{
+    (void)groupInfo;
+    int64_t now = GetBenchTimeNs();
+    std::lock_guard<std::mutex> autoLock(g_broadcastBenchMutex);
+    g_broadcastBenchFastNum++;
+    g_broadcastBenchDeliveredNs = now;
+    g_broadcastBenchCond.notify_all();
+}
+
+static bool WaitBroadcastBenchNum(const uint32_t &num, uint32_t expectedNum)
+{
+    std::unique_lock<std::mutex> autoLock(g_broadcastBenchMutex);
+    return g_broadcastBenchCond.wait_for(autoLock, std::chrono::milliseconds(BROADCAST_BENCH_WAIT_MSEC),
+        [&num, expectedNum] { return num == expectedNum; });
+}
+
+/*
+ * The cost of a group mutation to its poster, and the latency of its delivery to a fast listener, while another
+ * listener takes 5 ms per callback. Every mutation posts a created group and the trusted device number under a
+ * mutex, as the database does, and waits for the fast listener before the next one. The slow listener must get
+ * all the events in the end, none is dropped since the mutations of a run fit in its queue.
+ */
+TEST(BROADCAST_BENCHMARK, TC_BROADCAST_LATENCY_01)
+{
+    GroupInfo *groupInfo = CreateGroupInfoStruct();
+    ASSERT_NE(groupInfo, nullptr);
+    StringSetPointer(&groupInfo->name, BENCH_APP_NAME);
+    StringSetPointer(&groupInfo->id, BENCH_APP_NAME);
+    StringSetPointer(&groupInfo->ownerName, BENCH_APP_NAME);
+    groupInfo->type = PEER_TO_PEER_GROUP;
+    groupInfo->visibility = GROUP_VISIBILITY_PUBLIC;
+    DataChangeListener slowListener = { 0 };
+    slowListener.onGroupCreated = OnBroadcastBenchSlowCreated;
+    slowListener.onTrustedDeviceNumChanged = OnBroadcastBenchSlowDevNumChanged;
+    DataChangeListener fastListener = { 0 };
+    fastListener.onGroupCreated = OnBroadcastBenchFastCreated;
+    std::mutex databaseMutex;
+    vector<double> postCosts;
+    vector<double> deliveryCosts;
+    for (uint32_t run = 0; run < BROADCAST_BENCH_RUN_NUM; run++) {
+        g_broadcastBenchSlowNum = 0;
+        g_broadcastBenchFastNum = 0;
+        ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+        ASSERT_EQ(AddListener(BROADCAST_BENCH_SLOW_APP_NAME, &slowListener), HC_SUCCESS);
+        ASSERT_EQ(AddListener(BROADCAST_BENCH_FAST_APP_NAME, &fastListener), HC_SUCCESS);
+        for (uint32_t i = 0; i < BROADCAST_BENCH_MUTATION_NUM; i++) {
+            int64_t start = GetBenchTimeNs();
+            databaseMutex.lock();
+            GetBroadcaster()->postOnGroupCreated(groupInfo);
+            GetBroadcaster()->postOnTrustedDeviceNumChanged(i + 1);
+            databaseMutex.unlock();
+            postCosts.push_back((double)(GetBenchTimeNs() - start) / 1000);
+            ASSERT_TRUE(WaitBroadcastBenchNum(g_broadcastBenchFastNum, i + 1));
+            deliveryCosts.push_back((double)(g_broadcastBenchDeliveredNs - start) / 1000);
+        }
+        EXPECT_TRUE(WaitBroadcastBenchNum(g_broadcastBenchSlowNum, BROADCAST_BENCH_MUTATION_NUM));
+        DestroyBroadcastManager();
+    }
+    DestroyGroupInfoStruct(groupInfo);
+    PrintBenchmarkResult("broadcast.post", postCosts, "us/mutation");
+    PrintBenchmarkResult("broadcast.fast_delivery", deliveryCosts, "us/mutation");
+}
+
+static const uint32_t WIRE_BENCH_RUN_NUM = 20;
+static const uint32_t WIRE_BENCH_HANDSHAKE_NUM = 1000;
+static const uint32_t WIRE_BENCH_MSG_NUM = 6;
+static const uint32_t WIRE_BENCH_FIELD_NUM = 4;
+static const uint32_t WIRE_BENCH_ID_LEN = 32;
+static const uint32_t WIRE_BENCH_MAX_FIELD_LEN = 240;
+
+typedef struct {
+    const char *key;
+    uint32_t len;
+} WireBenchField;
+
+typedef struct {
+    int32_t message;
+    WireBenchField fields[WIRE_BENCH_FIELD_NUM];
+} WireBenchMessage;
+
+/* the messages of a standard pake bind, with the sizes of their byte fields */
+static const WireBenchMessage WIRE_BENCH_MESSAGES[WIRE_BENCH_MSG_NUM] = {
+    { 0x0001, { { "peerAuthId", 64 } } },
+    { 0x8001, { { "salt", 16 }, { "epk", 32 }, { "challenge", 16 }, { "peerAuthId", 64 } } },
+    { 0x0002, { { "epk", 32 }, { "kcfData", 32 }, { "challenge", 16 } } },
+    { 0x8002, { { "kcfData", 32 }, { "exAuthInfo", 240 }, { "nonce", 12 } } },
+    { 0x0003, { { "exAuthInfo", 240 }, { "nonce", 12 } } },
+    { 0x8003, { { "exAuthInfo", 240 }, { "nonce", 12 } } },
+};
+
+static void FillWireBenchBytes(uint8_t *bytes, uint32_t len, uint32_t seed)
+{
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t i = 0; i < len; i++) {
+        state = state * 1103515245u + 12345u;
+        bytes[i] = (uint8_t)(state >> 16);
+    }
+}
+
+/* the fields of the bind session which every message carries */
+static bool AddWireBenchSessionFields(CJson *msg)
+{
+    uint8_t id[WIRE_BENCH_ID_LEN] = { 0 };
+    bool isSuccess = true;
+    const char *idKeys[] = { FIELD_GROUP_ID, FIELD_PEER_DEVICE_ID, FIELD_CONN_DEVICE_ID };
+    for (uint32_t i = 0; i < sizeof(idKeys) / sizeof(idKeys[0]); i++) {
+        FillWireBenchBytes(id, sizeof(id), i + 1);
+        isSuccess = isSuccess && (AddByteToJson(msg, idKeys[i], id, sizeof(id)) == HC_SUCCESS);
+    }
+    isSuccess = isSuccess && (AddStringToJson(msg, FIELD_GROUP_NAME, "P2PGroup") == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_GROUP_OP, MEMBER_INVITE) == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_GROUP_TYPE, PEER_TO_PEER_GROUP) == HC_SUCCESS) &&
+        (AddStringToJson(msg, FIELD_APP_ID, "com.example.devicemanager") == HC_SUCCESS) &&
+        (AddStringToJson(msg, FIELD_OWNER_NAME, "com.example.devicemanager") == HC_SUCCESS) &&
+        (AddInt64StringToJson(msg, FIELD_REQUEST_ID, 1634020582345112) == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_GROUP_VISIBILITY, GROUP_VISIBILITY_PUBLIC) == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_USER_TYPE, DEVICE_TYPE_ACCESSORY) == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_EXPIRE_TIME, 90) == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_KEY_LENGTH, 32) == HC_SUCCESS);
+    return isSuccess;
+}
+
+static CJson *CreateWireBenchMessage(const WireBenchMessage *message, uint32_t seed)
+{
+    CJson *msg = CreateJson();
+    CJson *payload = CreateJson();
+    CJson *version = CreateJson();
+    uint8_t bytes[WIRE_BENCH_MAX_FIELD_LEN] = { 0 };
+    bool isSuccess = (msg != nullptr) && (payload != nullptr) && (version != nullptr);
+    for (uint32_t i = 0; isSuccess && (i < WIRE_BENCH_FIELD_NUM) && (message->fields[i].key != nullptr); i++) {
+        FillWireBenchBytes(bytes, message->fields[i].len, seed + i);
+        isSuccess = (AddByteToJson(payload, message->fields[i].key, bytes, message->fields[i].len) == HC_SUCCESS);
+    }
+    isSuccess = isSuccess && (AddStringToJson(version, FIELD_MIN_VERSION, "1.0.0") == HC_SUCCESS) &&
+        (AddStringToJson(version, FIELD_CURRENT_VERSION, "2.0.370") == HC_SUCCESS) &&
+        (AddObjToJson(payload, FIELD_VERSION, version) == HC_SUCCESS) &&
+        (AddIntToJson(msg, FIELD_MESSAGE, message->message) == HC_SUCCESS) &&
+        (AddObjToJson(msg, FIELD_PAYLOAD, payload) == HC_SUCCESS) && AddWireBenchSessionFields(msg);
+    FreeJson(version);
+    FreeJson(payload);
+    if (!isSuccess) {
+        FreeJson(msg);
+        return nullptr;
+    }
+    return msg;
+}
+
+/*
+ * The bytes on the wire and the cost of the encoding and the decoding of the six messages of a standard pake
+ * bind, in the text form and in the binary form. The messages carry the byte fields at their real sizes and the
+ * fields of the bind session. The text costs are those of the json library of the build.
+ */
+TEST(JSON_BINARY_BENCHMARK, TC_JSON_BINARY_01)
+{
+    CJson *msgs[WIRE_BENCH_MSG_NUM] = { nullptr };
+    char *texts[WIRE_BENCH_MSG_NUM] = { nullptr };
+    uint8_t *datas[WIRE_BENCH_MSG_NUM] = { nullptr };
+    uint32_t dataLens[WIRE_BENCH_MSG_NUM] = { 0 };
+    uint32_t textBytes = 0;
+    uint32_t binaryBytes = 0;
+    for (uint32_t i = 0; i < WIRE_BENCH_MSG_NUM; i++) {
+        msgs[i] = CreateWireBenchMessage(&WIRE_BENCH_MESSAGES[i], i * WIRE_BENCH_FIELD_NUM);
+        ASSERT_NE(msgs[i], nullptr);
+        texts[i] = PackJsonToString(msgs[i]);
+        datas[i] = PackJsonToBinary(msgs[i], &dataLens[i]);
+        ASSERT_NE(texts[i], nullptr);
+        ASSERT_NE(datas[i], nullptr);
+        textBytes += strlen(texts[i]) + 1;
+        binaryBytes += dataLens[i];
+        CJson *decoded = CreateJsonFromData(datas[i], dataLens[i]);
+        ASSERT_NE(decoded, nullptr);
+        char *decodedText = PackJsonToString(decoded);
+        EXPECT_STREQ(decodedText, texts[i]);
+        FreeJsonString(decodedText);
+        FreeJson(decoded);
+    }
+    printf("[  BENCH   ] json_binary.bytes: text %u, binary %u (%.1f%%) bytes/handshake\n", textBytes, binaryBytes,
+        100.0 * binaryBytes / textBytes);
+    RecordProperty("json_binary.text_bytes", to_string(textBytes));
+    RecordProperty("json_binary.binary_bytes", to_string(binaryBytes));
+    EXPECT_LT(binaryBytes, textBytes);
+    vector<double> textEncodeCosts;
+    vector<double> textDecodeCosts;
+    vector<double> binaryEncodeCosts;
+    vector<double> binaryDecodeCosts;
+    for (uint32_t run = 0; run < WIRE_BENCH_RUN_NUM; run++) {
+        int64_t start = GetBenchTimeNs();
+        for (uint32_t n = 0; n < WIRE_BENCH_HANDSHAKE_NUM; n++) {
+            for (uint32_t i = 0; i < WIRE_BENCH_MSG_NUM; i++) {
+                FreeJsonString(PackJsonToString(msgs[i]));
+            }
+        }
+        int64_t textEncodeEnd = GetBenchTimeNs();
+        for (uint32_t n = 0; n < WIRE_BENCH_HANDSHAKE_NUM; n++) {
+            for (uint32_t i = 0; i < WIRE_BENCH_MSG_NUM; i++) {
+                FreeJson(CreateJsonFromString(texts[i]));
+            }
+        }
+        int64_t textDecodeEnd = GetBenchTimeNs();
+        for (uint32_t n = 0; n < WIRE_BENCH_HANDSHAKE_NUM; n++) {
+            for (uint32_t i = 0; i < WIRE_BENCH_MSG_NUM; i++) {
+                uint32_t dataLen = 0;
+                FreeJsonBinary(PackJsonToBinary(msgs[i], &dataLen));
+            }
+        }
+        int64_t binaryEncodeEnd = GetBenchTimeNs();
+        for (uint32_t n = 0; n < WIRE_BENCH_HANDSHAKE_NUM; n++) {
+            for (uint32_t i = 0; i < WIRE_BENCH_MSG_NUM; i++) {
+                FreeJson(CreateJsonFromBinary(datas[i], dataLens[i]));
+            }
+        }
+        int64_t binaryDecodeEnd = GetBenchTimeNs();
+        textEncodeCosts.push_back((double)(textEncodeEnd - start) / WIRE_BENCH_HANDSHAKE_NUM / 1000);
+        textDecodeCosts.push_back((double)(textDecodeEnd - textEncodeEnd) / WIRE_BENCH_HANDSHAKE_NUM / 1000);
+        binaryEncodeCosts.push_back((double)(binaryEncodeEnd - textDecodeEnd) / WIRE_BENCH_HANDSHAKE_NUM / 1000);
+        binaryDecodeCosts.push_back((double)(binaryDecodeEnd - binaryEncodeEnd) / WIRE_BENCH_HANDSHAKE_NUM / 1000);
+    }
+    for (uint32_t i = 0; i < WIRE_BENCH_MSG_NUM; i++) {
+        FreeJsonBinary(datas[i]);
+        FreeJsonString(texts[i]);
+        FreeJson(msgs[i]);
+    }
+    PrintBenchmarkResult("json_binary.text_encode", textEncodeCosts, "us/handshake");
+    PrintBenchmarkResult("json_binary.text_decode", textDecodeCosts, "us/handshake");
+    PrintBenchmarkResult("json_binary.binary_encode", binaryEncodeCosts, "us/handshake");
+    PrintBenchmarkResult("json_binary.binary_decode", binaryDecodeCosts, "us/handshake");
+}
+
+static const uint32_t HEX_BENCH_RUN_NUM = 20;
+static const uint32_t HEX_BENCH_TOTAL_BYTES = 4 * 1024 * 1024;
+static const uint32_t HEX_BENCH_MAX_LEN = 4096;
+static const uint8_t HEX_BENCH_OUT_OF_HEX = 16;
+
+/* the scalar codec as it was before the vector paths */
+static char ReferenceHexToChar(uint8_t hex)
+{
+    return (hex > 9) ? (hex + 0x37) : (hex + 0x30); /* 9: the last digit, the offsets give A-F and 0-9 */
+}
+
+static void ReferenceByteToHexString(const uint8_t *byte, uint32_t byteLen, char *hexStr)
+{
+    for (uint32_t i = 0; i < byteLen; i++) {
+        hexStr[i * BYTE_TO_HEX_OPER_LENGTH] = ReferenceHexToChar((byte[i] & 0xF0) >> 4); /* 4: the high nibble */
+        hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1] = ReferenceHexToChar(byte[i] & 0x0F);
+    }
+    hexStr[byteLen * BYTE_TO_HEX_OPER_LENGTH] = '\0';
+}
+
+static uint8_t ReferenceCharToHex(char c)
+{
+    if ((c >= 'A') && (c <= 'F')) {
+        return (c - 'A' + DEC);
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return (c - 'a' + DEC);
+    } else if ((c >= '0') && (c <= '9')) {
+        return (c - '0');
+    }
+    return HEX_BENCH_OUT_OF_HEX;
+}
+
+static int32_t ReferenceHexStringToByte(const char *hexStr, uint8_t *byte, uint32_t byteLen)
+{
+    uint32_t realHexLen = strlen(hexStr);
+    if (realHexLen % BYTE_TO_HEX_OPER_LENGTH != 0 || byteLen < realHexLen / BYTE_TO_HEX_OPER_LENGTH) {
+        return HAL_ERR_INVALID_LEN;
+    }
+    for (uint32_t i = 0; i < realHexLen / BYTE_TO_HEX_OPER_LENGTH; i++) {
+        uint8_t high = ReferenceCharToHex(hexStr[i * BYTE_TO_HEX_OPER_LENGTH]);
+        uint8_t low = ReferenceCharToHex(hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1]);
+        if (high == HEX_BENCH_OUT_OF_HEX || low == HEX_BENCH_OUT_OF_HEX) {
+            return HAL_ERR_INVALID_PARAM;
+        }
+        byte[i] = (high << 4) | low; /* 4: Set the high nibble */
+    }
+    return HAL_SUCCESS;
+}
+
+/*
+ * The throughput of the hex codec on the 64 byte and the 4 KB buffers, in MB/s of the raw bytes, against the
+ * scalar codec it replaced. Every run converts 4 MB in buffers of the size.
+ */
+TEST(HEX_CODEC_BENCHMARK, TC_HEX_CODEC_01)
+{
+    vector<uint8_t> byte(HEX_BENCH_MAX_LEN);
+    vector<uint8_t> decoded(HEX_BENCH_MAX_LEN);
+    vector<char> hexStr(HEX_BENCH_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH + 1);
+    for (uint32_t i = 0; i < HEX_BENCH_MAX_LEN; i++) {
+        byte[i] = (uint8_t)(i * 37 + 11); /* 37, 11: spread the values over all the nibbles */
+    }
+    const uint32_t lens[] = { 64, HEX_BENCH_MAX_LEN };
+    for (uint32_t len : lens) {
+        uint32_t callNum = HEX_BENCH_TOTAL_BYTES / len;
+        double megaBytes = (double)HEX_BENCH_TOTAL_BYTES / (1024 * 1024);
+        vector<double> encodeRates;
+        vector<double> decodeRates;
+        vector<double> refEncodeRates;
+        vector<double> refDecodeRates;
+        for (uint32_t run = 0; run < HEX_BENCH_RUN_NUM; run++) {
+            int64_t start = GetBenchTimeNs();
+            for (uint32_t i = 0; i < callNum; i++) {
+                (void)ByteToHexString(byte.data(), len, hexStr.data(), hexStr.size());
+            }
+            int64_t encodeEnd = GetBenchTimeNs();
+            for (uint32_t i = 0; i < callNum; i++) {
+                (void)HexStringToByte(hexStr.data(), decoded.data(), len);
+            }
+            int64_t decodeEnd = GetBenchTimeNs();
+            for (uint32_t i = 0; i < callNum; i++) {
+                ReferenceByteToHexString(byte.data(), len, hexStr.data());
+            }
+            int64_t refEncodeEnd = GetBenchTimeNs();
+            for (uint32_t i = 0; i < callNum; i++) {
+                (void)ReferenceHexStringToByte(hexStr.data(), decoded.data(), len);
+            }
+            int64_t refDecodeEnd = GetBenchTimeNs();
+            encodeRates.push_back(megaBytes * 1e9 / (encodeEnd - start));
+            decodeRates.push_back(megaBytes * 1e9 / (decodeEnd - encodeEnd));
+            refEncodeRates.push_back(megaBytes * 1e9 / (refEncodeEnd - decodeEnd));
+            refDecodeRates.push_back(megaBytes * 1e9 / (refDecodeEnd - refEncodeEnd));
+            ASSERT_EQ(memcmp(byte.data(), decoded.data(), len), 0);
+        }
+        PrintBenchmarkResult("hex_codec.encode." + to_string(len), encodeRates, "MB/s");
+        PrintBenchmarkResult("hex_codec.decode." + to_string(len), decodeRates, "MB/s");
+        PrintBenchmarkResult("hex_codec.reference_encode." + to_string(len), refEncodeRates, "MB/s");
+        PrintBenchmarkResult("hex_codec.reference_decode." + to_string(len), refDecodeRates, "MB/s");
+    }
+}
+
+static const char *PEER_BENCH_CLIENT_DIR = "/data/data/deviceauth/bench_client";
+static const char *PEER_BENCH_SERVER_DIR = "/data/data/deviceauth/bench_server";
+static const char *PEER_BENCH_CLIENT_PATH = "/data/data/deviceauth/bench_client/hcgroup.dat";
+static const char *PEER_BENCH_SERVER_PATH = "/data/data/deviceauth/bench_server/hcgroup.dat";
+static const char *PEER_BENCH_CLIENT_UDID = "D6350E39AD8F11963C181BEEDC11AC85158E04466B68F1F4E6D895237E0FE81C";
+static const char *PEER_BENCH_SERVER_UDID = "ABCDEF00ABCDEF00ABCDEF00ABCDEF00ABCDEF00ABCDEF00ABCDEF00ABCDEF00";
+static const char *PEER_BENCH_PIN_CODE = "123456";
+static const uint32_t PEER_BENCH_WAIT_MSEC = 10000;
+static const int PEER_BENCH_EXPIRE_TIME = 90;
+
+enum PeerBenchFrameType {
+    PEER_FRAME_BIND_DATA = 1,
+    PEER_FRAME_AUTH_DATA,
+    PEER_FRAME_CALL,
+    PEER_FRAME_REPLY,
+    PEER_FRAME_FINISH,
+    PEER_FRAME_ERROR,
+    PEER_FRAME_QUIT
+};
+
+/* the calls of the client device to the server device */
+enum PeerBenchCall {
+    PEER_CALL_GET_STAT = 1,
+    PEER_CALL_DELETE_GROUP,
+    PEER_CALL_STOP_CRYPTO_POOL
+};
+
+typedef struct {
+    uint32_t type;
+    uint32_t dataLen;
+    int64_t requestId;
+} PeerBenchFrameHead;
+
+/* the counters of a device, they are read before and after the measured operations */
+typedef struct {
+    HcMemArenaStat arenaStat;
+    AuthGroupStat authGroupStat;
+} PeerBenchStat;
+
+static int g_peerBenchFd = -1;
+static pid_t g_peerBenchServerPid = -1;
+static std::thread g_peerBenchReader;
+static std::mutex g_peerBenchSendMutex;
+static std::mutex g_peerBenchMutex;
+static std::condition_variable g_peerBenchCond;
+static uint32_t g_peerBenchFinishNum = 0;
+static uint32_t g_peerBenchPeerFinishNum = 0;
+static uint32_t g_peerBenchReplyNum = 0;
+static uint32_t g_peerBenchErrorNum = 0;
+static int g_peerBenchLastOperation = -1;
+static uint32_t g_peerBenchAuthMsgNum = 0;
+static string g_peerBenchGroupId;
+static string g_peerBenchReply;
+static vector<uint8_t> g_peerBenchSessionKey;
+static vector<uint8_t> g_peerBenchPeerSessionKey;
+static set<int64_t> g_peerBenchDoneRequests;
+static map<int64_t, int64_t> g_peerBenchProbeEndTimes;
+
+static bool WritePeerBenchData(const void *data, size_t dataLen)
+{
+    size_t writtenLen = 0;
+    while (writtenLen < dataLen) {
+        ssize_t len = write(g_peerBenchFd, (const char *)data + writtenLen, dataLen - writtenLen);
+        if (len <= 0) {
+            return false;
+        }
+        writtenLen += (size_t)len;
+    }
+    return true;
+}
+
+static bool ReadPeerBenchData(void *data, size_t dataLen)
+{
+    size_t readLen = 0;
+    while (readLen < dataLen) {
+        ssize_t len = read(g_peerBenchFd, (char *)data + readLen, dataLen - readLen);
+        if (len <= 0) {
+            return false;
+        }
+        readLen += (size_t)len;
+    }
+    return true;
+}
+
+static bool SendPeerBenchFrame(uint32_t type, int64_t requestId, const void *data, uint32_t dataLen)
+{
+    PeerBenchFrameHead head = { type, dataLen, requestId };
+    std::lock_guard<std::mutex> autoLock(g_peerBenchSendMutex);
+    return WritePeerBenchData(&head, sizeof(head)) && ((dataLen == 0) || WritePeerBenchData(data, dataLen));
+}
+
+/* the data is terminated with '\0' beyond its length, so that a text can be read as it is */
+static bool ReceivePeerBenchFrame(PeerBenchFrameHead *head, vector<uint8_t> &data)
+{
+    if (!ReadPeerBenchData(head, sizeof(*head))) {
+        return false;
+    }
+    data.assign(head->dataLen + 1, 0);
+    return (head->dataLen == 0) || ReadPeerBenchData(data.data(), head->dataLen);
+}
+
+static void AddPeerBenchNum(uint32_t &num)
+{
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    num++;
+    g_peerBenchCond.notify_all();
+}
+
+static uint32_t GetPeerBenchNum(const uint32_t &num)
+{
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    return num;
+}
+
+static int GetPeerBenchLastOperation(void)
+{
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    return g_peerBenchLastOperation;
+}
+
+/* wait for the number to reach the expected one, any error of the devices ends the wait */
+static bool WaitPeerBenchNum(const uint32_t &num, uint32_t expectedNum)
+{
+    std::unique_lock<std::mutex> autoLock(g_peerBenchMutex);
+    bool isReached = g_peerBenchCond.wait_for(autoLock, std::chrono::milliseconds(PEER_BENCH_WAIT_MSEC),
+        [&num, expectedNum] { return (num >= expectedNum) || (g_peerBenchErrorNum != 0); });
+    return isReached && (g_peerBenchErrorNum == 0);
+}
+
+static bool OnPeerBenchBindTransmit(int64_t requestId, const uint8_t *data, uint32_t dataLen)
+{
+    return SendPeerBenchFrame(PEER_FRAME_BIND_DATA, requestId, data, dataLen);
+}
+
+static void OnPeerBenchSessionKeyReturned(int64_t requestId, const uint8_t *sessionKey, uint32_t sessionKeyLen)
+{
+    (void)requestId;
+    (void)sessionKey;
+    (void)sessionKeyLen;
+}
+
+/* the server tells the client when its side of a bind is done, the other operations are waited for locally */
+static void OnPeerBenchFinish(int64_t requestId, int operationCode, const char *returnData)
+{
+    if (!GetClient() && (operationCode == MEMBER_INVITE)) {
+        (void)SendPeerBenchFrame(PEER_FRAME_FINISH, requestId, nullptr, 0);
+        return;
+    }
+    CJson *returnJson = (operationCode == GROUP_CREATE) ? CreateJsonFromString(returnData) : nullptr;
+    const char *groupId = GetStringFromJson(returnJson, FIELD_GROUP_ID);
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    if (groupId != nullptr) {
+        g_peerBenchGroupId = groupId;
+    }
+    FreeJson(returnJson);
+    g_peerBenchLastOperation = operationCode;
+    g_peerBenchFinishNum++;
+    g_peerBenchCond.notify_all();
+}
+
+static void OnPeerBenchError(int64_t requestId, int operationCode, int errorCode, const char *errorReturn)
+{
+    (void)operationCode;
+    (void)errorCode;
+    (void)errorReturn;
+    if (!GetClient()) {
+        (void)SendPeerBenchFrame(PEER_FRAME_ERROR, requestId, nullptr, 0);
+    }
+    AddPeerBenchNum(g_peerBenchErrorNum);
+}
+
+static char *OnPeerBenchRequest(int64_t requestId, int operationCode, const char *reqParams)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)reqParams;
+    CJson *json = CreateJson();
+    AddIntToJson(json, FIELD_CONFIRMATION, REQUEST_ACCEPTED);
+    AddStringToJson(json, FIELD_PIN_CODE, PEER_BENCH_PIN_CODE);
+    AddStringToJson(json, FIELD_DEVICE_ID, PEER_BENCH_SERVER_UDID);
+    AddIntToJson(json, FIELD_USER_TYPE, DEVICE_TYPE_ACCESSORY);
+    AddIntToJson(json, FIELD_GROUP_VISIBILITY, GROUP_VISIBILITY_PUBLIC);
+    AddIntToJson(json, FIELD_EXPIRE_TIME, PEER_BENCH_EXPIRE_TIME);
+    char *returnDataStr = PackJsonToString(json);
+    FreeJson(json);
+    return returnDataStr;
+}
+
+static DeviceAuthCallback g_peerBenchBindCallback = {
+    OnPeerBenchBindTransmit, OnPeerBenchSessionKeyReturned, OnPeerBenchFinish, OnPeerBenchError, OnPeerBenchRequest
+};
+
+/* the client counts the auth messages of both devices, as all of them pass through it */
+static bool OnPeerBenchAuthTransmit(int64_t requestId, const uint8_t *data, uint32_t dataLen)
+{
+    if (GetClient()) {
+        AddPeerBenchNum(g_peerBenchAuthMsgNum);
+    }
+    return SendPeerBenchFrame(PEER_FRAME_AUTH_DATA, requestId, data, dataLen);
+}
+
+static void OnPeerBenchAuthSessionKey(int64_t requestId, const uint8_t *sessionKey, uint32_t sessionKeyLen)
+{
+    (void)requestId;
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    g_peerBenchSessionKey.assign(sessionKey, sessionKey + sessionKeyLen);
+}
+
+/* the server sends its session key with its finish, so that the client can check that both devices agree */
+static void OnPeerBenchAuthFinish(int64_t requestId, int operationCode, const char *returnData)
+{
+    (void)operationCode;
+    (void)returnData;
+    if (!GetClient()) {
+        vector<uint8_t> sessionKey;
+        {
+            std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+            sessionKey = g_peerBenchSessionKey;
+        }
+        (void)SendPeerBenchFrame(PEER_FRAME_FINISH, requestId, sessionKey.data(), sessionKey.size());
+        return;
+    }
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    g_peerBenchLastOperation = AUTHENTICATE;
+    g_peerBenchDoneRequests.insert(requestId);
+    g_peerBenchFinishNum++;
+    g_peerBenchCond.notify_all();
+}
+
+/* the server accepts the auth of the client device, and lets it be resumed */
+static char *OnPeerBenchAuthRequest(int64_t requestId, int operationCode, const char *reqParams)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)reqParams;
+    CJson *json = CreateJson();
+    AddIntToJson(json, FIELD_CONFIRMATION, REQUEST_ACCEPTED);
+    AddStringToJson(json, FIELD_SERVICE_PKG_NAME, BENCH_APP_NAME);
+    AddStringToJson(json, FIELD_PEER_CONN_DEVICE_ID, PEER_BENCH_CLIENT_UDID);
+    AddBoolToJson(json, FIELD_IS_RESUMABLE, true);
+    char *returnDataStr = PackJsonToString(json);
+    FreeJson(json);
+    return returnDataStr;
+}
+
+static DeviceAuthCallback g_peerBenchAuthCallback = {
+    OnPeerBenchAuthTransmit, OnPeerBenchAuthSessionKey, OnPeerBenchAuthFinish, OnPeerBenchError,
+    OnPeerBenchAuthRequest
+};
+
+/* a probe is an auth of an unknown peer, the task worker of its request rejects it at once */
+static void OnPeerBenchProbeError(int64_t requestId, int operationCode, int errorCode, const char *errorReturn)
+{
+    (void)operationCode;
+    (void)errorCode;
+    (void)errorReturn;
+    int64_t endTime = GetBenchTimeNs();
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    g_peerBenchProbeEndTimes[requestId] = endTime;
+    g_peerBenchCond.notify_all();
+}
+
+static DeviceAuthCallback g_peerBenchProbeCallback = {
+    nullptr, nullptr, nullptr, OnPeerBenchProbeError, nullptr
+};
+
+static void GetPeerBenchStat(PeerBenchStat *stat)
+{
+    (void)memset_s(stat, sizeof(*stat), 0, sizeof(*stat));
+    GetMemArenaStat(&stat->arenaStat);
+    GetAuthGroupStat(&stat->authGroupStat);
+}
+
+static int32_t DeletePeerBenchGroup(int64_t requestId, const string &groupId)
+{
+    string params = "{\"" + string(FIELD_GROUP_ID) + "\":\"" + groupId + "\"}";
+    uint32_t finishNum = GetPeerBenchNum(g_peerBenchFinishNum);
+    int32_t ret = GetGmInstance()->deleteGroup(requestId, BENCH_APP_NAME, params.c_str());
+    if (ret != HC_SUCCESS) {
+        return ret;
+    }
+    return WaitPeerBenchNum(g_peerBenchFinishNum, finishNum + 1) ? HC_SUCCESS : HC_ERR_TIME_OUT;
+}
+
+/* the server runs a call of the client and replies with its result */
+static void HandlePeerBenchCall(int64_t requestId, const vector<uint8_t> &data, uint32_t dataLen)
+{
+    uint32_t call = 0;
+    if (dataLen >= sizeof(call)) {
+        (void)memcpy_s(&call, sizeof(call), data.data(), sizeof(call));
+    }
+    if (call == PEER_CALL_GET_STAT) {
+        PeerBenchStat stat;
+        GetPeerBenchStat(&stat);
+        (void)SendPeerBenchFrame(PEER_FRAME_REPLY, requestId, &stat, sizeof(stat));
+    } else if (call == PEER_CALL_DELETE_GROUP) {
+        string groupId((const char *)data.data() + sizeof(call));
+        int32_t ret = DeletePeerBenchGroup(requestId, groupId);
+        (void)SendPeerBenchFrame(PEER_FRAME_REPLY, requestId, &ret, sizeof(ret));
+    } else if (call == PEER_CALL_STOP_CRYPTO_POOL) {
+        DestroyCryptoPool();
+        int32_t ret = HC_SUCCESS;
+        (void)SendPeerBenchFrame(PEER_FRAME_REPLY, requestId, &ret, sizeof(ret));
+    } else {
+        (void)SendPeerBenchFrame(PEER_FRAME_ERROR, requestId, nullptr, 0);
+    }
+}
+
+/* the server device, it serves the frames of the client until the client quits */
+static int RunPeerBenchServer(void)
+{
+    SetClient(false);
+    SetStoragePath(PEER_BENCH_SERVER_PATH);
+    int nullFd = open("/dev/null", O_WRONLY);
+    if ((nullFd < 0) || (dup2(nullFd, STDOUT_FILENO) < 0)) {
+        return 1;
+    }
+    close(nullFd);
+    string cmd = "rm -rf " + string(PEER_BENCH_SERVER_DIR) + "; mkdir -p " + string(PEER_BENCH_SERVER_DIR);
+    if ((system(cmd.c_str()) != 0) || (InitDeviceAuthService() != HC_SUCCESS)) {
+        return 1;
+    }
+    (void)GetGmInstance()->regCallback(BENCH_APP_NAME, &g_peerBenchBindCallback);
+    PeerBenchFrameHead head;
+    vector<uint8_t> data;
+    while (ReceivePeerBenchFrame(&head, data) && (head.type != PEER_FRAME_QUIT)) {
+        if (head.type == PEER_FRAME_BIND_DATA) {
+            (void)GetGmInstance()->processData(head.requestId, data.data(), head.dataLen);
+        } else if (head.type == PEER_FRAME_AUTH_DATA) {
+            (void)GetGaInstance()->processData(head.requestId, data.data(), head.dataLen, &g_peerBenchAuthCallback);
+        } else if (head.type == PEER_FRAME_CALL) {
+            HandlePeerBenchCall(head.requestId, data, head.dataLen);
+        }
+    }
+    DestroyDeviceAuthService();
+    return 0;
+}
+
+/* the client device takes the frames of the server on its own thread */
+static void ReadPeerBenchFrames(void)
+{
+    PeerBenchFrameHead head;
+    vector<uint8_t> data;
+    while (ReceivePeerBenchFrame(&head, data)) {
+        if (head.type == PEER_FRAME_BIND_DATA) {
+            (void)GetGmInstance()->processData(head.requestId, data.data(), head.dataLen);
+        } else if (head.type == PEER_FRAME_AUTH_DATA) {
+            AddPeerBenchNum(g_peerBenchAuthMsgNum);
+            (void)GetGaInstance()->processData(head.requestId, data.data(), head.dataLen, &g_peerBenchAuthCallback);
+        } else if (head.type == PEER_FRAME_FINISH) {
+            std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+            g_peerBenchPeerSessionKey.assign(data.begin(), data.begin() + head.dataLen);
+            g_peerBenchPeerFinishNum++;
+            g_peerBenchCond.notify_all();
+        } else if (head.type == PEER_FRAME_ERROR) {
+            AddPeerBenchNum(g_peerBenchErrorNum);
+        } else if (head.type == PEER_FRAME_REPLY) {
+            std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+            g_peerBenchReply.assign((const char *)data.data(), head.dataLen);
+            g_peerBenchReplyNum++;
+            g_peerBenchCond.notify_all();
+        }
+    }
+}
+
+static bool CallPeerBenchServer(uint32_t call, const string &arg, string &reply)
+{
+    vector<uint8_t> data(sizeof(call) + arg.size() + 1, 0);
+    (void)memcpy_s(data.data(), data.size(), &call, sizeof(call));
+    (void)memcpy_s(data.data() + sizeof(call), data.size() - sizeof(call), arg.c_str(), arg.size());
+    uint32_t replyNum = GetPeerBenchNum(g_peerBenchReplyNum);
+    if (!SendPeerBenchFrame(PEER_FRAME_CALL, 0, data.data(), data.size()) ||
+        !WaitPeerBenchNum(g_peerBenchReplyNum, replyNum + 1)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    reply = g_peerBenchReply;
+    return true;
+}
+
+static bool GetPeerBenchServerStat(PeerBenchStat *stat)
+{
+    string reply;
+    if (!CallPeerBenchServer(PEER_CALL_GET_STAT, "", reply) || (reply.size() != sizeof(*stat))) {
+        return false;
+    }
+    (void)memcpy_s(stat, sizeof(*stat), reply.data(), reply.size());
+    return true;
+}
+
+static bool DeletePeerBenchServerGroup(const string &groupId)
+{
+    string reply;
+    int32_t ret = HC_ERROR;
+    if (!CallPeerBenchServer(PEER_CALL_DELETE_GROUP, groupId, reply) || (reply.size() != sizeof(ret))) {
+        return false;
+    }
+    (void)memcpy_s(&ret, sizeof(ret), reply.data(), reply.size());
+    return ret == HC_SUCCESS;
+}
+
+static bool StopPeerBenchServerCryptoPool(void)
+{
+    string reply;
+    int32_t ret = HC_ERROR;
+    if (!CallPeerBenchServer(PEER_CALL_STOP_CRYPTO_POOL, "", reply) || (reply.size() != sizeof(ret))) {
+        return false;
+    }
+    (void)memcpy_s(&ret, sizeof(ret), reply.data(), reply.size());
+    return ret == HC_SUCCESS;
+}
+
+static void ResetPeerBenchState(void)
+{
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    g_peerBenchFinishNum = 0;
+    g_peerBenchPeerFinishNum = 0;
+    g_peerBenchReplyNum = 0;
+    g_peerBenchErrorNum = 0;
+    g_peerBenchAuthMsgNum = 0;
+    g_peerBenchLastOperation = -1;
+    g_peerBenchGroupId.clear();
+    g_peerBenchReply.clear();
+    g_peerBenchSessionKey.clear();
+    g_peerBenchPeerSessionKey.clear();
+    g_peerBenchDoneRequests.clear();
+    g_peerBenchProbeEndTimes.clear();
+}
+
+void DEVICE_AUTH_BENCHMARK::SetUp()
+{
+    ResetPeerBenchState();
+    int fds[2] = { -1, -1 };
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    (void)fflush(stdout);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        close(fds[0]);
+        g_peerBenchFd = fds[1];
+        _exit(RunPeerBenchServer());
+    }
+    close(fds[1]);
+    g_peerBenchFd = fds[0];
+    g_peerBenchServerPid = pid;
+    SetClient(true);
+    SetStoragePath(PEER_BENCH_CLIENT_PATH);
+    string cmd = "rm -rf " + string(PEER_BENCH_CLIENT_DIR) + "; mkdir -p " + string(PEER_BENCH_CLIENT_DIR);
+    ASSERT_EQ(system(cmd.c_str()), 0);
+    ASSERT_EQ(InitDeviceAuthService(), HC_SUCCESS);
+    ASSERT_EQ(GetGmInstance()->regCallback(BENCH_APP_NAME, &g_peerBenchBindCallback), HC_SUCCESS);
+    g_peerBenchReader = std::thread(ReadPeerBenchFrames);
+}
+
+void DEVICE_AUTH_BENCHMARK::TearDown()
+{
+    if (g_peerBenchFd >= 0) {
+        (void)SendPeerBenchFrame(PEER_FRAME_QUIT, 0, nullptr, 0);
+        (void)shutdown(g_peerBenchFd, SHUT_WR);
+    }
+    if (g_peerBenchReader.joinable()) {
+        g_peerBenchReader.join();
+    }
+    if (g_peerBenchServerPid > 0) {
+        int status = 0;
+        EXPECT_EQ(waitpid(g_peerBenchServerPid, &status, 0), g_peerBenchServerPid);
+        EXPECT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+        g_peerBenchServerPid = -1;
+    }
+    if (g_peerBenchFd >= 0) {
+        close(g_peerBenchFd);
+        g_peerBenchFd = -1;
+    }
+    DestroyDeviceAuthService();
+    SetClient(false);
+    SetStoragePath(nullptr);
+    string cmd = "rm -rf " + string(PEER_BENCH_CLIENT_DIR) + " " + string(PEER_BENCH_SERVER_DIR);
+    (void)system(cmd.c_str());
+}
+
+/*
+ * The server is forked from the client, so it starts with the keys the client kept from the earlier cases. The
+ * peer keys stay after a group is deleted, so no group name is used twice in a process, else the keys of an old
+ * group would have the aliases of the new one.
+ */
+static uint32_t g_peerBenchGroupNum = 0;
+
+static bool CreatePeerBenchGroup(int64_t requestId, string &groupId)
+{
+    CJson *params = CreateJson();
+    AddIntToJson(params, FIELD_GROUP_TYPE, PEER_TO_PEER_GROUP);
+    AddStringToJson(params, FIELD_DEVICE_ID, PEER_BENCH_CLIENT_UDID);
+    AddIntToJson(params, FIELD_USER_TYPE, DEVICE_TYPE_ACCESSORY);
+    AddIntToJson(params, FIELD_GROUP_VISIBILITY, GROUP_VISIBILITY_PUBLIC);
+    AddIntToJson(params, FIELD_EXPIRE_TIME, PEER_BENCH_EXPIRE_TIME);
+    AddStringToJson(params, FIELD_GROUP_NAME, ("BenchGroup" + to_string(g_peerBenchGroupNum++)).c_str());
+    char *paramsStr = PackJsonToString(params);
+    FreeJson(params);
+    uint32_t finishNum = GetPeerBenchNum(g_peerBenchFinishNum);
+    int32_t ret = GetGmInstance()->createGroup(requestId, BENCH_APP_NAME, paramsStr);
+    FreeJsonString(paramsStr);
+    if ((ret != HC_SUCCESS) || !WaitPeerBenchNum(g_peerBenchFinishNum, finishNum + 1)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    groupId = g_peerBenchGroupId;
+    return !groupId.empty();
+}
+
+/* bind the server into the group of the client, it is done when both devices have finished */
+static bool BindPeerBenchServer(int64_t requestId, const string &groupId)
+{
+    CJson *params = CreateJson();
+    AddStringToJson(params, FIELD_GROUP_ID, groupId.c_str());
+    AddIntToJson(params, FIELD_GROUP_TYPE, PEER_TO_PEER_GROUP);
+    AddStringToJson(params, FIELD_PIN_CODE, PEER_BENCH_PIN_CODE);
+    AddBoolToJson(params, FIELD_IS_ADMIN, true);
+    char *paramsStr = PackJsonToString(params);
+    FreeJson(params);
+    uint32_t finishNum = GetPeerBenchNum(g_peerBenchFinishNum);
+    uint32_t peerFinishNum = GetPeerBenchNum(g_peerBenchPeerFinishNum);
+    int32_t ret = GetGmInstance()->addMemberToGroup(requestId, BENCH_APP_NAME, paramsStr);
+    FreeJsonString(paramsStr);
+    return (ret == HC_SUCCESS) && WaitPeerBenchNum(g_peerBenchFinishNum, finishNum + 1) &&
+        WaitPeerBenchNum(g_peerBenchPeerFinishNum, peerFinishNum + 1) && (GetPeerBenchLastOperation() == MEMBER_INVITE);
+}
+
+static const uint32_t BIND_BENCH_RUN_NUM = 50;
+static const int64_t BIND_BENCH_REQUEST_ID_BASE = 0x2000;
+
+typedef struct {
+    vector<double> costs;
+    vector<double> clientAllocNums;
+    vector<double> serverAllocNums;
+    vector<double> clientFallbackNums;
+    vector<double> serverFallbackNums;
+} BindBenchResult;
+
+/* a round creates a group on the client, binds the server into it, and deletes the group on both devices */
+static bool RunBindBenchRound(uint32_t round, BindBenchResult &result)
+{
+    int64_t requestId = BIND_BENCH_REQUEST_ID_BASE + round * 4; /* 4: the requests of a round */
+    string groupId;
+    PeerBenchStat clientStart;
+    PeerBenchStat serverStart;
+    PeerBenchStat clientEnd;
+    PeerBenchStat serverEnd;
+    if (!CreatePeerBenchGroup(requestId, groupId) || !GetPeerBenchServerStat(&serverStart)) {
+        return false;
+    }
+    GetPeerBenchStat(&clientStart);
+    int64_t start = GetBenchTimeNs();
+    if (!BindPeerBenchServer(requestId + 1, groupId)) {
+        return false;
+    }
+    result.costs.push_back((double)(GetBenchTimeNs() - start) / 1000000);
+    GetPeerBenchStat(&clientEnd);
+    if (!GetPeerBenchServerStat(&serverEnd)) {
+        return false;
+    }
+    result.clientAllocNums.push_back(clientEnd.arenaStat.allocNum - clientStart.arenaStat.allocNum);
+    result.serverAllocNums.push_back(serverEnd.arenaStat.allocNum - serverStart.arenaStat.allocNum);
+    result.clientFallbackNums.push_back(clientEnd.arenaStat.fallbackNum - clientStart.arenaStat.fallbackNum);
+    result.serverFallbackNums.push_back(serverEnd.arenaStat.fallbackNum - serverStart.arenaStat.fallbackNum);
+    return DeletePeerBenchServerGroup(groupId) && (DeletePeerBenchGroup(requestId + 2, groupId) == HC_SUCCESS);
+}
+
+/*
+ * A full pake bind of two devices, from addMemberToGroup on the client until both devices have finished.
+ * It reports the latency, and from GetMemArenaStat, the allocations of each device served by the task arena
+ * and those which fell back to the heap. The chunks still in use after the binds, the current chunks of the
+ * workers among them, show whether the memory kept by the binds pins the arena.
+ */
+TEST_F(DEVICE_AUTH_BENCHMARK, TC_PAKE_BIND_01)
+{
+    BindBenchResult result;
+    int stdoutFd = MuteStdout();
+    ASSERT_GE(stdoutFd, 0);
+    uint32_t doneNum = 0;
+    while ((doneNum < BIND_BENCH_RUN_NUM) && RunBindBenchRound(doneNum, result)) {
+        doneNum++;
+    }
+    PeerBenchStat clientStat;
+    PeerBenchStat serverStat;
+    GetPeerBenchStat(&clientStat);
+    bool isServerStatGot = GetPeerBenchServerStat(&serverStat);
+    RestoreStdout(stdoutFd);
+    ASSERT_EQ(doneNum, BIND_BENCH_RUN_NUM);
+    ASSERT_TRUE(isServerStatGot);
+    PrintBenchmarkResult("pake_bind.latency", result.costs, "ms/bind");
+    PrintBenchmarkResult("pake_bind.client_arena_allocs", result.clientAllocNums, "allocs/bind");
+    PrintBenchmarkResult("pake_bind.server_arena_allocs", result.serverAllocNums, "allocs/bind");
+    PrintBenchmarkResult("pake_bind.client_heap_fallbacks", result.clientFallbackNums, "allocs/bind");
+    PrintBenchmarkResult("pake_bind.server_heap_fallbacks", result.serverFallbackNums, "allocs/bind");
+    printf("[  BENCH   ] pake_bind.pinned_chunks: client %u, server %u of %u\n",
+        clientStat.arenaStat.chunkNum - clientStat.arenaStat.freeChunkNum,
+        serverStat.arenaStat.chunkNum - serverStat.arenaStat.freeChunkNum, clientStat.arenaStat.chunkNum);
+}
+
+/* authenticate the bound server, it is done when both devices have finished with the same session key */
+static bool AuthPeerBenchServer(int64_t requestId, bool isResumable)
+{
+    CJson *params = CreateJson();
+    AddBoolToJson(params, FIELD_IS_CLIENT, true);
+    AddStringToJson(params, FIELD_SERVICE_PKG_NAME, BENCH_APP_NAME);
+    AddStringToJson(params, FIELD_PEER_CONN_DEVICE_ID, PEER_BENCH_SERVER_UDID);
+    AddBoolToJson(params, FIELD_IS_RESUMABLE, isResumable);
+    char *paramsStr = PackJsonToString(params);
+    FreeJson(params);
+    {
+        std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+        g_peerBenchSessionKey.clear();
+        g_peerBenchPeerSessionKey.clear();
+    }
+    uint32_t finishNum = GetPeerBenchNum(g_peerBenchFinishNum);
+    uint32_t peerFinishNum = GetPeerBenchNum(g_peerBenchPeerFinishNum);
+    int32_t ret = GetGaInstance()->authDevice(requestId, paramsStr, &g_peerBenchAuthCallback);
+    FreeJsonString(paramsStr);
+    if ((ret != HC_SUCCESS) || !WaitPeerBenchNum(g_peerBenchFinishNum, finishNum + 1) ||
+        !WaitPeerBenchNum(g_peerBenchPeerFinishNum, peerFinishNum + 1)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> autoLock(g_peerBenchMutex);
+    return !g_peerBenchSessionKey.empty() && (g_peerBenchSessionKey == g_peerBenchPeerSessionKey);
+}
+
+static const uint32_t RESUME_BENCH_RUN_NUM = 100;
+static const int64_t RESUME_BENCH_REQUEST_ID_BASE = 0x4000;
+static const uint32_t AUTH_RESUME_MSG_NUM = 2;
+
+typedef struct {
+    vector<double> costs;
+    vector<double> msgNums;
+    vector<double> clientAllocNums;
+    vector<double> serverAllocNums;
+} PeerAuthBenchResult;
+
+static bool RunPeerAuthBenchRound(int64_t requestId, bool isResumable, PeerAuthBenchResult &result)
+{
+    PeerBenchStat clientStart;
+    PeerBenchStat serverStart;
+    PeerBenchStat clientEnd;
+    PeerBenchStat serverEnd;
+    if (!GetPeerBenchServerStat(&serverStart)) {
+        return false;
+    }
+    GetPeerBenchStat(&clientStart);
+    uint32_t msgNum = GetPeerBenchNum(g_peerBenchAuthMsgNum);
+    int64_t start = GetBenchTimeNs();
+    if (!AuthPeerBenchServer(requestId, isResumable)) {
+        return false;
+    }
+    result.costs.push_back((double)(GetBenchTimeNs() - start) / 1000000);
+    result.msgNums.push_back(GetPeerBenchNum(g_peerBenchAuthMsgNum) - msgNum);
+    GetPeerBenchStat(&clientEnd);
+    if (!GetPeerBenchServerStat(&serverEnd)) {
+        return false;
+    }
+    result.clientAllocNums.push_back(clientEnd.arenaStat.allocNum - clientStart.arenaStat.allocNum);
+    result.serverAllocNums.push_back(serverEnd.arenaStat.allocNum - serverStart.arenaStat.allocNum);
+    return true;
+}
+
+static void PrintPeerAuthBenchResult(const string &name, PeerAuthBenchResult &result)
+{
+    PrintBenchmarkResult(name + ".latency", result.costs, "ms/auth");
+    PrintBenchmarkResult(name + ".messages", result.msgNums, "msgs/auth");
+    PrintBenchmarkResult(name + ".client_arena_allocs", result.clientAllocNums, "allocs/auth");
+    PrintBenchmarkResult(name + ".server_arena_allocs", result.serverAllocNums, "allocs/auth");
+}
+
+/*
+ * The auth of a bound server, the full auth against the resumed one, from authDevice on the client until both
+ * devices have finished with the same session key. The first resumable auth is a full auth which leaves the
+ * resumption secret on both devices, every resumed auth after it replaces the secret with the next one.
+ */
+TEST_F(DEVICE_AUTH_BENCHMARK, TC_AUTH_RESUME_01)
+{
+    PeerAuthBenchResult fullResult;
+    PeerAuthBenchResult resumedResult;
+    int64_t requestId = RESUME_BENCH_REQUEST_ID_BASE;
+    string groupId;
+    int stdoutFd = MuteStdout();
+    ASSERT_GE(stdoutFd, 0);
+    bool isBound = CreatePeerBenchGroup(requestId, groupId) && BindPeerBenchServer(requestId + 1, groupId);
+    requestId += 2; /* 2: the requests of the bind */
+    uint32_t fullNum = 0;
+    while (isBound && (fullNum < RESUME_BENCH_RUN_NUM) && RunPeerAuthBenchRound(requestId++, false, fullResult)) {
+        fullNum++;
+    }
+    bool isSeeded = isBound && AuthPeerBenchServer(requestId++, true);
+    uint32_t resumedNum = 0;
+    while (isSeeded && (resumedNum < RESUME_BENCH_RUN_NUM) && RunPeerAuthBenchRound(requestId++, true, resumedResult)) {
+        resumedNum++;
+    }
+    RestoreStdout(stdoutFd);
+    ASSERT_TRUE(isBound);
+    ASSERT_EQ(fullNum, RESUME_BENCH_RUN_NUM);
+    ASSERT_TRUE(isSeeded);
+    ASSERT_EQ(resumedNum, RESUME_BENCH_RUN_NUM);
+    for (uint32_t i = 0; i < RESUME_BENCH_RUN_NUM; i++) {
+        EXPECT_GT(fullResult.msgNums[i], AUTH_RESUME_MSG_NUM);
+        EXPECT_EQ(resumedResult.msgNums[i], AUTH_RESUME_MSG_NUM);
+    }
+    PrintPeerAuthBenchResult("full_auth", fullResult);
+    PrintPeerAuthBenchResult("resumed_auth", resumedResult);
+}
+
+static const uint32_t AFFINITY_BENCH_RUN_NUM = 50;
+static const int64_t AFFINITY_BENCH_REQUEST_ID_BASE = 0x6000;
+
+/*
+ * The server is bound in two groups of the client and then leaves the first one. The client auths without a
+ * group, so its candidates are both groups. The first auth fails with the first group and falls back to the
+ * second one, every later auth starts with the group of the last successful auth. The counts of the fallbacks
+ * and the reordered candidate lists are taken from GetAuthGroupStat of the client.
+ */
+TEST_F(DEVICE_AUTH_BENCHMARK, TC_AUTH_GROUP_AFFINITY_01)
+{
+    PeerAuthBenchResult result;
+    int64_t requestId = AFFINITY_BENCH_REQUEST_ID_BASE;
+    string leftGroupId;
+    string keptGroupId;
+    PeerBenchStat start;
+    PeerBenchStat end;
+    int stdoutFd = MuteStdout();
+    ASSERT_GE(stdoutFd, 0);
+    bool isReady = CreatePeerBenchGroup(requestId, leftGroupId) && BindPeerBenchServer(requestId + 1, leftGroupId) &&
+        CreatePeerBenchGroup(requestId + 2, keptGroupId) && BindPeerBenchServer(requestId + 3, keptGroupId) &&
+        DeletePeerBenchServerGroup(leftGroupId);
+    requestId += 4; /* 4: the requests of the two binds */
+    GetPeerBenchStat(&start);
+    uint32_t doneNum = 0;
+    while (isReady && (doneNum < AFFINITY_BENCH_RUN_NUM) && RunPeerAuthBenchRound(requestId++, false, result)) {
+        doneNum++;
+    }
+    GetPeerBenchStat(&end);
+    RestoreStdout(stdoutFd);
+    ASSERT_TRUE(isReady);
+    ASSERT_EQ(doneNum, AFFINITY_BENCH_RUN_NUM);
+    uint32_t finishNum = end.authGroupStat.finishCount - start.authGroupStat.finishCount;
+    uint32_t fallbackNum = end.authGroupStat.fallbackCount - start.authGroupStat.fallbackCount;
+    uint32_t firstFailNum = end.authGroupStat.firstFailCount - start.authGroupStat.firstFailCount;
+    uint32_t reorderNum = end.authGroupStat.reorderCount - start.authGroupStat.reorderCount;
+    EXPECT_EQ(finishNum, AFFINITY_BENCH_RUN_NUM);
+    EXPECT_EQ(fallbackNum, 1u);
+    EXPECT_EQ(firstFailNum, 1u);
+    EXPECT_EQ(reorderNum, AFFINITY_BENCH_RUN_NUM - 1);
+    /* the fallback costs the first auth the messages of the failed group, the later auths take the same number */
+    for (uint32_t i = 1; i < AFFINITY_BENCH_RUN_NUM; i++) {
+        EXPECT_LT(result.msgNums[i], result.msgNums[0]);
+        EXPECT_EQ(result.msgNums[i], result.msgNums[1]);
+    }
+    printf("[  BENCH   ] auth_group_affinity.first_auth: %.0f msgs, %.1f ms\n", result.msgNums[0], result.costs[0]);
+    printf("[  BENCH   ] auth_group_affinity.groups: %u auths, %u fallbacks, %u first group failures, "
+        "%u reordered candidate lists\n", finishNum, fallbackNum, firstFailNum, reorderNum);
+    PrintPeerAuthBenchResult("auth_group_affinity", result);
+}
+
+static const uint32_t MIXED_LOAD_STREAM_NUM = 8;
+static const uint32_t MIXED_LOAD_AUTH_NUM = 40;
+static const uint32_t MIXED_LOAD_PROBE_INTERVAL_USEC = 2000;
+static const int64_t MIXED_LOAD_REQUEST_ID_BASE = 0x10000;
+static const int64_t MIXED_LOAD_PHASE_ID_STEP = 0x10000;
+static const int64_t MIXED_LOAD_STREAM_ID_STEP = 0x100;
+static const int64_t MIXED_LOAD_PROBE_ID_OFFSET = 0x8000;
+static const char *MIXED_LOAD_PROBE_UDID = "5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A5A";
+
+typedef struct {
+    vector<double> authCosts;
+    vector<double> probeCosts;
+    uint32_t failedNum;
+} MixedLoadResult;
+
+static bool WaitPeerBenchRequestDone(int64_t requestId)
+{
+    std::unique_lock<std::mutex> autoLock(g_peerBenchMutex);
+    bool isDone = g_peerBenchCond.wait_for(autoLock, std::chrono::milliseconds(PEER_BENCH_WAIT_MSEC),
+        [requestId] { return (g_peerBenchDoneRequests.count(requestId) != 0) || (g_peerBenchErrorNum != 0); });
+    return isDone && (g_peerBenchErrorNum == 0);
+}
+
+/* a stream runs its auths one after another, each one starts when the client has finished the previous one */
+static void RunMixedLoadStream(int64_t requestId, vector<double> &costs, std::atomic<uint32_t> &failedNum)
+{
+    string params = "{\"" + string(FIELD_IS_CLIENT) + "\":true,\"" + string(FIELD_SERVICE_PKG_NAME) + "\":\"" +
+        BENCH_APP_NAME + "\",\"" + string(FIELD_PEER_CONN_DEVICE_ID) + "\":\"" + PEER_BENCH_SERVER_UDID + "\"}";
+    for (uint32_t i = 0; i < MIXED_LOAD_AUTH_NUM; i++, requestId++) {
+        int64_t start = GetBenchTimeNs();
+        if ((GetGaInstance()->authDevice(requestId, params.c_str(), &g_peerBenchAuthCallback) != HC_SUCCESS) ||
+            !WaitPeerBenchRequestDone(requestId)) {
+            failedNum++;
+            return;
+        }
+        costs.push_back((double)(GetBenchTimeNs() - start) / 1000000);
+    }
+}
+
+/* the probes are sent at a fixed interval until the streams are done, then their rejections are waited for */
+static void RunMixedLoadProbes(int64_t requestId, const std::atomic<bool> &isLoaded, MixedLoadResult &result)
+{
+    string params = "{\"" + string(FIELD_IS_CLIENT) + "\":true,\"" + string(FIELD_SERVICE_PKG_NAME) + "\":\"" +
+        BENCH_APP_NAME + "\",\"" + string(FIELD_PEER_CONN_DEVICE_ID) + "\":\"" + MIXED_LOAD_PROBE_UDID + "\"}";
+    map<int64_t, int64_t> startTimes;
+    while (isLoaded.load()) {
+        startTimes[requestId] = GetBenchTimeNs();
+        if (GetGaInstance()->authDevice(requestId, params.c_str(), &g_peerBenchProbeCallback) != HC_SUCCESS) {
+            startTimes.erase(requestId);
+            result.failedNum++;
+        }
+        requestId++;
+        usleep(MIXED_LOAD_PROBE_INTERVAL_USEC);
+    }
+    std::unique_lock<std::mutex> autoLock(g_peerBenchMutex);
+    (void)g_peerBenchCond.wait_for(autoLock, std::chrono::milliseconds(PEER_BENCH_WAIT_MSEC),
+        [&startTimes] { return g_peerBenchProbeEndTimes.size() >= startTimes.size(); });
+    for (const auto &probe : startTimes) {
+        auto end = g_peerBenchProbeEndTimes.find(probe.first);
+        if (end == g_peerBenchProbeEndTimes.end()) {
+            result.failedNum++;
+            continue;
+        }
+        result.probeCosts.push_back((double)(end->second - probe.second) / 1000000);
+    }
+    g_peerBenchProbeEndTimes.clear();
+}
+
+static void RunMixedLoadPhase(int64_t requestId, MixedLoadResult &result)
+{
+    vector<vector<double>> streamCosts(MIXED_LOAD_STREAM_NUM);
+    vector<std::thread> streams;
+    std::atomic<uint32_t> failedNum(0);
+    std::atomic<bool> isLoaded(true);
+    std::thread prober(RunMixedLoadProbes, requestId + MIXED_LOAD_PROBE_ID_OFFSET, std::cref(isLoaded),
+        std::ref(result));
+    for (uint32_t i = 0; i < MIXED_LOAD_STREAM_NUM; i++) {
+        streams.emplace_back(RunMixedLoadStream, requestId + i * MIXED_LOAD_STREAM_ID_STEP, std::ref(streamCosts[i]),
+            std::ref(failedNum));
+    }
+    for (std::thread &stream : streams) {
+        stream.join();
+    }
+    isLoaded = false;
+    prober.join();
+    for (const vector<double> &costs : streamCosts) {
+        result.authCosts.insert(result.authCosts.end(), costs.begin(), costs.end());
+    }
+    result.failedNum += failedNum.load();
+}
+
+/*
+ * The tail latency under a mixed load, with the crypto worker pool and without it. Several streams run auths
+ * with the bound server at once, while a probe, a light request which its task worker rejects at once, is sent
+ * at a fixed interval. Without the pool, a probe waits behind the asymmetric operations of the auths that hash
+ * to the same task worker. The pool is stopped on both devices for the second phase, the auths then take the
+ * synchronous path.
+ */
+TEST_F(DEVICE_AUTH_BENCHMARK, TC_AUTH_MIXED_LOAD_01)
+{
+    MixedLoadResult poolResult = { {}, {}, 0 };
+    MixedLoadResult noPoolResult = { {}, {}, 0 };
+    int64_t requestId = MIXED_LOAD_REQUEST_ID_BASE;
+    string groupId;
+    bool isPoolStarted = (GetAsyncLoaderInstance() != nullptr);
+    int stdoutFd = MuteStdout();
+    ASSERT_GE(stdoutFd, 0);
+    bool isBound = CreatePeerBenchGroup(requestId, groupId) && BindPeerBenchServer(requestId + 1, groupId);
+    if (isBound) {
+        RunMixedLoadPhase(requestId + MIXED_LOAD_PHASE_ID_STEP, poolResult);
+    }
+    uint32_t peerFinishNum = MIXED_LOAD_STREAM_NUM * MIXED_LOAD_AUTH_NUM + 1; /* 1: the finish of the bind */
+    bool isPoolStopped = isBound && WaitPeerBenchNum(g_peerBenchPeerFinishNum, peerFinishNum) &&
+        StopPeerBenchServerCryptoPool();
+    DestroyCryptoPool();
+    if (isPoolStopped) {
+        RunMixedLoadPhase(requestId + MIXED_LOAD_PHASE_ID_STEP * 2, noPoolResult); /* 2: the second phase */
+    }
+    RestoreStdout(stdoutFd);
+    ASSERT_TRUE(isBound);
+    ASSERT_TRUE(isPoolStopped);
+    EXPECT_EQ(poolResult.failedNum, 0u);
+    EXPECT_EQ(noPoolResult.failedNum, 0u);
+    EXPECT_EQ(poolResult.authCosts.size(), MIXED_LOAD_STREAM_NUM * MIXED_LOAD_AUTH_NUM);
+    EXPECT_EQ(noPoolResult.authCosts.size(), MIXED_LOAD_STREAM_NUM * MIXED_LOAD_AUTH_NUM);
+    string poolName = isPoolStarted ? "mixed_load.pool" : "mixed_load.pool_not_built";
+    PrintBenchmarkResult(poolName + ".auth", poolResult.authCosts, "ms");
+    PrintBenchmarkResult(poolName + ".probe", poolResult.probeCosts, "ms");
+    PrintBenchmarkResult("mixed_load.no_pool.auth", noPoolResult.authCosts, "ms");
+    PrintBenchmarkResult("mixed_load.no_pool.probe", noPoolResult.probeCosts, "ms");
+}
@@ -15,16 +15,50 @@
 
 #include "deviceauth_standard_test.h"
 #include "deviceauth_test_mock.h"
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <cstdio>
 #include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 extern "C" {
+#include "alg_loader.h"
+#include "auth_session_common.h"
+#include "auth_session_resume.h"
+#include "auth_session_server.h"
+#include "broadcast_manager.h"
+#include "channel_manager.h"
 #include "common_defs.h"
+#include "common_util.h"
+#include "crypto_hash_to_point.h"
+#include "das_common.h"
+#include "das_version_util.h"
+#include "json_binary.h"
 #include "json_utils.h"
+#include "module_common.h"
 #include "device_auth.h"
 #include "device_auth_defines.h"
 #include "database_manager.h"
 #include "hc_condition.h"
+#include "hc_crypto_pool.h"
+#include "hc_hash_map.h"
+#include "hc_lru_cache.h"
+#include "hc_mem_arena.h"
+#include "hc_mem_pool.h"
 #include "hc_mutex.h"
+#include "hc_parcel.h"
+#include "hc_task_thread.h"
 #include "hc_types.h"
+#include "hc_vector.h"
+#include "hks_api.h"
+#include "pake_base_cur_task.h"
+#include "pake_protocol_common.h"
+#include "session_manager.h"
 }
 
 using namespace std;
@@ -85,9 +119,15 @@ static void RemoveHuks(void)
 static int DeleteDatabase()
 {
     const char *groupPath = "/data/data/deviceauth/hcgroup.dat";
+    const char *journalPath = "/data/data/deviceauth/hcgroup.dat.journal";
+    const char *backupPath = "/data/data/deviceauth/hcgroup.dat.bak";
     int ret;
     ret = RemoveDir(groupPath);
     cout << "[Clear] clear db: done: " << ret << endl;
+    ret = RemoveDir(journalPath);
+    cout << "[Clear] clear db journal: done: " << ret << endl;
+    ret = RemoveDir(backupPath);
+    cout << "[Clear] clear db backup: done: " << ret << endl;
     RemoveHuks();
     /* wait for delete data */
     DelayWithMSec(500);
@@ -285,7 +325,22 @@ enum {
     TRUSTED_DEVICE_NUM_CHANGED
 };
 
-static int g_receivedMessageNum[7] = {0};
+#define LISTENER_TEST_WAIT_MSEC 5000
+
+/* the listeners are called by the broadcast workers */
+static std::atomic<int> g_receivedMessageNum[7] = {};
+
+/* the broadcast is asynchronous, the request may finish before the listener is called */
+static bool WaitReceivedMessageNum(int type, int expectedNum)
+{
+    for (int32_t i = 0; i < LISTENER_TEST_WAIT_MSEC; i++) {
+        if (g_receivedMessageNum[type] == expectedNum) {
+            return true;
+        }
+        DelayWithMSec(1);
+    }
+    return false;
+}
 
 void OnGroupCreated(const char *groupInfo)
 {
@@ -518,6 +573,44 @@ void QUERY_INTERFACE::TearDown()
     ClearTempValue();
 }
 
+void AUTH_GROUP_AFFINITY::SetUpTestCase()
+{
+    DeleteDatabase();
+}
+
+void AUTH_GROUP_AFFINITY::SetUp()
+{
+    InitDeviceAuthService();
+    g_gaCallback = {
+        OnTransmit,
+        OnSessionKeyReturned,
+        OnFinish2,
+        OnError2,
+        OnRequestNormal
+    };
+    g_testGm = GetGmInstance();
+    g_testGm->regCallback(TEST_APP_NAME, &g_gaCallback);
+}
+
+void AUTH_GROUP_AFFINITY::TearDown()
+{
+    DestroyDeviceAuthService();
+    DeleteDatabase();
+    ClearTempValue();
+}
+
+void DATABASE_MANAGER::SetUp()
+{
+    DeleteDatabase();
+    InitDeviceAuthService();
+}
+
+void DATABASE_MANAGER::TearDown()
+{
+    DestroyDeviceAuthService();
+    DeleteDatabase();
+}
+
 /* start cases */
 TEST_F(GET_INSTANCE, TC_GET_GM_INSTANCE)
 {
@@ -1358,6 +1451,118 @@ TEST_F(ADD_MEMBER_TO_GROUP, TC_DEV_P2P_BIND_13)
     EXPECT_EQ(g_operationCode, MEMBER_INVITE);
 }
 
+static CJson *CreateChannelTestMsg(int64_t *requestId)
+{
+    CJson *data = CreateJsonFromString(g_dataBuffer);
+    if (data == nullptr) {
+        return nullptr;
+    }
+    int64_t req = DEFAULT_REQUEST_ID;
+    (void)GetInt64FromJson(data, FIELD_REQUEST_ID, &req);
+    *requestId = (req == CLIENT_REQUEST_ID) ? SERVER_REQUEST_ID : CLIENT_REQUEST_ID;
+    (void)AddInt64StringToJson(data, FIELD_REQUEST_ID, *requestId);
+    return data;
+}
+
+/* the channel handler checks the requestId of the parsed message and takes the ownership of it */
+TEST_F(ADD_MEMBER_TO_GROUP, TC_CHANNEL_MSG_01)
+{
+    ChannelMsgHandler handler = GetChannelMsgHandler();
+    ASSERT_NE(handler, nullptr);
+    CJson *msg = CreateJson();
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(handler(SERVER_REQUEST_ID, msg), HC_ERR_JSON_GET);
+    msg = CreateJson();
+    ASSERT_NE(msg, nullptr);
+    (void)AddInt64StringToJson(msg, FIELD_REQUEST_ID, CLIENT_REQUEST_ID);
+    EXPECT_EQ(handler(SERVER_REQUEST_ID, msg), HC_ERR_INVALID_PARAMS);
+}
+
+/* a bind message received from the channel reaches the bind session without the string round trip */
+TEST_F(ADD_MEMBER_TO_GROUP, TC_CHANNEL_MSG_02)
+{
+    SetClient(true);
+    g_gaCallback.onRequest = OnRequestError1;
+    ASSERT_EQ(g_testGm->regCallback(TEST_APP_NAME, &g_gaCallback), HC_SUCCESS);
+    const char *createParamsStr = "{\"groupType\":256,\"deviceId\":\"3C58C27533D8\",\"userType\":0,\""
+        "groupVisibility\":-1,\"expireTime\":90,\"groupName\":\"P2PGroup\"}";
+    (void)g_testGm->createGroup(TEMP_REQUEST_ID, TEST_APP_NAME, createParamsStr);
+    DelayWithMSec(500);
+    char *addParamsStr = ConstructAddParams13();
+    (void)g_testGm->addMemberToGroup(CLIENT_REQUEST_ID, TEST_APP_NAME, addParamsStr);
+    FreeJsonString(addParamsStr);
+    DelayWithMSec(500);
+    ASSERT_EQ(g_messageCode, ON_TRANSMIT);
+    SetClient(false);
+    int64_t req = DEFAULT_REQUEST_ID;
+    CJson *msg = CreateChannelTestMsg(&req);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(GetChannelMsgHandler()(req, msg), HC_SUCCESS);
+    DelayWithMSec(500);
+    EXPECT_EQ(g_messageCode, ON_ERROR);
+    EXPECT_EQ(g_operationCode, MEMBER_INVITE);
+}
+
+#define SESSION_TEST_TICK_REQUEST_ID 789
+#define SESSION_TEST_MARGIN_TIME 10
+#define SESSION_TEST_IDLE_TIME (TIME_OUT_VALUE * 10)
+
+static void StartSessionTestBind(void)
+{
+    SetClient(true);
+    const char *createParamsStr = "{\"groupType\":256,\"deviceId\":\"3C58C27533D8\",\"userType\":0,\""
+        "groupVisibility\":-1,\"expireTime\":90,\"groupName\":\"P2PGroup\"}";
+    (void)g_testGm->createGroup(TEMP_REQUEST_ID, TEST_APP_NAME, createParamsStr);
+    DelayWithMSec(500);
+    char *addParamsStr = ConstructAddParams13();
+    (void)g_testGm->addMemberToGroup(CLIENT_REQUEST_ID, TEST_APP_NAME, addParamsStr);
+    FreeJsonString(addParamsStr);
+    DelayWithMSec(500);
+}
+
+/* a message of an unknown request moves the timer wheel and reports the expired sessions */
+static void TickSessionTestWheel(int64_t offset)
+{
+    SetTimeOffset(offset);
+    EXPECT_EQ(ProcessSession(SESSION_TEST_TICK_REQUEST_ID, BIND_TYPE, nullptr), HC_ERR_SESSION_NOT_EXIST);
+}
+
+/* a session expires when the wheel reaches its create time plus TIME_OUT_VALUE, not before */
+TEST_F(ADD_MEMBER_TO_GROUP, TC_SESSION_TIMEOUT_01)
+{
+    SetTimeOffset(0);
+    StartSessionTestBind();
+    ASSERT_EQ(g_messageCode, ON_TRANSMIT);
+    ASSERT_TRUE(IsRequestExist(CLIENT_REQUEST_ID));
+    /* the test itself takes real time, so the ticks keep a margin around the timeout */
+    TickSessionTestWheel(TIME_OUT_VALUE - SESSION_TEST_MARGIN_TIME);
+    EXPECT_TRUE(IsRequestExist(CLIENT_REQUEST_ID));
+    EXPECT_EQ(g_messageCode, ON_TRANSMIT);
+    TickSessionTestWheel(TIME_OUT_VALUE + SESSION_TEST_MARGIN_TIME);
+    EXPECT_FALSE(IsRequestExist(CLIENT_REQUEST_ID));
+    EXPECT_EQ(g_messageCode, ON_ERROR);
+    EXPECT_EQ(g_requestId, CLIENT_REQUEST_ID);
+    EXPECT_EQ(g_errorCode, HC_ERR_TIME_OUT);
+    SetTimeOffset(0);
+}
+
+/* an idle gap longer than the span of the wheel still expires the session once */
+TEST_F(ADD_MEMBER_TO_GROUP, TC_SESSION_TIMEOUT_02)
+{
+    SetTimeOffset(0);
+    StartSessionTestBind();
+    ASSERT_EQ(g_messageCode, ON_TRANSMIT);
+    ASSERT_TRUE(IsRequestExist(CLIENT_REQUEST_ID));
+    TickSessionTestWheel(SESSION_TEST_IDLE_TIME);
+    EXPECT_FALSE(IsRequestExist(CLIENT_REQUEST_ID));
+    EXPECT_EQ(g_messageCode, ON_ERROR);
+    EXPECT_EQ(g_errorCode, HC_ERR_TIME_OUT);
+    g_messageCode = ON_TRANSMIT;
+    TickSessionTestWheel(SESSION_TEST_IDLE_TIME + TIME_OUT_VALUE);
+    EXPECT_EQ(g_messageCode, ON_TRANSMIT);
+    SetTimeOffset(0);
+}
+
 TEST_F(REGISTER_LISTENER, TC_LISTENER_01)
 {
     DataChangeListener listener;
@@ -1438,7 +1643,8 @@ TEST_F(REGISTER_LISTENER, TC_LISTENER_05)
                                    "groupVisibility\":-1,\"expireTime\":90,\"groupName\":\"P2PGroup\"}";
     g_testGm->createGroup(TEMP_REQUEST_ID, TEST_APP_NAME, createParamsStr);
     g_testCondition.wait(&g_testCondition);
-    EXPECT_EQ(g_receivedMessageNum[GROUP_CREATED], 1);
+    EXPECT_TRUE(WaitReceivedMessageNum(GROUP_CREATED, 1));
+    EXPECT_TRUE(WaitReceivedMessageNum(TRUSTED_DEVICE_NUM_CHANGED, 1));
 }
 
 TEST_F(REGISTER_LISTENER, TC_LISTENER_06)
@@ -1457,9 +1663,12 @@ TEST_F(REGISTER_LISTENER, TC_LISTENER_06)
                                    "groupVisibility\":-1,\"expireTime\":90,\"groupName\":\"P2PGroup\"}";
     g_testGm->createGroup(TEMP_REQUEST_ID, TEST_APP_NAME, createParamsStr);
     g_testCondition.wait(&g_testCondition);
+    /* the pending changes of the device number are coalesced, let the first one arrive before the next */
+    EXPECT_TRUE(WaitReceivedMessageNum(TRUSTED_DEVICE_NUM_CHANGED, 2));
     const char *deleteParamsStr = R"({"groupId": "BC680ED1137A5731F4A5A90B1AACC4A0A3663F6FC2387B7273EFBCC66A54DC0B"})";
     g_testGm->deleteGroup(TEMP_REQUEST_ID, TEST_APP_NAME, deleteParamsStr);
-    DelayWithMSec(500);
+    EXPECT_TRUE(WaitReceivedMessageNum(GROUP_DELETED, 1));
+    EXPECT_TRUE(WaitReceivedMessageNum(TRUSTED_DEVICE_NUM_CHANGED, 3));
     EXPECT_EQ(g_receivedMessageNum[DEVICE_UNBOUND], 1);
     EXPECT_EQ(g_receivedMessageNum[LAST_GROUP_DELETED], 1);
     EXPECT_EQ(g_receivedMessageNum[TRUSTED_DEVICE_NUM_CHANGED], 3);
@@ -1522,3 +1731,3070 @@ TEST_F(QUERY_INTERFACE, TC_QUERY_04)
     EXPECT_EQ(ret, 0);
 }
 
+
+static const uint32_t HASH_MAP_KEY_NUM = 1000;
+static const uint32_t HASH_MAP_KEY_LEN = 16;
+
+static uint32_t GenerateHashMapKey(uint32_t index, char *key, uint32_t keyLen)
+{
+    return static_cast<uint32_t>(sprintf_s(key, keyLen, "key%u", index));
+}
+
+TEST(HASH_MAP, TC_HASH_MAP_01)
+{
+    char key[HASH_MAP_KEY_LEN] = { 0 };
+    HcHashMap map = CreateHashMap(0);
+    EXPECT_EQ(HashMapGet(&map, "key0", strlen("key0")), nullptr);
+    /* the buckets grow several times */
+    for (uint32_t i = 0; i < HASH_MAP_KEY_NUM; i++) {
+        uint32_t keyLen = GenerateHashMapKey(i, key, sizeof(key));
+        ASSERT_TRUE(HashMapPut(&map, key, keyLen, reinterpret_cast<void *>(static_cast<uintptr_t>(i + 1))));
+    }
+    EXPECT_EQ(HashMapSize(&map), HASH_MAP_KEY_NUM);
+    for (uint32_t i = 0; i < HASH_MAP_KEY_NUM; i++) {
+        uint32_t keyLen = GenerateHashMapKey(i, key, sizeof(key));
+        EXPECT_EQ(HashMapGet(&map, key, keyLen), reinterpret_cast<void *>(static_cast<uintptr_t>(i + 1)));
+    }
+    for (uint32_t i = 0; i < HASH_MAP_KEY_NUM; i += 2) {
+        uint32_t keyLen = GenerateHashMapKey(i, key, sizeof(key));
+        EXPECT_TRUE(HashMapRemove(&map, key, keyLen, nullptr));
+        EXPECT_FALSE(HashMapRemove(&map, key, keyLen, nullptr));
+    }
+    EXPECT_EQ(HashMapSize(&map), HASH_MAP_KEY_NUM / 2);
+    for (uint32_t i = 0; i < HASH_MAP_KEY_NUM; i++) {
+        uint32_t keyLen = GenerateHashMapKey(i, key, sizeof(key));
+        void *expected = (i % 2 == 0) ? nullptr : reinterpret_cast<void *>(static_cast<uintptr_t>(i + 1));
+        EXPECT_EQ(HashMapGet(&map, key, keyLen), expected);
+    }
+    /* a key is compared by length too, "key1" is not "key1" plus '\0' */
+    EXPECT_EQ(HashMapGet(&map, "key1", strlen("key1") + 1), nullptr);
+    ClearHashMap(&map);
+    EXPECT_EQ(HashMapSize(&map), 0u);
+    EXPECT_EQ(HashMapGet(&map, "key1", strlen("key1")), nullptr);
+    EXPECT_FALSE(HashMapPut(&map, nullptr, 1, nullptr));
+    EXPECT_FALSE(HashMapPut(&map, "key1", 0, nullptr));
+    DestroyHashMap(&map);
+}
+
+TEST(HASH_MAP, TC_HASH_MAP_02)
+{
+    static const uint32_t dupNum = 4;
+    const char *dupKey = "udid";
+    int values[dupNum] = { 0 };
+    char key[HASH_MAP_KEY_LEN] = { 0 };
+    HcHashMap map = CreateHashMap(0);
+    /* the elements with the same key are put between the others, so that the chains are split by the growth */
+    for (uint32_t i = 0; i < HASH_MAP_KEY_NUM; i++) {
+        if (i % (HASH_MAP_KEY_NUM / dupNum) == 0) {
+            ASSERT_TRUE(HashMapPut(&map, dupKey, strlen(dupKey), &values[i / (HASH_MAP_KEY_NUM / dupNum)]));
+        }
+        uint32_t keyLen = GenerateHashMapKey(i, key, sizeof(key));
+        ASSERT_TRUE(HashMapPut(&map, key, keyLen, nullptr));
+    }
+    /* the elements with the same key are found in the order of insertion */
+    EXPECT_EQ(HashMapGet(&map, dupKey, strlen(dupKey)), &values[0]);
+    uint32_t count = 0;
+    for (const HcHashNode *node = HashMapFind(&map, dupKey, strlen(dupKey)); node != nullptr;
+        node = HashMapFindNext(node)) {
+        ASSERT_LT(count, dupNum);
+        EXPECT_EQ(node->value, &values[count]);
+        count++;
+    }
+    EXPECT_EQ(count, dupNum);
+    /* the order is kept after removing an element in the middle and the first one */
+    EXPECT_TRUE(HashMapRemove(&map, dupKey, strlen(dupKey), &values[2]));
+    EXPECT_TRUE(HashMapRemove(&map, dupKey, strlen(dupKey), nullptr));
+    const HcHashNode *node = HashMapFind(&map, dupKey, strlen(dupKey));
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->value, &values[1]);
+    node = HashMapFindNext(node);
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->value, &values[3]);
+    EXPECT_EQ(HashMapFindNext(node), nullptr);
+    DestroyHashMap(&map);
+}
+
+static const uint32_t DB_TEST_DEVICE_NUM = 1000;
+static const uint32_t DB_TEST_ID_LEN = 65;
+
+static int32_t AddDbTestGroup(const char *groupId, const char *ownerName, int32_t groupType = PEER_TO_PEER_GROUP,
+    int32_t visibility = GROUP_VISIBILITY_PUBLIC)
+{
+    GroupInfo *groupInfo = CreateGroupInfoStruct();
+    if (groupInfo == nullptr) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    StringSetPointer(&groupInfo->name, groupId);
+    StringSetPointer(&groupInfo->id, groupId);
+    StringSetPointer(&groupInfo->ownerName, ownerName);
+    groupInfo->type = groupType;
+    groupInfo->visibility = visibility;
+    groupInfo->expireTime = -1;
+    int32_t ret = AddGroup(groupInfo);
+    DestroyGroupInfoStruct(groupInfo);
+    return ret;
+}
+
+static int32_t AddDbTestDevice(const char *groupId, const char *udid)
+{
+    DeviceInfo *deviceInfo = CreateDeviceInfoStruct();
+    if (deviceInfo == nullptr) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    deviceInfo->devType = DEVICE_TYPE_ACCESSORY;
+    StringSetPointer(&deviceInfo->authId, udid);
+    StringSetPointer(&deviceInfo->udid, udid);
+    StringSetPointer(&deviceInfo->groupId, groupId);
+    StringSetPointer(&deviceInfo->serviceType, groupId);
+    int32_t ret = AddTrustedDevice(deviceInfo, nullptr);
+    DestroyDeviceInfoStruct(deviceInfo);
+    return ret;
+}
+
+static void GenerateDbTestUdid(uint32_t index, char *udid, uint32_t udidLen)
+{
+    (void)sprintf_s(udid, udidLen, "%064X", index);
+}
+
+static double GetElapsedMs(const struct timespec *start)
+{
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/*
+ * the lookups by udid and by authId, the time of them is printed as a benchmark of the device indexes.
+ * The devices are in an account group, the peer to peer groups are limited to HC_TRUST_DEV_ENTRY_MAX_NUM.
+ */
+TEST_F(DATABASE_MANAGER, TC_DEVICE_INDEX_01)
+{
+    const char *groupIdA = "DB_TEST_GROUP_A";
+    const char *groupIdB = "DB_TEST_GROUP_B";
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    ASSERT_EQ(AddDbTestGroup(groupIdA, TEST_APP_NAME, IDENTICAL_ACCOUNT_GROUP), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup(groupIdB, TEST_APP_NAME), HC_SUCCESS);
+    for (uint32_t i = 0; i < DB_TEST_DEVICE_NUM; i++) {
+        GenerateDbTestUdid(i, udid, sizeof(udid));
+        ASSERT_EQ(AddDbTestDevice(groupIdA, udid), HC_SUCCESS);
+    }
+    GenerateDbTestUdid(0, udid, sizeof(udid));
+    EXPECT_EQ(AddDbTestDevice(groupIdA, udid), HC_ERR_DEVICE_DUPLICATE);
+    /* a device in two groups */
+    ASSERT_EQ(AddDbTestDevice(groupIdB, udid), HC_SUCCESS);
+    struct timespec start;
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < DB_TEST_DEVICE_NUM; i++) {
+        GenerateDbTestUdid(i, udid, sizeof(udid));
+        EXPECT_TRUE(IsTrustedDeviceInGroup(groupIdA, udid));
+        EXPECT_TRUE(IsTrustedDeviceInGroupByAuthId(groupIdA, udid));
+        EXPECT_TRUE(IsTrustedDeviceExist(udid));
+        EXPECT_EQ(IsTrustedDeviceInGroup(groupIdB, udid), i == 0);
+    }
+    double costTime = GetElapsedMs(&start);
+    PRINT_COST_TIME(costTime)
+    GenerateDbTestUdid(DB_TEST_DEVICE_NUM, udid, sizeof(udid));
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+    /* the device is still trusted through the other group */
+    GenerateDbTestUdid(0, udid, sizeof(udid));
+    EXPECT_EQ(DelTrustedDevice(udid, groupIdA), HC_SUCCESS);
+    EXPECT_FALSE(IsTrustedDeviceInGroup(groupIdA, udid));
+    EXPECT_TRUE(IsTrustedDeviceExist(udid));
+    EXPECT_EQ(DelTrustedDeviceByAuthId(udid, groupIdB), HC_SUCCESS);
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+    /* the indexes are rebuilt from the saved database */
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    GenerateDbTestUdid(1, udid, sizeof(udid));
+    EXPECT_TRUE(IsTrustedDeviceInGroup(groupIdA, udid));
+    EXPECT_TRUE(IsTrustedDeviceInGroupByAuthId(groupIdA, udid));
+    GenerateDbTestUdid(0, udid, sizeof(udid));
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+}
+
+static const char *DB_TEST_FILE_PATH = "/data/data/deviceauth/hcgroup.dat";
+static const uint16_t DB_V1_TAG = 0x0001;
+static const uint16_t DB_V2_HEAD_TAG = 0x0003;
+static const uint32_t DB_TLV_MAX_LEN = 32 * 1024;
+
+/* a database saved by the version 1 code: a group with a manager and a friend, and a device of the group */
+static const char *g_dbV1Hex =
+    "0100f6000160040001000000026083000100000001007b0001400e0056315f47524f55505f4e414d450002400c005631"
+    "5f47524f55505f494400034004000001000004400400ffffffff054004005a0000000640080000000000000000000740"
+    "000008401b000800000054657374417070000b0000004d616e616765724170700009400e000a000000467269656e6441"
+    "707000036063000100000002005b0001410c0056315f47524f55505f4944000241080056315f554449440003410b0056"
+    "315f415554485f49440004410c0056315f47524f55505f49440005410000064118000201000000000000000000000000"
+    "00000000000000000000";
+
+static bool ReadDbTestFile(const char *path, vector<uint8_t> &data)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+    uint8_t buff[BUFFER_SIZE];
+    size_t readLen;
+    data.clear();
+    while ((readLen = fread(buff, 1, sizeof(buff), fp)) > 0) {
+        data.insert(data.end(), buff, buff + readLen);
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool WriteDbTestFile(const char *path, const vector<uint8_t> &data)
+{
+    (void)system("mkdir -p /data/data/deviceauth");
+    FILE *fp = fopen(path, "wb");
+    if (fp == nullptr) {
+        return false;
+    }
+    bool ret = (fwrite(data.data(), 1, data.size(), fp) == data.size());
+    fclose(fp);
+    return ret;
+}
+
+static uint16_t GetDbFileTag(const vector<uint8_t> &data)
+{
+    return (data.size() < sizeof(uint16_t)) ? 0 : static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static void CheckDbTestGroup(const char *groupId, const char *groupName, const char *ownerName,
+    int32_t groupType = PEER_TO_PEER_GROUP)
+{
+    GroupInfo *groupInfo = CreateGroupInfoStruct();
+    ASSERT_NE(groupInfo, nullptr);
+    EXPECT_EQ(GetGroupEntryByGroupId(groupId, groupInfo), HC_SUCCESS);
+    EXPECT_STREQ(StringGet(&groupInfo->name), groupName);
+    EXPECT_STREQ(StringGet(&groupInfo->ownerName), ownerName);
+    EXPECT_EQ(groupInfo->type, groupType);
+    DestroyGroupInfoStruct(groupInfo);
+    EXPECT_TRUE(IsGroupOwner(groupId, ownerName));
+}
+
+/* the database is larger than a single TLV node, and it is loaded from the snapshot alone */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_FORMAT_01)
+{
+    const char *groupId = "DB_TEST_GROUP_A";
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    ASSERT_EQ(AddDbTestGroup(groupId, TEST_APP_NAME, IDENTICAL_ACCOUNT_GROUP), HC_SUCCESS);
+    ASSERT_EQ(AddGroupFriend(groupId, "FriendApp"), HC_SUCCESS);
+    for (uint32_t i = 0; i < DB_TEST_DEVICE_NUM; i++) {
+        GenerateDbTestUdid(i, udid, sizeof(udid));
+        ASSERT_EQ(AddDbTestDevice(groupId, udid), HC_SUCCESS);
+    }
+    /* the first restart compacts the journal into the snapshot, the second one only loads the snapshot */
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    DestroyDeviceAuthService();
+    vector<uint8_t> data;
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_FILE_PATH, data));
+    EXPECT_EQ(GetDbFileTag(data), DB_V2_HEAD_TAG);
+    EXPECT_GT(data.size(), DB_TLV_MAX_LEN);
+    struct timespec start;
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    InitDeviceAuthService();
+    double costTime = GetElapsedMs(&start);
+    PRINT_COST_TIME(costTime)
+    CheckDbTestGroup(groupId, groupId, TEST_APP_NAME, IDENTICAL_ACCOUNT_GROUP);
+    EXPECT_TRUE(IsGroupAccessible(groupId, "FriendApp"));
+    for (uint32_t i = 0; i < DB_TEST_DEVICE_NUM; i++) {
+        GenerateDbTestUdid(i, udid, sizeof(udid));
+        EXPECT_TRUE(IsTrustedDeviceInGroup(groupId, udid));
+    }
+}
+
+TEST_F(DATABASE_MANAGER, TC_DATABASE_FORMAT_02)
+{
+    DestroyDeviceAuthService();
+    vector<uint8_t> data(strlen(g_dbV1Hex) / BYTE_TO_HEX_OPER_LENGTH);
+    ASSERT_EQ(HexStringToByte(g_dbV1Hex, data.data(), data.size()), HC_SUCCESS);
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_FILE_PATH, data));
+    InitDeviceAuthService();
+    /* the version 1 database is loaded and migrated at once */
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_FILE_PATH, data));
+    EXPECT_EQ(GetDbFileTag(data), DB_V2_HEAD_TAG);
+    for (uint32_t i = 0; i < 2; i++) {
+        CheckDbTestGroup("V1_GROUP_ID", "V1_GROUP_NAME", TEST_APP_NAME);
+        EXPECT_TRUE(IsGroupEditAllowed("V1_GROUP_ID", "ManagerApp"));
+        EXPECT_TRUE(IsGroupAccessible("V1_GROUP_ID", "FriendApp"));
+        EXPECT_FALSE(IsGroupEditAllowed("V1_GROUP_ID", "OtherApp"));
+        DeviceInfo *deviceInfo = CreateDeviceInfoStruct();
+        ASSERT_NE(deviceInfo, nullptr);
+        EXPECT_EQ(GetDeviceInfoForDevAuth("V1_UDID", "V1_GROUP_ID", deviceInfo), HC_SUCCESS);
+        EXPECT_STREQ(StringGet(&deviceInfo->authId), "V1_AUTH_ID");
+        EXPECT_EQ(deviceInfo->credential, 2);
+        EXPECT_EQ(deviceInfo->devType, 1);
+        DestroyDeviceInfoStruct(deviceInfo);
+        /* the migrated database is loaded again */
+        DestroyDeviceAuthService();
+        InitDeviceAuthService();
+    }
+    EXPECT_NE(GetDbFileTag(data), DB_V1_TAG);
+}
+
+static const char *DB_TEST_JOURNAL_PATH = "/data/data/deviceauth/hcgroup.dat.journal";
+
+/* a crash between saving the snapshot and removing the journal leaves the compacted records behind */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_01)
+{
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    GenerateDbTestUdid(0, udid, sizeof(udid));
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestDevice("DB_TEST_GROUP_B", udid), HC_SUCCESS);
+    /* the records that add the group, the deletion may have been saved in a full snapshot instead of the journal */
+    vector<uint8_t> journal;
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    ASSERT_EQ(DelGroupByGroupId("DB_TEST_GROUP_B"), HC_SUCCESS);
+    /* the deletion is replayed from the journal, and the restart compacts the journal */
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+    /* the records compacted into the snapshot are skipped, so the group is not added back */
+    DestroyDeviceAuthService();
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+    /* the new records follow the sequence number of the snapshot */
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_C", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+}
+
+/* the records after a gap in the sequence numbers were made on another snapshot, they are dropped */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_02)
+{
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    vector<uint8_t> snapshot;
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_FILE_PATH, snapshot));
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_C", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    /* the journal now holds the record of group C, which follows the record of group B */
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_FILE_PATH, snapshot));
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+}
+
+static const uint32_t DB_JOURNAL_HEAD_LEN = 16;
+static const uint32_t DB_JOURNAL_LEN_POS = 8;
+static const char *DB_TEST_TEMP_PATH = "/data/data/deviceauth/hcgroup.dat.tmp";
+
+/* the offsets of the records in the journal, every record is a head of 4 uint32 and the payload */
+static vector<uint32_t> GetDbJournalRecordPos(const vector<uint8_t> &journal)
+{
+    vector<uint32_t> recordPos;
+    uint32_t pos = 0;
+    while (pos + DB_JOURNAL_HEAD_LEN <= journal.size()) {
+        recordPos.push_back(pos);
+        const uint8_t *len = &journal[pos + DB_JOURNAL_LEN_POS];
+        pos += DB_JOURNAL_HEAD_LEN + (len[0] | (len[1] << 8) | (len[2] << 16) | ((uint32_t)len[3] << 24));
+    }
+    return recordPos;
+}
+
+/* the three records of the groups, written by the last run of the service */
+static void SaveDbTestJournalGroups(vector<uint8_t> &journal, vector<uint32_t> &recordPos)
+{
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_C", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    recordPos = GetDbJournalRecordPos(journal);
+    ASSERT_EQ(recordPos.size(), 3u);
+}
+
+/* a crash in the middle of an append leaves a torn record, the records before it are replayed */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_03)
+{
+    vector<uint8_t> journal;
+    vector<uint32_t> recordPos;
+    SaveDbTestJournalGroups(journal, recordPos);
+    journal.resize(journal.size() - 5); /* 5: the tail of the payload of the last record */
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+    /* only the head of the record is left */
+    DestroyDeviceAuthService();
+    (void)system("rm -rf /data/data/deviceauth/hcgroup.dat*");
+    journal.resize(recordPos[1] + DB_JOURNAL_HEAD_LEN);
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+}
+
+/* a record which fails its crc stops the replay, the records after it are not applied either */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_04)
+{
+    vector<uint8_t> journal;
+    vector<uint32_t> recordPos;
+    SaveDbTestJournalGroups(journal, recordPos);
+    journal[recordPos[1] + DB_JOURNAL_HEAD_LEN] ^= 0x01;
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+}
+
+/*
+ * the torn record is cut off when the journal is loaded, even when the compaction after the load fails,
+ * so the records appended later are replayed.
+ */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_05)
+{
+    vector<uint8_t> journal;
+    vector<uint32_t> recordPos;
+    SaveDbTestJournalGroups(journal, recordPos);
+    journal.resize(recordPos[2] + DB_JOURNAL_HEAD_LEN + 1);
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    /* the snapshot can't be written while a directory takes the place of its temporary file */
+    ASSERT_EQ(mkdir(DB_TEST_TEMP_PATH, S_IRWXU), 0);
+    InitDeviceAuthService();
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+    EXPECT_EQ(AddDbTestGroup("DB_TEST_GROUP_D", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    ASSERT_EQ(rmdir(DB_TEST_TEMP_PATH), 0);
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_D"));
+}
+
+static const uint32_t DB_CRASH_TEST_ROUND_NUM = 5;
+static const uint32_t DB_CRASH_TEST_MAX_DEVICE_NUM = 100000;
+
+/* add devices until the process is killed, every device is reported through the pipe once it is saved */
+static void RunDbCrashTestChild(int32_t fd, uint32_t firstIndex)
+{
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    InitDeviceAuthService();
+    for (uint32_t i = firstIndex; i < DB_CRASH_TEST_MAX_DEVICE_NUM; i++) {
+        GenerateDbTestUdid(i, udid, sizeof(udid));
+        if ((AddDbTestDevice("DB_TEST_GROUP_A", udid) != HC_SUCCESS) || (write(fd, &i, sizeof(i)) != sizeof(i))) {
+            break;
+        }
+    }
+    _exit(0);
+}
+
+/* kill the child once it has saved some devices, the index of the last device it reported is returned */
+static uint32_t KillDbCrashTestChild(uint32_t firstIndex, uint32_t savedNum)
+{
+    int32_t fds[2];
+    if (pipe(fds) != 0) {
+        return 0;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        RunDbCrashTestChild(fds[1], firstIndex);
+    }
+    close(fds[1]);
+    uint32_t lastIndex = 0;
+    uint32_t index = 0;
+    uint32_t readNum = 0;
+    while ((readNum < savedNum) && (read(fds[0], &index, sizeof(index)) == sizeof(index))) {
+        lastIndex = index;
+        readNum++;
+    }
+    /* it is killed wherever it is, most of its time goes to writing and syncing the journal */
+    (void)kill(pid, SIGKILL);
+    (void)waitpid(pid, nullptr, 0);
+    while (read(fds[0], &index, sizeof(index)) == sizeof(index)) {
+        lastIndex = index;
+    }
+    close(fds[0]);
+    return lastIndex;
+}
+
+/* every device reported as saved before the crash is loaded again, and the journal stays appendable */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_06)
+{
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME, IDENTICAL_ACCOUNT_GROUP), HC_SUCCESS);
+    uint32_t firstIndex = 0;
+    srand(time(nullptr));
+    for (uint32_t round = 0; round < DB_CRASH_TEST_ROUND_NUM; round++) {
+        DestroyDeviceAuthService();
+        uint32_t lastIndex = KillDbCrashTestChild(firstIndex, 1 + rand() % 200); /* 200: up to 200 devices a round */
+        InitDeviceAuthService();
+        for (uint32_t i = 0; i <= lastIndex; i++) {
+            GenerateDbTestUdid(i, udid, sizeof(udid));
+            ASSERT_TRUE(IsTrustedDeviceInGroup("DB_TEST_GROUP_A", udid)) << "round " << round << ", device " << i;
+        }
+        /* the device being added when the child was killed may be saved or not, none after it */
+        GenerateDbTestUdid(lastIndex + 2, udid, sizeof(udid));
+        EXPECT_FALSE(IsTrustedDeviceExist(udid));
+        GenerateDbTestUdid(lastIndex + 1, udid, sizeof(udid));
+        if (!IsTrustedDeviceExist(udid)) {
+            ASSERT_EQ(AddDbTestDevice("DB_TEST_GROUP_A", udid), HC_SUCCESS);
+        }
+        firstIndex = lastIndex + 2;
+    }
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    for (uint32_t i = 0; i < firstIndex; i++) {
+        GenerateDbTestUdid(i, udid, sizeof(udid));
+        ASSERT_TRUE(IsTrustedDeviceInGroup("DB_TEST_GROUP_A", udid)) << "device " << i;
+    }
+}
+
+/* the devices of an across account group are deleted with it on replay, though their service type differs */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_JOURNAL_07)
+{
+    const char *groupId = "DB_TEST_GROUP_A";
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    GenerateDbTestUdid(0, udid, sizeof(udid));
+    ASSERT_EQ(AddDbTestGroup(groupId, TEST_APP_NAME, ACROSS_ACCOUNT_AUTHORIZE_GROUP), HC_SUCCESS);
+    DeviceInfo *deviceInfo = CreateDeviceInfoStruct();
+    ASSERT_NE(deviceInfo, nullptr);
+    deviceInfo->devType = DEVICE_TYPE_ACCESSORY;
+    StringSetPointer(&deviceInfo->authId, udid);
+    StringSetPointer(&deviceInfo->udid, udid);
+    StringSetPointer(&deviceInfo->groupId, groupId);
+    StringSetPointer(&deviceInfo->serviceType, "DB_TEST_SERVICE");
+    EXPECT_EQ(AddTrustedDevice(deviceInfo, nullptr), HC_SUCCESS);
+    DestroyDeviceInfoStruct(deviceInfo);
+    ASSERT_TRUE(IsTrustedDeviceExist(udid));
+    ASSERT_EQ(DelGroupByGroupId(groupId), HC_SUCCESS);
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+    /* the deletion is replayed from the journal, the device must not be left on the freed group */
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_FALSE(IsGroupExistByGroupId(groupId));
+    EXPECT_FALSE(IsTrustedDeviceExist(udid));
+}
+
+static const char *DB_TEST_ACL_APP_NAME = "DB_TEST_ACL_APP";
+static const char *DB_TEST_ACL_OWNER_NAME = "DB_TEST_ACL_OWNER";
+
+/* the ids of the peer to peer groups accessible to the app, in the order of the table */
+static string GetDbTestJoinedGroups(const char *appId)
+{
+    GroupInfoVec vec;
+    CreateGroupInfoVecStruct(&vec);
+    string groupIds;
+    if (GetJoinedGroups(appId, PEER_TO_PEER_GROUP, &vec) == HC_SUCCESS) {
+        for (uint32_t i = 0; i < HC_VECTOR_SIZE(&vec); i++) {
+            groupIds += StringGet(&((GroupInfo *)HC_VECTOR_GET(&vec, i))->id);
+            groupIds += ";";
+        }
+    }
+    DestroyGroupInfoVecStruct(&vec);
+    return groupIds;
+}
+
+/*
+ * the private groups are accessible to their managers and friends only, through the acl index.
+ * An app which is both a manager and a friend keeps the access when one of them is removed.
+ */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_ACL_01)
+{
+    const char *appId = DB_TEST_ACL_APP_NAME;
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME, PEER_TO_PEER_GROUP, GROUP_VISIBILITY_PRIVATE),
+        HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", DB_TEST_ACL_OWNER_NAME, PEER_TO_PEER_GROUP,
+        GROUP_VISIBILITY_PRIVATE), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_C", DB_TEST_ACL_OWNER_NAME), HC_SUCCESS);
+    EXPECT_EQ(GetDbTestJoinedGroups(TEST_APP_NAME), "DB_TEST_GROUP_A;DB_TEST_GROUP_C;");
+    EXPECT_EQ(GetDbTestJoinedGroups(DB_TEST_ACL_OWNER_NAME), "DB_TEST_GROUP_B;DB_TEST_GROUP_C;");
+    EXPECT_EQ(GetDbTestJoinedGroups(appId), "DB_TEST_GROUP_C;");
+    EXPECT_FALSE(IsGroupAccessible("DB_TEST_GROUP_B", appId));
+    ASSERT_EQ(AddGroupManager("DB_TEST_GROUP_B", appId), HC_SUCCESS);
+    ASSERT_EQ(AddGroupFriend("DB_TEST_GROUP_B", appId), HC_SUCCESS);
+    EXPECT_EQ(GetDbTestJoinedGroups(appId), "DB_TEST_GROUP_B;DB_TEST_GROUP_C;");
+    ASSERT_EQ(RemoveGroupManager("DB_TEST_GROUP_B", appId), HC_SUCCESS);
+    EXPECT_TRUE(IsGroupAccessible("DB_TEST_GROUP_B", appId));
+    /* the index is rebuilt from the file and the journal */
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_EQ(GetDbTestJoinedGroups(appId), "DB_TEST_GROUP_B;DB_TEST_GROUP_C;");
+    ASSERT_EQ(RemoveGroupFriend("DB_TEST_GROUP_B", appId), HC_SUCCESS);
+    EXPECT_FALSE(IsGroupAccessible("DB_TEST_GROUP_B", appId));
+    EXPECT_EQ(GetDbTestJoinedGroups(appId), "DB_TEST_GROUP_C;");
+    /* the acl of a deleted group does not pass to a new group with the same id */
+    ASSERT_EQ(AddGroupFriend("DB_TEST_GROUP_B", appId), HC_SUCCESS);
+    ASSERT_EQ(DelGroupByGroupId("DB_TEST_GROUP_B"), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", DB_TEST_ACL_OWNER_NAME, PEER_TO_PEER_GROUP,
+        GROUP_VISIBILITY_PRIVATE), HC_SUCCESS);
+    EXPECT_FALSE(IsGroupAccessible("DB_TEST_GROUP_B", appId));
+    EXPECT_EQ(GetDbTestJoinedGroups(appId), "DB_TEST_GROUP_C;");
+    EXPECT_EQ(GetDbTestJoinedGroups(DB_TEST_ACL_OWNER_NAME), "DB_TEST_GROUP_C;DB_TEST_GROUP_B;");
+}
+
+static const char *DB_TEST_BACKUP_PATH = "/data/data/deviceauth/hcgroup.dat.bak";
+
+/* the previous generation is kept next to the file, and it is loaded without the newer journal records */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_BACKUP_01)
+{
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    vector<uint8_t> prevSnapshot;
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_FILE_PATH, prevSnapshot));
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    vector<uint8_t> snapshot;
+    vector<uint8_t> backup;
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_FILE_PATH, snapshot));
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_BACKUP_PATH, backup));
+    EXPECT_TRUE(backup == prevSnapshot);
+    EXPECT_FALSE(snapshot == prevSnapshot);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_C", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    snapshot.pop_back();
+    ASSERT_TRUE(WriteDbTestFile(DB_TEST_FILE_PATH, snapshot));
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    /* the record of group C was made on the broken snapshot, it can't be applied without group B */
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_C"));
+    /* the compaction after the fallback replaces the broken file, but not the good previous generation */
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_D", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_D"));
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_BACKUP_PATH, backup));
+    EXPECT_TRUE(backup == prevSnapshot);
+    /* the new file loads, so it becomes the previous generation on the next compaction */
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_FILE_PATH, snapshot));
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_E", TEST_APP_NAME), HC_SUCCESS);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_E"));
+    ASSERT_TRUE(ReadDbTestFile(DB_TEST_BACKUP_PATH, backup));
+    EXPECT_TRUE(backup == snapshot);
+}
+
+TEST_F(DATABASE_MANAGER, TC_DATABASE_TRANSACTION_01)
+{
+    char udid[DB_TEST_ID_LEN] = { 0 };
+    GenerateDbTestUdid(0, udid, sizeof(udid));
+    ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+    EXPECT_EQ(BeginDatabaseTransaction(), HC_ERR_BAD_TIMING);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestDevice("DB_TEST_GROUP_A", udid), HC_SUCCESS);
+    ASSERT_EQ(CommitDatabaseTransaction(), HC_SUCCESS);
+    EXPECT_EQ(CommitDatabaseTransaction(), HC_ERR_BAD_TIMING);
+    /* the changes are saved in the snapshot on commit */
+    vector<uint8_t> journal;
+    EXPECT_FALSE(ReadDbTestFile(DB_TEST_JOURNAL_PATH, journal));
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_TRUE(IsTrustedDeviceInGroup("DB_TEST_GROUP_A", udid));
+}
+
+TEST_F(DATABASE_MANAGER, TC_DATABASE_TRANSACTION_02)
+{
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(DelGroupByGroupId("DB_TEST_GROUP_A"), HC_SUCCESS);
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    RollbackDatabaseTransaction();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+}
+
+static volatile bool g_isDbTestWriteDone = false;
+static int32_t g_dbTestCommitRes = HC_SUCCESS;
+
+static void *DbTestWriteThread(void *arg)
+{
+    (void)arg;
+    /* the transaction of the other thread can't be committed from here */
+    g_dbTestCommitRes = CommitDatabaseTransaction();
+    (void)AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME);
+    g_isDbTestWriteDone = true;
+    return nullptr;
+}
+
+/* the writes of the other threads wait until the transaction ends, and are not rolled back with it */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_TRANSACTION_03)
+{
+    g_isDbTestWriteDone = false;
+    ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+    pthread_t thread;
+    ASSERT_EQ(pthread_create(&thread, nullptr, DbTestWriteThread, nullptr), 0);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    DelayWithMSec(200);
+    EXPECT_FALSE(g_isDbTestWriteDone);
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    RollbackDatabaseTransaction();
+    (void)pthread_join(thread, nullptr);
+    EXPECT_EQ(g_dbTestCommitRes, HC_ERR_BAD_TIMING);
+    EXPECT_TRUE(g_isDbTestWriteDone);
+    EXPECT_FALSE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_B"));
+}
+
+static HcRwLock g_testRwLock;
+static std::atomic<int> g_rwLockTestSeq(0);
+static std::atomic<int> g_rwLockReaderSeq(0);
+static std::atomic<int> g_rwLockWriterSeq(0);
+
+static void *RwLockTestReader(void *arg)
+{
+    (void)arg;
+    g_testRwLock.readLock(&g_testRwLock);
+    g_rwLockReaderSeq = ++g_rwLockTestSeq;
+    g_testRwLock.unlock(&g_testRwLock);
+    return nullptr;
+}
+
+static void *RwLockTestWriter(void *arg)
+{
+    (void)arg;
+    g_testRwLock.writeLock(&g_testRwLock);
+    g_rwLockWriterSeq = ++g_rwLockTestSeq;
+    g_testRwLock.unlock(&g_testRwLock);
+    return nullptr;
+}
+
+/* the readers share the lock */
+TEST(HC_RW_LOCK, TC_RW_LOCK_01)
+{
+    ASSERT_EQ(InitHcRwLock(&g_testRwLock), 0);
+    g_rwLockTestSeq = 0;
+    g_rwLockReaderSeq = 0;
+    g_testRwLock.readLock(&g_testRwLock);
+    pthread_t reader;
+    ASSERT_EQ(pthread_create(&reader, nullptr, RwLockTestReader, nullptr), 0);
+    (void)pthread_join(reader, nullptr);
+    EXPECT_EQ(g_rwLockReaderSeq, 1);
+    g_testRwLock.unlock(&g_testRwLock);
+    DestroyHcRwLock(&g_testRwLock);
+}
+
+/* a waiting writer holds the turnstile, so a reader coming after it waits behind it */
+TEST(HC_RW_LOCK, TC_RW_LOCK_02)
+{
+    ASSERT_EQ(InitHcRwLock(&g_testRwLock), 0);
+    g_rwLockTestSeq = 0;
+    g_rwLockReaderSeq = 0;
+    g_rwLockWriterSeq = 0;
+    g_testRwLock.readLock(&g_testRwLock);
+    pthread_t writer;
+    pthread_t reader;
+    ASSERT_EQ(pthread_create(&writer, nullptr, RwLockTestWriter, nullptr), 0);
+    DelayWithMSec(100);
+    ASSERT_EQ(pthread_create(&reader, nullptr, RwLockTestReader, nullptr), 0);
+    DelayWithMSec(100);
+    EXPECT_EQ(g_rwLockWriterSeq, 0);
+    EXPECT_EQ(g_rwLockReaderSeq, 0);
+    g_testRwLock.unlock(&g_testRwLock);
+    (void)pthread_join(writer, nullptr);
+    (void)pthread_join(reader, nullptr);
+    EXPECT_EQ(g_rwLockWriterSeq, 1);
+    EXPECT_EQ(g_rwLockReaderSeq, 2);
+    DestroyHcRwLock(&g_testRwLock);
+}
+
+#define TASK_TEST_STACK_SIZE 4096
+#define TASK_TEST_CAPACITY 5
+#define TASK_TEST_QUEUE_SIZE 8
+#define TASK_TEST_PRODUCER_NUM 4
+#define TASK_TEST_TASK_NUM 1000
+#define TASK_TEST_WAIT_MSEC 10000
+
+typedef struct {
+    HcTaskBase base;
+    uint32_t producer;
+    uint32_t index;
+} TaskTestTask;
+
+static HcTaskThread g_testTaskThread;
+static std::atomic<uint32_t> g_taskTestDoneNum(0);
+static uint32_t g_taskTestNextIndex[TASK_TEST_PRODUCER_NUM] = { 0 };
+static bool g_isTaskTestOrdered = true;
+
+/* only the task thread runs the tasks, so the order fields need no lock */
+static void DoTaskTestAction(HcTaskBase *task)
+{
+    TaskTestTask *realTask = (TaskTestTask *)task;
+    if (realTask->index != g_taskTestNextIndex[realTask->producer]) {
+        g_isTaskTestOrdered = false;
+    }
+    g_taskTestNextIndex[realTask->producer] = realTask->index + 1;
+    g_taskTestDoneNum++;
+}
+
+static TaskTestTask *CreateTaskTestTask(uint32_t producer, uint32_t index)
+{
+    TaskTestTask *task = (TaskTestTask *)HcMalloc(sizeof(TaskTestTask), 0);
+    if (task == nullptr) {
+        return nullptr;
+    }
+    task->base.doAction = DoTaskTestAction;
+    task->base.destroy = nullptr;
+    task->producer = producer;
+    task->index = index;
+    return task;
+}
+
+static void ResetTaskTestState(void)
+{
+    g_taskTestDoneNum = 0;
+    g_isTaskTestOrdered = true;
+    for (uint32_t i = 0; i < TASK_TEST_PRODUCER_NUM; i++) {
+        g_taskTestNextIndex[i] = 0;
+    }
+}
+
+static bool WaitTaskTestDone(uint32_t taskNum)
+{
+    for (int32_t i = 0; i < TASK_TEST_WAIT_MSEC; i++) {
+        if (g_taskTestDoneNum == taskNum) {
+            return true;
+        }
+        DelayWithMSec(1);
+    }
+    return false;
+}
+
+static void *TaskTestProducer(void *arg)
+{
+    uint32_t producer = *(uint32_t *)arg;
+    for (uint32_t i = 0; i < TASK_TEST_TASK_NUM; i++) {
+        TaskTestTask *task = CreateTaskTestTask(producer, i);
+        if (task == nullptr) {
+            return nullptr;
+        }
+        /* the queue is much smaller than the tasks, retry until the thread makes room */
+        while (g_testTaskThread.pushTask(&g_testTaskThread, (HcTaskBase *)task) == HAL_ERR_QUEUE_FULL) {
+            DelayWithMSec(1);
+        }
+    }
+    return nullptr;
+}
+
+/* the capacity is rounded up to a power of two, a full queue rejects the task and the rest run in order */
+TEST(HC_TASK_THREAD, TC_TASK_THREAD_01)
+{
+    ResetTaskTestState();
+    ASSERT_EQ(InitHcTaskThread(&g_testTaskThread, TASK_TEST_STACK_SIZE, TASK_TEST_CAPACITY, "TaskTest"), 0);
+    for (uint32_t i = 0; i < TASK_TEST_QUEUE_SIZE; i++) {
+        TaskTestTask *task = CreateTaskTestTask(0, i);
+        ASSERT_NE(task, nullptr);
+        EXPECT_EQ(g_testTaskThread.pushTask(&g_testTaskThread, (HcTaskBase *)task), HAL_SUCCESS);
+    }
+    TaskTestTask *extraTask = CreateTaskTestTask(0, TASK_TEST_QUEUE_SIZE);
+    ASSERT_NE(extraTask, nullptr);
+    EXPECT_EQ(g_testTaskThread.pushTask(&g_testTaskThread, (HcTaskBase *)extraTask), HAL_ERR_QUEUE_FULL);
+    HcFree(extraTask);
+    ASSERT_EQ(g_testTaskThread.startThread(&g_testTaskThread), HAL_SUCCESS);
+    EXPECT_TRUE(WaitTaskTestDone(TASK_TEST_QUEUE_SIZE));
+    EXPECT_TRUE(g_isTaskTestOrdered);
+    g_testTaskThread.stopAndClear(&g_testTaskThread);
+    DestroyHcTaskThread(&g_testTaskThread);
+}
+
+/* the producers push concurrently through many rounds of the ring, each keeps its own order */
+TEST(HC_TASK_THREAD, TC_TASK_THREAD_02)
+{
+    ResetTaskTestState();
+    ASSERT_EQ(InitHcTaskThread(&g_testTaskThread, TASK_TEST_STACK_SIZE, TASK_TEST_CAPACITY, "TaskTest"), 0);
+    ASSERT_EQ(g_testTaskThread.startThread(&g_testTaskThread), HAL_SUCCESS);
+    pthread_t producers[TASK_TEST_PRODUCER_NUM];
+    uint32_t producerIds[TASK_TEST_PRODUCER_NUM];
+    for (uint32_t i = 0; i < TASK_TEST_PRODUCER_NUM; i++) {
+        producerIds[i] = i;
+        ASSERT_EQ(pthread_create(&producers[i], nullptr, TaskTestProducer, &producerIds[i]), 0);
+    }
+    for (uint32_t i = 0; i < TASK_TEST_PRODUCER_NUM; i++) {
+        (void)pthread_join(producers[i], nullptr);
+    }
+    EXPECT_TRUE(WaitTaskTestDone(TASK_TEST_PRODUCER_NUM * TASK_TEST_TASK_NUM));
+    EXPECT_TRUE(g_isTaskTestOrdered);
+    g_testTaskThread.stopAndClear(&g_testTaskThread);
+    DestroyHcTaskThread(&g_testTaskThread);
+}
+
+#define BROADCAST_TEST_SLOW_MSEC 50
+/* no more than the queue holds, so that none is dropped */
+#define BROADCAST_TEST_POST_NUM (BROADCAST_QUEUE_CAPACITY < 20 ? BROADCAST_QUEUE_CAPACITY : 20)
+#define BROADCAST_TEST_WAIT_MSEC 5000
+#define BROADCAST_TEST_LISTENER_NUM 32
+#define BROADCAST_TEST_EXTRA_NUM 5
+#define BROADCAST_TEST_DEV_NUM 10
+#define BROADCAST_TEST_NAME_LEN 32
+static const char *BROADCAST_TEST_APP_NAME = "BroadcastTestApp";
+
+static std::atomic<int32_t> g_bcCreatedNum(0);
+static std::atomic<int32_t> g_bcEnteredNum(0);
+static std::atomic<int32_t> g_bcLeftNum(0);
+static std::atomic<bool> g_bcIsBlocked(false);
+static std::atomic<int32_t> g_bcRevokedNum(0);
+static std::atomic<int32_t> g_bcDevNumCallNum(0);
+static std::atomic<int32_t> g_bcLastDevNum(-1);
+static std::atomic<bool> g_bcIsRemoveDone(false);
+static std::vector<std::string> g_bcRevokedUdids;
+static std::vector<pthread_t> g_bcThreads;
+static pthread_mutex_t g_bcThreadsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void ResetBroadcastTestState(void)
+{
+    g_bcCreatedNum = 0;
+    g_bcEnteredNum = 0;
+    g_bcLeftNum = 0;
+    g_bcIsBlocked = false;
+    g_bcRevokedNum = 0;
+    g_bcDevNumCallNum = 0;
+    g_bcLastDevNum = -1;
+    g_bcIsRemoveDone = false;
+    g_bcRevokedUdids.clear();
+    g_bcThreads.clear();
+}
+
+static bool WaitBroadcastTestNum(const std::atomic<int32_t> &num, int32_t expectedNum)
+{
+    for (int32_t i = 0; i < BROADCAST_TEST_WAIT_MSEC; i++) {
+        if (num == expectedNum) {
+            return true;
+        }
+        DelayWithMSec(1);
+    }
+    return false;
+}
+
+static GroupInfo *CreateBroadcastTestGroup(void)
+{
+    GroupInfo *groupInfo = CreateGroupInfoStruct();
+    if (groupInfo == nullptr) {
+        return nullptr;
+    }
+    StringSetPointer(&groupInfo->name, "BroadcastTestGroup");
+    StringSetPointer(&groupInfo->id, "BroadcastTestGroupId");
+    StringSetPointer(&groupInfo->ownerName, BROADCAST_TEST_APP_NAME);
+    groupInfo->type = PEER_TO_PEER_GROUP;
+    groupInfo->visibility = GROUP_VISIBILITY_PUBLIC;
+    return groupInfo;
+}
+
+static void OnBroadcastTestSlowCreated(const char *groupInfo)
+{
+    (void)groupInfo;
+    DelayWithMSec(BROADCAST_TEST_SLOW_MSEC);
+    g_bcCreatedNum++;
+}
+
+/* the first call blocks the worker until the test releases it */
+static void OnBroadcastTestBlockedCreated(const char *groupInfo)
+{
+    (void)groupInfo;
+    g_bcEnteredNum++;
+    while (g_bcIsBlocked) {
+        DelayWithMSec(1);
+    }
+    g_bcCreatedNum++;
+    g_bcLeftNum++;
+}
+
+static void OnBroadcastTestUnBound(const char *peerUdid, const char *groupInfo)
+{
+    (void)groupInfo;
+    g_bcRevokedUdids.push_back(peerUdid);
+    g_bcRevokedNum++;
+}
+
+static void OnBroadcastTestDevNumChanged(int curTrustedDeviceNum)
+{
+    g_bcDevNumCallNum++;
+    g_bcLastDevNum = curTrustedDeviceNum;
+}
+
+static void OnBroadcastTestRecordThread(const char *groupInfo)
+{
+    (void)groupInfo;
+    pthread_t self = pthread_self();
+    pthread_mutex_lock(&g_bcThreadsMutex);
+    bool isRecorded = false;
+    for (pthread_t thread : g_bcThreads) {
+        isRecorded = isRecorded || pthread_equal(thread, self);
+    }
+    if (!isRecorded) {
+        g_bcThreads.push_back(self);
+    }
+    pthread_mutex_unlock(&g_bcThreadsMutex);
+    g_bcCreatedNum++;
+}
+
+static void OnBroadcastTestRemoveSelf(const char *groupInfo)
+{
+    (void)groupInfo;
+    EXPECT_EQ(RemoveListener(BROADCAST_TEST_APP_NAME), HC_SUCCESS);
+    g_bcCreatedNum++;
+}
+
+static void *BroadcastTestRemover(void *arg)
+{
+    (void)arg;
+    (void)RemoveListener(BROADCAST_TEST_APP_NAME);
+    g_bcIsRemoveDone = true;
+    return nullptr;
+}
+
+/* block the worker on the first event, so that the following ones stay in the queue */
+static void BlockBroadcastTestListener(const GroupInfo *groupInfo)
+{
+    g_bcIsBlocked = true;
+    GetBroadcaster()->postOnGroupCreated(groupInfo);
+    EXPECT_TRUE(WaitBroadcastTestNum(g_bcEnteredNum, 1));
+}
+
+/* a slow listener does not hold back the poster */
+TEST(BROADCAST_MANAGER, TC_BROADCAST_LATENCY_01)
+{
+    ResetBroadcastTestState();
+    ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+    DataChangeListener listener = { 0 };
+    listener.onGroupCreated = OnBroadcastTestSlowCreated;
+    ASSERT_EQ(AddListener(BROADCAST_TEST_APP_NAME, &listener), HC_SUCCESS);
+    GroupInfo *groupInfo = CreateBroadcastTestGroup();
+    ASSERT_NE(groupInfo, nullptr);
+    struct timespec start;
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int32_t i = 0; i < BROADCAST_TEST_POST_NUM; i++) {
+        GetBroadcaster()->postOnGroupCreated(groupInfo);
+    }
+    double costTime = GetElapsedMs(&start);
+    PRINT_COST_TIME(costTime);
+    EXPECT_LT(costTime, BROADCAST_TEST_SLOW_MSEC);
+    EXPECT_TRUE(WaitBroadcastTestNum(g_bcCreatedNum, BROADCAST_TEST_POST_NUM));
+    DestroyGroupInfoStruct(groupInfo);
+    DestroyBroadcastManager();
+}
+
+/*
+ * A full queue drops the new events, but never a revocation: a revocation replaces a pending copy of itself
+ * or an event which is not a revocation, and goes beyond the bound when all the pending events are revocations.
+ */
+TEST(BROADCAST_MANAGER, TC_BROADCAST_REVOCATION_01)
+{
+    ResetBroadcastTestState();
+    ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+    DataChangeListener listener = { 0 };
+    listener.onGroupCreated = OnBroadcastTestBlockedCreated;
+    listener.onDeviceUnBound = OnBroadcastTestUnBound;
+    ASSERT_EQ(AddListener(BROADCAST_TEST_APP_NAME, &listener), HC_SUCCESS);
+    GroupInfo *groupInfo = CreateBroadcastTestGroup();
+    ASSERT_NE(groupInfo, nullptr);
+    BlockBroadcastTestListener(groupInfo);
+    for (int32_t i = 0; i < BROADCAST_QUEUE_CAPACITY + BROADCAST_TEST_EXTRA_NUM; i++) {
+        GetBroadcaster()->postOnGroupCreated(groupInfo);
+    }
+    const int32_t revokedNum = BROADCAST_QUEUE_CAPACITY + BROADCAST_TEST_EXTRA_NUM;
+    char udid[BROADCAST_TEST_NAME_LEN] = { 0 };
+    for (int32_t i = 0; i < revokedNum; i++) {
+        (void)sprintf_s(udid, sizeof(udid), "BroadcastTestUdid%d", i);
+        GetBroadcaster()->postOnDeviceUnBound(udid, groupInfo);
+    }
+    (void)sprintf_s(udid, sizeof(udid), "BroadcastTestUdid%d", 0);
+    GetBroadcaster()->postOnDeviceUnBound(udid, groupInfo);
+    g_bcIsBlocked = false;
+    EXPECT_TRUE(WaitBroadcastTestNum(g_bcRevokedNum, revokedNum));
+    DelayWithMSec(BROADCAST_TEST_SLOW_MSEC);
+    /* all the pending creations are replaced, the duplicated revocation moves to the tail */
+    EXPECT_EQ(g_bcCreatedNum, 1);
+    ASSERT_EQ(g_bcRevokedNum, revokedNum);
+    for (int32_t i = 1; i < revokedNum; i++) {
+        (void)sprintf_s(udid, sizeof(udid), "BroadcastTestUdid%d", i);
+        EXPECT_EQ(g_bcRevokedUdids[i - 1], udid);
+    }
+    (void)sprintf_s(udid, sizeof(udid), "BroadcastTestUdid%d", 0);
+    EXPECT_EQ(g_bcRevokedUdids[revokedNum - 1], udid);
+    DestroyGroupInfoStruct(groupInfo);
+    DestroyBroadcastManager();
+}
+
+/* the listeners share the workers instead of a thread each */
+TEST(BROADCAST_MANAGER, TC_BROADCAST_SHARED_WORKER_01)
+{
+    ResetBroadcastTestState();
+    ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+    DataChangeListener listener = { 0 };
+    listener.onGroupCreated = OnBroadcastTestRecordThread;
+    char appId[BROADCAST_TEST_NAME_LEN] = { 0 };
+    for (int32_t i = 0; i < BROADCAST_TEST_LISTENER_NUM; i++) {
+        (void)sprintf_s(appId, sizeof(appId), "BroadcastTestApp%d", i);
+        ASSERT_EQ(AddListener(appId, &listener), HC_SUCCESS);
+    }
+    GroupInfo *groupInfo = CreateBroadcastTestGroup();
+    ASSERT_NE(groupInfo, nullptr);
+    GetBroadcaster()->postOnGroupCreated(groupInfo);
+    EXPECT_TRUE(WaitBroadcastTestNum(g_bcCreatedNum, BROADCAST_TEST_LISTENER_NUM));
+    pthread_mutex_lock(&g_bcThreadsMutex);
+    EXPECT_LE(g_bcThreads.size(), (size_t)BROADCAST_WORKER_NUM);
+    pthread_mutex_unlock(&g_bcThreadsMutex);
+    for (int32_t i = 0; i < BROADCAST_TEST_LISTENER_NUM; i++) {
+        (void)sprintf_s(appId, sizeof(appId), "BroadcastTestApp%d", i);
+        EXPECT_EQ(RemoveListener(appId), HC_SUCCESS);
+    }
+    DestroyGroupInfoStruct(groupInfo);
+    DestroyBroadcastManager();
+}
+
+/* a listener can remove itself in the callback, the pending events are dropped with it */
+TEST(BROADCAST_MANAGER, TC_BROADCAST_REMOVE_01)
+{
+    ResetBroadcastTestState();
+    ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+    DataChangeListener listener = { 0 };
+    listener.onGroupCreated = OnBroadcastTestRemoveSelf;
+    ASSERT_EQ(AddListener(BROADCAST_TEST_APP_NAME, &listener), HC_SUCCESS);
+    GroupInfo *groupInfo = CreateBroadcastTestGroup();
+    ASSERT_NE(groupInfo, nullptr);
+    for (int32_t i = 0; i < BROADCAST_TEST_POST_NUM; i++) {
+        GetBroadcaster()->postOnGroupCreated(groupInfo);
+    }
+    EXPECT_TRUE(WaitBroadcastTestNum(g_bcCreatedNum, 1));
+    DelayWithMSec(BROADCAST_TEST_SLOW_MSEC);
+    EXPECT_EQ(g_bcCreatedNum, 1);
+    DestroyGroupInfoStruct(groupInfo);
+    DestroyBroadcastManager();
+}
+
+/* the removal by another thread returns after the callback in flight, and no callback follows */
+TEST(BROADCAST_MANAGER, TC_BROADCAST_REMOVE_02)
+{
+    ResetBroadcastTestState();
+    ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+    DataChangeListener listener = { 0 };
+    listener.onGroupCreated = OnBroadcastTestBlockedCreated;
+    ASSERT_EQ(AddListener(BROADCAST_TEST_APP_NAME, &listener), HC_SUCCESS);
+    GroupInfo *groupInfo = CreateBroadcastTestGroup();
+    ASSERT_NE(groupInfo, nullptr);
+    BlockBroadcastTestListener(groupInfo);
+    GetBroadcaster()->postOnGroupCreated(groupInfo);
+    pthread_t remover;
+    ASSERT_EQ(pthread_create(&remover, nullptr, BroadcastTestRemover, nullptr), 0);
+    DelayWithMSec(BROADCAST_TEST_SLOW_MSEC);
+    EXPECT_FALSE(g_bcIsRemoveDone);
+    g_bcIsBlocked = false;
+    (void)pthread_join(remover, nullptr);
+    EXPECT_TRUE(g_bcIsRemoveDone);
+    EXPECT_EQ(g_bcLeftNum, 1);
+    DelayWithMSec(BROADCAST_TEST_SLOW_MSEC);
+    EXPECT_EQ(g_bcCreatedNum, 1);
+    DestroyGroupInfoStruct(groupInfo);
+    DestroyBroadcastManager();
+}
+
+/* the changes of the trusted device number pending together are delivered once with the latest one */
+TEST(BROADCAST_MANAGER, TC_BROADCAST_DEVICE_NUM_01)
+{
+    ResetBroadcastTestState();
+    ASSERT_EQ(InitBroadcastManager(), HC_SUCCESS);
+    DataChangeListener listener = { 0 };
+    listener.onGroupCreated = OnBroadcastTestBlockedCreated;
+    listener.onTrustedDeviceNumChanged = OnBroadcastTestDevNumChanged;
+    ASSERT_EQ(AddListener(BROADCAST_TEST_APP_NAME, &listener), HC_SUCCESS);
+    GroupInfo *groupInfo = CreateBroadcastTestGroup();
+    ASSERT_NE(groupInfo, nullptr);
+    BlockBroadcastTestListener(groupInfo);
+    for (int32_t i = 1; i <= BROADCAST_TEST_DEV_NUM; i++) {
+        GetBroadcaster()->postOnTrustedDeviceNumChanged(i);
+    }
+    g_bcIsBlocked = false;
+    EXPECT_TRUE(WaitBroadcastTestNum(g_bcLastDevNum, BROADCAST_TEST_DEV_NUM));
+    DelayWithMSec(BROADCAST_TEST_SLOW_MSEC);
+    EXPECT_EQ(g_bcDevNumCallNum, 1);
+    DestroyGroupInfoStruct(groupInfo);
+    DestroyBroadcastManager();
+}
+
+#define PARCEL_TEST_ALLOC_UNIT 16
+#define PARCEL_TEST_WRITE_NUM 10000
+#define PARCEL_TEST_MAX_GROW_NUM 32
+#define PARCEL_TEST_RESERVE_SIZE 1000
+#define PARCEL_TEST_DATA_SIZE 100
+#define PARCEL_TEST_READ_SIZE 40
+
+DECLARE_HC_VECTOR(ParcelTestVec, uint32_t)
+IMPLEMENT_HC_VECTOR(ParcelTestVec, uint32_t, 1)
+
+static bool CheckParcelTestData(HcParcel *parcel, uint32_t begin, uint32_t size)
+{
+    if (GetParcelDataSize(parcel) != size) {
+        return false;
+    }
+    const uint8_t *data = (const uint8_t *)GetParcelData(parcel);
+    for (uint32_t i = 0; i < size; i++) {
+        if (data[i] != (uint8_t)(begin + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool WriteParcelTestData(HcParcel *parcel, uint32_t begin, uint32_t size)
+{
+    for (uint32_t i = begin; i < begin + size; i++) {
+        if (!ParcelWriteUint8(parcel, (uint8_t)i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* byte by byte writes grow the parcel geometrically, not by one allocUnit at a time */
+TEST(HC_PARCEL, TC_PARCEL_GROWTH_01)
+{
+    HcParcel parcel = CreateParcel(0, PARCEL_TEST_ALLOC_UNIT);
+    uint32_t growNum = 0;
+    uint32_t lastLength = parcel.length;
+    for (uint32_t i = 0; i < PARCEL_TEST_WRITE_NUM; i++) {
+        ASSERT_TRUE(ParcelWriteUint8(&parcel, (uint8_t)i));
+        if (parcel.length != lastLength) {
+            growNum++;
+            lastLength = parcel.length;
+        }
+    }
+    EXPECT_LE(growNum, PARCEL_TEST_MAX_GROW_NUM);
+    EXPECT_LE(parcel.length, PARCEL_TEST_WRITE_NUM * 2);
+    EXPECT_TRUE(CheckParcelTestData(&parcel, 0, PARCEL_TEST_WRITE_NUM));
+    DeleteParcel(&parcel);
+}
+
+/* a queue-like user which writes and pops in turn keeps the parcel small */
+TEST(HC_PARCEL, TC_PARCEL_GROWTH_02)
+{
+    HcParcel parcel = CreateParcel(0, PARCEL_TEST_ALLOC_UNIT);
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < PARCEL_TEST_WRITE_NUM; i++) {
+        ASSERT_TRUE(ParcelWriteUint32(&parcel, i));
+        ASSERT_TRUE(ParcelReadUint32(&parcel, &value));
+        ASSERT_EQ(value, i);
+    }
+    EXPECT_LE(parcel.length, PARCEL_TEST_ALLOC_UNIT * 2);
+    DeleteParcel(&parcel);
+}
+
+/* the writes within the reserved size neither move nor grow the buffer */
+TEST(HC_PARCEL, TC_PARCEL_RESERVE_01)
+{
+    HcParcel parcel = CreateParcel(0, PARCEL_TEST_ALLOC_UNIT);
+    ASSERT_TRUE(ParcelReserve(&parcel, PARCEL_TEST_RESERVE_SIZE));
+    EXPECT_GE(parcel.length, PARCEL_TEST_RESERVE_SIZE);
+    const char *data = parcel.data;
+    uint32_t length = parcel.length;
+    ASSERT_TRUE(WriteParcelTestData(&parcel, 0, PARCEL_TEST_RESERVE_SIZE));
+    EXPECT_EQ(parcel.data, data);
+    EXPECT_EQ(parcel.length, length);
+    EXPECT_TRUE(CheckParcelTestData(&parcel, 0, PARCEL_TEST_RESERVE_SIZE));
+    DeleteParcel(&parcel);
+}
+
+/* the reserve reuses the popped prefix before it grows the buffer */
+TEST(HC_PARCEL, TC_PARCEL_RESERVE_02)
+{
+    HcParcel parcel = CreateParcel(PARCEL_TEST_DATA_SIZE, PARCEL_TEST_ALLOC_UNIT);
+    ASSERT_TRUE(WriteParcelTestData(&parcel, 0, PARCEL_TEST_DATA_SIZE));
+    ASSERT_TRUE(ParcelPopFront(&parcel, PARCEL_TEST_READ_SIZE));
+    ASSERT_TRUE(ParcelReserve(&parcel, PARCEL_TEST_DATA_SIZE));
+    EXPECT_EQ(parcel.length, PARCEL_TEST_DATA_SIZE);
+    EXPECT_EQ(parcel.beginPos, 0);
+    EXPECT_TRUE(CheckParcelTestData(&parcel, PARCEL_TEST_READ_SIZE, PARCEL_TEST_DATA_SIZE - PARCEL_TEST_READ_SIZE));
+    DeleteParcel(&parcel);
+}
+
+/* the shrink keeps the unread data only, an empty parcel releases its buffer and stays usable */
+TEST(HC_PARCEL, TC_PARCEL_SHRINK_01)
+{
+    HcParcel parcel = CreateParcel(0, PARCEL_TEST_ALLOC_UNIT);
+    ASSERT_TRUE(ParcelReserve(&parcel, PARCEL_TEST_RESERVE_SIZE));
+    ASSERT_TRUE(WriteParcelTestData(&parcel, 0, PARCEL_TEST_DATA_SIZE));
+    ASSERT_TRUE(ParcelPopFront(&parcel, PARCEL_TEST_READ_SIZE));
+    ParcelShrinkToFit(&parcel);
+    EXPECT_EQ(parcel.length, PARCEL_TEST_DATA_SIZE - PARCEL_TEST_READ_SIZE);
+    EXPECT_TRUE(CheckParcelTestData(&parcel, PARCEL_TEST_READ_SIZE, PARCEL_TEST_DATA_SIZE - PARCEL_TEST_READ_SIZE));
+    ASSERT_TRUE(ParcelPopFront(&parcel, PARCEL_TEST_DATA_SIZE - PARCEL_TEST_READ_SIZE));
+    ParcelShrinkToFit(&parcel);
+    EXPECT_EQ(parcel.data, nullptr);
+    EXPECT_EQ(parcel.length, 0);
+    ASSERT_TRUE(WriteParcelTestData(&parcel, 0, PARCEL_TEST_DATA_SIZE));
+    EXPECT_TRUE(CheckParcelTestData(&parcel, 0, PARCEL_TEST_DATA_SIZE));
+    DeleteParcel(&parcel);
+}
+
+TEST(HC_PARCEL, TC_VECTOR_RESERVE_01)
+{
+    ParcelTestVec vec = CREATE_HC_VECTOR(ParcelTestVec);
+    ASSERT_TRUE(HC_VECTOR_RESERVE(&vec, PARCEL_TEST_DATA_SIZE));
+    const char *data = vec.parcel.data;
+    for (uint32_t i = 0; i < PARCEL_TEST_DATA_SIZE; i++) {
+        ASSERT_NE(vec.pushBackT(&vec, i), nullptr);
+    }
+    EXPECT_EQ(vec.parcel.data, data);
+    uint32_t value = 0;
+    ASSERT_TRUE(HC_VECTOR_POPFRONT(&vec, &value));
+    HC_VECTOR_SHRINK(&vec);
+    EXPECT_EQ(vec.parcel.length, (PARCEL_TEST_DATA_SIZE - 1) * sizeof(uint32_t));
+    EXPECT_EQ(HC_VECTOR_SIZE(&vec), PARCEL_TEST_DATA_SIZE - 1);
+    EXPECT_EQ(HC_VECTOR_GET(&vec, 0), 1);
+    DESTROY_HC_VECTOR(ParcelTestVec, &vec);
+}
+
+static std::atomic<bool> g_isDbTestReadDone(false);
+
+static void *DbTestReadThread(void *arg)
+{
+    (void)arg;
+    EXPECT_TRUE(IsGroupExistByGroupId("DB_TEST_GROUP_A"));
+    g_isDbTestReadDone = true;
+    return nullptr;
+}
+
+/* the queries don't wait for a writer that holds the database across calls */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_CONCURRENT_READ_01)
+{
+    g_isDbTestReadDone = false;
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_A", TEST_APP_NAME), HC_SUCCESS);
+    ASSERT_EQ(BeginDatabaseTransaction(), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup("DB_TEST_GROUP_B", TEST_APP_NAME), HC_SUCCESS);
+    pthread_t thread;
+    ASSERT_EQ(pthread_create(&thread, nullptr, DbTestReadThread, nullptr), 0);
+    (void)pthread_join(thread, nullptr);
+    EXPECT_TRUE(g_isDbTestReadDone);
+    EXPECT_EQ(CommitDatabaseTransaction(), HC_SUCCESS);
+}
+
+static const uint32_t DB_TEST_WRITER_NUM = 4;
+static const char *g_dbTestWriterGroupIds[DB_TEST_WRITER_NUM] = { nullptr };
+static std::atomic<int> g_dbTestAddedNum(0);
+
+static void *DbTestAddGroupThread(void *arg)
+{
+    const char *groupId = static_cast<const char *>(arg);
+    if (AddDbTestGroup(groupId, TEST_APP_NAME) == HC_SUCCESS) {
+        g_dbTestAddedNum++;
+    }
+    return nullptr;
+}
+
+static int32_t RunDbTestAddGroupThreads()
+{
+    g_dbTestAddedNum = 0;
+    pthread_t threads[DB_TEST_WRITER_NUM];
+    for (uint32_t i = 0; i < DB_TEST_WRITER_NUM; i++) {
+        if (pthread_create(&threads[i], nullptr, DbTestAddGroupThread,
+            const_cast<char *>(g_dbTestWriterGroupIds[i])) != 0) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < DB_TEST_WRITER_NUM; i++) {
+        (void)pthread_join(threads[i], nullptr);
+    }
+    return g_dbTestAddedNum;
+}
+
+/* the parallel workers can't add the same group twice, nor go beyond the group limit of the owner */
+TEST_F(DATABASE_MANAGER, TC_DATABASE_CONCURRENT_WRITE_01)
+{
+    for (uint32_t i = 0; i < DB_TEST_WRITER_NUM; i++) {
+        g_dbTestWriterGroupIds[i] = "DB_TEST_GROUP_SAME";
+    }
+    EXPECT_EQ(RunDbTestAddGroupThreads(), 1);
+    char groupId[DB_TEST_ID_LEN] = { 0 };
+    for (int32_t i = GetGroupNumberByOwner(TEST_APP_NAME); i < HC_TRUST_GROUP_ENTRY_MAX_NUM - 2; i++) {
+        (void)sprintf_s(groupId, sizeof(groupId), "DB_TEST_GROUP_%d", i);
+        ASSERT_EQ(AddDbTestGroup(groupId, TEST_APP_NAME), HC_SUCCESS);
+    }
+    g_dbTestWriterGroupIds[0] = "DB_TEST_GROUP_W0";
+    g_dbTestWriterGroupIds[1] = "DB_TEST_GROUP_W1";
+    g_dbTestWriterGroupIds[2] = "DB_TEST_GROUP_W2";
+    g_dbTestWriterGroupIds[3] = "DB_TEST_GROUP_W3";
+    EXPECT_EQ(RunDbTestAddGroupThreads(), 2);
+    EXPECT_EQ(GetGroupNumberByOwner(TEST_APP_NAME), HC_TRUST_GROUP_ENTRY_MAX_NUM);
+}
+
+#define HASH_TO_POINT_LEN 32
+
+static const char *g_hashToPointVectors[][2] = {
+    { "05162738495a6b7c8d9eafc0d1e2f30415263748596a7b8c9daebfd0e1f20314",
+        "dad98ec4c9fa3855848976d374ef27f58346fa757e3fa10e09af0b76ba2e507f" },
+    { "60718293a4b5c6d7e8f90a1b2c3d4e5f708192a3b4c5d6e7f8091a2b3c4d5e6f",
+        "b812fb3ccbb370826ff8ec32990a5666f165498cadab04bd5a486b8cbdcbc361" },
+    { "bbccddeeff102132435465768798a9bacbdcedfe0f2031425364758697a8b9ca",
+        "fc4370a4b49562f1431640086042ca2974da9f3ecdbfa9600b51d12da47d541b" },
+    { "162738495a6b7c8d9eafc0d1e2f30415263748596a7b8c9daebfd0e1f2031425",
+        "4386a4ce3e885a0ac6c002da038c100180e9b0b4e031e2aca4676a9c423dc845" },
+    /* the top two bits of the last byte are ignored */
+    { "05162738495a6b7c8d9eafc0d1e2f30415263748596a7b8c9daebfd0e1f203d4",
+        "dad98ec4c9fa3855848976d374ef27f58346fa757e3fa10e09af0b76ba2e507f" },
+};
+
+TEST(HASH_TO_POINT, TC_HASH_TO_POINT_01)
+{
+    uint8_t hashVal[HASH_TO_POINT_LEN] = { 0 };
+    uint8_t expectVal[HASH_TO_POINT_LEN] = { 0 };
+    uint8_t pointVal[HASH_TO_POINT_LEN] = { 0 };
+    for (uint32_t i = 0; i < sizeof(g_hashToPointVectors) / sizeof(g_hashToPointVectors[0]); i++) {
+        ASSERT_EQ(HexStringToByte(g_hashToPointVectors[i][0], hashVal, sizeof(hashVal)), HC_SUCCESS);
+        ASSERT_EQ(HexStringToByte(g_hashToPointVectors[i][1], expectVal, sizeof(expectVal)), HC_SUCCESS);
+        struct HksBlob hash = { sizeof(hashVal), hashVal };
+        struct HksBlob point = { sizeof(pointVal), pointVal };
+        EXPECT_EQ(OpensslHashToPoint(&hash, &point), 0);
+        EXPECT_EQ(memcmp(pointVal, expectVal, sizeof(expectVal)), 0);
+    }
+}
+
+TEST(HASH_TO_POINT, TC_HASH_TO_POINT_02)
+{
+    uint8_t hashVal[HASH_TO_POINT_LEN] = { 0 };
+    uint8_t pointVal[HASH_TO_POINT_LEN + 1] = { 0 };
+    struct HksBlob hash = { sizeof(hashVal), hashVal };
+    struct HksBlob point = { sizeof(pointVal), pointVal };
+    EXPECT_NE(OpensslHashToPoint(&hash, &point), 0);
+    hash.size = HASH_TO_POINT_LEN - 1;
+    point.size = HASH_TO_POINT_LEN;
+    EXPECT_NE(OpensslHashToPoint(&hash, &point), 0);
+}
+
+#define DL_TEST_PRIME_LEN 256
+#define DL_TEST_SECRET_LEN 32
+#define DL_TEST_LONG_BASE_LEN 200
+#define DL_TEST_SQUARE_EXP 2
+#define DL_TEST_SMALL_BASE 3
+#define DL_TEST_SMALL_SQUARE 9
+
+/* the 2048-bit MODP group of RFC 3526, the same prime as the 256-byte DL-SPEKE group */
+static const char *g_dlTestPrimeHex =
+    "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+    "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+    "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+    "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+    "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+    "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+    "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+    "3995497CEA956AE515D2261898FA051015728E5A8AACAA68FFFFFFFFFFFFFFFF";
+
+static void FillDlTestNum(uint8_t *val, uint32_t len, uint8_t seed)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        val[i] = (uint8_t)(seed + i * DL_TEST_SMALL_SQUARE);
+    }
+}
+
+/* the cached result of the context path is checked against the plain modexp of the prime string */
+static void CheckDlExpModWithContext(const AlgLoader *loader, const DlGroupContext *groupCtx,
+    const Uint8Buff *base, const Uint8Buff *exp)
+{
+    uint8_t expectVal[DL_TEST_PRIME_LEN] = { 0 };
+    uint8_t outVal[DL_TEST_PRIME_LEN] = { 0 };
+    Uint8Buff expectNum = { expectVal, DL_TEST_PRIME_LEN };
+    Uint8Buff outNum = { outVal, DL_TEST_PRIME_LEN };
+    ASSERT_EQ(loader->bigNumExpMod(base, exp, g_dlTestPrimeHex, &expectNum), HAL_SUCCESS);
+    ASSERT_EQ(loader->bigNumExpModWithContext(base, exp, groupCtx, &outNum), HAL_SUCCESS);
+    ASSERT_EQ(outNum.length, expectNum.length);
+    EXPECT_EQ(memcmp(outVal, expectVal, outNum.length), 0);
+}
+
+/* a prime is decoded once, the same string content gives the same context */
+TEST(DL_GROUP_CONTEXT, TC_DL_GROUP_CONTEXT_01)
+{
+    const AlgLoader *loader = GetLoaderInstance();
+    ASSERT_NE(loader, nullptr);
+    ASSERT_EQ(loader->initAlg(), HAL_SUCCESS);
+    ASSERT_NE(loader->getDlGroupContext, nullptr);
+    const DlGroupContext *groupCtx = loader->getDlGroupContext(g_dlTestPrimeHex);
+    ASSERT_NE(groupCtx, nullptr);
+    EXPECT_EQ(groupCtx->prime.length, DL_TEST_PRIME_LEN);
+    std::string primeCopy(g_dlTestPrimeHex);
+    EXPECT_EQ(loader->getDlGroupContext(primeCopy.c_str()), groupCtx);
+    EXPECT_EQ(loader->getDlGroupContext("FFFF"), nullptr);
+    EXPECT_EQ(loader->getDlGroupContext(nullptr), nullptr);
+}
+
+/* the short square fast path and the full modexp agree with bigNumExpMod */
+TEST(DL_GROUP_CONTEXT, TC_DL_GROUP_CONTEXT_02)
+{
+    const AlgLoader *loader = GetLoaderInstance();
+    ASSERT_NE(loader, nullptr);
+    ASSERT_EQ(loader->initAlg(), HAL_SUCCESS);
+    const DlGroupContext *groupCtx = loader->getDlGroupContext(g_dlTestPrimeHex);
+    ASSERT_NE(groupCtx, nullptr);
+    uint8_t squareExpVal[] = { DL_TEST_SQUARE_EXP };
+    Uint8Buff squareExp = { squareExpVal, sizeof(squareExpVal) };
+    uint8_t smallBaseVal[] = { DL_TEST_SMALL_BASE };
+    Uint8Buff smallBase = { smallBaseVal, sizeof(smallBaseVal) };
+    uint8_t outVal[DL_TEST_PRIME_LEN] = { 0 };
+    Uint8Buff outNum = { outVal, DL_TEST_PRIME_LEN };
+    ASSERT_EQ(loader->bigNumExpModWithContext(&smallBase, &squareExp, groupCtx, &outNum), HAL_SUCCESS);
+    EXPECT_EQ(outVal[DL_TEST_PRIME_LEN - 1], DL_TEST_SMALL_SQUARE);
+    EXPECT_EQ(outVal[0], 0);
+    uint8_t secretVal[DL_TEST_SECRET_LEN] = { 0 };
+    FillDlTestNum(secretVal, sizeof(secretVal), 0xA5);
+    Uint8Buff secret = { secretVal, sizeof(secretVal) };
+    CheckDlExpModWithContext(loader, groupCtx, &secret, &squareExp);
+    uint8_t longBaseVal[DL_TEST_LONG_BASE_LEN] = { 0 };
+    FillDlTestNum(longBaseVal, sizeof(longBaseVal), 0x5A);
+    Uint8Buff longBase = { longBaseVal, sizeof(longBaseVal) };
+    CheckDlExpModWithContext(loader, groupCtx, &longBase, &squareExp);
+    uint8_t expVal[DL_TEST_SECRET_LEN] = { 0 };
+    FillDlTestNum(expVal, sizeof(expVal), 0x3C);
+    Uint8Buff exp = { expVal, sizeof(expVal) };
+    CheckDlExpModWithContext(loader, groupCtx, &longBase, &exp);
+}
+
+static const char *g_jsonBinaryMsg = "{\"message\":32769,\"groupOp\":-2,\"authForm\":0,\"isClient\":true,"
+    "\"payload\":{\"salt\":\"0A1B2C3D4E5F60718293A4B5C6D7E8F9\",\"epk\":\"1a2b3c\",\"ratio\":0.5,"
+    "\"peerAuthId\":\"6D79206465766963652069640000\",\"version\":{\"minVersion\":\"1.0.0\","
+    "\"currentVersion\":\"2.0.370\"}},\"groupId\":\"ABC\",\"requestId\":\"9223372036854775807\","
+    "\"udids\":[\"\",null,false,[]],\"deviceId\":{}}";
+
+TEST(JSON_BINARY, TC_JSON_BINARY_01)
+{
+    CJson *msg = CreateJsonFromString(g_jsonBinaryMsg);
+    ASSERT_NE(msg, nullptr);
+    uint32_t dataLen = 0;
+    uint8_t *data = PackJsonToBinary(msg, &dataLen);
+    ASSERT_NE(data, nullptr);
+    EXPECT_TRUE(IsJsonBinary(data, dataLen));
+    EXPECT_LT(dataLen, strlen(g_jsonBinaryMsg));
+    CJson *decoded = CreateJsonFromData(data, dataLen);
+    ASSERT_NE(decoded, nullptr);
+    char *msgStr = PackJsonToString(msg);
+    char *decodedStr = PackJsonToString(decoded);
+    ASSERT_NE(msgStr, nullptr);
+    ASSERT_NE(decodedStr, nullptr);
+    EXPECT_STREQ(msgStr, decodedStr);
+    FreeJsonString(decodedStr);
+    FreeJson(decoded);
+    /* the text form is still taken, whether it is terminated or not */
+    decoded = CreateJsonFromData(reinterpret_cast<const uint8_t *>(msgStr), strlen(msgStr));
+    EXPECT_NE(decoded, nullptr);
+    FreeJson(decoded);
+    FreeJsonString(msgStr);
+    FreeJsonBinary(data);
+    FreeJson(msg);
+}
+
+TEST(JSON_BINARY, TC_JSON_BINARY_02)
+{
+    CJson *msg = CreateJsonFromString(g_jsonBinaryMsg);
+    ASSERT_NE(msg, nullptr);
+    uint32_t dataLen = 0;
+    uint8_t *data = PackJsonToBinary(msg, &dataLen);
+    ASSERT_NE(data, nullptr);
+    for (uint32_t len = 0; len < dataLen; len++) {
+        EXPECT_EQ(CreateJsonFromBinary(data, len), nullptr);
+    }
+    uint8_t version = data[1];
+    data[1] = version + 1;
+    EXPECT_EQ(CreateJsonFromBinary(data, dataLen), nullptr);
+    data[1] = version;
+    FreeJsonBinary(data);
+    FreeJson(msg);
+}
+
+TEST(JSON_BINARY, TC_JSON_BINARY_03)
+{
+    VersionStruct self = { 2, 0, EC_SPEKE | BINARY_WIRE_CAPABILITY };
+    VersionStruct peer = { 2, 0, DL_SPEKE | BINARY_WIRE_CAPABILITY };
+    /* the binary wire capability alone is no common algorithm */
+    EXPECT_EQ(NegotiateVersion(&peer, &peer, &self), HC_ERR_UNSUPPORTED_VERSION);
+    self.third = EC_SPEKE | DL_SPEKE | BINARY_WIRE_CAPABILITY;
+    EXPECT_EQ(NegotiateVersion(&peer, &peer, &self), HC_SUCCESS);
+    EXPECT_EQ(self.third, static_cast<uint32_t>(DL_SPEKE | BINARY_WIRE_CAPABILITY));
+    EXPECT_TRUE(IsSupportedBinaryWire(&self));
+    self.third = EC_SPEKE | DL_SPEKE;
+    EXPECT_EQ(NegotiateVersion(&peer, &peer, &self), HC_SUCCESS);
+    EXPECT_FALSE(IsSupportedBinaryWire(&self));
+}
+
+static const uint32_t JSON_BINARY_MUTATION_NUM = 5000;
+static const uint32_t JSON_BINARY_MAX_MUTATED_BYTES = 4;
+
+/* the randomly mutated data is either rejected or decoded, it never reads out of the data */
+TEST(JSON_BINARY, TC_JSON_BINARY_04)
+{
+    CJson *msg = CreateJsonFromString(g_jsonBinaryMsg);
+    ASSERT_NE(msg, nullptr);
+    uint32_t dataLen = 0;
+    uint8_t *data = PackJsonToBinary(msg, &dataLen);
+    ASSERT_NE(data, nullptr);
+    std::vector<uint8_t> mutated(dataLen);
+    uint32_t state = 1;
+    uint32_t decodedNum = 0;
+    for (uint32_t i = 0; i < JSON_BINARY_MUTATION_NUM; i++) {
+        mutated.assign(data, data + dataLen);
+        state = state * 1103515245u + 12345u;
+        uint32_t mutatedNum = 1 + (state >> 16) % JSON_BINARY_MAX_MUTATED_BYTES;
+        for (uint32_t j = 0; j < mutatedNum; j++) {
+            state = state * 1103515245u + 12345u;
+            /* the magic byte and the version are left as they are, so that the items are parsed */
+            mutated[2 + (state >> 8) % (dataLen - 2)] = static_cast<uint8_t>(state >> 24);
+        }
+        CJson *decoded = CreateJsonFromBinary(mutated.data(), dataLen);
+        decodedNum += (decoded != nullptr) ? 1 : 0;
+        FreeJson(decoded);
+    }
+    EXPECT_LT(decodedNum, JSON_BINARY_MUTATION_NUM);
+    FreeJsonBinary(data);
+    FreeJson(msg);
+}
+
+static const uint32_t HEX_CODEC_MAX_LEN = 130;
+
+TEST(HEX_CODEC, TC_HEX_CODEC_01)
+{
+    uint8_t byte[HEX_CODEC_MAX_LEN] = { 0 };
+    uint8_t decoded[HEX_CODEC_MAX_LEN] = { 0 };
+    char hexStr[HEX_CODEC_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH + 1] = { 0 };
+    for (uint32_t i = 0; i < HEX_CODEC_MAX_LEN; i++) {
+        byte[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    /* cover the block sizes of the vector paths and their tails */
+    for (uint32_t len = 1; len <= HEX_CODEC_MAX_LEN; len++) {
+        ASSERT_EQ(ByteToHexString(byte, len, hexStr, sizeof(hexStr)), HC_SUCCESS);
+        ASSERT_EQ(strlen(hexStr), len * BYTE_TO_HEX_OPER_LENGTH);
+        for (uint32_t i = 0; i < len * BYTE_TO_HEX_OPER_LENGTH; i += BYTE_TO_HEX_OPER_LENGTH) {
+            hexStr[i] = static_cast<char>(tolower(hexStr[i]));
+        }
+        ASSERT_EQ(HexStringToByte(hexStr, decoded, len), HC_SUCCESS);
+        ASSERT_EQ(memcmp(byte, decoded, len), 0);
+    }
+}
+
+TEST(HEX_CODEC, TC_HEX_CODEC_02)
+{
+    uint8_t byte[HEX_CODEC_MAX_LEN] = { 0 };
+    char hexStr[HEX_CODEC_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH + 1] = { 0 };
+    ASSERT_EQ(ByteToHexString(byte, HEX_CODEC_MAX_LEN, hexStr, sizeof(hexStr)), HC_SUCCESS);
+    EXPECT_NE(ByteToHexString(byte, HEX_CODEC_MAX_LEN, hexStr, sizeof(hexStr) - 1), HC_SUCCESS);
+    EXPECT_NE(HexStringToByte(hexStr, byte, HEX_CODEC_MAX_LEN - 1), HC_SUCCESS);
+    /* an invalid char is rejected wherever it is, inside a vector block or in the tail */
+    for (uint32_t pos = 0; pos < HEX_CODEC_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH; pos += 7) {
+        char saved = hexStr[pos];
+        hexStr[pos] = 'g';
+        EXPECT_NE(HexStringToByte(hexStr, byte, HEX_CODEC_MAX_LEN), HC_SUCCESS);
+        hexStr[pos] = saved;
+    }
+    hexStr[HEX_CODEC_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH - 1] = '\0';
+    EXPECT_NE(HexStringToByte(hexStr, byte, HEX_CODEC_MAX_LEN), HC_SUCCESS);
+}
+
+static const uint32_t HEX_CODEC_DIFF_ROUND_NUM = 20;
+static const uint32_t HEX_CODEC_DIFF_MAX_LEN = 300;
+static const uint8_t HEX_CODEC_OUT_OF_HEX = 16;
+static const uint8_t HEX_CODEC_FILL_BYTE = 0x5A;
+static const char HEX_CODEC_BAD_CHARS[] = "gG/:@`\x80\xff zZ";
+
+enum HexCodecDiffMode {
+    HEX_CODEC_DIFF_BAD_CHAR = 0,
+    HEX_CODEC_DIFF_SHORT_BUFFER,
+    HEX_CODEC_DIFF_ODD_LENGTH,
+    HEX_CODEC_DIFF_MODE_NUM = 6
+};
+
+/* the scalar codec as it was before the vector paths, the reference of the differential test */
+static uint8_t ReferenceCharToHex(char c)
+{
+    if ((c >= 'A') && (c <= 'F')) {
+        return (c - 'A' + DEC);
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return (c - 'a' + DEC);
+    } else if ((c >= '0') && (c <= '9')) {
+        return (c - '0');
+    }
+    return HEX_CODEC_OUT_OF_HEX;
+}
+
+static void ReferenceByteToHexString(const uint8_t *byte, uint32_t byteLen, char *hexStr)
+{
+    for (uint32_t i = 0; i < byteLen; i++) {
+        (void)sprintf_s(hexStr + i * BYTE_TO_HEX_OPER_LENGTH, BYTE_TO_HEX_OPER_LENGTH + 1, "%02X", byte[i]);
+    }
+    hexStr[byteLen * BYTE_TO_HEX_OPER_LENGTH] = '\0';
+}
+
+static int32_t ReferenceHexStringToByte(const char *hexStr, uint8_t *byte, uint32_t byteLen)
+{
+    uint32_t realHexLen = strlen(hexStr);
+    if (realHexLen % BYTE_TO_HEX_OPER_LENGTH != 0 || byteLen < realHexLen / BYTE_TO_HEX_OPER_LENGTH) {
+        return HAL_ERR_INVALID_LEN;
+    }
+    for (uint32_t i = 0; i < realHexLen / BYTE_TO_HEX_OPER_LENGTH; i++) {
+        uint8_t high = ReferenceCharToHex(hexStr[i * BYTE_TO_HEX_OPER_LENGTH]);
+        uint8_t low = ReferenceCharToHex(hexStr[i * BYTE_TO_HEX_OPER_LENGTH + 1]);
+        if (high == HEX_CODEC_OUT_OF_HEX || low == HEX_CODEC_OUT_OF_HEX) {
+            return HAL_ERR_INVALID_PARAM;
+        }
+        byte[i] = (high << 4) | low; /* 4: Set the high nibble */
+    }
+    return HAL_SUCCESS;
+}
+
+static uint32_t NextHexCodecRandom(uint32_t *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16; /* 16: the low bits of the generator are weak */
+}
+
+/*
+ * The codec agrees with the scalar reference at every length up to 300, in the output and in the return code.
+ * The hex is in mixed case, and carries an invalid char, is of an odd length or is decoded into a short buffer.
+ */
+TEST(HEX_CODEC, TC_HEX_CODEC_03)
+{
+    uint8_t byte[HEX_CODEC_DIFF_MAX_LEN] = { 0 };
+    uint8_t decoded[HEX_CODEC_DIFF_MAX_LEN + 2] = { 0 };
+    uint8_t refDecoded[HEX_CODEC_DIFF_MAX_LEN + 2] = { 0 };
+    char hexStr[HEX_CODEC_DIFF_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH + 1] = { 0 };
+    char refHexStr[HEX_CODEC_DIFF_MAX_LEN * BYTE_TO_HEX_OPER_LENGTH + 1] = { 0 };
+    uint32_t state = 1;
+    for (uint32_t round = 0; round < HEX_CODEC_DIFF_ROUND_NUM; round++) {
+        for (uint32_t len = 0; len <= HEX_CODEC_DIFF_MAX_LEN; len++) {
+            for (uint32_t i = 0; i < len; i++) {
+                byte[i] = static_cast<uint8_t>(NextHexCodecRandom(&state));
+            }
+            uint32_t hexLen = len * BYTE_TO_HEX_OPER_LENGTH;
+            ASSERT_EQ(ByteToHexString(byte, len, hexStr, hexLen + 1), HC_SUCCESS);
+            ASSERT_NE(ByteToHexString(byte, len, hexStr, hexLen), HC_SUCCESS);
+            ReferenceByteToHexString(byte, len, refHexStr);
+            ASSERT_STREQ(hexStr, refHexStr);
+            for (uint32_t i = 0; i < hexLen; i++) {
+                if ((NextHexCodecRandom(&state) % 3) == 0) { /* 3: lower about a third of the chars */
+                    hexStr[i] = static_cast<char>(tolower(hexStr[i]));
+                }
+            }
+            uint32_t mode = NextHexCodecRandom(&state) % HEX_CODEC_DIFF_MODE_NUM;
+            uint32_t capacity = len + NextHexCodecRandom(&state) % 3; /* 3: up to two spare bytes */
+            if ((len > 0) && (mode == HEX_CODEC_DIFF_BAD_CHAR)) {
+                hexStr[NextHexCodecRandom(&state) % hexLen] =
+                    HEX_CODEC_BAD_CHARS[NextHexCodecRandom(&state) % (sizeof(HEX_CODEC_BAD_CHARS) - 1)];
+            } else if ((len > 0) && (mode == HEX_CODEC_DIFF_SHORT_BUFFER)) {
+                capacity = len - 1;
+            } else if ((len > 0) && (mode == HEX_CODEC_DIFF_ODD_LENGTH)) {
+                hexStr[hexLen - 1] = '\0';
+            }
+            (void)memset_s(decoded, sizeof(decoded), HEX_CODEC_FILL_BYTE, sizeof(decoded));
+            (void)memset_s(refDecoded, sizeof(refDecoded), HEX_CODEC_FILL_BYTE, sizeof(refDecoded));
+            int32_t refRet = ReferenceHexStringToByte(hexStr, refDecoded, capacity);
+            ASSERT_EQ(HexStringToByte(hexStr, decoded, capacity), refRet) << "len " << len << " mode " << mode;
+            ASSERT_EQ(memcmp(decoded, refDecoded, sizeof(decoded)), 0) << "len " << len << " mode " << mode;
+        }
+    }
+}
+
+static const uint32_t MEM_ARENA_CHUNK_SIZE = 1024;
+static const uint32_t MEM_ARENA_CHUNK_NUM = 4;
+static const uint32_t MEM_ARENA_ALLOC_SIZE = 64;
+
+static bool IsZeroed(const uint8_t *addr, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        if (addr[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(MEM_ARENA, TC_MEM_ARENA_01)
+{
+    ASSERT_EQ(InitMemArena(MEM_ARENA_CHUNK_SIZE, MEM_ARENA_CHUNK_NUM), HAL_SUCCESS);
+    BindMemArena();
+    uint8_t *secret = static_cast<uint8_t *>(HcMalloc(MEM_ARENA_ALLOC_SIZE, 0));
+    ASSERT_NE(secret, nullptr);
+    EXPECT_TRUE(IsMemArenaAddr(secret));
+    EXPECT_TRUE(IsZeroed(secret, MEM_ARENA_ALLOC_SIZE));
+    (void)memset_s(secret, MEM_ARENA_ALLOC_SIZE, 0xA5, MEM_ARENA_ALLOC_SIZE);
+    CJson *json = CreateJson();
+    ASSERT_NE(json, nullptr);
+    EXPECT_TRUE(IsMemArenaAddr(json));
+    FreeJson(json);
+    void *large = HcMalloc(MEM_ARENA_CHUNK_SIZE, 0);
+    ASSERT_NE(large, nullptr);
+    EXPECT_FALSE(IsMemArenaAddr(large));
+    HcFree(large);
+    HcFree(secret);
+    UnbindMemArena();
+    HcMemArenaStat stat;
+    GetMemArenaStat(&stat);
+    EXPECT_EQ(stat.freeChunkNum, MEM_ARENA_CHUNK_NUM);
+    EXPECT_EQ(stat.fallbackNum, 1u);
+
+    BindMemArena();
+    uint8_t *reused = static_cast<uint8_t *>(HcMalloc(MEM_ARENA_ALLOC_SIZE, 0));
+    ASSERT_EQ(reused, secret);
+    EXPECT_TRUE(IsZeroed(reused, MEM_ARENA_ALLOC_SIZE));
+    HcFree(reused);
+    UnbindMemArena();
+    DestroyMemArena();
+    EXPECT_FALSE(IsMemArenaAddr(reused));
+}
+
+TEST(MEM_ARENA, TC_MEM_ARENA_02)
+{
+    ASSERT_EQ(InitMemArena(MEM_ARENA_CHUNK_SIZE, MEM_ARENA_CHUNK_NUM), HAL_SUCCESS);
+    BindMemArena();
+    void *escaped = HcMalloc(MEM_ARENA_ALLOC_SIZE, 0);
+    ASSERT_NE(escaped, nullptr);
+    escaped = HcRealloc(escaped, MEM_ARENA_ALLOC_SIZE, MEM_ARENA_ALLOC_SIZE * 2);
+    ASSERT_NE(escaped, nullptr);
+    UnbindMemArena();
+    HcMemArenaStat stat;
+    GetMemArenaStat(&stat);
+    EXPECT_EQ(stat.freeChunkNum, MEM_ARENA_CHUNK_NUM - 1);
+
+    DestroyMemArena();
+    EXPECT_TRUE(IsMemArenaAddr(escaped));
+    EXPECT_NE(InitMemArena(MEM_ARENA_CHUNK_SIZE, MEM_ARENA_CHUNK_NUM), HAL_SUCCESS);
+    HcFree(escaped);
+    EXPECT_FALSE(IsMemArenaAddr(escaped));
+    ASSERT_EQ(InitMemArena(MEM_ARENA_CHUNK_SIZE, MEM_ARENA_CHUNK_NUM), HAL_SUCCESS);
+    DestroyMemArena();
+}
+
+/*
+ * only the json of the deviceauth wrappers comes from the arena, and none does once another module replaces
+ * the cJSON hooks. The hooks stay replaced, so this case runs after the others which take json from the arena.
+ */
+TEST(MEM_ARENA, TC_MEM_ARENA_03)
+{
+    ASSERT_EQ(InitMemArena(MEM_ARENA_CHUNK_SIZE, MEM_ARENA_CHUNK_NUM), HAL_SUCCESS);
+    BindMemArena();
+    cJSON *otherJson = cJSON_CreateObject();
+    ASSERT_NE(otherJson, nullptr);
+    EXPECT_FALSE(IsMemArenaAddr(otherJson));
+    cJSON_Delete(otherJson);
+    CJson *json = CreateJson();
+    ASSERT_NE(json, nullptr);
+    EXPECT_TRUE(IsMemArenaAddr(json));
+    EXPECT_EQ(AddStringToJson(json, FIELD_GROUP_ID, "MEM_ARENA_TEST_GROUP"), HC_SUCCESS);
+    char *jsonStr = PackJsonToString(json);
+    ASSERT_NE(jsonStr, nullptr);
+    EXPECT_TRUE(IsMemArenaAddr(jsonStr));
+    FreeJsonString(jsonStr);
+    FreeJson(json);
+    UnbindMemArena();
+
+    cJSON_Hooks otherHooks = { malloc, free };
+    cJSON_InitHooks(&otherHooks);
+    BindMemArena();
+    json = CreateJson();
+    ASSERT_NE(json, nullptr);
+    EXPECT_FALSE(IsMemArenaAddr(json));
+    FreeJson(json);
+    UnbindMemArena();
+    DestroyMemArena();
+}
+
+static const uint32_t MEM_POOL_OBJ_SIZE = 20;
+static const uint32_t MEM_POOL_ALIGNED_OBJ_SIZE = 24;
+static const uint32_t MEM_POOL_OBJ_NUM_PER_SLAB = 4;
+static const uint32_t MEM_POOL_SLAB_NUM = 3;
+static const uint32_t MEM_POOL_OBJ_NUM = 10;
+
+/* the objects are spread over three slabs, they are distinct and aligned, and the spare slabs go back when empty */
+TEST(MEM_POOL, TC_MEM_POOL_01)
+{
+    HcMemPool pool;
+    ASSERT_EQ(InitMemPool(&pool, MEM_POOL_OBJ_SIZE, MEM_POOL_OBJ_NUM_PER_SLAB), HAL_SUCCESS);
+    HcMemPoolStat stat;
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_EQ(stat.reservedBytes, 0u);
+    vector<uint8_t *> objs;
+    for (uint32_t i = 0; i < MEM_POOL_OBJ_NUM; i++) {
+        uint8_t *obj = static_cast<uint8_t *>(MemPoolAlloc(&pool));
+        ASSERT_NE(obj, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(obj) % sizeof(uint64_t), 0u);
+        EXPECT_TRUE(IsZeroed(obj, MEM_POOL_OBJ_SIZE));
+        (void)memset_s(obj, MEM_POOL_OBJ_SIZE, i + 1, MEM_POOL_OBJ_SIZE);
+        objs.push_back(obj);
+        if (i == 0) {
+            GetMemPoolStat(&pool, &stat);
+        }
+    }
+    uint32_t slabBytes = stat.reservedBytes;
+    EXPECT_GE(slabBytes, MEM_POOL_ALIGNED_OBJ_SIZE * MEM_POOL_OBJ_NUM_PER_SLAB);
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_EQ(stat.usedNum, MEM_POOL_OBJ_NUM);
+    EXPECT_EQ(stat.usedBytes, MEM_POOL_OBJ_NUM * MEM_POOL_ALIGNED_OBJ_SIZE);
+    EXPECT_EQ(stat.reservedBytes, slabBytes * MEM_POOL_SLAB_NUM);
+    /* no object overlaps another one */
+    for (uint32_t i = 0; i < MEM_POOL_OBJ_NUM; i++) {
+        for (uint32_t j = 0; j < MEM_POOL_OBJ_SIZE; j++) {
+            ASSERT_EQ(objs[i][j], i + 1);
+        }
+    }
+    /* a freed object is reused before a new slab is taken */
+    MemPoolFree(&pool, objs[1]);
+    uint8_t *reused = static_cast<uint8_t *>(MemPoolAlloc(&pool));
+    EXPECT_EQ(reused, objs[1]);
+    EXPECT_TRUE(IsZeroed(reused, MEM_POOL_OBJ_SIZE));
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_EQ(stat.reservedBytes, slabBytes * MEM_POOL_SLAB_NUM);
+    for (uint8_t *obj : objs) {
+        MemPoolFree(&pool, obj);
+    }
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_EQ(stat.usedNum, 0u);
+    EXPECT_EQ(stat.usedBytes, 0u);
+    EXPECT_EQ(stat.reservedBytes, slabBytes);
+    /* the kept slab serves the next allocations */
+    for (uint32_t i = 0; i < MEM_POOL_OBJ_NUM_PER_SLAB; i++) {
+        objs[i] = static_cast<uint8_t *>(MemPoolAlloc(&pool));
+        ASSERT_NE(objs[i], nullptr);
+    }
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_EQ(stat.reservedBytes, slabBytes);
+    for (uint32_t i = 0; i < MEM_POOL_OBJ_NUM_PER_SLAB; i++) {
+        MemPoolFree(&pool, objs[i]);
+    }
+    DestroyMemPool(&pool);
+}
+
+TEST(MEM_POOL, TC_MEM_POOL_02)
+{
+    HcMemPool pool;
+    EXPECT_NE(InitMemPool(nullptr, MEM_POOL_OBJ_SIZE, MEM_POOL_OBJ_NUM_PER_SLAB), HAL_SUCCESS);
+    EXPECT_NE(InitMemPool(&pool, 0, MEM_POOL_OBJ_NUM_PER_SLAB), HAL_SUCCESS);
+    EXPECT_NE(InitMemPool(&pool, MEM_POOL_OBJ_SIZE, 0), HAL_SUCCESS);
+    EXPECT_NE(InitMemPool(&pool, UINT32_MAX, MEM_POOL_OBJ_NUM_PER_SLAB), HAL_SUCCESS);
+    EXPECT_NE(InitMemPool(&pool, MEM_POOL_OBJ_SIZE, UINT32_MAX), HAL_SUCCESS);
+    EXPECT_EQ(MemPoolAlloc(nullptr), nullptr);
+    /* an object smaller than a pointer still holds the link of the free list */
+    ASSERT_EQ(InitMemPool(&pool, 1, MEM_POOL_OBJ_NUM_PER_SLAB), HAL_SUCCESS);
+    void *first = MemPoolAlloc(&pool);
+    void *second = MemPoolAlloc(&pool);
+    ASSERT_TRUE((first != nullptr) && (second != nullptr) && (first != second));
+    HcMemPoolStat stat;
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_GE(stat.usedBytes, 2 * sizeof(void *));
+    MemPoolFree(&pool, nullptr);
+    MemPoolFree(&pool, first);
+    MemPoolFree(&pool, second);
+    GetMemPoolStat(&pool, &stat);
+    EXPECT_EQ(stat.usedNum, 0u);
+    DestroyMemPool(&pool);
+}
+
+static const uint32_t SESSION_TEST_MAX_COUNT = MAX_SESSION_COUNT + 10;
+static const int64_t SESSION_TEST_REQUEST_ID_BASE = 0x5000;
+static DeviceAuthCallback g_sessionTestCallback = { nullptr };
+
+static char *OnSessionTestRequest(int64_t requestId, int operationCode, const char *reqParams)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)reqParams;
+    CJson *returnData = CreateJson();
+    (void)AddIntToJson(returnData, FIELD_CONFIRMATION, REQUEST_WAITING);
+    char *returnDataStr = PackJsonToString(returnData);
+    FreeJson(returnData);
+    return returnDataStr;
+}
+
+/* a server bind session which waits for the confirmation of the service */
+static int32_t OpenWaitingTestSession(int64_t requestId)
+{
+    CJson *params = CreateJson();
+    if (params == nullptr) {
+        return HC_ERR_ALLOC_MEMORY;
+    }
+    (void)AddInt64StringToJson(params, FIELD_REQUEST_ID, requestId);
+    (void)AddIntToJson(params, FIELD_GROUP_OP, MEMBER_INVITE);
+    (void)AddStringToJson(params, FIELD_GROUP_ID, "SESSION_TEST_GROUP");
+    (void)AddIntToJson(params, FIELD_GROUP_TYPE, PEER_TO_PEER_GROUP);
+    (void)AddStringToJson(params, FIELD_PEER_DEVICE_ID, CLIENT_AUTH_ID);
+    (void)AddStringToJson(params, FIELD_APP_ID, TEST_APP_NAME);
+    g_sessionTestCallback.onRequest = OnSessionTestRequest;
+    int32_t ret = CreateSession(requestId, TYPE_SERVER_BIND_SESSION, params, &g_sessionTestCallback);
+    FreeJson(params);
+    return ret;
+}
+
+void SESSION_MANAGER::SetUp()
+{
+    DeleteDatabase();
+    SetMaxSessionCount(SESSION_TEST_MAX_COUNT);
+    InitDeviceAuthService();
+}
+
+void SESSION_MANAGER::TearDown()
+{
+    DestroyDeviceAuthService();
+    SetMaxSessionCount(MAX_SESSION_COUNT);
+}
+
+/* the limit comes from HcGetMaxSessionCount, it can be above MAX_SESSION_COUNT and it is never passed */
+TEST_F(SESSION_MANAGER, TC_SESSION_LIMIT_01)
+{
+    for (uint32_t i = 0; i < SESSION_TEST_MAX_COUNT; i++) {
+        ASSERT_EQ(OpenWaitingTestSession(SESSION_TEST_REQUEST_ID_BASE + i), HC_SUCCESS);
+    }
+    int64_t extraRequestId = SESSION_TEST_REQUEST_ID_BASE + SESSION_TEST_MAX_COUNT;
+    EXPECT_EQ(OpenWaitingTestSession(extraRequestId), HC_ERR_SESSION_IS_FULL);
+    EXPECT_FALSE(IsRequestExist(extraRequestId));
+    DestroySession(SESSION_TEST_REQUEST_ID_BASE);
+    EXPECT_EQ(OpenWaitingTestSession(extraRequestId), HC_SUCCESS);
+    EXPECT_EQ(OpenWaitingTestSession(SESSION_TEST_REQUEST_ID_BASE), HC_ERR_SESSION_IS_FULL);
+}
+
+/* the counters follow the sessions, and the pools give their memory back once the sessions are gone */
+TEST_F(SESSION_MANAGER, TC_SESSION_MEMORY_STAT_01)
+{
+    SessionMemoryStat stat;
+    GetSessionMemoryStat(&stat);
+    EXPECT_EQ(stat.sessionCount, 0u);
+    EXPECT_EQ(stat.capacity, SESSION_TEST_MAX_COUNT);
+    EXPECT_EQ(stat.usedBytes, 0u);
+    uint32_t idleReservedBytes = stat.reservedBytes;
+    ASSERT_EQ(OpenWaitingTestSession(SESSION_TEST_REQUEST_ID_BASE), HC_SUCCESS);
+    GetSessionMemoryStat(&stat);
+    EXPECT_EQ(stat.sessionCount, 1u);
+    uint32_t sessionBytes = stat.usedBytes;
+    EXPECT_GT(sessionBytes, 0u);
+    for (uint32_t i = 1; i < SESSION_TEST_MAX_COUNT; i++) {
+        ASSERT_EQ(OpenWaitingTestSession(SESSION_TEST_REQUEST_ID_BASE + i), HC_SUCCESS);
+    }
+    GetSessionMemoryStat(&stat);
+    EXPECT_EQ(stat.sessionCount, SESSION_TEST_MAX_COUNT);
+    EXPECT_EQ(stat.usedBytes, sessionBytes * SESSION_TEST_MAX_COUNT);
+    EXPECT_GE(stat.reservedBytes, stat.usedBytes);
+    uint32_t fullReservedBytes = stat.reservedBytes;
+    /* a failed creation leaves the counters as they are */
+    EXPECT_EQ(OpenWaitingTestSession(SESSION_TEST_REQUEST_ID_BASE + SESSION_TEST_MAX_COUNT), HC_ERR_SESSION_IS_FULL);
+    GetSessionMemoryStat(&stat);
+    EXPECT_EQ(stat.sessionCount, SESSION_TEST_MAX_COUNT);
+    EXPECT_EQ(stat.usedBytes, sessionBytes * SESSION_TEST_MAX_COUNT);
+    for (uint32_t i = 0; i < SESSION_TEST_MAX_COUNT; i++) {
+        DestroySession(SESSION_TEST_REQUEST_ID_BASE + i);
+    }
+    GetSessionMemoryStat(&stat);
+    EXPECT_EQ(stat.sessionCount, 0u);
+    EXPECT_EQ(stat.usedBytes, 0u);
+    EXPECT_LT(stat.reservedBytes, fullReservedBytes);
+    EXPECT_GE(stat.reservedBytes, idleReservedBytes);
+}
+
+static const uint32_t LRU_CACHE_CAPACITY = 2;
+static const uint32_t LRU_CACHE_MAX_LEN = 8;
+
+static bool IsCachedValue(HcLruCache *cache, const char *key, const char *value)
+{
+    Uint8Buff keyBuff = { (uint8_t *)key, (uint32_t)strlen(key) };
+    uint8_t valueVal[LRU_CACHE_MAX_LEN] = { 0 };
+    Uint8Buff valueBuff = { valueVal, sizeof(valueVal) };
+    if (!LruCacheGet(cache, &keyBuff, &valueBuff)) {
+        return false;
+    }
+    return (valueBuff.length == strlen(value)) && (memcmp(valueVal, value, valueBuff.length) == 0);
+}
+
+static void PutValue(HcLruCache *cache, const char *key, const char *value, uint32_t epoch)
+{
+    Uint8Buff keyBuff = { (uint8_t *)key, (uint32_t)strlen(key) };
+    Uint8Buff valueBuff = { (uint8_t *)value, (uint32_t)strlen(value) };
+    LruCachePut(cache, &keyBuff, &valueBuff, epoch);
+}
+
+TEST(LRU_CACHE, TC_LRU_CACHE_01)
+{
+    HcLruCache cache;
+    ASSERT_EQ(InitLruCache(&cache, LRU_CACHE_CAPACITY, LRU_CACHE_MAX_LEN, LRU_CACHE_MAX_LEN), HAL_SUCCESS);
+    PutValue(&cache, "a", "1", GetLruCacheEpoch(&cache));
+    PutValue(&cache, "b", "2", GetLruCacheEpoch(&cache));
+    EXPECT_TRUE(IsCachedValue(&cache, "a", "1"));
+    PutValue(&cache, "c", "3", GetLruCacheEpoch(&cache));
+    EXPECT_FALSE(IsCachedValue(&cache, "b", "2"));
+    EXPECT_TRUE(IsCachedValue(&cache, "a", "1"));
+    EXPECT_TRUE(IsCachedValue(&cache, "c", "3"));
+    PutValue(&cache, "a", "11", GetLruCacheEpoch(&cache));
+    EXPECT_TRUE(IsCachedValue(&cache, "a", "11"));
+    PutValue(&cache, "toolongkey", "4", GetLruCacheEpoch(&cache));
+    EXPECT_FALSE(IsCachedValue(&cache, "toolongkey", "4"));
+    DestroyLruCache(&cache);
+}
+
+TEST(LRU_CACHE, TC_LRU_CACHE_02)
+{
+    HcLruCache cache;
+    ASSERT_EQ(InitLruCache(&cache, LRU_CACHE_CAPACITY, LRU_CACHE_MAX_LEN, LRU_CACHE_MAX_LEN), HAL_SUCCESS);
+    PutValue(&cache, "a", "1", GetLruCacheEpoch(&cache));
+    uint32_t epoch = GetLruCacheEpoch(&cache);
+    Uint8Buff keyBuff = { (uint8_t *)"a", 1 };
+    LruCacheRemove(&cache, &keyBuff);
+    EXPECT_FALSE(LruCacheGet(&cache, &keyBuff, nullptr));
+    /* a value read before the removal is not put back */
+    PutValue(&cache, "a", "1", epoch);
+    EXPECT_FALSE(LruCacheGet(&cache, &keyBuff, nullptr));
+    PutValue(&cache, "a", "2", GetLruCacheEpoch(&cache));
+    EXPECT_TRUE(LruCacheGet(&cache, &keyBuff, nullptr));
+    ClearLruCache(&cache);
+    EXPECT_FALSE(LruCacheGet(&cache, &keyBuff, nullptr));
+    DestroyLruCache(&cache);
+}
+
+static const uint32_t KEY_ALIAS_DERIVE_HASH_NUM = 2; /* the service id, then the alias */
+static const char *KEY_ALIAS_SERVICE_TYPE = "TestServiceType";
+
+static int32_t GenerateTestKeyAlias(const char *authId, Uint8Buff *outKeyAlias)
+{
+    Uint8Buff pkgName = { (uint8_t *)TEST_APP_NAME, (uint32_t)strlen(TEST_APP_NAME) };
+    Uint8Buff serviceType = { (uint8_t *)KEY_ALIAS_SERVICE_TYPE, (uint32_t)strlen(KEY_ALIAS_SERVICE_TYPE) };
+    Uint8Buff authIdBuff = { (uint8_t *)authId, (uint32_t)strlen(authId) };
+    return GenerateKeyAlias(&pkgName, &serviceType, KEY_ALIAS_LT_KEY_PAIR, &authIdBuff, outKeyAlias);
+}
+
+TEST(KEY_ALIAS_CACHE, TC_KEY_ALIAS_CACHE_01)
+{
+    ASSERT_EQ(GetLoaderInstance()->initAlg(), HAL_SUCCESS);
+    ASSERT_EQ(InitKeyAliasCache(), HC_SUCCESS);
+    uint8_t firstVal[PAKE_KEY_ALIAS_LEN] = { 0 };
+    uint8_t secondVal[PAKE_KEY_ALIAS_LEN] = { 0 };
+    Uint8Buff first = { firstVal, sizeof(firstVal) };
+    Uint8Buff second = { secondVal, sizeof(secondVal) };
+    uint32_t hashNum = GetSha256CallNum();
+    EXPECT_EQ(GenerateTestKeyAlias(CLIENT_AUTH_ID, &first), HC_SUCCESS);
+    EXPECT_EQ(GetSha256CallNum() - hashNum, KEY_ALIAS_DERIVE_HASH_NUM);
+    /* the same inputs again, the alias comes from the cache without a single hash */
+    hashNum = GetSha256CallNum();
+    EXPECT_EQ(GenerateTestKeyAlias(CLIENT_AUTH_ID, &second), HC_SUCCESS);
+    EXPECT_EQ(GetSha256CallNum(), hashNum);
+    EXPECT_EQ(memcmp(firstVal, secondVal, sizeof(firstVal)), 0);
+    /* another peer is derived */
+    hashNum = GetSha256CallNum();
+    EXPECT_EQ(GenerateTestKeyAlias(SERVER_AUTH_ID, &second), HC_SUCCESS);
+    EXPECT_EQ(GetSha256CallNum() - hashNum, KEY_ALIAS_DERIVE_HASH_NUM);
+    EXPECT_NE(memcmp(firstVal, secondVal, sizeof(firstVal)), 0);
+    DestroyKeyAliasCache();
+
+    /* without the cache every alias is derived, and it is the same alias */
+    hashNum = GetSha256CallNum();
+    EXPECT_EQ(GenerateTestKeyAlias(CLIENT_AUTH_ID, &second), HC_SUCCESS);
+    EXPECT_EQ(GenerateTestKeyAlias(CLIENT_AUTH_ID, &second), HC_SUCCESS);
+    EXPECT_EQ(GetSha256CallNum() - hashNum, KEY_ALIAS_DERIVE_HASH_NUM + KEY_ALIAS_DERIVE_HASH_NUM);
+    EXPECT_EQ(memcmp(firstVal, secondVal, sizeof(firstVal)), 0);
+}
+
+static bool IsExportedKey(const Uint8Buff *keyAlias, const uint8_t *expectedKey)
+{
+    uint8_t keyVal[PAKE_ED25519_KEY_PAIR_LEN] = { 0 };
+    Uint8Buff key = { keyVal, sizeof(keyVal) };
+    if (GetLoaderInstance()->exportPublicKey(keyAlias, &key) != HAL_SUCCESS) {
+        return false;
+    }
+    return (key.length == sizeof(keyVal)) && (memcmp(keyVal, expectedKey, sizeof(keyVal)) == 0);
+}
+
+/* drop a key behind the back of the loader, a later answer for it can only come from the cache */
+static void DeleteKeyInHuks(const Uint8Buff *keyAlias)
+{
+    struct HksBlob keyAliasBlob = { keyAlias->length, keyAlias->val };
+    EXPECT_EQ(HksDeleteKey(&keyAliasBlob, nullptr), HKS_SUCCESS);
+}
+
+TEST(KEY_ALIAS_CACHE, TC_KEY_ALIAS_CACHE_02)
+{
+    const AlgLoader *loader = GetLoaderInstance();
+    ASSERT_EQ(loader->initAlg(), HAL_SUCCESS);
+    uint8_t aliasVal[PAKE_KEY_ALIAS_LEN] = { 0 };
+    Uint8Buff keyAlias = { aliasVal, sizeof(aliasVal) };
+    ASSERT_EQ(GenerateTestKeyAlias(CLIENT_AUTH_ID, &keyAlias), HC_SUCCESS);
+    ExtraInfo exInfo = { { (uint8_t *)CLIENT_AUTH_ID, (uint32_t)strlen(CLIENT_AUTH_ID) }, -1, -1 };
+    ASSERT_EQ(loader->generateKeyPairWithStorage(&keyAlias, PAKE_ED25519_KEY_PAIR_LEN, ED25519, &exInfo),
+        HAL_SUCCESS);
+    uint8_t pubKeyVal[PAKE_ED25519_KEY_PAIR_LEN] = { 0 };
+    Uint8Buff pubKey = { pubKeyVal, sizeof(pubKeyVal) };
+    ASSERT_EQ(loader->exportPublicKey(&keyAlias, &pubKey), HAL_SUCCESS);
+
+    /* the check and the export of the next handshake don't reach huks */
+    DeleteKeyInHuks(&keyAlias);
+    EXPECT_EQ(loader->checkKeyExist(&keyAlias), HAL_SUCCESS);
+    EXPECT_TRUE(IsExportedKey(&keyAlias, pubKeyVal));
+
+    /* a new key pair under the alias replaces the cached key */
+    ASSERT_EQ(loader->generateKeyPairWithStorage(&keyAlias, PAKE_ED25519_KEY_PAIR_LEN, ED25519, &exInfo),
+        HAL_SUCCESS);
+    EXPECT_FALSE(IsExportedKey(&keyAlias, pubKeyVal));
+    ASSERT_EQ(loader->exportPublicKey(&keyAlias, &pubKey), HAL_SUCCESS);
+
+    /* so does an imported key, the key of another peer is taken for it */
+    uint8_t peerAliasVal[PAKE_KEY_ALIAS_LEN] = { 0 };
+    Uint8Buff peerAlias = { peerAliasVal, sizeof(peerAliasVal) };
+    ASSERT_EQ(GenerateTestKeyAlias(SERVER_AUTH_ID, &peerAlias), HC_SUCCESS);
+    ASSERT_EQ(loader->generateKeyPairWithStorage(&peerAlias, PAKE_ED25519_KEY_PAIR_LEN, ED25519, &exInfo),
+        HAL_SUCCESS);
+    uint8_t peerKeyVal[PAKE_ED25519_KEY_PAIR_LEN] = { 0 };
+    Uint8Buff peerKey = { peerKeyVal, sizeof(peerKeyVal) };
+    ASSERT_EQ(loader->exportPublicKey(&peerAlias, &peerKey), HAL_SUCCESS);
+    EXPECT_EQ(loader->deleteKey(&peerAlias), HAL_SUCCESS);
+    DeleteKeyInHuks(&keyAlias);
+    EXPECT_TRUE(IsExportedKey(&keyAlias, pubKeyVal));
+    ASSERT_EQ(loader->importPublicKey(&keyAlias, &peerKey, ED25519, &exInfo), HAL_SUCCESS);
+    EXPECT_TRUE(IsExportedKey(&keyAlias, peerKeyVal));
+
+    /* and a delete drops it */
+    EXPECT_EQ(loader->deleteKey(&keyAlias), HAL_SUCCESS);
+    EXPECT_NE(loader->checkKeyExist(&keyAlias), HAL_SUCCESS);
+    EXPECT_FALSE(IsExportedKey(&keyAlias, peerKeyVal));
+}
+
+static const uint32_t CRYPTO_POOL_WORKER_NUM = 2;
+static HcCondition g_cryptoPoolCond;
+static uint32_t g_cryptoPoolDoneNum = 0;
+static int32_t g_cryptoPoolResult = HAL_SUCCESS;
+
+static void OnCryptoOpDone(int32_t result, void *ctx)
+{
+    (void)ctx;
+    g_cryptoPoolCond.mutex->lock(g_cryptoPoolCond.mutex);
+    g_cryptoPoolDoneNum++;
+    if (result != HAL_SUCCESS) {
+        g_cryptoPoolResult = result;
+    }
+    g_cryptoPoolCond.notifyWithoutLock(&g_cryptoPoolCond);
+    g_cryptoPoolCond.mutex->unlock(g_cryptoPoolCond.mutex);
+}
+
+static void WaitCryptoOps(uint32_t opNum)
+{
+    g_cryptoPoolCond.mutex->lock(g_cryptoPoolCond.mutex);
+    while (g_cryptoPoolDoneNum < opNum) {
+        g_cryptoPoolCond.waitWithoutLock(&g_cryptoPoolCond);
+    }
+    g_cryptoPoolCond.mutex->unlock(g_cryptoPoolCond.mutex);
+}
+
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_01)
+{
+    const uint32_t vectorNum = sizeof(g_hashToPointVectors) / sizeof(g_hashToPointVectors[0]);
+    uint8_t hashVal[vectorNum][HASH_TO_POINT_LEN] = { { 0 } };
+    uint8_t pointVal[vectorNum][HASH_TO_POINT_LEN] = { { 0 } };
+    Uint8Buff point[vectorNum];
+    ASSERT_EQ(InitHcCond(&g_cryptoPoolCond, nullptr), HAL_SUCCESS);
+    g_cryptoPoolDoneNum = 0;
+    g_cryptoPoolResult = HAL_SUCCESS;
+    ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+    const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+    ASSERT_NE(asyncLoader, nullptr);
+    for (uint32_t i = 0; i < vectorNum; i++) {
+        ASSERT_EQ(HexStringToByte(g_hashToPointVectors[i][0], hashVal[i], HASH_TO_POINT_LEN), HC_SUCCESS);
+        /* the input struct is copied, the output one gets the length of the result */
+        Uint8Buff hash = { hashVal[i], HASH_TO_POINT_LEN };
+        point[i] = { pointVal[i], HASH_TO_POINT_LEN };
+        ASSERT_EQ(asyncLoader->hashToPoint(&hash, X25519, &point[i], OnCryptoOpDone, nullptr), HAL_SUCCESS);
+    }
+    WaitCryptoOps(vectorNum);
+    EXPECT_EQ(g_cryptoPoolResult, HAL_SUCCESS);
+    uint8_t expectVal[HASH_TO_POINT_LEN] = { 0 };
+    for (uint32_t i = 0; i < vectorNum; i++) {
+        ASSERT_EQ(HexStringToByte(g_hashToPointVectors[i][1], expectVal, sizeof(expectVal)), HC_SUCCESS);
+        EXPECT_EQ(memcmp(pointVal[i], expectVal, sizeof(expectVal)), 0);
+    }
+    DestroyCryptoPool();
+    EXPECT_EQ(GetAsyncLoaderInstance(), nullptr);
+    DestroyHcCond(&g_cryptoPoolCond);
+}
+
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_02)
+{
+    EXPECT_EQ(InitCryptoPool(0), HAL_SUCCESS);
+    EXPECT_EQ(GetAsyncLoaderInstance(), nullptr);
+    ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+    const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+    ASSERT_NE(asyncLoader, nullptr);
+    uint8_t hashVal[HASH_TO_POINT_LEN] = { 0 };
+    uint8_t pointVal[HASH_TO_POINT_LEN] = { 0 };
+    Uint8Buff hash = { hashVal, HASH_TO_POINT_LEN };
+    Uint8Buff point = { pointVal, HASH_TO_POINT_LEN };
+    /* onDone is not called when the operation is refused */
+    EXPECT_NE(asyncLoader->hashToPoint(&hash, X25519, &point, nullptr, nullptr), HAL_SUCCESS);
+    EXPECT_NE(asyncLoader->hashToPoint(nullptr, X25519, &point, OnCryptoOpDone, nullptr), HAL_SUCCESS);
+    DestroyCryptoPool();
+    EXPECT_EQ(GetAsyncLoaderInstance(), nullptr);
+}
+
+static const uint32_t CRYPTO_GATE_WAIT_MSEC = 1;
+static const uint32_t CRYPTO_FILLER_LEN = 16;
+static std::atomic<bool> g_cryptoGateOpen(true);
+static std::atomic<uint32_t> g_cryptoGateRunNum(0);
+static std::atomic<uint32_t> g_cryptoFillerDoneNum(0);
+static std::atomic<uint32_t> g_cryptoFillerCancelNum(0);
+static std::atomic<uint32_t> g_pakeStepDoneNum(0);
+static std::atomic<bool> g_isPakeStepPendingInDone(false);
+static uint8_t g_cryptoGateKey[CRYPTO_FILLER_LEN] = { 0 };
+
+/* holds its crypto worker until the gate opens, the operations pushed to the worker wait behind it */
+static void OnCryptoGateDone(int32_t result, void *ctx)
+{
+    (void)result;
+    (void)ctx;
+    g_cryptoGateRunNum++;
+    while (!g_cryptoGateOpen.load()) {
+        DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+    }
+}
+
+static void OnCryptoFillerDone(int32_t result, void *ctx)
+{
+    (void)ctx;
+    if (result == HAL_ERR_CANCELED) {
+        g_cryptoFillerCancelNum++;
+    }
+    g_cryptoFillerDoneNum++;
+}
+
+struct CryptoFiller {
+    uint8_t outVal[CRYPTO_FILLER_LEN];
+    Uint8Buff out;
+};
+
+static int32_t SubmitCryptoFiller(const AsyncAlgLoader *asyncLoader, CryptoFiller *filler, AlgCompletionFunc onDone)
+{
+    Uint8Buff key = { g_cryptoGateKey, CRYPTO_FILLER_LEN };
+    filler->out = { filler->outVal, CRYPTO_FILLER_LEN };
+    return asyncLoader->computeHkdf(&key, nullptr, nullptr, &filler->out, false, onDone, nullptr);
+}
+
+/* each worker takes one gate operation in turn, they all run once the workers pick them up */
+static void CloseCryptoGate(const AsyncAlgLoader *asyncLoader, vector<CryptoFiller> &gates)
+{
+    g_cryptoGateOpen = false;
+    g_cryptoGateRunNum = 0;
+    gates.resize(CRYPTO_POOL_WORKER_NUM);
+    for (uint32_t i = 0; i < CRYPTO_POOL_WORKER_NUM; i++) {
+        ASSERT_EQ(SubmitCryptoFiller(asyncLoader, &gates[i], OnCryptoGateDone), HAL_SUCCESS);
+    }
+    while (g_cryptoGateRunNum.load() < CRYPTO_POOL_WORKER_NUM) {
+        DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+    }
+}
+
+/* like the resume handler, it may look at the step at once, the step is no longer pending then */
+static void OnPakeTestStepDone(void *ctx)
+{
+    if (ctx != nullptr) {
+        g_isPakeStepPendingInDone = IsPakeProtocolStepPending((const PakeBaseParams *)ctx);
+    }
+    g_pakeStepDoneNum++;
+}
+
+static void InitPakeTestParams(PakeBaseParams *params, bool isClient)
+{
+    ASSERT_EQ(InitPakeBaseParams(params), HC_SUCCESS);
+    params->isClient = isClient;
+    params->supportedPakeAlg = EC_SPEKE;
+    params->curveType = CURVE_25519;
+    ASSERT_EQ(InitSingleParam(&params->psk, PAKE_PSK_LEN), HC_SUCCESS);
+    (void)memset_s(params->psk.val, params->psk.length, 1, params->psk.length);
+}
+
+static void CopyPakeTestBuff(Uint8Buff *dst, const Uint8Buff *src)
+{
+    if (dst->length != src->length) {
+        HcFree(dst->val);
+        dst->val = nullptr;
+        ASSERT_EQ(InitSingleParam(dst, src->length), HC_SUCCESS);
+    }
+    ASSERT_EQ(memcpy_s(dst->val, dst->length, src->val, src->length), EOK);
+}
+
+/* the step waits behind the gate, so it is always pending, and it is finished by the resume */
+static void RunPendingPakeStep(const AsyncAlgLoader *asyncLoader, PakeBaseParams *params, PakeProtocolStep step,
+    bool isSuccess = true)
+{
+    vector<CryptoFiller> gates;
+    CloseCryptoGate(asyncLoader, gates);
+    g_pakeStepDoneNum = 0;
+    g_isPakeStepPendingInDone = true;
+    bool isPending = false;
+    ASSERT_EQ(StartPakeProtocolStep(params, step, OnPakeTestStepDone, params, &isPending), HC_SUCCESS);
+    EXPECT_TRUE(isPending);
+    EXPECT_TRUE(IsPakeProtocolStepPending(params));
+    EXPECT_EQ(g_pakeStepDoneNum.load(), 0u);
+    g_cryptoGateOpen = true;
+    while (g_pakeStepDoneNum.load() == 0) {
+        DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+    }
+    EXPECT_FALSE(g_isPakeStepPendingInDone.load());
+    EXPECT_FALSE(IsPakeProtocolStepPending(params));
+    EXPECT_EQ(FinishPakeProtocolStep(params, step) == HC_SUCCESS, isSuccess);
+    EXPECT_EQ(g_pakeStepDoneNum.load(), 1u);
+}
+
+/* the three steps of the pake run on the crypto workers, both sides get the same session key */
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_03)
+{
+    ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+    const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+    ASSERT_NE(asyncLoader, nullptr);
+    PakeBaseParams client;
+    PakeBaseParams server;
+    InitPakeTestParams(&client, true);
+    InitPakeTestParams(&server, false);
+    RunPendingPakeStep(asyncLoader, &server, PAKE_STEP_SERVER_RESPONSE);
+    CopyPakeTestBuff(&client.salt, &server.salt);
+    CopyPakeTestBuff(&client.challengePeer, &server.challengeSelf);
+    CopyPakeTestBuff(&client.epkPeer, &server.epkSelf);
+    RunPendingPakeStep(asyncLoader, &client, PAKE_STEP_CLIENT_CONFIRM);
+    CopyPakeTestBuff(&server.challengePeer, &client.challengeSelf);
+    CopyPakeTestBuff(&server.epkPeer, &client.epkSelf);
+    CopyPakeTestBuff(&server.kcfDataPeer, &client.kcfData);
+    RunPendingPakeStep(asyncLoader, &server, PAKE_STEP_SERVER_CONFIRM);
+    CopyPakeTestBuff(&client.kcfDataPeer, &server.kcfData);
+    EXPECT_EQ(ClientVerifyConfirmPakeProtocol(&client), HC_SUCCESS);
+    ASSERT_EQ(client.sessionKey.length, server.sessionKey.length);
+    EXPECT_EQ(memcmp(client.sessionKey.val, server.sessionKey.val, client.sessionKey.length), 0);
+    /* the proof of the client doesn't match another server, which only finds it out once the step resumes */
+    PakeBaseParams other;
+    InitPakeTestParams(&other, false);
+    RunPendingPakeStep(asyncLoader, &other, PAKE_STEP_SERVER_RESPONSE);
+    CopyPakeTestBuff(&other.challengePeer, &client.challengeSelf);
+    CopyPakeTestBuff(&other.epkPeer, &client.epkSelf);
+    CopyPakeTestBuff(&other.kcfDataPeer, &client.kcfData);
+    RunPendingPakeStep(asyncLoader, &other, PAKE_STEP_SERVER_CONFIRM, false);
+    DestroyPakeBaseParams(&other);
+    DestroyPakeBaseParams(&client);
+    DestroyPakeBaseParams(&server);
+    DestroyCryptoPool();
+}
+
+static void *OpenCryptoGateLater(void *arg)
+{
+    (void)arg;
+    DelayWithMSec(CRYPTO_GATE_WAIT_MSEC * 50); /* 50: long enough for the destruction to start waiting */
+    g_cryptoGateOpen = true;
+    return nullptr;
+}
+
+static void *DestroyCryptoPoolThread(void *arg)
+{
+    (void)arg;
+    DestroyCryptoPool();
+    return nullptr;
+}
+
+/* The params of a pending step are destroyed while its operations wait on the pool, onDone is never called. */
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_04)
+{
+    ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+    const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+    ASSERT_NE(asyncLoader, nullptr);
+    vector<CryptoFiller> gates;
+    CloseCryptoGate(asyncLoader, gates);
+    PakeBaseParams params;
+    InitPakeTestParams(&params, false);
+    g_pakeStepDoneNum = 0;
+    bool isPending = false;
+    ASSERT_EQ(StartPakeProtocolStep(&params, PAKE_STEP_SERVER_RESPONSE, OnPakeTestStepDone, nullptr, &isPending),
+        HC_SUCCESS);
+    EXPECT_TRUE(isPending);
+    pthread_t opener;
+    ASSERT_EQ(pthread_create(&opener, nullptr, OpenCryptoGateLater, nullptr), 0);
+    DestroyPakeBaseParams(&params);
+    (void)pthread_join(opener, nullptr);
+    EXPECT_EQ(g_pakeStepDoneNum.load(), 0u);
+    DestroyCryptoPool();
+}
+
+/*
+ * The pool is destroyed while its workers run, with operations in their queues and a caller which got the
+ * loader before: every operation ends once, the ones which did not run are canceled, and so is the pake step.
+ */
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_05)
+{
+    const uint32_t queuedNum = 8;
+    ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+    const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+    ASSERT_NE(asyncLoader, nullptr);
+    vector<CryptoFiller> gates;
+    CloseCryptoGate(asyncLoader, gates);
+    g_cryptoFillerDoneNum = 0;
+    g_cryptoFillerCancelNum = 0;
+    vector<CryptoFiller> fillers(queuedNum + 1);
+    for (uint32_t i = 0; i < queuedNum; i++) {
+        ASSERT_EQ(SubmitCryptoFiller(asyncLoader, &fillers[i], OnCryptoFillerDone), HAL_SUCCESS);
+    }
+    PakeBaseParams params;
+    InitPakeTestParams(&params, false);
+    g_pakeStepDoneNum = 0;
+    bool isPending = false;
+    ASSERT_EQ(StartPakeProtocolStep(&params, PAKE_STEP_SERVER_RESPONSE, OnPakeTestStepDone, nullptr, &isPending),
+        HC_SUCCESS);
+    EXPECT_TRUE(isPending);
+    pthread_t destroyer;
+    ASSERT_EQ(pthread_create(&destroyer, nullptr, DestroyCryptoPoolThread, nullptr), 0);
+    while (GetAsyncLoaderInstance() != nullptr) {
+        DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+    }
+    /* the queued operations are canceled by the destroying thread, the late one on this thread */
+    EXPECT_EQ(SubmitCryptoFiller(asyncLoader, &fillers[queuedNum], OnCryptoFillerDone), HAL_SUCCESS);
+    while ((g_cryptoFillerDoneNum.load() < queuedNum + 1) || (g_pakeStepDoneNum.load() == 0)) {
+        DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+    }
+    EXPECT_EQ(g_cryptoFillerCancelNum.load(), queuedNum + 1);
+    EXPECT_EQ(FinishPakeProtocolStep(&params, PAKE_STEP_SERVER_RESPONSE), HAL_ERR_CANCELED);
+    /* the running operations end before the destruction does */
+    g_cryptoGateOpen = true;
+    (void)pthread_join(destroyer, nullptr);
+    EXPECT_EQ(GetAsyncLoaderInstance(), nullptr);
+    EXPECT_EQ(g_pakeStepDoneNum.load(), 1u);
+    DestroyPakeBaseParams(&params);
+}
+
+/* when every queue is full, the operations run on the caller thread, and so does the whole pake step */
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_06)
+{
+    const uint32_t queuedNum = CRYPTO_POOL_WORKER_NUM * CRYPTO_QUEUE_CAPACITY;
+    ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+    const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+    ASSERT_NE(asyncLoader, nullptr);
+    vector<CryptoFiller> gates;
+    CloseCryptoGate(asyncLoader, gates);
+    g_cryptoFillerDoneNum = 0;
+    g_cryptoFillerCancelNum = 0;
+    vector<CryptoFiller> fillers(queuedNum + 1);
+    for (uint32_t i = 0; i < queuedNum; i++) {
+        ASSERT_EQ(SubmitCryptoFiller(asyncLoader, &fillers[i], OnCryptoFillerDone), HAL_SUCCESS);
+    }
+    EXPECT_EQ(g_cryptoFillerDoneNum.load(), 0u);
+    EXPECT_EQ(SubmitCryptoFiller(asyncLoader, &fillers[queuedNum], OnCryptoFillerDone), HAL_SUCCESS);
+    EXPECT_EQ(g_cryptoFillerDoneNum.load(), 1u);
+    PakeBaseParams params;
+    InitPakeTestParams(&params, false);
+    g_pakeStepDoneNum = 0;
+    bool isPending = true;
+    EXPECT_EQ(StartPakeProtocolStep(&params, PAKE_STEP_SERVER_RESPONSE, OnPakeTestStepDone, nullptr, &isPending),
+        HC_SUCCESS);
+    EXPECT_FALSE(isPending);
+    EXPECT_EQ(g_pakeStepDoneNum.load(), 0u);
+    EXPECT_EQ(params.epkSelf.length, (uint32_t)PAKE_EC_KEY_LEN);
+    g_cryptoGateOpen = true;
+    while (g_cryptoFillerDoneNum.load() < queuedNum + 1) {
+        DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+    }
+    EXPECT_EQ(g_cryptoFillerCancelNum.load(), 0u);
+    DestroyPakeBaseParams(&params);
+    DestroyCryptoPool();
+}
+
+static const uint32_t CRYPTO_SUBMITTER_NUM = 4;
+static const uint32_t CRYPTO_SUBMIT_NUM = 64;
+static const uint32_t CRYPTO_DESTROY_ROUND_NUM = 20;
+static std::atomic<uint32_t> g_cryptoSubmitStartNum(0);
+
+struct CryptoSubmitter {
+    const AsyncAlgLoader *asyncLoader;
+    vector<CryptoFiller> fillers;
+};
+
+static void *SubmitCryptoFillersThread(void *arg)
+{
+    CryptoSubmitter *submitter = (CryptoSubmitter *)arg;
+    g_cryptoSubmitStartNum++;
+    for (CryptoFiller &filler : submitter->fillers) {
+        (void)SubmitCryptoFiller(submitter->asyncLoader, &filler, OnCryptoFillerDone);
+    }
+    return nullptr;
+}
+
+/*
+ * The pool is destroyed while several callers submit without a pause. The destruction waits for the callers
+ * which are pushing, and every operation ends once: it runs, or it is canceled.
+ */
+TEST(CRYPTO_POOL, TC_CRYPTO_POOL_07)
+{
+    for (uint32_t round = 0; round < CRYPTO_DESTROY_ROUND_NUM; round++) {
+        ASSERT_EQ(InitCryptoPool(CRYPTO_POOL_WORKER_NUM), HAL_SUCCESS);
+        const AsyncAlgLoader *asyncLoader = GetAsyncLoaderInstance();
+        ASSERT_NE(asyncLoader, nullptr);
+        g_cryptoFillerDoneNum = 0;
+        g_cryptoSubmitStartNum = 0;
+        vector<CryptoSubmitter> submitters(CRYPTO_SUBMITTER_NUM);
+        vector<pthread_t> threads(CRYPTO_SUBMITTER_NUM);
+        for (uint32_t i = 0; i < CRYPTO_SUBMITTER_NUM; i++) {
+            submitters[i].asyncLoader = asyncLoader;
+            submitters[i].fillers.resize(CRYPTO_SUBMIT_NUM);
+            ASSERT_EQ(pthread_create(&threads[i], nullptr, SubmitCryptoFillersThread, &submitters[i]), 0);
+        }
+        while (g_cryptoSubmitStartNum.load() < CRYPTO_SUBMITTER_NUM) {
+            DelayWithMSec(CRYPTO_GATE_WAIT_MSEC);
+        }
+        DestroyCryptoPool();
+        EXPECT_EQ(GetAsyncLoaderInstance(), nullptr);
+        for (pthread_t thread : threads) {
+            (void)pthread_join(thread, nullptr);
+        }
+        EXPECT_EQ(g_cryptoFillerDoneNum.load(), CRYPTO_SUBMITTER_NUM * CRYPTO_SUBMIT_NUM);
+    }
+}
+
+TEST(AUTH_RESUME, TC_AUTH_RESUME_01)
+{
+    CJson *param = CreateJsonFromString("{\"isResumable\":true,\"peerConnDeviceId\":\"TEST_UDID\"}");
+    ASSERT_NE(param, nullptr);
+    ASSERT_EQ(InitAuthResumeCache(), HC_SUCCESS);
+    /* no auth has finished with the peer, so there is no secret to resume */
+    EXPECT_FALSE(IsAuthResumeRequested(param));
+    EXPECT_FALSE(IsAuthResumeMsg(param));
+    CJson *msg = CreateJsonFromString("{\"resumeStep\":1}");
+    ASSERT_NE(msg, nullptr);
+    EXPECT_TRUE(IsAuthResumeMsg(msg));
+    FreeJson(msg);
+    FreeJson(param);
+}
+
+TEST(AUTH_RESUME, TC_AUTH_RESUME_02)
+{
+    CJson *authParam = CreateJsonFromString("{\"isResumable\":true,\"isClient\":true}");
+    ASSERT_NE(authParam, nullptr);
+    CJson *oldPeerMsg = CreateJsonFromString("{\"isDeviceLevel\":false}");
+    CJson *peerMsg = CreateJsonFromString("{\"isResumable\":true}");
+    ASSERT_NE(oldPeerMsg, nullptr);
+    ASSERT_NE(peerMsg, nullptr);
+    bool isPeerResumable = false;
+    ProcessResumableFlag(oldPeerMsg, authParam);
+    EXPECT_NE(GetBoolFromJson(authParam, FIELD_IS_PEER_RESUMABLE, &isPeerResumable), HC_SUCCESS);
+    ProcessResumableFlag(peerMsg, authParam);
+    EXPECT_EQ(GetBoolFromJson(authParam, FIELD_IS_PEER_RESUMABLE, &isPeerResumable), HC_SUCCESS);
+    EXPECT_TRUE(isPeerResumable);
+    /* a later message without the flag, like the last one of the server, doesn't clear it */
+    ProcessResumableFlag(oldPeerMsg, authParam);
+    EXPECT_EQ(GetBoolFromJson(authParam, FIELD_IS_PEER_RESUMABLE, &isPeerResumable), HC_SUCCESS);
+    EXPECT_TRUE(isPeerResumable);
+    FreeJson(peerMsg);
+    FreeJson(oldPeerMsg);
+    FreeJson(authParam);
+}
+
+#define RESUME_TEST_GROUP_ID "RESUME_TEST_GROUP"
+#define RESUME_TEST_CLIENT_UDID "RESUME_TEST_CLIENT_UDID"
+#define RESUME_TEST_SERVER_UDID "RESUME_TEST_SERVER_UDID"
+
+static string g_resumeTestMsg;
+static std::map<int64_t, vector<uint8_t>> g_resumeTestKeys;
+static int32_t g_resumeTestFinishNum = 0;
+static int32_t g_resumeTestErrorNum = 0;
+static int32_t g_resumeTestErrorCode = HC_SUCCESS;
+
+static bool OnResumeTestTransmit(int64_t requestId, const uint8_t *data, uint32_t dataLen)
+{
+    (void)requestId;
+    g_resumeTestMsg = string((const char *)data, strnlen((const char *)data, dataLen));
+    return true;
+}
+
+static void OnResumeTestSessionKey(int64_t requestId, const uint8_t *sessionKey, uint32_t sessionKeyLen)
+{
+    g_resumeTestKeys[requestId].assign(sessionKey, sessionKey + sessionKeyLen);
+}
+
+static void OnResumeTestFinish(int64_t requestId, int operationCode, const char *returnData)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)returnData;
+    g_resumeTestFinishNum++;
+}
+
+static void OnResumeTestError(int64_t requestId, int operationCode, int errorCode, const char *errorReturn)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)errorReturn;
+    g_resumeTestErrorNum++;
+    g_resumeTestErrorCode = errorCode;
+}
+
+/* the server application accepts the resumption of the client */
+static char *OnResumeTestRequest(int64_t requestId, int operationCode, const char *reqParams)
+{
+    (void)requestId;
+    (void)operationCode;
+    (void)reqParams;
+    CJson *json = CreateJson();
+    AddIntToJson(json, FIELD_CONFIRMATION, REQUEST_ACCEPTED);
+    AddBoolToJson(json, FIELD_IS_RESUMABLE, true);
+    AddStringToJson(json, FIELD_SERVICE_PKG_NAME, TEST_APP_NAME);
+    AddStringToJson(json, FIELD_PEER_CONN_DEVICE_ID, RESUME_TEST_CLIENT_UDID);
+    char *returnDataStr = PackJsonToString(json);
+    FreeJson(json);
+    return returnDataStr;
+}
+
+static DeviceAuthCallback g_resumeTestCallback = {
+    OnResumeTestTransmit,
+    OnResumeTestSessionKey,
+    OnResumeTestFinish,
+    OnResumeTestError,
+    OnResumeTestRequest
+};
+
+void AUTH_RESUME_SESSION::SetUp()
+{
+    DeleteDatabase();
+    InitDeviceAuthService();
+    SetClient(false);
+    SetTimeOffset(0);
+    g_resumeTestMsg.clear();
+    g_resumeTestKeys.clear();
+    g_resumeTestFinishNum = 0;
+    g_resumeTestErrorNum = 0;
+    g_resumeTestErrorCode = HC_SUCCESS;
+    uint8_t udid[INPUT_UDID_LEN] = { 0 };
+    ASSERT_EQ(HcGetUdid(udid, INPUT_UDID_LEN), HC_SUCCESS);
+    ASSERT_EQ(AddDbTestGroup(RESUME_TEST_GROUP_ID, TEST_APP_NAME), HC_SUCCESS);
+    EXPECT_EQ(AddDbTestDevice(RESUME_TEST_GROUP_ID, (const char *)udid), HC_SUCCESS);
+    EXPECT_EQ(AddDbTestDevice(RESUME_TEST_GROUP_ID, RESUME_TEST_CLIENT_UDID), HC_SUCCESS);
+    EXPECT_EQ(AddDbTestDevice(RESUME_TEST_GROUP_ID, RESUME_TEST_SERVER_UDID), HC_SUCCESS);
+}
+
+void AUTH_RESUME_SESSION::TearDown()
+{
+    SetTimeOffset(0);
+    DestroyDeviceAuthService();
+    DeleteDatabase();
+}
+
+/* what the PAKE task hands to the session at the end of an auth of the group, with or without the secret */
+static void SaveResumeTestSecret(bool isClient, const char *peerUdid, uint8_t seed, bool hasSecret = true)
+{
+    uint8_t key[AUTH_RESUME_SECRET_LEN];
+    (void)memset_s(key, sizeof(key), seed, sizeof(key));
+    CJson *authParam = CreateJson();
+    CJson *out = CreateJson();
+    CJson *sendToSelf = CreateJson();
+    AddBoolToJson(authParam, FIELD_IS_RESUMABLE, true);
+    AddBoolToJson(authParam, FIELD_IS_CLIENT, isClient);
+    AddBoolToJson(authParam, FIELD_IS_PEER_RESUMABLE, true);
+    AddStringToJson(authParam, FIELD_GROUP_ID, RESUME_TEST_GROUP_ID);
+    AddStringToJson(authParam, FIELD_SERVICE_TYPE, RESUME_TEST_GROUP_ID);
+    AddStringToJson(authParam, FIELD_PEER_CONN_DEVICE_ID, peerUdid);
+    AddIntToJson(authParam, FIELD_SELF_TYPE, DEVICE_TYPE_ACCESSORY);
+    AddIntToJson(authParam, FIELD_PEER_USER_TYPE, DEVICE_TYPE_ACCESSORY);
+    AddByteToJson(sendToSelf, FIELD_SESSION_KEY, key, sizeof(key));
+    if (hasSecret) {
+        AddByteToJson(sendToSelf, FIELD_RESUME_SECRET, key, sizeof(key));
+    }
+    AddObjToJson(out, FIELD_SEND_TO_SELF, sendToSelf);
+    SaveAuthResumeSecret(authParam, out);
+    FreeJson(sendToSelf);
+    FreeJson(out);
+    FreeJson(authParam);
+}
+
+static CJson *CreateResumeTestClientParam(void)
+{
+    CJson *param = CreateJson();
+    int64_t requestId = CLIENT_REQUEST_ID;
+    AddBoolToJson(param, FIELD_IS_RESUMABLE, true);
+    AddBoolToJson(param, FIELD_IS_CLIENT, true);
+    AddStringToJson(param, FIELD_PEER_CONN_DEVICE_ID, RESUME_TEST_SERVER_UDID);
+    AddStringToJson(param, FIELD_SERVICE_PKG_NAME, TEST_APP_NAME);
+    AddStringToJson(param, FIELD_GROUP_ID, RESUME_TEST_GROUP_ID);
+    AddByteToJson(param, FIELD_REQUEST_ID, (const uint8_t *)&requestId, sizeof(int64_t));
+    return param;
+}
+
+/* the client session sends its resume request by the callback */
+static int32_t StartResumeTestClient(void)
+{
+    g_resumeTestMsg.clear();
+    CJson *param = CreateResumeTestClientParam();
+    int32_t res = CreateSession(CLIENT_REQUEST_ID, TYPE_CLIENT_AUTH_SESSION, param, &g_resumeTestCallback);
+    FreeJson(param);
+    return res;
+}
+
+static CJson *CreateResumeTestServerMsg(const string &msg)
+{
+    CJson *in = CreateJsonFromString(msg.c_str());
+    int64_t requestId = SERVER_REQUEST_ID;
+    AddByteToJson(in, FIELD_REQUEST_ID, (const uint8_t *)&requestId, sizeof(int64_t));
+    return in;
+}
+
+/* the server side without its application, so the result of the check can be seen */
+static int32_t ServeResumeTestRequest(const string &request)
+{
+    CJson *in = CreateResumeTestServerMsg(request);
+    char *confirmationStr = OnResumeTestRequest(SERVER_REQUEST_ID, AUTHENTICATE, nullptr);
+    CJson *confirmation = CreateJsonFromString(confirmationStr);
+    FreeJsonString(confirmationStr);
+    g_resumeTestMsg.clear();
+    int32_t res = ProcessServerAuthResume(in, confirmation, &g_resumeTestCallback);
+    FreeJson(confirmation);
+    FreeJson(in);
+    return res;
+}
+
+/* the client session gets the answer of the server, the session ends unless it goes on with the full auth */
+static int32_t ProcessResumeTestResponse(const string &response)
+{
+    CJson *in = CreateJsonFromString(response.c_str());
+    g_resumeTestMsg.clear();
+    int32_t res = ProcessSession(CLIENT_REQUEST_ID, AUTH_TYPE, in);
+    if (res != HC_SUCCESS) {
+        DestroySession(CLIENT_REQUEST_ID);
+    }
+    FreeJson(in);
+    return res;
+}
+
+static bool IsResumeTestMsgOfStep(const string &msg, int32_t expectedStep)
+{
+    CJson *json = CreateJsonFromString(msg.c_str());
+    int32_t step = 0;
+    bool isOfStep = (GetIntFromJson(json, FIELD_RESUME_STEP, &step) == HC_SUCCESS) && (step == expectedStep);
+    FreeJson(json);
+    return isOfStep;
+}
+
+static bool IsResumeTestRequested(void)
+{
+    CJson *param = CreateResumeTestClientParam();
+    bool isRequested = IsAuthResumeRequested(param);
+    FreeJson(param);
+    return isRequested;
+}
+
+/* both sides get the same session key in one round trip, and each round uses the secret of the previous one */
+TEST_F(AUTH_RESUME_SESSION, TC_AUTH_RESUME_03)
+{
+    SaveResumeTestSecret(true, RESUME_TEST_SERVER_UDID, 1);
+    SaveResumeTestSecret(false, RESUME_TEST_CLIENT_UDID, 1);
+    vector<uint8_t> lastKey;
+    for (int32_t round = 0; round < 3; round++) {
+        g_resumeTestKeys.clear();
+        ASSERT_TRUE(IsResumeTestRequested());
+        ASSERT_EQ(StartResumeTestClient(), HC_SUCCESS);
+        ASSERT_TRUE(IsResumeTestMsgOfStep(g_resumeTestMsg, AUTH_RESUME_REQUEST));
+        ASSERT_EQ(ServeResumeTestRequest(g_resumeTestMsg), HC_SUCCESS);
+        ASSERT_TRUE(IsResumeTestMsgOfStep(g_resumeTestMsg, AUTH_RESUME_RESPONSE));
+        EXPECT_EQ(ProcessResumeTestResponse(g_resumeTestMsg), FINISH);
+        EXPECT_FALSE(IsRequestExist(CLIENT_REQUEST_ID));
+        EXPECT_EQ(g_resumeTestKeys[CLIENT_REQUEST_ID].size(), (size_t)DEFAULT_RETURN_KEY_LENGTH);
+        EXPECT_EQ(g_resumeTestKeys[CLIENT_REQUEST_ID], g_resumeTestKeys[SERVER_REQUEST_ID]);
+        EXPECT_NE(g_resumeTestKeys[CLIENT_REQUEST_ID], lastKey);
+        lastKey = g_resumeTestKeys[CLIENT_REQUEST_ID];
+    }
+    EXPECT_EQ(g_resumeTestFinishNum, 6);
+    EXPECT_EQ(g_resumeTestErrorNum, 0);
+
+    /* the server has moved on to the next secret, a client which still has the first one can't resume */
+    SaveResumeTestSecret(true, RESUME_TEST_SERVER_UDID, 1);
+    ASSERT_EQ(StartResumeTestClient(), HC_SUCCESS);
+    EXPECT_EQ(ServeResumeTestRequest(g_resumeTestMsg), HC_ERR_PROOF_NOT_MATCH);
+    DestroySession(CLIENT_REQUEST_ID);
+}
+
+/* a request proves its secret once, the replayed one is refused and a response never reaches the server side */
+TEST_F(AUTH_RESUME_SESSION, TC_AUTH_RESUME_04)
+{
+    SaveResumeTestSecret(true, RESUME_TEST_SERVER_UDID, 1);
+    SaveResumeTestSecret(false, RESUME_TEST_CLIENT_UDID, 1);
+    ASSERT_EQ(StartResumeTestClient(), HC_SUCCESS);
+    string request = g_resumeTestMsg;
+    ASSERT_EQ(ServeResumeTestRequest(request), HC_SUCCESS);
+    string response = g_resumeTestMsg;
+    EXPECT_EQ(ProcessResumeTestResponse(response), FINISH);
+    g_resumeTestKeys.clear();
+    EXPECT_EQ(ServeResumeTestRequest(request), HC_ERR_PROOF_NOT_MATCH);
+    EXPECT_TRUE(g_resumeTestMsg.empty());
+    EXPECT_TRUE(g_resumeTestKeys.empty());
+
+    CJson *responseJson = CreateResumeTestServerMsg(response);
+    CJson *requestJson = CreateResumeTestServerMsg(request);
+    EXPECT_TRUE(IsAuthResumeMsg(responseJson));
+    EXPECT_FALSE(IsAuthResumeRequest(responseJson));
+    EXPECT_TRUE(IsAuthResumeRequest(requestJson));
+    FreeJson(requestJson);
+    FreeJson(responseJson);
+    EXPECT_EQ(ServeResumeTestRequest(response), HC_ERR_BAD_MESSAGE);
+    EXPECT_TRUE(g_resumeTestKeys.empty());
+}
+
+/* the server has no secret, so the client drops its own and goes on with the full auth in the same session */
+TEST_F(AUTH_RESUME_SESSION, TC_AUTH_RESUME_05)
+{
+    SaveResumeTestSecret(true, RESUME_TEST_SERVER_UDID, 1);
+    ASSERT_EQ(StartResumeTestClient(), HC_SUCCESS);
+    CJson *request = CreateResumeTestServerMsg(g_resumeTestMsg);
+    g_resumeTestMsg.clear();
+    ProcessServerAuthResumeMsg(request, &g_resumeTestCallback);
+    FreeJson(request);
+    ASSERT_TRUE(IsResumeTestMsgOfStep(g_resumeTestMsg, AUTH_RESUME_RESPONSE));
+    EXPECT_TRUE(g_resumeTestKeys.empty());
+
+    EXPECT_EQ(ProcessResumeTestResponse(g_resumeTestMsg), HC_SUCCESS);
+    EXPECT_TRUE(IsRequestExist(CLIENT_REQUEST_ID));
+    CJson *fullAuthMsg = CreateJsonFromString(g_resumeTestMsg.c_str());
+    ASSERT_NE(fullAuthMsg, nullptr);
+    EXPECT_FALSE(IsAuthResumeMsg(fullAuthMsg));
+    FreeJson(fullAuthMsg);
+    EXPECT_FALSE(IsResumeTestRequested());
+    EXPECT_TRUE(g_resumeTestKeys.empty());
+    DestroySession(CLIENT_REQUEST_ID);
+}
+
+/* only the secret of the PAKE task is kept, and it expires on the monotonic clock */
+TEST_F(AUTH_RESUME_SESSION, TC_AUTH_RESUME_06)
+{
+    SaveResumeTestSecret(true, RESUME_TEST_SERVER_UDID, 1, false);
+    EXPECT_FALSE(IsResumeTestRequested());
+    SaveResumeTestSecret(true, RESUME_TEST_SERVER_UDID, 1);
+    EXPECT_TRUE(IsResumeTestRequested());
+    SetTimeOffset(AUTH_RESUME_EXPIRE_TIME - 1);
+    EXPECT_TRUE(IsResumeTestRequested());
+    SetTimeOffset(AUTH_RESUME_EXPIRE_TIME + 1);
+    EXPECT_FALSE(IsResumeTestRequested());
+    SetTimeOffset(0);
+    EXPECT_FALSE(IsResumeTestRequested());
+}
+
+/* a pending session which can't be resumed fails at once, and is destroyed later without a timeout */
+TEST_F(AUTH_RESUME_SESSION, TC_SESSION_ABORT_01)
+{
+    ASSERT_EQ(StartResumeTestClient(), HC_SUCCESS);
+    ASSERT_TRUE(IsRequestExist(CLIENT_REQUEST_ID));
+    SessionMemoryStat stat = { 0 };
+    GetSessionMemoryStat(&stat);
+    uint32_t sessionCount = stat.sessionCount;
+    AbortSession(CLIENT_REQUEST_ID, HC_ERR_TASK_QUEUE_FULL);
+    EXPECT_EQ(g_resumeTestErrorNum, 1);
+    EXPECT_EQ(g_resumeTestErrorCode, HC_ERR_TASK_QUEUE_FULL);
+    EXPECT_FALSE(IsRequestExist(CLIENT_REQUEST_ID));
+    /* neither another failure nor a message reaches it */
+    AbortSession(CLIENT_REQUEST_ID, HC_ERR_TASK_QUEUE_FULL);
+    CJson *in = CreateJsonFromString("{}");
+    ASSERT_NE(in, nullptr);
+    EXPECT_EQ(ProcessSession(CLIENT_REQUEST_ID, AUTH_TYPE, in), HC_ERR_SESSION_NOT_EXIST);
+    SetTimeOffset(2); /* 2: the wheel passes the next second */
+    EXPECT_EQ(ProcessSession(CLIENT_REQUEST_ID, AUTH_TYPE, in), HC_ERR_SESSION_NOT_EXIST);
+    FreeJson(in);
+    GetSessionMemoryStat(&stat);
+    EXPECT_EQ(stat.sessionCount, sessionCount - 1);
+    EXPECT_EQ(g_resumeTestErrorNum, 1);
+}
+
+TEST_F(AUTH_GROUP_AFFINITY, TC_AUTH_GROUP_AFFINITY_01)
+{
+    const char *createParamsStr =
+        "{\"groupType\":256,\"deviceId\":\"3C58C27533D8\",\"userType\":0,\""
+        "groupVisibility\":-1,\"expireTime\":90,\"groupName\":\"P2PGroup\"}";
+    const char *groupId = "BC680ED1137A5731F4A5A90B1AACC4A0A3663F6FC2387B7273EFBCC66A54DC0B";
+    g_testGm->createGroup(TEMP_REQUEST_ID, TEST_APP_NAME, createParamsStr);
+    DelayWithMSec(500);
+    char *udid = nullptr;
+    ASSERT_EQ(GetLocalDevUdid(&udid), HC_SUCCESS);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 0u);
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(groupId, udid, 1000), HC_SUCCESS);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 1000u);
+    /* a time soon after the saved one is kept in memory, but not saved */
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(groupId, udid, 1030), HC_SUCCESS);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 1030u);
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 1000u);
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(groupId, udid, 1030), HC_SUCCESS);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 1030u);
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(groupId, udid, 1100), HC_SUCCESS);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 1100u);
+    /* the system time was set back */
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(groupId, udid, 10), HC_SUCCESS);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 10u);
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(groupId, "UNKNOWN_UDID", 1000), HC_ERR_DEVICE_NOT_EXIST);
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, "UNKNOWN_UDID", nullptr), 0u);
+    EXPECT_EQ(UpdateTrustedDeviceLastTm(nullptr, udid, 1000), HC_ERR_INVALID_PARAMS);
+    /* the saved time survives a restart of the service */
+    DestroyDeviceAuthService();
+    InitDeviceAuthService();
+    EXPECT_EQ(GetTrustedDeviceLastTm(groupId, udid, nullptr), 10u);
+    DestroyUdid(&udid);
+}
+
+#define AFFINITY_TEST_GROUP_A "AFFINITY_TEST_GROUP_A"
+#define AFFINITY_TEST_GROUP_B "AFFINITY_TEST_GROUP_B"
+#define AFFINITY_TEST_GROUP_C "AFFINITY_TEST_GROUP_C"
+#define AFFINITY_TEST_PEER_UDID "AFFINITY_TEST_PEER_UDID"
+
+/* the candidate groups of a client auth of the peer, in the order the session tries them */
+static string GetAffinityTestCandidates(const char *groupId = nullptr)
+{
+    CJson *param = CreateJson();
+    if (param == nullptr) {
+        return "";
+    }
+    (void)AddStringToJson(param, FIELD_PEER_CONN_DEVICE_ID, AFFINITY_TEST_PEER_UDID);
+    (void)AddStringToJson(param, FIELD_SERVICE_PKG_NAME, TEST_APP_NAME);
+    (void)AddBoolToJson(param, FIELD_IS_CLIENT, true);
+    if (groupId != nullptr) {
+        (void)AddStringToJson(param, FIELD_GROUP_ID, groupId);
+    }
+    ParamsVec list;
+    CreateAuthParamsVec(&list);
+    string order;
+    if (GetAuthParamsList(param, &list) == HC_SUCCESS) {
+        for (uint32_t i = 0; i < list.size(&list); i++) {
+            CJson *authParam = (CJson *)list.get(&list, i);
+            const char *candidate = GetStringFromJson(authParam, FIELD_GROUP_ID);
+            order += (candidate != nullptr) ? candidate : "null";
+            order += ";";
+            FreeJson(authParam);
+        }
+    }
+    DestroyAuthParamsVec(&list);
+    FreeJson(param);
+    return order;
+}
+
+TEST_F(AUTH_GROUP_AFFINITY, TC_AUTH_GROUP_AFFINITY_02)
+{
+    uint8_t udid[INPUT_UDID_LEN] = { 0 };
+    ASSERT_EQ(HcGetUdid(udid, INPUT_UDID_LEN), HC_SUCCESS);
+    const char *groups[] = { AFFINITY_TEST_GROUP_A, AFFINITY_TEST_GROUP_B, AFFINITY_TEST_GROUP_C };
+    for (const char *groupId : groups) {
+        ASSERT_EQ(AddDbTestGroup(groupId, TEST_APP_NAME), HC_SUCCESS);
+        ASSERT_EQ(AddDbTestDevice(groupId, (const char *)udid), HC_SUCCESS);
+        ASSERT_EQ(AddDbTestDevice(groupId, AFFINITY_TEST_PEER_UDID), HC_SUCCESS);
+    }
+    AuthGroupStat before = { 0 };
+    GetAuthGroupStat(&before);
+    /* never authenticated, the groups are tried in the order of the database */
+    EXPECT_EQ(GetAffinityTestCandidates(), "AFFINITY_TEST_GROUP_A;AFFINITY_TEST_GROUP_B;AFFINITY_TEST_GROUP_C;");
+    /* the group of the last auth comes first, the others keep their order */
+    ASSERT_EQ(UpdateTrustedDeviceLastTm(AFFINITY_TEST_GROUP_C, AFFINITY_TEST_PEER_UDID, 1000), HC_SUCCESS);
+    EXPECT_EQ(GetAffinityTestCandidates(), "AFFINITY_TEST_GROUP_C;AFFINITY_TEST_GROUP_A;AFFINITY_TEST_GROUP_B;");
+    /* an auth within the save interval of the other group still moves it to the front */
+    ASSERT_EQ(UpdateTrustedDeviceLastTm(AFFINITY_TEST_GROUP_B, AFFINITY_TEST_PEER_UDID, 1010), HC_SUCCESS);
+    EXPECT_EQ(GetAffinityTestCandidates(), "AFFINITY_TEST_GROUP_B;AFFINITY_TEST_GROUP_A;AFFINITY_TEST_GROUP_C;");
+    ASSERT_EQ(UpdateTrustedDeviceLastTm(AFFINITY_TEST_GROUP_A, AFFINITY_TEST_PEER_UDID, 1020), HC_SUCCESS);
+    EXPECT_EQ(GetAffinityTestCandidates(), "AFFINITY_TEST_GROUP_A;AFFINITY_TEST_GROUP_B;AFFINITY_TEST_GROUP_C;");
+    /* a given group is the only candidate */
+    EXPECT_EQ(GetAffinityTestCandidates(AFFINITY_TEST_GROUP_C), "AFFINITY_TEST_GROUP_C;");
+    AuthGroupStat after = { 0 };
+    GetAuthGroupStat(&after);
+    EXPECT_EQ(after.reorderCount - before.reorderCount, 2u);
+}
@@ -14,10 +14,21 @@
  */
 
 #include "deviceauth_test_mock.h"
+#include <atomic>
 #include <cstring>
+#include <ctime>
 #include "securec.h"
+extern "C" {
+#include "alg_loader.h"
+#include "huks_adapter.h"
+}
 
 static bool g_testForClient = false;
+static std::atomic<int64_t> g_timeOffset(0);
+static uint32_t g_maxSessionCount = MAX_SESSION_COUNT;
+static const char *DEFAULT_STORAGE_PATH = "/data/data/deviceauth/hcgroup.dat";
+static const char *g_storagePath = DEFAULT_STORAGE_PATH;
+static std::atomic<uint32_t> g_sha256CallNum(0);
 
 void SetClient(bool tag)
 {
@@ -41,7 +52,79 @@ int32_t HcGetUdid(uint8_t *udid, int32_t udidLen)
     return 0;
 }
 
+void SetStoragePath(const char *path)
+{
+    g_storagePath = (path != nullptr) ? path : DEFAULT_STORAGE_PATH;
+}
+
 const char *GetStoragePath()
 {
-    return "/data/data/deviceauth/hcgroup.dat";
+    return g_storagePath;
+}
+
+void SetMaxSessionCount(uint32_t count)
+{
+    g_maxSessionCount = count;
+}
+
+uint32_t HcGetMaxSessionCount(void)
+{
+    return g_maxSessionCount;
+}
+
+void SetTimeOffset(int64_t offset)
+{
+    g_timeOffset = offset;
+}
+
+static int64_t GetClockTime(clockid_t clockId)
+{
+    struct timespec now;
+    if (clock_gettime(clockId, &now) != 0) {
+        return -1;
+    }
+    return now.tv_sec + g_timeOffset;
+}
+
+int64_t HcGetCurTime()
+{
+    return GetClockTime(CLOCK_MONOTONIC);
+}
+
+int64_t HcGetIntervalTime(int64_t startTime)
+{
+    int64_t curTime = HcGetCurTime();
+    if ((startTime < 0) || (curTime < startTime)) {
+        return -1;
+    }
+    return curTime - startTime;
+}
+
+int64_t HcGetRealTime()
+{
+    return GetClockTime(CLOCK_REALTIME);
+}
+
+static int32_t CountingSha256(const Uint8Buff *message, Uint8Buff *hash)
+{
+    g_sha256CallNum++;
+    return GetRealLoaderInstance()->sha256(message, hash);
+}
+
+static AlgLoader CreateCountingLoader()
+{
+    AlgLoader loader = *GetRealLoaderInstance();
+    loader.sha256 = CountingSha256;
+    return loader;
+}
+
+const AlgLoader *GetLoaderInstance()
+{
+    static const AlgLoader countingLoader = CreateCountingLoader();
+    return &countingLoader;
+}
+
+uint32_t GetSha256CallNum()
+{
+    return g_sha256CallNum;
 }